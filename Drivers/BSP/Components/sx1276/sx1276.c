@@ -106,6 +106,69 @@ void SX1276WriteFifo( uint8_t *buffer, uint8_t size );
  */
 void SX1276ReadFifo( uint8_t *buffer, uint8_t size );
 
+/*!
+ * \brief Writes a 16 bits value to a MSB/LSB radio register pair in one burst
+ *
+ * \param [IN] addr Address of the MSB register
+ * \param [IN] data New registers value
+ */
+static void SX1276WriteWord( uint8_t addr, uint16_t data );
+
+/*!
+ * \brief Reads a 16 bits value from a MSB/LSB radio register pair in one burst
+ *
+ * \param [IN] addr Address of the MSB register
+ * \retval data Registers value
+ */
+static uint16_t SX1276ReadWord( uint8_t addr );
+
+/*!
+ * \brief Tells if the register is a configuration register held in the shadow
+ *
+ * \remark Registers 0x0D to 0x3F depend on the current modem
+ *
+ * \param [IN] addr Register address
+ * \retval shadowed true when the radio only changes it on a write
+ */
+static bool ShadowIsCached( uint8_t addr );
+
+/*!
+ * \brief Invalidates the shadow of a range of registers
+ *
+ * \param [IN] first First register address
+ * \param [IN] last  Last register address
+ */
+static void ShadowInvalidate( uint8_t first, uint8_t last );
+
+/*!
+ * \brief Updates the shadow with registers about to be written
+ *
+ * \param [IN] addr   First register address
+ * \param [IN] buffer New registers values
+ * \param [IN] size   Number of registers
+ * \retval changed false when all the registers already hold these values
+ */
+static bool ShadowWrite( uint8_t addr, uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Reads registers from the shadow
+ *
+ * \param [IN]  addr   First register address
+ * \param [OUT] buffer Registers values
+ * \param [IN]  size   Number of registers
+ * \retval hit true when all the registers were read from the shadow
+ */
+static bool ShadowRead( uint8_t addr, uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Stores registers read from the radio in the shadow
+ *
+ * \param [IN] addr   First register address
+ * \param [IN] buffer Registers values
+ * \param [IN] size   Number of registers
+ */
+static void ShadowFill( uint8_t addr, uint8_t *buffer, uint8_t size );
+
 /*!
  * \brief Sets the SX1276 operating mode
  *
@@ -113,6 +176,54 @@ void SX1276ReadFifo( uint8_t *buffer, uint8_t size );
  */
 void SX1276SetOpMode( uint8_t opMode );
 
+/*!
+ * \brief Saves the packet format registers and sets the ones of a FSK stream
+ *
+ * \param [IN] size     Packet size, 0 when the length byte is still to come
+ * \param [IN] variable Variable length format, with a length byte first
+ */
+static void FskStreamStart( uint32_t size, bool variable );
+
+/*!
+ * \brief Restores the packet format registers at the end of a FSK stream
+ */
+static void FskStreamEnd( void );
+
+/*!
+ * \brief Writes the next payload bytes of a FSK stream to the FIFO
+ *
+ * \param [IN] room Free room in the FIFO
+ */
+static void FskStreamFill( uint8_t room );
+
+/*!
+ * \brief Reads the next payload bytes of a FSK stream from the FIFO and
+ *        hands them to the RxChunk callback
+ *
+ * \param [IN] count Number of bytes in the FIFO
+ */
+static void FskStreamRead( uint8_t count );
+
+/*!
+ * \brief Ends a FSK stream reception
+ */
+static void FskStreamRxDone( void );
+
+/*!
+ * \brief FifoLevel interrupt of a FSK stream reception
+ */
+static void FskStreamOnFifoLevel( void );
+
+/*!
+ * \brief PayloadReady interrupt of a FSK stream reception
+ */
+static void FskStreamOnPayloadReady( void );
+
+/*!
+ * \brief FifoEmpty interrupt of a FSK stream transmission
+ */
+static void FskStreamOnFifoEmpty( void );
+
 /*
  * SX1276 DIO IRQ callback functions prototype
  */
@@ -169,6 +280,11 @@ const RadioRegisters_t RadioRegsInit[] = RADIO_INIT_REGISTERS_VALUE;
 #define RSSI_OFFSET_LF                              -164
 #define RSSI_OFFSET_HF                              -157
 
+/*!
+ * Registers covered by the shadow, up to REG_PLL
+ */
+#define SHADOW_SIZE                                 0x80
+
 /*!
  * Precomputed FSK bandwidth registers values
  */
@@ -207,11 +323,27 @@ const FskBandwidth_t FskBandwidths[] =
  */
 static RadioEvents_t *RadioEvents;
 
+/*!
+ * FSK stream callbacks, NULL when the streams are not used
+ */
+static RadioFskStreamEvents_t *FskStreamEvents = NULL;
+
 /*!
  * Reception buffer
  */
 static uint8_t RxTxBuffer[RX_BUFFER_SIZE];
 
+/*!
+ * Write-through shadow of the configuration registers, saves the SPI read of
+ * the read-modify-write sequences and skips the writes of unchanged values
+ */
+static uint8_t RegShadow[SHADOW_SIZE];
+
+/*!
+ * Bit n set when RegShadow[n] holds the radio register value
+ */
+static uint32_t RegShadowValid[SHADOW_SIZE / 32];
+
 static LoRaBoardCallback_t *LoRaBoardCallbacks;
 
 /*
@@ -287,14 +419,17 @@ RadioState_t SX1276GetStatus( void )
 void SX1276SetChannel( uint32_t freq )
 {
     uint32_t channel;
+    uint8_t frf[3];
 
     SX1276.Settings.Channel = freq;
 
     SX_FREQ_TO_CHANNEL( channel, freq );
 
-    SX1276Write( REG_FRFMSB, ( uint8_t )( ( channel >> 16 ) & 0xFF ) );
-    SX1276Write( REG_FRFMID, ( uint8_t )( ( channel >> 8 ) & 0xFF ) );
-    SX1276Write( REG_FRFLSB, ( uint8_t )( channel & 0xFF ) );
+    // REG_FRFMSB, REG_FRFMID and REG_FRFLSB in a single burst
+    frf[0] = ( uint8_t )( ( channel >> 16 ) & 0xFF );
+    frf[1] = ( uint8_t )( ( channel >> 8 ) & 0xFF );
+    frf[2] = ( uint8_t )( channel & 0xFF );
+    SX1276WriteBuffer( REG_FRFMSB, frf, 3 );
 }
 
 bool SX1276IsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
@@ -374,13 +509,15 @@ void RxChainCalibration( void )
     uint8_t regPaConfigInitVal;
     uint32_t initialFreq;
     uint32_t channel;
+    uint8_t frf[3];
 
     // Save context
     regPaConfigInitVal = SX1276Read( REG_PACONFIG );
 
-    channel = ( ( ( uint32_t )SX1276Read( REG_FRFMSB ) << 16 ) |
-                ( ( uint32_t )SX1276Read( REG_FRFMID ) << 8 ) |
-                ( ( uint32_t )SX1276Read( REG_FRFLSB ) ) );
+    SX1276ReadBuffer( REG_FRFMSB, frf, 3 );
+    channel = ( ( ( uint32_t )frf[0] << 16 ) |
+                ( ( uint32_t )frf[1] << 8 ) |
+                ( ( uint32_t )frf[2] ) );
 
     SX_CHANNEL_TO_FREQ(channel, initialFreq);
 
@@ -451,17 +588,16 @@ void SX1276SetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             SX1276.Settings.Fsk.IqInverted = iqInverted;
             SX1276.Settings.Fsk.RxContinuous = rxContinuous;
             SX1276.Settings.Fsk.PreambleLen = preambleLen;
-            SX1276.Settings.Fsk.RxSingleTimeout = ( uint32_t )( symbTimeout * ( ( 1.0 / ( double )datarate ) * 8.0 ) * 1000 );
+            // 1 symbol equals 1 byte: 8000 / datarate ms
+            SX1276.Settings.Fsk.RxSingleTimeout = ( ( uint32_t )symbTimeout * 8000 ) / datarate;
 
-            datarate = ( uint16_t )( ( double )XTAL_FREQ / ( double )datarate );
-            SX1276Write( REG_BITRATEMSB, ( uint8_t )( datarate >> 8 ) );
-            SX1276Write( REG_BITRATELSB, ( uint8_t )( datarate & 0xFF ) );
+            datarate = ( uint16_t )( XTAL_FREQ / datarate );
+            SX1276WriteWord( REG_BITRATEMSB, datarate );
 
             SX1276Write( REG_RXBW, GetFskBandwidthRegValue( bandwidth ) );
             SX1276Write( REG_AFCBW, GetFskBandwidthRegValue( bandwidthAfc ) );
 
-            SX1276Write( REG_PREAMBLEMSB, ( uint8_t )( ( preambleLen >> 8 ) & 0xFF ) );
-            SX1276Write( REG_PREAMBLELSB, ( uint8_t )( preambleLen & 0xFF ) );
+            SX1276WriteWord( REG_PREAMBLEMSB, preambleLen );
 
             if( fixLen == 1 )
             {
@@ -543,8 +679,7 @@ void SX1276SetRxConfig( RadioModems_t modem, uint32_t bandwidth,
 
             SX1276Write( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( symbTimeout & 0xFF ) );
 
-            SX1276Write( REG_LR_PREAMBLEMSB, ( uint8_t )( ( preambleLen >> 8 ) & 0xFF ) );
-            SX1276Write( REG_LR_PREAMBLELSB, ( uint8_t )( preambleLen & 0xFF ) );
+            SX1276WriteWord( REG_LR_PREAMBLEMSB, preambleLen );
 
             if( fixLen == 1 )
             {
@@ -622,16 +757,14 @@ void SX1276SetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             SX1276.Settings.Fsk.IqInverted = iqInverted;
             SX1276.Settings.Fsk.TxTimeout = timeout;
 
-            fdev = ( uint16_t )( ( double )fdev / ( double )FREQ_STEP );
-            SX1276Write( REG_FDEVMSB, ( uint8_t )( fdev >> 8 ) );
-            SX1276Write( REG_FDEVLSB, ( uint8_t )( fdev & 0xFF ) );
+            // FREQ_STEP = FREQ_STEP_8 / 256
+            fdev = ( uint16_t )( ( fdev << 8 ) / FREQ_STEP_8 );
+            SX1276WriteWord( REG_FDEVMSB, fdev );
 
-            datarate = ( uint16_t )( ( double )XTAL_FREQ / ( double )datarate );
-            SX1276Write( REG_BITRATEMSB, ( uint8_t )( datarate >> 8 ) );
-            SX1276Write( REG_BITRATELSB, ( uint8_t )( datarate & 0xFF ) );
+            datarate = ( uint16_t )( XTAL_FREQ / datarate );
+            SX1276WriteWord( REG_BITRATEMSB, datarate );
 
-            SX1276Write( REG_PREAMBLEMSB, ( preambleLen >> 8 ) & 0x00FF );
-            SX1276Write( REG_PREAMBLELSB, preambleLen & 0xFF );
+            SX1276WriteWord( REG_PREAMBLEMSB, preambleLen );
 
             SX1276Write( REG_PACKETCONFIG1,
                          ( SX1276Read( REG_PACKETCONFIG1 ) &
@@ -705,8 +838,7 @@ void SX1276SetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
                            RFLR_MODEMCONFIG3_LOWDATARATEOPTIMIZE_MASK ) |
                            ( SX1276.Settings.LoRa.LowDatarateOptimize << 3 ) );
 
-            SX1276Write( REG_LR_PREAMBLEMSB, ( preambleLen >> 8 ) & 0x00FF );
-            SX1276Write( REG_LR_PREAMBLELSB, preambleLen & 0xFF );
+            SX1276WriteWord( REG_LR_PREAMBLEMSB, preambleLen );
 
             if( datarate == 6 )
             {
@@ -739,71 +871,40 @@ uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint8_t pktLen )
     {
     case MODEM_FSK:
         {
-            airTime = (uint32_t) round( ( 8 * ( SX1276.Settings.Fsk.PreambleLen +
-                                     ( ( SX1276Read( REG_SYNCCONFIG ) & ~RF_SYNCCONFIG_SYNCSIZE_MASK ) + 1 ) +
-                                     ( ( SX1276.Settings.Fsk.FixLen == 0x01 ) ? 0.0 : 1.0 ) +
-                                     ( ( ( SX1276Read( REG_PACKETCONFIG1 ) & ~RF_PACKETCONFIG1_ADDRSFILTERING_MASK ) != 0x00 ) ? 1.0 : 0 ) +
-                                     pktLen +
-                                     ( ( SX1276.Settings.Fsk.CrcOn == 0x01 ) ? 2.0 : 0 ) ) /
-                                     SX1276.Settings.Fsk.Datarate ) * 1000 );
+            uint32_t nBytes = SX1276.Settings.Fsk.PreambleLen +
+                              ( ( SX1276Read( REG_SYNCCONFIG ) & ~RF_SYNCCONFIG_SYNCSIZE_MASK ) + 1 ) +
+                              ( ( SX1276.Settings.Fsk.FixLen == 0x01 ) ? 0 : 1 ) +
+                              ( ( ( SX1276Read( REG_PACKETCONFIG1 ) & ~RF_PACKETCONFIG1_ADDRSFILTERING_MASK ) != 0x00 ) ? 1 : 0 ) +
+                              pktLen +
+                              ( ( SX1276.Settings.Fsk.CrcOn == 0x01 ) ? 2 : 0 );
+
+            // round( 8000 * nBytes / datarate ) ms, in integer arithmetic
+            airTime = ( 16000 * nBytes + SX1276.Settings.Fsk.Datarate ) / ( 2 * SX1276.Settings.Fsk.Datarate );
         }
         break;
     case MODEM_LORA:
         {
-            double bw = 0.0;
-            // REMARK: When using LoRa modem only bandwidths 125, 250 and 500 kHz are supported
-            switch( SX1276.Settings.LoRa.Bandwidth )
+            // REMARK: When using LoRa modem only bandwidths 125, 250 and 500 kHz are supported.
+            // Those are 125 kHz << bwShift, which makes the symbol time 2^SF / bw an exact
+            // 2^( SF - bwShift ) / 125000 s and lets the whole computation run on integers.
+            uint32_t bwShift = SX1276.Settings.LoRa.Bandwidth - 7;
+            int32_t payloadBits = 8 * pktLen - 4 * ( int32_t )SX1276.Settings.LoRa.Datarate +
+                                  28 + 16 * SX1276.Settings.LoRa.CrcOn -
+                                  ( SX1276.Settings.LoRa.FixLen ? 20 : 0 );
+            int32_t bitsPerBlock = 4 * ( SX1276.Settings.LoRa.Datarate -
+                                   ( ( SX1276.Settings.LoRa.LowDatarateOptimize > 0 ) ? 2 : 0 ) );
+            // Number of quarter symbols: preamble + 4.25 sync symbols + 8 header symbols
+            uint32_t nQuarterSymbols = 4 * SX1276.Settings.LoRa.PreambleLen + 17 + 4 * 8;
+
+            if( payloadBits > 0 )
             {
-            //case 0: // 7.8 kHz
-            //    bw = 7800;
-            //    break;
-            //case 1: // 10.4 kHz
-            //    bw = 10400;
-            //    break;
-            //case 2: // 15.6 kHz
-            //    bw = 15600;
-            //    break;
-            //case 3: // 20.8 kHz
-            //    bw = 20800;
-            //    break;
-            //case 4: // 31.2 kHz
-            //    bw = 31200;
-            //    break;
-            //case 5: // 41.4 kHz
-            //    bw = 41400;
-            //    break;
-            //case 6: // 62.5 kHz
-            //    bw = 62500;
-            //    break;
-            case 7: // 125 kHz
-                bw = 125000;
-                break;
-            case 8: // 250 kHz
-                bw = 250000;
-                break;
-            case 9: // 500 kHz
-                bw = 500000;
-                break;
+                // Symbol length of payload
+                nQuarterSymbols += 4 * ( ( payloadBits + bitsPerBlock - 1 ) / bitsPerBlock ) *
+                                   ( SX1276.Settings.LoRa.Coderate + 4 );
             }
-
-            // Symbol rate : time for one symbol (secs)
-            double rs = bw / ( 1 << SX1276.Settings.LoRa.Datarate );
-            double ts = 1 / rs;
-            // time of preamble
-            double tPreamble = ( SX1276.Settings.LoRa.PreambleLen + 4.25 ) * ts;
-            // Symbol length of payload and time
-            double tmp = ceil( ( 8 * pktLen - 4 * SX1276.Settings.LoRa.Datarate +
-                                 28 + 16 * SX1276.Settings.LoRa.CrcOn -
-                                 ( SX1276.Settings.LoRa.FixLen ? 20 : 0 ) ) /
-                                 ( double )( 4 * ( SX1276.Settings.LoRa.Datarate -
-                                 ( ( SX1276.Settings.LoRa.LowDatarateOptimize > 0 ) ? 2 : 0 ) ) ) ) *
-                                 ( SX1276.Settings.LoRa.Coderate + 4 );
-            double nPayload = 8 + ( ( tmp > 0 ) ? tmp : 0 );
-            double tPayload = nPayload * ts;
-            // Time on air
-            double tOnAir = tPreamble + tPayload;
-            // return ms secs
-            airTime = (uint32_t) floor( tOnAir * 1000 + 0.999 );
+            // Time on air rounded up to the next ms:
+            // nQuarterSymbols / 4 * 2^SF / ( 125000 << bwShift ) * 1000 = ( nQuarterSymbols << ( SF - bwShift ) ) / 500
+            airTime = ( ( nQuarterSymbols << ( SX1276.Settings.LoRa.Datarate - bwShift ) ) + 499 ) / 500;
         }
         break;
     }
@@ -890,6 +991,7 @@ void SX1276SetSleep( void )
     TimerStop( &TxTimeoutTimer );
 
     SX1276SetOpMode( RF_OPMODE_SLEEP );
+    FskStreamEnd( );
     SX1276.Settings.State = RF_IDLE;
 }
 
@@ -899,6 +1001,7 @@ void SX1276SetStby( void )
     TimerStop( &TxTimeoutTimer );
 
     SX1276SetOpMode( RF_OPMODE_STANDBY );
+    FskStreamEnd( );
     SX1276.Settings.State = RF_IDLE;
 }
 
@@ -1231,6 +1334,9 @@ void SX1276Reset( void )
 
     // Wait 6 ms
     DelayMs( 6 );
+
+    // The registers are back to their reset values
+    ShadowInvalidate( 0, SHADOW_SIZE - 1 );
 }
 
 void SX1276SetOpMode( uint8_t opMode )
@@ -1304,39 +1410,285 @@ uint8_t SX1276Read( uint8_t addr )
     return data;
 }
 
-void SX1276WriteBuffer( uint8_t addr, uint8_t *buffer, uint8_t size )
+static bool ShadowIsCached( uint8_t addr )
 {
+    switch( addr )
+    {
+    // Common registers. REG_OPMODE mode bits hold the last requested mode:
+    // the radio may fall back to standby on its own, but never to sleep
+    case REG_OPMODE:
+    case REG_BITRATEMSB:
+    case REG_BITRATELSB:
+    case REG_FDEVMSB:
+    case REG_FDEVLSB:
+    case REG_FRFMSB:
+    case REG_FRFMID:
+    case REG_FRFLSB:
+    case REG_PACONFIG:
+    case REG_PARAMP:
+    case REG_OCP:
+    case REG_DIOMAPPING1:
+    case REG_DIOMAPPING2:
+    case REG_PLLHOP:
+    case REG_TCXO:
+    case REG_PADAC:
+    case REG_BITRATEFRAC:
+    case REG_AGCREF:
+    case REG_AGCTHRESH1:
+    case REG_AGCTHRESH2:
+    case REG_AGCTHRESH3:
+        return true;
+    default:
+        break;
+    }
+
+    if( SX1276.Settings.Modem == MODEM_LORA )
+    {
+        switch( addr )
+        {
+        case REG_LR_FIFOTXBASEADDR:
+        case REG_LR_FIFORXBASEADDR:
+        case REG_LR_IRQFLAGSMASK:
+        case REG_LR_MODEMCONFIG1:
+        case REG_LR_MODEMCONFIG2:
+        case REG_LR_SYMBTIMEOUTLSB:
+        case REG_LR_PREAMBLEMSB:
+        case REG_LR_PREAMBLELSB:
+        case REG_LR_PAYLOADLENGTH:
+        case REG_LR_PAYLOADMAXLENGTH:
+        case REG_LR_HOPPERIOD:
+        case REG_LR_MODEMCONFIG3:
+        case REG_LR_DETECTOPTIMIZE:
+        case REG_LR_INVERTIQ:
+        case REG_LR_DETECTIONTHRESHOLD:
+        case REG_LR_SYNCWORD:
+        case REG_LR_INVERTIQ2:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // FSK registers, without the ones holding start triggers (REG_RXCONFIG,
+    // REG_AFCFEI, REG_OSC, REG_SEQCONFIG1, REG_IMAGECAL)
+    switch( addr )
+    {
+    case REG_RSSICONFIG:
+    case REG_RSSICOLLISION:
+    case REG_RSSITHRESH:
+    case REG_RXBW:
+    case REG_AFCBW:
+    case REG_OOKPEAK:
+    case REG_OOKFIX:
+    case REG_OOKAVG:
+    case REG_PREAMBLEDETECT:
+    case REG_RXTIMEOUT1:
+    case REG_RXTIMEOUT2:
+    case REG_RXTIMEOUT3:
+    case REG_RXDELAY:
+    case REG_PREAMBLEMSB:
+    case REG_PREAMBLELSB:
+    case REG_SYNCCONFIG:
+    case REG_SYNCVALUE1:
+    case REG_SYNCVALUE2:
+    case REG_SYNCVALUE3:
+    case REG_SYNCVALUE4:
+    case REG_SYNCVALUE5:
+    case REG_SYNCVALUE6:
+    case REG_SYNCVALUE7:
+    case REG_SYNCVALUE8:
+    case REG_PACKETCONFIG1:
+    case REG_PACKETCONFIG2:
+    case REG_PAYLOADLENGTH:
+    case REG_NODEADRS:
+    case REG_BROADCASTADRS:
+    case REG_FIFOTHRESH:
+    case REG_SEQCONFIG2:
+    case REG_TIMERRESOL:
+    case REG_TIMER1COEF:
+    case REG_TIMER2COEF:
+    case REG_LOWBAT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void ShadowInvalidate( uint8_t first, uint8_t last )
+{
+    uint8_t addr;
+
+    for( addr = first; addr <= last; addr++ )
+    {
+        RegShadowValid[addr >> 5] &= ~( 1UL << ( addr & 0x1F ) );
+    }
+}
+
+static bool ShadowWrite( uint8_t addr, uint8_t *buffer, uint8_t size )
+{
+    bool changed = false;
+    uint8_t reg;
     uint8_t i;
 
-    //NSS = 0;
-    HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 0 );
+    if( addr == REG_FIFO )
+    {
+        return true;
+    }
 
-    HW_SPI_InOut( addr | 0x80 );
     for( i = 0; i < size; i++ )
     {
-        HW_SPI_InOut( buffer[i] );
+        reg = addr + i;
+        if( ( reg >= SHADOW_SIZE ) || ( ShadowIsCached( reg ) == false ) )
+        {
+            changed = true;
+            continue;
+        }
+
+        if( ( RegShadowValid[reg >> 5] & ( 1UL << ( reg & 0x1F ) ) ) == 0 )
+        {
+            changed = true;
+        }
+        else if( RegShadow[reg] != buffer[i] )
+        {
+            changed = true;
+        }
+
+        if( reg == REG_OPMODE )
+        {
+            // The radio may have left the shadowed mode, always write it
+            changed = true;
+            if( ( ( RegShadowValid[0] & ( 1UL << REG_OPMODE ) ) == 0 ) ||
+                ( ( ( RegShadow[REG_OPMODE] ^ buffer[i] ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 ) )
+            {
+                // Modem change: registers 0x0D to 0x3F switch to the other page
+                ShadowInvalidate( REG_LR_FIFOADDRPTR, REG_IRQFLAGS2 );
+            }
+        }
+
+        RegShadow[reg] = buffer[i];
+        RegShadowValid[reg >> 5] |= 1UL << ( reg & 0x1F );
     }
+    return changed;
+}
 
-    //NSS = 1;
-    HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 1 );
+static bool ShadowRead( uint8_t addr, uint8_t *buffer, uint8_t size )
+{
+    uint8_t reg;
+    uint8_t i;
+
+    if( addr == REG_FIFO )
+    {
+        return false;
+    }
+
+    for( i = 0; i < size; i++ )
+    {
+        reg = addr + i;
+        if( ( reg >= SHADOW_SIZE ) || ( ShadowIsCached( reg ) == false ) ||
+            ( ( RegShadowValid[reg >> 5] & ( 1UL << ( reg & 0x1F ) ) ) == 0 ) )
+        {
+            return false;
+        }
+    }
+
+    for( i = 0; i < size; i++ )
+    {
+        buffer[i] = RegShadow[addr + i];
+    }
+    return true;
 }
 
-void SX1276ReadBuffer( uint8_t addr, uint8_t *buffer, uint8_t size )
+static void ShadowFill( uint8_t addr, uint8_t *buffer, uint8_t size )
 {
+    uint8_t reg;
     uint8_t i;
 
+    if( addr == REG_FIFO )
+    {
+        return;
+    }
+
+    for( i = 0; i < size; i++ )
+    {
+        reg = addr + i;
+        if( ( reg < SHADOW_SIZE ) && ( ShadowIsCached( reg ) == true ) )
+        {
+            RegShadow[reg] = buffer[i];
+            RegShadowValid[reg >> 5] |= 1UL << ( reg & 0x1F );
+        }
+    }
+}
+
+static void SX1276WriteWord( uint8_t addr, uint16_t data )
+{
+    uint8_t buffer[2];
+
+    buffer[0] = ( uint8_t )( data >> 8 );
+    buffer[1] = ( uint8_t )( data & 0xFF );
+    SX1276WriteBuffer( addr, buffer, 2 );
+}
+
+static uint16_t SX1276ReadWord( uint8_t addr )
+{
+    uint8_t buffer[2];
+
+    SX1276ReadBuffer( addr, buffer, 2 );
+    return ( ( uint16_t )buffer[0] << 8 ) | buffer[1];
+}
+
+void SX1276WriteBuffer( uint8_t addr, uint8_t *buffer, uint8_t size )
+{
+    // The MAC accesses the radio both from the main loop and from the timer
+    // interrupt: each SPI transaction, with its shadow update, is atomic
+    BACKUP_PRIMASK();
+
+    DISABLE_IRQ( );
+
+    if( ShadowWrite( addr, buffer, size ) == false )
+    {
+        // The radio already holds these values
+        RESTORE_PRIMASK( );
+        return;
+    }
+
     //NSS = 0;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 0 );
 
-    HW_SPI_InOut( addr & 0x7F );
+    HW_SPI_InOut( addr | 0x80 );
+    // The radio auto-increments the address (except on the FIFO): one burst
+    HW_SPI_Transfer( buffer, NULL, size );
 
-    for( i = 0; i < size; i++ )
+    //NSS = 1;
+    HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 1 );
+
+    RESTORE_PRIMASK( );
+}
+
+void SX1276ReadBuffer( uint8_t addr, uint8_t *buffer, uint8_t size )
+{
+    BACKUP_PRIMASK();
+
+    DISABLE_IRQ( );
+
+    if( ShadowRead( addr, buffer, size ) == true )
     {
-        buffer[i] = HW_SPI_InOut( 0 );
+        RESTORE_PRIMASK( );
+        return;
     }
 
+    //NSS = 0;
+    HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 0 );
+
+    HW_SPI_InOut( addr & 0x7F );
+    // The radio auto-increments the address (except on the FIFO): one burst
+    HW_SPI_Transfer( NULL, buffer, size );
+
     //NSS = 1;
     HW_GPIO_Write( RADIO_NSS_PORT, RADIO_NSS_PIN, 1 );
+
+    ShadowFill( addr, buffer, size );
+
+    RESTORE_PRIMASK( );
 }
 
 void SX1276WriteFifo( uint8_t *buffer, uint8_t size )
@@ -1388,6 +1740,271 @@ uint32_t SX1276GetRadioWakeUpTime( void )
     return ( uint32_t )LoRaBoardCallbacks->SX1276BoardGetWakeTime( ) + RADIO_WAKEUP_TIME;// BOARD_WAKEUP_TIME;
 }
 
+void SX1276FskStreamInit( RadioFskStreamEvents_t *events )
+{
+    FskStreamEvents = events;
+}
+
+bool SX1276FskStreamSend( uint32_t size, uint32_t timeout )
+{
+    bool variable;
+    uint8_t length;
+
+    if( ( SX1276.Settings.Modem != MODEM_FSK ) || ( SX1276.Settings.State != RF_IDLE ) ||
+        ( FskStreamEvents == NULL ) || ( FskStreamEvents->TxChunk == NULL ) || ( size == 0 ) )
+    {
+        return false;
+    }
+
+    // FIFO operations can not take place in Sleep mode
+    if( ( SX1276Read( REG_OPMODE ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
+    {
+        SX1276SetStby( );
+        DelayMs( 1 );
+    }
+
+    variable = ( SX1276.Settings.Fsk.FixLen == false ) && ( size <= 0xFF );
+    FskStreamStart( size, variable );
+
+    if( variable == true )
+    {
+        length = ( uint8_t )size;
+        SX1276WriteFifo( &length, 1 );
+        FskStreamFill( SX1276_FSK_FIFO_SIZE - 1 );
+    }
+    else
+    {
+        FskStreamFill( SX1276_FSK_FIFO_SIZE );
+    }
+
+    SX1276SetTx( ( timeout != 0 ) ? timeout : SX1276.Settings.Fsk.TxTimeout );
+    return true;
+}
+
+bool SX1276FskStreamRx( uint32_t size, uint32_t timeout )
+{
+    if( ( SX1276.Settings.Modem != MODEM_FSK ) || ( SX1276.Settings.State != RF_IDLE ) ||
+        ( FskStreamEvents == NULL ) || ( FskStreamEvents->RxChunk == NULL ) )
+    {
+        return false;
+    }
+
+    FskStreamStart( size, size == 0 );
+    SX1276SetRx( timeout );
+    return true;
+}
+
+void SX1276FskStreamSetRxSize( uint32_t size )
+{
+    SX1276.Settings.FskStreamHandler.Size = size;
+}
+
+static void FskStreamStart( uint32_t size, bool variable )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+    uint16_t length;
+
+    stream->SavedPacketConfig1 = SX1276Read( REG_PACKETCONFIG1 );
+    stream->SavedPacketConfig2 = SX1276Read( REG_PACKETCONFIG2 );
+    stream->SavedPayloadLength = SX1276Read( REG_PAYLOADLENGTH );
+    stream->SavedFifoThresh = SX1276Read( REG_FIFOTHRESH );
+
+    stream->Size = size;
+    stream->NbBytes = 0;
+    stream->LengthPending = variable;
+    stream->Drained = false;
+    stream->Unlimited = ( variable == false ) && ( size > SX1276_FSK_FIXED_LENGTH_MAX );
+
+    // 11 bits payload length, 0 selects the unlimited length format
+    if( variable == true )
+    {
+        length = 0xFF;
+    }
+    else
+    {
+        length = ( stream->Unlimited == true ) ? 0 : ( uint16_t )size;
+    }
+    SX1276Write( REG_PACKETCONFIG1, ( stream->SavedPacketConfig1 & RF_PACKETCONFIG1_PACKETFORMAT_MASK ) |
+                                    ( ( variable == true ) ? RF_PACKETCONFIG1_PACKETFORMAT_VARIABLE :
+                                                             RF_PACKETCONFIG1_PACKETFORMAT_FIXED ) );
+    SX1276Write( REG_PACKETCONFIG2, ( stream->SavedPacketConfig2 & RF_PACKETCONFIG2_PAYLOADLENGTH_MSB_MASK ) |
+                                    ( ( length >> 8 ) & 0x07 ) );
+    SX1276Write( REG_PAYLOADLENGTH, ( uint8_t )( length & 0xFF ) );
+
+    stream->FifoThresh = SX1276_FSK_STREAM_FIFO_THRESH;
+    SX1276Write( REG_FIFOTHRESH, ( stream->SavedFifoThresh & RF_FIFOTHRESH_FIFOTHRESHOLD_MASK ) | stream->FifoThresh );
+
+    stream->Active = true;
+}
+
+static void FskStreamEnd( void )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+
+    if( stream->Active == false )
+    {
+        return;
+    }
+    stream->Active = false;
+    stream->Drained = false;
+
+    // The FSK page is not mapped while the LoRa modem is selected
+    if( SX1276.Settings.Modem == MODEM_FSK )
+    {
+        SX1276Write( REG_PACKETCONFIG1, stream->SavedPacketConfig1 );
+        SX1276Write( REG_PACKETCONFIG2, stream->SavedPacketConfig2 );
+        SX1276Write( REG_PAYLOADLENGTH, stream->SavedPayloadLength );
+        SX1276Write( REG_FIFOTHRESH, stream->SavedFifoThresh );
+    }
+}
+
+static void FskStreamFill( uint8_t room )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+    uint32_t remaining = stream->Size - stream->NbBytes;
+    uint8_t chunk = ( remaining < room ) ? ( uint8_t )remaining : room;
+
+    if( chunk > 0 )
+    {
+        FskStreamEvents->TxChunk( RxTxBuffer, chunk, stream->NbBytes );
+        // One burst, through the SPI DMA when enabled
+        SX1276WriteFifo( RxTxBuffer, chunk );
+        stream->NbBytes += chunk;
+    }
+}
+
+static void FskStreamRead( uint8_t count )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+    uint32_t remaining;
+    uint8_t length;
+    uint8_t chunk;
+
+    if( ( stream->LengthPending == true ) && ( count > 0 ) )
+    {
+        SX1276ReadFifo( &length, 1 );
+        stream->Size = length;
+        stream->LengthPending = false;
+        count--;
+    }
+
+    remaining = stream->Size - stream->NbBytes;
+    chunk = ( remaining < count ) ? ( uint8_t )remaining : count;
+    if( chunk > 0 )
+    {
+        // One burst, through the SPI DMA when enabled
+        SX1276ReadFifo( RxTxBuffer, chunk );
+        stream->NbBytes += chunk;
+        FskStreamEvents->RxChunk( RxTxBuffer, chunk, stream->NbBytes - chunk );
+    }
+
+    // SX1276FskStreamSetRxSize may have given a size already reached
+    if( stream->Size < stream->NbBytes )
+    {
+        stream->Size = stream->NbBytes;
+    }
+}
+
+static void FskStreamRxDone( void )
+{
+    uint32_t size = SX1276.Settings.FskStreamHandler.NbBytes;
+
+    TimerStop( &RxTimeoutSyncWord );
+    // Also stops the unlimited length receptions, which never end on their own
+    SX1276SetStby( );
+
+    SX1276.Settings.FskPacketHandler.PreambleDetected = false;
+    SX1276.Settings.FskPacketHandler.SyncWordDetected = false;
+
+    if( ( FskStreamEvents != NULL ) && ( FskStreamEvents->RxDone != NULL ) )
+    {
+        FskStreamEvents->RxDone( size, SX1276.Settings.FskPacketHandler.RssiValue );
+    }
+}
+
+static void FskStreamOnFifoLevel( void )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+    uint32_t remaining;
+
+    // DIO1 is raised by more than FifoThresh bytes. It only rises again once
+    // the FIFO went below the level, so the bytes received during a burst
+    // are read in the same interrupt
+    do
+    {
+        FskStreamRead( stream->FifoThresh + 1 );
+
+        remaining = stream->Size - stream->NbBytes;
+        if( remaining == 0 )
+        {
+            if( stream->Unlimited == true )
+            {
+                FskStreamRxDone( );
+            }
+            // The packet formats end on PayloadReady, with the CRC check
+            return;
+        }
+
+        if( ( stream->Unlimited == true ) && ( remaining <= stream->FifoThresh ) )
+        {
+            // Nothing follows the packet: its last bytes raise FifoLevel
+            stream->FifoThresh = remaining - 1;
+            SX1276Write( REG_FIFOTHRESH, ( stream->SavedFifoThresh & RF_FIFOTHRESH_FIFOTHRESHOLD_MASK ) | stream->FifoThresh );
+        }
+    }
+    while( ( SX1276Read( REG_IRQFLAGS2 ) & RF_IRQFLAGS2_FIFOLEVEL ) == RF_IRQFLAGS2_FIFOLEVEL );
+}
+
+static void FskStreamOnPayloadReady( void )
+{
+    if( ( SX1276.Settings.Fsk.CrcOn == true ) &&
+        ( ( SX1276Read( REG_IRQFLAGS2 ) & RF_IRQFLAGS2_CRCOK ) != RF_IRQFLAGS2_CRCOK ) )
+    {
+        // Clear Irqs
+        SX1276Write( REG_IRQFLAGS1, RF_IRQFLAGS1_RSSI |
+                                    RF_IRQFLAGS1_PREAMBLEDETECT |
+                                    RF_IRQFLAGS1_SYNCADDRESSMATCH );
+        SX1276Write( REG_IRQFLAGS2, RF_IRQFLAGS2_FIFOOVERRUN );
+
+        TimerStop( &RxTimeoutSyncWord );
+        SX1276SetStby( );
+
+        SX1276.Settings.FskPacketHandler.PreambleDetected = false;
+        SX1276.Settings.FskPacketHandler.SyncWordDetected = false;
+
+        // The chunks already handed out are to be dropped
+        if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
+        {
+            RadioEvents->RxError( );
+        }
+        return;
+    }
+
+    // The end of the packet is in the FIFO
+    FskStreamRead( SX1276_FSK_FIFO_SIZE );
+    FskStreamRxDone( );
+}
+
+static void FskStreamOnFifoEmpty( void )
+{
+    RadioFskStreamHandler_t *stream = &SX1276.Settings.FskStreamHandler;
+
+    if( stream->NbBytes < stream->Size )
+    {
+        // The last byte is still being shifted out, the FIFO is refilled in one burst
+        FskStreamFill( SX1276_FSK_FIFO_SIZE );
+    }
+    else if( ( stream->Unlimited == true ) && ( stream->Drained == false ) )
+    {
+        // No PacketSent in the unlimited length format: TxDone is given once
+        // the last byte and the ramp down are out, within two bytes
+        stream->Drained = true;
+        TimerStop( &TxTimeoutTimer );
+        TimerSetValue( &TxTimeoutTimer, ( 16000 + SX1276.Settings.Fsk.Datarate - 1 ) / SX1276.Settings.Fsk.Datarate + 1 );
+        TimerStart( &TxTimeoutTimer );
+    }
+}
+
 void SX1276OnTimeoutIrq( void )
 {
     switch( SX1276.Settings.State )
@@ -1406,7 +2023,13 @@ void SX1276OnTimeoutIrq( void )
                                         RF_IRQFLAGS1_SYNCADDRESSMATCH );
             SX1276Write( REG_IRQFLAGS2, RF_IRQFLAGS2_FIFOOVERRUN );
 
-            if( SX1276.Settings.Fsk.RxContinuous == true )
+            if( SX1276.Settings.FskStreamHandler.Active == true )
+            {
+                // The stream receptions are single
+                TimerStop( &RxTimeoutSyncWord );
+                SX1276SetStby( );
+            }
+            else if( SX1276.Settings.Fsk.RxContinuous == true )
             {
                 // Continuous mode restart Rx chain
                 SX1276Write( REG_RXCONFIG, SX1276Read( REG_RXCONFIG ) | RF_RXCONFIG_RESTARTRXWITHOUTPLLLOCK );
@@ -1424,6 +2047,17 @@ void SX1276OnTimeoutIrq( void )
         }
         break;
     case RF_TX_RUNNING:
+        if( SX1276.Settings.FskStreamHandler.Drained == true )
+        {
+            // End of an unlimited length stream transmission
+            SX1276SetStby( );
+            if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
+            {
+                RadioEvents->TxDone( );
+            }
+            break;
+        }
+
         // Tx timeout shouldn't happen.
         // But it has been observed that when it happens it is a result of a corrupted SPI transfer
         // it depends on the platform design.
@@ -1432,7 +2066,9 @@ void SX1276OnTimeoutIrq( void )
 
         // BEGIN WORKAROUND
 
-        // Reset the radio
+        // Reset the radio, and with it the packet format of a stream
+        SX1276.Settings.FskStreamHandler.Active = false;
+        SX1276.Settings.FskStreamHandler.Drained = false;
         SX1276Reset( );
 
         // Calibrate Rx chain
@@ -1475,6 +2111,12 @@ void SX1276OnDio0Irq( void )
             switch( SX1276.Settings.Modem )
             {
             case MODEM_FSK:
+                if( SX1276.Settings.FskStreamHandler.Active == true )
+                {
+                    FskStreamOnPayloadReady( );
+                    break;
+                }
+
                 if( SX1276.Settings.Fsk.CrcOn == true )
                 {
                     irqFlags = SX1276Read( REG_IRQFLAGS2 );
@@ -1652,6 +2294,8 @@ void SX1276OnDio0Irq( void )
                 // Intentional fall through
             case MODEM_FSK:
             default:
+                // Restores the packet format after a stream
+                FskStreamEnd( );
                 SX1276.Settings.State = RF_IDLE;
                 if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
                 {
@@ -1675,6 +2319,12 @@ void SX1276OnDio1Irq( void )
             {
             case MODEM_FSK:
                 // FifoLevel interrupt
+                if( SX1276.Settings.FskStreamHandler.Active == true )
+                {
+                    FskStreamOnFifoLevel( );
+                    break;
+                }
+
                 // Read received packet size
                 if( ( SX1276.Settings.FskPacketHandler.Size == 0 ) && ( SX1276.Settings.FskPacketHandler.NbBytes == 0 ) )
                 {
@@ -1721,6 +2371,12 @@ void SX1276OnDio1Irq( void )
             {
             case MODEM_FSK:
                 // FifoEmpty interrupt
+                if( SX1276.Settings.FskStreamHandler.Active == true )
+                {
+                    FskStreamOnFifoEmpty( );
+                    break;
+                }
+
                 if( ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes ) > SX1276.Settings.FskPacketHandler.ChunkSize )
                 {
                     SX1276WriteFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.ChunkSize );
@@ -1767,8 +2423,7 @@ void SX1276OnDio2Irq( void )
 
                     SX1276.Settings.FskPacketHandler.RssiValue = -( SX1276Read( REG_RSSIVALUE ) >> 1 );
 
-                    afcChannel = ( ( ( uint16_t )SX1276Read( REG_AFCMSB ) << 8 ) |
-                                     ( uint16_t )SX1276Read( REG_AFCLSB ) );
+                    afcChannel = SX1276ReadWord( REG_AFCMSB );
 
                     SX_CHANNEL_TO_FREQ( afcChannel, SX1276.Settings.FskPacketHandler.AfcValue );
 
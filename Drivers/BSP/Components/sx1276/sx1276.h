@@ -138,6 +138,81 @@ typedef struct
     uint8_t Size;
 }RadioLoRaPacketHandler_t;
 
+/*!
+ * Size of the FSK FIFO
+ */
+#define SX1276_FSK_FIFO_SIZE                        64
+
+/*!
+ * Longest payload of the FSK fixed length packet format (11 bits length),
+ * longer streams use the unlimited length format
+ */
+#define SX1276_FSK_FIXED_LENGTH_MAX                 2047
+
+/*!
+ * FIFO level of the FSK stream receptions: the FIFO is read in bursts of
+ * SX1276_FSK_STREAM_FIFO_THRESH + 1 bytes, above the SPI DMA threshold
+ */
+#define SX1276_FSK_STREAM_FIFO_THRESH               47
+
+/*!
+ * Size of a FSK stream reception whose length is carried by the payload,
+ * see SX1276FskStreamSetRxSize
+ */
+#define SX1276_FSK_STREAM_SIZE_UNKNOWN              0xFFFFFFFF
+
+/*!
+ * Radio FSK stream callbacks, called from the DIO IRQ handlers
+ *
+ * \remark The timeouts and the CRC errors are still reported through the
+ *         RadioEvents_t callbacks given to SX1276Init
+ */
+typedef struct
+{
+    /*!
+     * \brief  Bytes of the packet being received, as soon as they are read
+     *         from the FIFO
+     *
+     * \param [IN] chunk  Received bytes, valid during the call only
+     * \param [IN] size   Number of bytes
+     * \param [IN] offset Position of the first byte in the packet
+     */
+    void    ( *RxChunk )( uint8_t *chunk, uint16_t size, uint32_t offset );
+    /*!
+     * \brief  End of the reception, the CRC (packet formats) is correct
+     *
+     * \param [IN] size Number of bytes of the packet
+     * \param [IN] rssi RSSI value computed while receiving the sync word [dBm]
+     */
+    void    ( *RxDone )( uint32_t size, int16_t rssi );
+    /*!
+     * \brief  Asks the next bytes of the packet being sent
+     *
+     * \param [OUT] chunk  Buffer to fill with exactly size bytes
+     * \param [IN]  size   Number of bytes
+     * \param [IN]  offset Position of the first byte in the packet
+     */
+    void    ( *TxChunk )( uint8_t *chunk, uint16_t size, uint32_t offset );
+}RadioFskStreamEvents_t;
+
+/*!
+ * Radio FSK stream state
+ */
+typedef struct
+{
+    bool     Active;
+    bool     Unlimited;
+    bool     LengthPending;
+    bool     Drained;
+    uint32_t Size;
+    uint32_t NbBytes;
+    uint8_t  FifoThresh;
+    uint8_t  SavedPacketConfig1;
+    uint8_t  SavedPacketConfig2;
+    uint8_t  SavedPayloadLength;
+    uint8_t  SavedFifoThresh;
+}RadioFskStreamHandler_t;
+
 /*!
  * Radio Settings
  */
@@ -148,6 +223,7 @@ typedef struct
     uint32_t                 Channel;
     RadioFskSettings_t       Fsk;
     RadioFskPacketHandler_t  FskPacketHandler;
+    RadioFskStreamHandler_t  FskStreamHandler;
     RadioLoRaSettings_t      LoRa;
     RadioLoRaPacketHandler_t LoRaPacketHandler;
 }RadioSettings_t;
@@ -550,4 +626,59 @@ void SX1276SetPublicNetwork( bool enable );
  */
 uint32_t SX1276GetRadioWakeUpTime( void );
 
+/*!
+ * \brief Sets the callbacks of the FSK streams
+ *
+ * \remark The streams are specific to the SX1276 and are not part of the
+ *         Radio_s interface
+ *
+ * \param [IN] events Stream callbacks, NULL disables the streams
+ */
+void SX1276FskStreamInit( RadioFskStreamEvents_t *events );
+
+/*!
+ * \brief Sends a FSK packet whose payload is supplied chunk by chunk
+ *
+ * \remark The payload is asked to the TxChunk callback by FIFO loads of up
+ *         to SX1276_FSK_FIFO_SIZE bytes, refilled on FifoEmpty. The packet
+ *         format follows the size:
+ *         - up to 255 bytes with the variable length configuration: a length
+ *           byte comes first
+ *         - up to SX1276_FSK_FIXED_LENGTH_MAX bytes: fixed length format
+ *         - longer: unlimited length format, neither the length nor the CRC
+ *           are handled by the radio, TxDone comes two bytes after the FIFO
+ *           is drained
+ *
+ * \param [IN] size    Payload size [bytes]
+ * \param [IN] timeout Transmission timeout [ms], 0 for the one of SX1276SetTxConfig
+ * \retval status      [true: started, false: not FSK, busy or no TxChunk callback]
+ */
+bool SX1276FskStreamSend( uint32_t size, uint32_t timeout );
+
+/*!
+ * \brief Receives a FSK packet and hands it out chunk by chunk
+ *
+ * \remark The FIFO is read in bursts on the FifoLevel interrupt, each one
+ *         given to the RxChunk callback. The reception is single: the radio
+ *         goes to standby when it ends.
+ *
+ * \param [IN] size    0 for the variable length format, the packet size for
+ *                     the fixed one, above SX1276_FSK_FIXED_LENGTH_MAX or
+ *                     SX1276_FSK_STREAM_SIZE_UNKNOWN for the unlimited one
+ * \param [IN] timeout Reception timeout [ms], 0 for none
+ * \retval status      [true: started, false: not FSK, busy or no RxChunk callback]
+ */
+bool SX1276FskStreamRx( uint32_t size, uint32_t timeout );
+
+/*!
+ * \brief Sets the size of an unlimited length reception, once the payload
+ *        header giving it has been received
+ *
+ * \remark To be called from the RxChunk callback. The bytes of the current
+ *         chunk past the size are not part of the packet.
+ *
+ * \param [IN] size Packet size [bytes]
+ */
+void SX1276FskStreamSetRxSize( uint32_t size );
+
 #endif /* __SX1276_H__ */
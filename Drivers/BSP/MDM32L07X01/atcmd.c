@@ -52,6 +52,10 @@
 /* External variables --------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define BIN_COBS_MAX_SIZE   (BIN_FRAME_MAX_SIZE + (BIN_FRAME_MAX_SIZE / 254) + 3)
+                                              /*COBS frame between two 0x00*/
+
+#define BIN_RESPONSE_TIMEOUT   5000           /*ms - a frame with a bad CRC is dropped*/
 
 
 /* Private macro -------------------------------------------------------------*/
@@ -69,6 +73,35 @@ static char response[DATA_RX_MAX_BUFF_SIZE];  /*has to be the largest of the res
                                             /*not only for return code but also for*/
                                             /*return value: exemple KEY*/
 
+static uint8_t BinMode = 0;   /*binary frames once AT+BINMODE has been accepted*/
+
+static uint8_t BinSeq = 0;    /*sequence number of the last cmd frame*/
+
+static uint8_t BinTxFrame[BIN_FRAME_MAX_SIZE];  /*cmd frame being built*/
+
+static uint16_t BinTxSize;
+
+static uint8_t BinCobs[BIN_COBS_MAX_SIZE];      /*cmd frame COBS encoded*/
+
+static uint8_t BinRxFrame[BIN_COBS_MAX_SIZE];   /*received frame, decoded in place*/
+
+static uint16_t BinRxSize = 0;
+
+static uint8_t BinRxOverflow = 0;
+
+static struct {
+  uint8_t Pending;                          /*one bit per ATBinEvent_t*/
+  uint8_t RxPort;
+  uint8_t RxSize;
+  uint8_t RxData[DATA_RX_MAX_BUFF_SIZE];
+  uint8_t TxAck;
+} BinEvents;                                /*events received, not yet got*/
+
+/* CRC16-CCITT of each nibble, poly 0x1021 */
+static const uint16_t Crc16Nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
 /****************************************************************************/
 /*here we have to include a list of AT cmd by the way of #include<file>     */
 /*this file will be preprocessed for CmdTab and ATE_RetCode definition      */
@@ -93,6 +126,22 @@ static ATEerror_t at_cmd_receive(void *pdata);
 
 static ATEerror_t at_cmd_responseAnalysing(const char *ReturnResp);
 
+static ATEerror_t at_cmd_bin(ATGroup_t at_group, ATCmd_t Cmd, void *pdata);
+
+static void at_cmd_bin_add(uint8_t Type, const void *Value, uint8_t Len);
+
+static HAL_StatusTypeDef at_cmd_bin_send(void);
+
+static ATEerror_t at_cmd_bin_receive(void *pdata);
+
+static int16_t at_cmd_bin_poll(void);
+
+static int16_t at_cmd_bin_decode(void);
+
+static const uint8_t *at_cmd_bin_tlv(int16_t Size, uint8_t Type, uint8_t *Len);
+
+static uint16_t at_cmd_crc16(const uint8_t *Buff, uint16_t Size);
+
 //static void at_cmd_send_noresp(uint16_t len);
 
 
@@ -145,6 +194,11 @@ uint16_t Len;
    /*reset At_cmd buffer for each transmission*/
    memset(LoRa_AT_Cmd_Buff, 0x00, sizeof LoRa_AT_Cmd_Buff); 
 
+  if (BinMode)
+  {
+    return at_cmd_bin(at_group, Cmd, pdata);
+  }
+
   switch (at_group)
   {
   case AT_CTRL:
@@ -155,6 +209,15 @@ uint16_t Len;
           return (AT_UART_LINK_ERROR); /*problem on UART transmission*/
       if(Cmd != AT_RESET)       
           Status = at_cmd_receive(NULL);   
+      if((Cmd == AT_BINMODE) && (Status == AT_OK))
+      {
+          /*the modem sends frames from now, events included*/
+          BinMode = 1;
+          BinRxSize = 0;
+          BinRxOverflow = 0;
+          BinEvents.Pending = 0;
+          HW_UART_Modem_SetContinuousRx(ENABLE);
+      }
     break;
   }  
   case AT_SET:
@@ -184,6 +247,52 @@ uint16_t Len;
 }
 
 
+/******************************************************************************
+ * @brief  Tells if the modem link carries binary frames (AT+BINMODE)
+ * @param  None
+ * @retval 1 in binary mode, 0 in text mode
+ *****************************************************************************/
+uint8_t Modem_AT_IsBinMode( void )
+{
+  return BinMode;
+}
+
+
+/******************************************************************************
+ * @brief  Gets an asynchronous event of the binary mode, without waiting
+ * @param  Event to get
+ *         pdata pointer to the OUT buffer, following the event
+ * @retval AT_OK if the event has been received since the last call
+ * @retval AT_END_ERROR otherwise
+ *****************************************************************************/
+ATEerror_t Modem_AT_BinEvent(ATBinEvent_t Event, void *pdata )
+{
+  /*the late responses are dropped, the events are stored*/
+  while (at_cmd_bin_poll() != 0);
+
+  if ((BinEvents.Pending & (1 << Event)) == 0)
+  {
+    return AT_END_ERROR;
+  }
+  BinEvents.Pending &= ~(1 << Event);
+
+  switch (Event)
+  {
+  case BIN_EVT_RX:
+    ((sReceivedDataBinary_t *)pdata)->Port = BinEvents.RxPort;
+    ((sReceivedDataBinary_t *)pdata)->DataSize = BinEvents.RxSize;
+    memcpy(((sReceivedDataBinary_t *)pdata)->Buffer, BinEvents.RxData, BinEvents.RxSize);
+    break;
+  case BIN_EVT_TXDONE:
+    *(uint8_t *)pdata = BinEvents.TxAck;
+    break;
+  default:
+    break;
+  }
+  return AT_OK;
+}
+
+
 /******************************************************************************
  * @brief  format the cmd in order to be send
  * @param  Cmd AT command
@@ -207,6 +316,7 @@ char value_c;      /*for 8_C*/
     case AT:  
     case AT_RESET: 
     case AT_JOIN: 
+    case AT_BINMODE: 
     {
       /*Format = FORMAT_VOID_PARAM;*/
       len = AT_VPRINTF("%s%s\r\n",AT_HEADER,CmdTab[Cmd]);
@@ -498,6 +608,345 @@ int i;
 }
 
 
+/******************************************************************************
+  * @brief This function handles an AT cmd in binary mode
+  * @brief SENDB and JOIN have their own frames, the other cmds are sent as text
+  * @param at_group AT group [control, set , get)
+  *        Cmd AT command
+  *        pdata pointer to the IN/OUT buffer
+  * @retval return code coming from slave
+******************************************************************************/
+static ATEerror_t at_cmd_bin(ATGroup_t at_group, ATCmd_t Cmd, void *pdata)
+{
+uint16_t Len;
+
+  BinTxFrame[1] = ++BinSeq;
+  BinTxSize = 2;
+
+  if ((at_group == AT_SET) && (Cmd == AT_SENDB))
+  {
+    BinTxFrame[0] = BIN_ID_SEND;
+    at_cmd_bin_add(BIN_TLV_PORT, &((sSendDataBinary_t *)pdata)->Port, 1);
+    at_cmd_bin_add(BIN_TLV_DATA, ((sSendDataBinary_t *)pdata)->Buffer, ((sSendDataBinary_t *)pdata)->DataSize);
+  }
+  else if ((at_group == AT_CTRL) && (Cmd == AT_JOIN))
+  {
+    BinTxFrame[0] = BIN_ID_JOIN;
+  }
+  else if (Cmd == AT_BINMODE)
+  {
+    return AT_OK;     /*already in binary mode*/
+  }
+  else
+  {
+    switch (at_group)
+    {
+    case AT_CTRL:
+      Len = at_cmd_format(Cmd, NULL, CTRL_MARKER);
+      break;
+    case AT_SET:
+      Len = at_cmd_format(Cmd, pdata, SET_MARKER);
+      break;
+    case AT_GET:
+      Len = at_cmd_format(Cmd, pdata, GET_MARKER);
+      break;
+    default:
+      DBG_PRINTF("unknow group\n\r");
+      return AT_END_ERROR;
+    }
+    BinTxFrame[0] = BIN_ID_AT;
+    at_cmd_bin_add(BIN_TLV_TEXT, LoRa_AT_Cmd_Buff, Len - 2);   /*without <cr><lf>*/
+  }
+
+  if (at_cmd_bin_send() != HAL_OK)
+  {
+    return (AT_UART_LINK_ERROR); /*problem on UART transmission*/
+  }
+
+  if (Cmd == AT_RESET)
+  {
+    /*the modem restarts in text mode*/
+    BinMode = 0;
+    HW_UART_Modem_SetContinuousRx(DISABLE);
+    return AT_END_ERROR;
+  }
+  return at_cmd_bin_receive((at_group == AT_GET) ? pdata : NULL);
+}
+
+
+/******************************************************************************
+  * @brief This function appends a TLV to the cmd frame
+  * @param Type TLV type
+  *        Value TLV value
+  *        Len TLV length, the TLV is dropped if the frame is full
+  * @retval void
+******************************************************************************/
+static void at_cmd_bin_add(uint8_t Type, const void *Value, uint8_t Len)
+{
+  if ((BinTxSize + 2 + Len + 2) > sizeof(BinTxFrame))   /*room for the CRC16*/
+  {
+    return;
+  }
+  BinTxFrame[BinTxSize++] = Type;
+  BinTxFrame[BinTxSize++] = Len;
+  memcpy(&BinTxFrame[BinTxSize], Value, Len);
+  BinTxSize += Len;
+}
+
+
+/******************************************************************************
+  * @brief This function sends the cmd frame, CRC16 then COBS encoded
+  * @brief A leading 0x00 ends what is left on the link, the modem drops it
+  * @param void
+  * @retval HAL return code
+******************************************************************************/
+static HAL_StatusTypeDef at_cmd_bin_send(void)
+{
+uint16_t Crc = at_cmd_crc16(BinTxFrame, BinTxSize);
+uint16_t Code = 1;   /*position of the code byte of the current block*/
+uint16_t Len = 2;
+uint16_t i;
+
+  BinTxFrame[BinTxSize++] = Crc >> 8;
+  BinTxFrame[BinTxSize++] = Crc & 0xFF;
+
+  /*the <lf> of AT+BINMODE or the bytes of a muted frame become a bad frame*/
+  BinCobs[0] = 0;
+
+  for (i = 0; i < BinTxSize; i++)
+  {
+    if (BinTxFrame[i] == 0)
+    {
+      BinCobs[Code] = Len - Code;
+      Code = Len++;
+    }
+    else
+    {
+      BinCobs[Len++] = BinTxFrame[i];
+      if ((Len - Code) == 0xFF)  /*254 non zero bytes, block without zero*/
+      {
+        BinCobs[Code] = 0xFF;
+        Code = Len++;
+      }
+    }
+  }
+  BinCobs[Code] = Len - Code;
+  BinCobs[Len++] = 0;
+
+  return HAL_UART_Transmit(&huart2, BinCobs, Len, 5000);
+}
+
+
+/******************************************************************************
+  * @brief This function waits for the response frame of the last cmd frame
+  * @brief The events received meanwhile are kept for Modem_AT_BinEvent
+  * @param pdata: pointeur to the value returned by the slave
+  * @retval return code coming from slave
+******************************************************************************/
+static ATEerror_t at_cmd_bin_receive(void *pdata)
+{
+uint32_t TickStart = HAL_GetTick();
+int16_t Size;
+const uint8_t *Value;
+uint8_t Len;
+uint8_t i;
+
+  while ((HAL_GetTick() - TickStart) < BIN_RESPONSE_TIMEOUT)
+  {
+    Size = at_cmd_bin_poll();
+    if ((Size <= 0) || (BinRxFrame[1] != BinSeq))
+    {
+      continue;    /*a late response to a cmd that timed out is dropped*/
+    }
+
+    if (pdata != NULL)
+    {
+      /*returned value following a GET cmd: its first line, as in text mode*/
+      Value = at_cmd_bin_tlv(Size, BIN_TLV_TEXT, &Len);
+      if (Value == NULL)
+      {
+        Len = 0;
+      }
+      if (Len > (DATA_RX_MAX_BUFF_SIZE - 1))
+      {
+        Len = DATA_RX_MAX_BUFF_SIZE - 1;
+      }
+      for (i = 0; (i < Len) && (Value[i] != '\n'); i++)
+      {
+        ((char *)pdata)[i] = Value[i];
+      }
+      ((char *)pdata)[i] = '\0';
+    }
+
+    Value = at_cmd_bin_tlv(Size, BIN_TLV_STATUS, &Len);
+    if ((Value == NULL) || (Len != 1) || (Value[0] >= (sizeof(BinStatus) / sizeof(BinStatus[0]))))
+    {
+      return AT_END_ERROR;
+    }
+    return BinStatus[Value[0]];
+  }
+  return AT_UART_LINK_ERROR;
+}
+
+
+/******************************************************************************
+  * @brief This function reads the received chars up to the end of a frame
+  * @brief The events are stored, a response is left in BinRxFrame
+  * @param void
+  * @retval size of the response frame without CRC16, 0 if no more frame,
+  * @retval -1 for an event
+******************************************************************************/
+static int16_t at_cmd_bin_poll(void)
+{
+uint8_t c;
+int16_t Size;
+uint16_t Crc;
+const uint8_t *Value;
+uint8_t Len;
+
+  while (HW_UART_Modem_IsNewCharReceived() == SET)
+  {
+    c = HW_UART_Modem_GetNewChar();
+    if (c != 0)
+    {
+      if (BinRxSize < sizeof(BinRxFrame))
+      {
+        BinRxFrame[BinRxSize++] = c;
+      }
+      else
+      {
+        BinRxOverflow = 1;   /*e.g. a downlink larger than DATA_RX_MAX_BUFF_SIZE*/
+      }
+      continue;
+    }
+
+    /*end of frame, the bad ones are dropped*/
+    Size = (BinRxOverflow == 0) ? at_cmd_bin_decode() : -1;
+    BinRxSize = 0;
+    BinRxOverflow = 0;
+    if (Size < 4)
+    {
+      continue;
+    }
+    Size -= 2;
+    Crc = at_cmd_crc16(BinRxFrame, Size);
+    if (Crc != ((BinRxFrame[Size] << 8) | BinRxFrame[Size + 1]))
+    {
+      continue;
+    }
+
+    switch (BinRxFrame[0])
+    {
+    case BIN_ID_RESPONSE:
+      return Size;
+    case BIN_ID_EVT_RX:
+      Value = at_cmd_bin_tlv(Size, BIN_TLV_PORT, &Len);
+      BinEvents.RxPort = ((Value != NULL) && (Len == 1)) ? Value[0] : 0;
+      Value = at_cmd_bin_tlv(Size, BIN_TLV_DATA, &Len);
+      BinEvents.RxSize = 0;
+      if (Value != NULL)
+      {
+        BinEvents.RxSize = (Len > DATA_RX_MAX_BUFF_SIZE) ? DATA_RX_MAX_BUFF_SIZE : Len;
+        memcpy(BinEvents.RxData, Value, BinEvents.RxSize);
+      }
+      BinEvents.Pending |= (1 << BIN_EVT_RX);
+      return -1;
+    case BIN_ID_EVT_TXDONE:
+      Value = at_cmd_bin_tlv(Size, BIN_TLV_ACK, &Len);
+      BinEvents.TxAck = ((Value != NULL) && (Len == 1)) ? Value[0] : 0;
+      BinEvents.Pending |= (1 << BIN_EVT_TXDONE);
+      return -1;
+    case BIN_ID_EVT_JOINED:
+      BinEvents.Pending |= (1 << BIN_EVT_JOINED);
+      return -1;
+    default:
+      break;
+    }
+  }
+  return 0;
+}
+
+
+/******************************************************************************
+  * @brief This function COBS decodes BinRxFrame in place
+  * @param void
+  * @retval size of the decoded frame, -1 if it is not valid COBS
+******************************************************************************/
+static int16_t at_cmd_bin_decode(void)
+{
+uint16_t Ir = 0;
+uint16_t Iw = 0;   /*stays behind Ir*/
+uint8_t Code;
+uint8_t i;
+
+  while (Ir < BinRxSize)
+  {
+    Code = BinRxFrame[Ir++];
+    if ((Ir + Code - 1) > BinRxSize)
+    {
+      return -1;
+    }
+    for (i = 1; i < Code; i++)
+    {
+      BinRxFrame[Iw++] = BinRxFrame[Ir++];
+    }
+    if ((Code != 0xFF) && (Ir < BinRxSize))   /*a zero ends the block, but the last one*/
+    {
+      BinRxFrame[Iw++] = 0;
+    }
+  }
+  return Iw;
+}
+
+
+/******************************************************************************
+  * @brief This function looks a TLV up in the received frame
+  * @param Size size of the frame without CRC16
+  *        Type TLV type
+  *        Len TLV length, set when found
+  * @retval TLV value, NULL if not found or if the frame is malformed
+******************************************************************************/
+static const uint8_t *at_cmd_bin_tlv(int16_t Size, uint8_t Type, uint8_t *Len)
+{
+int16_t i = 2;   /*after Id and Seq*/
+
+  while ((i + 2) <= Size)
+  {
+    if ((i + 2 + BinRxFrame[i + 1]) > Size)
+    {
+      return NULL;
+    }
+    if (BinRxFrame[i] == Type)
+    {
+      *Len = BinRxFrame[i + 1];
+      return &BinRxFrame[i + 2];
+    }
+    i += 2 + BinRxFrame[i + 1];
+  }
+  return NULL;
+}
+
+
+/******************************************************************************
+  * @brief This function computes the CRC16-CCITT of a frame, init 0xFFFF
+  * @param Buff frame
+  *        Size size of the frame
+  * @retval CRC16
+******************************************************************************/
+static uint16_t at_cmd_crc16(const uint8_t *Buff, uint16_t Size)
+{
+uint16_t Crc = 0xFFFF;
+
+  while (Size-- > 0)
+  {
+    Crc = (Crc << 4) ^ Crc16Nibble[(Crc >> 12) ^ (*Buff >> 4)];
+    Crc = (Crc << 4) ^ Crc16Nibble[(Crc >> 12) ^ (*Buff & 0x0F)];
+    Buff++;
+  }
+  return Crc;
+}
+
+
 /******************************************************************************
   * @brief This function sends an AT cmd to the slave device
   * @brief It is an AT cmd without response from slave device
@@ -54,6 +54,10 @@ extern "C" {
 #define DATA_TX_MAX_BUFF_SIZE    78       /*Max size of the transmit buffer*/
                                           /*it is the worst-case when sending*/
                                           /*a max payload equal to 64 bytes*/
+
+#define BIN_FRAME_MAX_SIZE       88       /*Max size of a binary frame before COBS*/
+                                          /*an AT cmd of DATA_TX_MAX_BUFF_SIZE or*/
+                                          /*a downlink of DATA_RX_MAX_BUFF_SIZE*/
 typedef enum ATGroup
 {
   AT_CTRL = 0,
@@ -116,6 +120,15 @@ typedef struct sReceivedDataBinary
 }sReceivedDataBinary_t;
 
 
+/*type definition for the asynchronous events of the binary mode*/
+typedef enum ATBinEvent
+{
+  BIN_EVT_RX = 0,       /*downlink data, out in sReceivedDataBinary_t*/
+  BIN_EVT_TXDONE,       /*end of uplink, out in uint8_t: 1 if acknowledged*/
+  BIN_EVT_JOINED,       /*network joined, no out value*/
+} ATBinEvent_t;
+
+
 /*type definition for return code analysis*/
 typedef  char* ATEerrorStr_t;
 
@@ -179,6 +192,22 @@ void Modem_IO_DeInit( void ) ;
  *****************************************************************************/
 ATEerror_t Modem_AT_Cmd(ATGroup_t at_group, ATCmd_t Cmd, void *pdata );
 
+/******************************************************************************
+ * @brief  Tells if the modem link carries binary frames (AT+BINMODE)
+ * @param  None
+ * @retval 1 in binary mode, 0 in text mode
+ *****************************************************************************/
+uint8_t Modem_AT_IsBinMode( void );
+
+/******************************************************************************
+ * @brief  Gets an asynchronous event of the binary mode, without waiting
+ * @param  Event to get
+ *         pdata pointer to the OUT buffer, following the event
+ * @retval AT_OK if the event has been received since the last call
+ * @retval AT_END_ERROR otherwise
+ *****************************************************************************/
+ATEerror_t Modem_AT_BinEvent(ATBinEvent_t Event, void *pdata );
+
 
 
 #ifdef __cplusplus
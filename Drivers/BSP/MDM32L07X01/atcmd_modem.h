@@ -92,6 +92,7 @@ typedef enum ATCmd
  AT_RSSI,
  AT_SNR,
  AT_VER,
+ AT_BINMODE,
  AT_END_AT
 } ATCmd_t; 
 
@@ -141,7 +142,8 @@ static char *CmdTab[] = {
   {"+BAT"},        /* +BAT  battery level*/
   {"+RSSI"},       /* +RSSI Signal strength indicator on received radio signal*/
   {"+SNR"},        /* +SNR  Signal to Noice ratio*/
-  {"+VER"}         /* firmware version of the modem (slave)*/
+  {"+VER"},        /* firmware version of the modem (slave)*/
+  {"+BINMODE"}     /* +BINMODE switch to the binary frames*/
 };
 
 #endif
@@ -188,6 +190,18 @@ static ATE_RetCode_t ATE_RetCode[] = {
   {{"\r\nAT_NO_NETWORK_JOINED\r\n"},{sizeof("\r\nAT_NO_NETWORK_JOINED\r\n")},{AT_NO_NET_JOINED}},
   {{"\r\nunknown error\r\n"},{sizeof("\r\nunknown error\r\n")},{AT_END_ERROR}}};
 
+/*
+ * Return code of the binary frames, indexed by their TLV_STATUS. Located in atcmd.c file
+ */
+static const ATEerror_t BinStatus[] = {
+  AT_OK,
+  AT_ERROR,
+  AT_PARAM_ERROR,
+  AT_BUSY_ERROR,
+  AT_TEST_PARAM_OVERFLOW,
+  AT_NO_NET_JOINED,
+  AT_ERROR};                /* rx error on the modem side*/
+
 #endif
 
   
@@ -207,6 +221,28 @@ static ATE_RetCode_t ATE_RetCode[] = {
 #define AT_SEPARATOR    ":" 
 #define AT_FRAME_KEY    "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx:%hhx"
 #define AT_FRAME_KEY_OFFSET 0  
+
+/* 
+ * Binary frames entered with AT+BINMODE: Id | Seq | TLVs | CRC16, COBS encoded, ended by 0x00.
+ * TLV is Type | Length | Value, CRC16 is CCITT (poly 0x1021, init 0xFFFF) sent MSB first.
+ */
+#define BIN_ID_AT          0x01   /* TLV_TEXT: AT cmd line without <cr><lf>*/
+#define BIN_ID_SEND        0x02   /* TLV_PORT, TLV_DATA*/
+#define BIN_ID_JOIN        0x03
+#define BIN_ID_EXIT        0x04
+#define BIN_ID_RESPONSE    0x80   /* TLV_STATUS, TLV_TEXT if any, same Seq as the cmd*/
+#define BIN_ID_EVT_RX      0x81   /* TLV_PORT, TLV_DATA, TLV_RSSI, TLV_SNR*/
+#define BIN_ID_EVT_TXDONE  0x82   /* TLV_STATUS, TLV_ACK*/
+#define BIN_ID_EVT_JOINED  0x83
+
+#define BIN_TLV_STATUS     0x01   /* index in BinStatus*/
+#define BIN_TLV_TEXT       0x02
+#define BIN_TLV_PORT       0x03
+#define BIN_TLV_DATA       0x04
+#define BIN_TLV_CONFIRMED  0x05
+#define BIN_TLV_RSSI       0x06
+#define BIN_TLV_SNR        0x07
+#define BIN_TLV_ACK        0x08
 #endif
   
 
@@ -94,6 +94,11 @@ static ComplianceTest_t certifParam;
 static LoraConfirm_t IsTxConfirmed;
 static bool AdrEnableInit;
 
+/*!
+ * Transmission posted by the timer interrupt, sent by certif_process from the main loop
+ */
+static volatile bool CertifTxRequest = false;
+
 /* Private functions ---------------------------------------------------------*/
 
 static void OnCertifTxNextPacketTimerEvent( void );
@@ -117,6 +122,23 @@ void certif_linkCheck(MlmeConfirm_t *mlmeConfirm)
   certifParam.NbGateways = mlmeConfirm->NbGateways;
 }
 
+void certif_process( void )
+{
+  if( CertifTxRequest == true )
+  {
+    CertifTxRequest = false;
+    if( certifParam.Running == true )
+    {
+      certif_tx( );
+    }
+  }
+}
+
+bool certif_pending( void )
+{
+  return CertifTxRequest;
+}
+
 static bool certif_tx( void )
 {
   McpsReq_t mcpsReq;
@@ -327,6 +349,7 @@ void certif_rx( McpsIndication_t *mcpsIndication, MlmeReqJoin_t* JoinParameters)
     {
       /*cerification test stops*/
       TimerStop( &CertifTxNextPacketTimer );
+      CertifTxRequest = false;
     }
 }
 
@@ -335,8 +358,8 @@ void certif_rx( McpsIndication_t *mcpsIndication, MlmeReqJoin_t* JoinParameters)
  */
 static void OnCertifTxNextPacketTimerEvent( void )
 {
-    certif_tx( );
-
+    /* no LoRaMac request from the RTC interrupt: the main loop sends */
+    CertifTxRequest = true;
 }
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
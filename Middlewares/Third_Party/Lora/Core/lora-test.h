@@ -68,6 +68,12 @@ void certif_linkCheck(MlmeConfirm_t *mlmeConfirm);
 
 void certif_rx( McpsIndication_t *mcpsIndication, MlmeReqJoin_t* JoinParameters);
 
+/* sends the test frame posted by the certification timer, called from the main loop */
+void certif_process( void );
+
+/* true while a test frame is posted, the main loop must not sleep */
+bool certif_pending( void );
+
 #ifdef __cplusplus
 }
 #endif
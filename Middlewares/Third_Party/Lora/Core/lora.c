@@ -262,6 +262,9 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
   /* init the main call backs*/
   LoRaMainCallbacks = callbacks;
   
+  /* Random seed initialization, for the device address as for the join nonce */
+  srand1( LoRaMainCallbacks->BoardGetRandomSeed( ) );
+  
 #if (STATIC_DEVICE_EUI != 1)
   LoRaMainCallbacks->BoardGetUniqueId( DevEui );  
 #endif
@@ -275,8 +278,6 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
 #else
 
 #if (STATIC_DEVICE_ADDRESS != 1)
-  // Random seed initialization
-  srand1( LoRaMainCallbacks->BoardGetRandomSeed( ) );
   // Choose a random device address
   DevAddr = randr( 0, 0x01FFFFFF );
 #endif
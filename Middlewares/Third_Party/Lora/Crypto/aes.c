@@ -64,6 +64,12 @@
 
 #include "aes.h"
 
+/* byte oriented encryption rounds are needed unless the T-table version
+   is the only encryption code compiled in */
+#if !defined( AES_ENC_TTABLE ) || defined( AES_ENC_128_OTFK ) || defined( AES_ENC_256_OTFK )
+#  define AES_ENC_BYTE_ROUNDS
+#endif
+
 //#if defined( HAVE_UINT_32T )
 //  typedef unsigned long uint32_t;
 //#endif
@@ -197,8 +203,22 @@ static const uint8_t sbox[256]  =  sb_data(f1);
 static const uint8_t isbox[256] = isb_data(f1);
 #endif
 
+#if defined( AES_ENC_BYTE_ROUNDS )
 static const uint8_t gfm2_sbox[256] = sb_data(f2);
 static const uint8_t gfm3_sbox[256] = sb_data(f3);
+#endif
+
+#if defined( AES_ENC_TTABLE )
+/*  te0[x] is the MixColumns contribution of S(x) when it sits in row 0 of
+    a column, i.e. (2.S(x), S(x), S(x), 3.S(x)) stored as a little-endian
+    column word. The contributions of rows 1, 2 and 3 are the same word
+    rotated left by 8, 16 and 24 bits.
+*/
+#define te0_word(x) ((uint32_t)f2(x) | ((uint32_t)(x) << 8) | \
+                     ((uint32_t)(x) << 16) | ((uint32_t)f3(x) << 24))
+
+static const uint32_t te0[256] = sb_data(te0_word);
+#endif
 
 #if defined( AES_DEC_PREKEYED )
 static const uint8_t gfmul_9[256] = mm_data(f9);
@@ -408,6 +428,8 @@ static void add_round_key( uint8_t d[N_BLOCK], const uint8_t k[N_BLOCK] )
     xor_block(d, k);
 }
 
+#if defined( AES_ENC_BYTE_ROUNDS )
+
 static void shift_sub_rows( uint8_t st[N_BLOCK] )
 {   uint8_t tt;
 
@@ -424,6 +446,8 @@ static void shift_sub_rows( uint8_t st[N_BLOCK] )
     st[ 7] = s_box(st[ 3]); st[ 3] = s_box( tt );
 }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
@@ -444,6 +468,8 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
 
 #endif
 
+#if defined( AES_ENC_BYTE_ROUNDS )
+
 #if defined( VERSION_1 )
   static void mix_sub_columns( uint8_t dt[N_BLOCK] )
   { uint8_t st[N_BLOCK];
@@ -473,6 +499,8 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
     dt[15] = gfm3_sb(st[12]) ^ s_box(st[1]) ^ s_box(st[6]) ^ gfm2_sb(st[11]);
   }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 #if defined( VERSION_1 )
@@ -563,6 +591,68 @@ return_type aes_set_key( const uint8_t key[], length_type keylen, aes_context ct
 
 #if defined( AES_ENC_PREKEYED )
 
+#if defined( AES_ENC_TTABLE )
+
+#if !defined( USE_TABLES )
+#  error "AES_ENC_TTABLE requires USE_TABLES"
+#endif
+
+#define rotl32(x, n)    (((x) << (n)) | ((x) >> (32 - (n))))
+
+/* the key schedule and the data blocks need not be word aligned */
+#define load_le32(p)    ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+                         ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+/* one full round on column words: sub bytes, shift rows, mix columns */
+#define tt_round(a, b, c, d, k) \
+    (te0[(a) & 0xff] ^ rotl32(te0[((b) >> 8) & 0xff], 8) ^ \
+     rotl32(te0[((c) >> 16) & 0xff], 16) ^ rotl32(te0[(d) >> 24], 24) ^ load_le32(k))
+
+/* last round output column: sub bytes, shift rows, add round key */
+#define tt_final(o, a, b, c, d, k) do {                     \
+    (o)[0] = s_box((a) & 0xff) ^ (k)[0];                    \
+    (o)[1] = s_box(((b) >> 8) & 0xff) ^ (k)[1];             \
+    (o)[2] = s_box(((c) >> 16) & 0xff) ^ (k)[2];            \
+    (o)[3] = s_box((d) >> 24) ^ (k)[3];                     \
+    } while (0)
+
+/*  Encrypt a single block of 16 bytes ( 32-bit T-table version ) */
+
+return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+{
+    if( ctx->rnd )
+    {
+        const uint8_t *k = ctx->ksch;
+        uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+        uint8_t r;
+
+        s0 = load_le32(in     ) ^ load_le32(k     );
+        s1 = load_le32(in +  4) ^ load_le32(k +  4);
+        s2 = load_le32(in +  8) ^ load_le32(k +  8);
+        s3 = load_le32(in + 12) ^ load_le32(k + 12);
+
+        for( r = 1 ; r < ctx->rnd ; ++r )
+        {
+            k += N_BLOCK;
+            t0 = tt_round(s0, s1, s2, s3, k     );
+            t1 = tt_round(s1, s2, s3, s0, k +  4);
+            t2 = tt_round(s2, s3, s0, s1, k +  8);
+            t3 = tt_round(s3, s0, s1, s2, k + 12);
+            s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+        }
+        k += N_BLOCK;
+        tt_final(out     , s0, s1, s2, s3, k     );
+        tt_final(out +  4, s1, s2, s3, s0, k +  4);
+        tt_final(out +  8, s2, s3, s0, s1, k +  8);
+        tt_final(out + 12, s3, s0, s1, s2, k + 12);
+    }
+    else
+        return ( uint8_t )-1;
+    return 0;
+}
+
+#else
+
 /*  Encrypt a single block of 16 bytes */
 
 return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
@@ -592,6 +682,8 @@ return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const
     return 0;
 }
 
+#endif
+
 /* CBC encrypt a number of blocks (input and return an IV) */
 
 return_type aes_cbc_encrypt( const uint8_t *in, uint8_t *out,
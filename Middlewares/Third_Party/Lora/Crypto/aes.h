@@ -37,6 +37,19 @@
 #if 0
 #  define AES_DEC_PREKEYED  /* AES decryption with a precomputed key schedule  */
 #endif
+
+/*  Encryption backend used by aes_encrypt() for the precomputed key schedule.
+    Both backends share aes_set_key() and the aes_context layout; the
+    T-table one works on 32-bit column words and suits the Cortex-M cores.
+    It can also be enabled from the build with -DAES_ENC_TTABLE.
+
+    backend             tables (flash)      relative encryption speed
+    byte (default)      768 bytes           1x
+    AES_ENC_TTABLE      1280 bytes          2x to 4x, depending on the core
+*/
+#if 0
+#  define AES_ENC_TTABLE    /* AES encryption with a 32-bit T-table          */
+#endif
 #if 0
 #  define AES_ENC_128_OTFK  /* AES encryption with 'on the fly' 128 bit keying */
 #endif
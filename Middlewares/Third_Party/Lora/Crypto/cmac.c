@@ -60,12 +60,20 @@ void AES_CMAC_Init(AES_CMAC_CTX *ctx)
             memset1(ctx->X, 0, sizeof ctx->X);
             ctx->M_n = 0;
         memset1(ctx->rijndael.ksch, '\0', 240);
+        ctx->ksch = &ctx->rijndael;
 }
     
 void AES_CMAC_SetKey(AES_CMAC_CTX *ctx, const uint8_t key[AES_CMAC_KEY_LENGTH])
 {
            //rijndael_set_key_enc_only(&ctx->rijndael, key, 128);
        aes_set_key( key, AES_CMAC_KEY_LENGTH, &ctx->rijndael);
+       ctx->ksch = &ctx->rijndael;
+}
+
+/* Uses an already expanded key schedule, the caller keeps it alive until Final */
+void AES_CMAC_SetKeySchedule(AES_CMAC_CTX *ctx, const aes_context *ksch)
+{
+       ctx->ksch = ksch;
 }
     
 void AES_CMAC_Update(AES_CMAC_CTX *ctx, const uint8_t *data, uint32_t len)
@@ -81,7 +89,7 @@ void AES_CMAC_Update(AES_CMAC_CTX *ctx, const uint8_t *data, uint32_t len)
                             return;
                    XOR(ctx->M_last, ctx->X);
                     //rijndael_encrypt(&ctx->rijndael, ctx->X, ctx->X);
-            aes_encrypt( ctx->X, ctx->X, &ctx->rijndael);
+            aes_encrypt( ctx->X, ctx->X, ctx->ksch);
                     data += mlen;
                     len -= mlen;
             }
@@ -91,7 +99,7 @@ void AES_CMAC_Update(AES_CMAC_CTX *ctx, const uint8_t *data, uint32_t len)
                     //rijndael_encrypt(&ctx->rijndael, ctx->X, ctx->X);
 
                     memcpy1(in, &ctx->X[0], 16); //Bestela ez du ondo iten
-            aes_encrypt( in, in, &ctx->rijndael);
+            aes_encrypt( in, in, ctx->ksch);
                     memcpy1(&ctx->X[0], in, 16);
 
                     data += 16;
@@ -111,7 +119,7 @@ void AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX *ctx)
 
             //rijndael_encrypt(&ctx->rijndael, K, K);
 
-            aes_encrypt( K, K, &ctx->rijndael);
+            aes_encrypt( K, K, ctx->ksch);
 
             if (K[0] & 0x80) {
                     LSHIFT(K, K);
@@ -146,7 +154,7 @@ void AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX *ctx)
            //rijndael_encrypt(&ctx->rijndael, ctx->X, digest);
 
        memcpy1(in, &ctx->X[0], 16); //Bestela ez du ondo iten
-       aes_encrypt(in, digest, &ctx->rijndael);
+       aes_encrypt(in, digest, ctx->ksch);
            memset1(K, 0, sizeof K);
 
 }
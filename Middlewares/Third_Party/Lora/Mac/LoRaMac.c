@@ -26,33 +26,15 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #include "timeServer.h"
 #include "LoRaMac.h"
 #include "region/Region.h"
+#include "LoRaMacCtx.h"
 #include "LoRaMacCrypto.h"
+#include "random.h"
 
 #include "debug.h"
 #include "LoRaMacTest.h"
 
 
 
-/*!
- * Maximum PHY layer payload size
- */
-#define LORAMAC_PHY_MAXPAYLOAD                      255
-
-/*!
- * Maximum MAC commands buffer size
- */
-#define LORA_MAC_COMMAND_MAX_LENGTH                 128
-
-/*!
- * Maximum length of the fOpts field
- */
-#define LORA_MAC_COMMAND_MAX_FOPTS_LENGTH           15
-
-/*!
- * LoRaMac region.
- */
-static LoRaMacRegion_t LoRaMacRegion;
-
 /*!
  * LoRaMac duty cycle for the back-off procedure during the first hour.
  */
@@ -68,225 +50,6 @@ static LoRaMacRegion_t LoRaMacRegion;
  */
 #define BACKOFF_DC_24_HOURS                         10000
 
-/*!
- * Device IEEE EUI
- */
-static uint8_t *LoRaMacDevEui;
-
-/*!
- * Application IEEE EUI
- */
-static uint8_t *LoRaMacAppEui;
-
-/*!
- * AES encryption/decryption cipher application key
- */
-static uint8_t *LoRaMacAppKey;
-
-/*!
- * AES encryption/decryption cipher network session key
- */
-static uint8_t LoRaMacNwkSKey[] =
-{
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
-
-/*!
- * AES encryption/decryption cipher application session key
- */
-static uint8_t LoRaMacAppSKey[] =
-{
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
-
-/*!
- * Device nonce is a random value extracted by issuing a sequence of RSSI
- * measurements
- */
-static uint16_t LoRaMacDevNonce;
-
-/*!
- * Network ID ( 3 bytes )
- */
-static uint32_t LoRaMacNetID;
-
-/*!
- * Mote Address
- */
-static uint32_t LoRaMacDevAddr;
-
-/*!
- * Multicast channels linked list
- */
-static MulticastParams_t *MulticastChannels = NULL;
-
-/*!
- * Actual device class
- */
-static DeviceClass_t LoRaMacDeviceClass;
-
-/*!
- * Indicates if the node is connected to a private or public network
- */
-static bool PublicNetwork;
-
-/*!
- * Indicates if the node supports repeaters
- */
-static bool RepeaterSupport;
-
-/*!
- * Buffer containing the data to be sent or received.
- */
-static uint8_t LoRaMacBuffer[LORAMAC_PHY_MAXPAYLOAD];
-
-/*!
- * Length of packet in LoRaMacBuffer
- */
-static uint16_t LoRaMacBufferPktLen = 0;
-
-/*!
- * Length of the payload in LoRaMacBuffer
- */
-static uint8_t LoRaMacTxPayloadLen = 0;
-
-/*!
- * Buffer containing the upper layer data.
- */
-static uint8_t LoRaMacRxPayload[LORAMAC_PHY_MAXPAYLOAD];
-
-/*!
- * LoRaMAC frame counter. Each time a packet is sent the counter is incremented.
- * Only the 16 LSB bits are sent
- */
-static uint32_t UpLinkCounter = 0;
-
-/*!
- * LoRaMAC frame counter. Each time a packet is received the counter is incremented.
- * Only the 16 LSB bits are received
- */
-static uint32_t DownLinkCounter = 0;
-
-/*!
- * IsPacketCounterFixed enables the MIC field tests by fixing the
- * UpLinkCounter value
- */
-static bool IsUpLinkCounterFixed = false;
-
-/*!
- * Used for test purposes. Disables the opening of the reception windows.
- */
-static bool IsRxWindowsEnabled = true;
-
-/*!
- * Indicates if the MAC layer has already joined a network.
- */
-static bool IsLoRaMacNetworkJoined = false;
-
-/*!
- * LoRaMac ADR control status
- */
-static bool AdrCtrlOn = false;
-
-/*!
- * Counts the number of missed ADR acknowledgements
- */
-static uint32_t AdrAckCounter = 0;
-
-/*!
- * If the node has sent a FRAME_TYPE_DATA_CONFIRMED_UP this variable indicates
- * if the nodes needs to manage the server acknowledgement.
- */
-static bool NodeAckRequested = false;
-
-/*!
- * If the server has sent a FRAME_TYPE_DATA_CONFIRMED_DOWN this variable indicates
- * if the ACK bit must be set for the next transmission
- */
-static bool SrvAckRequested = false;
-
-/*!
- * Indicates if the MAC layer wants to send MAC commands
- */
-static bool MacCommandsInNextTx = false;
-
-/*!
- * Contains the current MacCommandsBuffer index
- */
-static uint8_t MacCommandsBufferIndex = 0;
-
-/*!
- * Contains the current MacCommandsBuffer index for MAC commands to repeat
- */
-static uint8_t MacCommandsBufferToRepeatIndex = 0;
-
-/*!
- * Buffer containing the MAC layer commands
- */
-static uint8_t MacCommandsBuffer[LORA_MAC_COMMAND_MAX_LENGTH];
-
-/*!
- * Buffer containing the MAC layer commands which must be repeated
- */
-static uint8_t MacCommandsBufferToRepeat[LORA_MAC_COMMAND_MAX_LENGTH];
-
-/*!
- * LoRaMac parameters
- */
-LoRaMacParams_t LoRaMacParams;
-
-/*!
- * LoRaMac default parameters
- */
-LoRaMacParams_t LoRaMacParamsDefaults;
-
-/*!
- * Uplink messages repetitions counter
- */
-static uint8_t ChannelsNbRepCounter = 0;
-
-/*!
- * Maximum duty cycle
- * \remark Possibility to shutdown the device.
- */
-static uint8_t MaxDCycle = 0;
-
-/*!
- * Aggregated duty cycle management
- */
-static uint16_t AggregatedDCycle;
-static TimerTime_t AggregatedLastTxDoneTime;
-static TimerTime_t AggregatedTimeOff;
-
-/*!
- * Enables/Disables duty cycle management (Test only)
- */
-static bool DutyCycleOn;
-
-/*!
- * Current channel index
- */
-static uint8_t Channel;
-
-/*!
- * Current channel index
- */
-static uint8_t LastTxChannel;
-
-/*!
- * Set to true, if the last uplink was a join request
- */
-static bool LastTxIsJoinRequest;
-
-/*!
- * Stores the time at LoRaMac initialization.
- *
- * \remark Used for the BACKOFF_DC computation.
- */
-static TimerTime_t LoRaMacInitializationTime = 0;
-
 /*!
  * LoRaMac internal states
  */
@@ -303,119 +66,132 @@ enum eLoRaMacState
 };
 
 /*!
- * LoRaMac internal state
- */
-uint32_t LoRaMacState = LORAMAC_IDLE;
-
-/*!
- * LoRaMac timer used to check the LoRaMacState (runs every second)
+ * Radio events function pointer
  */
-static TimerEvent_t MacStateCheckTimer;
+static RadioEvents_t RadioEvents;
 
 /*!
- * LoRaMac upper layer event functions
+ * Context of the single instance API
  */
-static LoRaMacPrimitives_t *LoRaMacPrimitives;
+static LoRaMacCtx_t LoRaMacDefaultCtx;
 
 /*!
- * LoRaMac upper layer callback functions
+ * Context the MAC functions work on, selected by the API functions
  */
-static LoRaMacCallback_t *LoRaMacCallbacks;
+static LoRaMacCtx_t *MacCtx = NULL;
 
 /*!
- * Radio events function pointer
+ * Context which started the last radio operation, the radio events are
+ * queued for it
  */
-static RadioEvents_t RadioEvents;
+static LoRaMacCtx_t *RadioOwner = NULL;
 
 /*!
- * LoRaMac duty cycle delayed Tx timer
+ * Set once the radio noise has been added to the entropy pool. The
+ * instances initialized afterwards share the generator
  */
-static TimerEvent_t TxDelayedTimer;
+static bool RadioNoiseSeeded = false;
 
 /*!
- * LoRaMac reception windows timers
+ * \brief Queues an event for LoRaMacProcess. Called from interrupt context.
+ *
+ * \param [IN] ctx     Context the event is queued for, NULL drops it
+ * \param [IN] event   Event to queue
+ * \param [IN] payload Received frame, RX done event only
+ * \param [IN] size    Size of the received frame
+ * \param [IN] rssi    Rssi of the received frame
+ * \param [IN] snr     Snr of the received frame
  */
-static TimerEvent_t RxWindowTimer1;
-static TimerEvent_t RxWindowTimer2;
+static void PushEvent( LoRaMacCtx_t *ctx, LoRaMacEvent_t event, uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr );
 
 /*!
- * LoRaMac reception windows delay
- * \remark normal frame: RxWindowXDelay = ReceiveDelayX - RADIO_WAKEUP_TIME
- *         join frame  : RxWindowXDelay = JoinAcceptDelayX - RADIO_WAKEUP_TIME
+ * \brief Radio Tx Done interrupt, queues the event
  */
-static uint32_t RxWindow1Delay;
-static uint32_t RxWindow2Delay;
+static void OnRadioTxDoneIrq( void );
 
 /*!
- * LoRaMac Rx windows configuration
+ * \brief Radio Rx Done interrupt, copies the frame and queues the event
  */
-static RxConfigParams_t RxWindow1Config;
-static RxConfigParams_t RxWindow2Config;
+static void OnRadioRxDoneIrq( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr );
 
 /*!
- * Acknowledge timeout timer. Used for packet retransmissions.
+ * \brief Radio Tx Timeout interrupt, queues the event
  */
-static TimerEvent_t AckTimeoutTimer;
+static void OnRadioTxTimeoutIrq( void );
 
 /*!
- * Number of trials to get a frame acknowledged
+ * \brief Radio Rx error interrupt, queues the event
  */
-static uint8_t AckTimeoutRetries = 1;
+static void OnRadioRxErrorIrq( void );
 
 /*!
- * Number of trials to get a frame acknowledged
+ * \brief Radio Rx Timeout interrupt, queues the event
  */
-static uint8_t AckTimeoutRetriesCounter = 1;
+static void OnRadioRxTimeoutIrq( void );
 
 /*!
- * Indicates if the AckTimeout timer has expired or not
+ * \brief MAC state check timer interrupt, queues the event
  */
-static bool AckTimeoutRetry = false;
+static void OnMacStateCheckTimerIrq( void );
 
 /*!
- * Last transmission time on air
+ * \brief Duty cycle delayed Tx timer interrupt, queues the event
  */
-TimerTime_t TxTimeOnAir = 0;
+static void OnTxDelayedTimerIrq( void );
 
 /*!
- * Number of trials for the Join Request
+ * \brief AckTimeout timer interrupt, queues the event
  */
-static uint8_t JoinRequestTrials;
+static void OnAckTimeoutTimerIrq( void );
 
 /*!
- * Maximum number of trials for the Join Request
+ * \brief First Rx window timer interrupt, opens the window of the timer context
  */
-static uint8_t MaxJoinRequestTrials;
+static void OnRxWindow1TimerIrq( void );
 
 /*!
- * Structure to hold an MCPS indication data.
+ * \brief Second Rx window timer interrupt, opens the window of the timer context
  */
-static McpsIndication_t McpsIndication;
+static void OnRxWindow2TimerIrq( void );
 
 /*!
- * Structure to hold MCPS confirm data.
+ * \brief Selects the context the MAC and the region functions work on, and
+ *        loads its session keys into the key schedule cache
+ *
+ * \param [IN] ctx Context to select
  */
-static McpsConfirm_t McpsConfirm;
+static void SelectCtx( LoRaMacCtx_t *ctx );
 
 /*!
- * Structure to hold MLME confirm data.
+ * \brief Switches the MAC and the region functions to a context, without
+ *        touching the key schedule cache. Used from interrupt context.
+ *
+ * \param [IN] ctx Context to switch to
+ * \retval Context previously in use
  */
-static MlmeConfirm_t MlmeConfirm;
+static LoRaMacCtx_t* SwitchCtx( LoRaMacCtx_t *ctx );
 
 /*!
- * Holds the current rx window slot
+ * \brief Makes the current context the owner of the radio events, and
+ *        restores its network type if another context used the radio
  */
-static uint8_t RxSlot = 0;
+static void TakeRadio( void );
 
 /*!
- * LoRaMac tx/rx operation state
+ * \brief Computes the timer value of a delay counted from a past event
+ *
+ * \param [IN] time  Time of the event
+ * \param [IN] delay Delay from the event
+ * \retval Remaining delay, 0 if already elapsed
  */
-LoRaMacFlags_t LoRaMacFlags;
+static uint32_t GetRemainingDelay( TimerTime_t time, uint32_t delay );
 
 /*!
  * \brief Function to be executed on Radio Tx Done event
+ *
+ * \param [IN] txDoneTime Time of the Tx Done interrupt
  */
-static void OnRadioTxDone( void );
+static void OnRadioTxDone( TimerTime_t txDoneTime );
 
 /*!
  * \brief This function prepares the MAC to abort the execution of function
@@ -563,6 +339,18 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl
  */
 static LoRaMacStatus_t ScheduleTx( void );
 
+/*
+ * \brief Gets the RX window parameters of a datarate. They are computed on the
+ *        first use of the datarate and cached until MinRxSymbols or
+ *        SystemMaxRxError change.
+ *
+ * \param [IN] datarate        The RX datarate
+ *
+ * \param [OUT] rxConfigParams Updated WindowTimeout, WindowOffset, Datarate
+ *                             and Bandwidth
+ */
+static void GetRxWindowParameters( int8_t datarate, RxConfigParams_t *rxConfigParams );
+
 /*
  * \brief Calculates the back-off time for the band of a channel.
  *
@@ -608,14 +396,161 @@ LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint
  */
 static void ResetMacParameters( void );
 
-static void OnRadioTxDone( void )
+static LoRaMacCtx_t* SwitchCtx( LoRaMacCtx_t *ctx )
+{
+    LoRaMacCtx_t *previous = MacCtx;
+
+    MacCtx = ctx;
+    RegionSetCtx( ctx->LoRaMacRegion, &ctx->Region );
+    return previous;
+}
+
+static void SelectCtx( LoRaMacCtx_t *ctx )
+{
+    if( ( MacCtx == ctx ) && ( MacCtx != NULL ) )
+    {
+        return;
+    }
+    SwitchCtx( ctx );
+
+    // The key schedule cache holds the session keys of a single context
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, ctx->LoRaMacNwkSKey );
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, ctx->LoRaMacAppSKey );
+}
+
+static void TakeRadio( void )
+{
+    if( RadioOwner != MacCtx )
+    {
+        RadioOwner = MacCtx;
+        Radio.SetPublicNetwork( MacCtx->PublicNetwork );
+    }
+}
+
+static void PushEvent( LoRaMacCtx_t *ctx, LoRaMacEvent_t event, uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    LoRaMacEventEntry_t *entry;
+
+    if( ctx == NULL )
+    {
+        return;
+    }
+
+    if( ( uint8_t )( ctx->EventQueueHead - ctx->EventQueueTail ) >= LORAMAC_EVENT_QUEUE_SIZE )
+    {
+        // Queue full, the event is lost
+        return;
+    }
+
+    if( event == LORAMAC_EVENT_RADIO_RX_DONE )
+    {
+        if( ( uint8_t )( ctx->RxFrameHead - ctx->RxFrameTail ) >= LORAMAC_RX_FRAME_QUEUE_SIZE )
+        {
+            // No room to keep the frame, report it as a reception error
+            event = LORAMAC_EVENT_RADIO_RX_ERROR;
+        }
+        else
+        {
+            memcpy1( ctx->RxFrameQueue[ctx->RxFrameHead & ( LORAMAC_RX_FRAME_QUEUE_SIZE - 1 )], payload, size );
+            ctx->RxFrameHead++;
+        }
+    }
+
+    entry = &ctx->EventQueue[ctx->EventQueueHead & ( LORAMAC_EVENT_QUEUE_SIZE - 1 )];
+    entry->Event = event;
+    entry->Time = TimerGetCurrentTime( );
+    entry->Rssi = rssi;
+    entry->Snr = snr;
+    entry->Size = size;
+
+    // The entry must be complete before the consumer can see it
+    __DMB( );
+    ctx->EventQueueHead++;
+}
+
+static void OnRadioTxDoneIrq( void )
+{
+    PushEvent( RadioOwner, LORAMAC_EVENT_RADIO_TX_DONE, NULL, 0, 0, 0 );
+}
+
+static void OnRadioRxDoneIrq( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    PushEvent( RadioOwner, LORAMAC_EVENT_RADIO_RX_DONE, payload, size, rssi, snr );
+}
+
+static void OnRadioTxTimeoutIrq( void )
+{
+    PushEvent( RadioOwner, LORAMAC_EVENT_RADIO_TX_TIMEOUT, NULL, 0, 0, 0 );
+}
+
+static void OnRadioRxErrorIrq( void )
+{
+    PushEvent( RadioOwner, LORAMAC_EVENT_RADIO_RX_ERROR, NULL, 0, 0, 0 );
+}
+
+static void OnRadioRxTimeoutIrq( void )
+{
+    PushEvent( RadioOwner, LORAMAC_EVENT_RADIO_RX_TIMEOUT, NULL, 0, 0, 0 );
+}
+
+static void OnMacStateCheckTimerIrq( void )
+{
+    PushEvent( ( LoRaMacCtx_t* )TimerGetContext( ), LORAMAC_EVENT_MAC_STATE_CHECK, NULL, 0, 0, 0 );
+}
+
+static void OnTxDelayedTimerIrq( void )
+{
+    PushEvent( ( LoRaMacCtx_t* )TimerGetContext( ), LORAMAC_EVENT_TX_DELAYED, NULL, 0, 0, 0 );
+}
+
+static void OnAckTimeoutTimerIrq( void )
+{
+    PushEvent( ( LoRaMacCtx_t* )TimerGetContext( ), LORAMAC_EVENT_ACK_TIMEOUT, NULL, 0, 0, 0 );
+}
+
+static void OnRxWindow1TimerIrq( void )
+{
+    // The interrupt may preempt the main loop working on another context
+    LoRaMacCtx_t *previous = SwitchCtx( ( LoRaMacCtx_t* )TimerGetContext( ) );
+
+    OnRxWindow1TimerEvent( );
+
+    if( previous != NULL )
+    {
+        SwitchCtx( previous );
+    }
+}
+
+static void OnRxWindow2TimerIrq( void )
+{
+    LoRaMacCtx_t *previous = SwitchCtx( ( LoRaMacCtx_t* )TimerGetContext( ) );
+
+    OnRxWindow2TimerEvent( );
+
+    if( previous != NULL )
+    {
+        SwitchCtx( previous );
+    }
+}
+
+static uint32_t GetRemainingDelay( TimerTime_t time, uint32_t delay )
+{
+    TimerTime_t elapsed = TimerGetElapsedTime( time );
+
+    if( elapsed >= delay )
+    {
+        return 0;
+    }
+    return delay - elapsed;
+}
+
+static void OnRadioTxDone( TimerTime_t txDoneTime )
 {
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
     SetBandTxDoneParams_t txDone;
-    TimerTime_t curTime = TimerGetCurrentTime( );
 
-    if( LoRaMacDeviceClass != CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
@@ -624,78 +559,78 @@ static void OnRadioTxDone( void )
         OnRxWindow2TimerEvent( );
     }
 
-    // Setup timers
-    if( IsRxWindowsEnabled == true )
+    // Setup timers, the delays run from the Tx Done interrupt
+    if( MacCtx->IsRxWindowsEnabled == true )
     {
-        TimerSetValue( &RxWindowTimer1, RxWindow1Delay );
-        TimerStart( &RxWindowTimer1 );
-        if( LoRaMacDeviceClass != CLASS_C )
+        TimerSetValue( &MacCtx->RxWindowTimer1, GetRemainingDelay( txDoneTime, MacCtx->RxWindow1Delay ) );
+        TimerStart( &MacCtx->RxWindowTimer1 );
+        if( MacCtx->LoRaMacDeviceClass != CLASS_C )
         {
-            TimerSetValue( &RxWindowTimer2, RxWindow2Delay );
-            TimerStart( &RxWindowTimer2 );
+            TimerSetValue( &MacCtx->RxWindowTimer2, GetRemainingDelay( txDoneTime, MacCtx->RxWindow2Delay ) );
+            TimerStart( &MacCtx->RxWindowTimer2 );
         }
-        if( ( LoRaMacDeviceClass == CLASS_C ) || ( NodeAckRequested == true ) )
+        if( ( MacCtx->LoRaMacDeviceClass == CLASS_C ) || ( MacCtx->NodeAckRequested == true ) )
         {
             getPhy.Attribute = PHY_ACK_TIMEOUT;
-            phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-            TimerSetValue( &AckTimeoutTimer, RxWindow2Delay + phyParam.Value );
-            TimerStart( &AckTimeoutTimer );
+            phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+            TimerSetValue( &MacCtx->AckTimeoutTimer, GetRemainingDelay( txDoneTime, MacCtx->RxWindow2Delay + phyParam.Value ) );
+            TimerStart( &MacCtx->AckTimeoutTimer );
         }
     }
     else
     {
-        McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-        MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
+        MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+        MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
 
-        if( LoRaMacFlags.Value == 0 )
+        if( MacCtx->LoRaMacFlags.Value == 0 )
         {
-            LoRaMacFlags.Bits.McpsReq = 1;
+            MacCtx->LoRaMacFlags.Bits.McpsReq = 1;
         }
-        LoRaMacFlags.Bits.MacDone = 1;
+        MacCtx->LoRaMacFlags.Bits.MacDone = 1;
     }
 
     // Verify if the last uplink was a join request
-    if( ( LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MlmeConfirm.MlmeRequest == MLME_JOIN ) )
+    if( ( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MacCtx->MlmeConfirm.MlmeRequest == MLME_JOIN ) )
     {
-        LastTxIsJoinRequest = true;
+        MacCtx->LastTxIsJoinRequest = true;
     }
     else
     {
-        LastTxIsJoinRequest = false;
+        MacCtx->LastTxIsJoinRequest = false;
     }
 
     // Store last Tx channel
-    LastTxChannel = Channel;
+    MacCtx->LastTxChannel = MacCtx->Channel;
     // Update last tx done time for the current channel
-    txDone.Channel = Channel;
-    txDone.Joined = IsLoRaMacNetworkJoined;
-    txDone.LastTxDoneTime = curTime;
-    RegionSetBandTxDone( LoRaMacRegion, &txDone );
+    txDone.Channel = MacCtx->Channel;
+    txDone.Joined = MacCtx->IsLoRaMacNetworkJoined;
+    txDone.LastTxDoneTime = txDoneTime;
+    RegionSetBandTxDone( MacCtx->LoRaMacRegion, &txDone );
     // Update Aggregated last tx done time
-    AggregatedLastTxDoneTime = curTime;
+    MacCtx->AggregatedLastTxDoneTime = txDoneTime;
 
-    if( NodeAckRequested == false )
+    if( MacCtx->NodeAckRequested == false )
     {
-        McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-        ChannelsNbRepCounter++;
+        MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+        MacCtx->ChannelsNbRepCounter++;
     }
 }
 
 static void PrepareRxDoneAbort( void )
 {
-    LoRaMacState |= LORAMAC_RX_ABORT;
+    MacCtx->LoRaMacState |= LORAMAC_RX_ABORT;
 
-    if( NodeAckRequested )
+    if( MacCtx->NodeAckRequested )
     {
         OnAckTimeoutTimerEvent( );
     }
 
-    LoRaMacFlags.Bits.McpsInd = 1;
-    LoRaMacFlags.Bits.MacDone = 1;
+    MacCtx->LoRaMacFlags.Bits.McpsInd = 1;
+    MacCtx->LoRaMacFlags.Bits.MacDone = 1;
 
     // Trig OnMacCheckTimerEvent call as soon as possible
-    TimerSetValue( &MacStateCheckTimer, 1 );
-    TimerStart( &MacStateCheckTimer );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, 1 );
+    TimerStart( &MacCtx->MacStateCheckTimer );
 }
 
 static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
@@ -721,111 +656,113 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
     uint32_t downLinkCounter = 0;
 
     MulticastParams_t *curMulticastParams = NULL;
-    uint8_t *nwkSKey = LoRaMacNwkSKey;
-    uint8_t *appSKey = LoRaMacAppSKey;
+    uint8_t *nwkSKey = MacCtx->LoRaMacNwkSKey;
+    uint8_t *appSKey = MacCtx->LoRaMacAppSKey;
 
     uint8_t multicast = 0;
 
     bool isMicOk = false;
 
-    McpsConfirm.AckReceived = false;
-    McpsIndication.Rssi = rssi;
-    McpsIndication.Snr = snr;
-    McpsIndication.RxSlot = RxSlot;
-    McpsIndication.Port = 0;
-    McpsIndication.Multicast = 0;
-    McpsIndication.FramePending = 0;
-    McpsIndication.Buffer = NULL;
-    McpsIndication.BufferSize = 0;
-    McpsIndication.RxData = false;
-    McpsIndication.AckReceived = false;
-    McpsIndication.DownLinkCounter = 0;
-    McpsIndication.McpsIndication = MCPS_UNCONFIRMED;
+    MacCtx->McpsConfirm.AckReceived = false;
+    MacCtx->McpsIndication.Rssi = rssi;
+    MacCtx->McpsIndication.Snr = snr;
+    MacCtx->McpsIndication.RxSlot = MacCtx->RxSlot;
+    MacCtx->McpsIndication.Port = 0;
+    MacCtx->McpsIndication.Multicast = 0;
+    MacCtx->McpsIndication.FramePending = 0;
+    MacCtx->McpsIndication.Buffer = NULL;
+    MacCtx->McpsIndication.BufferSize = 0;
+    MacCtx->McpsIndication.RxData = false;
+    MacCtx->McpsIndication.AckReceived = false;
+    MacCtx->McpsIndication.DownLinkCounter = 0;
+    MacCtx->McpsIndication.McpsIndication = MCPS_UNCONFIRMED;
 
     Radio.Sleep( );
-    TimerStop( &RxWindowTimer2 );
+    TimerStop( &MacCtx->RxWindowTimer2 );
 
     macHdr.Value = payload[pktHeaderLen++];
 
     switch( macHdr.Bits.MType )
     {
         case FRAME_TYPE_JOIN_ACCEPT:
-            if( IsLoRaMacNetworkJoined == true )
+            if( MacCtx->IsLoRaMacNetworkJoined == true )
             {
-                McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+                MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
                 PrepareRxDoneAbort( );
                 return;
             }
-            LoRaMacJoinDecrypt( payload + 1, size - 1, LoRaMacAppKey, LoRaMacRxPayload + 1 );
+            LoRaMacJoinDecrypt( payload + 1, size - 1, MacCtx->LoRaMacAppKey, MacCtx->LoRaMacRxPayload + 1 );
 
-            LoRaMacRxPayload[0] = macHdr.Value;
+            MacCtx->LoRaMacRxPayload[0] = macHdr.Value;
 
-            LoRaMacJoinComputeMic( LoRaMacRxPayload, size - LORAMAC_MFR_LEN, LoRaMacAppKey, &mic );
+            LoRaMacJoinComputeMic( MacCtx->LoRaMacRxPayload, size - LORAMAC_MFR_LEN, MacCtx->LoRaMacAppKey, &mic );
 
-            micRx |= ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN];
-            micRx |= ( ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 1] << 8 );
-            micRx |= ( ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 2] << 16 );
-            micRx |= ( ( uint32_t )LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 3] << 24 );
+            micRx |= ( uint32_t )MacCtx->LoRaMacRxPayload[size - LORAMAC_MFR_LEN];
+            micRx |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 1] << 8 );
+            micRx |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 2] << 16 );
+            micRx |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[size - LORAMAC_MFR_LEN + 3] << 24 );
 
             if( micRx == mic )
             {
-                LoRaMacJoinComputeSKeys( LoRaMacAppKey, LoRaMacRxPayload + 1, LoRaMacDevNonce, LoRaMacNwkSKey, LoRaMacAppSKey );
+                LoRaMacJoinComputeSKeys( MacCtx->LoRaMacAppKey, MacCtx->LoRaMacRxPayload + 1, MacCtx->LoRaMacDevNonce, MacCtx->LoRaMacNwkSKey, MacCtx->LoRaMacAppSKey );
+                LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, MacCtx->LoRaMacNwkSKey );
+                LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, MacCtx->LoRaMacAppSKey );
 
-                LoRaMacNetID = ( uint32_t )LoRaMacRxPayload[4];
-                LoRaMacNetID |= ( ( uint32_t )LoRaMacRxPayload[5] << 8 );
-                LoRaMacNetID |= ( ( uint32_t )LoRaMacRxPayload[6] << 16 );
+                MacCtx->LoRaMacNetID = ( uint32_t )MacCtx->LoRaMacRxPayload[4];
+                MacCtx->LoRaMacNetID |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[5] << 8 );
+                MacCtx->LoRaMacNetID |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[6] << 16 );
 
-                LoRaMacDevAddr = ( uint32_t )LoRaMacRxPayload[7];
-                LoRaMacDevAddr |= ( ( uint32_t )LoRaMacRxPayload[8] << 8 );
-                LoRaMacDevAddr |= ( ( uint32_t )LoRaMacRxPayload[9] << 16 );
-                LoRaMacDevAddr |= ( ( uint32_t )LoRaMacRxPayload[10] << 24 );
+                MacCtx->LoRaMacDevAddr = ( uint32_t )MacCtx->LoRaMacRxPayload[7];
+                MacCtx->LoRaMacDevAddr |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[8] << 8 );
+                MacCtx->LoRaMacDevAddr |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[9] << 16 );
+                MacCtx->LoRaMacDevAddr |= ( ( uint32_t )MacCtx->LoRaMacRxPayload[10] << 24 );
 
                 // DLSettings
-                LoRaMacParams.Rx1DrOffset = ( LoRaMacRxPayload[11] >> 4 ) & 0x07;
-                LoRaMacParams.Rx2Channel.Datarate = LoRaMacRxPayload[11] & 0x0F;
+                MacCtx->LoRaMacParams.Rx1DrOffset = ( MacCtx->LoRaMacRxPayload[11] >> 4 ) & 0x07;
+                MacCtx->LoRaMacParams.Rx2Channel.Datarate = MacCtx->LoRaMacRxPayload[11] & 0x0F;
 
                 // RxDelay
-                LoRaMacParams.ReceiveDelay1 = ( LoRaMacRxPayload[12] & 0x0F );
-                if( LoRaMacParams.ReceiveDelay1 == 0 )
+                MacCtx->LoRaMacParams.ReceiveDelay1 = ( MacCtx->LoRaMacRxPayload[12] & 0x0F );
+                if( MacCtx->LoRaMacParams.ReceiveDelay1 == 0 )
                 {
-                    LoRaMacParams.ReceiveDelay1 = 1;
+                    MacCtx->LoRaMacParams.ReceiveDelay1 = 1;
                 }
-                LoRaMacParams.ReceiveDelay1 *= 1000;
-                LoRaMacParams.ReceiveDelay2 = LoRaMacParams.ReceiveDelay1 + 1000;
+                MacCtx->LoRaMacParams.ReceiveDelay1 *= 1000;
+                MacCtx->LoRaMacParams.ReceiveDelay2 = MacCtx->LoRaMacParams.ReceiveDelay1 + 1000;
 
                 // Apply CF list
-                applyCFList.Payload = &LoRaMacRxPayload[13];
+                applyCFList.Payload = &MacCtx->LoRaMacRxPayload[13];
                 // Size of the regular payload is 12. Plus 1 byte MHDR and 4 bytes MIC
                 applyCFList.Size = size - 17;
 
-                RegionApplyCFList( LoRaMacRegion, &applyCFList );
+                RegionApplyCFList( MacCtx->LoRaMacRegion, &applyCFList );
 
-                MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-                IsLoRaMacNetworkJoined = true;
-                LoRaMacParams.ChannelsDatarate = LoRaMacParamsDefaults.ChannelsDatarate;
+                MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+                MacCtx->IsLoRaMacNetworkJoined = true;
+                MacCtx->LoRaMacParams.ChannelsDatarate = MacCtx->LoRaMacParamsDefaults.ChannelsDatarate;
             }
             else
             {
-                MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_JOIN_FAIL;
+                MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_JOIN_FAIL;
             }
             break;
         case FRAME_TYPE_DATA_CONFIRMED_DOWN:
         case FRAME_TYPE_DATA_UNCONFIRMED_DOWN:
             {
                 // Check if the received payload size is valid
-                getPhy.UplinkDwellTime = LoRaMacParams.DownlinkDwellTime;
-                getPhy.Datarate = McpsIndication.RxDatarate;
+                getPhy.UplinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
+                getPhy.Datarate = MacCtx->McpsIndication.RxDatarate;
                 getPhy.Attribute = PHY_MAX_PAYLOAD;
 
                 // Get the maximum payload length
-                if( RepeaterSupport == true )
+                if( MacCtx->RepeaterSupport == true )
                 {
                     getPhy.Attribute = PHY_MAX_PAYLOAD_REPEATER;
                 }
-                phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+                phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
                 if( MAX( 0, ( int16_t )( ( int16_t )size - ( int16_t )LORA_MAC_FRMPAYLOAD_OVERHEAD ) ) > phyParam.Value )
                 {
-                    McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+                    MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
                     PrepareRxDoneAbort( );
                     return;
                 }
@@ -835,9 +772,9 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                 address |= ( (uint32_t)payload[pktHeaderLen++] << 16 );
                 address |= ( (uint32_t)payload[pktHeaderLen++] << 24 );
 
-                if( address != LoRaMacDevAddr )
+                if( address != MacCtx->LoRaMacDevAddr )
                 {
-                    curMulticastParams = MulticastChannels;
+                    curMulticastParams = MacCtx->MulticastChannels;
                     while( curMulticastParams != NULL )
                     {
                         if( address == curMulticastParams->Address )
@@ -853,7 +790,7 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                     if( multicast == 0 )
                     {
                         // We are not the destination of this frame.
-                        McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ADDRESS_FAIL;
+                        MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ADDRESS_FAIL;
                         PrepareRxDoneAbort( );
                         return;
                     }
@@ -861,9 +798,9 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                 else
                 {
                     multicast = 0;
-                    nwkSKey = LoRaMacNwkSKey;
-                    appSKey = LoRaMacAppSKey;
-                    downLinkCounter = DownLinkCounter;
+                    nwkSKey = MacCtx->LoRaMacNwkSKey;
+                    appSKey = MacCtx->LoRaMacAppSKey;
+                    downLinkCounter = MacCtx->DownLinkCounter;
                 }
 
                 fCtrl.Value = payload[pktHeaderLen++];
@@ -904,39 +841,39 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
 
                 // Check for a the maximum allowed counter difference
                 getPhy.Attribute = PHY_MAX_FCNT_GAP;
-                phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+                phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
                 if( sequenceCounterDiff >= phyParam.Value )
                 {
-                    McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_TOO_MANY_FRAMES_LOSS;
-                    McpsIndication.DownLinkCounter = downLinkCounter;
+                    MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_TOO_MANY_FRAMES_LOSS;
+                    MacCtx->McpsIndication.DownLinkCounter = downLinkCounter;
                     PrepareRxDoneAbort( );
                     return;
                 }
 
                 if( isMicOk == true )
                 {
-                    McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-                    McpsIndication.Multicast = multicast;
-                    McpsIndication.FramePending = fCtrl.Bits.FPending;
-                    McpsIndication.Buffer = NULL;
-                    McpsIndication.BufferSize = 0;
-                    McpsIndication.DownLinkCounter = downLinkCounter;
+                    MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+                    MacCtx->McpsIndication.Multicast = multicast;
+                    MacCtx->McpsIndication.FramePending = fCtrl.Bits.FPending;
+                    MacCtx->McpsIndication.Buffer = NULL;
+                    MacCtx->McpsIndication.BufferSize = 0;
+                    MacCtx->McpsIndication.DownLinkCounter = downLinkCounter;
 
-                    McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+                    MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
 
-                    AdrAckCounter = 0;
-                    MacCommandsBufferToRepeatIndex = 0;
+                    MacCtx->AdrAckCounter = 0;
+                    MacCtx->MacCommandsBufferToRepeatIndex = 0;
 
                     // Update 32 bits downlink counter
                     if( multicast == 1 )
                     {
-                        McpsIndication.McpsIndication = MCPS_MULTICAST;
+                        MacCtx->McpsIndication.McpsIndication = MCPS_MULTICAST;
 
                         if( ( curMulticastParams->DownLinkCounter == downLinkCounter ) &&
                             ( curMulticastParams->DownLinkCounter != 0 ) )
                         {
-                            McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_REPEATED;
-                            McpsIndication.DownLinkCounter = downLinkCounter;
+                            MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_REPEATED;
+                            MacCtx->McpsIndication.DownLinkCounter = downLinkCounter;
                             PrepareRxDoneAbort( );
                             return;
                         }
@@ -946,11 +883,11 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                     {
                         if( macHdr.Bits.MType == FRAME_TYPE_DATA_CONFIRMED_DOWN )
                         {
-                            SrvAckRequested = true;
-                            McpsIndication.McpsIndication = MCPS_CONFIRMED;
+                            MacCtx->SrvAckRequested = true;
+                            MacCtx->McpsIndication.McpsIndication = MCPS_CONFIRMED;
 
-                            if( ( DownLinkCounter == downLinkCounter ) &&
-                                ( DownLinkCounter != 0 ) )
+                            if( ( MacCtx->DownLinkCounter == downLinkCounter ) &&
+                                ( MacCtx->DownLinkCounter != 0 ) )
                             {
                                 // Duplicated confirmed downlink. Skip indication.
                                 // In this case, the MAC layer shall accept the MAC commands
@@ -962,35 +899,35 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                         }
                         else
                         {
-                            SrvAckRequested = false;
-                            McpsIndication.McpsIndication = MCPS_UNCONFIRMED;
+                            MacCtx->SrvAckRequested = false;
+                            MacCtx->McpsIndication.McpsIndication = MCPS_UNCONFIRMED;
 
-                            if( ( DownLinkCounter == downLinkCounter ) &&
-                                ( DownLinkCounter != 0 ) )
+                            if( ( MacCtx->DownLinkCounter == downLinkCounter ) &&
+                                ( MacCtx->DownLinkCounter != 0 ) )
                             {
-                                McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_REPEATED;
-                                McpsIndication.DownLinkCounter = downLinkCounter;
+                                MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_DOWNLINK_REPEATED;
+                                MacCtx->McpsIndication.DownLinkCounter = downLinkCounter;
                                 PrepareRxDoneAbort( );
                                 return;
                             }
                         }
-                        DownLinkCounter = downLinkCounter;
+                        MacCtx->DownLinkCounter = downLinkCounter;
                     }
 
                     // This must be done before parsing the payload and the MAC commands.
                     // We need to reset the MacCommandsBufferIndex here, since we need
                     // to take retransmissions and repetitions into account. Error cases
                     // will be handled in function OnMacStateCheckTimerEvent.
-                    if( McpsConfirm.McpsRequest == MCPS_CONFIRMED )
+                    if( MacCtx->McpsConfirm.McpsRequest == MCPS_CONFIRMED )
                     {
                         if( fCtrl.Bits.Ack == 1 )
                         {// Reset MacCommandsBufferIndex when we have received an ACK.
-                            MacCommandsBufferIndex = 0;
+                            MacCtx->MacCommandsBufferIndex = 0;
                         }
                     }
                     else
                     {// Reset the variable if we have received any valid frame.
-                        MacCommandsBufferIndex = 0;
+                        MacCtx->MacCommandsBufferIndex = 0;
                     }
 
                     // Process payload and MAC commands
@@ -999,7 +936,7 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                         port = payload[appPayloadStartIndex++];
                         frameLen = ( size - 4 ) - appPayloadStartIndex;
 
-                        McpsIndication.Port = port;
+                        MacCtx->McpsIndication.Port = port;
 
                         if( port == 0 )
                         {
@@ -1012,10 +949,10 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                                                        address,
                                                        DOWN_LINK,
                                                        downLinkCounter,
-                                                       LoRaMacRxPayload );
+                                                       MacCtx->LoRaMacRxPayload );
 
                                 // Decode frame payload MAC commands
-                                ProcessMacCommands( LoRaMacRxPayload, 0, frameLen, snr );
+                                ProcessMacCommands( MacCtx->LoRaMacRxPayload, 0, frameLen, snr );
                             }
                             else
                             {
@@ -1036,13 +973,13 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                                                    address,
                                                    DOWN_LINK,
                                                    downLinkCounter,
-                                                   LoRaMacRxPayload );
+                                                   MacCtx->LoRaMacRxPayload );
 
                             if( skipIndication == false )
                             {
-                                McpsIndication.Buffer = LoRaMacRxPayload;
-                                McpsIndication.BufferSize = frameLen;
-                                McpsIndication.RxData = true;
+                                MacCtx->McpsIndication.Buffer = MacCtx->LoRaMacRxPayload;
+                                MacCtx->McpsIndication.BufferSize = frameLen;
+                                MacCtx->McpsIndication.RxData = true;
                             }
                         }
                     }
@@ -1060,33 +997,33 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
                         // Check if the frame is an acknowledgement
                         if( fCtrl.Bits.Ack == 1 )
                         {
-                            McpsConfirm.AckReceived = true;
-                            McpsIndication.AckReceived = true;
+                            MacCtx->McpsConfirm.AckReceived = true;
+                            MacCtx->McpsIndication.AckReceived = true;
 
                             // Stop the AckTimeout timer as no more retransmissions
                             // are needed.
-                            TimerStop( &AckTimeoutTimer );
+                            TimerStop( &MacCtx->AckTimeoutTimer );
                         }
                         else
                         {
-                            McpsConfirm.AckReceived = false;
+                            MacCtx->McpsConfirm.AckReceived = false;
 
-                            if( AckTimeoutRetriesCounter > AckTimeoutRetries )
+                            if( MacCtx->AckTimeoutRetriesCounter > MacCtx->AckTimeoutRetries )
                             {
                                 // Stop the AckTimeout timer as no more retransmissions
                                 // are needed.
-                                TimerStop( &AckTimeoutTimer );
+                                TimerStop( &MacCtx->AckTimeoutTimer );
                             }
                         }
                     }
                     // Provide always an indication, skip the callback to the user application,
                     // in case of a confirmed downlink retransmission.
-                    LoRaMacFlags.Bits.McpsInd = 1;
-                    LoRaMacFlags.Bits.McpsIndSkip = skipIndication;
+                    MacCtx->LoRaMacFlags.Bits.McpsInd = 1;
+                    MacCtx->LoRaMacFlags.Bits.McpsIndSkip = skipIndication;
                 }
                 else
                 {
-                    McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_MIC_FAIL;
+                    MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_MIC_FAIL;
 
                     PrepareRxDoneAbort( );
                     return;
@@ -1095,31 +1032,31 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
             break;
         case FRAME_TYPE_PROPRIETARY:
             {
-                memcpy1( LoRaMacRxPayload, &payload[pktHeaderLen], size );
+                memcpy1( MacCtx->LoRaMacRxPayload, &payload[pktHeaderLen], size );
 
-                McpsIndication.McpsIndication = MCPS_PROPRIETARY;
-                McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-                McpsIndication.Buffer = LoRaMacRxPayload;
-                McpsIndication.BufferSize = size - pktHeaderLen;
+                MacCtx->McpsIndication.McpsIndication = MCPS_PROPRIETARY;
+                MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+                MacCtx->McpsIndication.Buffer = MacCtx->LoRaMacRxPayload;
+                MacCtx->McpsIndication.BufferSize = size - pktHeaderLen;
 
-                LoRaMacFlags.Bits.McpsInd = 1;
+                MacCtx->LoRaMacFlags.Bits.McpsInd = 1;
                 break;
             }
         default:
-            McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+            MacCtx->McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
             PrepareRxDoneAbort( );
             break;
     }
-    LoRaMacFlags.Bits.MacDone = 1;
+    MacCtx->LoRaMacFlags.Bits.MacDone = 1;
 
     // Trig OnMacCheckTimerEvent call as soon as possible
-    TimerSetValue( &MacStateCheckTimer, 1 );
-    TimerStart( &MacStateCheckTimer );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, 1 );
+    TimerStart( &MacCtx->MacStateCheckTimer );
 }
 
 static void OnRadioTxTimeout( void )
 {
-    if( LoRaMacDeviceClass != CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
@@ -1128,14 +1065,14 @@ static void OnRadioTxTimeout( void )
         OnRxWindow2TimerEvent( );
     }
 
-    McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT;
-    MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT;
-    LoRaMacFlags.Bits.MacDone = 1;
+    MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT;
+    MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT;
+    MacCtx->LoRaMacFlags.Bits.MacDone = 1;
 }
 
 static void OnRadioRxError( void )
 {
-    if( LoRaMacDeviceClass != CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
@@ -1144,33 +1081,33 @@ static void OnRadioRxError( void )
         OnRxWindow2TimerEvent( );
     }
 
-    if( RxSlot == 0 )
+    if( MacCtx->RxSlot == 0 )
     {
-        if( NodeAckRequested == true )
+        if( MacCtx->NodeAckRequested == true )
         {
-            McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_ERROR;
+            MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_ERROR;
         }
-        MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_ERROR;
+        MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_ERROR;
 
-        if( TimerGetElapsedTime( AggregatedLastTxDoneTime ) >= RxWindow2Delay )
+        if( TimerGetElapsedTime( MacCtx->AggregatedLastTxDoneTime ) >= MacCtx->RxWindow2Delay )
         {
-            LoRaMacFlags.Bits.MacDone = 1;
+            MacCtx->LoRaMacFlags.Bits.MacDone = 1;
         }
     }
     else
     {
-        if( NodeAckRequested == true )
+        if( MacCtx->NodeAckRequested == true )
         {
-            McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_ERROR;
+            MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_ERROR;
         }
-        MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_ERROR;
-        LoRaMacFlags.Bits.MacDone = 1;
+        MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_ERROR;
+        MacCtx->LoRaMacFlags.Bits.MacDone = 1;
     }
 }
 
 static void OnRadioRxTimeout( void )
 {
-    if( LoRaMacDeviceClass != CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
@@ -1179,30 +1116,30 @@ static void OnRadioRxTimeout( void )
         OnRxWindow2TimerEvent( );
     }
 
-    if( RxSlot == 0 )
+    if( MacCtx->RxSlot == 0 )
     {
-        if( NodeAckRequested == true )
+        if( MacCtx->NodeAckRequested == true )
         {
-            McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT;
+            MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT;
         }
-        MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT;
+        MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT;
 
-        if( TimerGetElapsedTime( AggregatedLastTxDoneTime ) >= RxWindow2Delay )
+        if( TimerGetElapsedTime( MacCtx->AggregatedLastTxDoneTime ) >= MacCtx->RxWindow2Delay )
         {
-            LoRaMacFlags.Bits.MacDone = 1;
+            MacCtx->LoRaMacFlags.Bits.MacDone = 1;
         }
     }
     else
     {
-        if( NodeAckRequested == true )
+        if( MacCtx->NodeAckRequested == true )
         {
-            McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
+            MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
         }
-        MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
+        MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT;
 
-        if( LoRaMacDeviceClass != CLASS_C )
+        if( MacCtx->LoRaMacDeviceClass != CLASS_C )
         {
-            LoRaMacFlags.Bits.MacDone = 1;
+            MacCtx->LoRaMacFlags.Bits.MacDone = 1;
         }
     }
 }
@@ -1213,54 +1150,54 @@ static void OnMacStateCheckTimerEvent( void )
     PhyParam_t phyParam;
     bool txTimeout = false;
 
-    TimerStop( &MacStateCheckTimer );
+    TimerStop( &MacCtx->MacStateCheckTimer );
 
-    if( LoRaMacFlags.Bits.MacDone == 1 )
+    if( MacCtx->LoRaMacFlags.Bits.MacDone == 1 )
     {
-        if( ( LoRaMacState & LORAMAC_RX_ABORT ) == LORAMAC_RX_ABORT )
+        if( ( MacCtx->LoRaMacState & LORAMAC_RX_ABORT ) == LORAMAC_RX_ABORT )
         {
-            LoRaMacState &= ~LORAMAC_RX_ABORT;
-            LoRaMacState &= ~LORAMAC_TX_RUNNING;
+            MacCtx->LoRaMacState &= ~LORAMAC_RX_ABORT;
+            MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
         }
 
-        if( ( LoRaMacFlags.Bits.MlmeReq == 1 ) || ( ( LoRaMacFlags.Bits.McpsReq == 1 ) ) )
+        if( ( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 ) || ( ( MacCtx->LoRaMacFlags.Bits.McpsReq == 1 ) ) )
         {
-            if( ( McpsConfirm.Status == LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT ) ||
-                ( MlmeConfirm.Status == LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT ) )
+            if( ( MacCtx->McpsConfirm.Status == LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT ) ||
+                ( MacCtx->MlmeConfirm.Status == LORAMAC_EVENT_INFO_STATUS_TX_TIMEOUT ) )
             {
                 // Stop transmit cycle due to tx timeout.
-                LoRaMacState &= ~LORAMAC_TX_RUNNING;
-                MacCommandsBufferIndex = 0;
-                McpsConfirm.NbRetries = AckTimeoutRetriesCounter;
-                McpsConfirm.AckReceived = false;
-                McpsConfirm.TxTimeOnAir = 0;
+                MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                MacCtx->MacCommandsBufferIndex = 0;
+                MacCtx->McpsConfirm.NbRetries = MacCtx->AckTimeoutRetriesCounter;
+                MacCtx->McpsConfirm.AckReceived = false;
+                MacCtx->McpsConfirm.TxTimeOnAir = 0;
                 txTimeout = true;
             }
         }
 
-        if( ( NodeAckRequested == false ) && ( txTimeout == false ) )
+        if( ( MacCtx->NodeAckRequested == false ) && ( txTimeout == false ) )
         {
-            if( ( LoRaMacFlags.Bits.MlmeReq == 1 ) || ( ( LoRaMacFlags.Bits.McpsReq == 1 ) ) )
+            if( ( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 ) || ( ( MacCtx->LoRaMacFlags.Bits.McpsReq == 1 ) ) )
             {
-                if( ( LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MlmeConfirm.MlmeRequest == MLME_JOIN ) )
+                if( ( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MacCtx->MlmeConfirm.MlmeRequest == MLME_JOIN ) )
                 {// Procedure for the join request
-                    MlmeConfirm.NbRetries = JoinRequestTrials;
+                    MacCtx->MlmeConfirm.NbRetries = MacCtx->JoinRequestTrials;
 
-                    if( MlmeConfirm.Status == LORAMAC_EVENT_INFO_STATUS_OK )
+                    if( MacCtx->MlmeConfirm.Status == LORAMAC_EVENT_INFO_STATUS_OK )
                     {// Node joined successfully
-                        UpLinkCounter = 0;
-                        ChannelsNbRepCounter = 0;
-                        LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                        MacCtx->UpLinkCounter = 0;
+                        MacCtx->ChannelsNbRepCounter = 0;
+                        MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
                     }
                     else
                     {
-                        if( JoinRequestTrials >= MaxJoinRequestTrials )
+                        if( MacCtx->JoinRequestTrials >= MacCtx->MaxJoinRequestTrials )
                         {
-                            LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                            MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
                         }
                         else
                         {
-                            LoRaMacFlags.Bits.MacDone = 0;
+                            MacCtx->LoRaMacFlags.Bits.MacDone = 0;
                             // Sends the same frame again
                             OnTxDelayedTimerEvent( );
                         }
@@ -1268,27 +1205,27 @@ static void OnMacStateCheckTimerEvent( void )
                 }
                 else
                 {// Procedure for all other frames
-                    if( ( ChannelsNbRepCounter >= LoRaMacParams.ChannelsNbRep ) || ( LoRaMacFlags.Bits.McpsInd == 1 ) )
+                    if( ( MacCtx->ChannelsNbRepCounter >= MacCtx->LoRaMacParams.ChannelsNbRep ) || ( MacCtx->LoRaMacFlags.Bits.McpsInd == 1 ) )
                     {
-                        if( LoRaMacFlags.Bits.McpsInd == 0 )
+                        if( MacCtx->LoRaMacFlags.Bits.McpsInd == 0 )
                         {   // Maximum repetitions without downlink. Reset MacCommandsBufferIndex. Increase ADR Ack counter.
                             // Only process the case when the MAC did not receive a downlink.
-                            MacCommandsBufferIndex = 0;
-                            AdrAckCounter++;
+                            MacCtx->MacCommandsBufferIndex = 0;
+                            MacCtx->AdrAckCounter++;
                         }
 
-                        ChannelsNbRepCounter = 0;
+                        MacCtx->ChannelsNbRepCounter = 0;
 
-                        if( IsUpLinkCounterFixed == false )
+                        if( MacCtx->IsUpLinkCounterFixed == false )
                         {
-                            UpLinkCounter++;
+                            MacCtx->UpLinkCounter++;
                         }
 
-                        LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                        MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
                     }
                     else
                     {
-                        LoRaMacFlags.Bits.MacDone = 0;
+                        MacCtx->LoRaMacFlags.Bits.MacDone = 0;
                         // Sends the same frame again
                         OnTxDelayedTimerEvent( );
                     }
@@ -1296,117 +1233,117 @@ static void OnMacStateCheckTimerEvent( void )
             }
         }
 
-        if( LoRaMacFlags.Bits.McpsInd == 1 )
+        if( MacCtx->LoRaMacFlags.Bits.McpsInd == 1 )
         {// Procedure if we received a frame
-            if( ( McpsConfirm.AckReceived == true ) || ( AckTimeoutRetriesCounter > AckTimeoutRetries ) )
+            if( ( MacCtx->McpsConfirm.AckReceived == true ) || ( MacCtx->AckTimeoutRetriesCounter > MacCtx->AckTimeoutRetries ) )
             {
-                AckTimeoutRetry = false;
-                NodeAckRequested = false;
-                if( IsUpLinkCounterFixed == false )
+                MacCtx->AckTimeoutRetry = false;
+                MacCtx->NodeAckRequested = false;
+                if( MacCtx->IsUpLinkCounterFixed == false )
                 {
-                    UpLinkCounter++;
+                    MacCtx->UpLinkCounter++;
                 }
-                McpsConfirm.NbRetries = AckTimeoutRetriesCounter;
+                MacCtx->McpsConfirm.NbRetries = MacCtx->AckTimeoutRetriesCounter;
 
-                LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
             }
         }
 
-        if( ( AckTimeoutRetry == true ) && ( ( LoRaMacState & LORAMAC_TX_DELAYED ) == 0 ) )
+        if( ( MacCtx->AckTimeoutRetry == true ) && ( ( MacCtx->LoRaMacState & LORAMAC_TX_DELAYED ) == 0 ) )
         {// Retransmissions procedure for confirmed uplinks
-            AckTimeoutRetry = false;
-            if( ( AckTimeoutRetriesCounter < AckTimeoutRetries ) && ( AckTimeoutRetriesCounter <= MAX_ACK_RETRIES ) )
+            MacCtx->AckTimeoutRetry = false;
+            if( ( MacCtx->AckTimeoutRetriesCounter < MacCtx->AckTimeoutRetries ) && ( MacCtx->AckTimeoutRetriesCounter <= MAX_ACK_RETRIES ) )
             {
-                AckTimeoutRetriesCounter++;
+                MacCtx->AckTimeoutRetriesCounter++;
 
-                if( ( AckTimeoutRetriesCounter % 2 ) == 1 )
+                if( ( MacCtx->AckTimeoutRetriesCounter % 2 ) == 1 )
                 {
                     getPhy.Attribute = PHY_NEXT_LOWER_TX_DR;
-                    getPhy.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
-                    getPhy.Datarate = LoRaMacParams.ChannelsDatarate;
-                    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-                    LoRaMacParams.ChannelsDatarate = phyParam.Value;
+                    getPhy.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
+                    getPhy.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+                    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+                    MacCtx->LoRaMacParams.ChannelsDatarate = phyParam.Value;
                 }
                 // Try to send the frame again
                 if( ScheduleTx( ) == LORAMAC_STATUS_OK )
                 {
-                    LoRaMacFlags.Bits.MacDone = 0;
+                    MacCtx->LoRaMacFlags.Bits.MacDone = 0;
                 }
                 else
                 {
                     // The DR is not applicable for the payload size
-                    McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_DR_PAYLOAD_SIZE_ERROR;
-
-                    MacCommandsBufferIndex = 0;
-                    LoRaMacState &= ~LORAMAC_TX_RUNNING;
-                    NodeAckRequested = false;
-                    McpsConfirm.AckReceived = false;
-                    McpsConfirm.NbRetries = AckTimeoutRetriesCounter;
-                    McpsConfirm.Datarate = LoRaMacParams.ChannelsDatarate;
-                    if( IsUpLinkCounterFixed == false )
+                    MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_TX_DR_PAYLOAD_SIZE_ERROR;
+
+                    MacCtx->MacCommandsBufferIndex = 0;
+                    MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                    MacCtx->NodeAckRequested = false;
+                    MacCtx->McpsConfirm.AckReceived = false;
+                    MacCtx->McpsConfirm.NbRetries = MacCtx->AckTimeoutRetriesCounter;
+                    MacCtx->McpsConfirm.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+                    if( MacCtx->IsUpLinkCounterFixed == false )
                     {
-                        UpLinkCounter++;
+                        MacCtx->UpLinkCounter++;
                     }
                 }
             }
             else
             {
-                RegionInitDefaults( LoRaMacRegion, INIT_TYPE_RESTORE );
+                RegionInitDefaults( MacCtx->LoRaMacRegion, INIT_TYPE_RESTORE );
 
-                LoRaMacState &= ~LORAMAC_TX_RUNNING;
+                MacCtx->LoRaMacState &= ~LORAMAC_TX_RUNNING;
 
-                MacCommandsBufferIndex = 0;
-                NodeAckRequested = false;
-                McpsConfirm.AckReceived = false;
-                McpsConfirm.NbRetries = AckTimeoutRetriesCounter;
-                if( IsUpLinkCounterFixed == false )
+                MacCtx->MacCommandsBufferIndex = 0;
+                MacCtx->NodeAckRequested = false;
+                MacCtx->McpsConfirm.AckReceived = false;
+                MacCtx->McpsConfirm.NbRetries = MacCtx->AckTimeoutRetriesCounter;
+                if( MacCtx->IsUpLinkCounterFixed == false )
                 {
-                    UpLinkCounter++;
+                    MacCtx->UpLinkCounter++;
                 }
             }
         }
     }
     // Handle reception for Class B and Class C
-    if( ( LoRaMacState & LORAMAC_RX ) == LORAMAC_RX )
+    if( ( MacCtx->LoRaMacState & LORAMAC_RX ) == LORAMAC_RX )
     {
-        LoRaMacState &= ~LORAMAC_RX;
+        MacCtx->LoRaMacState &= ~LORAMAC_RX;
     }
-    if( LoRaMacState == LORAMAC_IDLE )
+    if( MacCtx->LoRaMacState == LORAMAC_IDLE )
     {
-        if( LoRaMacFlags.Bits.McpsReq == 1 )
+        if( MacCtx->LoRaMacFlags.Bits.McpsReq == 1 )
         {
-            LoRaMacPrimitives->MacMcpsConfirm( &McpsConfirm );
-            LoRaMacFlags.Bits.McpsReq = 0;
+            MacCtx->LoRaMacPrimitives->MacMcpsConfirm( &MacCtx->McpsConfirm );
+            MacCtx->LoRaMacFlags.Bits.McpsReq = 0;
         }
 
-        if( LoRaMacFlags.Bits.MlmeReq == 1 )
+        if( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 )
         {
-            LoRaMacPrimitives->MacMlmeConfirm( &MlmeConfirm );
-            LoRaMacFlags.Bits.MlmeReq = 0;
+            MacCtx->LoRaMacPrimitives->MacMlmeConfirm( &MacCtx->MlmeConfirm );
+            MacCtx->LoRaMacFlags.Bits.MlmeReq = 0;
         }
 
         // Procedure done. Reset variables.
-        LoRaMacFlags.Bits.MacDone = 0;
+        MacCtx->LoRaMacFlags.Bits.MacDone = 0;
     }
     else
     {
         // Operation not finished restart timer
-        TimerSetValue( &MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
-        TimerStart( &MacStateCheckTimer );
+        TimerSetValue( &MacCtx->MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+        TimerStart( &MacCtx->MacStateCheckTimer );
     }
 
-    if( LoRaMacFlags.Bits.McpsInd == 1 )
+    if( MacCtx->LoRaMacFlags.Bits.McpsInd == 1 )
     {
-        if( LoRaMacDeviceClass == CLASS_C )
+        if( MacCtx->LoRaMacDeviceClass == CLASS_C )
         {// Activate RX2 window for Class C
             OnRxWindow2TimerEvent( );
         }
-        if( LoRaMacFlags.Bits.McpsIndSkip == 0 )
+        if( MacCtx->LoRaMacFlags.Bits.McpsIndSkip == 0 )
         {
-            LoRaMacPrimitives->MacMcpsIndication( &McpsIndication );
+            MacCtx->LoRaMacPrimitives->MacMcpsIndication( &MacCtx->McpsIndication );
         }
-        LoRaMacFlags.Bits.McpsIndSkip = 0;
-        LoRaMacFlags.Bits.McpsInd = 0;
+        MacCtx->LoRaMacFlags.Bits.McpsIndSkip = 0;
+        MacCtx->LoRaMacFlags.Bits.McpsInd = 0;
     }
 }
 
@@ -1416,21 +1353,21 @@ static void OnTxDelayedTimerEvent( void )
     LoRaMacFrameCtrl_t fCtrl;
     AlternateDrParams_t altDr;
 
-    TimerStop( &TxDelayedTimer );
-    LoRaMacState &= ~LORAMAC_TX_DELAYED;
+    TimerStop( &MacCtx->TxDelayedTimer );
+    MacCtx->LoRaMacState &= ~LORAMAC_TX_DELAYED;
 
-    if( ( LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MlmeConfirm.MlmeRequest == MLME_JOIN ) )
+    if( ( MacCtx->LoRaMacFlags.Bits.MlmeReq == 1 ) && ( MacCtx->MlmeConfirm.MlmeRequest == MLME_JOIN ) )
     {
         ResetMacParameters( );
 
-        altDr.NbTrials = JoinRequestTrials + 1;
-        LoRaMacParams.ChannelsDatarate = RegionAlternateDr( LoRaMacRegion, &altDr );
+        altDr.NbTrials = MacCtx->JoinRequestTrials + 1;
+        MacCtx->LoRaMacParams.ChannelsDatarate = RegionAlternateDr( MacCtx->LoRaMacRegion, &altDr );
 
         macHdr.Value = 0;
         macHdr.Bits.MType = FRAME_TYPE_JOIN_REQ;
 
         fCtrl.Value = 0;
-        fCtrl.Bits.Adr = AdrCtrlOn;
+        fCtrl.Bits.Adr = MacCtx->AdrCtrlOn;
 
         /* In case of join request retransmissions, the stack must prepare
          * the frame again, because the network server keeps track of the random
@@ -1443,63 +1380,65 @@ static void OnTxDelayedTimerEvent( void )
 
 static void OnRxWindow1TimerEvent( void )
 {
-    TimerStop( &RxWindowTimer1 );
-    RxSlot = 0;
+    TimerStop( &MacCtx->RxWindowTimer1 );
+    MacCtx->RxSlot = 0;
 
-    RxWindow1Config.Channel = Channel;
-    RxWindow1Config.DrOffset = LoRaMacParams.Rx1DrOffset;
-    RxWindow1Config.DownlinkDwellTime = LoRaMacParams.DownlinkDwellTime;
-    RxWindow1Config.RepeaterSupport = RepeaterSupport;
-    RxWindow1Config.RxContinuous = false;
-    RxWindow1Config.Window = RxSlot;
+    MacCtx->RxWindow1Config.Channel = MacCtx->Channel;
+    MacCtx->RxWindow1Config.DrOffset = MacCtx->LoRaMacParams.Rx1DrOffset;
+    MacCtx->RxWindow1Config.DownlinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
+    MacCtx->RxWindow1Config.RepeaterSupport = MacCtx->RepeaterSupport;
+    MacCtx->RxWindow1Config.RxContinuous = false;
+    MacCtx->RxWindow1Config.Window = MacCtx->RxSlot;
 
-    if( LoRaMacDeviceClass == CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass == CLASS_C )
     {
         Radio.Standby( );
     }
 
-    RegionRxConfig( LoRaMacRegion, &RxWindow1Config, ( int8_t* )&McpsIndication.RxDatarate );
-    RxWindowSetup( RxWindow1Config.RxContinuous, LoRaMacParams.MaxRxWindow );
+    TakeRadio( );
+    RegionRxConfig( MacCtx->LoRaMacRegion, &MacCtx->RxWindow1Config, ( int8_t* )&MacCtx->McpsIndication.RxDatarate );
+    RxWindowSetup( MacCtx->RxWindow1Config.RxContinuous, MacCtx->LoRaMacParams.MaxRxWindow );
 }
 
 static void OnRxWindow2TimerEvent( void )
 {
-    TimerStop( &RxWindowTimer2 );
+    TimerStop( &MacCtx->RxWindowTimer2 );
 
-    RxWindow2Config.Channel = Channel;
-    RxWindow2Config.Frequency = LoRaMacParams.Rx2Channel.Frequency;
-    RxWindow2Config.DownlinkDwellTime = LoRaMacParams.DownlinkDwellTime;
-    RxWindow2Config.RepeaterSupport = RepeaterSupport;
-    RxWindow2Config.Window = 1;
+    MacCtx->RxWindow2Config.Channel = MacCtx->Channel;
+    MacCtx->RxWindow2Config.Frequency = MacCtx->LoRaMacParams.Rx2Channel.Frequency;
+    MacCtx->RxWindow2Config.DownlinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
+    MacCtx->RxWindow2Config.RepeaterSupport = MacCtx->RepeaterSupport;
+    MacCtx->RxWindow2Config.Window = 1;
 
-    if( LoRaMacDeviceClass != CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass != CLASS_C )
     {
-        RxWindow2Config.RxContinuous = false;
+        MacCtx->RxWindow2Config.RxContinuous = false;
     }
     else
     {
-        RxWindow2Config.RxContinuous = true;
+        MacCtx->RxWindow2Config.RxContinuous = true;
     }
 
-    if( RegionRxConfig( LoRaMacRegion, &RxWindow2Config, ( int8_t* )&McpsIndication.RxDatarate ) == true )
+    TakeRadio( );
+    if( RegionRxConfig( MacCtx->LoRaMacRegion, &MacCtx->RxWindow2Config, ( int8_t* )&MacCtx->McpsIndication.RxDatarate ) == true )
     {
-        RxWindowSetup( RxWindow2Config.RxContinuous, LoRaMacParams.MaxRxWindow );
-        RxSlot = RxWindow2Config.Window;
+        RxWindowSetup( MacCtx->RxWindow2Config.RxContinuous, MacCtx->LoRaMacParams.MaxRxWindow );
+        MacCtx->RxSlot = MacCtx->RxWindow2Config.Window;
     }
 }
 
 static void OnAckTimeoutTimerEvent( void )
 {
-    TimerStop( &AckTimeoutTimer );
+    TimerStop( &MacCtx->AckTimeoutTimer );
 
-    if( NodeAckRequested == true )
+    if( MacCtx->NodeAckRequested == true )
     {
-        AckTimeoutRetry = true;
-        LoRaMacState &= ~LORAMAC_ACK_REQ;
+        MacCtx->AckTimeoutRetry = true;
+        MacCtx->LoRaMacState &= ~LORAMAC_ACK_REQ;
     }
-    if( LoRaMacDeviceClass == CLASS_C )
+    if( MacCtx->LoRaMacDeviceClass == CLASS_C )
     {
-        LoRaMacFlags.Bits.MacDone = 1;
+        MacCtx->LoRaMacFlags.Bits.MacDone = 1;
     }
 }
 
@@ -1523,16 +1462,16 @@ static bool ValidatePayloadLength( uint8_t lenN, int8_t datarate, uint8_t fOptsL
     uint16_t payloadSize = 0;
 
     // Setup PHY request
-    getPhy.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
+    getPhy.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
     getPhy.Datarate = datarate;
     getPhy.Attribute = PHY_MAX_PAYLOAD;
 
     // Get the maximum payload length
-    if( RepeaterSupport == true )
+    if( MacCtx->RepeaterSupport == true )
     {
         getPhy.Attribute = PHY_MAX_PAYLOAD_REPEATER;
     }
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
     maxN = phyParam.Value;
 
     // Calculate the resulting payload size
@@ -1550,86 +1489,86 @@ static LoRaMacStatus_t AddMacCommand( uint8_t cmd, uint8_t p1, uint8_t p2 )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_BUSY;
     // The maximum buffer length must take MAC commands to re-send into account.
-    uint8_t bufLen = LORA_MAC_COMMAND_MAX_LENGTH - MacCommandsBufferToRepeatIndex;
+    uint8_t bufLen = LORA_MAC_COMMAND_MAX_LENGTH - MacCtx->MacCommandsBufferToRepeatIndex;
 
     switch( cmd )
     {
         case MOTE_MAC_LINK_CHECK_REQ:
-            if( MacCommandsBufferIndex < bufLen )
+            if( MacCtx->MacCommandsBufferIndex < bufLen )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // No payload for this command
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_LINK_ADR_ANS:
-            if( MacCommandsBufferIndex < ( bufLen - 1 ) )
+            if( MacCtx->MacCommandsBufferIndex < ( bufLen - 1 ) )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // Margin
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p1;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p1;
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_DUTY_CYCLE_ANS:
-            if( MacCommandsBufferIndex < bufLen )
+            if( MacCtx->MacCommandsBufferIndex < bufLen )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // No payload for this answer
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_RX_PARAM_SETUP_ANS:
-            if( MacCommandsBufferIndex < ( bufLen - 1 ) )
+            if( MacCtx->MacCommandsBufferIndex < ( bufLen - 1 ) )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // Status: Datarate ACK, Channel ACK
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p1;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p1;
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_DEV_STATUS_ANS:
-            if( MacCommandsBufferIndex < ( bufLen - 2 ) )
+            if( MacCtx->MacCommandsBufferIndex < ( bufLen - 2 ) )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // 1st byte Battery
                 // 2nd byte Margin
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p1;
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p2;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p1;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p2;
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_NEW_CHANNEL_ANS:
-            if( MacCommandsBufferIndex < ( bufLen - 1 ) )
+            if( MacCtx->MacCommandsBufferIndex < ( bufLen - 1 ) )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // Status: Datarate range OK, Channel frequency OK
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p1;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p1;
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_RX_TIMING_SETUP_ANS:
-            if( MacCommandsBufferIndex < bufLen )
+            if( MacCtx->MacCommandsBufferIndex < bufLen )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // No payload for this answer
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_TX_PARAM_SETUP_ANS:
-            if( MacCommandsBufferIndex < bufLen )
+            if( MacCtx->MacCommandsBufferIndex < bufLen )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // No payload for this answer
                 status = LORAMAC_STATUS_OK;
             }
             break;
         case MOTE_MAC_DL_CHANNEL_ANS:
-            if( MacCommandsBufferIndex < bufLen )
+            if( MacCtx->MacCommandsBufferIndex < bufLen )
             {
-                MacCommandsBuffer[MacCommandsBufferIndex++] = cmd;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = cmd;
                 // Status: Uplink frequency exists, Channel frequency OK
-                MacCommandsBuffer[MacCommandsBufferIndex++] = p1;
+                MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex++] = p1;
                 status = LORAMAC_STATUS_OK;
             }
             break;
@@ -1638,7 +1577,7 @@ static LoRaMacStatus_t AddMacCommand( uint8_t cmd, uint8_t p1, uint8_t p2 )
     }
     if( status == LORAMAC_STATUS_OK )
     {
-        MacCommandsInNextTx = true;
+        MacCtx->MacCommandsInNextTx = true;
     }
     return status;
 }
@@ -1706,9 +1645,9 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
         switch( payload[macIndex++] )
         {
             case SRV_MAC_LINK_CHECK_ANS:
-                MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-                MlmeConfirm.DemodMargin = payload[macIndex++];
-                MlmeConfirm.NbGateways = payload[macIndex++];
+                MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
+                MacCtx->MlmeConfirm.DemodMargin = payload[macIndex++];
+                MacCtx->MlmeConfirm.NbGateways = payload[macIndex++];
                 break;
             case SRV_MAC_LINK_ADR_REQ:
                 {
@@ -1721,21 +1660,21 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     // Fill parameter structure
                     linkAdrReq.Payload = &payload[macIndex - 1];
                     linkAdrReq.PayloadSize = commandsSize - ( macIndex - 1 );
-                    linkAdrReq.AdrEnabled = AdrCtrlOn;
-                    linkAdrReq.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
-                    linkAdrReq.CurrentDatarate = LoRaMacParams.ChannelsDatarate;
-                    linkAdrReq.CurrentTxPower = LoRaMacParams.ChannelsTxPower;
-                    linkAdrReq.CurrentNbRep = LoRaMacParams.ChannelsNbRep;
+                    linkAdrReq.AdrEnabled = MacCtx->AdrCtrlOn;
+                    linkAdrReq.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
+                    linkAdrReq.CurrentDatarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+                    linkAdrReq.CurrentTxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
+                    linkAdrReq.CurrentNbRep = MacCtx->LoRaMacParams.ChannelsNbRep;
 
                     // Process the ADR requests
-                    status = RegionLinkAdrReq( LoRaMacRegion, &linkAdrReq, &linkAdrDatarate,
+                    status = RegionLinkAdrReq( MacCtx->LoRaMacRegion, &linkAdrReq, &linkAdrDatarate,
                                                &linkAdrTxPower, &linkAdrNbRep, &linkAdrNbBytesParsed );
 
                     if( ( status & 0x07 ) == 0x07 )
                     {
-                        LoRaMacParams.ChannelsDatarate = linkAdrDatarate;
-                        LoRaMacParams.ChannelsTxPower = linkAdrTxPower;
-                        LoRaMacParams.ChannelsNbRep = linkAdrNbRep;
+                        MacCtx->LoRaMacParams.ChannelsDatarate = linkAdrDatarate;
+                        MacCtx->LoRaMacParams.ChannelsTxPower = linkAdrTxPower;
+                        MacCtx->LoRaMacParams.ChannelsNbRep = linkAdrNbRep;
                     }
 
                     // Add the answers to the buffer
@@ -1748,8 +1687,8 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                 }
                 break;
             case SRV_MAC_DUTY_CYCLE_REQ:
-                MaxDCycle = payload[macIndex++];
-                AggregatedDCycle = 1 << MaxDCycle;
+                MacCtx->MaxDCycle = payload[macIndex++];
+                MacCtx->AggregatedDCycle = 1 << MacCtx->MaxDCycle;
                 AddMacCommand( MOTE_MAC_DUTY_CYCLE_ANS, 0, 0 );
                 break;
             case SRV_MAC_RX_PARAM_SETUP_REQ:
@@ -1767,13 +1706,13 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     rxParamSetupReq.Frequency *= 100;
 
                     // Perform request on region
-                    status = RegionRxParamSetupReq( LoRaMacRegion, &rxParamSetupReq );
+                    status = RegionRxParamSetupReq( MacCtx->LoRaMacRegion, &rxParamSetupReq );
 
                     if( ( status & 0x07 ) == 0x07 )
                     {
-                        LoRaMacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
-                        LoRaMacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
-                        LoRaMacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
+                        MacCtx->LoRaMacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
+                        MacCtx->LoRaMacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
+                        MacCtx->LoRaMacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
                     }
                     AddMacCommand( MOTE_MAC_RX_PARAM_SETUP_ANS, status, 0 );
                 }
@@ -1781,9 +1720,9 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
             case SRV_MAC_DEV_STATUS_REQ:
                 {
                     uint8_t batteryLevel = BAT_LEVEL_NO_MEASURE;
-                    if( ( LoRaMacCallbacks != NULL ) && ( LoRaMacCallbacks->GetBatteryLevel != NULL ) )
+                    if( ( MacCtx->LoRaMacCallbacks != NULL ) && ( MacCtx->LoRaMacCallbacks->GetBatteryLevel != NULL ) )
                     {
-                        batteryLevel = LoRaMacCallbacks->GetBatteryLevel( );
+                        batteryLevel = MacCtx->LoRaMacCallbacks->GetBatteryLevel( );
                     }
                     AddMacCommand( MOTE_MAC_DEV_STATUS_ANS, batteryLevel, snr );
                     break;
@@ -1804,7 +1743,7 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     chParam.Rx1Frequency = 0;
                     chParam.DrRange.Value = payload[macIndex++];
 
-                    status = RegionNewChannelReq( LoRaMacRegion, &newChannelReq );
+                    status = RegionNewChannelReq( MacCtx->LoRaMacRegion, &newChannelReq );
 
                     AddMacCommand( MOTE_MAC_NEW_CHANNEL_ANS, status, 0 );
                 }
@@ -1817,8 +1756,8 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     {
                         delay++;
                     }
-                    LoRaMacParams.ReceiveDelay1 = delay * 1000;
-                    LoRaMacParams.ReceiveDelay2 = LoRaMacParams.ReceiveDelay1 + 1000;
+                    MacCtx->LoRaMacParams.ReceiveDelay1 = delay * 1000;
+                    MacCtx->LoRaMacParams.ReceiveDelay2 = MacCtx->LoRaMacParams.ReceiveDelay1 + 1000;
                     AddMacCommand( MOTE_MAC_RX_TIMING_SETUP_ANS, 0, 0 );
                 }
                 break;
@@ -1841,12 +1780,12 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     txParamSetupReq.MaxEirp = eirpDwellTime & 0x0F;
 
                     // Check the status for correctness
-                    if( RegionTxParamSetupReq( LoRaMacRegion, &txParamSetupReq ) != -1 )
+                    if( RegionTxParamSetupReq( MacCtx->LoRaMacRegion, &txParamSetupReq ) != -1 )
                     {
                         // Accept command
-                        LoRaMacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
-                        LoRaMacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
-                        LoRaMacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
+                        MacCtx->LoRaMacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
+                        MacCtx->LoRaMacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
+                        MacCtx->LoRaMacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
                         // Add command response
                         AddMacCommand( MOTE_MAC_TX_PARAM_SETUP_ANS, 0, 0 );
                     }
@@ -1863,7 +1802,7 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     dlChannelReq.Rx1Frequency |= ( uint32_t )payload[macIndex++] << 16;
                     dlChannelReq.Rx1Frequency *= 100;
 
-                    status = RegionDlChannelReq( LoRaMacRegion, &dlChannelReq );
+                    status = RegionDlChannelReq( MacCtx->LoRaMacRegion, &dlChannelReq );
 
                     AddMacCommand( MOTE_MAC_DL_CHANNEL_ANS, status, 0 );
                 }
@@ -1885,7 +1824,7 @@ LoRaMacStatus_t Send( LoRaMacHeader_t *macHdr, uint8_t fPort, void *fBuffer, uin
     fCtrl.Bits.FPending      = 0;
     fCtrl.Bits.Ack           = false;
     fCtrl.Bits.AdrAckReq     = false;
-    fCtrl.Bits.Adr           = AdrCtrlOn;
+    fCtrl.Bits.Adr           = MacCtx->AdrCtrlOn;
 
     // Prepare the frame
     status = PrepareFrame( macHdr, &fCtrl, fPort, fBuffer, fBufferSize );
@@ -1897,9 +1836,9 @@ LoRaMacStatus_t Send( LoRaMacHeader_t *macHdr, uint8_t fPort, void *fBuffer, uin
     }
 
     // Reset confirm parameters
-    McpsConfirm.NbRetries = 0;
-    McpsConfirm.AckReceived = false;
-    McpsConfirm.UpLinkCounter = UpLinkCounter;
+    MacCtx->McpsConfirm.NbRetries = 0;
+    MacCtx->McpsConfirm.AckReceived = false;
+    MacCtx->McpsConfirm.UpLinkCounter = MacCtx->UpLinkCounter;
 
     status = ScheduleTx( );
 
@@ -1912,134 +1851,157 @@ static LoRaMacStatus_t ScheduleTx( void )
     NextChanParams_t nextChan;
 
     // Check if the device is off
-    if( MaxDCycle == 255 )
+    if( MacCtx->MaxDCycle == 255 )
     {
         return LORAMAC_STATUS_DEVICE_OFF;
     }
-    if( MaxDCycle == 0 )
+    if( MacCtx->MaxDCycle == 0 )
     {
-        AggregatedTimeOff = 0;
+        MacCtx->AggregatedTimeOff = 0;
     }
 
     // Update Backoff
-    CalculateBackOff( LastTxChannel );
+    CalculateBackOff( MacCtx->LastTxChannel );
 
-    nextChan.AggrTimeOff = AggregatedTimeOff;
-    nextChan.Datarate = LoRaMacParams.ChannelsDatarate;
-    nextChan.DutyCycleEnabled = DutyCycleOn;
-    nextChan.Joined = IsLoRaMacNetworkJoined;
-    nextChan.LastAggrTx = AggregatedLastTxDoneTime;
+    nextChan.AggrTimeOff = MacCtx->AggregatedTimeOff;
+    nextChan.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+    nextChan.DutyCycleEnabled = MacCtx->DutyCycleOn;
+    nextChan.Joined = MacCtx->IsLoRaMacNetworkJoined;
+    nextChan.LastAggrTx = MacCtx->AggregatedLastTxDoneTime;
 
     // Select channel
-    while( RegionNextChannel( LoRaMacRegion, &nextChan, &Channel, &dutyCycleTimeOff, &AggregatedTimeOff ) == false )
+    while( RegionNextChannel( MacCtx->LoRaMacRegion, &nextChan, &MacCtx->Channel, &dutyCycleTimeOff, &MacCtx->AggregatedTimeOff ) == false )
     {
         // Set the default datarate
-        LoRaMacParams.ChannelsDatarate = LoRaMacParamsDefaults.ChannelsDatarate;
+        MacCtx->LoRaMacParams.ChannelsDatarate = MacCtx->LoRaMacParamsDefaults.ChannelsDatarate;
         // Update datarate in the function parameters
-        nextChan.Datarate = LoRaMacParams.ChannelsDatarate;
+        nextChan.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
     }
 
-    // Compute Rx1 windows parameters
-    RegionComputeRxWindowParameters( LoRaMacRegion,
-                                     RegionApplyDrOffset( LoRaMacRegion, LoRaMacParams.DownlinkDwellTime, LoRaMacParams.ChannelsDatarate, LoRaMacParams.Rx1DrOffset ),
-                                     LoRaMacParams.MinRxSymbols,
-                                     LoRaMacParams.SystemMaxRxError,
-                                     &RxWindow1Config );
-    // Compute Rx2 windows parameters
-    RegionComputeRxWindowParameters( LoRaMacRegion,
-                                     LoRaMacParams.Rx2Channel.Datarate,
-                                     LoRaMacParams.MinRxSymbols,
-                                     LoRaMacParams.SystemMaxRxError,
-                                     &RxWindow2Config );
+    // Get Rx1 windows parameters
+    GetRxWindowParameters( RegionApplyDrOffset( MacCtx->LoRaMacRegion, MacCtx->LoRaMacParams.DownlinkDwellTime, MacCtx->LoRaMacParams.ChannelsDatarate, MacCtx->LoRaMacParams.Rx1DrOffset ),
+                           &MacCtx->RxWindow1Config );
+    // Get Rx2 windows parameters
+    GetRxWindowParameters( MacCtx->LoRaMacParams.Rx2Channel.Datarate, &MacCtx->RxWindow2Config );
 
-    if( IsLoRaMacNetworkJoined == false )
+    if( MacCtx->IsLoRaMacNetworkJoined == false )
     {
-        RxWindow1Delay = LoRaMacParams.JoinAcceptDelay1 + RxWindow1Config.WindowOffset;
-        RxWindow2Delay = LoRaMacParams.JoinAcceptDelay2 + RxWindow2Config.WindowOffset;
+        MacCtx->RxWindow1Delay = MacCtx->LoRaMacParams.JoinAcceptDelay1 + MacCtx->RxWindow1Config.WindowOffset;
+        MacCtx->RxWindow2Delay = MacCtx->LoRaMacParams.JoinAcceptDelay2 + MacCtx->RxWindow2Config.WindowOffset;
     }
     else
     {
-        if( ValidatePayloadLength( LoRaMacTxPayloadLen, LoRaMacParams.ChannelsDatarate, MacCommandsBufferIndex ) == false )
+        if( ValidatePayloadLength( MacCtx->LoRaMacTxPayloadLen, MacCtx->LoRaMacParams.ChannelsDatarate, MacCtx->MacCommandsBufferIndex ) == false )
         {
             return LORAMAC_STATUS_LENGTH_ERROR;
         }
-        RxWindow1Delay = LoRaMacParams.ReceiveDelay1 + RxWindow1Config.WindowOffset;
-        RxWindow2Delay = LoRaMacParams.ReceiveDelay2 + RxWindow2Config.WindowOffset;
+        MacCtx->RxWindow1Delay = MacCtx->LoRaMacParams.ReceiveDelay1 + MacCtx->RxWindow1Config.WindowOffset;
+        MacCtx->RxWindow2Delay = MacCtx->LoRaMacParams.ReceiveDelay2 + MacCtx->RxWindow2Config.WindowOffset;
     }
 
     // Schedule transmission of frame
     if( dutyCycleTimeOff == 0 )
     {
         // Try to send now
-        return SendFrameOnChannel( Channel );
+        return SendFrameOnChannel( MacCtx->Channel );
     }
     else
     {
         // Send later - prepare timer
-        LoRaMacState |= LORAMAC_TX_DELAYED;
-        TimerSetValue( &TxDelayedTimer, dutyCycleTimeOff );
-        TimerStart( &TxDelayedTimer );
+        MacCtx->LoRaMacState |= LORAMAC_TX_DELAYED;
+        TimerSetValue( &MacCtx->TxDelayedTimer, dutyCycleTimeOff );
+        TimerStart( &MacCtx->TxDelayedTimer );
 
         return LORAMAC_STATUS_OK;
     }
 }
 
+static void GetRxWindowParameters( int8_t datarate, RxConfigParams_t *rxConfigParams )
+{
+    RxWindowParams_t *params;
+
+    if( ( datarate < 0 ) || ( datarate >= LORAMAC_RX_WINDOW_CACHE_SIZE ) )
+    {
+        RegionComputeRxWindowParameters( MacCtx->LoRaMacRegion, datarate, MacCtx->LoRaMacParams.MinRxSymbols,
+                                         MacCtx->LoRaMacParams.SystemMaxRxError, rxConfigParams );
+        return;
+    }
+
+    params = &MacCtx->RxWindowParams[datarate];
+    if( ( MacCtx->RxWindowParamsValid & ( 1 << datarate ) ) == 0 )
+    {
+        RegionComputeRxWindowParameters( MacCtx->LoRaMacRegion, datarate, MacCtx->LoRaMacParams.MinRxSymbols,
+                                         MacCtx->LoRaMacParams.SystemMaxRxError, rxConfigParams );
+        params->Datarate = rxConfigParams->Datarate;
+        params->Bandwidth = rxConfigParams->Bandwidth;
+        params->WindowTimeout = rxConfigParams->WindowTimeout;
+        params->WindowOffset = rxConfigParams->WindowOffset;
+        MacCtx->RxWindowParamsValid |= ( 1 << datarate );
+        return;
+    }
+
+    rxConfigParams->Datarate = params->Datarate;
+    rxConfigParams->Bandwidth = params->Bandwidth;
+    rxConfigParams->WindowTimeout = params->WindowTimeout;
+    rxConfigParams->WindowOffset = params->WindowOffset;
+}
+
 static void CalculateBackOff( uint8_t channel )
 {
     CalcBackOffParams_t calcBackOff;
 
-    calcBackOff.Joined = IsLoRaMacNetworkJoined;
-    calcBackOff.DutyCycleEnabled = DutyCycleOn;
+    calcBackOff.Joined = MacCtx->IsLoRaMacNetworkJoined;
+    calcBackOff.DutyCycleEnabled = MacCtx->DutyCycleOn;
     calcBackOff.Channel = channel;
-    calcBackOff.ElapsedTime = TimerGetElapsedTime( LoRaMacInitializationTime );
-    calcBackOff.TxTimeOnAir = TxTimeOnAir;
-    calcBackOff.LastTxIsJoinRequest = LastTxIsJoinRequest;
+    calcBackOff.ElapsedTime = TimerGetElapsedTime( MacCtx->LoRaMacInitializationTime );
+    calcBackOff.TxTimeOnAir = MacCtx->TxTimeOnAir;
+    calcBackOff.LastTxIsJoinRequest = MacCtx->LastTxIsJoinRequest;
 
     // Update regional back-off
-    RegionCalcBackOff( LoRaMacRegion, &calcBackOff );
+    RegionCalcBackOff( MacCtx->LoRaMacRegion, &calcBackOff );
 
     // Update aggregated time-off
-    AggregatedTimeOff = AggregatedTimeOff + ( TxTimeOnAir * AggregatedDCycle - TxTimeOnAir );
+    MacCtx->AggregatedTimeOff = MacCtx->AggregatedTimeOff + ( MacCtx->TxTimeOnAir * MacCtx->AggregatedDCycle - MacCtx->TxTimeOnAir );
 }
 
 static void ResetMacParameters( void )
 {
-    IsLoRaMacNetworkJoined = false;
+    MacCtx->IsLoRaMacNetworkJoined = false;
 
     // Counters
-    UpLinkCounter = 0;
-    DownLinkCounter = 0;
-    AdrAckCounter = 0;
+    MacCtx->UpLinkCounter = 0;
+    MacCtx->DownLinkCounter = 0;
+    MacCtx->AdrAckCounter = 0;
 
-    ChannelsNbRepCounter = 0;
+    MacCtx->ChannelsNbRepCounter = 0;
 
-    AckTimeoutRetries = 1;
-    AckTimeoutRetriesCounter = 1;
-    AckTimeoutRetry = false;
+    MacCtx->AckTimeoutRetries = 1;
+    MacCtx->AckTimeoutRetriesCounter = 1;
+    MacCtx->AckTimeoutRetry = false;
 
-    MaxDCycle = 0;
-    AggregatedDCycle = 1;
+    MacCtx->MaxDCycle = 0;
+    MacCtx->AggregatedDCycle = 1;
 
-    MacCommandsBufferIndex = 0;
-    MacCommandsBufferToRepeatIndex = 0;
+    MacCtx->MacCommandsBufferIndex = 0;
+    MacCtx->MacCommandsBufferToRepeatIndex = 0;
 
-    IsRxWindowsEnabled = true;
+    MacCtx->IsRxWindowsEnabled = true;
 
-    LoRaMacParams.ChannelsTxPower = LoRaMacParamsDefaults.ChannelsTxPower;
-    LoRaMacParams.ChannelsDatarate = LoRaMacParamsDefaults.ChannelsDatarate;
-    LoRaMacParams.Rx1DrOffset = LoRaMacParamsDefaults.Rx1DrOffset;
-    LoRaMacParams.Rx2Channel = LoRaMacParamsDefaults.Rx2Channel;
-    LoRaMacParams.UplinkDwellTime = LoRaMacParamsDefaults.UplinkDwellTime;
-    LoRaMacParams.DownlinkDwellTime = LoRaMacParamsDefaults.DownlinkDwellTime;
-    LoRaMacParams.MaxEirp = LoRaMacParamsDefaults.MaxEirp;
-    LoRaMacParams.AntennaGain = LoRaMacParamsDefaults.AntennaGain;
+    MacCtx->LoRaMacParams.ChannelsTxPower = MacCtx->LoRaMacParamsDefaults.ChannelsTxPower;
+    MacCtx->LoRaMacParams.ChannelsDatarate = MacCtx->LoRaMacParamsDefaults.ChannelsDatarate;
+    MacCtx->LoRaMacParams.Rx1DrOffset = MacCtx->LoRaMacParamsDefaults.Rx1DrOffset;
+    MacCtx->LoRaMacParams.Rx2Channel = MacCtx->LoRaMacParamsDefaults.Rx2Channel;
+    MacCtx->LoRaMacParams.UplinkDwellTime = MacCtx->LoRaMacParamsDefaults.UplinkDwellTime;
+    MacCtx->LoRaMacParams.DownlinkDwellTime = MacCtx->LoRaMacParamsDefaults.DownlinkDwellTime;
+    MacCtx->LoRaMacParams.MaxEirp = MacCtx->LoRaMacParamsDefaults.MaxEirp;
+    MacCtx->LoRaMacParams.AntennaGain = MacCtx->LoRaMacParamsDefaults.AntennaGain;
 
-    NodeAckRequested = false;
-    SrvAckRequested = false;
-    MacCommandsInNextTx = false;
+    MacCtx->NodeAckRequested = false;
+    MacCtx->SrvAckRequested = false;
+    MacCtx->MacCommandsInNextTx = false;
 
     // Reset Multicast downlink counters
-    MulticastParams_t *cur = MulticastChannels;
+    MulticastParams_t *cur = MacCtx->MulticastChannels;
     while( cur != NULL )
     {
         cur->DownLinkCounter = 0;
@@ -2047,8 +2009,8 @@ static void ResetMacParameters( void )
     }
 
     // Initialize channel index.
-    Channel = 0;
-    LastTxChannel = Channel;
+    MacCtx->Channel = 0;
+    MacCtx->LastTxChannel = MacCtx->Channel;
 }
 
 LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl, uint8_t fPort, void *fBuffer, uint16_t fBufferSize )
@@ -2060,47 +2022,47 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl
     const void* payload = fBuffer;
     uint8_t framePort = fPort;
 
-    LoRaMacBufferPktLen = 0;
+    MacCtx->LoRaMacBufferPktLen = 0;
 
-    NodeAckRequested = false;
+    MacCtx->NodeAckRequested = false;
 
     if( fBuffer == NULL )
     {
         fBufferSize = 0;
     }
 
-    LoRaMacTxPayloadLen = fBufferSize;
+    MacCtx->LoRaMacTxPayloadLen = fBufferSize;
 
-    LoRaMacBuffer[pktHeaderLen++] = macHdr->Value;
+    MacCtx->LoRaMacBuffer[pktHeaderLen++] = macHdr->Value;
 
     switch( macHdr->Bits.MType )
     {
         case FRAME_TYPE_JOIN_REQ:
-            LoRaMacBufferPktLen = pktHeaderLen;
+            MacCtx->LoRaMacBufferPktLen = pktHeaderLen;
 
-            memcpyr( LoRaMacBuffer + LoRaMacBufferPktLen, LoRaMacAppEui, 8 );
-            LoRaMacBufferPktLen += 8;
-            memcpyr( LoRaMacBuffer + LoRaMacBufferPktLen, LoRaMacDevEui, 8 );
-            LoRaMacBufferPktLen += 8;
+            memcpyr( MacCtx->LoRaMacBuffer + MacCtx->LoRaMacBufferPktLen, MacCtx->LoRaMacAppEui, 8 );
+            MacCtx->LoRaMacBufferPktLen += 8;
+            memcpyr( MacCtx->LoRaMacBuffer + MacCtx->LoRaMacBufferPktLen, MacCtx->LoRaMacDevEui, 8 );
+            MacCtx->LoRaMacBufferPktLen += 8;
 
-            LoRaMacDevNonce = Radio.Random( );
+            MacCtx->LoRaMacDevNonce = ( uint16_t )Random_Get32( );
 
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = LoRaMacDevNonce & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = ( LoRaMacDevNonce >> 8 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = MacCtx->LoRaMacDevNonce & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = ( MacCtx->LoRaMacDevNonce >> 8 ) & 0xFF;
 
-            LoRaMacJoinComputeMic( LoRaMacBuffer, LoRaMacBufferPktLen & 0xFF, LoRaMacAppKey, &mic );
+            LoRaMacJoinComputeMic( MacCtx->LoRaMacBuffer, MacCtx->LoRaMacBufferPktLen & 0xFF, MacCtx->LoRaMacAppKey, &mic );
 
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = mic & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = ( mic >> 8 ) & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = ( mic >> 16 ) & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen++] = ( mic >> 24 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = mic & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = ( mic >> 8 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = ( mic >> 16 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen++] = ( mic >> 24 ) & 0xFF;
 
             break;
         case FRAME_TYPE_DATA_CONFIRMED_UP:
-            NodeAckRequested = true;
+            MacCtx->NodeAckRequested = true;
             //Intentional fallthrough
         case FRAME_TYPE_DATA_UNCONFIRMED_UP:
-            if( IsLoRaMacNetworkJoined == false )
+            if( MacCtx->IsLoRaMacNetworkJoined == false )
             {
                 return LORAMAC_STATUS_NO_NETWORK_JOINED; // No network has been joined yet
             }
@@ -2108,106 +2070,106 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t *macHdr, LoRaMacFrameCtrl_t *fCtrl
             // Adr next request
             adrNext.UpdateChanMask = true;
             adrNext.AdrEnabled = fCtrl->Bits.Adr;
-            adrNext.AdrAckCounter = AdrAckCounter;
-            adrNext.Datarate = LoRaMacParams.ChannelsDatarate;
-            adrNext.TxPower = LoRaMacParams.ChannelsTxPower;
-            adrNext.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
+            adrNext.AdrAckCounter = MacCtx->AdrAckCounter;
+            adrNext.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+            adrNext.TxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
+            adrNext.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
 
-            fCtrl->Bits.AdrAckReq = RegionAdrNext( LoRaMacRegion, &adrNext,
-                                                   &LoRaMacParams.ChannelsDatarate, &LoRaMacParams.ChannelsTxPower, &AdrAckCounter );
+            fCtrl->Bits.AdrAckReq = RegionAdrNext( MacCtx->LoRaMacRegion, &adrNext,
+                                                   &MacCtx->LoRaMacParams.ChannelsDatarate, &MacCtx->LoRaMacParams.ChannelsTxPower, &MacCtx->AdrAckCounter );
 
-            if( SrvAckRequested == true )
+            if( MacCtx->SrvAckRequested == true )
             {
-                SrvAckRequested = false;
+                MacCtx->SrvAckRequested = false;
                 fCtrl->Bits.Ack = 1;
             }
 
-            LoRaMacBuffer[pktHeaderLen++] = ( LoRaMacDevAddr ) & 0xFF;
-            LoRaMacBuffer[pktHeaderLen++] = ( LoRaMacDevAddr >> 8 ) & 0xFF;
-            LoRaMacBuffer[pktHeaderLen++] = ( LoRaMacDevAddr >> 16 ) & 0xFF;
-            LoRaMacBuffer[pktHeaderLen++] = ( LoRaMacDevAddr >> 24 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = ( MacCtx->LoRaMacDevAddr ) & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = ( MacCtx->LoRaMacDevAddr >> 8 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = ( MacCtx->LoRaMacDevAddr >> 16 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = ( MacCtx->LoRaMacDevAddr >> 24 ) & 0xFF;
 
-            LoRaMacBuffer[pktHeaderLen++] = fCtrl->Value;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = fCtrl->Value;
 
-            LoRaMacBuffer[pktHeaderLen++] = UpLinkCounter & 0xFF;
-            LoRaMacBuffer[pktHeaderLen++] = ( UpLinkCounter >> 8 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = MacCtx->UpLinkCounter & 0xFF;
+            MacCtx->LoRaMacBuffer[pktHeaderLen++] = ( MacCtx->UpLinkCounter >> 8 ) & 0xFF;
 
             // Copy the MAC commands which must be re-send into the MAC command buffer
-            memcpy1( &MacCommandsBuffer[MacCommandsBufferIndex], MacCommandsBufferToRepeat, MacCommandsBufferToRepeatIndex );
-            MacCommandsBufferIndex += MacCommandsBufferToRepeatIndex;
+            memcpy1( &MacCtx->MacCommandsBuffer[MacCtx->MacCommandsBufferIndex], MacCtx->MacCommandsBufferToRepeat, MacCtx->MacCommandsBufferToRepeatIndex );
+            MacCtx->MacCommandsBufferIndex += MacCtx->MacCommandsBufferToRepeatIndex;
 
-            if( ( payload != NULL ) && ( LoRaMacTxPayloadLen > 0 ) )
+            if( ( payload != NULL ) && ( MacCtx->LoRaMacTxPayloadLen > 0 ) )
             {
-                if( MacCommandsInNextTx == true )
+                if( MacCtx->MacCommandsInNextTx == true )
                 {
-                    if( MacCommandsBufferIndex <= LORA_MAC_COMMAND_MAX_FOPTS_LENGTH )
+                    if( MacCtx->MacCommandsBufferIndex <= LORA_MAC_COMMAND_MAX_FOPTS_LENGTH )
                     {
-                        fCtrl->Bits.FOptsLen += MacCommandsBufferIndex;
+                        fCtrl->Bits.FOptsLen += MacCtx->MacCommandsBufferIndex;
 
                         // Update FCtrl field with new value of OptionsLength
-                        LoRaMacBuffer[0x05] = fCtrl->Value;
-                        for( i = 0; i < MacCommandsBufferIndex; i++ )
+                        MacCtx->LoRaMacBuffer[0x05] = fCtrl->Value;
+                        for( i = 0; i < MacCtx->MacCommandsBufferIndex; i++ )
                         {
-                            LoRaMacBuffer[pktHeaderLen++] = MacCommandsBuffer[i];
+                            MacCtx->LoRaMacBuffer[pktHeaderLen++] = MacCtx->MacCommandsBuffer[i];
                         }
                     }
                     else
                     {
-                        LoRaMacTxPayloadLen = MacCommandsBufferIndex;
-                        payload = MacCommandsBuffer;
+                        MacCtx->LoRaMacTxPayloadLen = MacCtx->MacCommandsBufferIndex;
+                        payload = MacCtx->MacCommandsBuffer;
                         framePort = 0;
                     }
                 }
             }
             else
             {
-                if( ( MacCommandsBufferIndex > 0 ) && ( MacCommandsInNextTx == true ) )
+                if( ( MacCtx->MacCommandsBufferIndex > 0 ) && ( MacCtx->MacCommandsInNextTx == true ) )
                 {
-                    LoRaMacTxPayloadLen = MacCommandsBufferIndex;
-                    payload = MacCommandsBuffer;
+                    MacCtx->LoRaMacTxPayloadLen = MacCtx->MacCommandsBufferIndex;
+                    payload = MacCtx->MacCommandsBuffer;
                     framePort = 0;
                 }
             }
-            MacCommandsInNextTx = false;
+            MacCtx->MacCommandsInNextTx = false;
             // Store MAC commands which must be re-send in case the device does not receive a downlink anymore
-            MacCommandsBufferToRepeatIndex = ParseMacCommandsToRepeat( MacCommandsBuffer, MacCommandsBufferIndex, MacCommandsBufferToRepeat );
-            if( MacCommandsBufferToRepeatIndex > 0 )
+            MacCtx->MacCommandsBufferToRepeatIndex = ParseMacCommandsToRepeat( MacCtx->MacCommandsBuffer, MacCtx->MacCommandsBufferIndex, MacCtx->MacCommandsBufferToRepeat );
+            if( MacCtx->MacCommandsBufferToRepeatIndex > 0 )
             {
-                MacCommandsInNextTx = true;
+                MacCtx->MacCommandsInNextTx = true;
             }
 
-            if( ( payload != NULL ) && ( LoRaMacTxPayloadLen > 0 ) )
+            if( ( payload != NULL ) && ( MacCtx->LoRaMacTxPayloadLen > 0 ) )
             {
-                LoRaMacBuffer[pktHeaderLen++] = framePort;
+                MacCtx->LoRaMacBuffer[pktHeaderLen++] = framePort;
 
                 if( framePort == 0 )
                 {
                     // Reset buffer index as the mac commands are being sent on port 0
-                    MacCommandsBufferIndex = 0;
-                    LoRaMacPayloadEncrypt( (uint8_t* ) payload, LoRaMacTxPayloadLen, LoRaMacNwkSKey, LoRaMacDevAddr, UP_LINK, UpLinkCounter, &LoRaMacBuffer[pktHeaderLen] );
+                    MacCtx->MacCommandsBufferIndex = 0;
+                    LoRaMacPayloadEncrypt( (uint8_t* ) payload, MacCtx->LoRaMacTxPayloadLen, MacCtx->LoRaMacNwkSKey, MacCtx->LoRaMacDevAddr, UP_LINK, MacCtx->UpLinkCounter, &MacCtx->LoRaMacBuffer[pktHeaderLen] );
                 }
                 else
                 {
-                    LoRaMacPayloadEncrypt( (uint8_t* ) payload, LoRaMacTxPayloadLen, LoRaMacAppSKey, LoRaMacDevAddr, UP_LINK, UpLinkCounter, &LoRaMacBuffer[pktHeaderLen] );
+                    LoRaMacPayloadEncrypt( (uint8_t* ) payload, MacCtx->LoRaMacTxPayloadLen, MacCtx->LoRaMacAppSKey, MacCtx->LoRaMacDevAddr, UP_LINK, MacCtx->UpLinkCounter, &MacCtx->LoRaMacBuffer[pktHeaderLen] );
                 }
             }
-            LoRaMacBufferPktLen = pktHeaderLen + LoRaMacTxPayloadLen;
+            MacCtx->LoRaMacBufferPktLen = pktHeaderLen + MacCtx->LoRaMacTxPayloadLen;
 
-            LoRaMacComputeMic( LoRaMacBuffer, LoRaMacBufferPktLen, LoRaMacNwkSKey, LoRaMacDevAddr, UP_LINK, UpLinkCounter, &mic );
+            LoRaMacComputeMicFast( LORAMAC_CRYPTO_NWK_S_KEY, UP_LINK, MacCtx->LoRaMacDevAddr, MacCtx->UpLinkCounter, MacCtx->LoRaMacBuffer, MacCtx->LoRaMacBufferPktLen, &mic );
 
-            LoRaMacBuffer[LoRaMacBufferPktLen + 0] = mic & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen + 1] = ( mic >> 8 ) & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen + 2] = ( mic >> 16 ) & 0xFF;
-            LoRaMacBuffer[LoRaMacBufferPktLen + 3] = ( mic >> 24 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen + 0] = mic & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen + 1] = ( mic >> 8 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen + 2] = ( mic >> 16 ) & 0xFF;
+            MacCtx->LoRaMacBuffer[MacCtx->LoRaMacBufferPktLen + 3] = ( mic >> 24 ) & 0xFF;
 
-            LoRaMacBufferPktLen += LORAMAC_MFR_LEN;
+            MacCtx->LoRaMacBufferPktLen += LORAMAC_MFR_LEN;
 
             break;
         case FRAME_TYPE_PROPRIETARY:
-            if( ( fBuffer != NULL ) && ( LoRaMacTxPayloadLen > 0 ) )
+            if( ( fBuffer != NULL ) && ( MacCtx->LoRaMacTxPayloadLen > 0 ) )
             {
-                memcpy1( LoRaMacBuffer + pktHeaderLen, ( uint8_t* ) fBuffer, LoRaMacTxPayloadLen );
-                LoRaMacBufferPktLen = pktHeaderLen + LoRaMacTxPayloadLen;
+                memcpy1( MacCtx->LoRaMacBuffer + pktHeaderLen, ( uint8_t* ) fBuffer, MacCtx->LoRaMacTxPayloadLen );
+                MacCtx->LoRaMacBufferPktLen = pktHeaderLen + MacCtx->LoRaMacTxPayloadLen;
             }
             break;
         default:
@@ -2223,38 +2185,39 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
     int8_t txPower = 0;
 
     txConfig.Channel = channel;
-    txConfig.Datarate = LoRaMacParams.ChannelsDatarate;
-    txConfig.TxPower = LoRaMacParams.ChannelsTxPower;
-    txConfig.MaxEirp = LoRaMacParams.MaxEirp;
-    txConfig.AntennaGain = LoRaMacParams.AntennaGain;
-    txConfig.PktLen = LoRaMacBufferPktLen;
+    txConfig.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+    txConfig.TxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
+    txConfig.MaxEirp = MacCtx->LoRaMacParams.MaxEirp;
+    txConfig.AntennaGain = MacCtx->LoRaMacParams.AntennaGain;
+    txConfig.PktLen = MacCtx->LoRaMacBufferPktLen;
 
-    DBG_PRINTF( "\n\r*** seqTx= %d *****\n\r", UpLinkCounter );
+    DBG_PRINTF( "\n\r*** seqTx= %d *****\n\r", MacCtx->UpLinkCounter );
 
-    RegionTxConfig( LoRaMacRegion, &txConfig, &txPower, &TxTimeOnAir );
+    TakeRadio( );
+    RegionTxConfig( MacCtx->LoRaMacRegion, &txConfig, &txPower, &MacCtx->TxTimeOnAir );
 
-    MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
-    McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
-    McpsConfirm.Datarate = LoRaMacParams.ChannelsDatarate;
-    McpsConfirm.TxPower = txPower;
+    MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+    MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+    MacCtx->McpsConfirm.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+    MacCtx->McpsConfirm.TxPower = txPower;
 
     // Store the time on air
-    McpsConfirm.TxTimeOnAir = TxTimeOnAir;
-    MlmeConfirm.TxTimeOnAir = TxTimeOnAir;
+    MacCtx->McpsConfirm.TxTimeOnAir = MacCtx->TxTimeOnAir;
+    MacCtx->MlmeConfirm.TxTimeOnAir = MacCtx->TxTimeOnAir;
 
     // Starts the MAC layer status check timer
-    TimerSetValue( &MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
-    TimerStart( &MacStateCheckTimer );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+    TimerStart( &MacCtx->MacStateCheckTimer );
 
-    if( IsLoRaMacNetworkJoined == false )
+    if( MacCtx->IsLoRaMacNetworkJoined == false )
     {
-        JoinRequestTrials++;
+        MacCtx->JoinRequestTrials++;
     }
 
     // Send now
-    Radio.Send( LoRaMacBuffer, LoRaMacBufferPktLen );
+    Radio.Send( MacCtx->LoRaMacBuffer, MacCtx->LoRaMacBufferPktLen );
 
-    LoRaMacState |= LORAMAC_TX_RUNNING;
+    MacCtx->LoRaMacState |= LORAMAC_TX_RUNNING;
 
     return LORAMAC_STATUS_OK;
 }
@@ -2263,43 +2226,45 @@ LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout )
 {
     ContinuousWaveParams_t continuousWave;
 
-    continuousWave.Channel = Channel;
-    continuousWave.Datarate = LoRaMacParams.ChannelsDatarate;
-    continuousWave.TxPower = LoRaMacParams.ChannelsTxPower;
-    continuousWave.MaxEirp = LoRaMacParams.MaxEirp;
-    continuousWave.AntennaGain = LoRaMacParams.AntennaGain;
+    continuousWave.Channel = MacCtx->Channel;
+    continuousWave.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+    continuousWave.TxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
+    continuousWave.MaxEirp = MacCtx->LoRaMacParams.MaxEirp;
+    continuousWave.AntennaGain = MacCtx->LoRaMacParams.AntennaGain;
     continuousWave.Timeout = timeout;
 
-    RegionSetContinuousWave( LoRaMacRegion, &continuousWave );
+    TakeRadio( );
+    RegionSetContinuousWave( MacCtx->LoRaMacRegion, &continuousWave );
 
     // Starts the MAC layer status check timer
-    TimerSetValue( &MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
-    TimerStart( &MacStateCheckTimer );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+    TimerStart( &MacCtx->MacStateCheckTimer );
 
-    LoRaMacState |= LORAMAC_TX_RUNNING;
+    MacCtx->LoRaMacState |= LORAMAC_TX_RUNNING;
 
     return LORAMAC_STATUS_OK;
 }
 
 LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint8_t power )
 {
+    TakeRadio( );
     Radio.SetTxContinuousWave( frequency, power, timeout );
 
     // Starts the MAC layer status check timer
-    TimerSetValue( &MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
-    TimerStart( &MacStateCheckTimer );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+    TimerStart( &MacCtx->MacStateCheckTimer );
 
-    LoRaMacState |= LORAMAC_TX_RUNNING;
+    MacCtx->LoRaMacState |= LORAMAC_TX_RUNNING;
 
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t *primitives, LoRaMacCallback_t *callbacks, LoRaMacRegion_t region )
+LoRaMacStatus_t LoRaMacInitializationCtx( LoRaMacCtx_t *ctx, LoRaMacPrimitives_t *primitives, LoRaMacCallback_t *callbacks, LoRaMacRegion_t region )
 {
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
 
-    if( primitives == NULL )
+    if( ( ctx == NULL ) || ( primitives == NULL ) )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
@@ -2316,140 +2281,236 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t *primitives, LoRaMacC
         return LORAMAC_STATUS_REGION_NOT_SUPPORTED;
     }
 
-    LoRaMacPrimitives = primitives;
-    LoRaMacCallbacks = callbacks;
-    LoRaMacRegion = region;
+    memset1( ( uint8_t* )ctx, 0, sizeof( LoRaMacCtx_t ) );
+    ctx->LoRaMacRegion = region;
+    SwitchCtx( ctx );
+
+    MacCtx->LoRaMacPrimitives = primitives;
+    MacCtx->LoRaMacCallbacks = callbacks;
 
-    LoRaMacFlags.Value = 0;
+    MacCtx->LoRaMacFlags.Value = 0;
 
-    LoRaMacDeviceClass = CLASS_A;
-    LoRaMacState = LORAMAC_IDLE;
+    MacCtx->LoRaMacDeviceClass = CLASS_A;
+    MacCtx->LoRaMacState = LORAMAC_IDLE;
 
-    JoinRequestTrials = 0;
-    MaxJoinRequestTrials = 1;
-    RepeaterSupport = false;
+    MacCtx->JoinRequestTrials = 0;
+    MacCtx->MaxJoinRequestTrials = 1;
+    MacCtx->RepeaterSupport = false;
 
     // Reset duty cycle times
-    AggregatedLastTxDoneTime = 0;
-    AggregatedTimeOff = 0;
+    MacCtx->AggregatedLastTxDoneTime = 0;
+    MacCtx->AggregatedTimeOff = 0;
 
     // Reset to defaults
     getPhy.Attribute = PHY_DUTY_CYCLE;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    DutyCycleOn = ( bool ) phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->DutyCycleOn = ( bool ) phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_TX_POWER;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.ChannelsTxPower = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.ChannelsTxPower = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_TX_DR;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.ChannelsDatarate = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.ChannelsDatarate = phyParam.Value;
 
     getPhy.Attribute = PHY_MAX_RX_WINDOW;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.MaxRxWindow = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.MaxRxWindow = phyParam.Value;
 
     getPhy.Attribute = PHY_RECEIVE_DELAY1;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.ReceiveDelay1 = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.ReceiveDelay1 = phyParam.Value;
 
     getPhy.Attribute = PHY_RECEIVE_DELAY2;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.ReceiveDelay2 = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.ReceiveDelay2 = phyParam.Value;
 
     getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY1;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
 
     getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY2;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_DR1_OFFSET;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.Rx1DrOffset = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.Rx1DrOffset = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_RX2_FREQUENCY;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.Rx2Channel.Frequency = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.Rx2Channel.Frequency = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_RX2_DR;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.Rx2Channel.Datarate = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.Rx2Channel.Datarate = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_UPLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.UplinkDwellTime = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.UplinkDwellTime = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_DOWNLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.DownlinkDwellTime = phyParam.Value;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.DownlinkDwellTime = phyParam.Value;
 
     getPhy.Attribute = PHY_DEF_MAX_EIRP;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.MaxEirp = phyParam.fValue;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.MaxEirp = phyParam.fValue;
 
     getPhy.Attribute = PHY_DEF_ANTENNA_GAIN;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
-    LoRaMacParamsDefaults.AntennaGain = phyParam.fValue;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
+    MacCtx->LoRaMacParamsDefaults.AntennaGain = phyParam.fValue;
 
-    RegionInitDefaults( LoRaMacRegion, INIT_TYPE_INIT );
+    RegionInitDefaults( MacCtx->LoRaMacRegion, INIT_TYPE_INIT );
 
     // Init parameters which are not set in function ResetMacParameters
-    LoRaMacParamsDefaults.ChannelsNbRep = 1;
-    LoRaMacParamsDefaults.SystemMaxRxError = 10;
-    LoRaMacParamsDefaults.MinRxSymbols = 6;
-
-    LoRaMacParams.SystemMaxRxError = LoRaMacParamsDefaults.SystemMaxRxError;
-    LoRaMacParams.MinRxSymbols = LoRaMacParamsDefaults.MinRxSymbols;
-    LoRaMacParams.MaxRxWindow = LoRaMacParamsDefaults.MaxRxWindow;
-    LoRaMacParams.ReceiveDelay1 = LoRaMacParamsDefaults.ReceiveDelay1;
-    LoRaMacParams.ReceiveDelay2 = LoRaMacParamsDefaults.ReceiveDelay2;
-    LoRaMacParams.JoinAcceptDelay1 = LoRaMacParamsDefaults.JoinAcceptDelay1;
-    LoRaMacParams.JoinAcceptDelay2 = LoRaMacParamsDefaults.JoinAcceptDelay2;
-    LoRaMacParams.ChannelsNbRep = LoRaMacParamsDefaults.ChannelsNbRep;
+    MacCtx->LoRaMacParamsDefaults.ChannelsNbRep = 1;
+    MacCtx->LoRaMacParamsDefaults.SystemMaxRxError = 10;
+    MacCtx->LoRaMacParamsDefaults.MinRxSymbols = 6;
+
+    MacCtx->LoRaMacParams.SystemMaxRxError = MacCtx->LoRaMacParamsDefaults.SystemMaxRxError;
+    MacCtx->LoRaMacParams.MinRxSymbols = MacCtx->LoRaMacParamsDefaults.MinRxSymbols;
+    MacCtx->LoRaMacParams.MaxRxWindow = MacCtx->LoRaMacParamsDefaults.MaxRxWindow;
+    MacCtx->LoRaMacParams.ReceiveDelay1 = MacCtx->LoRaMacParamsDefaults.ReceiveDelay1;
+    MacCtx->LoRaMacParams.ReceiveDelay2 = MacCtx->LoRaMacParamsDefaults.ReceiveDelay2;
+    MacCtx->LoRaMacParams.JoinAcceptDelay1 = MacCtx->LoRaMacParamsDefaults.JoinAcceptDelay1;
+    MacCtx->LoRaMacParams.JoinAcceptDelay2 = MacCtx->LoRaMacParamsDefaults.JoinAcceptDelay2;
+    MacCtx->LoRaMacParams.ChannelsNbRep = MacCtx->LoRaMacParamsDefaults.ChannelsNbRep;
 
     ResetMacParameters( );
 
-    // Initialize timers
-    TimerInit( &MacStateCheckTimer, OnMacStateCheckTimerEvent );
-    TimerSetValue( &MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+    // Expand the session keys once, MIB_NWK_SKEY/MIB_APP_SKEY and the join
+    // accept refresh them
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, MacCtx->LoRaMacNwkSKey );
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, MacCtx->LoRaMacAppSKey );
 
-    TimerInit( &TxDelayedTimer, OnTxDelayedTimerEvent );
-    TimerInit( &RxWindowTimer1, OnRxWindow1TimerEvent );
-    TimerInit( &RxWindowTimer2, OnRxWindow2TimerEvent );
-    TimerInit( &AckTimeoutTimer, OnAckTimeoutTimerEvent );
+    // Initialize timers
+    // The Rx windows are opened from the timer interrupt for accuracy, the
+    // other MAC timer events are processed by LoRaMacProcess
+    TimerInit( &MacCtx->MacStateCheckTimer, OnMacStateCheckTimerIrq );
+    TimerSetValue( &MacCtx->MacStateCheckTimer, MAC_STATE_CHECK_TIMEOUT );
+
+    TimerInit( &MacCtx->TxDelayedTimer, OnTxDelayedTimerIrq );
+    TimerInit( &MacCtx->RxWindowTimer1, OnRxWindow1TimerIrq );
+    TimerInit( &MacCtx->RxWindowTimer2, OnRxWindow2TimerIrq );
+    TimerInit( &MacCtx->AckTimeoutTimer, OnAckTimeoutTimerIrq );
+    TimerSetContext( &MacCtx->MacStateCheckTimer, MacCtx );
+    TimerSetContext( &MacCtx->TxDelayedTimer, MacCtx );
+    TimerSetContext( &MacCtx->RxWindowTimer1, MacCtx );
+    TimerSetContext( &MacCtx->RxWindowTimer2, MacCtx );
+    TimerSetContext( &MacCtx->AckTimeoutTimer, MacCtx );
+
+    // Flush the deferred event queue
+    MacCtx->EventQueueHead = MacCtx->EventQueueTail = 0;
+    MacCtx->RxFrameHead = MacCtx->RxFrameTail = 0;
 
     // Store the current initialization time
-    LoRaMacInitializationTime = TimerGetCurrentTime( );
+    MacCtx->LoRaMacInitializationTime = TimerGetCurrentTime( );
 
     // Initialize Radio driver
-    RadioEvents.TxDone = OnRadioTxDone;
-    RadioEvents.RxDone = OnRadioRxDone;
-    RadioEvents.RxError = OnRadioRxError;
-    RadioEvents.TxTimeout = OnRadioTxTimeout;
-    RadioEvents.RxTimeout = OnRadioRxTimeout;
+    RadioEvents.TxDone = OnRadioTxDoneIrq;
+    RadioEvents.RxDone = OnRadioRxDoneIrq;
+    RadioEvents.RxError = OnRadioRxErrorIrq;
+    RadioEvents.TxTimeout = OnRadioTxTimeoutIrq;
+    RadioEvents.RxTimeout = OnRadioRxTimeoutIrq;
     Radio.Init( &RadioEvents );
 
-    // Random seed initialization
-    srand1( Radio.Random( ) );
+    // Random seed initialization, the RSSI noise sampling keeps the radio
+    // in reception for tens of ms and is done once
+    if( RadioNoiseSeeded == false )
+    {
+        srand1( Radio.Random( ) );
+        RadioNoiseSeeded = true;
+    }
 
-    PublicNetwork = true;
-    Radio.SetPublicNetwork( PublicNetwork );
+    MacCtx->PublicNetwork = true;
+    Radio.SetPublicNetwork( MacCtx->PublicNetwork );
+    RadioOwner = MacCtx;
     Radio.Sleep( );
 
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
+void LoRaMacProcessCtx( LoRaMacCtx_t *ctx )
+{
+    LoRaMacEventEntry_t *entry;
+
+    SelectCtx( ctx );
+
+    while( MacCtx->EventQueueTail != MacCtx->EventQueueHead )
+    {
+        // The entry is read only once its index is published
+        __DMB( );
+        entry = &MacCtx->EventQueue[MacCtx->EventQueueTail & ( LORAMAC_EVENT_QUEUE_SIZE - 1 )];
+
+        switch( entry->Event )
+        {
+            case LORAMAC_EVENT_RADIO_TX_DONE:
+            {
+                OnRadioTxDone( entry->Time );
+                break;
+            }
+            case LORAMAC_EVENT_RADIO_RX_DONE:
+            {
+                OnRadioRxDone( MacCtx->RxFrameQueue[MacCtx->RxFrameTail & ( LORAMAC_RX_FRAME_QUEUE_SIZE - 1 )],
+                               entry->Size, entry->Rssi, entry->Snr );
+                MacCtx->RxFrameTail++;
+                break;
+            }
+            case LORAMAC_EVENT_RADIO_RX_ERROR:
+            {
+                OnRadioRxError( );
+                break;
+            }
+            case LORAMAC_EVENT_RADIO_TX_TIMEOUT:
+            {
+                OnRadioTxTimeout( );
+                break;
+            }
+            case LORAMAC_EVENT_RADIO_RX_TIMEOUT:
+            {
+                OnRadioRxTimeout( );
+                break;
+            }
+            case LORAMAC_EVENT_MAC_STATE_CHECK:
+            {
+                OnMacStateCheckTimerEvent( );
+                break;
+            }
+            case LORAMAC_EVENT_TX_DELAYED:
+            {
+                OnTxDelayedTimerEvent( );
+                break;
+            }
+            case LORAMAC_EVENT_ACK_TIMEOUT:
+            {
+                OnAckTimeoutTimerEvent( );
+                break;
+            }
+            default:
+                break;
+        }
+
+        MacCtx->EventQueueTail++;
+    }
+}
+
+bool LoRaMacIsProcessPendingCtx( LoRaMacCtx_t *ctx )
+{
+    return ( ctx->EventQueueTail != ctx->EventQueueHead ) ? true : false;
+}
+
+LoRaMacStatus_t LoRaMacQueryTxPossibleCtx( LoRaMacCtx_t *ctx, uint8_t size, LoRaMacTxInfo_t* txInfo )
 {
     AdrNextParams_t adrNext;
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
-    int8_t datarate = LoRaMacParamsDefaults.ChannelsDatarate;
-    int8_t txPower = LoRaMacParamsDefaults.ChannelsTxPower;
-    uint8_t fOptLen = MacCommandsBufferIndex + MacCommandsBufferToRepeatIndex;
+    int8_t datarate = ctx->LoRaMacParamsDefaults.ChannelsDatarate;
+    int8_t txPower = ctx->LoRaMacParamsDefaults.ChannelsTxPower;
+    uint8_t fOptLen = ctx->MacCommandsBufferIndex + ctx->MacCommandsBufferToRepeatIndex;
+
+    SelectCtx( ctx );
 
     if( txInfo == NULL )
     {
@@ -2458,27 +2519,27 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
 
     // Setup ADR request
     adrNext.UpdateChanMask = false;
-    adrNext.AdrEnabled = AdrCtrlOn;
-    adrNext.AdrAckCounter = AdrAckCounter;
-    adrNext.Datarate = LoRaMacParams.ChannelsDatarate;
-    adrNext.TxPower = LoRaMacParams.ChannelsTxPower;
-    adrNext.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
+    adrNext.AdrEnabled = MacCtx->AdrCtrlOn;
+    adrNext.AdrAckCounter = MacCtx->AdrAckCounter;
+    adrNext.Datarate = MacCtx->LoRaMacParams.ChannelsDatarate;
+    adrNext.TxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
+    adrNext.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
 
     // We call the function for information purposes only. We don't want to
     // apply the datarate, the tx power and the ADR ack counter.
-    RegionAdrNext( LoRaMacRegion, &adrNext, &datarate, &txPower, &AdrAckCounter );
+    RegionAdrNext( MacCtx->LoRaMacRegion, &adrNext, &datarate, &txPower, &MacCtx->AdrAckCounter );
 
     // Setup PHY request
-    getPhy.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
+    getPhy.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
     getPhy.Datarate = datarate;
     getPhy.Attribute = PHY_MAX_PAYLOAD;
 
     // Change request in case repeater is supported
-    if( RepeaterSupport == true )
+    if( MacCtx->RepeaterSupport == true )
     {
         getPhy.Attribute = PHY_MAX_PAYLOAD_REPEATER;
     }
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
     txInfo->CurrentPayloadSize = phyParam.Value;
 
     // Verify if the fOpts fit into the maximum payload
@@ -2492,8 +2553,8 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
         // The fOpts don't fit into the maximum payload. Omit the MAC commands to
         // ensure that another uplink is possible.
         fOptLen = 0;
-        MacCommandsBufferIndex = 0;
-        MacCommandsBufferToRepeatIndex = 0;
+        MacCtx->MacCommandsBufferIndex = 0;
+        MacCtx->MacCommandsBufferToRepeatIndex = 0;
     }
 
     // Verify if the fOpts and the payload fit into the maximum payload
@@ -2504,12 +2565,14 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t *mibGet )
+LoRaMacStatus_t LoRaMacMibGetRequestConfirmCtx( LoRaMacCtx_t *ctx, MibRequestConfirm_t *mibGet )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_OK;
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
 
+    SelectCtx( ctx );
+
     if( mibGet == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
@@ -2519,71 +2582,71 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t *mibGet )
     {
         case MIB_DEVICE_CLASS:
         {
-            mibGet->Param.Class = LoRaMacDeviceClass;
+            mibGet->Param.Class = MacCtx->LoRaMacDeviceClass;
             break;
         }
         case MIB_NETWORK_JOINED:
         {
-            mibGet->Param.IsNetworkJoined = IsLoRaMacNetworkJoined;
+            mibGet->Param.IsNetworkJoined = MacCtx->IsLoRaMacNetworkJoined;
             break;
         }
         case MIB_ADR:
         {
-            mibGet->Param.AdrEnable = AdrCtrlOn;
+            mibGet->Param.AdrEnable = MacCtx->AdrCtrlOn;
             break;
         }
         case MIB_NET_ID:
         {
-            mibGet->Param.NetID = LoRaMacNetID;
+            mibGet->Param.NetID = MacCtx->LoRaMacNetID;
             break;
         }
         case MIB_DEV_ADDR:
         {
-            mibGet->Param.DevAddr = LoRaMacDevAddr;
+            mibGet->Param.DevAddr = MacCtx->LoRaMacDevAddr;
             break;
         }
         case MIB_NWK_SKEY:
         {
-            mibGet->Param.NwkSKey = LoRaMacNwkSKey;
+            mibGet->Param.NwkSKey = MacCtx->LoRaMacNwkSKey;
             break;
         }
         case MIB_APP_SKEY:
         {
-            mibGet->Param.AppSKey = LoRaMacAppSKey;
+            mibGet->Param.AppSKey = MacCtx->LoRaMacAppSKey;
             break;
         }
         case MIB_PUBLIC_NETWORK:
         {
-            mibGet->Param.EnablePublicNetwork = PublicNetwork;
+            mibGet->Param.EnablePublicNetwork = MacCtx->PublicNetwork;
             break;
         }
         case MIB_REPEATER_SUPPORT:
         {
-            mibGet->Param.EnableRepeaterSupport = RepeaterSupport;
+            mibGet->Param.EnableRepeaterSupport = MacCtx->RepeaterSupport;
             break;
         }
         case MIB_CHANNELS:
         {
             getPhy.Attribute = PHY_CHANNELS;
-            phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+            phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
 
             mibGet->Param.ChannelList = phyParam.Channels;
             break;
         }
         case MIB_RX2_CHANNEL:
         {
-            mibGet->Param.Rx2Channel = LoRaMacParams.Rx2Channel;
+            mibGet->Param.Rx2Channel = MacCtx->LoRaMacParams.Rx2Channel;
             break;
         }
         case MIB_RX2_DEFAULT_CHANNEL:
         {
-            mibGet->Param.Rx2Channel = LoRaMacParamsDefaults.Rx2Channel;
+            mibGet->Param.Rx2Channel = MacCtx->LoRaMacParamsDefaults.Rx2Channel;
             break;
         }
         case MIB_CHANNELS_DEFAULT_MASK:
         {
             getPhy.Attribute = PHY_CHANNELS_DEFAULT_MASK;
-            phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+            phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
 
             mibGet->Param.ChannelsDefaultMask = phyParam.ChannelsMask;
             break;
@@ -2591,89 +2654,89 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t *mibGet )
         case MIB_CHANNELS_MASK:
         {
             getPhy.Attribute = PHY_CHANNELS_MASK;
-            phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+            phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
 
             mibGet->Param.ChannelsMask = phyParam.ChannelsMask;
             break;
         }
         case MIB_CHANNELS_NB_REP:
         {
-            mibGet->Param.ChannelNbRep = LoRaMacParams.ChannelsNbRep;
+            mibGet->Param.ChannelNbRep = MacCtx->LoRaMacParams.ChannelsNbRep;
             break;
         }
         case MIB_MAX_RX_WINDOW_DURATION:
         {
-            mibGet->Param.MaxRxWindow = LoRaMacParams.MaxRxWindow;
+            mibGet->Param.MaxRxWindow = MacCtx->LoRaMacParams.MaxRxWindow;
             break;
         }
         case MIB_RECEIVE_DELAY_1:
         {
-            mibGet->Param.ReceiveDelay1 = LoRaMacParams.ReceiveDelay1;
+            mibGet->Param.ReceiveDelay1 = MacCtx->LoRaMacParams.ReceiveDelay1;
             break;
         }
         case MIB_RECEIVE_DELAY_2:
         {
-            mibGet->Param.ReceiveDelay2 = LoRaMacParams.ReceiveDelay2;
+            mibGet->Param.ReceiveDelay2 = MacCtx->LoRaMacParams.ReceiveDelay2;
             break;
         }
         case MIB_JOIN_ACCEPT_DELAY_1:
         {
-            mibGet->Param.JoinAcceptDelay1 = LoRaMacParams.JoinAcceptDelay1;
+            mibGet->Param.JoinAcceptDelay1 = MacCtx->LoRaMacParams.JoinAcceptDelay1;
             break;
         }
         case MIB_JOIN_ACCEPT_DELAY_2:
         {
-            mibGet->Param.JoinAcceptDelay2 = LoRaMacParams.JoinAcceptDelay2;
+            mibGet->Param.JoinAcceptDelay2 = MacCtx->LoRaMacParams.JoinAcceptDelay2;
             break;
         }
         case MIB_CHANNELS_DEFAULT_DATARATE:
         {
-            mibGet->Param.ChannelsDefaultDatarate = LoRaMacParamsDefaults.ChannelsDatarate;
+            mibGet->Param.ChannelsDefaultDatarate = MacCtx->LoRaMacParamsDefaults.ChannelsDatarate;
             break;
         }
         case MIB_CHANNELS_DATARATE:
         {
-            mibGet->Param.ChannelsDatarate = LoRaMacParams.ChannelsDatarate;
+            mibGet->Param.ChannelsDatarate = MacCtx->LoRaMacParams.ChannelsDatarate;
             break;
         }
         case MIB_CHANNELS_DEFAULT_TX_POWER:
         {
-            mibGet->Param.ChannelsDefaultTxPower = LoRaMacParamsDefaults.ChannelsTxPower;
+            mibGet->Param.ChannelsDefaultTxPower = MacCtx->LoRaMacParamsDefaults.ChannelsTxPower;
             break;
         }
         case MIB_CHANNELS_TX_POWER:
         {
-            mibGet->Param.ChannelsTxPower = LoRaMacParams.ChannelsTxPower;
+            mibGet->Param.ChannelsTxPower = MacCtx->LoRaMacParams.ChannelsTxPower;
             break;
         }
         case MIB_UPLINK_COUNTER:
         {
-            mibGet->Param.UpLinkCounter = UpLinkCounter;
+            mibGet->Param.UpLinkCounter = MacCtx->UpLinkCounter;
             break;
         }
         case MIB_DOWNLINK_COUNTER:
         {
-            mibGet->Param.DownLinkCounter = DownLinkCounter;
+            mibGet->Param.DownLinkCounter = MacCtx->DownLinkCounter;
             break;
         }
         case MIB_MULTICAST_CHANNEL:
         {
-            mibGet->Param.MulticastList = MulticastChannels;
+            mibGet->Param.MulticastList = MacCtx->MulticastChannels;
             break;
         }
         case MIB_SYSTEM_MAX_RX_ERROR:
         {
-            mibGet->Param.SystemMaxRxError = LoRaMacParams.SystemMaxRxError;
+            mibGet->Param.SystemMaxRxError = MacCtx->LoRaMacParams.SystemMaxRxError;
             break;
         }
         case MIB_MIN_RX_SYMBOLS:
         {
-            mibGet->Param.MinRxSymbols = LoRaMacParams.MinRxSymbols;
+            mibGet->Param.MinRxSymbols = MacCtx->LoRaMacParams.MinRxSymbols;
             break;
         }
         case MIB_ANTENNA_GAIN:
         {
-            mibGet->Param.AntennaGain = LoRaMacParams.AntennaGain;
+            mibGet->Param.AntennaGain = MacCtx->LoRaMacParams.AntennaGain;
             break;
         }
         default:
@@ -2684,17 +2747,19 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t *mibGet )
     return status;
 }
 
-LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
+LoRaMacStatus_t LoRaMacMibSetRequestConfirmCtx( LoRaMacCtx_t *ctx, MibRequestConfirm_t *mibSet )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_OK;
     ChanMaskSetParams_t chanMaskSet;
     VerifyParams_t verify;
 
+    SelectCtx( ctx );
+
     if( mibSet == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
         return LORAMAC_STATUS_BUSY;
     }
@@ -2703,8 +2768,8 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
     {
         case MIB_DEVICE_CLASS:
         {
-            LoRaMacDeviceClass = mibSet->Param.Class;
-            switch( LoRaMacDeviceClass )
+            MacCtx->LoRaMacDeviceClass = mibSet->Param.Class;
+            switch( MacCtx->LoRaMacDeviceClass )
             {
                 case CLASS_A:
                 {
@@ -2719,7 +2784,7 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
                 case CLASS_C:
                 {
                     // Set the NodeAckRequested indicator to default
-                    NodeAckRequested = false;
+                    MacCtx->NodeAckRequested = false;
                     OnRxWindow2TimerEvent( );
                     break;
                 }
@@ -2728,30 +2793,31 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         }
         case MIB_NETWORK_JOINED:
         {
-            IsLoRaMacNetworkJoined = mibSet->Param.IsNetworkJoined;
+            MacCtx->IsLoRaMacNetworkJoined = mibSet->Param.IsNetworkJoined;
             break;
         }
         case MIB_ADR:
         {
-            AdrCtrlOn = mibSet->Param.AdrEnable;
+            MacCtx->AdrCtrlOn = mibSet->Param.AdrEnable;
             break;
         }
         case MIB_NET_ID:
         {
-            LoRaMacNetID = mibSet->Param.NetID;
+            MacCtx->LoRaMacNetID = mibSet->Param.NetID;
             break;
         }
         case MIB_DEV_ADDR:
         {
-            LoRaMacDevAddr = mibSet->Param.DevAddr;
+            MacCtx->LoRaMacDevAddr = mibSet->Param.DevAddr;
             break;
         }
         case MIB_NWK_SKEY:
         {
             if( mibSet->Param.NwkSKey != NULL )
             {
-                memcpy1( LoRaMacNwkSKey, mibSet->Param.NwkSKey,
-                               sizeof( LoRaMacNwkSKey ) );
+                memcpy1( MacCtx->LoRaMacNwkSKey, mibSet->Param.NwkSKey,
+                               sizeof( MacCtx->LoRaMacNwkSKey ) );
+                LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, MacCtx->LoRaMacNwkSKey );
             }
             else
             {
@@ -2763,8 +2829,9 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         {
             if( mibSet->Param.AppSKey != NULL )
             {
-                memcpy1( LoRaMacAppSKey, mibSet->Param.AppSKey,
-                               sizeof( LoRaMacAppSKey ) );
+                memcpy1( MacCtx->LoRaMacAppSKey, mibSet->Param.AppSKey,
+                               sizeof( MacCtx->LoRaMacAppSKey ) );
+                LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, MacCtx->LoRaMacAppSKey );
             }
             else
             {
@@ -2774,44 +2841,41 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         }
         case MIB_PUBLIC_NETWORK:
         {
-            PublicNetwork = mibSet->Param.EnablePublicNetwork;
-            Radio.SetPublicNetwork( PublicNetwork );
+            MacCtx->PublicNetwork = mibSet->Param.EnablePublicNetwork;
+            Radio.SetPublicNetwork( MacCtx->PublicNetwork );
+            RadioOwner = MacCtx;
             break;
         }
         case MIB_REPEATER_SUPPORT:
         {
-             RepeaterSupport = mibSet->Param.EnableRepeaterSupport;
+             MacCtx->RepeaterSupport = mibSet->Param.EnableRepeaterSupport;
             break;
         }
         case MIB_RX2_CHANNEL:
         {
             verify.DatarateParams.Datarate = mibSet->Param.Rx2Channel.Datarate;
-            verify.DatarateParams.DownlinkDwellTime = LoRaMacParams.DownlinkDwellTime;
+            verify.DatarateParams.DownlinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_RX_DR ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_RX_DR ) == true )
             {
-                LoRaMacParams.Rx2Channel = mibSet->Param.Rx2Channel;
+                MacCtx->LoRaMacParams.Rx2Channel = mibSet->Param.Rx2Channel;
 
-                if( ( LoRaMacDeviceClass == CLASS_C ) && ( IsLoRaMacNetworkJoined == true ) )
+                if( ( MacCtx->LoRaMacDeviceClass == CLASS_C ) && ( MacCtx->IsLoRaMacNetworkJoined == true ) )
                 {
                     // Compute Rx2 windows parameters
-                    RegionComputeRxWindowParameters( LoRaMacRegion,
-                                                     LoRaMacParams.Rx2Channel.Datarate,
-                                                     LoRaMacParams.MinRxSymbols,
-                                                     LoRaMacParams.SystemMaxRxError,
-                                                     &RxWindow2Config );
-
-                    RxWindow2Config.Channel = Channel;
-                    RxWindow2Config.Frequency = LoRaMacParams.Rx2Channel.Frequency;
-                    RxWindow2Config.DownlinkDwellTime = LoRaMacParams.DownlinkDwellTime;
-                    RxWindow2Config.RepeaterSupport = RepeaterSupport;
-                    RxWindow2Config.Window = 1;
-                    RxWindow2Config.RxContinuous = true;
-
-                    if( RegionRxConfig( LoRaMacRegion, &RxWindow2Config, ( int8_t* )&McpsIndication.RxDatarate ) == true )
+                    GetRxWindowParameters( MacCtx->LoRaMacParams.Rx2Channel.Datarate, &MacCtx->RxWindow2Config );
+
+                    MacCtx->RxWindow2Config.Channel = MacCtx->Channel;
+                    MacCtx->RxWindow2Config.Frequency = MacCtx->LoRaMacParams.Rx2Channel.Frequency;
+                    MacCtx->RxWindow2Config.DownlinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
+                    MacCtx->RxWindow2Config.RepeaterSupport = MacCtx->RepeaterSupport;
+                    MacCtx->RxWindow2Config.Window = 1;
+                    MacCtx->RxWindow2Config.RxContinuous = true;
+
+                    if( RegionRxConfig( MacCtx->LoRaMacRegion, &MacCtx->RxWindow2Config, ( int8_t* )&MacCtx->McpsIndication.RxDatarate ) == true )
                     {
-                        RxWindowSetup( RxWindow2Config.RxContinuous, LoRaMacParams.MaxRxWindow );
-                        RxSlot = RxWindow2Config.Window;
+                        RxWindowSetup( MacCtx->RxWindow2Config.RxContinuous, MacCtx->LoRaMacParams.MaxRxWindow );
+                        MacCtx->RxSlot = MacCtx->RxWindow2Config.Window;
                     }
                     else
                     {
@@ -2828,11 +2892,11 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         case MIB_RX2_DEFAULT_CHANNEL:
         {
             verify.DatarateParams.Datarate = mibSet->Param.Rx2Channel.Datarate;
-            verify.DatarateParams.DownlinkDwellTime = LoRaMacParams.DownlinkDwellTime;
+            verify.DatarateParams.DownlinkDwellTime = MacCtx->LoRaMacParams.DownlinkDwellTime;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_RX_DR ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_RX_DR ) == true )
             {
-                LoRaMacParamsDefaults.Rx2Channel = mibSet->Param.Rx2DefaultChannel;
+                MacCtx->LoRaMacParamsDefaults.Rx2Channel = mibSet->Param.Rx2DefaultChannel;
             }
             else
             {
@@ -2845,7 +2909,7 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
             chanMaskSet.ChannelsMaskIn = mibSet->Param.ChannelsMask;
             chanMaskSet.ChannelsMaskType = CHANNELS_DEFAULT_MASK;
 
-            if( RegionChanMaskSet( LoRaMacRegion, &chanMaskSet ) == false )
+            if( RegionChanMaskSet( MacCtx->LoRaMacRegion, &chanMaskSet ) == false )
             {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
@@ -2856,7 +2920,7 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
             chanMaskSet.ChannelsMaskIn = mibSet->Param.ChannelsMask;
             chanMaskSet.ChannelsMaskType = CHANNELS_MASK;
 
-            if( RegionChanMaskSet( LoRaMacRegion, &chanMaskSet ) == false )
+            if( RegionChanMaskSet( MacCtx->LoRaMacRegion, &chanMaskSet ) == false )
             {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
@@ -2867,7 +2931,7 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
             if( ( mibSet->Param.ChannelNbRep >= 1 ) &&
                 ( mibSet->Param.ChannelNbRep <= 15 ) )
             {
-                LoRaMacParams.ChannelsNbRep = mibSet->Param.ChannelNbRep;
+                MacCtx->LoRaMacParams.ChannelsNbRep = mibSet->Param.ChannelNbRep;
             }
             else
             {
@@ -2877,36 +2941,36 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         }
         case MIB_MAX_RX_WINDOW_DURATION:
         {
-            LoRaMacParams.MaxRxWindow = mibSet->Param.MaxRxWindow;
+            MacCtx->LoRaMacParams.MaxRxWindow = mibSet->Param.MaxRxWindow;
             break;
         }
         case MIB_RECEIVE_DELAY_1:
         {
-            LoRaMacParams.ReceiveDelay1 = mibSet->Param.ReceiveDelay1;
+            MacCtx->LoRaMacParams.ReceiveDelay1 = mibSet->Param.ReceiveDelay1;
             break;
         }
         case MIB_RECEIVE_DELAY_2:
         {
-            LoRaMacParams.ReceiveDelay2 = mibSet->Param.ReceiveDelay2;
+            MacCtx->LoRaMacParams.ReceiveDelay2 = mibSet->Param.ReceiveDelay2;
             break;
         }
         case MIB_JOIN_ACCEPT_DELAY_1:
         {
-            LoRaMacParams.JoinAcceptDelay1 = mibSet->Param.JoinAcceptDelay1;
+            MacCtx->LoRaMacParams.JoinAcceptDelay1 = mibSet->Param.JoinAcceptDelay1;
             break;
         }
         case MIB_JOIN_ACCEPT_DELAY_2:
         {
-            LoRaMacParams.JoinAcceptDelay2 = mibSet->Param.JoinAcceptDelay2;
+            MacCtx->LoRaMacParams.JoinAcceptDelay2 = mibSet->Param.JoinAcceptDelay2;
             break;
         }
         case MIB_CHANNELS_DEFAULT_DATARATE:
         {
             verify.DatarateParams.Datarate = mibSet->Param.ChannelsDefaultDatarate;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_DEF_TX_DR ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_DEF_TX_DR ) == true )
             {
-                LoRaMacParamsDefaults.ChannelsDatarate = verify.DatarateParams.Datarate;
+                MacCtx->LoRaMacParamsDefaults.ChannelsDatarate = verify.DatarateParams.Datarate;
             }
             else
             {
@@ -2918,9 +2982,9 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         {
             verify.DatarateParams.Datarate = mibSet->Param.ChannelsDatarate;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_TX_DR ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_TX_DR ) == true )
             {
-                LoRaMacParams.ChannelsDatarate = verify.DatarateParams.Datarate;
+                MacCtx->LoRaMacParams.ChannelsDatarate = verify.DatarateParams.Datarate;
             }
             else
             {
@@ -2932,9 +2996,9 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         {
             verify.TxPower = mibSet->Param.ChannelsDefaultTxPower;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_DEF_TX_POWER ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_DEF_TX_POWER ) == true )
             {
-                LoRaMacParamsDefaults.ChannelsTxPower = verify.TxPower;
+                MacCtx->LoRaMacParamsDefaults.ChannelsTxPower = verify.TxPower;
             }
             else
             {
@@ -2946,9 +3010,9 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         {
             verify.TxPower = mibSet->Param.ChannelsTxPower;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_TX_POWER ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_TX_POWER ) == true )
             {
-                LoRaMacParams.ChannelsTxPower = verify.TxPower;
+                MacCtx->LoRaMacParams.ChannelsTxPower = verify.TxPower;
             }
             else
             {
@@ -2958,27 +3022,29 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
         }
         case MIB_UPLINK_COUNTER:
         {
-            UpLinkCounter = mibSet->Param.UpLinkCounter;
+            MacCtx->UpLinkCounter = mibSet->Param.UpLinkCounter;
             break;
         }
         case MIB_DOWNLINK_COUNTER:
         {
-            DownLinkCounter = mibSet->Param.DownLinkCounter;
+            MacCtx->DownLinkCounter = mibSet->Param.DownLinkCounter;
             break;
         }
         case MIB_SYSTEM_MAX_RX_ERROR:
         {
-            LoRaMacParams.SystemMaxRxError = LoRaMacParamsDefaults.SystemMaxRxError = mibSet->Param.SystemMaxRxError;
+            MacCtx->LoRaMacParams.SystemMaxRxError = MacCtx->LoRaMacParamsDefaults.SystemMaxRxError = mibSet->Param.SystemMaxRxError;
+            MacCtx->RxWindowParamsValid = 0;
             break;
         }
         case MIB_MIN_RX_SYMBOLS:
         {
-            LoRaMacParams.MinRxSymbols = LoRaMacParamsDefaults.MinRxSymbols = mibSet->Param.MinRxSymbols;
+            MacCtx->LoRaMacParams.MinRxSymbols = MacCtx->LoRaMacParamsDefaults.MinRxSymbols = mibSet->Param.MinRxSymbols;
+            MacCtx->RxWindowParamsValid = 0;
             break;
         }
         case MIB_ANTENNA_GAIN:
         {
-            LoRaMacParams.AntennaGain = mibSet->Param.AntennaGain;
+            MacCtx->LoRaMacParams.AntennaGain = mibSet->Param.AntennaGain;
             break;
         }
         default:
@@ -2989,14 +3055,16 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
     return status;
 }
 
-LoRaMacStatus_t LoRaMacChannelAdd( uint8_t id, ChannelParams_t params )
+LoRaMacStatus_t LoRaMacChannelAddCtx( LoRaMacCtx_t *ctx, uint8_t id, ChannelParams_t params )
 {
     ChannelAddParams_t channelAdd;
 
+    SelectCtx( ctx );
+
     // Validate if the MAC is in a correct state
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
-        if( ( LoRaMacState & LORAMAC_TX_CONFIG ) != LORAMAC_TX_CONFIG )
+        if( ( MacCtx->LoRaMacState & LORAMAC_TX_CONFIG ) != LORAMAC_TX_CONFIG )
         {
             return LORAMAC_STATUS_BUSY;
         }
@@ -3005,16 +3073,18 @@ LoRaMacStatus_t LoRaMacChannelAdd( uint8_t id, ChannelParams_t params )
     channelAdd.NewChannel = &params;
     channelAdd.ChannelId = id;
 
-    return RegionChannelAdd( LoRaMacRegion, &channelAdd );
+    return RegionChannelAdd( MacCtx->LoRaMacRegion, &channelAdd );
 }
 
-LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id )
+LoRaMacStatus_t LoRaMacChannelRemoveCtx( LoRaMacCtx_t *ctx, uint8_t id )
 {
     ChannelRemoveParams_t channelRemove;
 
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    SelectCtx( ctx );
+
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
-        if( ( LoRaMacState & LORAMAC_TX_CONFIG ) != LORAMAC_TX_CONFIG )
+        if( ( MacCtx->LoRaMacState & LORAMAC_TX_CONFIG ) != LORAMAC_TX_CONFIG )
         {
             return LORAMAC_STATUS_BUSY;
         }
@@ -3022,20 +3092,22 @@ LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id )
 
     channelRemove.ChannelId = id;
 
-    if( RegionChannelsRemove( LoRaMacRegion, &channelRemove ) == false )
+    if( RegionChannelsRemove( MacCtx->LoRaMacRegion, &channelRemove ) == false )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacMulticastChannelLink( MulticastParams_t *channelParam )
+LoRaMacStatus_t LoRaMacMulticastChannelLinkCtx( LoRaMacCtx_t *ctx, MulticastParams_t *channelParam )
 {
+    SelectCtx( ctx );
+
     if( channelParam == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
         return LORAMAC_STATUS_BUSY;
     }
@@ -3043,14 +3115,18 @@ LoRaMacStatus_t LoRaMacMulticastChannelLink( MulticastParams_t *channelParam )
     // Reset downlink counter
     channelParam->DownLinkCounter = 0;
 
-    if( MulticastChannels == NULL )
+    // Expand the session keys once, they are looked up on every downlink
+    LoRaMacCryptoSetMulticastKey( channelParam->NwkSKey );
+    LoRaMacCryptoSetMulticastKey( channelParam->AppSKey );
+
+    if( MacCtx->MulticastChannels == NULL )
     {
         // New node is the fist element
-        MulticastChannels = channelParam;
+        MacCtx->MulticastChannels = channelParam;
     }
     else
     {
-        MulticastParams_t *cur = MulticastChannels;
+        MulticastParams_t *cur = MacCtx->MulticastChannels;
 
         // Search the last node in the list
         while( cur->Next != NULL )
@@ -3064,27 +3140,29 @@ LoRaMacStatus_t LoRaMacMulticastChannelLink( MulticastParams_t *channelParam )
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacMulticastChannelUnlink( MulticastParams_t *channelParam )
+LoRaMacStatus_t LoRaMacMulticastChannelUnlinkCtx( LoRaMacCtx_t *ctx, MulticastParams_t *channelParam )
 {
+    SelectCtx( ctx );
+
     if( channelParam == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
         return LORAMAC_STATUS_BUSY;
     }
 
-    if( MulticastChannels != NULL )
+    if( MacCtx->MulticastChannels != NULL )
     {
-        if( MulticastChannels == channelParam )
+        if( MacCtx->MulticastChannels == channelParam )
         {
           // First element
-          MulticastChannels = channelParam->Next;
+          MacCtx->MulticastChannels = channelParam->Next;
         }
         else
         {
-            MulticastParams_t *cur = MulticastChannels;
+            MulticastParams_t *cur = MacCtx->MulticastChannels;
 
             // Search the node in the list
             while( cur->Next && cur->Next != channelParam )
@@ -3100,10 +3178,14 @@ LoRaMacStatus_t LoRaMacMulticastChannelUnlink( MulticastParams_t *channelParam )
         channelParam->Next = NULL;
     }
 
+    // Release the multicast key schedules
+    LoRaMacCryptoClearMulticastKey( channelParam->NwkSKey );
+    LoRaMacCryptoClearMulticastKey( channelParam->AppSKey );
+
     return LORAMAC_STATUS_OK;
 }
 
-LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
+LoRaMacStatus_t LoRaMacMlmeRequestCtx( LoRaMacCtx_t *ctx, MlmeReq_t *mlmeRequest )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_SERVICE_UNKNOWN;
     LoRaMacHeader_t macHdr;
@@ -3112,24 +3194,26 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
 
+    SelectCtx( ctx );
+
     if( mlmeRequest == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    if( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    if( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
         return LORAMAC_STATUS_BUSY;
     }
 
-    memset1( ( uint8_t* ) &MlmeConfirm, 0, sizeof( MlmeConfirm ) );
+    memset1( ( uint8_t* ) &MacCtx->MlmeConfirm, 0, sizeof( MacCtx->MlmeConfirm ) );
 
-    MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+    MacCtx->MlmeConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
 
     switch( mlmeRequest->Type )
     {
         case MLME_JOIN:
         {
-            if( ( LoRaMacState & LORAMAC_TX_DELAYED ) == LORAMAC_TX_DELAYED )
+            if( ( MacCtx->LoRaMacState & LORAMAC_TX_DELAYED ) == LORAMAC_TX_DELAYED )
             {
                 return LORAMAC_STATUS_BUSY;
             }
@@ -3145,24 +3229,25 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
             // Verify the parameter NbTrials for the join procedure
             verify.NbJoinTrials = mlmeRequest->Req.Join.NbTrials;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_NB_JOIN_TRIALS ) == false )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_NB_JOIN_TRIALS ) == false )
             {
                 // Value not supported, get default
                 getPhy.Attribute = PHY_DEF_NB_JOIN_TRIALS;
-                phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+                phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
                 mlmeRequest->Req.Join.NbTrials = ( uint8_t ) phyParam.Value;
             }
 
-            LoRaMacFlags.Bits.MlmeReq = 1;
-            MlmeConfirm.MlmeRequest = mlmeRequest->Type;
+            MacCtx->LoRaMacFlags.Bits.MlmeReq = 1;
+            MacCtx->MlmeConfirm.MlmeRequest = mlmeRequest->Type;
 
-            LoRaMacDevEui = mlmeRequest->Req.Join.DevEui;
-            LoRaMacAppEui = mlmeRequest->Req.Join.AppEui;
-            LoRaMacAppKey = mlmeRequest->Req.Join.AppKey;
-            MaxJoinRequestTrials = mlmeRequest->Req.Join.NbTrials;
+            MacCtx->LoRaMacDevEui = mlmeRequest->Req.Join.DevEui;
+            MacCtx->LoRaMacAppEui = mlmeRequest->Req.Join.AppEui;
+            MacCtx->LoRaMacAppKey = mlmeRequest->Req.Join.AppKey;
+            LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_KEY, MacCtx->LoRaMacAppKey );
+            MacCtx->MaxJoinRequestTrials = mlmeRequest->Req.Join.NbTrials;
 
             // Reset variable JoinRequestTrials
-            JoinRequestTrials = 0;
+            MacCtx->JoinRequestTrials = 0;
 
             // Setup header information
             macHdr.Value = 0;
@@ -3170,33 +3255,33 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
 
             ResetMacParameters( );
 
-            altDr.NbTrials = JoinRequestTrials + 1;
+            altDr.NbTrials = MacCtx->JoinRequestTrials + 1;
 
-            LoRaMacParams.ChannelsDatarate = RegionAlternateDr( LoRaMacRegion, &altDr );
+            MacCtx->LoRaMacParams.ChannelsDatarate = RegionAlternateDr( MacCtx->LoRaMacRegion, &altDr );
 
             status = Send( &macHdr, 0, NULL, 0 );
             break;
         }
         case MLME_LINK_CHECK:
         {
-            LoRaMacFlags.Bits.MlmeReq = 1;
+            MacCtx->LoRaMacFlags.Bits.MlmeReq = 1;
             // LoRaMac will send this command piggy-pack
-            MlmeConfirm.MlmeRequest = mlmeRequest->Type;
+            MacCtx->MlmeConfirm.MlmeRequest = mlmeRequest->Type;
 
             status = AddMacCommand( MOTE_MAC_LINK_CHECK_REQ, 0, 0 );
             break;
         }
         case MLME_TXCW:
         {
-            MlmeConfirm.MlmeRequest = mlmeRequest->Type;
-            LoRaMacFlags.Bits.MlmeReq = 1;
+            MacCtx->MlmeConfirm.MlmeRequest = mlmeRequest->Type;
+            MacCtx->LoRaMacFlags.Bits.MlmeReq = 1;
             status = SetTxContinuousWave( mlmeRequest->Req.TxCw.Timeout );
             break;
         }
         case MLME_TXCW_1:
         {
-            MlmeConfirm.MlmeRequest = mlmeRequest->Type;
-            LoRaMacFlags.Bits.MlmeReq = 1;
+            MacCtx->MlmeConfirm.MlmeRequest = mlmeRequest->Type;
+            MacCtx->LoRaMacFlags.Bits.MlmeReq = 1;
             status = SetTxContinuousWave1( mlmeRequest->Req.TxCw.Timeout, mlmeRequest->Req.TxCw.Frequency, mlmeRequest->Req.TxCw.Power );
             break;
         }
@@ -3206,14 +3291,14 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
 
     if( status != LORAMAC_STATUS_OK )
     {
-        NodeAckRequested = false;
-        LoRaMacFlags.Bits.MlmeReq = 0;
+        MacCtx->NodeAckRequested = false;
+        MacCtx->LoRaMacFlags.Bits.MlmeReq = 0;
     }
 
     return status;
 }
 
-LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
+LoRaMacStatus_t LoRaMacMcpsRequestCtx( LoRaMacCtx_t *ctx, McpsReq_t *mcpsRequest )
 {
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
@@ -3226,29 +3311,31 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
     int8_t datarate;
     bool readyToSend = false;
 
+    SelectCtx( ctx );
+
     if( mcpsRequest == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    if( ( ( LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING ) ||
-        ( ( LoRaMacState & LORAMAC_TX_DELAYED ) == LORAMAC_TX_DELAYED ) )
+    if( ( ( MacCtx->LoRaMacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING ) ||
+        ( ( MacCtx->LoRaMacState & LORAMAC_TX_DELAYED ) == LORAMAC_TX_DELAYED ) )
     {
         return LORAMAC_STATUS_BUSY;
     }
 
     macHdr.Value = 0;
-    memset1 ( ( uint8_t* ) &McpsConfirm, 0, sizeof( McpsConfirm ) );
-    McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+    memset1 ( ( uint8_t* ) &MacCtx->McpsConfirm, 0, sizeof( MacCtx->McpsConfirm ) );
+    MacCtx->McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
 
     // AckTimeoutRetriesCounter must be reset every time a new request (unconfirmed or confirmed) is performed.
-    AckTimeoutRetriesCounter = 1;
+    MacCtx->AckTimeoutRetriesCounter = 1;
 
     switch( mcpsRequest->Type )
     {
         case MCPS_UNCONFIRMED:
         {
             readyToSend = true;
-            AckTimeoutRetries = 1;
+            MacCtx->AckTimeoutRetries = 1;
 
             macHdr.Bits.MType = FRAME_TYPE_DATA_UNCONFIRMED_UP;
             fPort = mcpsRequest->Req.Unconfirmed.fPort;
@@ -3260,7 +3347,7 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
         case MCPS_CONFIRMED:
         {
             readyToSend = true;
-            AckTimeoutRetries = mcpsRequest->Req.Confirmed.NbTrials;
+            MacCtx->AckTimeoutRetries = mcpsRequest->Req.Confirmed.NbTrials;
 
             macHdr.Bits.MType = FRAME_TYPE_DATA_CONFIRMED_UP;
             fPort = mcpsRequest->Req.Confirmed.fPort;
@@ -3272,7 +3359,7 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
         case MCPS_PROPRIETARY:
         {
             readyToSend = true;
-            AckTimeoutRetries = 1;
+            MacCtx->AckTimeoutRetries = 1;
 
             macHdr.Bits.MType = FRAME_TYPE_PROPRIETARY;
             fBuffer = mcpsRequest->Req.Proprietary.fBuffer;
@@ -3286,22 +3373,22 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
 
     // Get the minimum possible datarate
     getPhy.Attribute = PHY_MIN_TX_DR;
-    getPhy.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
-    phyParam = RegionGetPhyParam( LoRaMacRegion, &getPhy );
+    getPhy.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
+    phyParam = RegionGetPhyParam( MacCtx->LoRaMacRegion, &getPhy );
     // Apply the minimum possible datarate.
     // Some regions have limitations for the minimum datarate.
     datarate = MAX( datarate, phyParam.Value );
 
     if( readyToSend == true )
     {
-        if( AdrCtrlOn == false )
+        if( MacCtx->AdrCtrlOn == false )
         {
             verify.DatarateParams.Datarate = datarate;
-            verify.DatarateParams.UplinkDwellTime = LoRaMacParams.UplinkDwellTime;
+            verify.DatarateParams.UplinkDwellTime = MacCtx->LoRaMacParams.UplinkDwellTime;
 
-            if( RegionVerify( LoRaMacRegion, &verify, PHY_TX_DR ) == true )
+            if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_TX_DR ) == true )
             {
-                LoRaMacParams.ChannelsDatarate = verify.DatarateParams.Datarate;
+                MacCtx->LoRaMacParams.ChannelsDatarate = verify.DatarateParams.Datarate;
             }
             else
             {
@@ -3312,42 +3399,107 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
         status = Send( &macHdr, fPort, fBuffer, fBufferSize );
         if( status == LORAMAC_STATUS_OK )
         {
-            McpsConfirm.McpsRequest = mcpsRequest->Type;
-            LoRaMacFlags.Bits.McpsReq = 1;
+            MacCtx->McpsConfirm.McpsRequest = mcpsRequest->Type;
+            MacCtx->LoRaMacFlags.Bits.McpsReq = 1;
         }
         else
         {
-            NodeAckRequested = false;
+            MacCtx->NodeAckRequested = false;
         }
     }
 
     return status;
 }
 
+LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t *primitives, LoRaMacCallback_t *callbacks, LoRaMacRegion_t region )
+{
+    return LoRaMacInitializationCtx( &LoRaMacDefaultCtx, primitives, callbacks, region );
+}
+
+void LoRaMacProcess( void )
+{
+    LoRaMacProcessCtx( &LoRaMacDefaultCtx );
+}
+
+bool LoRaMacIsProcessPending( void )
+{
+    return LoRaMacIsProcessPendingCtx( &LoRaMacDefaultCtx );
+}
+
+LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
+{
+    return LoRaMacQueryTxPossibleCtx( &LoRaMacDefaultCtx, size, txInfo );
+}
+
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t *mibGet )
+{
+    return LoRaMacMibGetRequestConfirmCtx( &LoRaMacDefaultCtx, mibGet );
+}
+
+LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t *mibSet )
+{
+    return LoRaMacMibSetRequestConfirmCtx( &LoRaMacDefaultCtx, mibSet );
+}
+
+LoRaMacStatus_t LoRaMacChannelAdd( uint8_t id, ChannelParams_t params )
+{
+    return LoRaMacChannelAddCtx( &LoRaMacDefaultCtx, id, params );
+}
+
+LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id )
+{
+    return LoRaMacChannelRemoveCtx( &LoRaMacDefaultCtx, id );
+}
+
+LoRaMacStatus_t LoRaMacMulticastChannelLink( MulticastParams_t *channelParam )
+{
+    return LoRaMacMulticastChannelLinkCtx( &LoRaMacDefaultCtx, channelParam );
+}
+
+LoRaMacStatus_t LoRaMacMulticastChannelUnlink( MulticastParams_t *channelParam )
+{
+    return LoRaMacMulticastChannelUnlinkCtx( &LoRaMacDefaultCtx, channelParam );
+}
+
+LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest )
+{
+    return LoRaMacMlmeRequestCtx( &LoRaMacDefaultCtx, mlmeRequest );
+}
+
+LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest )
+{
+    return LoRaMacMcpsRequestCtx( &LoRaMacDefaultCtx, mcpsRequest );
+}
+
 void LoRaMacTestRxWindowsOn( bool enable )
 {
-    IsRxWindowsEnabled = enable;
+    SelectCtx( &LoRaMacDefaultCtx );
+    MacCtx->IsRxWindowsEnabled = enable;
 }
 
 void LoRaMacTestSetMic( uint16_t txPacketCounter )
 {
-    UpLinkCounter = txPacketCounter;
-    IsUpLinkCounterFixed = true;
+    SelectCtx( &LoRaMacDefaultCtx );
+    MacCtx->UpLinkCounter = txPacketCounter;
+    MacCtx->IsUpLinkCounterFixed = true;
 }
 
 void LoRaMacTestSetDutyCycleOn( bool enable )
 {
     VerifyParams_t verify;
 
+    SelectCtx( &LoRaMacDefaultCtx );
+
     verify.DutyCycle = enable;
 
-    if( RegionVerify( LoRaMacRegion, &verify, PHY_DUTY_CYCLE ) == true )
+    if( RegionVerify( MacCtx->LoRaMacRegion, &verify, PHY_DUTY_CYCLE ) == true )
     {
-        DutyCycleOn = enable;
+        MacCtx->DutyCycleOn = enable;
     }
 }
 
 void LoRaMacTestSetChannel( uint8_t channel )
 {
-    Channel = channel;
+    SelectCtx( &LoRaMacDefaultCtx );
+    MacCtx->Channel = channel;
 }
@@ -1699,6 +1699,18 @@ typedef struct sLoRaMacCallback
     uint8_t ( *GetBatteryLevel )( void );
 }LoRaMacCallback_t;
 
+/*!
+ * LoRaMAC instance context, defined in LoRaMacCtx.h
+ *
+ * \remark The functions without the Ctx suffix work on a context of their
+ *         own. Several contexts, e.g. a private and a public network, share
+ *         the radio and the timer server: the application only starts a
+ *         request on a context while the others are idle, and calls
+ *         \ref LoRaMacProcessCtx for each of them. The MCPS and MLME
+ *         primitives must not call the functions of another context.
+ */
+typedef struct sLoRaMacCtx LoRaMacCtx_t;
+
 /*!
  * LoRaMAC Max EIRP (dBm) table
  */
@@ -1730,6 +1742,28 @@ static const uint8_t LoRaMacMaxEirpTable[] = { 8, 10, 12, 13, 14, 16, 18, 20, 21
  */
 LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t *primitives, LoRaMacCallback_t *callbacks, LoRaMacRegion_t region );
 
+/*!
+ * \brief   Processes the LoRaMAC events
+ *
+ * \details The radio interrupts and the MAC timers only queue their events,
+ *          this function runs the MAC on them: frame decoding, MAC commands
+ *          and the MCPS/MLME primitives. It must be called from the main
+ *          loop, never from interrupt context. The Rx windows are still
+ *          opened from the timer interrupt.
+ */
+void LoRaMacProcess( void );
+
+/*!
+ * \brief   Tells whether events are waiting for \ref LoRaMacProcess
+ *
+ * \details To be checked with the interrupts disabled before entering a
+ *          low power mode, an event queued after the last call to
+ *          \ref LoRaMacProcess would otherwise wait for the next wake up.
+ *
+ * \retval  true if \ref LoRaMacProcess has events to process
+ */
+bool LoRaMacIsProcessPending( void );
+
 /*!
  * \brief   Queries the LoRaMAC if it is possible to send the next frame with
  *          a given payload size. The LoRaMAC takes scheduled MAC commands into
@@ -1956,6 +1990,72 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t *mlmeRequest );
  */
 LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t *mcpsRequest );
 
+/*!
+ * \brief   \ref LoRaMacInitialization on the given context
+ *
+ * \details The context is cleared first, it may be a zeroed or a
+ *          reused LoRaMacCtx_t. Returns \ref LORAMAC_STATUS_PARAMETER_INVALID
+ *          when ctx is NULL.
+ *
+ * \param   [IN] ctx - LoRaMAC instance context.
+ */
+LoRaMacStatus_t LoRaMacInitializationCtx( LoRaMacCtx_t *ctx, LoRaMacPrimitives_t *primitives, LoRaMacCallback_t *callbacks, LoRaMacRegion_t region );
+
+/*!
+ * \brief   \ref LoRaMacProcess on the given context
+ */
+void LoRaMacProcessCtx( LoRaMacCtx_t *ctx );
+
+/*!
+ * \brief   \ref LoRaMacIsProcessPending on the given context
+ */
+bool LoRaMacIsProcessPendingCtx( LoRaMacCtx_t *ctx );
+
+/*!
+ * \brief   \ref LoRaMacQueryTxPossible on the given context
+ */
+LoRaMacStatus_t LoRaMacQueryTxPossibleCtx( LoRaMacCtx_t *ctx, uint8_t size, LoRaMacTxInfo_t* txInfo );
+
+/*!
+ * \brief   \ref LoRaMacChannelAdd on the given context
+ */
+LoRaMacStatus_t LoRaMacChannelAddCtx( LoRaMacCtx_t *ctx, uint8_t id, ChannelParams_t params );
+
+/*!
+ * \brief   \ref LoRaMacChannelRemove on the given context
+ */
+LoRaMacStatus_t LoRaMacChannelRemoveCtx( LoRaMacCtx_t *ctx, uint8_t id );
+
+/*!
+ * \brief   \ref LoRaMacMulticastChannelLink on the given context
+ */
+LoRaMacStatus_t LoRaMacMulticastChannelLinkCtx( LoRaMacCtx_t *ctx, MulticastParams_t *channelParam );
+
+/*!
+ * \brief   \ref LoRaMacMulticastChannelUnlink on the given context
+ */
+LoRaMacStatus_t LoRaMacMulticastChannelUnlinkCtx( LoRaMacCtx_t *ctx, MulticastParams_t *channelParam );
+
+/*!
+ * \brief   \ref LoRaMacMibGetRequestConfirm on the given context
+ */
+LoRaMacStatus_t LoRaMacMibGetRequestConfirmCtx( LoRaMacCtx_t *ctx, MibRequestConfirm_t *mibGet );
+
+/*!
+ * \brief   \ref LoRaMacMibSetRequestConfirm on the given context
+ */
+LoRaMacStatus_t LoRaMacMibSetRequestConfirmCtx( LoRaMacCtx_t *ctx, MibRequestConfirm_t *mibSet );
+
+/*!
+ * \brief   \ref LoRaMacMlmeRequest on the given context
+ */
+LoRaMacStatus_t LoRaMacMlmeRequestCtx( LoRaMacCtx_t *ctx, MlmeReq_t *mlmeRequest );
+
+/*!
+ * \brief   \ref LoRaMacMcpsRequest on the given context
+ */
+LoRaMacStatus_t LoRaMacMcpsRequestCtx( LoRaMacCtx_t *ctx, McpsReq_t *mcpsRequest );
+
 /*! \} defgroup LORAMAC */
 
 #endif // __LORAMAC_H__
@@ -19,10 +19,11 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 */
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include "utilities.h"
 
 #include "aes.h"
-#include "cmac.h"
 
 #include "LoRaMacCrypto.h"
 
@@ -32,122 +33,518 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define LORAMAC_MIC_BLOCK_B0_SIZE                   16
 
 /*!
- * MIC field computation initial data
+ * MIC field computation Block B0 first byte
  */
-static uint8_t MicBlockB0[] = { 0x49, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-                              };
+#define LORAMAC_MIC_BLOCK_B0_TAG                    0x49
 
 /*!
- * Contains the computed MIC field.
- *
- * \remark Only the 4 first bytes are used
+ * Number of CTR keystream blocks generated per batch by the software provider
  */
-static uint8_t Mic[16];
+#define LORAMAC_CTR_BATCH_BLOCKS                    4
 
 /*!
- * Encryption aBlock and sBlock
+ * AES computation context variable, holds the schedule of the last key
+ * which was not found in the key cache
  */
-static uint8_t aBlock[] = { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-                          };
-static uint8_t sBlock[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-                          };
+static aes_context AesContext;
 
 /*!
- * AES computation context variable
+ * Key expanded into AesContext
  */
-static aes_context AesContext;
+static uint8_t AesContextKey[16];
+
+/*!
+ * Indicates if AesContext holds the schedule of AesContextKey
+ */
+static bool AesContextValid = false;
+
+/*!
+ * AES provider in use, the software one until LoRaMacCryptoInit selects another
+ */
+static const LoRaMacCryptoProvider_t *Provider = &LoRaMacCryptoSoftProvider;
+
+/*!
+ * Key schedule cache entry
+ */
+typedef struct sLoRaMacCryptoKeyEntry
+{
+    /*!
+     * Indicates if the entry holds a key
+     */
+    bool InUse;
+    /*!
+     * Copy of the key, used to find the entry back from a key buffer
+     */
+    uint8_t Key[16];
+    /*!
+     * Expanded key schedule
+     */
+    aes_context Schedule;
+    /*!
+     * CMAC subkey K1, used when the last block is complete
+     */
+    uint8_t K1[16];
+    /*!
+     * CMAC subkey K2, used when the last block is padded
+     */
+    uint8_t K2[16];
+}LoRaMacCryptoKeyEntry_t;
 
 /*!
- * CMAC computation context variable
+ * Key schedule cache
  */
-static AES_CMAC_CTX AesCmacCtx[1];
+static LoRaMacCryptoKeyEntry_t KeyCache[LORAMAC_CRYPTO_NB_KEYS];
 
 /*!
- * \brief Computes the LoRaMAC frame MIC field  
+ * \brief Compares two 16 bytes keys
  *
- * \param [IN]  buffer          Data buffer
- * \param [IN]  size            Data buffer size
- * \param [IN]  key             AES key to be used
+ * \retval equal Returns true if the keys are identical
+ */
+static bool KeyEqual( const uint8_t *a, const uint8_t *b )
+{
+    uint8_t i;
+
+    for( i = 0; i < 16; i++ )
+    {
+        if( a[i] != b[i] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Doubles a 16 bytes value in GF(2^128), as done for the CMAC subkeys
+ *
+ * \param [IN]  in              Value to be doubled
+ * \param [OUT] out             Doubled value
+ */
+static void CmacDouble( const uint8_t *in, uint8_t *out )
+{
+    uint8_t i;
+    uint8_t msb = in[0] & 0x80;
+
+    for( i = 0; i < 15; i++ )
+    {
+        out[i] = ( in[i] << 1 ) | ( in[i + 1] >> 7 );
+    }
+    out[15] = in[15] << 1;
+    if( msb != 0 )
+    {
+        out[15] ^= 0x87;
+    }
+}
+
+/*!
+ * \brief Builds the 16 bytes Block B0 ( MIC ) or Block A ( encryption )
+ *
+ * \param [OUT] block           Block to be filled
+ * \param [IN]  tag             Block first byte
  * \param [IN]  address         Frame address
  * \param [IN]  dir             Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter Frame sequence counter
- * \param [OUT] mic Computed MIC field
+ * \param [IN]  last            Block last byte ( message length or counter )
  */
-void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic )
+static void BuildBlock( uint8_t *block, uint8_t tag, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t last )
 {
-    MicBlockB0[5] = dir;
-    
-    MicBlockB0[6] = ( address ) & 0xFF;
-    MicBlockB0[7] = ( address >> 8 ) & 0xFF;
-    MicBlockB0[8] = ( address >> 16 ) & 0xFF;
-    MicBlockB0[9] = ( address >> 24 ) & 0xFF;
+    block[0] = tag;
+    block[1] = 0x00;
+    block[2] = 0x00;
+    block[3] = 0x00;
+    block[4] = 0x00;
+
+    block[5] = dir;
+
+    block[6] = ( address ) & 0xFF;
+    block[7] = ( address >> 8 ) & 0xFF;
+    block[8] = ( address >> 16 ) & 0xFF;
+    block[9] = ( address >> 24 ) & 0xFF;
+
+    block[10] = ( sequenceCounter ) & 0xFF;
+    block[11] = ( sequenceCounter >> 8 ) & 0xFF;
+    block[12] = ( sequenceCounter >> 16 ) & 0xFF;
+    block[13] = ( sequenceCounter >> 24 ) & 0xFF;
+
+    block[14] = 0x00;
+    block[15] = last;
+}
 
-    MicBlockB0[10] = ( sequenceCounter ) & 0xFF;
-    MicBlockB0[11] = ( sequenceCounter >> 8 ) & 0xFF;
-    MicBlockB0[12] = ( sequenceCounter >> 16 ) & 0xFF;
-    MicBlockB0[13] = ( sequenceCounter >> 24 ) & 0xFF;
+/*!
+ * \brief Computes an AES-CMAC in one pass with precomputed subkeys
+ *
+ * \param [IN]  key             AES key
+ * \param [IN]  k1              CMAC subkey K1
+ * \param [IN]  k2              CMAC subkey K2
+ * \param [IN]  b0              Optional first block, may be NULL
+ * \param [IN]  buffer          Data buffer
+ * \param [IN]  size            Data buffer size
+ * \param [OUT] digest          Computed 16 bytes CMAC
+ */
+static void ComputeCmac( const uint8_t *key, const uint8_t *k1, const uint8_t *k2, const uint8_t *b0, const uint8_t *buffer, uint16_t size, uint8_t *digest )
+{
+    uint8_t i;
+    uint8_t last[16];
+    const uint8_t *subKey;
 
-    MicBlockB0[15] = size & 0xFF;
+    memset1( digest, 0, 16 );
 
-    AES_CMAC_Init( AesCmacCtx );
+    if( b0 != NULL )
+    {
+        if( size == 0 )
+        {
+            // Block B0 is the last and only block
+            buffer = b0;
+            size = 16;
+        }
+        else
+        {
+            Provider->CbcMac( key, b0, 1, digest );
+        }
+    }
 
-    AES_CMAC_SetKey( AesCmacCtx, key );
+    if( size > 16 )
+    {
+        i = ( size - 1 ) >> 4;
+        Provider->CbcMac( key, buffer, i, digest );
+        buffer += ( uint16_t )i << 4;
+        size -= ( uint16_t )i << 4;
+    }
 
-    AES_CMAC_Update( AesCmacCtx, MicBlockB0, LORAMAC_MIC_BLOCK_B0_SIZE );
-    
-    AES_CMAC_Update( AesCmacCtx, buffer, size & 0xFF );
-    
-    AES_CMAC_Final( Mic, AesCmacCtx );
-    
-    *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+    // Last block, complete or padded
+    memset1( last, 0, 16 );
+    memcpy1( last, buffer, size );
+    if( size == 16 )
+    {
+        subKey = k1;
+    }
+    else
+    {
+        subKey = k2;
+        last[size] = 0x80;
+    }
+    for( i = 0; i < 16; i++ )
+    {
+        last[i] ^= subKey[i];
+    }
+    Provider->CbcMac( key, last, 1, digest );
 }
 
-void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer )
+/*!
+ * \brief Computes the CMAC subkeys of a key which is not cached
+ *
+ * \param [IN]  key             AES key
+ * \param [OUT] k1              CMAC subkey K1
+ * \param [OUT] k2              CMAC subkey K2
+ */
+static void ComputeSubKeys( const uint8_t *key, uint8_t *k1, uint8_t *k2 )
 {
-    uint16_t i;
-    uint8_t bufferIndex = 0;
-    uint16_t ctr = 1;
+    memset1( k1, 0, 16 );
+    Provider->Ecb( key, k1, k1, 1 );
+    CmacDouble( k1, k1 );
+    CmacDouble( k1, k2 );
+}
+
+/*!
+ * \brief Returns the expanded schedule of the given key
+ *
+ * \remark Keys not found in the cache are expanded into AesContext, the
+ *         returned schedule is then only valid until the next call.
+ *
+ * \param [IN]  key             AES key
+ * \retval schedule Expanded key schedule
+ */
+static const aes_context* GetKeySchedule( const uint8_t *key )
+{
+    LoRaMacCryptoKeyHandle_t handle = LoRaMacCryptoGetKeyHandle( key );
+
+    if( handle != LORAMAC_CRYPTO_KEY_NONE )
+    {
+        return &KeyCache[handle].Schedule;
+    }
 
-    memset1( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
+    if( ( AesContextValid == false ) || ( KeyEqual( AesContextKey, key ) == false ) )
+    {
+        memset1( AesContext.ksch, '\0', 240 );
+        aes_set_key( key, 16, &AesContext );
+        memcpy1( AesContextKey, key, 16 );
+        AesContextValid = true;
+    }
+    return &AesContext;
+}
 
-    aBlock[5] = dir;
+/*!
+ * \brief Software provider AES-ECB encryption
+ */
+static void SoftEcb( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+    const aes_context *schedule = GetKeySchedule( key );
 
-    aBlock[6] = ( address ) & 0xFF;
-    aBlock[7] = ( address >> 8 ) & 0xFF;
-    aBlock[8] = ( address >> 16 ) & 0xFF;
-    aBlock[9] = ( address >> 24 ) & 0xFF;
+    while( nbBlocks-- > 0 )
+    {
+        aes_encrypt( in, out, schedule );
+        in += 16;
+        out += 16;
+    }
+}
 
-    aBlock[10] = ( sequenceCounter ) & 0xFF;
-    aBlock[11] = ( sequenceCounter >> 8 ) & 0xFF;
-    aBlock[12] = ( sequenceCounter >> 16 ) & 0xFF;
-    aBlock[13] = ( sequenceCounter >> 24 ) & 0xFF;
+/*!
+ * \brief Software provider AES-CBC-MAC
+ */
+static void SoftCbcMac( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain )
+{
+    const aes_context *schedule = GetKeySchedule( key );
+    uint8_t i;
 
-    while( size >= 16 )
+    while( nbBlocks-- > 0 )
     {
-        aBlock[15] = ( ( ctr ) & 0xFF );
-        ctr++;
-        aes_encrypt( aBlock, sBlock, &AesContext );
         for( i = 0; i < 16; i++ )
         {
-            encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
+            chain[i] ^= in[i];
         }
-        size -= 16;
-        bufferIndex += 16;
+        aes_encrypt( chain, chain, schedule );
+        in += 16;
     }
+}
 
-    if( size > 0 )
+/*!
+ * \brief Generates consecutive CTR keystream blocks
+ *
+ * \param [IN]    schedule        Expanded key schedule
+ * \param [INOUT] ctrBlock        Counter block, advanced by nbBlocks
+ * \param [OUT]   keystream       Keystream, nbBlocks * 16 bytes
+ * \param [IN]    nbBlocks        Number of blocks to generate
+ */
+static void SoftKeystream( const aes_context *schedule, uint8_t *ctrBlock, uint8_t *keystream, uint8_t nbBlocks )
+{
+    while( nbBlocks-- > 0 )
     {
-        aBlock[15] = ( ( ctr ) & 0xFF );
-        aes_encrypt( aBlock, sBlock, &AesContext );
-        for( i = 0; i < size; i++ )
+        aes_encrypt( ctrBlock, keystream, schedule );
+        ctrBlock[15]++;
+        keystream += 16;
+    }
+}
+
+/*!
+ * \brief XORs the keystream into the data, 32 bits at a time. out may be
+ *        the same as in.
+ *
+ * \remark The data words go through memcpy, which is safe for any buffer
+ *         alignment and compiles to single loads and stores on the cores
+ *         with unaligned access.
+ *
+ * \param [IN]  in              Input data
+ * \param [IN]  keystream       Keystream words
+ * \param [OUT] out             Output data
+ * \param [IN]  size            Number of bytes
+ */
+static void XorKeystream( const uint8_t *in, const uint32_t *keystream, uint8_t *out, uint16_t size )
+{
+    uint32_t word;
+    uint16_t i;
+
+    for( i = 0; ( i + 4 ) <= size; i += 4 )
+    {
+        memcpy( &word, in + i, 4 );
+        word ^= keystream[i >> 2];
+        memcpy( out + i, &word, 4 );
+    }
+    for( ; i < size; i++ )
+    {
+        out[i] = in[i] ^ ( ( const uint8_t* )keystream )[i];
+    }
+}
+
+/*!
+ * \brief Software provider AES-CTR, the counter is the block last byte
+ */
+static void SoftCtr( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out )
+{
+    const aes_context *schedule = GetKeySchedule( key );
+    uint32_t keystream[LORAMAC_CTR_BATCH_BLOCKS * 4];
+    uint8_t ctrBlock[16];
+    uint8_t nbBlocks;
+    uint16_t len;
+
+    memcpy1( ctrBlock, counterBlock, 16 );
+    while( size > 0 )
+    {
+        nbBlocks = ( size >= ( LORAMAC_CTR_BATCH_BLOCKS * 16 ) ) ? LORAMAC_CTR_BATCH_BLOCKS : ( ( size + 15 ) >> 4 );
+        len = ( size > ( nbBlocks * 16 ) ) ? ( nbBlocks * 16 ) : size;
+
+        SoftKeystream( schedule, ctrBlock, ( uint8_t* )keystream, nbBlocks );
+        XorKeystream( in, keystream, out, len );
+
+        in += len;
+        out += len;
+        size -= len;
+    }
+}
+
+const LoRaMacCryptoProvider_t LoRaMacCryptoSoftProvider =
+{
+    NULL,
+    SoftEcb,
+    SoftCbcMac,
+    SoftCtr
+};
+
+void LoRaMacCryptoInit( const LoRaMacCryptoProvider_t *provider )
+{
+    Provider = &LoRaMacCryptoSoftProvider;
+
+    if( ( provider != NULL ) && ( ( provider->Init == NULL ) || ( provider->Init( ) == true ) ) )
+    {
+        Provider = provider;
+    }
+}
+
+void LoRaMacCryptoSetKey( LoRaMacCryptoKeyHandle_t handle, const uint8_t *key )
+{
+    if( handle >= LORAMAC_CRYPTO_NB_KEYS )
+    {
+        return;
+    }
+    if( ( KeyCache[handle].InUse == true ) && ( KeyEqual( KeyCache[handle].Key, key ) == true ) )
+    {
+        // Schedule already up to date
+        return;
+    }
+    memcpy1( KeyCache[handle].Key, key, 16 );
+    memset1( KeyCache[handle].Schedule.ksch, '\0', 240 );
+    aes_set_key( key, 16, &KeyCache[handle].Schedule );
+
+    // CMAC subkeys: K1 = dbl( AES( K, 0 ) ), K2 = dbl( K1 )
+    memset1( KeyCache[handle].K1, 0, 16 );
+    aes_encrypt( KeyCache[handle].K1, KeyCache[handle].K1, &KeyCache[handle].Schedule );
+    CmacDouble( KeyCache[handle].K1, KeyCache[handle].K1 );
+    CmacDouble( KeyCache[handle].K1, KeyCache[handle].K2 );
+
+    KeyCache[handle].InUse = true;
+}
+
+void LoRaMacCryptoClearKey( LoRaMacCryptoKeyHandle_t handle )
+{
+    if( handle >= LORAMAC_CRYPTO_NB_KEYS )
+    {
+        return;
+    }
+    memset1( ( uint8_t* )&KeyCache[handle], 0, sizeof( LoRaMacCryptoKeyEntry_t ) );
+}
+
+LoRaMacCryptoKeyHandle_t LoRaMacCryptoSetMulticastKey( const uint8_t *key )
+{
+    LoRaMacCryptoKeyHandle_t handle;
+
+    for( handle = LORAMAC_CRYPTO_MC_KEY_FIRST; handle < LORAMAC_CRYPTO_NB_KEYS; handle++ )
+    {
+        if( KeyCache[handle].InUse == false )
+        {
+            LoRaMacCryptoSetKey( handle, key );
+            return handle;
+        }
+    }
+    return LORAMAC_CRYPTO_KEY_NONE;
+}
+
+void LoRaMacCryptoClearMulticastKey( const uint8_t *key )
+{
+    LoRaMacCryptoKeyHandle_t handle;
+
+    for( handle = LORAMAC_CRYPTO_MC_KEY_FIRST; handle < LORAMAC_CRYPTO_NB_KEYS; handle++ )
+    {
+        if( ( KeyCache[handle].InUse == true ) && ( KeyEqual( KeyCache[handle].Key, key ) == true ) )
+        {
+            LoRaMacCryptoClearKey( handle );
+            return;
+        }
+    }
+}
+
+LoRaMacCryptoKeyHandle_t LoRaMacCryptoGetKeyHandle( const uint8_t *key )
+{
+    LoRaMacCryptoKeyHandle_t handle;
+
+    for( handle = 0; handle < LORAMAC_CRYPTO_NB_KEYS; handle++ )
+    {
+        if( ( KeyCache[handle].InUse == true ) && ( KeyEqual( KeyCache[handle].Key, key ) == true ) )
         {
-            encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
+            return handle;
         }
     }
+    return LORAMAC_CRYPTO_KEY_NONE;
+}
+
+void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic )
+{
+    LoRaMacCryptoKeyHandle_t handle = LoRaMacCryptoGetKeyHandle( key );
+    uint8_t b0[LORAMAC_MIC_BLOCK_B0_SIZE];
+    uint8_t digest[16];
+    uint8_t k1[16];
+    uint8_t k2[16];
+
+    if( handle != LORAMAC_CRYPTO_KEY_NONE )
+    {
+        LoRaMacComputeMicFast( handle, dir, address, sequenceCounter, buffer, size, mic );
+        return;
+    }
+
+    BuildBlock( b0, LORAMAC_MIC_BLOCK_B0_TAG, address, dir, sequenceCounter, size & 0xFF );
+
+    ComputeSubKeys( key, k1, k2 );
+    ComputeCmac( key, k1, k2, b0, buffer, size & 0xFF, digest );
+
+    *mic = ( uint32_t )( ( uint32_t )digest[3] << 24 | ( uint32_t )digest[2] << 16 | ( uint32_t )digest[1] << 8 | ( uint32_t )digest[0] );
+}
+
+void LoRaMacComputeMicFast( LoRaMacCryptoKeyHandle_t handle, uint8_t dir, uint32_t address, uint32_t sequenceCounter, const uint8_t *buffer, uint16_t size, uint32_t *mic )
+{
+    const LoRaMacCryptoKeyEntry_t *entry;
+    uint8_t b0[LORAMAC_MIC_BLOCK_B0_SIZE];
+    uint8_t digest[16];
+
+    if( ( handle >= LORAMAC_CRYPTO_NB_KEYS ) || ( KeyCache[handle].InUse == false ) )
+    {
+        *mic = 0;
+        return;
+    }
+    entry = &KeyCache[handle];
+
+    BuildBlock( b0, LORAMAC_MIC_BLOCK_B0_TAG, address, dir, sequenceCounter, size & 0xFF );
+
+    ComputeCmac( entry->Key, entry->K1, entry->K2, b0, buffer, size & 0xFF, digest );
+
+    *mic = ( uint32_t )( ( uint32_t )digest[3] << 24 | ( uint32_t )digest[2] << 16 | ( uint32_t )digest[1] << 8 | ( uint32_t )digest[0] );
+}
+
+void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer )
+{
+    uint8_t aBlock[16];
+
+    if( size == 0 )
+    {
+        return;
+    }
+
+    BuildBlock( aBlock, 0x01, address, dir, sequenceCounter, 0x01 );
+
+    Provider->Ctr( key, aBlock, buffer, size, encBuffer );
+}
+
+void LoRaMacPayloadKeystream( const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t firstBlock, uint8_t nbBlocks, uint8_t *keystream )
+{
+    uint8_t aBlock[16];
+
+    if( nbBlocks == 0 )
+    {
+        return;
+    }
+
+    BuildBlock( aBlock, 0x01, address, dir, sequenceCounter, firstBlock );
+
+    // CTR over a zeroed buffer yields the bare keystream
+    memset1( keystream, 0, nbBlocks * 16 );
+    Provider->Ctr( key, aBlock, keystream, nbBlocks * 16, keystream );
 }
 
 void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer )
@@ -157,46 +554,44 @@ void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t
 
 void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic )
 {
-    AES_CMAC_Init( AesCmacCtx );
-
-    AES_CMAC_SetKey( AesCmacCtx, key );
-
-    AES_CMAC_Update( AesCmacCtx, buffer, size & 0xFF );
+    LoRaMacCryptoKeyHandle_t handle = LoRaMacCryptoGetKeyHandle( key );
+    uint8_t digest[16];
+    uint8_t k1[16];
+    uint8_t k2[16];
 
-    AES_CMAC_Final( Mic, AesCmacCtx );
+    if( handle != LORAMAC_CRYPTO_KEY_NONE )
+    {
+        ComputeCmac( key, KeyCache[handle].K1, KeyCache[handle].K2, NULL, buffer, size & 0xFF, digest );
+    }
+    else
+    {
+        ComputeSubKeys( key, k1, k2 );
+        ComputeCmac( key, k1, k2, NULL, buffer, size & 0xFF, digest );
+    }
 
-    *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+    *mic = ( uint32_t )( ( uint32_t )digest[3] << 24 | ( uint32_t )digest[2] << 16 | ( uint32_t )digest[1] << 8 | ( uint32_t )digest[0] );
 }
 
 void LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer )
 {
-    memset1( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
-    aes_encrypt( buffer, decBuffer, &AesContext );
     // Check if optional CFList is included
-    if( size >= 16 )
-    {
-        aes_encrypt( buffer + 16, decBuffer + 16, &AesContext );
-    }
+    Provider->Ecb( key, buffer, decBuffer, ( size >= 16 ) ? 2 : 1 );
 }
 
 void LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint16_t devNonce, uint8_t *nwkSKey, uint8_t *appSKey )
 {
     uint8_t nonce[16];
     uint8_t *pDevNonce = ( uint8_t * )&devNonce;
-    
-    memset1( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
 
     memset1( nonce, 0, sizeof( nonce ) );
     nonce[0] = 0x01;
     memcpy1( nonce + 1, appNonce, 6 );
     memcpy1( nonce + 7, pDevNonce, 2 );
-    aes_encrypt( nonce, nwkSKey, &AesContext );
+    Provider->Ecb( key, nonce, nwkSKey, 1 );
 
     memset1( nonce, 0, sizeof( nonce ) );
     nonce[0] = 0x02;
     memcpy1( nonce + 1, appNonce, 6 );
     memcpy1( nonce + 7, pDevNonce, 2 );
-    aes_encrypt( nonce, appSKey, &AesContext );
+    Provider->Ecb( key, nonce, appSKey, 1 );
 }
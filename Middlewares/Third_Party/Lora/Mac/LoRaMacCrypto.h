@@ -36,6 +36,158 @@
 #ifndef __LORAMAC_CRYPTO_H__
 #define __LORAMAC_CRYPTO_H__
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Number of key schedule slots reserved for multicast session keys
+ *
+ * \remark Each multicast channel uses two slots ( NwkSKey and AppSKey ).
+ *         Keys which do not fit are expanded on every use.
+ */
+#ifndef LORAMAC_CRYPTO_NB_MC_KEYS
+#define LORAMAC_CRYPTO_NB_MC_KEYS                   2
+#endif
+
+/*!
+ * Invalid key handle
+ */
+#define LORAMAC_CRYPTO_KEY_NONE                     0xFF
+
+/*!
+ * Key schedule cache slots
+ */
+typedef enum eLoRaMacCryptoKey
+{
+    /*!
+     * Application key, used by the join procedure
+     */
+    LORAMAC_CRYPTO_APP_KEY = 0,
+    /*!
+     * Network session key
+     */
+    LORAMAC_CRYPTO_NWK_S_KEY,
+    /*!
+     * Application session key
+     */
+    LORAMAC_CRYPTO_APP_S_KEY,
+    /*!
+     * First multicast session key slot
+     */
+    LORAMAC_CRYPTO_MC_KEY_FIRST,
+}LoRaMacCryptoKey_t;
+
+/*!
+ * Total number of key schedule cache slots
+ */
+#define LORAMAC_CRYPTO_NB_KEYS                      ( LORAMAC_CRYPTO_MC_KEY_FIRST + LORAMAC_CRYPTO_NB_MC_KEYS )
+
+/*!
+ * Handle on a key schedule cache slot
+ */
+typedef uint8_t LoRaMacCryptoKeyHandle_t;
+
+/*!
+ * AES-128 provider used by the LoRaMAC cryptographic primitives
+ *
+ * \remark The software provider is used by default. Another provider, e.g.
+ *         an AES hardware peripheral, is selected with LoRaMacCryptoInit.
+ *         Keys are 16 bytes long and all buffers may be unaligned.
+ */
+typedef struct sLoRaMacCryptoProvider
+{
+    /*!
+     * \brief Prepares the provider, may be NULL
+     *
+     * \retval status Returns false when the provider can't be used
+     */
+    bool ( *Init )( void );
+    /*!
+     * \brief AES-ECB encryption of nbBlocks 16 bytes blocks
+     *
+     * \param [IN]  key          AES key
+     * \param [IN]  in           Input blocks
+     * \param [OUT] out          Output blocks, may be equal to in
+     * \param [IN]  nbBlocks     Number of blocks
+     */
+    void ( *Ecb )( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks );
+    /*!
+     * \brief AES-CBC encryption keeping only the last cipher block
+     *
+     * \param [IN]  key          AES key
+     * \param [IN]  in           Input blocks
+     * \param [IN]  nbBlocks     Number of blocks
+     * \param [IN/OUT] chain     Initialization vector in, last cipher block out
+     */
+    void ( *CbcMac )( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain );
+    /*!
+     * \brief AES-CTR encryption, the counter is carried by the block last byte
+     *
+     * \param [IN]  key          AES key
+     * \param [IN]  counterBlock First counter block
+     * \param [IN]  in           Input buffer
+     * \param [IN]  size         Input buffer size
+     * \param [OUT] out          Output buffer, may be equal to in
+     */
+    void ( *Ctr )( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out );
+}LoRaMacCryptoProvider_t;
+
+/*!
+ * Software AES provider, based on Crypto/aes.c and the key schedule cache
+ */
+extern const LoRaMacCryptoProvider_t LoRaMacCryptoSoftProvider;
+
+/*!
+ * Selects the AES provider
+ *
+ * \remark Falls back to the software provider when provider is NULL or when
+ *         its Init function fails, e.g. because the peripheral is absent.
+ *
+ * \param [IN]  provider        - AES provider
+ */
+void LoRaMacCryptoInit( const LoRaMacCryptoProvider_t *provider );
+
+/*!
+ * Expands the key and stores its schedule in the given slot. Every crypto
+ * primitive called later with the same key reuses that schedule.
+ *
+ * \param [IN]  handle          - Key slot
+ * \param [IN]  key             - AES key to be expanded
+ */
+void LoRaMacCryptoSetKey( LoRaMacCryptoKeyHandle_t handle, const uint8_t *key );
+
+/*!
+ * Releases a key slot
+ *
+ * \param [IN]  handle          - Key slot
+ */
+void LoRaMacCryptoClearKey( LoRaMacCryptoKeyHandle_t handle );
+
+/*!
+ * Stores the key in the first free multicast key slot
+ *
+ * \param [IN]  key             - AES key to be expanded
+ *
+ * \retval handle Slot used, LORAMAC_CRYPTO_KEY_NONE when all slots are taken
+ */
+LoRaMacCryptoKeyHandle_t LoRaMacCryptoSetMulticastKey( const uint8_t *key );
+
+/*!
+ * Releases the multicast key slot holding the given key
+ *
+ * \param [IN]  key             - AES key
+ */
+void LoRaMacCryptoClearMulticastKey( const uint8_t *key );
+
+/*!
+ * Looks up the slot holding the given key
+ *
+ * \param [IN]  key             - AES key
+ *
+ * \retval handle Slot holding the key, LORAMAC_CRYPTO_KEY_NONE if not cached
+ */
+LoRaMacCryptoKeyHandle_t LoRaMacCryptoGetKeyHandle( const uint8_t *key );
+
 /*!
  * Computes the LoRaMAC frame MIC field
  *
@@ -49,6 +201,22 @@
  */
 void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic );
 
+/*!
+ * Computes the LoRaMAC frame MIC field with a cached key
+ *
+ * \remark Uses the CMAC subkeys precomputed by LoRaMacCryptoSetKey and
+ *         builds Block B0 on the stack.
+ *
+ * \param [IN]  handle          - Key slot holding the network session key
+ * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
+ * \param [IN]  address         - Frame address
+ * \param [IN]  sequenceCounter - Frame sequence counter
+ * \param [IN]  buffer          - Data buffer
+ * \param [IN]  size            - Data buffer size
+ * \param [OUT] mic             - Computed MIC field, 0 if the slot is empty
+ */
+void LoRaMacComputeMicFast( LoRaMacCryptoKeyHandle_t handle, uint8_t dir, uint32_t address, uint32_t sequenceCounter, const uint8_t *buffer, uint16_t size, uint32_t *mic );
+
 /*!
  * Computes the LoRaMAC payload encryption
  *
@@ -58,10 +226,27 @@ void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key
  * \param [IN]  address         - Frame address
  * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter - Frame sequence counter
- * \param [OUT] encBuffer       - Encrypted buffer
+ * \param [OUT] encBuffer       - Encrypted buffer, may be the same as buffer
+ *                                for in-place encryption
  */
 void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer );
 
+/*!
+ * Generates nbBlocks consecutive blocks of the LoRaMAC payload keystream
+ *
+ * \remark Block i of the payload is XORed with the keystream block
+ *         numbered i + 1, so firstBlock is 1 for the payload start.
+ *
+ * \param [IN]  key             - AES key to be used
+ * \param [IN]  address         - Frame address
+ * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
+ * \param [IN]  sequenceCounter - Frame sequence counter
+ * \param [IN]  firstBlock      - Counter of the first generated block
+ * \param [IN]  nbBlocks        - Number of 16 bytes blocks to generate
+ * \param [OUT] keystream       - Keystream buffer, nbBlocks * 16 bytes
+ */
+void LoRaMacPayloadKeystream( const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t firstBlock, uint8_t nbBlocks, uint8_t *keystream );
+
 /*!
  * Computes the LoRaMAC payload decryption
  *
@@ -71,7 +256,7 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
  * \param [IN]  address         - Frame address
  * \param [IN]  dir             - Frame direction [0: uplink, 1: downlink]
  * \param [IN]  sequenceCounter - Frame sequence counter
- * \param [OUT] decBuffer       - Decrypted buffer
+ * \param [OUT] decBuffer       - Decrypted buffer, may be the same as buffer
  */
 void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *decBuffer );
 
@@ -0,0 +1,553 @@
+/*!
+ * \file      LoRaMacCtx.h
+ *
+ * \brief     LoRa MAC layer instance context
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ *               ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ *              / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ *              \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ *              |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ *              embedded.connectivity.solutions===============
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    Daniel Jaeckle ( STACKFORCE )
+ *
+ * \defgroup  LORAMACCTX LoRa MAC layer instance context
+ *            State of one LoRaMAC instance. The MAC and region functions work
+ *            on the context selected by the API function in progress, several
+ *            contexts can share the radio and the timer server one after the
+ *            other.
+ * \{
+ */
+#ifndef __LORAMACCTX_H__
+#define __LORAMACCTX_H__
+
+#include "timeServer.h"
+#include "LoRaMac.h"
+#include "region/Region.h"
+#include "region/RegionCommon.h"
+#ifdef REGION_AS923
+#include "region/RegionAS923.h"
+#endif
+#ifdef REGION_AU915
+#include "region/RegionAU915.h"
+#endif
+#ifdef REGION_CN470
+#include "region/RegionCN470.h"
+#endif
+#ifdef REGION_CN779
+#include "region/RegionCN779.h"
+#endif
+#ifdef REGION_EU433
+#include "region/RegionEU433.h"
+#endif
+#ifdef REGION_EU868
+#include "region/RegionEU868.h"
+#endif
+#ifdef REGION_IN865
+#include "region/RegionIN865.h"
+#endif
+#ifdef REGION_KR920
+#include "region/RegionKR920.h"
+#endif
+#ifdef REGION_US915
+#include "region/RegionUS915.h"
+#endif
+#ifdef REGION_US915_HYBRID
+#include "region/RegionUS915-Hybrid.h"
+#endif
+
+/*!
+ * Maximum PHY layer payload size
+ */
+#define LORAMAC_PHY_MAXPAYLOAD                      255
+
+/*!
+ * Maximum MAC commands buffer size
+ */
+#define LORA_MAC_COMMAND_MAX_LENGTH                 128
+
+/*!
+ * Maximum length of the fOpts field
+ */
+#define LORA_MAC_COMMAND_MAX_FOPTS_LENGTH           15
+
+/*!
+ * Number of entries of the deferred event queue, must be a power of 2
+ */
+#define LORAMAC_EVENT_QUEUE_SIZE                    8
+
+/*!
+ * Number of received frames held by the deferred event queue, must be a power of 2
+ */
+#define LORAMAC_RX_FRAME_QUEUE_SIZE                 2
+
+/*!
+ * Number of datarates held by the RX window parameters cache
+ */
+#define LORAMAC_RX_WINDOW_CACHE_SIZE                16
+
+
+/*!
+ * Channels and bands state of the regions built in
+ */
+typedef union uRegionCtx
+{
+#ifdef REGION_AS923
+    /*!
+     * AS923 channels and bands
+     */
+    RegionAS923Ctx_t AS923;
+#endif
+#ifdef REGION_AU915
+    /*!
+     * AU915 channels and bands
+     */
+    RegionAU915Ctx_t AU915;
+#endif
+#ifdef REGION_CN470
+    /*!
+     * CN470 channels and bands
+     */
+    RegionCN470Ctx_t CN470;
+#endif
+#ifdef REGION_CN779
+    /*!
+     * CN779 channels and bands
+     */
+    RegionCN779Ctx_t CN779;
+#endif
+#ifdef REGION_EU433
+    /*!
+     * EU433 channels and bands
+     */
+    RegionEU433Ctx_t EU433;
+#endif
+#ifdef REGION_EU868
+    /*!
+     * EU868 channels and bands
+     */
+    RegionEU868Ctx_t EU868;
+#endif
+#ifdef REGION_IN865
+    /*!
+     * IN865 channels and bands
+     */
+    RegionIN865Ctx_t IN865;
+#endif
+#ifdef REGION_KR920
+    /*!
+     * KR920 channels and bands
+     */
+    RegionKR920Ctx_t KR920;
+#endif
+#ifdef REGION_US915
+    /*!
+     * US915 channels and bands
+     */
+    RegionUS915Ctx_t US915;
+#endif
+#ifdef REGION_US915_HYBRID
+    /*!
+     * US915-HYBRID channels and bands
+     */
+    RegionUS915HybridCtx_t US915Hybrid;
+#endif
+    /*!
+     * Keeps the union defined when no region is built in
+     */
+    uint8_t None;
+}RegionCtx_t;
+
+/*!
+ * Events raised from interrupt context and processed by LoRaMacProcess
+ */
+typedef enum eLoRaMacEvent
+{
+    LORAMAC_EVENT_RADIO_TX_DONE,
+    LORAMAC_EVENT_RADIO_RX_DONE,
+    LORAMAC_EVENT_RADIO_RX_ERROR,
+    LORAMAC_EVENT_RADIO_TX_TIMEOUT,
+    LORAMAC_EVENT_RADIO_RX_TIMEOUT,
+    LORAMAC_EVENT_MAC_STATE_CHECK,
+    LORAMAC_EVENT_TX_DELAYED,
+    LORAMAC_EVENT_ACK_TIMEOUT,
+}LoRaMacEvent_t;
+
+/*!
+ * Entry of the deferred event queue
+ */
+typedef struct sLoRaMacEventEntry
+{
+    /*!
+     * Event
+     */
+    LoRaMacEvent_t Event;
+    /*!
+     * Time the event was raised
+     */
+    TimerTime_t Time;
+    /*!
+     * Rssi of the received frame
+     */
+    int16_t Rssi;
+    /*!
+     * Snr of the received frame
+     */
+    int8_t Snr;
+    /*!
+     * Size of the received frame
+     */
+    uint16_t Size;
+}LoRaMacEventEntry_t;
+
+/*!
+ * RX window parameters of one datarate, as computed by
+ * RegionComputeRxWindowParameters
+ */
+typedef struct sRxWindowParams
+{
+    /*!
+     * RX datarate, after the boundary check of the region
+     */
+    int8_t Datarate;
+    /*!
+     * RX bandwidth
+     */
+    uint8_t Bandwidth;
+    /*!
+     * RX window timeout
+     */
+    uint32_t WindowTimeout;
+    /*!
+     * RX window offset
+     */
+    int32_t WindowOffset;
+}RxWindowParams_t;
+
+/*!
+ * LoRaMac instance context
+ */
+struct sLoRaMacCtx
+{
+    /*!
+     * LoRaMac region.
+     */
+    LoRaMacRegion_t LoRaMacRegion;
+    /*!
+     * Device IEEE EUI
+     */
+    uint8_t *LoRaMacDevEui;
+    /*!
+     * Application IEEE EUI
+     */
+    uint8_t *LoRaMacAppEui;
+    /*!
+     * AES encryption/decryption cipher application key
+     */
+    uint8_t *LoRaMacAppKey;
+    /*!
+     * AES encryption/decryption cipher network session key
+     */
+    uint8_t LoRaMacNwkSKey[16];
+    /*!
+     * AES encryption/decryption cipher application session key
+     */
+    uint8_t LoRaMacAppSKey[16];
+    /*!
+     * Device nonce is a random value extracted by issuing a sequence of RSSI
+     * measurements
+     */
+    uint16_t LoRaMacDevNonce;
+    /*!
+     * Network ID ( 3 bytes )
+     */
+    uint32_t LoRaMacNetID;
+    /*!
+     * Mote Address
+     */
+    uint32_t LoRaMacDevAddr;
+    /*!
+     * Multicast channels linked list
+     */
+    MulticastParams_t *MulticastChannels;
+    /*!
+     * Actual device class
+     */
+    DeviceClass_t LoRaMacDeviceClass;
+    /*!
+     * Indicates if the node is connected to a private or public network
+     */
+    bool PublicNetwork;
+    /*!
+     * Indicates if the node supports repeaters
+     */
+    bool RepeaterSupport;
+    /*!
+     * Buffer containing the data to be sent or received.
+     */
+    uint8_t LoRaMacBuffer[LORAMAC_PHY_MAXPAYLOAD];
+    /*!
+     * Length of packet in LoRaMacBuffer
+     */
+    uint16_t LoRaMacBufferPktLen;
+    /*!
+     * Length of the payload in LoRaMacBuffer
+     */
+    uint8_t LoRaMacTxPayloadLen;
+    /*!
+     * Buffer containing the upper layer data.
+     */
+    uint8_t LoRaMacRxPayload[LORAMAC_PHY_MAXPAYLOAD];
+    /*!
+     * LoRaMAC frame counter. Each time a packet is sent the counter is incremented.
+     * Only the 16 LSB bits are sent
+     */
+    uint32_t UpLinkCounter;
+    /*!
+     * LoRaMAC frame counter. Each time a packet is received the counter is incremented.
+     * Only the 16 LSB bits are received
+     */
+    uint32_t DownLinkCounter;
+    /*!
+     * IsPacketCounterFixed enables the MIC field tests by fixing the
+     * UpLinkCounter value
+     */
+    bool IsUpLinkCounterFixed;
+    /*!
+     * Used for test purposes. Disables the opening of the reception windows.
+     */
+    bool IsRxWindowsEnabled;
+    /*!
+     * Indicates if the MAC layer has already joined a network.
+     */
+    bool IsLoRaMacNetworkJoined;
+    /*!
+     * LoRaMac ADR control status
+     */
+    bool AdrCtrlOn;
+    /*!
+     * Counts the number of missed ADR acknowledgements
+     */
+    uint32_t AdrAckCounter;
+    /*!
+     * If the node has sent a FRAME_TYPE_DATA_CONFIRMED_UP this variable indicates
+     * if the nodes needs to manage the server acknowledgement.
+     */
+    bool NodeAckRequested;
+    /*!
+     * If the server has sent a FRAME_TYPE_DATA_CONFIRMED_DOWN this variable indicates
+     * if the ACK bit must be set for the next transmission
+     */
+    bool SrvAckRequested;
+    /*!
+     * Indicates if the MAC layer wants to send MAC commands
+     */
+    bool MacCommandsInNextTx;
+    /*!
+     * Contains the current MacCommandsBuffer index
+     */
+    uint8_t MacCommandsBufferIndex;
+    /*!
+     * Contains the current MacCommandsBuffer index for MAC commands to repeat
+     */
+    uint8_t MacCommandsBufferToRepeatIndex;
+    /*!
+     * Buffer containing the MAC layer commands
+     */
+    uint8_t MacCommandsBuffer[LORA_MAC_COMMAND_MAX_LENGTH];
+    /*!
+     * Buffer containing the MAC layer commands which must be repeated
+     */
+    uint8_t MacCommandsBufferToRepeat[LORA_MAC_COMMAND_MAX_LENGTH];
+    /*!
+     * LoRaMac parameters
+     */
+    LoRaMacParams_t LoRaMacParams;
+    /*!
+     * LoRaMac default parameters
+     */
+    LoRaMacParams_t LoRaMacParamsDefaults;
+    /*!
+     * Uplink messages repetitions counter
+     */
+    uint8_t ChannelsNbRepCounter;
+    /*!
+     * Maximum duty cycle
+     * \remark Possibility to shutdown the device.
+     */
+    uint8_t MaxDCycle;
+    /*!
+     * Aggregated duty cycle management
+     */
+    uint16_t AggregatedDCycle;
+    TimerTime_t AggregatedLastTxDoneTime;
+    TimerTime_t AggregatedTimeOff;
+    /*!
+     * Enables/Disables duty cycle management (Test only)
+     */
+    bool DutyCycleOn;
+    /*!
+     * Current channel index
+     */
+    uint8_t Channel;
+    /*!
+     * Current channel index
+     */
+    uint8_t LastTxChannel;
+    /*!
+     * Set to true, if the last uplink was a join request
+     */
+    bool LastTxIsJoinRequest;
+    /*!
+     * Stores the time at LoRaMac initialization.
+     *
+     * \remark Used for the BACKOFF_DC computation.
+     */
+    TimerTime_t LoRaMacInitializationTime;
+    /*!
+     * LoRaMac internal state
+     */
+    uint32_t LoRaMacState;
+    /*!
+     * LoRaMac timer used to check the LoRaMacState (runs every second)
+     */
+    TimerEvent_t MacStateCheckTimer;
+    /*!
+     * LoRaMac upper layer event functions
+     */
+    LoRaMacPrimitives_t *LoRaMacPrimitives;
+    /*!
+     * LoRaMac upper layer callback functions
+     */
+    LoRaMacCallback_t *LoRaMacCallbacks;
+    /*!
+     * LoRaMac duty cycle delayed Tx timer
+     */
+    TimerEvent_t TxDelayedTimer;
+    /*!
+     * LoRaMac reception windows timers
+     */
+    TimerEvent_t RxWindowTimer1;
+    TimerEvent_t RxWindowTimer2;
+    /*!
+     * LoRaMac reception windows delay
+     * \remark normal frame: RxWindowXDelay = ReceiveDelayX - RADIO_WAKEUP_TIME
+     *         join frame  : RxWindowXDelay = JoinAcceptDelayX - RADIO_WAKEUP_TIME
+     */
+    uint32_t RxWindow1Delay;
+    uint32_t RxWindow2Delay;
+    /*!
+     * LoRaMac Rx windows configuration
+     */
+    RxConfigParams_t RxWindow1Config;
+    RxConfigParams_t RxWindow2Config;
+    /*!
+     * RX window parameters of each datarate, for the current MinRxSymbols
+     * and SystemMaxRxError
+     */
+    RxWindowParams_t RxWindowParams[LORAMAC_RX_WINDOW_CACHE_SIZE];
+    /*!
+     * Datarates of RxWindowParams which are up to date, one bit per datarate
+     */
+    uint16_t RxWindowParamsValid;
+    /*!
+     * Acknowledge timeout timer. Used for packet retransmissions.
+     */
+    TimerEvent_t AckTimeoutTimer;
+    /*!
+     * Number of trials to get a frame acknowledged
+     */
+    uint8_t AckTimeoutRetries;
+    /*!
+     * Number of trials to get a frame acknowledged
+     */
+    uint8_t AckTimeoutRetriesCounter;
+    /*!
+     * Indicates if the AckTimeout timer has expired or not
+     */
+    bool AckTimeoutRetry;
+    /*!
+     * Last transmission time on air
+     */
+    TimerTime_t TxTimeOnAir;
+    /*!
+     * Number of trials for the Join Request
+     */
+    uint8_t JoinRequestTrials;
+    /*!
+     * Maximum number of trials for the Join Request
+     */
+    uint8_t MaxJoinRequestTrials;
+    /*!
+     * Structure to hold an MCPS indication data.
+     */
+    McpsIndication_t McpsIndication;
+    /*!
+     * Structure to hold MCPS confirm data.
+     */
+    McpsConfirm_t McpsConfirm;
+    /*!
+     * Structure to hold MLME confirm data.
+     */
+    MlmeConfirm_t MlmeConfirm;
+    /*!
+     * Holds the current rx window slot
+     */
+    uint8_t RxSlot;
+    /*!
+     * LoRaMac tx/rx operation state
+     */
+    LoRaMacFlags_t LoRaMacFlags;
+    /*!
+     * Deferred event queue. The radio and the MAC timers raise their events from
+     * interrupts of the same priority (DIO EXTI and RTC alarm), which never preempt
+     * each other: they form a single producer and LoRaMacProcess the single consumer.
+     */
+    LoRaMacEventEntry_t EventQueue[LORAMAC_EVENT_QUEUE_SIZE];
+    /*!
+     * Event queue write index, only written by the producer
+     */
+    volatile uint8_t EventQueueHead;
+    /*!
+     * Event queue read index, only written by the consumer
+     */
+    volatile uint8_t EventQueueTail;
+    /*!
+     * Copies of the radio buffer of the received frames, taken in the same order
+     * as the LORAMAC_EVENT_RADIO_RX_DONE events
+     */
+    uint8_t RxFrameQueue[LORAMAC_RX_FRAME_QUEUE_SIZE][LORAMAC_PHY_MAXPAYLOAD];
+    /*!
+     * Received frames write index, only written by the producer
+     */
+    volatile uint8_t RxFrameHead;
+    /*!
+     * Received frames read index, only written by the consumer
+     */
+    volatile uint8_t RxFrameTail;
+    /*!
+     * Channels and bands of the region
+     */
+    RegionCtx_t Region;
+};
+
+/*! \} defgroup LORAMACCTX */
+
+#endif // __LORAMACCTX_H__
@@ -28,6 +28,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 
 // Regional includes
 #include "Region.h"
+#include "RegionCommon.h"
 
 
 
@@ -39,6 +40,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define AS923_GET_PHY_PARAM( )                     AS923_CASE { return RegionAS923GetPhyParam( getPhy ); }
 #define AS923_SET_BAND_TX_DONE( )                  AS923_CASE { RegionAS923SetBandTxDone( txDone ); break; }
 #define AS923_INIT_DEFAULTS( )                     AS923_CASE { RegionAS923InitDefaults( type ); break; }
+#define AS923_SET_CTX( )                           AS923_CASE { RegionAS923SetCtx( ctx ); break; }
 #define AS923_VERIFY( )                            AS923_CASE { return RegionAS923Verify( verify, phyAttribute ); }
 #define AS923_APPLY_CF_LIST( )                     AS923_CASE { RegionAS923ApplyCFList( applyCFList ); break; }
 #define AS923_CHAN_MASK_SET( )                     AS923_CASE { return RegionAS923ChanMaskSet( chanMaskSet ); }
@@ -63,6 +65,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define AS923_GET_PHY_PARAM( )
 #define AS923_SET_BAND_TX_DONE( )
 #define AS923_INIT_DEFAULTS( )
+#define AS923_SET_CTX( )
 #define AS923_VERIFY( )
 #define AS923_APPLY_CF_LIST( )
 #define AS923_CHAN_MASK_SET( )
@@ -91,6 +94,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define AU915_GET_PHY_PARAM( )                     AU915_CASE { return RegionAU915GetPhyParam( getPhy ); }
 #define AU915_SET_BAND_TX_DONE( )                  AU915_CASE { RegionAU915SetBandTxDone( txDone ); break; }
 #define AU915_INIT_DEFAULTS( )                     AU915_CASE { RegionAU915InitDefaults( type ); break; }
+#define AU915_SET_CTX( )                           AU915_CASE { RegionAU915SetCtx( ctx ); break; }
 #define AU915_VERIFY( )                            AU915_CASE { return RegionAU915Verify( verify, phyAttribute ); }
 #define AU915_APPLY_CF_LIST( )                     AU915_CASE { RegionAU915ApplyCFList( applyCFList ); break; }
 #define AU915_CHAN_MASK_SET( )                     AU915_CASE { return RegionAU915ChanMaskSet( chanMaskSet ); }
@@ -115,6 +119,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define AU915_GET_PHY_PARAM( )
 #define AU915_SET_BAND_TX_DONE( )
 #define AU915_INIT_DEFAULTS( )
+#define AU915_SET_CTX( )
 #define AU915_VERIFY( )
 #define AU915_APPLY_CF_LIST( )
 #define AU915_CHAN_MASK_SET( )
@@ -143,6 +148,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define CN470_GET_PHY_PARAM( )                     CN470_CASE { return RegionCN470GetPhyParam( getPhy ); }
 #define CN470_SET_BAND_TX_DONE( )                  CN470_CASE { RegionCN470SetBandTxDone( txDone ); break; }
 #define CN470_INIT_DEFAULTS( )                     CN470_CASE { RegionCN470InitDefaults( type ); break; }
+#define CN470_SET_CTX( )                           CN470_CASE { RegionCN470SetCtx( ctx ); break; }
 #define CN470_VERIFY( )                            CN470_CASE { return RegionCN470Verify( verify, phyAttribute ); }
 #define CN470_APPLY_CF_LIST( )                     CN470_CASE { RegionCN470ApplyCFList( applyCFList ); break; }
 #define CN470_CHAN_MASK_SET( )                     CN470_CASE { return RegionCN470ChanMaskSet( chanMaskSet ); }
@@ -167,6 +173,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define CN470_GET_PHY_PARAM( )
 #define CN470_SET_BAND_TX_DONE( )
 #define CN470_INIT_DEFAULTS( )
+#define CN470_SET_CTX( )
 #define CN470_VERIFY( )
 #define CN470_APPLY_CF_LIST( )
 #define CN470_CHAN_MASK_SET( )
@@ -195,6 +202,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define CN779_GET_PHY_PARAM( )                     CN779_CASE { return RegionCN779GetPhyParam( getPhy ); }
 #define CN779_SET_BAND_TX_DONE( )                  CN779_CASE { RegionCN779SetBandTxDone( txDone ); break; }
 #define CN779_INIT_DEFAULTS( )                     CN779_CASE { RegionCN779InitDefaults( type ); break; }
+#define CN779_SET_CTX( )                           CN779_CASE { RegionCN779SetCtx( ctx ); break; }
 #define CN779_VERIFY( )                            CN779_CASE { return RegionCN779Verify( verify, phyAttribute ); }
 #define CN779_APPLY_CF_LIST( )                     CN779_CASE { RegionCN779ApplyCFList( applyCFList ); break; }
 #define CN779_CHAN_MASK_SET( )                     CN779_CASE { return RegionCN779ChanMaskSet( chanMaskSet ); }
@@ -219,6 +227,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define CN779_GET_PHY_PARAM( )
 #define CN779_SET_BAND_TX_DONE( )
 #define CN779_INIT_DEFAULTS( )
+#define CN779_SET_CTX( )
 #define CN779_VERIFY( )
 #define CN779_APPLY_CF_LIST( )
 #define CN779_CHAN_MASK_SET( )
@@ -247,6 +256,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define EU433_GET_PHY_PARAM( )                     EU433_CASE { return RegionEU433GetPhyParam( getPhy ); }
 #define EU433_SET_BAND_TX_DONE( )                  EU433_CASE { RegionEU433SetBandTxDone( txDone ); break; }
 #define EU433_INIT_DEFAULTS( )                     EU433_CASE { RegionEU433InitDefaults( type ); break; }
+#define EU433_SET_CTX( )                           EU433_CASE { RegionEU433SetCtx( ctx ); break; }
 #define EU433_VERIFY( )                            EU433_CASE { return RegionEU433Verify( verify, phyAttribute ); }
 #define EU433_APPLY_CF_LIST( )                     EU433_CASE { RegionEU433ApplyCFList( applyCFList ); break; }
 #define EU433_CHAN_MASK_SET( )                     EU433_CASE { return RegionEU433ChanMaskSet( chanMaskSet ); }
@@ -271,6 +281,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define EU433_GET_PHY_PARAM( )
 #define EU433_SET_BAND_TX_DONE( )
 #define EU433_INIT_DEFAULTS( )
+#define EU433_SET_CTX( )
 #define EU433_VERIFY( )
 #define EU433_APPLY_CF_LIST( )
 #define EU433_CHAN_MASK_SET( )
@@ -299,6 +310,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define EU868_GET_PHY_PARAM( )                     EU868_CASE { return RegionEU868GetPhyParam( getPhy ); }
 #define EU868_SET_BAND_TX_DONE( )                  EU868_CASE { RegionEU868SetBandTxDone( txDone ); break; }
 #define EU868_INIT_DEFAULTS( )                     EU868_CASE { RegionEU868InitDefaults( type ); break; }
+#define EU868_SET_CTX( )                           EU868_CASE { RegionEU868SetCtx( ctx ); break; }
 #define EU868_VERIFY( )                            EU868_CASE { return RegionEU868Verify( verify, phyAttribute ); }
 #define EU868_APPLY_CF_LIST( )                     EU868_CASE { RegionEU868ApplyCFList( applyCFList ); break; }
 #define EU868_CHAN_MASK_SET( )                     EU868_CASE { return RegionEU868ChanMaskSet( chanMaskSet ); }
@@ -323,6 +335,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define EU868_GET_PHY_PARAM( )
 #define EU868_SET_BAND_TX_DONE( )
 #define EU868_INIT_DEFAULTS( )
+#define EU868_SET_CTX( )
 #define EU868_VERIFY( )
 #define EU868_APPLY_CF_LIST( )
 #define EU868_CHAN_MASK_SET( )
@@ -351,6 +364,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define KR920_GET_PHY_PARAM( )                     KR920_CASE { return RegionKR920GetPhyParam( getPhy ); }
 #define KR920_SET_BAND_TX_DONE( )                  KR920_CASE { RegionKR920SetBandTxDone( txDone ); break; }
 #define KR920_INIT_DEFAULTS( )                     KR920_CASE { RegionKR920InitDefaults( type ); break; }
+#define KR920_SET_CTX( )                           KR920_CASE { RegionKR920SetCtx( ctx ); break; }
 #define KR920_VERIFY( )                            KR920_CASE { return RegionKR920Verify( verify, phyAttribute ); }
 #define KR920_APPLY_CF_LIST( )                     KR920_CASE { RegionKR920ApplyCFList( applyCFList ); break; }
 #define KR920_CHAN_MASK_SET( )                     KR920_CASE { return RegionKR920ChanMaskSet( chanMaskSet ); }
@@ -375,6 +389,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define KR920_GET_PHY_PARAM( )
 #define KR920_SET_BAND_TX_DONE( )
 #define KR920_INIT_DEFAULTS( )
+#define KR920_SET_CTX( )
 #define KR920_VERIFY( )
 #define KR920_APPLY_CF_LIST( )
 #define KR920_CHAN_MASK_SET( )
@@ -403,6 +418,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define IN865_GET_PHY_PARAM( )                     IN865_CASE { return RegionIN865GetPhyParam( getPhy ); }
 #define IN865_SET_BAND_TX_DONE( )                  IN865_CASE { RegionIN865SetBandTxDone( txDone ); break; }
 #define IN865_INIT_DEFAULTS( )                     IN865_CASE { RegionIN865InitDefaults( type ); break; }
+#define IN865_SET_CTX( )                           IN865_CASE { RegionIN865SetCtx( ctx ); break; }
 #define IN865_VERIFY( )                            IN865_CASE { return RegionIN865Verify( verify, phyAttribute ); }
 #define IN865_APPLY_CF_LIST( )                     IN865_CASE { RegionIN865ApplyCFList( applyCFList ); break; }
 #define IN865_CHAN_MASK_SET( )                     IN865_CASE { return RegionIN865ChanMaskSet( chanMaskSet ); }
@@ -427,6 +443,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define IN865_GET_PHY_PARAM( )
 #define IN865_SET_BAND_TX_DONE( )
 #define IN865_INIT_DEFAULTS( )
+#define IN865_SET_CTX( )
 #define IN865_VERIFY( )
 #define IN865_APPLY_CF_LIST( )
 #define IN865_CHAN_MASK_SET( )
@@ -455,6 +472,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define US915_GET_PHY_PARAM( )                     US915_CASE { return RegionUS915GetPhyParam( getPhy ); }
 #define US915_SET_BAND_TX_DONE( )                  US915_CASE { RegionUS915SetBandTxDone( txDone ); break; }
 #define US915_INIT_DEFAULTS( )                     US915_CASE { RegionUS915InitDefaults( type ); break; }
+#define US915_SET_CTX( )                           US915_CASE { RegionUS915SetCtx( ctx ); break; }
 #define US915_VERIFY( )                            US915_CASE { return RegionUS915Verify( verify, phyAttribute ); }
 #define US915_APPLY_CF_LIST( )                     US915_CASE { RegionUS915ApplyCFList( applyCFList ); break; }
 #define US915_CHAN_MASK_SET( )                     US915_CASE { return RegionUS915ChanMaskSet( chanMaskSet ); }
@@ -479,6 +497,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define US915_GET_PHY_PARAM( )
 #define US915_SET_BAND_TX_DONE( )
 #define US915_INIT_DEFAULTS( )
+#define US915_SET_CTX( )
 #define US915_VERIFY( )
 #define US915_APPLY_CF_LIST( )
 #define US915_CHAN_MASK_SET( )
@@ -507,6 +526,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define US915_HYBRID_GET_PHY_PARAM( )                     US915_HYBRID_CASE { return RegionUS915HybridGetPhyParam( getPhy ); }
 #define US915_HYBRID_SET_BAND_TX_DONE( )                  US915_HYBRID_CASE { RegionUS915HybridSetBandTxDone( txDone ); break; }
 #define US915_HYBRID_INIT_DEFAULTS( )                     US915_HYBRID_CASE { RegionUS915HybridInitDefaults( type ); break; }
+#define US915_HYBRID_SET_CTX( )                           US915_HYBRID_CASE { RegionUS915HybridSetCtx( ctx ); break; }
 #define US915_HYBRID_VERIFY( )                            US915_HYBRID_CASE { return RegionUS915HybridVerify( verify, phyAttribute ); }
 #define US915_HYBRID_APPLY_CF_LIST( )                     US915_HYBRID_CASE { RegionUS915HybridApplyCFList( applyCFList ); break; }
 #define US915_HYBRID_CHAN_MASK_SET( )                     US915_HYBRID_CASE { return RegionUS915HybridChanMaskSet( chanMaskSet ); }
@@ -531,6 +551,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #define US915_HYBRID_GET_PHY_PARAM( )
 #define US915_HYBRID_SET_BAND_TX_DONE( )
 #define US915_HYBRID_INIT_DEFAULTS( )
+#define US915_HYBRID_SET_CTX( )
 #define US915_HYBRID_VERIFY( )
 #define US915_HYBRID_APPLY_CF_LIST( )
 #define US915_HYBRID_CHAN_MASK_SET( )
@@ -637,6 +658,27 @@ void RegionInitDefaults( LoRaMacRegion_t region, InitType_t type )
     }
 }
 
+void RegionSetCtx( LoRaMacRegion_t region, void* ctx )
+{
+    switch( region )
+    {
+        AS923_SET_CTX( );
+        AU915_SET_CTX( );
+        CN470_SET_CTX( );
+        CN779_SET_CTX( );
+        EU433_SET_CTX( );
+        EU868_SET_CTX( );
+        KR920_SET_CTX( );
+        IN865_SET_CTX( );
+        US915_SET_CTX( );
+        US915_HYBRID_SET_CTX( );
+        default:
+        {
+            break;
+        }
+    }
+}
+
 bool RegionVerify( LoRaMacRegion_t region, VerifyParams_t* verify, PhyAttribute_t phyAttribute )
 {
     switch( region )
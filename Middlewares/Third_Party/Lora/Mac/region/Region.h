@@ -1208,6 +1208,19 @@ void RegionSetBandTxDone( LoRaMacRegion_t region, SetBandTxDoneParams_t* txDone
  */
 void RegionInitDefaults( LoRaMacRegion_t region, InitType_t type );
 
+/*!
+ * \brief Selects the context the functions of the region work on. The
+ *        context holds the channels, the bands and the masks of one MAC
+ *        instance, the following region calls use it until the next
+ *        selection.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \param [IN] ctx Pointer to the context of the region, for instance a
+ *                 RegionEU868Ctx_t for LORAMAC_REGION_EU868.
+ */
+void RegionSetCtx( LoRaMacRegion_t region, void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
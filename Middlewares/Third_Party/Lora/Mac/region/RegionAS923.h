@@ -205,6 +205,11 @@
  */
 #define AS923_MAX_NB_BANDS                          1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define AS923_CHANNELS_MASK_SIZE                    1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -278,6 +283,42 @@ static const uint8_t MaxPayloadOfDatarateDwell1DownAS923[] = { 0, 0, 11, 53, 126
  */
 static const int8_t EffectiveRx1DrOffsetAS923[] = { 0, 1, 2, 3, 4, 5, -1, -2 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionAS923Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[AS923_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[AS923_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[AS923_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[AS923_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[AS923_TX_MAX_DATARATE + 1][AS923_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[AS923_MAX_NB_BANDS][AS923_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionAS923Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -301,6 +342,13 @@ void RegionAS923SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionAS923InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionAS923Ctx_t.
+ */
+void RegionAS923SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
@@ -175,6 +175,11 @@
  */
 #define AU915_MAX_NB_BANDS                           1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define AU915_CHANNELS_MASK_SIZE                     6
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -230,6 +235,46 @@ static const uint8_t MaxPayloadOfDatarateAU915[] = { 51, 51, 51, 115, 242, 242,
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterAU915[] = { 51, 51, 51, 115, 222, 222, 222, 0, 33, 109, 222, 222, 222, 222, 0, 0 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionAU915Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[AU915_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[AU915_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[AU915_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels remaining
+     */
+    uint16_t ChannelsMaskRemaining[AU915_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[AU915_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[AU915_TX_MAX_DATARATE + 1][AU915_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[AU915_MAX_NB_BANDS][AU915_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionAU915Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -253,6 +298,13 @@ void RegionAU915SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionAU915InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionAU915Ctx_t.
+ */
+void RegionAU915SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
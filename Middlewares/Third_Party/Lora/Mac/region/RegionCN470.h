@@ -175,6 +175,11 @@
  */
 #define CN470_MAX_NB_BANDS                           1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define CN470_CHANNELS_MASK_SIZE                     6
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -216,6 +221,42 @@ static const uint8_t MaxPayloadOfDatarateCN470[] = { 51, 51, 51, 115, 222, 222 }
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterCN470[] = { 51, 51, 51, 115, 222, 222 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionCN470Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[CN470_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[CN470_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[CN470_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[CN470_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[CN470_TX_MAX_DATARATE + 1][CN470_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[CN470_MAX_NB_BANDS][CN470_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionCN470Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -239,6 +280,13 @@ void RegionCN470SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionCN470InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionCN470Ctx_t.
+ */
+void RegionCN470SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
@@ -192,6 +192,11 @@
  */
 #define CN779_MAX_NB_BANDS                           1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define CN779_CHANNELS_MASK_SIZE                     1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -240,6 +245,42 @@ static const uint8_t MaxPayloadOfDatarateCN779[] = { 51, 51, 51, 115, 242, 242,
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterCN779[] = { 51, 51, 51, 115, 222, 222, 222, 222 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionCN779Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[CN779_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[CN779_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[CN779_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[CN779_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[CN779_TX_MAX_DATARATE + 1][CN779_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[CN779_MAX_NB_BANDS][CN779_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionCN779Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -263,6 +304,13 @@ void RegionCN779SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionCN779InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionCN779Ctx_t.
+ */
+void RegionCN779SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
@@ -38,16 +38,17 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 
 static uint8_t CountChannels( uint16_t mask, uint8_t nbBits )
 {
-    uint8_t nbActiveBits = 0;
+    uint32_t bits = mask;
 
-    for( uint8_t j = 0; j < nbBits; j++ )
+    if( nbBits < 16 )
     {
-        if( ( mask & ( 1 << j ) ) == ( 1 << j ) )
-        {
-            nbActiveBits++;
-        }
+        bits &= ( 1 << nbBits ) - 1;
     }
-    return nbActiveBits;
+    // Parallel bit count
+    bits = bits - ( ( bits >> 1 ) & 0x5555 );
+    bits = ( bits & 0x3333 ) + ( ( bits >> 2 ) & 0x3333 );
+    bits = ( bits + ( bits >> 4 ) ) & 0x0F0F;
+    return ( uint8_t )( ( bits + ( bits >> 8 ) ) & 0x1F );
 }
 
 
@@ -293,20 +294,34 @@ uint8_t RegionCommonLinkAdrReqVerifyParams( RegionCommonLinkAdrReqVerifyParams_t
     return status;
 }
 
-double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth )
+uint32_t RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth )
+{
+    return ( ( uint32_t )1000000 << phyDr ) / bandwidth; // in us
+}
+
+uint32_t RegionCommonComputeSymbolTimeFsk( uint8_t phyDr )
 {
-    return ( ( double )( 1 << phyDr ) / ( double )bandwidth ) * 1000;
+    return 8000 / ( uint32_t )phyDr; // 1 symbol equals 1 byte, in us
 }
 
-double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr )
+static int32_t CeilDiv( int32_t num, int32_t den )
 {
-    return ( 8.0 / ( double )phyDr ); // 1 symbol equals 1 byte
+    if( num > 0 )
+    {
+        return ( num + den - 1 ) / den;
+    }
+    return -( -num / den );
 }
 
-void RegionCommonComputeRxWindowParameters( double tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset )
+void RegionCommonComputeRxWindowParameters( uint32_t tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset )
 {
-    *windowTimeout = MAX( ( uint32_t )ceil( ( ( 2 * minRxSymbols - 8 ) * tSymbol + 2 * rxError ) / tSymbol ), minRxSymbols ); // Computed number of symbols
-    *windowOffset = ( int32_t )ceil( ( 4.0 * tSymbol ) - ( ( *windowTimeout * tSymbol ) / 2.0 ) - wakeUpTime );
+    // ceil( ( ( 2 * minRxSymbols - 8 ) * tSymbol + 2 * rxError ) / tSymbol ) with tSymbol in us and rxError in ms
+    int32_t timeoutUs = ( 2 * minRxSymbols - 8 ) * ( int32_t )tSymbol + 2000 * ( int32_t )rxError;
+    uint32_t timeout = ( timeoutUs > 0 ) ? ( uint32_t )CeilDiv( timeoutUs, ( int32_t )tSymbol ) : 0;
+
+    *windowTimeout = MAX( timeout, minRxSymbols ); // Computed number of symbols
+    // ceil( ( 4 * tSymbol ) - ( ( *windowTimeout * tSymbol ) / 2 ) - wakeUpTime ) in ms
+    *windowOffset = CeilDiv( ( 8 - ( int32_t )*windowTimeout ) * ( int32_t )tSymbol - 2000 * ( int32_t )wakeUpTime, 2000 );
 }
 
 int8_t RegionCommonComputeTxPower( int8_t txPowerIndex, float maxEirp, float antennaGain )
@@ -360,3 +375,112 @@ void RegionCommonCalcBackOff( RegionCommonCalcBackOffParams_t* calcBackOffParams
         }
     }
 }
+
+void RegionCommonChanBitmapsInit( RegionCommonChanBitmaps_t* bitmaps, ChannelParams_t* channels, uint8_t nbChannels )
+{
+    memset1( ( uint8_t* )bitmaps->DrMasks, 0, bitmaps->NbDatarates * bitmaps->NbMaskWords * sizeof( uint16_t ) );
+    memset1( ( uint8_t* )bitmaps->BandMasks, 0, bitmaps->NbBands * bitmaps->NbMaskWords * sizeof( uint16_t ) );
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        RegionCommonChanBitmapsUpdate( bitmaps, channels, i );
+    }
+}
+
+void RegionCommonChanBitmapsUpdate( RegionCommonChanBitmaps_t* bitmaps, ChannelParams_t* channels, uint8_t id )
+{
+    uint8_t index = id / 16;
+    uint16_t bit = 1 << ( id % 16 );
+
+    // Clear the channel from all the masks
+    for( uint8_t i = 0; i < bitmaps->NbDatarates; i++ )
+    {
+        bitmaps->DrMasks[i * bitmaps->NbMaskWords + index] &= ~bit;
+    }
+    for( uint8_t i = 0; i < bitmaps->NbBands; i++ )
+    {
+        bitmaps->BandMasks[i * bitmaps->NbMaskWords + index] &= ~bit;
+    }
+
+    if( channels[id].Frequency == 0 )
+    { // The channel is not defined
+        return;
+    }
+    for( uint8_t i = channels[id].DrRange.Fields.Min; ( i <= channels[id].DrRange.Fields.Max ) && ( i < bitmaps->NbDatarates ); i++ )
+    {
+        bitmaps->DrMasks[i * bitmaps->NbMaskWords + index] |= bit;
+    }
+    if( channels[id].Band < bitmaps->NbBands )
+    {
+        bitmaps->BandMasks[channels[id].Band * bitmaps->NbMaskWords + index] |= bit;
+    }
+}
+
+uint8_t RegionCommonChanBitmapsCount( RegionCommonChanBitmaps_t* bitmaps, int8_t datarate, uint16_t* channelsMask,
+                                      Band_t* bands, uint16_t* enabledMask, uint8_t* delayTx )
+{
+    uint16_t* drMask = NULL;
+    uint16_t candidates = 0;
+    uint16_t available = 0;
+    uint8_t nbEnabledChannels = 0;
+    uint8_t delayTransmission = 0;
+
+    if( ( datarate < 0 ) || ( datarate >= bitmaps->NbDatarates ) )
+    { // No channel supports the datarate
+        memset1( ( uint8_t* )enabledMask, 0, bitmaps->NbMaskWords * sizeof( uint16_t ) );
+        *delayTx = 0;
+        return 0;
+    }
+    drMask = &bitmaps->DrMasks[datarate * bitmaps->NbMaskWords];
+
+    for( uint8_t k = 0; k < bitmaps->NbMaskWords; k++ )
+    {
+        candidates = channelsMask[k] & drMask[k];
+        available = 0;
+        for( uint8_t i = 0; i < bitmaps->NbBands; i++ )
+        { // Only keep the channels of the bands available for transmission
+            if( bands[i].TimeOff == 0 )
+            {
+                available |= bitmaps->BandMasks[i * bitmaps->NbMaskWords + k];
+            }
+        }
+        available &= candidates;
+
+        enabledMask[k] = available;
+        nbEnabledChannels += CountChannels( available, 16 );
+        delayTransmission += CountChannels( candidates & ~available, 16 );
+    }
+
+    *delayTx = delayTransmission;
+    return nbEnabledChannels;
+}
+
+uint8_t RegionCommonChanBitmapsSelect( uint16_t* channelsMask, uint8_t nbMaskWords, uint8_t n )
+{
+    uint16_t mask = 0;
+    uint8_t nbChannels = 0;
+
+    for( uint8_t k = 0; k < nbMaskWords; k++ )
+    {
+        nbChannels = CountChannels( channelsMask[k], 16 );
+        if( n >= nbChannels )
+        {
+            n -= nbChannels;
+            continue;
+        }
+        // Clear the n lowest channels of the word, the result is the lowest one left
+        mask = channelsMask[k];
+        for( ; n > 0; n-- )
+        {
+            mask &= mask - 1;
+        }
+        for( uint8_t j = 0; j < 16; j++ )
+        {
+            if( ( mask & ( 1 << j ) ) != 0 )
+            {
+                return ( k * 16 ) + j;
+            }
+        }
+    }
+    return 0;
+}
@@ -159,6 +159,31 @@ typedef struct sRegionCommonCalcBackOffParams
     TimerTime_t TxTimeOnAir;
 }RegionCommonCalcBackOffParams_t;
 
+typedef struct sRegionCommonChanBitmaps
+{
+    /*!
+     * Defined channels supporting each datarate. NbDatarates masks of
+     * NbMaskWords words, the mask of datarate dr starts at dr * NbMaskWords.
+     */
+    uint16_t* DrMasks;
+    /*!
+     * Defined channels of each band. NbBands masks of NbMaskWords words.
+     */
+    uint16_t* BandMasks;
+    /*!
+     * Number of 16 bits words of a channels mask.
+     */
+    uint8_t NbMaskWords;
+    /*!
+     * Number of datarates a mask is kept for, from DR_0.
+     */
+    uint8_t NbDatarates;
+    /*!
+     * Number of bands.
+     */
+    uint8_t NbBands;
+}RegionCommonChanBitmaps_t;
+
 /*!
  * \brief Calculates the join duty cycle.
  *        This is a generic function and valid for all regions.
@@ -309,9 +334,9 @@ uint8_t RegionCommonLinkAdrReqVerifyParams( RegionCommonLinkAdrReqVerifyParams_t
  *
  * \param [IN] bandwidth Bandwidth to use.
  *
- * \retval Returns the symbol time.
+ * \retval Returns the symbol time in microseconds.
  */
-double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
+uint32_t RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
 
 /*!
  * \brief Computes the symbol time for FSK modulation.
@@ -320,14 +345,14 @@ double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
  *
  * \param [IN] bandwidth Bandwidth to use.
  *
- * \retval Returns the symbol time.
+ * \retval Returns the symbol time in microseconds.
  */
-double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
+uint32_t RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
 
 /*!
  * \brief Computes the RX window timeout and the RX window offset.
  *
- * \param [IN] tSymbol Symbol timeout.
+ * \param [IN] tSymbol Symbol time in microseconds.
  *
  * \param [IN] minRxSymbols Minimum required number of symbols to detect an Rx frame.
  *
@@ -340,7 +365,7 @@ double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
  *
  * \param [OUT] windowOffset RX window time offset to be applied to the RX delay.
  */
-void RegionCommonComputeRxWindowParameters( double tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset );
+void RegionCommonComputeRxWindowParameters( uint32_t tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset );
 
 /*!
  * \brief Computes the txPower, based on the max EIRP and the antenna gain.
@@ -362,6 +387,66 @@ int8_t RegionCommonComputeTxPower( int8_t txPowerIndex, float maxEirp, float ant
  */
 void RegionCommonCalcBackOff( RegionCommonCalcBackOffParams_t* calcBackOffParams );
 
+/*!
+ * \brief Rebuilds the channel bitmaps from the channels of the region.
+ *        This is a generic function and valid for all regions.
+ *
+ * \param [IN] bitmaps The channel bitmaps of the region.
+ *
+ * \param [IN] channels The channels of the region.
+ *
+ * \param [IN] nbChannels Number of channels.
+ */
+void RegionCommonChanBitmapsInit( RegionCommonChanBitmaps_t* bitmaps, ChannelParams_t* channels, uint8_t nbChannels );
+
+/*!
+ * \brief Updates the channel bitmaps after a channel has been added,
+ *        modified or removed. This is a generic function and valid for all regions.
+ *
+ * \param [IN] bitmaps The channel bitmaps of the region.
+ *
+ * \param [IN] channels The channels of the region.
+ *
+ * \param [IN] id The id of the channel which changed.
+ */
+void RegionCommonChanBitmapsUpdate( RegionCommonChanBitmaps_t* bitmaps, ChannelParams_t* channels, uint8_t id );
+
+/*!
+ * \brief Computes the mask of the channels available for a transmission:
+ *        enabled in the channels mask, supporting the datarate and with
+ *        their band free of time-off. This is a generic function and valid for all regions.
+ *
+ * \param [IN] bitmaps The channel bitmaps of the region.
+ *
+ * \param [IN] datarate The datarate of the transmission.
+ *
+ * \param [IN] channelsMask The channels mask to apply, NbMaskWords words.
+ *
+ * \param [IN] bands The bands of the region.
+ *
+ * \param [OUT] enabledMask The mask of the available channels, NbMaskWords words.
+ *
+ * \param [OUT] delayTx Number of channels only blocked by a band time-off.
+ *
+ * \retval Returns the number of available channels.
+ */
+uint8_t RegionCommonChanBitmapsCount( RegionCommonChanBitmaps_t* bitmaps, int8_t datarate, uint16_t* channelsMask,
+                                      Band_t* bands, uint16_t* enabledMask, uint8_t* delayTx );
+
+/*!
+ * \brief Returns the id of the n-th channel set in a channels mask, counting
+ *        from the lowest id. This is a generic function and valid for all regions.
+ *
+ * \param [IN] channelsMask The channels mask.
+ *
+ * \param [IN] nbMaskWords Number of 16 bits words of the mask.
+ *
+ * \param [IN] n Index of the channel to return, lower than the number of channels set.
+ *
+ * \retval Returns the channel id.
+ */
+uint8_t RegionCommonChanBitmapsSelect( uint16_t* channelsMask, uint8_t nbMaskWords, uint8_t n );
+
 /*! \} defgroup REGIONCOMMON */
 
 #endif // __REGIONCOMMON_H__
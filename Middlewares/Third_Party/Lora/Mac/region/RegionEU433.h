@@ -192,6 +192,11 @@
  */
 #define EU433_MAX_NB_BANDS                          1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define EU433_CHANNELS_MASK_SIZE                    1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -241,6 +246,42 @@ static const uint8_t MaxPayloadOfDatarateEU433[] = { 51, 51, 51, 115, 242, 242,
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterEU433[] = { 51, 51, 51, 115, 222, 222, 222, 222 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionEU433Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[EU433_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[EU433_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[EU433_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[EU433_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[EU433_TX_MAX_DATARATE + 1][EU433_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[EU433_MAX_NB_BANDS][EU433_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionEU433Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -264,6 +305,13 @@ void RegionEU433SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionEU433InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionEU433Ctx_t.
+ */
+void RegionEU433SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
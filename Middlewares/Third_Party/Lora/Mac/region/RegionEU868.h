@@ -189,6 +189,11 @@
  */
 #define EU868_MAX_NB_BANDS                          5
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define EU868_CHANNELS_MASK_SIZE                    1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -262,6 +267,42 @@ static const uint8_t MaxPayloadOfDatarateEU868[] = { 51, 51, 51, 115, 242, 242,
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterEU868[] = { 51, 51, 51, 115, 222, 222, 222, 222 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionEU868Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[EU868_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[EU868_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[EU868_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[EU868_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[EU868_TX_MAX_DATARATE + 1][EU868_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[EU868_MAX_NB_BANDS][EU868_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionEU868Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -285,6 +326,13 @@ void RegionEU868SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionEU868InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionEU868Ctx_t.
+ */
+void RegionEU868SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
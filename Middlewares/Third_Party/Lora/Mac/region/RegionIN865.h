@@ -189,6 +189,11 @@
  */
 #define IN865_MAX_NB_BANDS                          1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define IN865_CHANNELS_MASK_SIZE                    1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -243,6 +248,42 @@ static const uint8_t MaxPayloadOfDatarateRepeaterIN865[] = { 51, 51, 51, 115, 22
  */
 static const int8_t EffectiveRx1DrOffsetIN865[] = { 0, 1, 2, 3, 4, 5, -1, -2 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionIN865Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[IN865_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[IN865_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[IN865_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[IN865_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[IN865_TX_MAX_DATARATE + 1][IN865_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[IN865_MAX_NB_BANDS][IN865_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionIN865Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -266,6 +307,13 @@ void RegionIN865SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionIN865InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionIN865Ctx_t.
+ */
+void RegionIN865SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
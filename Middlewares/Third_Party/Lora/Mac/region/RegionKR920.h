@@ -194,6 +194,11 @@
  */
 #define KR920_MAX_NB_BANDS                          1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define KR920_CHANNELS_MASK_SIZE                    1
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -253,6 +258,42 @@ static const uint8_t MaxPayloadOfDatarateKR920[] = { 51, 51, 51, 115, 242, 242 }
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterKR920[] = { 51, 51, 51, 115, 222, 222 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionKR920Ctx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[KR920_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[KR920_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[KR920_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[KR920_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[KR920_TX_MAX_DATARATE + 1][KR920_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[KR920_MAX_NB_BANDS][KR920_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionKR920Ctx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -276,6 +317,13 @@ void RegionKR920SetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionKR920InitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionKR920Ctx_t.
+ */
+void RegionKR920SetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
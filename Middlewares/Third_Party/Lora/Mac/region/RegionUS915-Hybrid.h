@@ -170,6 +170,11 @@
  */
 #define US915_HYBRID_MAX_NB_BANDS                   1
 
+/*!
+ * Number of 16 bits words of a channels mask
+ */
+#define US915_HYBRID_CHANNELS_MASK_SIZE             6
+
 /*!
  * Band 0 definition
  * { DutyCycle, TxMaxPower, LastJoinTxDoneTime, LastTxDoneTime, TimeOff }
@@ -223,6 +228,46 @@ static const uint8_t MaxPayloadOfDatarateUS915_HYBRID[] = { 11, 53, 125, 242, 24
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterUS915_HYBRID[] = { 11, 53, 125, 242, 242, 0, 0, 0, 33, 109, 222, 222, 222, 222, 0, 0 };
 
+/*!
+ * Channels and bands state of the region, one per LoRaMac context
+ */
+typedef struct sRegionUS915HybridCtx
+{
+    /*!
+     * LoRaMAC channels
+     */
+    ChannelParams_t Channels[US915_HYBRID_MAX_NB_CHANNELS];
+    /*!
+     * LoRaMac bands
+     */
+    Band_t Bands[US915_HYBRID_MAX_NB_BANDS];
+    /*!
+     * LoRaMac channels mask
+     */
+    uint16_t ChannelsMask[US915_HYBRID_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels remaining
+     */
+    uint16_t ChannelsMaskRemaining[US915_HYBRID_CHANNELS_MASK_SIZE];
+    /*!
+     * LoRaMac channels default mask
+     */
+    uint16_t ChannelsDefaultMask[US915_HYBRID_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels supporting each TX datarate
+     */
+    uint16_t ChannelsDrMasks[US915_HYBRID_TX_MAX_DATARATE + 1][US915_HYBRID_CHANNELS_MASK_SIZE];
+    /*!
+     * Defined channels of each band
+     */
+    uint16_t ChannelsBandMasks[US915_HYBRID_MAX_NB_BANDS][US915_HYBRID_CHANNELS_MASK_SIZE];
+    /*!
+     * Channel bitmaps used to select the next channel, kept up to date on
+     * each change of the channels list
+     */
+    RegionCommonChanBitmaps_t ChannelsBitmaps;
+}RegionUS915HybridCtx_t;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -246,6 +291,13 @@ void RegionUS915HybridSetBandTxDone( SetBandTxDoneParams_t* txDone );
  */
 void RegionUS915HybridInitDefaults( InitType_t type );
 
+/*!
+ * \brief Selects the context the region functions work on.
+ *
+ * \param [IN] ctx Pointer to a RegionUS915HybridCtx_t.
+ */
+void RegionUS915HybridSetCtx( void* ctx );
+
 /*!
  * \brief Verifies a parameter.
  *
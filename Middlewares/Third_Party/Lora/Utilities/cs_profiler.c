@@ -0,0 +1,317 @@
+/**
+ ******************************************************************************
+ * @file    cs_profiler.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Critical section duration profiler
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "utilities.h"
+
+#if defined( CS_PROFILER )
+
+#include "cs_profiler.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
+/* SysTick reload value when the profiler owns the SysTick (24 bits counter) */
+#define CSP_SYSTICK_RELOAD    0x00FFFFFFU
+
+/* Private macros ------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static bool CspInitialized = false;
+static bool CspActive = false;
+static uint32_t CspStart = 0;
+static CSP_Site_t *CspSites = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+/**
+ * @brief  Reads the cycle counter
+ * @param  None
+ * @retval Counter value, counting up
+ */
+static uint32_t CSP_GetCycles(void);
+
+/**
+ * @brief  Computes the number of cycles between two counter values
+ * @param  start: counter value at the section start
+ * @param  end: counter value at the section end
+ * @retval Elapsed cycles
+ */
+static uint32_t CSP_Elapsed(uint32_t start, uint32_t end);
+
+/**
+ * @brief  Accounts a duration to a call site, interrupts disabled
+ * @param  site: call site
+ * @param  duration: duration in core cycles
+ * @retval None
+ */
+static void CSP_Account(CSP_Site_t *site, uint32_t duration);
+
+/**
+ * @brief  Writes a little endian value into a buffer
+ * @param  buf: destination
+ * @param  value: value to write
+ * @param  size: number of bytes
+ * @retval Pointer past the written bytes
+ */
+static uint8_t *CSP_Put(uint8_t *buf, uint32_t value, uint8_t size);
+
+/* Functions Definition ------------------------------------------------------*/
+void CSP_Init(void)
+{
+#if ( __CORTEX_M >= 3U )
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+  /* keep the SysTick as configured by the application if it is running */
+  if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+  {
+    SysTick->LOAD = CSP_SYSTICK_RELOAD;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+  }
+#endif
+  CspInitialized = true;
+}
+
+void CSP_Enter(uint32_t primask)
+{
+  if (primask != 0)
+  {
+    /* nested section, the outer one is timed */
+    return;
+  }
+  if (CspInitialized == false)
+  {
+    CSP_Init();
+  }
+  CspStart = CSP_GetCycles();
+  CspActive = true;
+}
+
+void CSP_Exit(CSP_Site_t *site)
+{
+  uint32_t duration;
+
+  if (CspActive == false)
+  {
+    return;
+  }
+  duration = CSP_Elapsed(CspStart, CSP_GetCycles());
+  CspActive = false;
+
+  CSP_Account(site, duration);
+}
+
+uint32_t CSP_IsrEnter(void)
+{
+  if (CspInitialized == false)
+  {
+    CSP_Init();
+  }
+  return CSP_GetCycles();
+}
+
+void CSP_IsrExit(CSP_Site_t *site, uint32_t start)
+{
+  uint32_t duration = CSP_Elapsed(start, CSP_GetCycles());
+  uint32_t primask = __get_PRIMASK();
+
+  /* the sites list is shared with the critical sections */
+  __disable_irq();
+  CSP_Account(site, duration);
+  __set_PRIMASK(primask);
+}
+
+void CSP_Reset(void)
+{
+  CSP_Site_t *site;
+  uint8_t i;
+
+  BACKUP_PRIMASK();
+  DISABLE_IRQ();
+
+  for (site = CspSites; site != NULL; site = site->Next)
+  {
+    site->Count = 0;
+    site->Max = 0;
+    for (i = 0; i < CSP_NB_BINS; i++)
+    {
+      site->Histogram[i] = 0;
+    }
+  }
+
+  RESTORE_PRIMASK();
+}
+
+const CSP_Site_t *CSP_GetSites(void)
+{
+  return CspSites;
+}
+
+uint32_t CSP_Dump(void (*write)(const uint8_t *buf, uint16_t len))
+{
+  uint8_t record[11 + (4 * CSP_NB_BINS) + 255];
+  uint8_t *p;
+  const CSP_Site_t *site;
+  const char *file;
+  const char *c;
+  uint8_t nbSites = 0;
+  uint8_t fileLen;
+  uint8_t i;
+  uint32_t total = 0;
+
+  for (site = CspSites; site != NULL; site = site->Next)
+  {
+    nbSites++;
+  }
+
+  p = record;
+  *p++ = 'C';
+  *p++ = 'S';
+  *p++ = 'P';
+  *p++ = CSP_DUMP_VERSION;
+  *p++ = nbSites;
+  *p++ = CSP_NB_BINS;
+  p = CSP_Put(p, SystemCoreClock, 4);
+  write(record, p - record);
+  total += p - record;
+
+  for (site = CspSites; site != NULL; site = site->Next)
+  {
+    /* base name of the file */
+    file = site->File;
+    for (c = site->File; *c != '\0'; c++)
+    {
+      if ((*c == '/') || (*c == '\\'))
+      {
+        file = c + 1;
+      }
+    }
+
+    p = record;
+    p = CSP_Put(p, site->Line, 2);
+    p = CSP_Put(p, site->Count, 4);
+    p = CSP_Put(p, site->Max, 4);
+    for (i = 0; i < CSP_NB_BINS; i++)
+    {
+      p = CSP_Put(p, site->Histogram[i], 4);
+    }
+    for (fileLen = 0; (file[fileLen] != '\0') && (fileLen < 255); fileLen++)
+    {
+      p[1 + fileLen] = file[fileLen];
+    }
+    *p = fileLen;
+    p += 1 + fileLen;
+
+    write(record, p - record);
+    total += p - record;
+  }
+  return total;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t CSP_GetCycles(void)
+{
+#if ( __CORTEX_M >= 3U )
+  return DWT->CYCCNT;
+#else
+  /* SysTick counts down */
+  return SysTick->LOAD - SysTick->VAL;
+#endif
+}
+
+static uint32_t CSP_Elapsed(uint32_t start, uint32_t end)
+{
+#if ( __CORTEX_M >= 3U )
+  return end - start;
+#else
+  /* a single SysTick period is resolved, longer sections are aliased */
+  if (end >= start)
+  {
+    return end - start;
+  }
+  return (SysTick->LOAD + 1U) - start + end;
+#endif
+}
+
+static void CSP_Account(CSP_Site_t *site, uint32_t duration)
+{
+  uint32_t bound = 1U << CSP_BIN0_LOG2;
+  uint8_t bin = 0;
+
+  if (site->Registered == false)
+  {
+    site->Registered = true;
+    site->Next = CspSites;
+    CspSites = site;
+  }
+
+  while ((bin < (CSP_NB_BINS - 1)) && (duration >= bound))
+  {
+    bound <<= 2;
+    bin++;
+  }
+  site->Histogram[bin]++;
+  site->Count++;
+  if (duration > site->Max)
+  {
+    site->Max = duration;
+  }
+}
+
+static uint8_t *CSP_Put(uint8_t *buf, uint32_t value, uint8_t size)
+{
+  while (size-- > 0)
+  {
+    *buf++ = (uint8_t) value;
+    value >>= 8;
+  }
+  return buf;
+}
+
+#endif /* CS_PROFILER */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
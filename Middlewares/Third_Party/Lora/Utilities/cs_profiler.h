@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ * @file    cs_profiler.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Header for cs_profiler.c module
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CS_PROFILER_H__
+#define __CS_PROFILER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Number of bins of the duration histogram of a call site.
+ * Bin i counts the sections shorter than 2^(CSP_BIN0_LOG2 + 2 * i) cycles,
+ * the last bin counts all the longer ones.
+ */
+#define CSP_NB_BINS     8
+#define CSP_BIN0_LOG2   6
+
+/**
+ * Binary dump format, all fields little endian:
+ *   header: 'C' 'S' 'P' version(1) nbSites(1) nbBins(1) coreClock(4)
+ *   then per site: line(2) count(4) max(4) histogram(4 * nbBins)
+ *                  fileLen(1) file(fileLen, base name only)
+ */
+#define CSP_DUMP_VERSION   1
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Statistics of the critical sections ending at a given source line
+ */
+typedef struct CSP_Site_s
+{
+  const char *File;                 /* source file of the section end */
+  uint16_t Line;                    /* source line of the section end */
+  bool Registered;                  /* site is in the sites list */
+  uint32_t Count;                   /* number of sections measured */
+  uint32_t Max;                     /* longest section, in core cycles */
+  uint32_t Histogram[CSP_NB_BINS];  /* duration histogram */
+  struct CSP_Site_s *Next;          /* next site in the sites list */
+} CSP_Site_t;
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/**
+ * Static initializer of a call site, used by the RESTORE_PRIMASK, ENABLE_IRQ
+ * and CSP_ISR_EXIT macros of utilities.h when CS_PROFILER is defined
+ */
+#define CSP_SITE_INIT   { __FILE__, __LINE__, false, 0, 0, { 0 }, NULL }
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Starts the cycle counter, DWT when the core has one, SysTick otherwise.
+ *         Called on the first section if not called by the application.
+ * @param  None
+ * @retval None
+ */
+void CSP_Init(void);
+
+/**
+ * @brief  Marks the start of a critical section, interrupts already disabled
+ * @param  primask: PRIMASK value before the interrupts were disabled,
+ *         nested sections (primask set) are not timed
+ * @retval None
+ */
+void CSP_Enter(uint32_t primask);
+
+/**
+ * @brief  Marks the end of a critical section, interrupts still disabled
+ * @param  site: call site the duration is accounted to
+ * @retval None
+ */
+void CSP_Exit(CSP_Site_t *site);
+
+/**
+ * @brief  Marks the start of an interrupt handler
+ * @param  None
+ * @retval Counter value, to be given to CSP_IsrExit
+ */
+uint32_t CSP_IsrEnter(void);
+
+/**
+ * @brief  Marks the end of an interrupt handler. The interrupts of lower or
+ *         equal priority wait for the whole handler, which is accounted
+ *         like a critical section.
+ * @param  site: call site the duration is accounted to
+ * @param  start: value returned by CSP_IsrEnter
+ * @retval None
+ */
+void CSP_IsrExit(CSP_Site_t *site, uint32_t start);
+
+/**
+ * @brief  Clears the statistics of all the call sites
+ * @param  None
+ * @retval None
+ */
+void CSP_Reset(void);
+
+/**
+ * @brief  Returns the call sites measured so far
+ * @param  None
+ * @retval First site of the list, NULL if none
+ */
+const CSP_Site_t *CSP_GetSites(void);
+
+/**
+ * @brief  Serializes the statistics in the binary dump format
+ * @param  write: function called with each chunk of the dump
+ * @retval Number of bytes written
+ */
+uint32_t CSP_Dump(void (*write)(const uint8_t *buf, uint16_t len));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CS_PROFILER_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
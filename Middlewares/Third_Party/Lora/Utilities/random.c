@@ -0,0 +1,212 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013 Semtech
+
+Description: Entropy pool and AES-CTR deterministic random bit generator
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis and Gregory Cristian
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "utilities.h"
+#include "aes.h"
+#include "random.h"
+
+/*!
+ * Key schedule of the generator, also used to compress the entropy pool
+ */
+static aes_context RandomAesContext;
+
+/*!
+ * Counter block of the generator
+ */
+static uint8_t RandomV[N_BLOCK];
+
+/*!
+ * Entropy pool and write position in its current block
+ */
+static uint8_t RandomPool[N_BLOCK];
+static uint8_t RandomPoolIndex = 0;
+
+/*!
+ * Output block not yet handed out and read position, N_BLOCK when empty
+ */
+static uint8_t RandomOutput[N_BLOCK];
+static uint8_t RandomOutputIndex = N_BLOCK;
+
+/*!
+ * The key schedule starts from the all zeros key
+ */
+static bool RandomInitialized = false;
+
+/*!
+ * Set by the first reseed
+ */
+static bool RandomSeeded = false;
+
+/*!
+ * \brief Sets the all zeros key on the first use
+ */
+static void RandomInit( void )
+{
+    uint8_t key[N_BLOCK];
+
+    if( RandomInitialized == false )
+    {
+        memset1( key, 0, N_BLOCK );
+        aes_set_key( key, N_BLOCK, &RandomAesContext );
+        RandomInitialized = true;
+    }
+}
+
+/*!
+ * \brief Increments the counter block, big endian
+ */
+static void RandomIncrement( void )
+{
+    uint8_t i = N_BLOCK;
+
+    while( i-- > 0 )
+    {
+        if( ++RandomV[i] != 0 )
+        {
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief CTR_DRBG update: derives a new key and counter from the current ones
+ *
+ * \param [IN] data Provided data XORed into the new key, NULL for none
+ */
+static void RandomUpdate( const uint8_t *data )
+{
+    uint8_t key[N_BLOCK];
+    uint8_t i;
+
+    RandomIncrement( );
+    aes_encrypt( RandomV, key, &RandomAesContext );
+    RandomIncrement( );
+    aes_encrypt( RandomV, RandomV, &RandomAesContext );
+
+    if( data != NULL )
+    {
+        for( i = 0; i < N_BLOCK; i++ )
+        {
+            key[i] ^= data[i];
+        }
+    }
+    aes_set_key( key, N_BLOCK, &RandomAesContext );
+    memset1( key, 0, N_BLOCK );
+}
+
+void Random_AddEntropy( const uint8_t *data, uint16_t size )
+{
+    RandomInit( );
+
+    while( size-- > 0 )
+    {
+        RandomPool[RandomPoolIndex++] ^= *data++;
+        if( RandomPoolIndex == N_BLOCK )
+        {
+            aes_encrypt( RandomPool, RandomPool, &RandomAesContext );
+            RandomPoolIndex = 0;
+        }
+    }
+}
+
+void Random_Reseed( void )
+{
+    RandomInit( );
+
+    // Completes the pending block of the pool
+    if( RandomPoolIndex != 0 )
+    {
+        aes_encrypt( RandomPool, RandomPool, &RandomAesContext );
+        RandomPoolIndex = 0;
+    }
+    RandomUpdate( RandomPool );
+
+    // The output drawn from the previous key is dropped
+    RandomOutputIndex = N_BLOCK;
+    RandomSeeded = true;
+}
+
+bool Random_IsSeeded( void )
+{
+    return RandomSeeded;
+}
+
+void Random_Get( uint8_t *buffer, uint16_t size )
+{
+    RandomInit( );
+
+    while( size-- > 0 )
+    {
+        if( RandomOutputIndex == N_BLOCK )
+        {
+            RandomIncrement( );
+            aes_encrypt( RandomV, RandomOutput, &RandomAesContext );
+            RandomUpdate( NULL );
+            RandomOutputIndex = 0;
+        }
+        *buffer++ = RandomOutput[RandomOutputIndex];
+        // An output byte is never handed out twice
+        RandomOutput[RandomOutputIndex++] = 0;
+    }
+}
+
+uint32_t Random_Get32( void )
+{
+    uint8_t buffer[4];
+
+    Random_Get( buffer, 4 );
+    return ( ( uint32_t )buffer[3] << 24 ) | ( ( uint32_t )buffer[2] << 16 ) |
+           ( ( uint32_t )buffer[1] << 8 ) | buffer[0];
+}
+
+uint32_t Random_Range( uint32_t range )
+{
+    uint32_t limit;
+    uint32_t value;
+
+    if( range == 0 )
+    {
+        return Random_Get32( );
+    }
+
+    // 2^32 modulo range: the lowest draws are the incomplete multiple
+    limit = ( uint32_t )( -range ) % range;
+    do
+    {
+        value = Random_Get32( );
+    }
+    while( value < limit );
+
+    return value % range;
+}
+
+void srand1( uint32_t seed )
+{
+    uint8_t buffer[4];
+
+    buffer[0] = seed;
+    buffer[1] = seed >> 8;
+    buffer[2] = seed >> 16;
+    buffer[3] = seed >> 24;
+    Random_AddEntropy( buffer, 4 );
+    Random_Reseed( );
+}
+
+int32_t randr( int32_t min, int32_t max )
+{
+    return ( int32_t )( ( uint32_t )min + Random_Range( ( uint32_t )max - ( uint32_t )min + 1 ) );
+}
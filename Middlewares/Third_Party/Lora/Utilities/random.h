@@ -0,0 +1,83 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013 Semtech
+
+Description: Entropy pool and AES-CTR deterministic random bit generator
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis and Gregory Cristian
+*/
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * The generator is a CTR_DRBG (NIST SP 800-90A) built on the AES-128 of
+ * aes.c. The noise sources (radio RSSI, MCU unique ID, ADC) are sampled
+ * once and compressed into a 16 bytes pool with AES in CBC-MAC mode; a
+ * reseed folds the pool into the key and the counter of the generator.
+ *
+ * A draw costs one AES block per 16 bytes and two more blocks to update
+ * the key, which gives backtracking resistance. srand1 and randr of
+ * utilities.h are implemented on top of it.
+ *
+ * \remark The functions are not reentrant: they must be called from the
+ *         main loop, not from interrupt handlers.
+ */
+
+/*!
+ * \brief Adds noise samples to the entropy pool
+ *
+ * \remark The samples only reach the generator on the next Random_Reseed
+ *
+ * \param [IN] data Noise samples
+ * \param [IN] size Number of bytes
+ */
+void Random_AddEntropy( const uint8_t *data, uint16_t size );
+
+/*!
+ * \brief Folds the entropy pool into the generator
+ */
+void Random_Reseed( void );
+
+/*!
+ * \brief Tells whether the generator has been reseeded at least once
+ *
+ * \retval seeded true when Random_Reseed has been called
+ */
+bool Random_IsSeeded( void );
+
+/*!
+ * \brief Fills a buffer with random bytes
+ *
+ * \param [OUT] buffer Buffer to fill
+ * \param [IN]  size   Number of bytes
+ */
+void Random_Get( uint8_t *buffer, uint16_t size );
+
+/*!
+ * \brief Draws a 32 bits random number
+ *
+ * \retval random Random value
+ */
+uint32_t Random_Get32( void );
+
+/*!
+ * \brief Draws an unbiased random number in 0..range-1
+ *
+ * \remark The draws falling in the last incomplete multiple of range are
+ *         rejected, instead of folding them with a modulo.
+ *
+ * \param [IN] range Number of values, 0 for the full 32 bits range
+ * \retval random Random value in range 0..range-1
+ */
+uint32_t Random_Range( uint32_t range );
+
+#endif // __RANDOM_H__
@@ -80,49 +80,79 @@ Maintainer: Miguel Luis, Gregory Cristian and Wael Guibene
       }                           \
   } while(0);                   
 
+/*!
+ * Counts an expiry comparison of the heap, the host test of the timer server
+ * defines it to check the heap work per critical section
+ */
+#ifndef TIMER_COUNT_COMPARE
+#define TIMER_COUNT_COMPARE( )
+#endif
+
+
 
+/*!
+ * Timers heap root, always the next timer to expire
+ */
+static TimerEvent_t *TimerHeapRoot = NULL;
+
+/*!
+ * Timer for which the RTC alarm is currently programmed
+ */
+static TimerEvent_t *TimerArmed = NULL;
 
 /*!
- * Timers list head pointer
+ * Timer whose callback is running
  */
-static TimerEvent_t *TimerListHead = NULL;
+static TimerEvent_t *TimerExpired = NULL;
 
 /*!
- * \brief Adds or replace the head timer of the list.
+ * \brief Compares the expiry of two timers
  *
- * \remark The list is automatically sorted. The list head always contains the
- *     next timer to expire.
+ * \remark Timestamps are absolute tick values, compared modulo 2^32.
  *
- * \param [IN]  obj Timer object to be become the new head
- * \param [IN]  remainingTime Remaining time of the previous head to be replaced
+ * \param [IN]  a First timer object
+ * \param [IN]  b Second timer object
+ * \retval true if a expires before b
  */
-static void TimerInsertNewHeadTimer( TimerEvent_t *obj );
+static bool TimerIsBefore( TimerEvent_t *a, TimerEvent_t *b );
 
 /*!
- * \brief Adds a timer to the list.
+ * \brief Melds two heaps of timers
  *
- * \remark The list is automatically sorted. The list head always contains the
- *     next timer to expire.
+ * \param [IN]  a Root of the first heap, may be NULL
+ * \param [IN]  b Root of the second heap, may be NULL
+ * \retval Root of the resulting heap
+ */
+static TimerEvent_t* TimerMeld( TimerEvent_t *a, TimerEvent_t *b );
+
+/*!
+ * \brief Melds a list of sibling sub-heaps into a single heap (two passes)
  *
- * \param [IN]  obj Timer object to be added to the list
- * \param [IN]  remainingTime Remaining time of the running head after which the object may be added
+ * \param [IN]  first Leftmost sibling, may be NULL
+ * \retval Root of the resulting heap
  */
-static void TimerInsertTimer( TimerEvent_t *obj );
+static TimerEvent_t* TimerMergePairs( TimerEvent_t *first );
 
 /*!
- * \brief Sets a timeout with the duration "timestamp"
- * 
- * \param [IN] timestamp Delay duration
+ * \brief Removes a timer from the heap
+ *
+ * \param [IN]  obj Timer object to be removed, must be in the heap
  */
-static void TimerSetTimeout( TimerEvent_t *obj );
+static void TimerHeapRemove( TimerEvent_t *obj );
+
+/*!
+ * \brief Returns the current time in ticks, on the timestamps time base
+ *
+ * \retval Current time in ticks
+ */
+static uint32_t TimerGetNow( void );
 
 /*!
- * \brief Check if the Object to be added is not already in the list
+ * \brief Sets a timeout with the duration "timestamp"
  * 
  * \param [IN] timestamp Delay duration
- * \retval true (the object is already in the list) or false  
  */
-static bool TimerExists( TimerEvent_t *obj );
+static void TimerSetTimeout( TimerEvent_t *obj );
 
 
 
@@ -132,137 +162,80 @@ void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) )
   obj->ReloadValue = 0;
   obj->IsRunning = false;
   obj->Callback = callback;
+  obj->Child = NULL;
   obj->Next = NULL;
+  obj->Prev = NULL;
+  obj->Context = NULL;
 }
 
 void TimerStart( TimerEvent_t *obj )
 {
-  uint32_t elapsedTime = 0;
-  
   BACKUP_PRIMASK();
   
   DISABLE_IRQ( );
   
 
-  if( ( obj == NULL ) || ( TimerExists( obj ) == true ) )
+  if( ( obj == NULL ) || ( obj->IsRunning == true ) )
   {
     RESTORE_PRIMASK( );
     return;
   }
-  obj->Timestamp = obj->ReloadValue;
-  obj->IsRunning = false;
 
-  if( TimerListHead == NULL )
+  if( TimerHeapRoot == NULL )
   {
     HW_RTC_SetTimerContext( );
-    TimerInsertNewHeadTimer( obj ); // insert a timeout at now+obj->Timestamp
   }
-  else 
-  {
-    elapsedTime = HW_RTC_GetTimerElapsedTime( );
-    obj->Timestamp += elapsedTime;
-  
-    if( obj->Timestamp < TimerListHead->Timestamp )
-    {
-      TimerInsertNewHeadTimer( obj);
-    }
-    else
-    {
-      TimerInsertTimer( obj);
-    }
-  }
-  RESTORE_PRIMASK( );
-}
-
-static void TimerInsertTimer( TimerEvent_t *obj)
-{
-  TimerEvent_t* cur = TimerListHead;
-  TimerEvent_t* next = TimerListHead->Next;
-
-  while (cur->Next != NULL )
-  {  
-    if( obj->Timestamp  > next->Timestamp )
-    {
-        cur = next;
-        next = next->Next;
-    }
-    else
-    {
-        cur->Next = obj;
-        obj->Next = next;
-        return;
-
-    }
-  }
-  cur->Next = obj;
+  obj->Timestamp = TimerGetNow( ) + obj->ReloadValue;
+  obj->IsRunning = true;
+  obj->Child = NULL;
   obj->Next = NULL;
-}
+  obj->Prev = NULL;
 
-static void TimerInsertNewHeadTimer( TimerEvent_t *obj )
-{
-  TimerEvent_t* cur = TimerListHead;
+  TimerHeapRoot = TimerMeld( TimerHeapRoot, obj );
 
-  if( cur != NULL )
+  if( TimerHeapRoot == obj )
   {
-    cur->IsRunning = false;
+    TimerSetTimeout( obj ); // insert a timeout at now+obj->ReloadValue
   }
-
-  obj->Next = cur;
-  TimerListHead = obj;
-  TimerSetTimeout( TimerListHead );
+  RESTORE_PRIMASK( );
 }
 
 void TimerIrqHandler( void )
 {
   TimerEvent_t* cur;
-  TimerEvent_t* next;
-  
+  CSP_ISR_ENTER( );
 
-  
-  uint32_t old =  HW_RTC_GetTimerContext( );
-  uint32_t now =  HW_RTC_SetTimerContext( );
-  uint32_t DeltaContext = now - old; //intentionnal wrap around
-  
-  /* update timeStamp based upon new Time Reference*/
-  /* beacuse delta context should never exceed 2^32*/
-  if ( TimerListHead != NULL )
-  {
-    for (cur=TimerListHead; cur->Next != NULL; cur= cur->Next)
-    {
-      next =cur->Next;
-      if (next->Timestamp > DeltaContext)
-      {
-        next->Timestamp -= DeltaContext;
-      }
-      else
-      {
-        next->Timestamp = 0 ;
-      }
-    }
-  }
+  /* the alarm has fired: move the time reference, timestamps are absolute */
+  HW_RTC_SetTimerContext( );
+  TimerArmed = NULL;
   
   /* execute imediately the alarm callback */
-  if ( TimerListHead != NULL )
+  if ( TimerHeapRoot != NULL )
   {
-    cur = TimerListHead;
-    TimerListHead = TimerListHead->Next;
+    cur = TimerHeapRoot;
+    TimerHeapRemove( cur );
+    TimerExpired = cur;
     exec_cb( cur->Callback );
   }
 
 
-  // remove all the expired object from the list
-  while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp < HW_RTC_GetTimerElapsedTime(  )  ))
+  // remove all the expired object from the heap
+  while( ( TimerHeapRoot != NULL ) && ( ( int32_t )( TimerHeapRoot->Timestamp - TimerGetNow( ) ) < 0 ) )
   {
-   cur = TimerListHead;
-   TimerListHead = TimerListHead->Next;
+   cur = TimerHeapRoot;
+   TimerHeapRemove( cur );
+   TimerExpired = cur;
    exec_cb( cur->Callback );
   }
+  TimerExpired = NULL;
 
-  /* start the next TimerListHead if it exists AND NOT running */
-  if(( TimerListHead != NULL ) && (TimerListHead->IsRunning == false))
+  /* start the next TimerHeapRoot if it exists AND NOT armed */
+  if( ( TimerHeapRoot != NULL ) && ( TimerHeapRoot != TimerArmed ) )
   {
-    TimerSetTimeout( TimerListHead );
+    TimerSetTimeout( TimerHeapRoot );
   }
+
+  CSP_ISR_EXIT( );
 }
 
 void TimerStop( TimerEvent_t *obj ) 
@@ -271,86 +244,145 @@ void TimerStop( TimerEvent_t *obj )
   
   DISABLE_IRQ( );
   
-  TimerEvent_t* prev = TimerListHead;
-  TimerEvent_t* cur = TimerListHead;
-
-  // List is empty or the Obj to stop does not exist 
-  if( ( TimerListHead == NULL ) || ( obj == NULL ) )
+  // Obj to stop does not exist 
+  if( ( obj == NULL ) || ( obj->IsRunning == false ) )
   {
     RESTORE_PRIMASK( );
     return;
   }
 
-  if( TimerListHead == obj ) // Stop the Head                  
+  if( TimerHeapRoot == obj ) // Stop the Head                  
   {
-    if( TimerListHead->IsRunning == true ) // The head is already running 
-    {    
-      if( TimerListHead->Next != NULL )
+    TimerHeapRemove( obj );
+
+    if( TimerArmed == obj ) // The head is already running 
+    {
+      if( TimerHeapRoot != NULL )
       {
-        TimerListHead->IsRunning = false;
-        TimerListHead = TimerListHead->Next;
-        TimerSetTimeout( TimerListHead );
+        TimerSetTimeout( TimerHeapRoot );
       }
       else
       {
         HW_RTC_StopAlarm( );
-        TimerListHead = NULL;
-      }
-    }
-    else // Stop the head before it is started
-    {   
-      if( TimerListHead->Next != NULL )   
-      {
-        TimerListHead = TimerListHead->Next;
-      }
-      else
-      {
-        TimerListHead = NULL;
+        TimerArmed = NULL;
       }
     }
   }
-  else // Stop an object within the list
-  {      
-    while( cur != NULL )
-    {
-      if( cur == obj )
-      {
-        if( cur->Next != NULL )
-        {
-          cur = cur->Next;
-          prev->Next = cur;
-        }
-        else
-        {
-          cur = NULL;
-          prev->Next = cur;
-        }
-        break;
-      }
-      else
-      {
-        prev = cur;
-        cur = cur->Next;
-      }
-    }   
+  else // Stop an object within the heap
+  {
+    TimerHeapRemove( obj );
   }
   
   RESTORE_PRIMASK( );
 }  
   
-static bool TimerExists( TimerEvent_t *obj )
+static bool TimerIsBefore( TimerEvent_t *a, TimerEvent_t *b )
+{
+  TIMER_COUNT_COMPARE( );
+  /* intentional wrap around, timers are less than 2^31 ticks apart */
+  return ( ( int32_t )( a->Timestamp - b->Timestamp ) < 0 );
+}
+
+static TimerEvent_t* TimerMeld( TimerEvent_t *a, TimerEvent_t *b )
+{
+  TimerEvent_t* tmp;
+
+  if( a == NULL )
+  {
+    return b;
+  }
+  if( b == NULL )
+  {
+    return a;
+  }
+  if( TimerIsBefore( b, a ) == true )
+  {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  /* b becomes the leftmost child of a */
+  b->Prev = a;
+  b->Next = a->Child;
+  if( a->Child != NULL )
+  {
+    a->Child->Prev = b;
+  }
+  a->Child = b;
+  return a;
+}
+
+static TimerEvent_t* TimerMergePairs( TimerEvent_t *first )
 {
-  TimerEvent_t* cur = TimerListHead;
+  TimerEvent_t* pairs = NULL;
+  TimerEvent_t* root = NULL;
+  TimerEvent_t* a;
+  TimerEvent_t* b;
 
-  while( cur != NULL )
+  /* first pass: meld the siblings two by two, stacking the results */
+  while( first != NULL )
   {
-    if( cur == obj )
+    a = first;
+    b = a->Next;
+    first = ( b != NULL ) ? b->Next : NULL;
+
+    a->Next = NULL;
+    a->Prev = NULL;
+    if( b != NULL )
     {
-      return true;
+      b->Next = NULL;
+      b->Prev = NULL;
     }
-    cur = cur->Next;
+    a = TimerMeld( a, b );
+    a->Next = pairs;
+    pairs = a;
+  }
+
+  /* second pass: meld the stacked pairs from the last to the first */
+  while( pairs != NULL )
+  {
+    a = pairs;
+    pairs = a->Next;
+    a->Next = NULL;
+    root = TimerMeld( root, a );
   }
-  return false;
+  return root;
+}
+
+static void TimerHeapRemove( TimerEvent_t *obj )
+{
+  if( obj == TimerHeapRoot )
+  {
+    TimerHeapRoot = TimerMergePairs( obj->Child );
+  }
+  else
+  {
+    /* unlink obj from its parent or left sibling */
+    if( obj->Prev->Child == obj )
+    {
+      obj->Prev->Child = obj->Next;
+    }
+    else
+    {
+      obj->Prev->Next = obj->Next;
+    }
+    if( obj->Next != NULL )
+    {
+      obj->Next->Prev = obj->Prev;
+    }
+    TimerHeapRoot = TimerMeld( TimerHeapRoot, TimerMergePairs( obj->Child ) );
+  }
+
+  obj->Child = NULL;
+  obj->Next = NULL;
+  obj->Prev = NULL;
+  obj->IsRunning = false;
+}
+
+static uint32_t TimerGetNow( void )
+{
+  return HW_RTC_GetTimerContext( ) + HW_RTC_GetTimerElapsedTime( );
 }
 
 void TimerReset( TimerEvent_t *obj )
@@ -377,6 +409,16 @@ void TimerSetValue( TimerEvent_t *obj, uint32_t value )
   obj->ReloadValue = ticks;
 }
 
+void TimerSetContext( TimerEvent_t *obj, void *context )
+{
+  obj->Context = context;
+}
+
+void *TimerGetContext( void )
+{
+  return ( TimerExpired != NULL ) ? TimerExpired->Context : NULL;
+}
+
 TimerTime_t TimerGetCurrentTime( void )
 {
   uint32_t now = HW_RTC_GetTimerValue( );
@@ -394,13 +436,16 @@ TimerTime_t TimerGetElapsedTime( TimerTime_t past )
 static void TimerSetTimeout( TimerEvent_t *obj )
 {
   int32_t minTicks= HW_RTC_GetMinimumTimeout( );
-  obj->IsRunning = true; 
+  uint32_t elapsed = HW_RTC_GetTimerElapsedTime( );
+  uint32_t timeout = obj->Timestamp - HW_RTC_GetTimerContext( );
+
+  TimerArmed = obj;
 
   //in case deadline too soon
-  if(obj->Timestamp  < (HW_RTC_GetTimerElapsedTime(  ) + minTicks) )
+  if( ( int32_t )( timeout - ( elapsed + minTicks ) ) < 0 )
   {
-    obj->Timestamp = HW_RTC_GetTimerElapsedTime(  ) + minTicks;
+    timeout = elapsed + minTicks;
   }
-  HW_RTC_SetAlarm( obj->Timestamp );
+  HW_RTC_SetAlarm( timeout );
 }
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
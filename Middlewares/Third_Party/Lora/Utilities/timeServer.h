@@ -77,11 +77,14 @@ Maintainer: Miguel Luis and Gregory Cristian
  */
 typedef struct TimerEvent_s
 {
-    uint32_t Timestamp;         //! Expiring timer value in ticks from TimerContext
+    uint32_t Timestamp;         //! Expiring timer value in absolute ticks
     uint32_t ReloadValue;       //! Reload Value when Timer is restarted
-    bool IsRunning;             //! Is the timer currently running
+    bool IsRunning;             //! Is the timer currently running (in the timers heap)
     void ( *Callback )( void ); //! Timer IRQ callback function
-    struct TimerEvent_s *Next;  //! Pointer to the next Timer object.
+    struct TimerEvent_s *Child; //! Pointer to the leftmost child Timer object in the heap
+    struct TimerEvent_s *Next;  //! Pointer to the next sibling Timer object in the heap
+    struct TimerEvent_s *Prev;  //! Pointer to the previous sibling, or to the parent for the leftmost child
+    void *Context;              //! Owner of the timer, returned by TimerGetContext during the callback
 } TimerEvent_t;
 
 
@@ -104,7 +107,7 @@ void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) );
 /*!
  * \brief Timer IRQ event handler
  *
- * \note Head Timer Object is automaitcally removed from the List
+ * \note Head Timer Object is automaitcally removed from the heap
  *
  * \note e.g. it is snot needded to stop it
  */
@@ -139,6 +142,22 @@ void TimerReset( TimerEvent_t *obj );
  */
 void TimerSetValue( TimerEvent_t *obj, uint32_t value );
 
+/*!
+ * \brief Attaches an owner to the timer object, for callbacks shared by
+ *        several owners
+ *
+ * \param [IN] obj     Structure containing the timer object parameters
+ * \param [IN] context Owner of the timer, NULL after TimerInit
+ */
+void TimerSetContext( TimerEvent_t *obj, void *context );
+
+/*!
+ * \brief Returns the owner of the timer whose callback is running
+ *
+ * \retval context     owner set by TimerSetContext, NULL out of a callback
+ */
+void *TimerGetContext( void );
+
 
 /*!
  * \brief Read the current time
@@ -17,32 +17,6 @@ Maintainer: Miguel Luis and Gregory Cristian
 #include <stdint.h>
 #include "utilities.h"
 
-/*!
- * Redefinition of rand() and srand() standard C functions.
- * These functions are redefined in order to get the same behavior across
- * different compiler toolchains implementations.
- */
-// Standard random functions redefinition start
-#define RAND_LOCAL_MAX 2147483647L
-
-static uint32_t next = 1;
-
-int32_t rand1( void )
-{
-    return ( ( next = next * 1103515245L + 12345L ) % RAND_LOCAL_MAX );
-}
-
-void srand1( uint32_t seed )
-{
-    next = seed;
-}
-// Standard random functions redefinition end
-
-int32_t randr( int32_t min, int32_t max )
-{
-    return ( int32_t )rand1( ) % ( max - min + 1 ) + min;
-}
-
 void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
 {
     while( size-- )
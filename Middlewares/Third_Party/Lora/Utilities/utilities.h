@@ -68,10 +68,24 @@ Maintainer: Miguel Luis and Gregory Cristian
    PRIMASK is saved on STACK and recovered at the end of the funtion
    That way RESTORE_PRIMASK ensures that no irq would be triggered in case of
    unbalanced enable/disable, reentrant code etc...*/
+#if defined( CS_PROFILER )
+/* Critical sections are timed per call site (end of the section), see cs_profiler.h */
+#include "cs_profiler.h"
+#define BACKUP_PRIMASK()  uint32_t primask_bit= __get_PRIMASK()
+#define DISABLE_IRQ() do { uint32_t csp_primask= __get_PRIMASK(); __disable_irq(); CSP_Enter(csp_primask); } while(0)
+#define ENABLE_IRQ() do { static CSP_Site_t csp_site= CSP_SITE_INIT; CSP_Exit(&csp_site); __enable_irq(); } while(0)
+#define RESTORE_PRIMASK() do { static CSP_Site_t csp_site= CSP_SITE_INIT; if (primask_bit == 0) { CSP_Exit(&csp_site); } __set_PRIMASK(primask_bit); } while(0)
+/* Interrupt handlers bracketed by CSP_ISR_ENTER (after the declarations) and CSP_ISR_EXIT are timed the same way */
+#define CSP_ISR_ENTER() uint32_t csp_isr_start= CSP_IsrEnter()
+#define CSP_ISR_EXIT() do { static CSP_Site_t csp_site= CSP_SITE_INIT; CSP_IsrExit(&csp_site, csp_isr_start); } while(0)
+#else
 #define BACKUP_PRIMASK()  uint32_t primask_bit= __get_PRIMASK()
 #define DISABLE_IRQ() __disable_irq()
 #define ENABLE_IRQ() __enable_irq()
 #define RESTORE_PRIMASK() __set_PRIMASK(primask_bit)
+#define CSP_ISR_ENTER()
+#define CSP_ISR_EXIT()
+#endif
 
 /* prepocessor directive to align buffer*/
 #define ALIGN(n)             __attribute__((aligned(n)))
@@ -118,14 +132,18 @@ __STATIC_INLINE uint8_t __ffs( uint32_t value )
 }
 
 /*!
- * \brief Initializes the pseudo random generator initial value
+ * \brief Adds a seed to the entropy pool of the random generator and reseeds it
+ *
+ * \remark Implemented in random.c, over the AES-CTR generator
  *
- * \param [IN] seed Pseudo random generator initial value
+ * \param [IN] seed Noise sample or device specific value
  */
 void srand1( uint32_t seed );
 
 /*!
- * \brief Computes a random number between min and max
+ * \brief Computes an unbiased random number between min and max
+ *
+ * \remark Implemented in random.c, over the AES-CTR generator
  *
  * \param [IN] min range minimum value
  * \param [IN] max range maximum value
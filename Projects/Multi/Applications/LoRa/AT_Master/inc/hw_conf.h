@@ -132,6 +132,9 @@ Maintainer: Miguel Luis and Gregory Cristian
 /* uncomment below line to never enter lowpower modes in main.c*/
 //#define LOW_POWER_DISABLE
 
+/* uncomment below line to measure the critical sections durations (cs_profiler.h)*/
+//#define CS_PROFILER
+
 /* debug swicthes in bsp.c */
 //#define SENSOR_ENABLED
 
@@ -150,6 +153,10 @@ Maintainer: Miguel Luis and Gregory Cristian
 /*USI Modem MCU in sleep mode*/
 //#define MODEM_IN_SLEEP_MODE
 
+/*MDM32L07X01 modem driven by binary frames after init (AT+BINMODE)*/
+/*a modem which does not know AT+BINMODE stays on the text AT commands*/
+#define MODEM_BINARY_MODE
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 
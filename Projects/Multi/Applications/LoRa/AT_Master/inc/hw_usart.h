@@ -83,6 +83,8 @@ FlagStatus HW_UART_Modem_IsNewCharReceived(void);
 
 uint8_t HW_UART_Modem_GetNewChar(void);
 
+void HW_UART_Modem_SetContinuousRx(FunctionalState State);
+
 
 #ifdef __cplusplus
 }
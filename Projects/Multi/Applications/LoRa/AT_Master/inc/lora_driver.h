@@ -240,6 +240,16 @@ ATEerror_t Lora_SetJoinMode(uint8_t Mode);
 **************************************************************/
 ATEerror_t Lora_GetJoinMode(uint8_t *Mode);
 
+#ifdef USE_MDM32L07X01
+/**************************************************************
+ * @brief  Do a request to drive the modem by binary frames
+ * @param  void
+ * @retval LoRa return code
+ * @Nota on error the modem stays on the text AT commands
+**************************************************************/
+ATEerror_t Lora_SetBinaryMode(void);
+#endif
+
 #ifdef USE_LRWAN_NS1
 /**************************************************************
 * @brief  Do a request to reset LoRaWAN AT modem to factory default configuration.
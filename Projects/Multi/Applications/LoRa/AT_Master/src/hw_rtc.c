@@ -103,8 +103,18 @@ typedef struct
 #define CONV_NUMER                (MSEC_NUMBER>>COMMON_FACTOR)
 #define CONV_DENOM                (1<<(N_PREDIV_S-COMMON_FACTOR))
 
+/* DR value never read from a running calendar: the date is never 00 */
+#define CALENDAR_DAY_REG_INVALID  ((uint32_t) 0)
+
 
 /* Private macro -------------------------------------------------------------*/
+/* Divisions by a constant as a multiplication by its reciprocal: the RTC is */
+/* reprogrammed with irqs masked and Cortex-M0+ has no hardware divider. */
+/* Exact for X < 86400 (DIV_60, DIV_3600) and X < 2^23 (DIV_86400) */
+#define DIV_60(X)         ( ( ( ( uint32_t )(X) >> 2 ) * 17477U ) >> 18 )
+#define DIV_3600(X)       ( ( ( uint32_t )(X) * 37283U ) >> 27 )
+#define DIV_86400(X)      ( ( ( ( uint32_t )(X) >> 7 ) * 49711U ) >> 25 )
+
 /* Private variables ---------------------------------------------------------*/
 /*!
  * \brief Indicates if the RTC is already Initalized or not
@@ -138,11 +148,6 @@ static const uint16_t SecondsInHour = 3600;
  */
 static const uint32_t SecondsInDay = 86400;
 
-/*!
- * Number of hours in a day
- */
-static const uint8_t HoursInDay = 24;
-
 /*!
  * Number of days in a standard year
  */
@@ -174,6 +179,16 @@ static RTC_AlarmTypeDef RTC_AlarmStructure;
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/*!
+ * Calendar date register value CalendarDaySeconds was computed for
+ */
+static volatile uint32_t CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+
+/*!
+ * Seconds elapsed from 01/01/2000 to 00:00:00 of the CalendarDayReg date
+ */
+static volatile uint32_t CalendarDaySeconds = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 
 static void HW_RTC_SetConfig( void );
@@ -354,10 +369,7 @@ void HW_RTC_SetAlarm( uint32_t timeout )
  */
 uint32_t HW_RTC_GetTimerElapsedTime( void )
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-  
-  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct );
+  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(NULL, NULL );
 
   return( ( uint32_t )( CalendarValue - RtcTimerContext.Rtc_Time ));
 }
@@ -369,10 +381,7 @@ uint32_t HW_RTC_GetTimerElapsedTime( void )
  */
 uint32_t HW_RTC_GetTimerValue( void )
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-  
-  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct );
+  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(NULL, NULL );
 
   return( CalendarValue );
 }
@@ -486,83 +495,52 @@ static void HW_RTC_StartWakeUpAlarm( uint32_t timeoutValue )
   uint16_t rtcAlarmMinutes = 0;
   uint16_t rtcAlarmHours = 0;
   uint16_t rtcAlarmDays = 0;
+  uint8_t rtcAlarmMonth = 0;
+  uint8_t rtcAlarmYear = 0;
+  uint8_t daysInMonth = 0;
   RTC_TimeTypeDef RTC_TimeStruct = RtcTimerContext.RTC_Calndr_Time;
   RTC_DateTypeDef RTC_DateStruct = RtcTimerContext.RTC_Calndr_Date;
 
   HW_RTC_StopAlarm( );
   DBG_GPIO_SET(GPIOB, GPIO_PIN_13);
   
-  /*reverse counter */
+  /* fold the timeout and the context time in seconds from 00:00:00 of the */
+  /* context date, then split it once: the cost is the same for any timeout */
   rtcAlarmSubSeconds =  PREDIV_S - RTC_TimeStruct.SubSeconds;
   rtcAlarmSubSeconds += ( timeoutValue & PREDIV_S);
-  /* convert timeout  to seconds */
-  timeoutValue >>= N_PREDIV_S;  /* convert timeout  in seconds */
+  timeoutValue = ( timeoutValue >> N_PREDIV_S ) + ( rtcAlarmSubSeconds >> N_PREDIV_S ) +
+                 ( uint32_t )RTC_TimeStruct.Seconds + 
+                 ( ( uint32_t )RTC_TimeStruct.Minutes * SecondsInMinute ) +
+                 ( ( uint32_t )RTC_TimeStruct.Hours * SecondsInHour );
+  rtcAlarmSubSeconds &= PREDIV_S;
   
-  /*convert microsecs to RTC format and add to 'Now' */
-  rtcAlarmDays =  RTC_DateStruct.Date;
-  while (timeoutValue >= SecondsInDay)
-  {
-    timeoutValue -= SecondsInDay;
-    rtcAlarmDays++;
-  }
+  /* calc days */
+  rtcAlarmDays = DIV_86400( timeoutValue );
+  timeoutValue -= rtcAlarmDays * SecondsInDay;
+  rtcAlarmDays += RTC_DateStruct.Date;
   
   /* calc hours */
-  rtcAlarmHours = RTC_TimeStruct.Hours;
-  while (timeoutValue >= SecondsInHour)
-  {
-    timeoutValue -= SecondsInHour;
-    rtcAlarmHours++;
-  }
-  
-  /* calc minutes */
-  rtcAlarmMinutes = RTC_TimeStruct.Minutes;
-  while (timeoutValue >= SecondsInMinute)
-  {
-    timeoutValue -= SecondsInMinute;
-    rtcAlarmMinutes++;
-  }
-   
-  /* calc seconds */
-  rtcAlarmSeconds =  RTC_TimeStruct.Seconds + timeoutValue;
-
-  /***** correct for modulo********/
-  while (rtcAlarmSubSeconds >= (PREDIV_S+1))
-  {
-    rtcAlarmSubSeconds -= (PREDIV_S+1);
-    rtcAlarmSeconds++;
-  }
+  rtcAlarmHours = DIV_3600( timeoutValue );
+  timeoutValue -= rtcAlarmHours * SecondsInHour;
   
-  while (rtcAlarmSeconds >= 60)
-  { 
-    rtcAlarmSeconds -= 60;
-    rtcAlarmMinutes++;
-  }
-
-  while (rtcAlarmMinutes >= 60)
-  {
-    rtcAlarmMinutes -= 60;
-    rtcAlarmHours++;
-  }
-  
-  while (rtcAlarmHours >= HoursInDay)
-  {
-    rtcAlarmHours -= HoursInDay;
-    rtcAlarmDays++;
-  }
-
-  if( RTC_DateStruct.Year % 4 == 0 ) 
+  /* calc minutes and seconds */
+  rtcAlarmMinutes = DIV_60( timeoutValue );
+  rtcAlarmSeconds = timeoutValue - rtcAlarmMinutes * SecondsInMinute;
+
+  /* wrap the date month by month, result in 1..days in month: the longest */
+  /* timeout, 2^32 ticks or 48 days, ends two months after the context */
+  rtcAlarmMonth = RTC_DateStruct.Month - 1;
+  rtcAlarmYear = RTC_DateStruct.Year;
+  daysInMonth = ( rtcAlarmYear % 4 == 0 ) ? DaysInMonthLeapYear[ rtcAlarmMonth ] : DaysInMonth[ rtcAlarmMonth ];
+  while( rtcAlarmDays > daysInMonth )
   {
-    if( rtcAlarmDays > DaysInMonthLeapYear[ RTC_DateStruct.Month - 1 ] )    
+    rtcAlarmDays -= daysInMonth;
+    if( ++rtcAlarmMonth == 12 )
     {
-      rtcAlarmDays = rtcAlarmDays % DaysInMonthLeapYear[ RTC_DateStruct.Month - 1 ];
-    }
-  }
-  else
-  {
-    if( rtcAlarmDays > DaysInMonth[ RTC_DateStruct.Month - 1 ] )    
-    {   
-      rtcAlarmDays = rtcAlarmDays % DaysInMonth[ RTC_DateStruct.Month - 1 ];
+      rtcAlarmMonth = 0;
+      rtcAlarmYear++;
     }
+    daysInMonth = ( rtcAlarmYear % 4 == 0 ) ? DaysInMonthLeapYear[ rtcAlarmMonth ] : DaysInMonth[ rtcAlarmMonth ];
   }
 
   /* Set RTC_AlarmStructure with calculated values*/
@@ -593,63 +571,101 @@ static void HW_RTC_StartWakeUpAlarm( uint32_t timeoutValue )
 
 /*!
  * @brief get current time from calendar in ticks
- * @param pointer to RTC_DateStruct
- * @param pointer to RTC_TimeStruct
+ * @param pointer to RTC_DateStruct, may be NULL
+ * @param pointer to RTC_TimeStruct, may be NULL
  * @retval time in ticks
  */
 static TimerTime_t HW_RTC_GetCalendarValue( RTC_DateTypeDef* RTC_DateStruct, RTC_TimeTypeDef* RTC_TimeStruct )
 {
   TimerTime_t calendarValue = 0;
   uint32_t i = 0;
-  uint32_t first_read;
+  uint32_t dayReg;
+  uint32_t daySeconds;
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t dr;
+  uint32_t year;
+  uint32_t month;
   
-  /* Get Time and Date*/
-  HAL_RTC_GetTime( &RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN );
- 
-   /* make sure it is correct due to asynchronus nature of RTC*/
+  /* shadow registers are bypassed: read SSR, TR and DR directly and */
+  /* make sure they are coherent due to asynchronus nature of RTC*/
   do {
-    first_read = RTC_TimeStruct->SubSeconds;
-    HAL_RTC_GetDate( &RtcHandle, RTC_DateStruct, RTC_FORMAT_BIN );
-    HAL_RTC_GetTime( &RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN );
-  } while (first_read != RTC_TimeStruct->SubSeconds);
+    ssr = RTC->SSR;
+    tr = RTC->TR;
+    dr = RTC->DR;
+  } while (ssr != RTC->SSR);
  
-  /* years (calc valid up to year 2099)*/
-  for( i = 0; i < RTC_DateStruct->Year; i++ )
+  /* the day base only changes with DR: the key is read around the base */
+  /* so that a refresh done meanwhile from an irq is not torn */
+  dayReg = CalendarDayReg;
+  daySeconds = CalendarDaySeconds;
+  if ( ( dayReg != dr ) || ( CalendarDayReg != dayReg ) )
   {
-    if( (i % 4) == 0 )
+    year = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_YT | RTC_DR_YU ) ) >> 16U ) );
+    month = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_MT | RTC_DR_MU ) ) >> 8U ) );
+    
+    /* years (calc valid up to year 2099)*/
+    for( i = 0; i < year; i++ )
     {
-      calendarValue += DaysInLeapYear * SecondsInDay;
+      if( (i % 4) == 0 )
+      {
+        calendarValue += DaysInLeapYear * SecondsInDay;
+      }
+      else
+      {
+        calendarValue += DaysInYear * SecondsInDay;
+      }
+    }
+
+    /* months (calc valid up to year 2099)*/
+    if(( (year % 4) == 0 ) )
+    {
+      for( i = 0; i < ( month - 1 ); i++ )
+      {
+        calendarValue += DaysInMonthLeapYear[i] * SecondsInDay;
+      }
     }
     else
     {
-      calendarValue += DaysInYear * SecondsInDay;
+      for( i = 0;  i < ( month - 1 ); i++ )
+      {
+        calendarValue += DaysInMonth[i] * SecondsInDay;
+      }
     }
+
+    /* days */
+    calendarValue += ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( dr & ( RTC_DR_DT | RTC_DR_DU ) ) ) * SecondsInDay;
+    daySeconds = calendarValue;
+
+    CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+    CalendarDaySeconds = daySeconds;
+    CalendarDayReg = dr;
   }
 
-  /* months (calc valid up to year 2099)*/
-  if(( (RTC_DateStruct->Year % 4) == 0 ) )
+  calendarValue = daySeconds + 
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( tr & ( RTC_TR_ST | RTC_TR_SU ) ) ) + 
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_MNT | RTC_TR_MNU ) ) >> 8U ) ) * SecondsInMinute ) +
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_HT | RTC_TR_HU ) ) >> 16U ) ) * SecondsInHour ) );
+
+  calendarValue = (calendarValue<<N_PREDIV_S) + ( PREDIV_S - ( ssr & RTC_SSR_SS ) );
+
+  /* the broken down time is only decoded when the caller asks for it */
+  if ( RTC_TimeStruct != NULL )
   {
-    for( i = 0; i < ( RTC_DateStruct->Month - 1 ); i++ )
-    {
-      calendarValue += DaysInMonthLeapYear[i] * SecondsInDay;
-    }
+    RTC_TimeStruct->SubSeconds = ssr & RTC_SSR_SS;
+    RTC_TimeStruct->Hours = RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_HT | RTC_TR_HU ) ) >> 16U ) );
+    RTC_TimeStruct->Minutes = RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_MNT | RTC_TR_MNU ) ) >> 8U ) );
+    RTC_TimeStruct->Seconds = RTC_Bcd2ToByte( ( uint8_t )( tr & ( RTC_TR_ST | RTC_TR_SU ) ) );
+    RTC_TimeStruct->TimeFormat = ( uint8_t )( ( tr & RTC_TR_PM ) >> 16U );
   }
-  else
+  if ( RTC_DateStruct != NULL )
   {
-    for( i = 0;  i < ( RTC_DateStruct->Month - 1 ); i++ )
-    {
-      calendarValue += DaysInMonth[i] * SecondsInDay;
-    }
+    RTC_DateStruct->Year = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_YT | RTC_DR_YU ) ) >> 16U ) );
+    RTC_DateStruct->Month = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_MT | RTC_DR_MU ) ) >> 8U ) );
+    RTC_DateStruct->Date = RTC_Bcd2ToByte( ( uint8_t )( dr & ( RTC_DR_DT | RTC_DR_DU ) ) );
+    RTC_DateStruct->WeekDay = ( uint8_t )( ( dr & RTC_DR_WDU ) >> 13U );
   }
 
-  /* days */
-  calendarValue += ( ( uint32_t )RTC_TimeStruct->Seconds + 
-                     ( ( uint32_t )RTC_TimeStruct->Minutes * SecondsInMinute ) +
-                     ( ( uint32_t )RTC_TimeStruct->Hours * SecondsInHour ) + 
-                     ( ( uint32_t )( RTC_DateStruct->Date * SecondsInDay ) ) );
-  
-  calendarValue = (calendarValue<<N_PREDIV_S) + ( PREDIV_S - RTC_TimeStruct->SubSeconds);
-
   return( calendarValue );
 }
 
@@ -55,6 +55,7 @@ static struct {
   char buffRx[256];
   int rx_idx_free;
   int rx_idx_toread;
+  __IO uint8_t rx_continuous;               /* each char goes in buffRx, without HAL_UART_Receive_IT*/
   HW_LockTypeDef Lock;
   __IO HAL_UART_StateTypeDef gState;
   __IO HAL_UART_StateTypeDef RxState;
@@ -423,6 +424,15 @@ void HW_UART_Modem_IRQHandler(UART_HandleTypeDef *huart)
 				rx_ready = 1;  /* not used RxTC callback*/
 			}
 		}
+		else if (uart_context.rx_continuous)
+		{
+                   /*RXNE flag is auto cleared by reading the data*/
+                   receive((char)READ_REG(huart->Instance->RDR));
+
+                   /* allow stop mode*/
+                   LPM_SetStopMode(LPM_UART_RX_Id , LPM_Enable );
+                   return;
+		}
 		else
 		{
                    /* Clear RXNE interrupt flag */
@@ -452,6 +462,27 @@ void HW_UART_Modem_IRQHandler(UART_HandleTypeDef *huart)
 }
 
 
+/******************************************************************************
+  * @brief To receive every character, without HAL_UART_Receive_IT
+  * @brief The modem may then send at any time, e.g. the events of the binary mode
+  * @param ENABLE to receive continuously, DISABLE to go back to HAL_UART_Receive_IT
+  * @retval none
+******************************************************************************/
+void HW_UART_Modem_SetContinuousRx(FunctionalState State)
+{
+  if (State == ENABLE)
+  {
+    uart_context.rx_continuous = 1;
+    SET_BIT(huart2.Instance->CR1, USART_CR1_RXNEIE);
+  }
+  else
+  {
+    CLEAR_BIT(huart2.Instance->CR1, USART_CR1_RXNEIE);
+    uart_context.rx_continuous = 0;
+  }
+}
+
+
 /******************************************************************************
   * @brief To check if data has been received
   * @param none
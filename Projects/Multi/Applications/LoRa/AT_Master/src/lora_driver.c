@@ -396,6 +396,19 @@ ATEerror_t Status = AT_END_ERROR;
   Status = Modem_AT_Cmd(AT_ASYNC_EVENT, AT_JOIN, NULL );
 #elif USE_MDM32L07X01
   uint8_t JoinStatus = 0;
+  /*in binary mode the modem notifies the join, no need to poll it*/
+  if(Modem_AT_IsBinMode())
+  {
+    if(Modem_AT_BinEvent(BIN_EVT_JOINED, NULL) == AT_OK)
+    {
+      TimerStop( &JoinStatusDelayTimer );
+      JoinTimeOutFlag = RESET;
+      return AT_OK;
+    }
+    /*woken up by an other event: keep on waiting up to the timeout*/
+    if(!JoinTimeOutFlag)
+      return AT_JOIN_SLEEP_TRANSITION;
+  }
   /*trap the return code of the join request procedure*/
   if(JoinTimeOutFlag)
   {
@@ -433,6 +446,22 @@ ATEerror_t Status;
   return(Status);
 }
 
+#ifdef USE_MDM32L07X01
+/**************************************************************
+ * @brief  Do a request to drive the modem by binary frames
+ * @param  void
+ * @retval LoRa return code
+ * @Nota on error the modem stays on the text AT commands
+**************************************************************/
+ATEerror_t Lora_SetBinaryMode(void)
+{
+ATEerror_t Status;
+
+  Status = Modem_AT_Cmd(AT_CTRL, AT_BINMODE, NULL );
+
+  return(Status);
+}
+#endif
 
 /**************************************************************
  * @brief  Do a request to get the Network join Mode
@@ -1394,6 +1423,18 @@ uint8_t sizebuf;
 uint8_t i;
 char TempBuf[3] ={0};
 
+#ifdef USE_MDM32L07X01
+  /*in binary mode the last downlink came with its event, as is*/
+  if(Modem_AT_IsBinMode())
+  {
+    if (Modem_AT_BinEvent(BIN_EVT_RX, PtrStructData) != AT_OK)
+    {
+      PtrStructData->Port = 0;
+      PtrStructData->DataSize = 0;
+    }
+    return (AT_OK);
+  }
+#endif
 
   Status = Modem_AT_Cmd(AT_GET, AT_RECVB, PtrValueFromDevice );
   if (Status == 0)
@@ -1774,6 +1815,10 @@ ATEerror_t LoraCmdRetCode;
 #if USE_MDM32L07X01
           /*Set the modem Join mode following application set-up*/
           LoraCmdRetCode = Lora_SetJoinMode(LoraDriverParam->JoinMode);
+#ifdef MODEM_BINARY_MODE
+          /*Switch the modem to the binary frames once set-up*/
+          LoraCmdRetCode = Lora_SetBinaryMode();
+#endif
 #endif
 
 #if defined (USE_I_NUCLEO_LRWAN1) && defined (MODEM_IN_SLEEP_MODE)
@@ -1874,6 +1919,10 @@ ATEerror_t LoraCmdRetCode;
           DeviceSubState = DEVICE_INIT;  /* Reset the substate. We are Joined*/
           DBG_PRINTF("Nwk Joined\n");
         }
+        else if (LoraCmdRetCode == AT_JOIN_SLEEP_TRANSITION)
+        {
+          /* still waiting for the join event of the modem */
+        }
         else
         {
           DeviceState = DEVICE_READY;
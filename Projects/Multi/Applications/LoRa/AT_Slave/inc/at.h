@@ -121,6 +121,8 @@ typedef enum eATEerror
 #define AT_TCONF      "+TCONF"
 #define AT_TOFF       "+TOFF"
 #define AT_CERTIF     "+CERTIF"
+#define AT_CSPROF     "+CSPROF"
+#define AT_BINMODE    "+BINMODE"
 
 /* Exported functions ------------------------------------------------------- */
 
@@ -602,6 +604,36 @@ ATEerror_t at_test_get_lora_config(const char *param);
  * @retval AT_OK
  */
 ATEerror_t at_Certif( const char *param );
+
+/**
+ * @brief  Switch the com port to the binary frames
+ * @param  String parameter
+ * @retval AT_OK
+ */
+ATEerror_t at_BinMode(const char *param);
+
+#ifdef CS_PROFILER
+/**
+ * @brief  Print the critical sections statistics
+ * @param  String parameter
+ * @retval AT_OK
+ */
+ATEerror_t at_CsProfiler_get(const char *param);
+
+/**
+ * @brief  Reset the critical sections statistics
+ * @param  String parameter, must be 0
+ * @retval AT_OK if OK, or an appropriate AT_xxx error code
+ */
+ATEerror_t at_CsProfiler_set(const char *param);
+
+/**
+ * @brief  Send the critical sections statistics as a binary dump
+ * @param  String parameter
+ * @retval AT_OK
+ */
+ATEerror_t at_CsProfiler_run(const char *param);
+#endif
   
 #ifdef __cplusplus
 }
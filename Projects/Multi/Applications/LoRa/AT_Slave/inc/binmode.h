@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * @file    binmode.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Header for the binary framed transport of the AT interface
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BINMODE_H__
+#define __BINMODE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/*
+ * A frame is Id | Seq | TLVs | CRC16, COBS encoded and ended by a 0x00.
+ * The host sends a 0x00 before each frame as well: the modem drops what
+ * it receives after AT+BINMODE up to the first 0x00.
+ * Each TLV is Type(1) | Length(1) | Value, the CRC16 is the CCITT one
+ * (poly 0x1021, init 0xFFFF) on Id to the last TLV, sent MSB first.
+ * Responses and events have bit 7 of their Id set; a response carries
+ * the Seq of its command, events carry 0.
+ */
+
+/* Commands, host to modem */
+#define BIN_ID_AT         0x01  /* TLV_TEXT: an AT command line without <cr><lf> */
+#define BIN_ID_SEND       0x02  /* TLV_PORT, TLV_DATA, TLV_CONFIRMED optional */
+#define BIN_ID_JOIN       0x03  /* no TLV */
+#define BIN_ID_EXIT       0x04  /* no TLV, back to the text AT commands */
+
+/* Responses and events, modem to host */
+#define BIN_ID_RESPONSE   0x80  /* TLV_STATUS, TLV_TEXT optional */
+#define BIN_ID_EVT_RX     0x81  /* TLV_PORT, TLV_DATA, TLV_RSSI, TLV_SNR */
+#define BIN_ID_EVT_TXDONE 0x82  /* TLV_STATUS, TLV_ACK */
+#define BIN_ID_EVT_JOINED 0x83  /* no TLV */
+
+/* TLV types */
+#define BIN_TLV_STATUS    0x01  /* 1 byte, an ATEerror_t */
+#define BIN_TLV_TEXT      0x02  /* the chars, not null terminated */
+#define BIN_TLV_PORT      0x03  /* 1 byte */
+#define BIN_TLV_DATA      0x04  /* the payload bytes */
+#define BIN_TLV_CONFIRMED 0x05  /* 1 byte, 0 or 1 */
+#define BIN_TLV_RSSI      0x06  /* 2 bytes, signed, MSB first */
+#define BIN_TLV_SNR       0x07  /* 1 byte, signed */
+#define BIN_TLV_ACK       0x08  /* 1 byte, 0 or 1 */
+
+/* Max size of a frame from Id to CRC16, before its COBS encoding:
+   an EVT_RX with 242 bytes of data, or a RESPONSE with 255 chars of text */
+#define BIN_FRAME_SIZE    264
+
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+/**
+ * @brief  Switches the com port to the binary frames
+ * @param  None
+ * @retval None
+ */
+void BIN_Enter(void);
+
+/**
+ * @brief  Tells if the com port carries binary frames
+ * @param  None
+ * @retval true in binary mode
+ */
+bool BIN_IsActive(void);
+
+/**
+ * @brief  Processes a byte received in binary mode
+ * @note   A frame is processed on its final 0x00
+ * @param  The received byte
+ * @retval None
+ */
+void BIN_Receive(uint8_t c);
+
+/**
+ * @brief  Sends the received data event
+ * @param  Application port
+ * @param  Buffer of the received data
+ * @param  Size of the received data
+ * @param  Rssi of the received packet
+ * @param  Snr of the received packet
+ * @retval None
+ */
+void BIN_EventRx(uint8_t AppPort, const uint8_t *Buff, uint8_t BuffSize, int16_t Rssi, int8_t Snr);
+
+/**
+ * @brief  Sends the end of transmission event
+ * @param  true if the transmission succeeded
+ * @param  true if the network acknowledged a confirmed uplink
+ * @retval None
+ */
+void BIN_EventTxDone(bool Success, bool AckReceived);
+
+/**
+ * @brief  Sends the network joined event
+ * @param  None
+ * @retval None
+ */
+void BIN_EventJoined(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BINMODE_H__*/
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -52,6 +52,8 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include "at.h"
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 /* External variables --------------------------------------------------------*/
@@ -78,6 +80,14 @@ void CMD_Init(void);
  */
 void CMD_Process(void);
 
+/**
+ * @brief Runs a command line without printing its status
+ *
+ * @param [IN] The command line, starting with AT, null terminated
+ * @retval The status of the command
+ */
+ATEerror_t CMD_Run(const char *cmd);
+
 #ifdef __cplusplus
 }
 #endif
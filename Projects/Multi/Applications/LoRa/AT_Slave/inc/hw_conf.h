@@ -128,6 +128,17 @@
 /* uncomment below line to never enter lowpower modes in main.c*/
 //#define LOW_POWER_DISABLE
 
+/* uncomment below line to measure the critical sections durations (cs_profiler.h),
+   results are read with AT+CSPROF*/
+//#define CS_PROFILER
+
+/* uncomment below line to move the long radio SPI transfers to the DMA (hw_spi.c)*/
+//#define SPI_DMA
+
+/* uncomment below line to choose what vcom_Send does when its tx buffer is full (vcom.h),
+   VCOM_TX_BLOCK by default*/
+//#define VCOM_TX_POLICY VCOM_TX_DROP
+
 /* debug swicthes in bsp.c */
 //#define SENSOR_ENABLED
 
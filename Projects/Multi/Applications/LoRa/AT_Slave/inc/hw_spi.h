@@ -115,6 +115,17 @@ void HW_SPI_IoDeInit(void);
  */
 uint16_t HW_SPI_InOut(uint16_t outData);
 
+/**
+ * @brief Sends and receives a block of bytes in a single SPI transaction
+ *
+ * @param  [IN] txData Data to be sent, NULL to clock out zeros
+ * @param  [OUT] rxData Received data, NULL to discard it
+ * @param  [IN] size Number of bytes to transfer
+ * @retval None
+ * @note With SPI_DMA defined, transfers above a threshold use the DMA
+ */
+void HW_SPI_Transfer(uint8_t *txData, uint8_t *rxData, uint16_t size);
+
 
 
 #ifdef __cplusplus
@@ -217,6 +217,14 @@ typedef struct sLoRaMainCallback
  * @param [IN] length is the number of recieved bytes
  */
     void ( *LORA_ConfirmClass) ( DeviceClass_t Class );
+/*!
+ * @brief Confirms the end of an uplink
+ *
+ * @param [IN] Status LORA_SUCCESS if the uplink has been sent
+ *
+ * @param [IN] AckReceived true if the network acknowledged a confirmed uplink
+ */
+    void ( *LORA_TxDone) ( LoraErrorStatus Status, bool AckReceived );
   
 } LoRaMainCallback_t;
 
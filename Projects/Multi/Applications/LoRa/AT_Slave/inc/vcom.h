@@ -58,6 +58,14 @@ extern "C" {
 /* Exported constants --------------------------------------------------------*/
 /* Character added when a RX error has been detected */
 #define AT_ERROR_RX_CHAR 0x01
+
+/* What vcom_Send does with a string the tx buffer cannot take */
+#define VCOM_TX_DROP      0   /* drops the string */
+#define VCOM_TX_BLOCK     1   /* waits for room, drops the string when called from an interrupt */
+#define VCOM_TX_OVERWRITE 2   /* discards the oldest lines not being sent yet */
+#ifndef VCOM_TX_POLICY
+#define VCOM_TX_POLICY    VCOM_TX_BLOCK
+#endif
 /* External variables --------------------------------------------------------*/
 
 /* Exported functions ------------------------------------------------------- */
@@ -99,11 +107,53 @@ void vcom_IoDeInit(void);
 
 /**
  * @brief  Sends string on com port
+ * @note   The string is formatted straight in the tx buffer, at most MAX_PRINT_SIZE chars
+ *         with the final '\0'. When it does not fit, VCOM_TX_POLICY applies
  * @param  String
  * @retval None
  */
 void vcom_Send(const char *format, ...);
 
+/**
+ * @brief  Gets the count of strings vcom_Send has dropped and of lines it has discarded
+ * @param  None
+ * @retval Returns the count since the start
+ */
+uint32_t vcom_GetDropCount(void);
+
+/**
+ * @brief  Sends raw bytes on com port
+ * @param  Buffer to send
+ * @param  Buffer length
+ * @retval None
+ */
+void vcom_Write(const uint8_t *buf, uint16_t len);
+
+/**
+ * @brief  Sends bytes on com port as lower case hex digits
+ * @param  Buffer to send
+ * @param  Buffer length
+ * @retval None
+ */
+void vcom_WriteHex(const uint8_t *buf, uint16_t len);
+
+/**
+ * @brief  Captures the text of vcom_Send and vcom_WriteHex instead of sending it
+ * @note   vcom_Write still sends on com port
+ * @param  Capture buffer, NULL to drop the text
+ * @param  Capture buffer size, the text is truncated to it. The buffer holds
+ *         one more char for the final '\0' of vcom_Send
+ * @retval None
+ */
+void vcom_CaptureStart(char *buf, uint16_t size);
+
+/**
+ * @brief  Sends the text on com port again
+ * @param  None
+ * @retval Returns the count of chars captured since vcom_CaptureStart
+ */
+uint16_t vcom_CaptureStop(void);
+
 /**
  * @brief  Checks if a new character has been received on com port
  * @param  None
@@ -58,6 +58,7 @@
 #include "version.h"
 #include "hw_msp.h"
 #include "test_rf.h"
+#include "binmode.h"
 
 /* External variables --------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
@@ -80,7 +81,7 @@
 /*!
  * User application data buffer size
  */
-#define LORAWAN_APP_DATA_BUFF_SIZE                           64
+#define LORAWAN_APP_DATA_BUFF_SIZE                           242
 
 /*!
  * User application data
@@ -106,6 +107,20 @@ static unsigned ReceivedDataSize = 0;
  */
 static uint8_t ReceivedDataPort;
 
+/**
+ * @brief Value of the hex digits from '0' to 'f', 0xFF for the other chars
+ */
+static const uint8_t HexNibble['f' - '0' + 1] =
+{
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,             /* 0-9 */
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,                               /* :-@ */
+  0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,                                     /* A-F */
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, /* G-R */
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, /* S-^ */
+  0xFF, 0xFF,                                                             /* _-` */
+  0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,                                     /* a-f */
+};
+
 /* Private function prototypes -----------------------------------------------*/
 /**
  * @brief  Translate a LoRaMacStatus_t into an ATEerror_t
@@ -165,6 +180,15 @@ static void print_d(int value);
  */
 static void print_u(unsigned int value);
 
+/**
+ * @brief  Decode hex digits into bytes
+ * @param  The hex digits, two per byte
+ * @param  The number of hex digits
+ * @param  The buffer that will contain the bytes
+ * @retval 0 if all the digits are valid, -1 otherwise
+ */
+static int decode_hex(const char *from, unsigned size, uint8_t *pt);
+
 /* Exported functions ------------------------------------------------------- */
 
 void set_at_receive(uint8_t AppPort, uint8_t* Buff, uint8_t BuffSize)
@@ -333,6 +357,50 @@ ATEerror_t at_Certif( const char *param )
   return AT_OK;
 }
 
+ATEerror_t at_BinMode(const char *param)
+{
+  /* the frames start after the status of this command */
+  BIN_Enter();
+  return AT_OK;
+}
+
+#ifdef CS_PROFILER
+ATEerror_t at_CsProfiler_get(const char *param)
+{
+  const CSP_Site_t *site;
+  uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+  uint8_t i;
+
+  for (site = CSP_GetSites(); site != NULL; site = site->Next)
+  {
+    AT_PRINTF("%s:%u %lu %lu(%luus)", site->File, site->Line, site->Count,
+              site->Max, site->Max / cyclesPerUs);
+    for (i = 0; i < CSP_NB_BINS; i++)
+    {
+      AT_PRINTF(" %lu", site->Histogram[i]);
+    }
+    AT_PRINTF("\r\n");
+  }
+  return AT_OK;
+}
+
+ATEerror_t at_CsProfiler_set(const char *param)
+{
+  if ((param[0] != '0') || (param[1] != '\0'))
+  {
+    return AT_PARAM_ERROR;
+  }
+  CSP_Reset();
+  return AT_OK;
+}
+
+ATEerror_t at_CsProfiler_run(const char *param)
+{
+  CSP_Dump(vcom_Write);
+  return AT_OK;
+}
+#endif
+
 ATEerror_t at_ADR_get(const char *param)
 {
   MibRequestConfirm_t mib;
@@ -840,10 +908,8 @@ ATEerror_t at_SendBinary(const char *param)
 {
   LoraErrorStatus status;
   const char *buf= param;
-  unsigned char bufSize= strlen(param);
+  unsigned bufSize= strlen(param);
   uint32_t appPort;
-  unsigned size=0;
-  char hex[3];
   
     /* read and set the application port */
   if (1 != tiny_sscanf(buf, "%u:", &appPort))
@@ -871,24 +937,16 @@ ATEerror_t at_SendBinary(const char *param)
     bufSize --;
   }
 
-  hex[2] = 0;
-  while ((size < LORAWAN_APP_DATA_BUFF_SIZE) && (bufSize > 1))
+  if (((bufSize % 2) != 0) || (bufSize > (LORAWAN_APP_DATA_BUFF_SIZE * 2)))
   {
-    hex[0] = buf[size*2];
-    hex[1] = buf[size*2+1];
-    if (tiny_sscanf(hex, "%hhx", &AppData.Buff[size]) != 1)
-    {
-      return AT_PARAM_ERROR;
-    }
-    size++;
-    bufSize -= 2;
+    return AT_PARAM_ERROR;
   }
-  if (bufSize != 0)
+  if (decode_hex(buf, bufSize, AppData.Buff) != 0)
   {
     return AT_PARAM_ERROR;
   }
   
-  AppData.BuffSize = size;
+  AppData.BuffSize = bufSize / 2;
   AppData.Port= appPort;
 
   status = LORA_send( &AppData, lora_config_reqack_get() );
@@ -958,13 +1016,8 @@ ATEerror_t at_Send(const char *param)
 
 ATEerror_t at_ReceiveBinary(const char *param)
 {
-  unsigned i;
-  
   AT_PRINTF("%d:", ReceivedDataPort);
-  for (i = 0; i < ReceivedDataSize; i++)
-  {
-    AT_PRINTF("%02x", ReceivedData[i]);
-  }
+  vcom_WriteHex((uint8_t *)ReceivedData, ReceivedDataSize);
   AT_PRINTF("\r\n");
   ReceivedDataSize = 0;
 
@@ -1146,3 +1199,24 @@ static void print_u(unsigned int value)
 {
   AT_PRINTF("%u\r\n", value);
 }
+
+static int decode_hex(const char *from, unsigned size, uint8_t *pt)
+{
+  uint8_t high;
+  uint8_t low;
+  uint8_t c;
+
+  for (; size >= 2; size -= 2)
+  {
+    c = *from++ - '0';
+    high = (c < sizeof(HexNibble)) ? HexNibble[c] : 0xFF;
+    c = *from++ - '0';
+    low = (c < sizeof(HexNibble)) ? HexNibble[c] : 0xFF;
+    if ((high | low) > 0x0F)
+    {
+      return -1;
+    }
+    *pt++ = (high << 4) | low;
+  }
+  return 0;
+}
@@ -0,0 +1,567 @@
+/**
+ ******************************************************************************
+ * @file    binmode.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Binary framed transport of the AT interface
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "hw.h"
+#include "at.h"
+#include "command.h"
+#include "lora.h"
+#include "binmode.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  States of the binary mode
+ */
+typedef enum
+{
+  BIN_OFF = 0,   /* text AT commands */
+  BIN_ENTERING,  /* AT+BINMODE accepted, its status still to be printed */
+  BIN_ON,        /* binary frames, the text output is dropped */
+} BinState_t;
+
+/**
+ * @brief  A frame being built, from Id to CRC16
+ */
+typedef struct
+{
+  uint8_t buff[BIN_FRAME_SIZE];
+  uint16_t size;
+} BinFrame_t;
+
+/* Private define ------------------------------------------------------------*/
+/**
+ * @brief  Max size of a COBS encoded frame, with its final 0x00
+ */
+#define BIN_COBS_SIZE (BIN_FRAME_SIZE + (BIN_FRAME_SIZE / 254) + 2)
+
+/**
+ * @brief  Size of Id, Seq and CRC16, the smallest frame
+ */
+#define BIN_FRAME_MIN 4
+
+/**
+ * @brief  Position of the text in the response to BIN_ID_AT, after Id, Seq and the TLV header
+ */
+#define BIN_TEXT_POS  4
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static BinState_t BinState = BIN_OFF;
+
+/**
+ * @brief  Received frame, COBS encoded then decoded in place
+ */
+static uint8_t RxFrame[BIN_COBS_SIZE];
+static uint16_t RxFrameSize = 0;
+
+/**
+ * @brief  The frame being received is dropped at its 0x00: it overflowed, or it is
+ *         the end of the AT+BINMODE line
+ */
+static bool RxDiscard = false;
+
+/**
+ * @brief  Responses and events are built apart, events may be sent while a command runs
+ */
+static BinFrame_t Response;
+static BinFrame_t Event;
+
+/**
+ * @brief  COBS encoded frame being sent
+ */
+static uint8_t TxCobs[BIN_COBS_SIZE];
+
+/**
+ * @brief  CRC16-CCITT of each nibble, poly 0x1021
+ */
+static const uint16_t Crc16Nibble[16] =
+{
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+/**
+ * @brief  Leaves BIN_ENTERING once the status of AT+BINMODE has been printed
+ * @param  None
+ * @retval None
+ */
+static void bin_start(void);
+
+/**
+ * @brief  Computes the CRC16-CCITT of a buffer, init 0xFFFF
+ * @param  The buffer
+ * @param  The size of the buffer
+ * @retval The CRC
+ */
+static uint16_t crc16(const uint8_t *buf, uint16_t size);
+
+/**
+ * @brief  COBS encodes a buffer
+ * @param  The buffer to encode
+ * @param  The size of the buffer, at most BIN_FRAME_SIZE
+ * @param  The encoded buffer, at least BIN_COBS_SIZE - 1 bytes
+ * @retval The size of the encoded buffer, without the final 0x00
+ */
+static uint16_t cobs_encode(const uint8_t *from, uint16_t size, uint8_t *to);
+
+/**
+ * @brief  COBS decodes a buffer in place
+ * @param  The buffer to decode, without its final 0x00
+ * @param  The size of the buffer
+ * @retval The size of the decoded buffer, -1 if it is not valid COBS
+ */
+static int cobs_decode(uint8_t *buf, uint16_t size);
+
+/**
+ * @brief  Starts a frame
+ * @param  The frame
+ * @param  The frame Id
+ * @param  The frame sequence number
+ * @retval None
+ */
+static void frame_start(BinFrame_t *frame, uint8_t id, uint8_t seq);
+
+/**
+ * @brief  Appends a TLV to a frame, drops it when the frame is full
+ * @param  The frame
+ * @param  The TLV type
+ * @param  The TLV value
+ * @param  The TLV length
+ * @retval None
+ */
+static void frame_add(BinFrame_t *frame, uint8_t type, const uint8_t *value, uint8_t len);
+
+/**
+ * @brief  Appends the CRC16 to a frame and sends it COBS encoded
+ * @param  The frame
+ * @retval None
+ */
+static void frame_send(BinFrame_t *frame);
+
+/**
+ * @brief  Looks a TLV up in the TLVs of a received frame
+ * @param  The TLVs
+ * @param  The size of the TLVs
+ * @param  The TLV type
+ * @param  The TLV length, set when found
+ * @retval The TLV value, NULL if not found or if the TLVs are malformed
+ */
+static uint8_t *find_tlv(uint8_t *tlv, uint16_t size, uint8_t type, uint8_t *len);
+
+/**
+ * @brief  Runs a received frame and sends its response
+ * @param  The frame, CRC16 checked
+ * @param  The size of the frame, without the CRC16
+ * @retval None
+ */
+static void process_frame(uint8_t *frame, uint16_t size);
+
+/**
+ * @brief  Runs a text AT command, its output captured in the response
+ * @param  The TLVs of the frame
+ * @param  The size of the TLVs
+ * @retval The status of the command
+ */
+static ATEerror_t run_at(uint8_t *tlv, uint16_t size);
+
+/**
+ * @brief  Sends data on the LoRa network
+ * @param  The TLVs of the frame
+ * @param  The size of the TLVs
+ * @retval The status of the command
+ */
+static ATEerror_t run_send(uint8_t *tlv, uint16_t size);
+
+/* Exported functions ---------------------------------------------------------*/
+
+void BIN_Enter(void)
+{
+  if (BinState == BIN_OFF)
+  {
+    /* the status of AT+BINMODE is still printed as text */
+    BinState = BIN_ENTERING;
+    /* the <lf> after the <cr> of the command comes next, the host sends a 0x00 before its frames */
+    RxFrameSize = 0;
+    RxDiscard = true;
+  }
+}
+
+bool BIN_IsActive(void)
+{
+  return (BinState != BIN_OFF);
+}
+
+void BIN_Receive(uint8_t c)
+{
+  int size;
+
+  bin_start();
+
+  if (c != 0)
+  {
+    if (RxFrameSize < sizeof(RxFrame))
+    {
+      RxFrame[RxFrameSize++] = c;
+    }
+    else
+    {
+      RxDiscard = true;
+    }
+    return;
+  }
+
+  /* end of frame, the bad ones are dropped and the host times out */
+  size = (RxDiscard == true) ? -1 : cobs_decode(RxFrame, RxFrameSize);
+  RxFrameSize = 0;
+  RxDiscard = false;
+
+  if (size < BIN_FRAME_MIN)
+  {
+    return;
+  }
+  size -= 2;
+  if (crc16(RxFrame, size) != ((RxFrame[size] << 8) | RxFrame[size + 1]))
+  {
+    return;
+  }
+  process_frame(RxFrame, size);
+}
+
+void BIN_EventRx(uint8_t AppPort, const uint8_t *Buff, uint8_t BuffSize, int16_t Rssi, int8_t Snr)
+{
+  uint8_t rssi[2] = { (uint8_t)(Rssi >> 8), (uint8_t) Rssi };
+
+  if (BinState == BIN_OFF)
+  {
+    return;
+  }
+  bin_start();
+
+  frame_start(&Event, BIN_ID_EVT_RX, 0);
+  frame_add(&Event, BIN_TLV_PORT, &AppPort, 1);
+  frame_add(&Event, BIN_TLV_DATA, Buff, BuffSize);
+  frame_add(&Event, BIN_TLV_RSSI, rssi, 2);
+  frame_add(&Event, BIN_TLV_SNR, (const uint8_t *) &Snr, 1);
+  frame_send(&Event);
+}
+
+void BIN_EventTxDone(bool Success, bool AckReceived)
+{
+  uint8_t status = (Success == true) ? AT_OK : AT_ERROR;
+  uint8_t ack = (AckReceived == true) ? 1 : 0;
+
+  if (BinState == BIN_OFF)
+  {
+    return;
+  }
+  bin_start();
+
+  frame_start(&Event, BIN_ID_EVT_TXDONE, 0);
+  frame_add(&Event, BIN_TLV_STATUS, &status, 1);
+  frame_add(&Event, BIN_TLV_ACK, &ack, 1);
+  frame_send(&Event);
+}
+
+void BIN_EventJoined(void)
+{
+  if (BinState == BIN_OFF)
+  {
+    return;
+  }
+  bin_start();
+
+  frame_start(&Event, BIN_ID_EVT_JOINED, 0);
+  frame_send(&Event);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void bin_start(void)
+{
+  if (BinState == BIN_ENTERING)
+  {
+    /* the traces would corrupt the frames, drop them */
+    vcom_CaptureStart(NULL, 0);
+    BinState = BIN_ON;
+  }
+}
+
+static uint16_t crc16(const uint8_t *buf, uint16_t size)
+{
+  uint16_t crc = 0xFFFF;
+
+  while (size-- > 0)
+  {
+    crc = (crc << 4) ^ Crc16Nibble[(crc >> 12) ^ (*buf >> 4)];
+    crc = (crc << 4) ^ Crc16Nibble[(crc >> 12) ^ (*buf & 0x0F)];
+    buf++;
+  }
+  return crc;
+}
+
+static uint16_t cobs_encode(const uint8_t *from, uint16_t size, uint8_t *to)
+{
+  uint16_t code = 0;  /* index of the code byte of the current block */
+  uint16_t iw = 1;
+
+  while (size-- > 0)
+  {
+    if (*from == 0)
+    {
+      to[code] = iw - code;
+      code = iw++;
+    }
+    else
+    {
+      to[iw++] = *from;
+      if ((iw - code) == 0xFF)
+      {
+        /* 254 non zero bytes, the block ends without a zero */
+        to[code] = 0xFF;
+        code = iw++;
+      }
+    }
+    from++;
+  }
+  to[code] = iw - code;
+  return iw;
+}
+
+static int cobs_decode(uint8_t *buf, uint16_t size)
+{
+  uint16_t ir = 0;
+  uint16_t iw = 0;
+  uint8_t code;
+  uint8_t i;
+
+  /* iw stays behind ir, the decoding can be done in place */
+  while (ir < size)
+  {
+    code = buf[ir++];
+    if ((ir + code - 1) > size)
+    {
+      return -1;
+    }
+    for (i = 1; i < code; i++)
+    {
+      buf[iw++] = buf[ir++];
+    }
+    /* a block shorter than 254 bytes ends with a zero, but the last one */
+    if ((code != 0xFF) && (ir < size))
+    {
+      buf[iw++] = 0;
+    }
+  }
+  return iw;
+}
+
+static void frame_start(BinFrame_t *frame, uint8_t id, uint8_t seq)
+{
+  frame->buff[0] = id;
+  frame->buff[1] = seq;
+  frame->size = 2;
+}
+
+static void frame_add(BinFrame_t *frame, uint8_t type, const uint8_t *value, uint8_t len)
+{
+  /* keep room for the CRC16 */
+  if ((frame->size + 2 + len + 2) > BIN_FRAME_SIZE)
+  {
+    return;
+  }
+  frame->buff[frame->size++] = type;
+  frame->buff[frame->size++] = len;
+  memcpy1(&frame->buff[frame->size], value, len);
+  frame->size += len;
+}
+
+static void frame_send(BinFrame_t *frame)
+{
+  uint16_t crc = crc16(frame->buff, frame->size);
+  uint16_t size;
+
+  frame->buff[frame->size++] = crc >> 8;
+  frame->buff[frame->size++] = crc & 0xFF;
+
+  size = cobs_encode(frame->buff, frame->size, TxCobs);
+  TxCobs[size++] = 0;
+  vcom_Write(TxCobs, size);
+}
+
+static uint8_t *find_tlv(uint8_t *tlv, uint16_t size, uint8_t type, uint8_t *len)
+{
+  while (size >= 2)
+  {
+    if ((2 + tlv[1]) > size)
+    {
+      return NULL;
+    }
+    if (tlv[0] == type)
+    {
+      *len = tlv[1];
+      return &tlv[2];
+    }
+    size -= 2 + tlv[1];
+    tlv += 2 + tlv[1];
+  }
+  return NULL;
+}
+
+static void process_frame(uint8_t *frame, uint16_t size)
+{
+  uint8_t id = frame[0];
+  uint8_t seq = frame[1];
+  uint8_t status;
+
+  frame_start(&Response, BIN_ID_RESPONSE, seq);
+
+  switch (id)
+  {
+    case BIN_ID_AT:
+      status = run_at(&frame[2], size - 2);
+      break;
+    case BIN_ID_SEND:
+      status = run_send(&frame[2], size - 2);
+      break;
+    case BIN_ID_JOIN:
+      LORA_Join();
+      status = AT_OK;
+      break;
+    case BIN_ID_EXIT:
+      status = AT_OK;
+      break;
+    default:
+      status = AT_ERROR;
+      break;
+  }
+
+  frame_add(&Response, BIN_TLV_STATUS, &status, 1);
+  frame_send(&Response);
+
+  if (id == BIN_ID_EXIT)
+  {
+    /* the traces are printed again */
+    vcom_CaptureStop();
+    BinState = BIN_OFF;
+  }
+}
+
+static ATEerror_t run_at(uint8_t *tlv, uint16_t size)
+{
+  ATEerror_t status;
+  uint8_t *text;
+  uint8_t len;
+  uint16_t captured;
+  uint16_t room = BIN_FRAME_SIZE - BIN_TEXT_POS - 3 - 2;
+
+  text = find_tlv(tlv, size, BIN_TLV_TEXT, &len);
+  if (text == NULL)
+  {
+    return AT_PARAM_ERROR;
+  }
+  /* the CRC16 at least follows the text, it has been checked and can be overwritten */
+  text[len] = '\0';
+
+  /* the output of the command is captured straight in the TEXT TLV of the response,
+     its final '\0' lands where the STATUS TLV goes next */
+  if (room > 255)
+  {
+    room = 255;
+  }
+  vcom_CaptureStop();
+  vcom_CaptureStart((char *) &Response.buff[BIN_TEXT_POS], room);
+  status = CMD_Run((const char *) text);
+  captured = vcom_CaptureStop();
+  vcom_CaptureStart(NULL, 0);
+
+  if (captured > 0)
+  {
+    Response.buff[Response.size++] = BIN_TLV_TEXT;
+    Response.buff[Response.size++] = captured;
+    Response.size += captured;
+  }
+  return status;
+}
+
+static ATEerror_t run_send(uint8_t *tlv, uint16_t size)
+{
+  lora_AppData_t AppData;
+  LoraConfirm_t confirmed = lora_config_reqack_get();
+  uint8_t *value;
+  uint8_t len;
+
+  value = find_tlv(tlv, size, BIN_TLV_PORT, &len);
+  if ((value == NULL) || (len != 1))
+  {
+    return AT_PARAM_ERROR;
+  }
+  AppData.Port = value[0];
+
+  value = find_tlv(tlv, size, BIN_TLV_CONFIRMED, &len);
+  if ((value != NULL) && (len == 1))
+  {
+    confirmed = (value[0] != 0) ? LORAWAN_CONFIRMED_MSG : LORAWAN_UNCONFIRMED_MSG;
+  }
+
+  /* the MAC copies the payload, it is sent from the received frame */
+  AppData.Buff = find_tlv(tlv, size, BIN_TLV_DATA, &len);
+  if (AppData.Buff == NULL)
+  {
+    return AT_PARAM_ERROR;
+  }
+  AppData.BuffSize = len;
+
+  if (LORA_send(&AppData, confirmed) != LORA_SUCCESS)
+  {
+    return AT_ERROR;
+  }
+  return AT_OK;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
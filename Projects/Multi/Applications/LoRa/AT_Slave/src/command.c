@@ -49,6 +49,7 @@
 #include "at.h"
 #include "hw.h"
 #include "command.h"
+#include "binmode.h"
 
 /* comment the following to have help message */
 /* #define NO_HELP */
@@ -70,7 +71,7 @@ struct ATCommand_s {
 };
 
 /* Private define ------------------------------------------------------------*/
-#define CMD_SIZE 128
+#define CMD_SIZE 512
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -565,8 +566,41 @@ static const struct ATCommand_s ATCommand[] =
     .set = at_return_error,
     .run = at_Certif,
   },
+
+  {
+    .string = AT_BINMODE,
+    .size_string = sizeof(AT_BINMODE) - 1,
+#ifndef NO_HELP
+    .help_string = "AT"AT_BINMODE ": Switch to the binary frames (COBS, CRC16), until their EXIT command\r\n",
+#endif
+    .get = at_return_error,
+    .set = at_return_error,
+    .run = at_BinMode,
+  },
+#ifdef CS_PROFILER
+  {
+    .string = AT_CSPROF,
+    .size_string = sizeof(AT_CSPROF) - 1,
+#ifndef NO_HELP
+    .help_string = "AT"AT_CSPROF ": Get (=?) or reset (=0) the critical sections statistics, binary dump (run)\r\n",
+#endif
+    .get = at_CsProfiler_get,
+    .set = at_CsProfiler_set,
+    .run = at_CsProfiler_run,
+  },
+#endif
 };
 
+/**
+ * @brief  Number of supported AT Commands
+ */
+#define AT_COMMAND_NB (sizeof(ATCommand) / sizeof(struct ATCommand_s))
+
+/**
+ * @brief  Indexes in ATCommand sorted by command size then string, built by CMD_Init
+ */
+static uint8_t ATCommandIndex[AT_COMMAND_NB];
+
 
 /* Private function prototypes -----------------------------------------------*/
 
@@ -584,10 +618,42 @@ static void com_error(ATEerror_t error_type);
  */
 static void parse_cmd(const char *cmd);
 
+/**
+ * @brief  Parse a command and run it, without printing its status
+ * @param  The command
+ * @retval The status of the command
+ */
+static ATEerror_t run_cmd(const char *cmd);
+
+/**
+ * @brief  Compares a command with a token, size first so that most commands differ on it
+ * @param  The command
+ * @param  The token, not null terminated
+ * @param  The size of the token
+ * @retval <0, 0 or >0 as the command sorts before, as or after the token
+ */
+static int compare_cmd(const struct ATCommand_s *command, const char *token, int size);
+
+/**
+ * @brief  Sorts ATCommandIndex
+ * @param  None
+ * @retval None
+ */
+static void sort_cmd(void);
+
+/**
+ * @brief  Looks a command token up in ATCommandIndex
+ * @param  The token, not null terminated
+ * @param  The size of the token
+ * @retval The command, NULL if not supported
+ */
+static const struct ATCommand_s *find_cmd(const char *token, int size);
+
 /* Exported functions ---------------------------------------------------------*/
 
 void CMD_Init(void)
 {
+  sort_cmd();
   vcom_Init();
   vcom_ReceiveInit();
 }
@@ -600,6 +666,13 @@ void CMD_Process(void)
   /* Process all commands */
   while (IsNewCharReceived() == SET)
   {
+    if (BIN_IsActive())
+    {
+      /* any byte may be in a frame, AT_ERROR_RX_CHAR included: the CRC16 catches the rx errors */
+      BIN_Receive(GetNewChar());
+      continue;
+    }
+
     command[i] = GetNewChar();
 
 #if 0 /* echo On    */
@@ -635,6 +708,11 @@ void CMD_Process(void)
   }
 }
 
+ATEerror_t CMD_Run(const char *cmd)
+{
+  return run_cmd(cmd);
+}
+
 /* Private functions ---------------------------------------------------------*/
 
 static void com_error(ATEerror_t error_type)
@@ -648,6 +726,11 @@ static void com_error(ATEerror_t error_type)
 
 
 static void parse_cmd(const char *cmd)
+{
+  com_error(run_cmd(cmd));
+}
+
+static ATEerror_t run_cmd(const char *cmd)
 {
   ATEerror_t status = AT_OK;
   const struct ATCommand_s *Current_ATCommand;
@@ -682,48 +765,100 @@ static void parse_cmd(const char *cmd)
     /* point to the start of the command, excluding AT */
     status = AT_ERROR;
     cmd += 2;
-    for (i = 0; i < (sizeof(ATCommand) / sizeof(struct ATCommand_s)); i++)
+    /* the command token ends on its parameters, its help request or the end of line */
+    for (i = 0; (cmd[i] != '\0') && (cmd[i] != '=') && (cmd[i] != '?'); i++)
+    {
+    }
+    Current_ATCommand = find_cmd(cmd, i);
+    if (Current_ATCommand != NULL)
     {
-      if (strncmp(cmd, ATCommand[i].string, ATCommand[i].size_string) == 0)
+      /* point to the string after the command to parse it */
+      cmd += Current_ATCommand->size_string;
+
+      /* parse after the command */
+      switch (cmd[0])
       {
-        Current_ATCommand = &(ATCommand[i]);
-        /* point to the string after the command to parse it */
-        cmd += Current_ATCommand->size_string;
-
-        /* parse after the command */
-        switch (cmd[0])
-        {
-          case '\0':    /* nothing after the command */
-            status = Current_ATCommand->run(cmd);
-            break;
-          case '=':
-            if ((cmd[1] == '?') && (cmd[2] == '\0'))
-            {
-              status = Current_ATCommand->get(cmd + 1);
-            }
-            else
-            {
-              status = Current_ATCommand->set(cmd + 1);
-            }
-            break;
-          case '?':
-#ifndef NO_HELP
-            AT_PRINTF(Current_ATCommand->help_string);
-#endif
-            status = AT_OK;
-            break;
-          default:
-            /* not recognized */
-            break;
-        }
-
-        /* we end the loop as the command was found */
-        break;
+        case '\0':    /* nothing after the command */
+          status = Current_ATCommand->run(cmd);
+          break;
+        case '=':
+          if ((cmd[1] == '?') && (cmd[2] == '\0'))
+          {
+            status = Current_ATCommand->get(cmd + 1);
+          }
+          else
+          {
+            status = Current_ATCommand->set(cmd + 1);
+          }
+          break;
+        case '?':
+#ifndef NO_HELP
+          AT_PRINTF(Current_ATCommand->help_string);
+#endif
+          status = AT_OK;
+          break;
+        default:
+          /* not recognized */
+          break;
       }
     }
   }
 
-  com_error(status);
+  return status;
+}
+
+static int compare_cmd(const struct ATCommand_s *command, const char *token, int size)
+{
+  if (command->size_string != size)
+  {
+    return command->size_string - size;
+  }
+  return strncmp(command->string, token, size);
+}
+
+static void sort_cmd(void)
+{
+  int i;
+  int j;
+  uint8_t index;
+
+  /* insertion sort, run once on a few tens of commands */
+  for (i = 0; i < AT_COMMAND_NB; i++)
+  {
+    index = i;
+    for (j = i; (j > 0) && (compare_cmd(&ATCommand[ATCommandIndex[j - 1]], ATCommand[index].string, ATCommand[index].size_string) > 0); j--)
+    {
+      ATCommandIndex[j] = ATCommandIndex[j - 1];
+    }
+    ATCommandIndex[j] = index;
+  }
+}
+
+static const struct ATCommand_s *find_cmd(const char *token, int size)
+{
+  int low = 0;
+  int high = AT_COMMAND_NB - 1;
+  int mid;
+  int diff;
+
+  while (low <= high)
+  {
+    mid = (low + high) / 2;
+    diff = compare_cmd(&ATCommand[ATCommandIndex[mid]], token, size);
+    if (diff == 0)
+    {
+      return &ATCommand[ATCommandIndex[mid]];
+    }
+    if (diff < 0)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid - 1;
+    }
+  }
+  return NULL;
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -163,11 +163,14 @@ void HW_GPIO_SetIrq(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, uint32_t prio, GpioI
 void HW_GPIO_IrqHandler(uint16_t GPIO_Pin)
 {
   uint32_t BitPos = HW_GPIO_GetBitPos(GPIO_Pin);
+  CSP_ISR_ENTER();
 
   if (GpioIrq[ BitPos ]  != NULL)
   {
     GpioIrq[BitPos]();
   }
+
+  CSP_ISR_EXIT();
 }
 
 uint32_t HW_GPIO_Read(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
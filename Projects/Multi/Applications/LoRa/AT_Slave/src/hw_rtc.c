@@ -121,6 +121,9 @@ typedef struct
 #define CONV_NUMER                (MSEC_NUMBER >> COMMON_FACTOR)
 #define CONV_DENOM                (1 << (N_PREDIV_S - COMMON_FACTOR))
 
+/* DR value never read from a running calendar: the date is never 00 */
+#define CALENDAR_DAY_REG_INVALID  ((uint32_t) 0)
+
 #if defined(USE_B_L072Z_LRWAN1)
 #define HW_RTC_EXTI_LINE_ALARM_EVENT LL_EXTI_LINE_17
 #else
@@ -131,12 +134,14 @@ typedef struct
 #define CALENDAR_VALUE(subsec, sec, min, hours, days)  \
   ((((sec) + 60 * ((min) + 60 * ((hours) + 24 * (days)))) << N_PREDIV_S) + (PREDIV_S - (subsec)))
 
-
-#define ADJUST_TIME(_x_, _y_, _t_) \
-  while ((_x_) >= (_t_)) { \
-    (_x_) -= (_t_); \
-    (_y_)++; \
-  }
+/*
+ * Divisions by a constant as a multiplication by its reciprocal: the RTC is
+ * reprogrammed with irqs masked and Cortex-M0+ has no hardware divider.
+ * Exact for X < 86400 (DIV_60, DIV_3600) and X < 2^23 (DIV_86400)
+ */
+#define DIV_60(X)         ((((uint32_t)(X) >> 2) * 17477U) >> 18)
+#define DIV_3600(X)       (((uint32_t)(X) * 37283U) >> 27)
+#define DIV_86400(X)      ((((uint32_t)(X) >> 7) * 49711U) >> 25)
 
 /* Private variables ---------------------------------------------------------*/
 /**
@@ -161,11 +166,6 @@ static int16_t McuWakeUpTimeCal = 0;
  */
 static const uint8_t SecondsInMinute = 60;
 
-/**
- * Number of minutes in an hour
- */
-static const uint8_t MinutesInHour = 60;
-
 /**
  * Number of seconds in an hour
  */
@@ -176,11 +176,6 @@ static const uint16_t SecondsInHour = 3600;
  */
 static const uint32_t SecondsInDay = 86400;
 
-/**
- * Number of hours in a day
- */
-static const uint8_t HoursInDay = 24;
-
 /**
  * Number of days in a standard year
  */
@@ -198,6 +193,16 @@ static const uint8_t DaysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 3
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/**
+ * Calendar date register value CalendarDays was computed for
+ */
+static volatile uint32_t CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+
+/**
+ * Number of days elapsed from 01/01/2000 to the CalendarDayReg date
+ */
+static volatile uint32_t CalendarDays = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 
 /**
@@ -226,8 +231,8 @@ static void HW_RTC_StartWakeUpAlarm(uint32_t timeoutValue);
 
 /**
  * @brief  Get current time from calendar in ticks
- * @param  Pointer to RTC_DateStruct
- * @param  Pointer to RTC_TimeStruct
+ * @param  Pointer to RTC_DateStruct, may be NULL
+ * @param  Pointer to RTC_TimeStruct, may be NULL
  * @retval Time in ticks
  */
 static TimerTime_t HW_RTC_GetCalendarValue(HW_RTC_DateTypeDef *RTC_DateStruct, HW_RTC_TimeTypeDef *RTC_TimeStruct);
@@ -372,20 +377,14 @@ void HW_RTC_SetAlarm(uint32_t timeout)
 
 uint32_t HW_RTC_GetTimerElapsedTime(void)
 {
-  HW_RTC_TimeTypeDef RTC_TimeStruct;
-  HW_RTC_DateTypeDef RTC_DateStruct;
-
-  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(NULL, NULL);
 
   return(( uint32_t )(CalendarValue - RtcTimerContext.Rtc_Time));
 }
 
 uint32_t HW_RTC_GetTimerValue(void)
 {
-  HW_RTC_TimeTypeDef RTC_TimeStruct;
-  HW_RTC_DateTypeDef RTC_DateStruct;
-
-  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct);
+  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(NULL, NULL);
 
   return(CalendarValue);
 }
@@ -506,49 +505,64 @@ static void HW_RTC_StartWakeUpAlarm(uint32_t timeoutValue)
   uint16_t rtcAlarmHours;
   uint16_t rtcAlarmDays;
   uint8_t day_in_month;
+  uint32_t month;
+  uint32_t year;
   HW_RTC_TimeTypeDef RTC_TimeStruct = RtcTimerContext.RTC_Calndr_Time;
   HW_RTC_DateTypeDef RTC_DateStruct = RtcTimerContext.RTC_Calndr_Date;
 
   HW_RTC_StopAlarm();
   DBG_GPIO_SET(GPIOB, GPIO_PIN_13);
 
-  /*reverse counter */
+  /*
+   * fold the timeout and the context time in seconds from 00:00:00 of the
+   * context date, then split it once: the cost is the same for any timeout
+   */
   rtcAlarmSubSeconds =  PREDIV_S - RTC_TimeStruct.SubSeconds;
   rtcAlarmSubSeconds += (timeoutValue & PREDIV_S);
-  /* convert timeout  to seconds */
-  timeoutValue >>= N_PREDIV_S;  /* convert timeout  in seconds */
+  timeoutValue = (timeoutValue >> N_PREDIV_S) + (rtcAlarmSubSeconds >> N_PREDIV_S) +
+                 (uint32_t)RTC_TimeStruct.Seconds +
+                 ((uint32_t)RTC_TimeStruct.Minutes * SecondsInMinute) +
+                 ((uint32_t)RTC_TimeStruct.Hours * SecondsInHour);
+  rtcAlarmSubSeconds &= PREDIV_S;
 
-  /*convert microsecs to RTC format and add to 'Now' */
-  rtcAlarmDays =  RTC_DateStruct.Day;
-  ADJUST_TIME(timeoutValue, rtcAlarmDays, SecondsInDay);
+  /* calc days */
+  rtcAlarmDays = DIV_86400(timeoutValue);
+  timeoutValue -= rtcAlarmDays * SecondsInDay;
+  rtcAlarmDays += RTC_DateStruct.Day;
 
   /* calc hours */
-  rtcAlarmHours = RTC_TimeStruct.Hours;
-  ADJUST_TIME(timeoutValue, rtcAlarmHours, SecondsInHour);
-
-  /* calc minutes */
-  rtcAlarmMinutes = RTC_TimeStruct.Minutes;
-  ADJUST_TIME(timeoutValue, rtcAlarmMinutes, SecondsInMinute);
+  rtcAlarmHours = DIV_3600(timeoutValue);
+  timeoutValue -= rtcAlarmHours * SecondsInHour;
 
-  /* calc seconds */
-  rtcAlarmSeconds =  RTC_TimeStruct.Seconds + timeoutValue;
+  /* calc minutes and seconds */
+  rtcAlarmMinutes = DIV_60(timeoutValue);
+  rtcAlarmSeconds = timeoutValue - rtcAlarmMinutes * SecondsInMinute;
 
-  /***** correct for modulo********/
-  ADJUST_TIME(rtcAlarmSubSeconds, rtcAlarmSeconds, (PREDIV_S + 1));
-  ADJUST_TIME(rtcAlarmSeconds, rtcAlarmMinutes, SecondsInMinute);
-  ADJUST_TIME(rtcAlarmMinutes, rtcAlarmHours, MinutesInHour);
-  ADJUST_TIME(rtcAlarmHours, rtcAlarmDays, HoursInDay);
-
-  /* Day in month, adjusted to take into account leap years */
-  day_in_month = DaysInMonth[RTC_DateStruct.Month - 1];
-  if (((RTC_DateStruct.Year % 4) == 0) && (RTC_DateStruct.Month == 2))
+  /*
+   * wrap the date month by month, result in 1..days in month: the longest
+   * timeout, 2^32 ticks or 48 days, ends two months after the context
+   */
+  month = RTC_DateStruct.Month;
+  year = RTC_DateStruct.Year;
+  while (1)
   {
-    day_in_month++;
-  }
+    /* Day in month, adjusted to take into account leap years */
+    day_in_month = DaysInMonth[month - 1];
+    if (((year % 4) == 0) && (month == 2))
+    {
+      day_in_month++;
+    }
 
-  while (rtcAlarmDays > day_in_month)
-  {
-    rtcAlarmDays = (rtcAlarmDays - day_in_month);
+    if (rtcAlarmDays <= day_in_month)
+    {
+      break;
+    }
+    rtcAlarmDays -= day_in_month;
+    if (++month > 12)
+    {
+      month = 1;
+      year++;
+    }
   }
 
   /* Set RTC_AlarmStructure with calculated values*/
@@ -604,6 +618,9 @@ static TimerTime_t HW_RTC_GetCalendarValue(HW_RTC_DateTypeDef *RTC_DateStruct, H
   uint32_t ssr;
   uint32_t tr;
   uint32_t dr;
+  uint32_t day_reg;
+  uint32_t year;
+  uint32_t month;
   
   /*
    * as shadow registers are not used, we must read RTC->SSR, TR and DR registers
@@ -618,51 +635,76 @@ static TimerTime_t HW_RTC_GetCalendarValue(HW_RTC_DateTypeDef *RTC_DateStruct, H
     dr = RTC->DR;
   } while (ssr != RTC->SSR);
 
-  /* RTC_TimeStruct->SubSeconds = LL_RTC_TIME_GetSubSecond(RTC); */
-  RTC_TimeStruct->SubSeconds = READ_BIT(ssr, RTC_SSR_SS);
-
-  /* RTC_TimeStruct->Hours = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetHour(RTC)); */
-  RTC_TimeStruct->Hours = HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_HT | RTC_TR_HU)) >> 16U));
+  /*
+   * the number of days since 01/01/2000 only changes with DR: it is cached and
+   * the key is read around the value so that a refresh from an irq is not torn
+   */
+  day_reg = CalendarDayReg;
+  nb_days = CalendarDays;
+  if ((day_reg != dr) || (CalendarDayReg != day_reg))
+  {
+    year = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_YT | RTC_DR_YU)) >> 16U));
+    month = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_MT | RTC_DR_MU)) >> 8U));
+
+    /* years (calc valid up to year 2099)*/
+    nb_days = year * DaysInYear;
+    nb_days += (year + 3) / 4;    /* we add 1 day for full-year 00 (which is 2000), 1 day for full-year 2004,...) */
+    /* Day in month, adjusted to take into account leap years */
+    for (i = 0; i < (month - 1); i++)
+    {
+      nb_days += DaysInMonth[i];
+    }
+    if (((year % 4) == 0) && (month >= 3))
+    {
+      nb_days++;
+    }
 
-  /* RTC_TimeStruct->Minutes = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetMinute(RTC)); */
-  RTC_TimeStruct->Minutes = HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_MNT | RTC_TR_MNU)) >>8U));
+    /* days */
+    nb_days += (HW_RTC_Bcd2ToByte((uint8_t)(dr & (RTC_DR_DT | RTC_DR_DU))) - 1);
 
-  /* RTC_TimeStruct->Seconds = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetSecond(RTC)); */
-  RTC_TimeStruct->Seconds = HW_RTC_Bcd2ToByte((uint8_t)(tr & (RTC_TR_ST | RTC_TR_SU)));
+    CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+    CalendarDays = nb_days;
+    CalendarDayReg = dr;
+  }
 
-  /* RTC_TimeStruct->TimeFormat = LL_RTC_TIME_GetFormat(RTC); */
-  RTC_TimeStruct->TimeFormat = READ_BIT(tr, RTC_TR_PM);
+  calendarValue = CALENDAR_VALUE(READ_BIT(ssr, RTC_SSR_SS),
+                                 HW_RTC_Bcd2ToByte((uint8_t)(tr & (RTC_TR_ST | RTC_TR_SU))),
+                                 HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_MNT | RTC_TR_MNU)) >> 8U)),
+                                 HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_HT | RTC_TR_HU)) >> 16U)), nb_days);
 
-  /* RTC_DateStruct->WeekDay = LL_RTC_DATE_GetWeekDay(RTC); */
-  RTC_DateStruct->WeekDay = (uint32_t)(READ_BIT(dr, RTC_DR_WDU) >> RTC_POSITION_DR_WDU);
+  /* the broken down time is only decoded when the caller asks for it */
+  if (RTC_TimeStruct != NULL)
+  {
+    /* RTC_TimeStruct->SubSeconds = LL_RTC_TIME_GetSubSecond(RTC); */
+    RTC_TimeStruct->SubSeconds = READ_BIT(ssr, RTC_SSR_SS);
 
-  /* RTC_DateStruct->Month = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetMonth(RTC)); */
-  RTC_DateStruct->Month = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_MT | RTC_DR_MU)) >> 8U));
+    /* RTC_TimeStruct->Hours = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetHour(RTC)); */
+    RTC_TimeStruct->Hours = HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_HT | RTC_TR_HU)) >> 16U));
 
-  /* RTC_DateStruct->Day = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetDay(RTC)); */
-  RTC_DateStruct->Day = HW_RTC_Bcd2ToByte((uint8_t)(dr & (RTC_DR_DT | RTC_DR_DU)));
+    /* RTC_TimeStruct->Minutes = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetMinute(RTC)); */
+    RTC_TimeStruct->Minutes = HW_RTC_Bcd2ToByte((uint8_t)((tr & (RTC_TR_MNT | RTC_TR_MNU)) >>8U));
 
-  /* RTC_DateStruct->Year = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetYear(RTC)); */
-  RTC_DateStruct->Year = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_YT | RTC_DR_YU)) >> 16U));
+    /* RTC_TimeStruct->Seconds = HW_RTC_Bcd2ToByte(LL_RTC_TIME_GetSecond(RTC)); */
+    RTC_TimeStruct->Seconds = HW_RTC_Bcd2ToByte((uint8_t)(tr & (RTC_TR_ST | RTC_TR_SU)));
 
-  /* years (calc valid up to year 2099)*/
-  nb_days = RTC_DateStruct->Year * DaysInYear;
-  nb_days += (RTC_DateStruct->Year + 3) / 4;    /* we add 1 day for full-year 00 (which is 2000), 1 day for full-year 2004,...) */
-  /* Day in month, adjusted to take into account leap years */
-  for (i = 0; i < (RTC_DateStruct->Month - 1); i++)
-  {
-    nb_days += DaysInMonth[i];
+    /* RTC_TimeStruct->TimeFormat = LL_RTC_TIME_GetFormat(RTC); */
+    RTC_TimeStruct->TimeFormat = READ_BIT(tr, RTC_TR_PM);
   }
-  if (((RTC_DateStruct->Year % 4) == 0) && (RTC_DateStruct->Month >= 3))
+
+  if (RTC_DateStruct != NULL)
   {
-    nb_days++;
-  }
+    /* RTC_DateStruct->WeekDay = LL_RTC_DATE_GetWeekDay(RTC); */
+    RTC_DateStruct->WeekDay = (uint32_t)(READ_BIT(dr, RTC_DR_WDU) >> RTC_POSITION_DR_WDU);
+
+    /* RTC_DateStruct->Month = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetMonth(RTC)); */
+    RTC_DateStruct->Month = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_MT | RTC_DR_MU)) >> 8U));
 
-  /* days */
-  nb_days += (RTC_DateStruct->Day - 1);
+    /* RTC_DateStruct->Day = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetDay(RTC)); */
+    RTC_DateStruct->Day = HW_RTC_Bcd2ToByte((uint8_t)(dr & (RTC_DR_DT | RTC_DR_DU)));
 
-  calendarValue = CALENDAR_VALUE(RTC_TimeStruct->SubSeconds, RTC_TimeStruct->Seconds,
-                                 RTC_TimeStruct->Minutes, RTC_TimeStruct->Hours, nb_days);
+    /* RTC_DateStruct->Year = HW_RTC_Bcd2ToByte(LL_RTC_DATE_GetYear(RTC)); */
+    RTC_DateStruct->Year = HW_RTC_Bcd2ToByte((uint8_t)((dr & (RTC_DR_YT | RTC_DR_YU)) >> 16U));
+  }
 
   return(calendarValue);
 }
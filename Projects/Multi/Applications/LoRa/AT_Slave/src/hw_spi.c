@@ -61,9 +61,19 @@ Maintainer: Miguel Luis and Gregory Cristian
 /* Includes ------------------------------------------------------------------*/
 #include "hw.h"
 #include "utilities.h"
+#ifdef SPI_DMA
+#include "stm32l0xx_ll_dma.h"
+#endif
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#ifdef SPI_DMA
+/**
+ * Transfers of at least this many bytes go through the DMA (channels 2 and 3,
+ * request 1). Below it the channels set-up costs more than the polled loop.
+ */
+#define HW_SPI_DMA_THRESHOLD 32
+#endif
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
@@ -76,6 +86,26 @@ Maintainer: Miguel Luis and Gregory Cristian
  */
 static uint32_t SpiFrequency(uint32_t hz);
 
+#ifdef SPI_DMA
+/**
+ * @brief Runs a transfer through the DMA and waits for its completion
+ *
+ * @param [IN] txData Data to be sent, NULL to clock out zeros
+ * @param [OUT] rxData Received data, NULL to discard it
+ * @param [IN] size Number of bytes to transfer
+ * @retval None
+ */
+static void SpiDmaTransfer(uint8_t *txData, uint8_t *rxData, uint16_t size);
+
+/**
+ * @brief Completion callback of the DMA transfer, releases the channels
+ *
+ * @param [IN] None
+ * @retval None
+ */
+static void SpiDmaCplt(void);
+#endif
+
 /* Exported functions ---------------------------------------------------------*/
 
 void HW_SPI_Init(void)
@@ -191,6 +221,50 @@ uint16_t HW_SPI_InOut(uint16_t txData)
   return rx_data;
 }
 
+void HW_SPI_Transfer(uint8_t *txData, uint8_t *rxData, uint16_t size)
+{
+  uint16_t i;
+  uint8_t data;
+
+#ifdef SPI_DMA
+  if (size >= HW_SPI_DMA_THRESHOLD)
+  {
+    SpiDmaTransfer(txData, rxData, size);
+    return;
+  }
+#endif
+
+  /* Check if the SPI is already enabled. Enable otherwise */
+  if (LL_SPI_IsEnabled(SPI1) == RESET)
+  {
+    LL_SPI_Enable(SPI1);
+  }
+
+  for (i = 0; i < size; i++)
+  {
+    /* TXE is set again once the previous byte has been received */
+    LL_SPI_TransmitData8(SPI1, (txData != NULL) ? txData[i] : 0);
+
+    /* Wait until RXNE flag is set */
+    while (LL_SPI_IsActiveFlag_RXNE(SPI1) == RESET)
+    {
+      ;
+    }
+
+    data = LL_SPI_ReceiveData8(SPI1);
+    if (rxData != NULL)
+    {
+      rxData[i] = data;
+    }
+  }
+
+  /* Wait until Busy flag is reset, once for the whole block */
+  while (LL_SPI_IsActiveFlag_BSY(SPI1) != RESET)
+  {
+    ;
+  }
+}
+
 /* Private functions ---------------------------------------------------------*/
 
 static uint32_t SpiFrequency(uint32_t hz)
@@ -218,5 +292,81 @@ static uint32_t SpiFrequency(uint32_t hz)
   return baudRate;
 }
 
+#ifdef SPI_DMA
+static void SpiDmaTransfer(uint8_t *txData, uint8_t *rxData, uint16_t size)
+{
+  /* source of the zeros and sink of the discarded bytes, not incremented */
+  static uint8_t dummy;
+  LL_DMA_InitTypeDef DMA_InitStruct;
+
+  /*switch dma clock ON*/
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+
+  if (LL_SPI_IsEnabled(SPI1) == RESET)
+  {
+    LL_SPI_Enable(SPI1);
+  }
+
+  /*rx channel: SPI1->DR to rxData*/
+  DMA_InitStruct.Direction = LL_DMA_DIRECTION_PERIPH_TO_MEMORY;
+  DMA_InitStruct.PeriphOrM2MSrcAddress = (uint32_t) &SPI1->DR;
+  DMA_InitStruct.PeriphOrM2MSrcDataSize = LL_DMA_PDATAALIGN_BYTE;
+  DMA_InitStruct.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+  DMA_InitStruct.Mode = LL_DMA_MODE_NORMAL;
+  DMA_InitStruct.MemoryOrM2MDstAddress = (rxData != NULL) ? (uint32_t) rxData : (uint32_t) &dummy;
+  DMA_InitStruct.MemoryOrM2MDstIncMode = (rxData != NULL) ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT;
+  DMA_InitStruct.MemoryOrM2MDstDataSize = LL_DMA_MDATAALIGN_BYTE;
+  DMA_InitStruct.NbData = size;
+  DMA_InitStruct.PeriphRequest = LL_DMA_REQUEST_1;
+  /*a late read overruns the SPI, rx wins the arbitration*/
+  DMA_InitStruct.Priority = LL_DMA_PRIORITY_VERYHIGH;
+  LL_DMA_Init(DMA1, LL_DMA_CHANNEL_2, &DMA_InitStruct);
+
+  /*tx channel: txData to SPI1->DR*/
+  dummy = 0;
+  DMA_InitStruct.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+  DMA_InitStruct.MemoryOrM2MDstAddress = (txData != NULL) ? (uint32_t) txData : (uint32_t) &dummy;
+  DMA_InitStruct.MemoryOrM2MDstIncMode = (txData != NULL) ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT;
+  DMA_InitStruct.Priority = LL_DMA_PRIORITY_HIGH;
+  LL_DMA_Init(DMA1, LL_DMA_CHANNEL_3, &DMA_InitStruct);
+
+  /* The rx transfer complete interrupt is left disabled in the nvic: it only
+     sets the pending bit, which wakes the core from WFE through SEVONPEND.
+     This works as well from the radio irq handlers, which run at the same
+     priority as a dma handler would */
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_2);
+  NVIC_DisableIRQ(DMA1_Channel2_3_IRQn);
+  SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+
+  /* rx request first so that no received byte is missed */
+  LL_SPI_EnableDMAReq_RX(SPI1);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_2);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_3);
+  LL_SPI_EnableDMAReq_TX(SPI1);
+
+  while (LL_DMA_IsActiveFlag_TC2(DMA1) == RESET)
+  {
+    __WFE();
+  }
+
+  SpiDmaCplt();
+}
+
+static void SpiDmaCplt(void)
+{
+  LL_DMA_DisableIT_TC(DMA1, LL_DMA_CHANNEL_2);
+  LL_DMA_ClearFlag_GI2(DMA1);
+  LL_DMA_ClearFlag_GI3(DMA1);
+  NVIC_ClearPendingIRQ(DMA1_Channel2_3_IRQn);
+
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_3);
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_2);
+
+  /* the last byte is received: the bus is idle */
+  LL_SPI_DisableDMAReq_TX(SPI1);
+  LL_SPI_DisableDMAReq_RX(SPI1);
+}
+#endif
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
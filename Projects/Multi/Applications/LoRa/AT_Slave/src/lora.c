@@ -175,6 +175,8 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
                 break;
         }
     }
+    LoRaMainCallbacks->LORA_TxDone( ( mcpsConfirm->Status == LORAMAC_EVENT_INFO_STATUS_OK ) ? LORA_SUCCESS : LORA_ERROR,
+                                    mcpsConfirm->AckReceived );
 }
 
 /*!
@@ -300,6 +302,9 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
   /* init the main call backs*/
   LoRaMainCallbacks = callbacks;
   
+  /* Random seed initialization, for the device address as for the join nonce */
+  srand1( LoRaMainCallbacks->BoardGetRandomSeed( ) );
+  
 #if (STATIC_DEVICE_EUI != 1)
   LoRaMainCallbacks->BoardGetUniqueId( lora_config.DevEui );  
 #endif
@@ -311,8 +316,6 @@ void LORA_Init (LoRaMainCallback_t *callbacks, LoRaParam_t* LoRaParam )
   PRINTF("AppKey= %02X", lora_config.AppKey[0]) ;for(int i=1; i<16; i++) {PRINTF(" %02X", lora_config.AppKey[i]); }; PRINTF("\n\n\r");
 
 #if (STATIC_DEVICE_ADDRESS != 1)
-  // Random seed initialization
-  srand1( LoRaMainCallbacks->BoardGetRandomSeed( ) );
   // Choose a random device address
   DevAddr = randr( 0, 0x01FFFFFF );
 #endif
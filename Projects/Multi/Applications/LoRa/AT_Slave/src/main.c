@@ -62,11 +62,13 @@ Maintainer: Miguel Luis, Gregory Cristian and Wael Guibene
 #include "hw.h"
 #include "low_power_manager.h"
 #include "lora.h"
+#include "lora-test.h"
 #include "timeServer.h"
 #include "version.h"
 #include "command.h"
 #include "at.h"
 #include "lora.h"
+#include "binmode.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -99,6 +101,8 @@ static void LoraRxData(lora_AppData_t *AppData);
 static void LORA_HasJoined( void );
 /* call back when LoRa endNode has just switch the class*/
 static void LORA_ConfirmClass ( DeviceClass_t Class );
+/* call back when LoRa endNode has just sent an uplink*/
+static void LORA_TxDone ( LoraErrorStatus Status, bool AckReceived );
 
 /* Private variables ---------------------------------------------------------*/
 /* load call backs*/
@@ -108,7 +112,8 @@ static LoRaMainCallback_t LoRaMainCallbacks = { HW_GetBatteryLevel,
                                                 HW_GetRandomSeed,
                                                 LoraRxData,
                                                LORA_HasJoined,
-                                               LORA_ConfirmClass};
+                                               LORA_ConfirmClass,
+                                               LORA_TxDone};
 
 /**
  * Initialises the Lora Parameters
@@ -204,6 +209,10 @@ int main(void)
   {
     /* Handle UART commands */
     CMD_Process();
+    /* Run the LoRaMac on the radio and timer events */
+    LoRaMacProcess();
+    /* Send the compliance test frame posted by its timer */
+    certif_process();
     /*
      * low power section
      */
@@ -212,8 +221,9 @@ int main(void)
      * if an interrupt has occurred after DISABLE_IRQ, it is kept pending
      * and cortex will not enter low power anyway
      * don't go in low power mode if we just received a char
+     * or if a LoRaMac event or a test frame is waiting to be processed
      */
-    if ( (IsNewCharReceived() == RESET))
+    if ((IsNewCharReceived() == RESET) && (LoRaMacIsProcessPending() == false) && (certif_pending() == false))
     {
 #ifndef LOW_POWER_DISABLE
       LPM_EnterLowPower();
@@ -230,6 +240,8 @@ int main(void)
 static void LoraRxData(lora_AppData_t *AppData)
 {
    set_at_receive(AppData->Port, AppData->Buff, AppData->BuffSize);
+   BIN_EventRx(AppData->Port, AppData->Buff, AppData->BuffSize,
+               lora_config_rssi_get(), lora_config_snr_get());
 }
 
 #ifdef  USE_FULL_ASSERT
@@ -244,6 +256,7 @@ static void LORA_HasJoined( void )
 #if( OVER_THE_AIR_ACTIVATION != 0 )
   PRINTF("JOINED\n\r");
 #endif
+  BIN_EventJoined();
 }
 
 static void LORA_ConfirmClass ( DeviceClass_t Class )
@@ -251,4 +264,9 @@ static void LORA_ConfirmClass ( DeviceClass_t Class )
   DBG_PRINTF("switch to class %c done\n\r","ABC"[Class] );
 }
 
+static void LORA_TxDone ( LoraErrorStatus Status, bool AckReceived )
+{
+  BIN_EventTxDone(Status == LORA_SUCCESS, AckReceived);
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -370,7 +370,15 @@ void SystemClock_Config(void)
 
 uint32_t HW_GetRandomSeed(void)
 {
-  return ((*(uint32_t *)ID1) ^ (*(uint32_t *)ID2) ^ (*(uint32_t *)ID3));
+  uint32_t seed = ((*(uint32_t *)ID1) ^ (*(uint32_t *)ID2) ^ (*(uint32_t *)ID3));
+  uint8_t i;
+
+  /* the LSBs of the Vrefint conversions are noise */
+  for (i = 0; i < 8; i++)
+  {
+    seed = ((seed << 4) | (seed >> 28)) ^ HW_AdcReadChannel(LL_ADC_CHANNEL_VREFINT);
+  }
+  return seed;
 }
 
 void HW_GetUniqueId(uint8_t *id)
@@ -620,6 +620,8 @@ repeat:
     {
       case 'c':
 #ifdef TINY_PRINTF
+        /* the padding stops at the end of the buffer */
+        if (field_width > ((size - 1) - (str - buf))) field_width = (size - 1) - (str - buf);
 #else
         if (!(flags & LEFT))
 #endif
@@ -636,6 +638,9 @@ repeat:
         if (!s) s = "<NULL>";
 #ifdef TINY_PRINTF
         len = strlen(s);
+        /* the string is truncated at the end of the buffer */
+        if (len > ((size - 1) - (str - buf))) len = (size - 1) - (str - buf);
+        if (field_width > ((size - 1) - (str - buf))) field_width = (size - 1) - (str - buf);
 #else
         len = strnlen(s, precision);
         if (!(flags & LEFT))
@@ -51,7 +51,6 @@
 #include "stm32l0xx_ll_dma.h"
 #include "low_power_manager.h"
 #include "tiny_vsnprintf.h"
-#include "delay.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -61,22 +60,28 @@
 #define BUFSIZE_TX 128
 #endif
 
-#define BUFSIZE_RX 8
+/* circular buffer written by the DMA, must be a power of 2 */
+#define BUFSIZE_RX 256
 #define MAX_PRINT_SIZE 128
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 
 typedef struct {
-  char buff[BUFSIZE_TX];   /* buffer to transmit */
+  char buff[BUFSIZE_TX + MAX_PRINT_SIZE]; /* buffer to transmit, then the spill of a string formatted across its end */
   __IO int iw;             /* 1st free index in BuffTx */
   int ir;                  /* next char to read in buffTx */
   __IO int dmabuffSize;
+  int spillWrap;           /* index of the end of buff the last spill went across */
+  uint16_t spillLen;       /* count of chars in the spill, also copied at the start of buff */
+  uint32_t dropped;        /* count of strings dropped or lines discarded */
 } circ_buff_tx_t;
 
 typedef struct {
-  char buff[BUFSIZE_RX];   /* buffer to receive */
-  __IO int iw;             /* 1st free index in BuffRx */
-  int ir;                  /* next char to read in buffRx */
+  char buff[BUFSIZE_RX];   /* buffer written by the DMA */
+  __IO uint32_t iw;        /* count of chars received, updated by vcom_RxSync */
+  uint32_t ir;             /* count of chars read */
+  uint16_t dmaPos;         /* DMA index in buff at the last vcom_RxSync */
+  __IO uint8_t error;      /* a reception error or an overflow is to be reported */
 } circ_buff_rx_t;
 
 static struct {
@@ -89,13 +94,22 @@ static struct {
   int len;                /* low power buffer length */
 } SleepBuff;              /* low power structure*/
 
+static struct {
+  bool on;                /* the text goes to buff instead of the com port */
+  char *buff;             /* capture buffer, NULL to drop the text */
+  uint16_t size;          /* capture buffer size */
+  uint16_t len;           /* count of chars captured */
+} Capture;                /* text capture context */
+
 
 /* Private function prototypes -----------------------------------------------*/
 /**
- * @brief  Takes one character that has been received and save it in uart_context.buffRx
- * @param  received character
+ * @brief  Accounts the characters written by the DMA since the last call
+ * @note   To be called with the interrupts disabled or from the vcom interrupts,
+ *         at least once per half buffer
+ * @param  None
  */
-static void receive(char rx);
+static void vcom_RxSync(void);
 
 /**
  * @brief  prepare DMA print
@@ -110,6 +124,46 @@ static void vcom_PrintDMA(void);
  */
 static void vcom_StartDMA(char* buf, uint16_t buffLen);
 
+/**
+ * @brief  Ends the DMA transfer into UART and starts the next one
+ * @note   To be called with the interrupts disabled or from the vcom interrupts
+ * @param  None
+ */
+static void vcom_TxDone(void);
+
+/**
+ * @brief  Formats a string straight in the tx circular buffer and starts the DMA
+ * @note   A string the buffer cannot take is handled as set by VCOM_TX_POLICY
+ * @param  C string that contains a format string
+ * @param  arguments of the format
+ */
+static void vcom_Format(const char *format, va_list args);
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+/**
+ * @brief  Discards the oldest line of the tx circular buffer not handed to the DMA yet
+ * @note   To be called with the interrupts disabled
+ * @param  None
+ * @retval false if there is nothing left to discard
+ */
+static bool vcom_DiscardLine(void);
+#endif
+
+/**
+ * @brief  Copies characters in the tx circular buffer and starts the DMA
+ * @param  buffer to copy
+ * @param  length of buffer to copy, at most BUFSIZE_TX
+ */
+static void vcom_Enqueue(const char *buf, uint16_t len);
+
+/**
+ * @brief  Waits until the tx circular buffer can take characters
+ * @note   Polls the end of the DMA transfers, so works from any context.
+ *         Returns with the interrupts disabled, the caller restores them
+ * @param  number of characters to write, at most BUFSIZE_TX
+ */
+static void vcom_WaitFree(uint16_t len);
+
 
 /* Functions Definition ------------------------------------------------------*/
 
@@ -147,6 +201,8 @@ void vcom_Init(void)
 
 void vcom_DeInit(void)
 {
+  LL_LPUART_DisableDMAReq_RX(UARTX);
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_6);
   LL_LPUART_DeInit(UARTX);
 }
 
@@ -182,8 +238,41 @@ void vcom_IoDeInit(void)
 
 void vcom_ReceiveInit(void)
 {
-  /* enable RXNE */
-  LL_LPUART_EnableIT_RXNE(UARTX);
+  LL_DMA_InitTypeDef DMA_InitStruct;
+
+  uart_context.rx.iw = 0;
+  uart_context.rx.ir = 0;
+  uart_context.rx.dmaPos = 0;
+  uart_context.rx.error = 0;
+
+  /*switch dma clock ON*/
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+  /*the DMA writes the received chars round the rx buffer, with no interrupt per char*/
+  DMA_InitStruct.Direction= LL_DMA_DIRECTION_PERIPH_TO_MEMORY;
+  DMA_InitStruct.PeriphOrM2MSrcAddress=(uint32_t) &UARTX->RDR;
+  DMA_InitStruct.PeriphOrM2MSrcDataSize= LL_DMA_PDATAALIGN_BYTE;
+  DMA_InitStruct.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+  DMA_InitStruct.Mode= LL_DMA_MODE_CIRCULAR;
+  DMA_InitStruct.MemoryOrM2MDstAddress= (uint32_t) uart_context.rx.buff;
+  DMA_InitStruct.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+  DMA_InitStruct.MemoryOrM2MDstDataSize= LL_DMA_MDATAALIGN_BYTE;
+  DMA_InitStruct.NbData= BUFSIZE_RX;
+  DMA_InitStruct.PeriphRequest=LL_DMA_REQUEST_5;
+  DMA_InitStruct.Priority=LL_DMA_PRIORITY_MEDIUM;
+  LL_DMA_Init(DMA1, LL_DMA_CHANNEL_6, &DMA_InitStruct);
+  /*half and full transfer events bound the chars the rx buffer holds unaccounted*/
+  LL_DMA_EnableIT_HT(DMA1, LL_DMA_CHANNEL_6);
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_6);
+  /* enable DMA nvic*/
+  HAL_NVIC_SetPriority(DMA1_Channel4_5_6_7_IRQn, IRQ_PRIORITY_USARTX, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel4_5_6_7_IRQn);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_6);
+  /* enable LPUART DMA request*/
+  LL_LPUART_EnableDMAReq_RX(UARTX);
+
+  /* the end of a line is signalled by the idle line */
+  LL_LPUART_ClearFlag_IDLE(UARTX);
+  LL_LPUART_EnableIT_IDLE(UARTX);
   /* WakeUp from stop mode on start bit detection*/
   LL_LPUART_SetWKUPType(UARTX, LL_LPUART_WAKEUP_ON_STARTBIT);
 
@@ -198,41 +287,241 @@ void vcom_Send( const char *format, ... )
 {
   va_list args;
   va_start(args, format);
-  uint8_t len=0;
-  uint8_t lenTop;
-  char tempBuff[MAX_PRINT_SIZE];
-  int32_t freebuff;
-
-  /* calculate free buffer size*/
-  /*in case freebuff is negative this is an overrun*/
-  freebuff = BUFSIZE_TX - (uart_context.tx.iw-uart_context.tx.ir);
 
-  if (SleepBuff.len!=0)
+  if (Capture.on)
   {
-    /*if SleepBuff has been filled before entering lowpower, prepend it */
-    memcpy(&tempBuff[0], SleepBuff.buffer, SleepBuff.len);
-    len = tiny_vsnprintf_like(&tempBuff[SleepBuff.len], sizeof(tempBuff), format, args); 
-    len += SleepBuff.len;
-    /*erase SleepBuff*/
-    memset(SleepBuff.buffer, 0,sizeof(SleepBuff.buffer) );
+    /*the text of SleepBuff is not part of the captured output*/
     SleepBuff.len=0;
+    if (Capture.buff != NULL)
+    {
+      /*the capture buffer holds one more char for the final '\0'*/
+      Capture.len += tiny_vsnprintf_like(&Capture.buff[Capture.len], Capture.size - Capture.len + 1, format, args);
+    }
   }
   else
   {
-  /*convert into string at buff[0] of length iw*/
-    len = tiny_vsnprintf_like(&tempBuff[0], sizeof(tempBuff), format, args); 
+    if (SleepBuff.len!=0)
+    {
+      /*if SleepBuff has been filled before entering lowpower, send it first */
+      vcom_Enqueue(SleepBuff.buffer, SleepBuff.len);
+      SleepBuff.len=0;
+    }
+    vcom_Format(format, args);
   }
-  
-  if (len>freebuff)
+
+  va_end(args);
+}
+
+uint32_t vcom_GetDropCount(void)
+{
+  return uart_context.tx.dropped;
+}
+
+void vcom_Write(const uint8_t *buf, uint16_t len)
+{
+  uint16_t chunk;
+
+  while (len > 0)
+  {
+    chunk = (len > MAX_PRINT_SIZE) ? MAX_PRINT_SIZE : len;
+    vcom_Enqueue((const char *) buf, chunk);
+    buf += chunk;
+    len -= chunk;
+  }
+}
+
+void vcom_WriteHex(const uint8_t *buf, uint16_t len)
+{
+  static const char HexDigit[] = "0123456789abcdef";
+  uint16_t chunk;
+  int iw;
+  BACKUP_PRIMASK();
+
+  if (Capture.on)
+  {
+    /*two digits per byte, as long as they fit*/
+    while ((len > 0) && ((Capture.len + 2) <= Capture.size))
+    {
+      Capture.buff[Capture.len++] = HexDigit[*buf >> 4];
+      Capture.buff[Capture.len++] = HexDigit[*buf & 0x0F];
+      buf++;
+      len--;
+    }
+    return;
+  }
+
+  while (len > 0)
   {
-    /*wait enough free char in buff*/
-    /*1 char at 9600 lasts approx 1ms*/
-    DelayMs(len-freebuff);
+    chunk = (len > (MAX_PRINT_SIZE / 2)) ? (MAX_PRINT_SIZE / 2) : len;
+    /*an interrupt may print meanwhile: the room is kept until the chars are committed*/
+    vcom_WaitFree(chunk * 2);
+
+    /*encode straight into the circ buf, two digits per byte*/
+    iw = uart_context.tx.iw;
+    len -= chunk;
+    while (chunk-- > 0)
+    {
+      uart_context.tx.buff[iw % BUFSIZE_TX] = HexDigit[*buf >> 4];
+      iw++;
+      uart_context.tx.buff[iw % BUFSIZE_TX] = HexDigit[*buf & 0x0F];
+      iw++;
+      buf++;
+    }
+    uart_context.tx.iw = iw;
+
+    if (! LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_7) )
+    {
+      vcom_PrintDMA();
+    }
+    RESTORE_PRIMASK();
   }
+}
+
+void vcom_CaptureStart(char *buf, uint16_t size)
+{
+  Capture.buff = buf;
+  Capture.size = (buf == NULL) ? 0 : size;
+  Capture.len = 0;
+  Capture.on = true;
+}
+
+uint16_t vcom_CaptureStop(void)
+{
+  Capture.on = false;
+  return Capture.len;
+}
+
+static void vcom_Format(const char *format, va_list args)
+{
+  va_list argsTry;
+  int room;
+  int size;
+  int pos;
+  int len;
+  BACKUP_PRIMASK();
+
+  while (1)
+  {
+    /*an interrupt may print meanwhile: the string is formatted and committed at once*/
+    DISABLE_IRQ();
+
+    room = BUFSIZE_TX - (uart_context.tx.iw - uart_context.tx.ir);
+    size = (room < MAX_PRINT_SIZE) ? room : MAX_PRINT_SIZE;
+    pos = uart_context.tx.iw % BUFSIZE_TX;
+
+    /*chars past the end of buff go in the spill*/
+    va_copy(argsTry, args);
+    len = tiny_vsnprintf_like(&uart_context.tx.buff[pos], size, format, argsTry);
+    va_end(argsTry);
+
+    /*the string may only be truncated to MAX_PRINT_SIZE, as with a temporary buffer*/
+    if ((len < (size - 1)) || (size == MAX_PRINT_SIZE))
+    {
+      if ((pos + len) > BUFSIZE_TX)
+      {
+        /*copy the spill at the start of buff, the DMA sends it from either place*/
+        uart_context.tx.spillLen = pos + len - BUFSIZE_TX;
+        uart_context.tx.spillWrap = uart_context.tx.iw + (BUFSIZE_TX - pos);
+        memcpy(&uart_context.tx.buff[0], &uart_context.tx.buff[BUFSIZE_TX], uart_context.tx.spillLen);
+      }
+      uart_context.tx.iw += len;
+
+      /*an empty string leaves nothing to send*/
+      if ((len > 0) && (! LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_7)) )
+      {
+        vcom_PrintDMA();
+      }
+      RESTORE_PRIMASK();
+      return;
+    }
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+    if (vcom_DiscardLine())
+    {
+      RESTORE_PRIMASK();
+      continue;
+    }
+#elif (VCOM_TX_POLICY == VCOM_TX_BLOCK)
+    if (__get_IPSR() == 0)
+    {
+      /*wait until the DMA frees some chars, never in an interrupt*/
+      RESTORE_PRIMASK();
+      vcom_WaitFree(room + 1);
+      RESTORE_PRIMASK();
+      continue;
+    }
+#endif
+    uart_context.tx.dropped++;
+    RESTORE_PRIMASK();
+    return;
+  }
+}
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+static bool vcom_DiscardLine(void)
+{
+  int start = uart_context.tx.ir;
+  int iw = uart_context.tx.iw;
+  int n = 1;
+  int i;
+
+  if (LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_7))
+  {
+    /*the chars handed to the DMA are being sent*/
+    start += uart_context.tx.dmabuffSize;
+  }
+  if (start == iw)
+  {
+    return false;
+  }
+
+  /*the oldest line ends at its '\n'*/
+  while (((start + n) < iw) && (uart_context.tx.buff[(start + n - 1) % BUFSIZE_TX] != '\n'))
+  {
+    n++;
+  }
+  /*move the younger chars over it*/
+  for (i = start; (i + n) < iw; i++)
+  {
+    uart_context.tx.buff[i % BUFSIZE_TX] = uart_context.tx.buff[(i + n) % BUFSIZE_TX];
+  }
+  uart_context.tx.iw = iw - n;
+  /*the spill is no longer a copy of the start of buff*/
+  uart_context.tx.spillWrap = -1;
+  uart_context.tx.dropped++;
+  return true;
+}
+#endif
+
+static void vcom_WaitFree(uint16_t len)
+{
+  BACKUP_PRIMASK();
+
+  /*the chars are freed at the end of each DMA transfer: poll it, the DMA
+    interrupt may not preempt the caller*/
+  DISABLE_IRQ();
+  while ((BUFSIZE_TX - (uart_context.tx.iw - uart_context.tx.ir)) < len)
+  {
+    if (LL_DMA_IsActiveFlag_TC7(DMA1))
+    {
+      vcom_TxDone();
+    }
+    RESTORE_PRIMASK();
+    DISABLE_IRQ();
+  }
+}
+
+static void vcom_Enqueue(const char *buf, uint16_t len)
+{
+  uint16_t lenTop;
+  BACKUP_PRIMASK();
+
+  /*an interrupt may print meanwhile: the room is kept until the chars are committed*/
+  vcom_WaitFree(len);
 
   if (((uart_context.tx.iw)%BUFSIZE_TX)+len<BUFSIZE_TX)
   {
-    memcpy( &uart_context.tx.buff[((uart_context.tx.iw)%BUFSIZE_TX)], &tempBuff[0], len);
+    memcpy( &uart_context.tx.buff[((uart_context.tx.iw)%BUFSIZE_TX)], &buf[0], len);
     uart_context.tx.iw+=len;
   }
   else
@@ -240,9 +529,9 @@ void vcom_Send( const char *format, ... )
     /*cut buffer in high/low part*/
     lenTop= BUFSIZE_TX - ((uart_context.tx.iw)%BUFSIZE_TX);
     /*copy beginning at top part of the circ buf*/
-    memcpy( &uart_context.tx.buff[((uart_context.tx.iw)%BUFSIZE_TX)], &tempBuff[0], lenTop);
+    memcpy( &uart_context.tx.buff[((uart_context.tx.iw)%BUFSIZE_TX)], &buf[0], lenTop);
      /*copy end at bottom part of the circ buf*/
-    memcpy( &uart_context.tx.buff[0], &tempBuff[lenTop], len-lenTop);
+    memcpy( &uart_context.tx.buff[0], &buf[lenTop], len-lenTop);
     uart_context.tx.iw += len;
   }
 
@@ -250,8 +539,7 @@ void vcom_Send( const char *format, ... )
   {
     vcom_PrintDMA();
   }
-  
-  va_end(args);
+  RESTORE_PRIMASK();
 }
 
 void vcom_Send_Lp(const char *format, ...)
@@ -272,7 +560,9 @@ FlagStatus IsNewCharReceived(void)
   BACKUP_PRIMASK();
   DISABLE_IRQ();
   
-  status = ((uart_context.rx.iw == uart_context.rx.ir) ? RESET : SET);
+  /* also takes the chars of a line still being received */
+  vcom_RxSync();
+  status = (((uart_context.rx.iw == uart_context.rx.ir) && (uart_context.rx.error == 0)) ? RESET : SET);
   
   RESTORE_PRIMASK();
   return status;
@@ -285,8 +575,17 @@ uint8_t GetNewChar(void)
   BACKUP_PRIMASK();
   DISABLE_IRQ();
 
-  NewChar = uart_context.rx.buff[uart_context.rx.ir];
-  uart_context.rx.ir = (uart_context.rx.ir + 1) % sizeof(uart_context.rx.buff);
+  if (uart_context.rx.error != 0)
+  {
+    /* report the error before the chars received after it */
+    uart_context.rx.error = 0;
+    NewChar = AT_ERROR_RX_CHAR;
+  }
+  else
+  {
+    NewChar = uart_context.rx.buff[uart_context.rx.ir % BUFSIZE_RX];
+    uart_context.rx.ir++;
+  }
 
   RESTORE_PRIMASK();
   return NewChar;
@@ -302,85 +601,81 @@ void vcom_IRQHandler(void)
     LPM_SetStopMode(LPM_UART_TX_Id, LPM_Enable);
   }
   /*rx*/
+  /* UART Wake Up interrupt occured ------------------------------------------*/
+  if (LL_LPUART_IsActiveFlag_WKUP(UARTX) && (LL_LPUART_IsEnabledIT_WKUP(UARTX) != RESET))
   {
-    __IO int rx_ready = 0;
-    char rx = AT_ERROR_RX_CHAR;
-    
-    /* UART Wake Up interrupt occured ------------------------------------------*/
-    if (LL_LPUART_IsActiveFlag_WKUP(UARTX) && (LL_LPUART_IsEnabledIT_WKUP(UARTX) != RESET))
-    {
-      LL_LPUART_ClearFlag_WKUP(UARTX);
+    LL_LPUART_ClearFlag_WKUP(UARTX);
 
-      /* forbid stop mode */
-      LPM_SetStopMode(LPM_UART_RX_Id, LPM_Disable);
-    }
+    /* forbid stop mode, the DMA takes the chars until the line gets idle */
+    LPM_SetStopMode(LPM_UART_RX_Id, LPM_Disable);
+  }
 
-    if (LL_LPUART_IsActiveFlag_RXNE(UARTX) && (LL_LPUART_IsEnabledIT_RXNE(UARTX) != RESET))
-    {
-      /* no need to clear the RXNE flag because it is auto cleared by reading the data*/
-      rx = LL_LPUART_ReceiveData8(UARTX);
-      rx_ready = 1;
-      
-      /* allow stop mode*/
-      LPM_SetStopMode(LPM_UART_RX_Id, LPM_Enable);
-    }
+  if (LL_LPUART_IsActiveFlag_IDLE(UARTX) && (LL_LPUART_IsEnabledIT_IDLE(UARTX) != RESET))
+  {
+    LL_LPUART_ClearFlag_IDLE(UARTX);
+    vcom_RxSync();
 
-    if (LL_LPUART_IsActiveFlag_PE(UARTX) || LL_LPUART_IsActiveFlag_FE(UARTX) || LL_LPUART_IsActiveFlag_ORE(UARTX) || LL_LPUART_IsActiveFlag_NE(UARTX))
-    {
-      DBG_PRINTF("Error when receiving\n\r");
-      /* clear error IT */
-      LL_LPUART_ClearFlag_PE(UARTX);
-      LL_LPUART_ClearFlag_FE(UARTX);
-      LL_LPUART_ClearFlag_ORE(UARTX);
-      LL_LPUART_ClearFlag_NE(UARTX);
-      
-      rx = AT_ERROR_RX_CHAR;
-      
-      rx_ready = 1;
-    }
-    
-    if (rx_ready == 1)
-    {
-      receive(rx);
-    }
+    /* allow stop mode*/
+    LPM_SetStopMode(LPM_UART_RX_Id, LPM_Enable);
+  }
+
+  if (LL_LPUART_IsActiveFlag_PE(UARTX) || LL_LPUART_IsActiveFlag_FE(UARTX) || LL_LPUART_IsActiveFlag_ORE(UARTX) || LL_LPUART_IsActiveFlag_NE(UARTX))
+  {
+    DBG_PRINTF("Error when receiving\n\r");
+    /* clear error IT */
+    LL_LPUART_ClearFlag_PE(UARTX);
+    LL_LPUART_ClearFlag_FE(UARTX);
+    LL_LPUART_ClearFlag_ORE(UARTX);
+    LL_LPUART_ClearFlag_NE(UARTX);
+
+    vcom_RxSync();
+    uart_context.rx.error = 1;
   }
 }
 
-static void receive(char rx)
+static void vcom_RxSync(void)
 {
-  int next_free;
+  uint16_t pos = (BUFSIZE_RX - LL_DMA_GetDataLength(DMA1, LL_DMA_CHANNEL_6)) % BUFSIZE_RX;
 
-  /** no need to clear the RXNE flag because it is auto cleared by reading the data*/
-  uart_context.rx.buff[uart_context.rx.iw] = rx;
-  next_free = (uart_context.rx.iw + 1) % sizeof(uart_context.rx.buff);
-  if (next_free != uart_context.rx.iw)
-  {
-    /* this is ok to read as there is no buffer overflow in input */
-    uart_context.rx.iw = next_free;
-  }
-  else
+  uart_context.rx.iw += (uint16_t)(pos - uart_context.rx.dmaPos) % BUFSIZE_RX;
+  uart_context.rx.dmaPos = pos;
+
+  if ((uart_context.rx.iw - uart_context.rx.ir) > BUFSIZE_RX)
   {
-    /* force the end of a command in case of overflow so that we can process it */
-    uart_context.rx.buff[uart_context.rx.iw] = '\r';
-    DBG_PRINTF("uart_context.buffRx buffer overflow %d\r\n");
+    /* the DMA went round over unread chars: drop them, report the overflow */
+    uart_context.rx.ir = uart_context.rx.iw;
+    uart_context.rx.error = 1;
   }
 }
 
 void vcom_Dma_IRQHandler( void )
 {
+  if (LL_DMA_IsActiveFlag_HT6(DMA1) || LL_DMA_IsActiveFlag_TC6(DMA1))
+  {
+    /* half of the rx buffer has been filled by a long line */
+    LL_DMA_ClearFlag_HT6(DMA1);
+    LL_DMA_ClearFlag_TC6(DMA1);
+    vcom_RxSync();
+  }
   if (LL_DMA_IsActiveFlag_TC7(DMA1) )
   {
-    /*clear interrupt and flag*/
-    LL_DMA_DisableIT_TC(DMA1, LL_DMA_CHANNEL_7);
-    
-    LL_DMA_ClearFlag_TC7(DMA1);
-    /* update tx read index*/
-    uart_context.tx.ir += uart_context.tx.dmabuffSize;
-    
-    LL_DMA_DisableChannel( DMA1, LL_DMA_CHANNEL_7);
-    
-    LL_LPUART_DisableDMAReq_TX(UARTX);
+    vcom_TxDone();
   }
+}
+
+static void vcom_TxDone(void)
+{
+  /*clear interrupt and flag*/
+  LL_DMA_DisableIT_TC(DMA1, LL_DMA_CHANNEL_7);
+
+  LL_DMA_ClearFlag_TC7(DMA1);
+  /* update tx read index*/
+  uart_context.tx.ir += uart_context.tx.dmabuffSize;
+
+  LL_DMA_DisableChannel( DMA1, LL_DMA_CHANNEL_7);
+
+  LL_LPUART_DisableDMAReq_TX(UARTX);
+
   if ( uart_context.tx.ir!= uart_context.tx.iw)
   {
     /*continue if more has been written in buffer meanwhile*/
@@ -406,7 +701,12 @@ static void vcom_PrintDMA(void)
   {
     /*[ir:BUFSIZE_TX-1] and [0:iw]. */
      uart_context.tx.dmabuffSize= BUFSIZE_TX-read_idx;
-     /*only [ir:BUFSIZE_TX-1] sent, rest will be sent in dma  handler*/
+     if (uart_context.tx.spillWrap == (uart_context.tx.ir + uart_context.tx.dmabuffSize))
+     {
+       /*the string spilled across the end of buff follows [ir:BUFSIZE_TX-1]: same transfer*/
+       uart_context.tx.dmabuffSize += MIN(uart_context.tx.spillLen, uart_context.tx.iw - uart_context.tx.spillWrap);
+     }
+     /*the rest of [0:iw] will be sent in dma  handler*/
      vcom_StartDMA( &uart_context.tx.buff[read_idx], uart_context.tx.dmabuffSize);
   }
 }
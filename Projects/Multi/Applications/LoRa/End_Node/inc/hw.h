@@ -72,6 +72,7 @@ Maintainer: Miguel Luis and Gregory Cristian
 #include "hw_conf.h"
 #include "hw_gpio.h"
 #include "hw_spi.h"
+#include "hw_aes.h"
 #include "hw_rtc.h"
 #include "hw_msp.h"
 #include "debug.h"
@@ -0,0 +1,121 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013 Semtech
+
+Description: Header for driver hw aes module
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis and Gregory Cristian
+*/
+ /******************************************************************************
+  * @file    hw_aes.h
+  * @author  MCD Application Team
+  * @version V1.1.4
+  * @date    08-January-2018
+  * @brief   Header for driver hw_aes.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V. 
+  * All rights reserved.</center></h2>
+  *
+  * Redistribution and use in source and binary forms, with or without 
+  * modification, are permitted, provided that the following conditions are met:
+  *
+  * 1. Redistribution of source code must retain the above copyright notice, 
+  *    this list of conditions and the following disclaimer.
+  * 2. Redistributions in binary form must reproduce the above copyright notice,
+  *    this list of conditions and the following disclaimer in the documentation
+  *    and/or other materials provided with the distribution.
+  * 3. Neither the name of STMicroelectronics nor the names of other 
+  *    contributors to this software may be used to endorse or promote products 
+  *    derived from this software without specific written permission.
+  * 4. This software, including modifications and/or derivative works of this 
+  *    software, must execute solely and exclusively on microcontroller or
+  *    microprocessor devices manufactured by or for STMicroelectronics.
+  * 5. Redistribution and use of this software other than as permitted under 
+  *    this license is void and will automatically terminate your rights under 
+  *    this license. 
+  *
+  * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS" 
+  * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT 
+  * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+  * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+  * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT 
+  * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+  * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+  * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+  * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HW_AES_H__
+#define __HW_AES_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Exported macros -----------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */ 
+
+/*!
+ * @brief Checks that the MCU has an AES coprocessor
+ *
+ * @retval true when the AES peripheral is available, false otherwise
+ */
+bool HW_AES_Init( void );
+
+/*!
+ * @brief AES-128 ECB encryption of nbBlocks consecutive 16 bytes blocks
+ *
+ * @param [IN]  key      AES key
+ * @param [IN]  in       Input blocks
+ * @param [OUT] out      Output blocks (may be the same as in)
+ * @param [IN]  nbBlocks Number of blocks
+ */
+void HW_AES_Ecb( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks );
+
+/*!
+ * @brief AES-128 CBC-MAC, only the last cipher block is kept
+ *
+ * @param [IN]    key      AES key
+ * @param [IN]    in       Input blocks
+ * @param [IN]    nbBlocks Number of blocks
+ * @param [INOUT] chain    IV on entry, last cipher block on exit
+ */
+void HW_AES_CbcMac( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain );
+
+/*!
+ * @brief AES-128 CTR encryption, the counter is the last 32 bits word
+ *
+ * @param [IN]  key          AES key
+ * @param [IN]  counterBlock Initial counter block
+ * @param [IN]  in           Input buffer
+ * @param [IN]  size         Input buffer size
+ * @param [OUT] out          Output buffer (may be the same as in)
+ */
+void HW_AES_Ctr( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __HW_AES_H__ */
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -124,6 +124,11 @@ Maintainer: Miguel Luis and Gregory Cristian
   #include "mlm32l0xx_hw_conf.h"
 #endif
 
+#ifdef USE_SIMULATOR
+  /* host simulator, see Projects/Multi/Applications/LoRa/Simulator */
+  #include "sim_hw_conf.h"
+#endif
+
 /* --------Preprocessor compile swicth------------ */
 /* debug swicthes in debug.h */
 //#define DEBUG
@@ -132,6 +137,16 @@ Maintainer: Miguel Luis and Gregory Cristian
 /* uncomment below line to never enter lowpower modes in main.c*/
 //#define LOW_POWER_DISABLE
 
+/* uncomment below line to measure the critical sections durations (cs_profiler.h)*/
+//#define CS_PROFILER
+
+/* uncomment below line to move the long radio SPI transfers to the DMA (hw_spi.c)*/
+//#define SPI_DMA
+
+/* uncomment below line to choose what vcom_Send does when its buffer is full (vcom.h),
+   VCOM_TX_BLOCK by default*/
+//#define VCOM_TX_POLICY VCOM_TX_DROP
+
 /* debug swicthes in bsp.c */
 //#define SENSOR_ENABLED
    
@@ -125,6 +125,14 @@ Maintainer: Miguel Luis and Gregory Cristian
 
 #define SPI1_AF                          GPIO_AF5_SPI1  
 
+/*  SPI DMA MACRO redefinition (SPI_DMA compile switch in hw_conf.h) */
+
+#define SPI_DMA_CLK_ENABLE()            __HAL_RCC_DMA1_CLK_ENABLE()
+#define SPI_RX_DMA_CHANNEL              DMA1_Channel2
+#define SPI_TX_DMA_CHANNEL              DMA1_Channel3
+#define SPI_RX_DMA_IRQn                 DMA1_Channel2_IRQn
+#define SPI_TX_DMA_IRQn                 DMA1_Channel3_IRQn
+
 /* ADC MACRO redefinition */
 
 
@@ -66,8 +66,17 @@ Maintainer: Miguel Luis and Gregory Cristian
 #endif
    
 /* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+/* What vcom_Send does with a string the circular buffer cannot take */
+#define VCOM_TX_DROP      0   /* drops the string */
+#define VCOM_TX_BLOCK     1   /* waits for room, drops the string when called from an interrupt */
+#define VCOM_TX_OVERWRITE 2   /* discards the oldest lines not being sent yet */
+#ifndef VCOM_TX_POLICY
+#define VCOM_TX_POLICY    VCOM_TX_BLOCK
+#endif
 /* External variables --------------------------------------------------------*/
 
 /* Exported functions ------------------------------------------------------- */ 
@@ -101,16 +110,24 @@ void vcom_IoInit(void);
 void vcom_IoDeInit(void);
   
 /** 
-* @brief  Records string on circular Buffer and set SW interrupt
-* @note   Set NVIC to call vcom_Send
+* @brief  Formats string straight in circular Buffer and sends it in IT mode
+* @note   At most 128 chars with the final '\0'. When it does not fit,
+*         VCOM_TX_POLICY applies
 * @param  string
 * @return None
 */
 void vcom_Send( char *format, ... );
 
+/** 
+* @brief  Gets the count of strings vcom_Send has dropped and of lines it has discarded
+* @param  None
+* @return the count since the start
+*/
+uint32_t vcom_GetDropCount( void );
+
 /** 
 * @brief  Sends circular Buffer on com port in IT mode
-* @note   called from low Priority interrupt
+* @note   called from the USART interrupt
 * @param  None
 * @return None
 */
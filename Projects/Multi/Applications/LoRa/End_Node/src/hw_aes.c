@@ -0,0 +1,247 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013 Semtech
+
+Description: AES coprocessor driver implementation
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis and Gregory Cristian
+*/
+ /*******************************************************************************
+  * @file    hw_aes.c
+  * @author  MCD Application Team
+  * @version V1.1.4
+  * @date    08-January-2018
+  * @brief   manages the AES coprocessor
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V. 
+  * All rights reserved.</center></h2>
+  *
+  * Redistribution and use in source and binary forms, with or without 
+  * modification, are permitted, provided that the following conditions are met:
+  *
+  * 1. Redistribution of source code must retain the above copyright notice, 
+  *    this list of conditions and the following disclaimer.
+  * 2. Redistributions in binary form must reproduce the above copyright notice,
+  *    this list of conditions and the following disclaimer in the documentation
+  *    and/or other materials provided with the distribution.
+  * 3. Neither the name of STMicroelectronics nor the names of other 
+  *    contributors to this software may be used to endorse or promote products 
+  *    derived from this software without specific written permission.
+  * 4. This software, including modifications and/or derivative works of this 
+  *    software, must execute solely and exclusively on microcontroller or
+  *    microprocessor devices manufactured by or for STMicroelectronics.
+  * 5. Redistribution and use of this software other than as permitted under 
+  *    this license is void and will automatically terminate your rights under 
+  *    this license. 
+  *
+  * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS" 
+  * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT 
+  * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+  * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+  * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT 
+  * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+  * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+  * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+  * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "utilities.h"
+
+#if defined( AES )
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* CR configuration: byte swapped data, encryption mode */
+#define AES_CR_ECB                  ( AES_CR_DATATYPE_1 )
+#define AES_CR_CBC                  ( AES_CR_DATATYPE_1 | AES_CR_CHMOD_0 )
+#define AES_CR_CTR                  ( AES_CR_DATATYPE_1 | AES_CR_CHMOD_1 )
+
+/* Private macro -------------------------------------------------------------*/
+#if defined( STM32L1 )
+#define AES_CLK_ENABLE( )           __HAL_RCC_CRYP_CLK_ENABLE( )
+#define AES_CLK_DISABLE( )          __HAL_RCC_CRYP_CLK_DISABLE( )
+#else
+#define AES_CLK_ENABLE( )           __HAL_RCC_AES_CLK_ENABLE( )
+#define AES_CLK_DISABLE( )          __HAL_RCC_AES_CLK_DISABLE( )
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief Enables the peripheral and loads key and IV
+ *
+ * @param [IN] mode  CR configuration
+ * @param [IN] key   AES key
+ * @param [IN] iv    Initialization vector, NULL for none
+ */
+static void AesStart( uint32_t mode, const uint8_t *key, const uint8_t *iv );
+
+/*!
+ * @brief Disables the peripheral
+ */
+static void AesStop( void );
+
+/*!
+ * @brief Processes one 16 bytes block
+ *
+ * @param [IN]  in   Input block
+ * @param [OUT] out  Output block
+ */
+static void AesBlock( const uint8_t *in, uint8_t *out );
+
+/* Exported functions ---------------------------------------------------------*/
+
+bool HW_AES_Init( void )
+{
+  return true;
+}
+
+void HW_AES_Ecb( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+  AesStart( AES_CR_ECB, key, NULL );
+  while( nbBlocks-- > 0 )
+  {
+    AesBlock( in, out );
+    in += 16;
+    out += 16;
+  }
+  AesStop( );
+}
+
+void HW_AES_CbcMac( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain )
+{
+  AesStart( AES_CR_CBC, key, chain );
+  while( nbBlocks-- > 0 )
+  {
+    AesBlock( in, chain );
+    in += 16;
+  }
+  AesStop( );
+}
+
+void HW_AES_Ctr( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out )
+{
+  uint8_t block[16];
+
+  AesStart( AES_CR_CTR, key, counterBlock );
+  while( size >= 16 )
+  {
+    AesBlock( in, out );
+    in += 16;
+    out += 16;
+    size -= 16;
+  }
+  if( size > 0 )
+  {
+    /* Last partial block: pad with zeros and keep the used bytes only */
+    memset1( block, 0, sizeof( block ) );
+    memcpy1( block, in, size );
+    AesBlock( block, block );
+    memcpy1( out, block, size );
+  }
+  AesStop( );
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t ReadBe32( const uint8_t *p )
+{
+  return ( ( uint32_t )p[0] << 24 ) | ( ( uint32_t )p[1] << 16 ) | ( ( uint32_t )p[2] << 8 ) | p[3];
+}
+
+static void AesStart( uint32_t mode, const uint8_t *key, const uint8_t *iv )
+{
+  AES_CLK_ENABLE( );
+
+  AES->CR = mode;
+
+  /* Key and IV registers are not affected by the data type swapping */
+  AES->KEYR3 = ReadBe32( key );
+  AES->KEYR2 = ReadBe32( key + 4 );
+  AES->KEYR1 = ReadBe32( key + 8 );
+  AES->KEYR0 = ReadBe32( key + 12 );
+
+  if( iv != NULL )
+  {
+    AES->IVR3 = ReadBe32( iv );
+    AES->IVR2 = ReadBe32( iv + 4 );
+    AES->IVR1 = ReadBe32( iv + 8 );
+    AES->IVR0 = ReadBe32( iv + 12 );
+  }
+
+  AES->CR |= AES_CR_EN;
+}
+
+static void AesStop( void )
+{
+  AES->CR &= ~AES_CR_EN;
+  AES_CLK_DISABLE( );
+}
+
+static void AesBlock( const uint8_t *in, uint8_t *out )
+{
+  uint32_t word;
+  uint8_t i;
+
+  for( i = 0; i < 16; i += 4 )
+  {
+    AES->DINR = ( uint32_t )in[i] | ( ( uint32_t )in[i + 1] << 8 ) |
+                ( ( uint32_t )in[i + 2] << 16 ) | ( ( uint32_t )in[i + 3] << 24 );
+  }
+
+  while( ( AES->SR & AES_SR_CCF ) == 0 )
+  {
+  }
+
+  for( i = 0; i < 16; i += 4 )
+  {
+    word = AES->DOUTR;
+    out[i] = ( uint8_t )word;
+    out[i + 1] = ( uint8_t )( word >> 8 );
+    out[i + 2] = ( uint8_t )( word >> 16 );
+    out[i + 3] = ( uint8_t )( word >> 24 );
+  }
+
+  AES->CR |= AES_CR_CCFC;
+}
+
+#else /* AES */
+
+/* The MCU has no AES coprocessor: LoRaMacCrypto keeps the software provider */
+
+bool HW_AES_Init( void )
+{
+  return false;
+}
+
+void HW_AES_Ecb( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+}
+
+void HW_AES_CbcMac( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain )
+{
+}
+
+void HW_AES_Ctr( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out )
+{
+}
+
+#endif /* AES */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
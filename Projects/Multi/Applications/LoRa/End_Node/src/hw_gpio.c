@@ -136,11 +136,14 @@ void HW_GPIO_SetIrq( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint32_t prio,  Gpi
 void HW_GPIO_IrqHandler( uint16_t GPIO_Pin )
 {
   uint32_t BitPos = HW_GPIO_GetBitPos( GPIO_Pin );
+  CSP_ISR_ENTER( );
   
   if ( GpioIrq[ BitPos ]  != NULL)
   {
     GpioIrq[ BitPos ] ( );
   }
+
+  CSP_ISR_EXIT( );
 }
 
 /*!
@@ -113,10 +113,6 @@ typedef struct
 
 #define  SECONDS_IN_1MINUTE   (uint32_t) 60
 
-#define  MINUTES_IN_1HOUR    (uint32_t) 60
-
-#define  HOURS_IN_1DAY      (uint32_t) 24
-
 #define  DAYS_IN_MONTH_CORRECTION_NORM     ((uint32_t) 0x99AAA0 )
 #define  DAYS_IN_MONTH_CORRECTION_LEAP     ((uint32_t) 0x445550 )
 
@@ -124,8 +120,18 @@ typedef struct
 /* Calculates ceiling(X/N) */
 #define DIVC(X,N)   ( ( (X) + (N) -1 ) / (N) )
 
+/* DR value never read from a running calendar: the date is never 00 */
+#define CALENDAR_DAY_REG_INVALID  ((uint32_t) 0)
+
 
 /* Private macro -------------------------------------------------------------*/
+/* Divisions by a constant as a multiplication by its reciprocal: the RTC is */
+/* reprogrammed with irqs masked and Cortex-M0+ has no hardware divider. */
+/* Exact for X < 86400 (DIV_60, DIV_3600) and X < 2^23 (DIV_86400) */
+#define DIV_60(X)         ( ( ( ( uint32_t )(X) >> 2 ) * 17477U ) >> 18 )
+#define DIV_3600(X)       ( ( ( uint32_t )(X) * 37283U ) >> 27 )
+#define DIV_86400(X)      ( ( ( ( uint32_t )(X) >> 7 ) * 49711U ) >> 25 )
+
 /* Private variables ---------------------------------------------------------*/
 /*!
  * \brief Indicates if the RTC is already Initalized or not
@@ -165,6 +171,16 @@ static RTC_AlarmTypeDef RTC_AlarmStructure;
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/*!
+ * Calendar date register value CalendarDaySeconds was computed for
+ */
+static volatile uint32_t CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+
+/*!
+ * Seconds elapsed from 01/01/2000 to 00:00:00 of the CalendarDayReg date
+ */
+static volatile uint32_t CalendarDaySeconds = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 
 static void HW_RTC_SetConfig( void );
@@ -345,10 +361,7 @@ void HW_RTC_SetAlarm( uint32_t timeout )
  */
 uint32_t HW_RTC_GetTimerElapsedTime( void )
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-  
-  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct );
+  TimerTime_t CalendarValue = HW_RTC_GetCalendarValue(NULL, NULL );
 
   return( ( uint32_t )( CalendarValue - RtcTimerContext.Rtc_Time ));
 }
@@ -360,10 +373,7 @@ uint32_t HW_RTC_GetTimerElapsedTime( void )
  */
 uint32_t HW_RTC_GetTimerValue( void )
 {
-  RTC_TimeTypeDef RTC_TimeStruct;
-  RTC_DateTypeDef RTC_DateStruct;
-  
-  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(&RTC_DateStruct, &RTC_TimeStruct );
+  uint32_t CalendarValue = (uint32_t) HW_RTC_GetCalendarValue(NULL, NULL );
 
   return( CalendarValue );
 }
@@ -477,83 +487,52 @@ static void HW_RTC_StartWakeUpAlarm( uint32_t timeoutValue )
   uint16_t rtcAlarmMinutes = 0;
   uint16_t rtcAlarmHours = 0;
   uint16_t rtcAlarmDays = 0;
+  uint8_t rtcAlarmMonth = 0;
+  uint8_t rtcAlarmYear = 0;
+  uint8_t daysInMonth = 0;
   RTC_TimeTypeDef RTC_TimeStruct = RtcTimerContext.RTC_Calndr_Time;
   RTC_DateTypeDef RTC_DateStruct = RtcTimerContext.RTC_Calndr_Date;
 
   HW_RTC_StopAlarm( );
   DBG_GPIO_SET(GPIOB, GPIO_PIN_13);
   
-  /*reverse counter */
+  /* fold the timeout and the context time in seconds from 00:00:00 of the */
+  /* context date, then split it once: the cost is the same for any timeout */
   rtcAlarmSubSeconds =  PREDIV_S - RTC_TimeStruct.SubSeconds;
   rtcAlarmSubSeconds += ( timeoutValue & PREDIV_S);
-  /* convert timeout  to seconds */
-  timeoutValue >>= N_PREDIV_S;  /* convert timeout  in seconds */
+  timeoutValue = ( timeoutValue >> N_PREDIV_S ) + ( rtcAlarmSubSeconds >> N_PREDIV_S ) +
+                 ( uint32_t )RTC_TimeStruct.Seconds + 
+                 ( ( uint32_t )RTC_TimeStruct.Minutes * SECONDS_IN_1MINUTE ) +
+                 ( ( uint32_t )RTC_TimeStruct.Hours * SECONDS_IN_1HOUR );
+  rtcAlarmSubSeconds &= PREDIV_S;
   
-  /*convert microsecs to RTC format and add to 'Now' */
-  rtcAlarmDays =  RTC_DateStruct.Date;
-  while (timeoutValue >= SECONDS_IN_1DAY)
-  {
-    timeoutValue -= SECONDS_IN_1DAY;
-    rtcAlarmDays++;
-  }
+  /* calc days */
+  rtcAlarmDays = DIV_86400( timeoutValue );
+  timeoutValue -= rtcAlarmDays * SECONDS_IN_1DAY;
+  rtcAlarmDays += RTC_DateStruct.Date;
   
   /* calc hours */
-  rtcAlarmHours = RTC_TimeStruct.Hours;
-  while (timeoutValue >= SECONDS_IN_1HOUR)
-  {
-    timeoutValue -= SECONDS_IN_1HOUR;
-    rtcAlarmHours++;
-  }
-  
-  /* calc minutes */
-  rtcAlarmMinutes = RTC_TimeStruct.Minutes;
-  while (timeoutValue >= SECONDS_IN_1MINUTE)
-  {
-    timeoutValue -= SECONDS_IN_1MINUTE;
-    rtcAlarmMinutes++;
-  }
-   
-  /* calc seconds */
-  rtcAlarmSeconds =  RTC_TimeStruct.Seconds + timeoutValue;
-
-  /***** correct for modulo********/
-  while (rtcAlarmSubSeconds >= (PREDIV_S+1))
-  {
-    rtcAlarmSubSeconds -= (PREDIV_S+1);
-    rtcAlarmSeconds++;
-  }
-  
-  while (rtcAlarmSeconds >= SECONDS_IN_1MINUTE)
-  { 
-    rtcAlarmSeconds -= SECONDS_IN_1MINUTE;
-    rtcAlarmMinutes++;
-  }
-
-  while (rtcAlarmMinutes >= MINUTES_IN_1HOUR)
-  {
-    rtcAlarmMinutes -= MINUTES_IN_1HOUR;
-    rtcAlarmHours++;
-  }
+  rtcAlarmHours = DIV_3600( timeoutValue );
+  timeoutValue -= rtcAlarmHours * SECONDS_IN_1HOUR;
   
-  while (rtcAlarmHours >= HOURS_IN_1DAY)
-  {
-    rtcAlarmHours -= HOURS_IN_1DAY;
-    rtcAlarmDays++;
-  }
-
-  if( RTC_DateStruct.Year % 4 == 0 ) 
+  /* calc minutes and seconds */
+  rtcAlarmMinutes = DIV_60( timeoutValue );
+  rtcAlarmSeconds = timeoutValue - rtcAlarmMinutes * SECONDS_IN_1MINUTE;
+
+  /* wrap the date month by month, result in 1..days in month: the longest */
+  /* timeout, 2^32 ticks or 48 days, ends two months after the context */
+  rtcAlarmMonth = RTC_DateStruct.Month - 1;
+  rtcAlarmYear = RTC_DateStruct.Year;
+  daysInMonth = ( rtcAlarmYear % 4 == 0 ) ? DaysInMonthLeapYear[ rtcAlarmMonth ] : DaysInMonth[ rtcAlarmMonth ];
+  while( rtcAlarmDays > daysInMonth )
   {
-    if( rtcAlarmDays > DaysInMonthLeapYear[ RTC_DateStruct.Month - 1 ] )    
+    rtcAlarmDays -= daysInMonth;
+    if( ++rtcAlarmMonth == 12 )
     {
-      rtcAlarmDays = rtcAlarmDays % DaysInMonthLeapYear[ RTC_DateStruct.Month - 1 ];
-    }
-  }
-  else
-  {
-    if( rtcAlarmDays > DaysInMonth[ RTC_DateStruct.Month - 1 ] )    
-    {   
-      rtcAlarmDays = rtcAlarmDays % DaysInMonth[ RTC_DateStruct.Month - 1 ];
+      rtcAlarmMonth = 0;
+      rtcAlarmYear++;
     }
+    daysInMonth = ( rtcAlarmYear % 4 == 0 ) ? DaysInMonthLeapYear[ rtcAlarmMonth ] : DaysInMonth[ rtcAlarmMonth ];
   }
 
   /* Set RTC_AlarmStructure with calculated values*/
@@ -584,45 +563,79 @@ static void HW_RTC_StartWakeUpAlarm( uint32_t timeoutValue )
 
 /*!
  * @brief get current time from calendar in ticks
- * @param pointer to RTC_DateStruct
- * @param pointer to RTC_TimeStruct
+ * @param pointer to RTC_DateStruct, may be NULL
+ * @param pointer to RTC_TimeStruct, may be NULL
  * @retval time in ticks
  */
 static TimerTime_t HW_RTC_GetCalendarValue( RTC_DateTypeDef* RTC_DateStruct, RTC_TimeTypeDef* RTC_TimeStruct )
 {
   TimerTime_t calendarValue = 0;
-  uint32_t first_read;
+  uint32_t dayReg;
+  uint32_t daySeconds;
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t dr;
+  uint32_t year;
+  uint32_t month;
   uint32_t correction;
   
-  /* Get Time and Date*/
-  HAL_RTC_GetTime( &RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN );
- 
-   /* make sure it is correct due to asynchronus nature of RTC*/
+  /* shadow registers are bypassed: read SSR, TR and DR directly and */
+  /* make sure they are coherent due to asynchronus nature of RTC*/
   do {
-    first_read = RTC_TimeStruct->SubSeconds;
-    HAL_RTC_GetDate( &RtcHandle, RTC_DateStruct, RTC_FORMAT_BIN );
-    HAL_RTC_GetTime( &RtcHandle, RTC_TimeStruct, RTC_FORMAT_BIN );
-  } while (first_read != RTC_TimeStruct->SubSeconds);
+    ssr = RTC->SSR;
+    tr = RTC->TR;
+    dr = RTC->DR;
+  } while (ssr != RTC->SSR);
  
-  /* calculte amount of elapsed days since 01/01/2000 */
-  calendarValue= DIVC( (DAYS_IN_YEAR*3 + DAYS_IN_LEAP_YEAR)* RTC_DateStruct->Year , 4);
+  /* the day base only changes with DR: the key is read around the base */
+  /* so that a refresh done meanwhile from an irq is not torn */
+  dayReg = CalendarDayReg;
+  daySeconds = CalendarDaySeconds;
+  if ( ( dayReg != dr ) || ( CalendarDayReg != dayReg ) )
+  {
+    year = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_YT | RTC_DR_YU ) ) >> 16U ) );
+    month = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_MT | RTC_DR_MU ) ) >> 8U ) );
+    
+    /* calculte amount of elapsed days since 01/01/2000 */
+    calendarValue= DIVC( (DAYS_IN_YEAR*3 + DAYS_IN_LEAP_YEAR)* year , 4);
 
-  correction = ( (RTC_DateStruct->Year % 4) == 0 ) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM ;
+    correction = ( (year % 4) == 0 ) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM ;
  
-  calendarValue +=( DIVC( (RTC_DateStruct->Month-1)*(30+31) ,2 ) - (((correction>> ((RTC_DateStruct->Month-1)*2) )&0x3)));
+    calendarValue +=( DIVC( (month-1)*(30+31) ,2 ) - (((correction>> ((month-1)*2) )&0x3)));
 
-  calendarValue += (RTC_DateStruct->Date -1);
-  
-  /* convert from days to seconds */
-  calendarValue *= SECONDS_IN_1DAY; 
+    calendarValue += ( RTC_Bcd2ToByte( ( uint8_t )( dr & ( RTC_DR_DT | RTC_DR_DU ) ) ) -1);
+    
+    /* convert from days to seconds */
+    daySeconds = calendarValue * SECONDS_IN_1DAY;
+
+    CalendarDayReg = CALENDAR_DAY_REG_INVALID;
+    CalendarDaySeconds = daySeconds;
+    CalendarDayReg = dr;
+  }
 
-  calendarValue += ( ( uint32_t )RTC_TimeStruct->Seconds + 
-                     ( ( uint32_t )RTC_TimeStruct->Minutes * SECONDS_IN_1MINUTE ) +
-                     ( ( uint32_t )RTC_TimeStruct->Hours * SECONDS_IN_1HOUR ) ) ;
+  calendarValue = daySeconds + 
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( tr & ( RTC_TR_ST | RTC_TR_SU ) ) ) + 
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_MNT | RTC_TR_MNU ) ) >> 8U ) ) * SECONDS_IN_1MINUTE ) +
+                  ( ( uint32_t )RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_HT | RTC_TR_HU ) ) >> 16U ) ) * SECONDS_IN_1HOUR ) ) ;
 
+  calendarValue = (calendarValue<<N_PREDIV_S) + ( PREDIV_S - ( ssr & RTC_SSR_SS ) );
 
-  
-  calendarValue = (calendarValue<<N_PREDIV_S) + ( PREDIV_S - RTC_TimeStruct->SubSeconds);
+  /* the broken down time is only decoded when the caller asks for it */
+  if ( RTC_TimeStruct != NULL )
+  {
+    RTC_TimeStruct->SubSeconds = ssr & RTC_SSR_SS;
+    RTC_TimeStruct->Hours = RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_HT | RTC_TR_HU ) ) >> 16U ) );
+    RTC_TimeStruct->Minutes = RTC_Bcd2ToByte( ( uint8_t )( ( tr & ( RTC_TR_MNT | RTC_TR_MNU ) ) >> 8U ) );
+    RTC_TimeStruct->Seconds = RTC_Bcd2ToByte( ( uint8_t )( tr & ( RTC_TR_ST | RTC_TR_SU ) ) );
+    RTC_TimeStruct->TimeFormat = ( uint8_t )( ( tr & RTC_TR_PM ) >> 16U );
+  }
+  if ( RTC_DateStruct != NULL )
+  {
+    RTC_DateStruct->Year = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_YT | RTC_DR_YU ) ) >> 16U ) );
+    RTC_DateStruct->Month = RTC_Bcd2ToByte( ( uint8_t )( ( dr & ( RTC_DR_MT | RTC_DR_MU ) ) >> 8U ) );
+    RTC_DateStruct->Date = RTC_Bcd2ToByte( ( uint8_t )( dr & ( RTC_DR_DT | RTC_DR_DU ) ) );
+    RTC_DateStruct->WeekDay = ( uint8_t )( ( dr & RTC_DR_WDU ) >> 13U );
+  }
 
   return( calendarValue );
 }
@@ -65,9 +65,24 @@ Maintainer: Miguel Luis and Gregory Cristian
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#ifdef SPI_DMA
+/*!
+ * Transfers of at least this many bytes go through the DMA. Below it the
+ * channels set-up costs more cycles than the polled transfer.
+ */
+#define HW_SPI_DMA_THRESHOLD          32
+#endif
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static SPI_HandleTypeDef hspi;
+#ifdef SPI_DMA
+static DMA_HandleTypeDef hdmaRx;
+static DMA_HandleTypeDef hdmaTx;
+/*!
+ * Set while a DMA transfer is on going, cleared by the completion callbacks
+ */
+static volatile bool SpiDmaBusy = false;
+#endif
 /* Private function prototypes -----------------------------------------------*/
 
 /*!
@@ -78,6 +93,24 @@ static SPI_HandleTypeDef hspi;
  */
 static uint32_t SpiFrequency( uint32_t hz );
 
+#ifdef SPI_DMA
+/*!
+ * @brief Configures the DMA channels linked to the SPI
+ *
+ * @param [IN] none
+ */
+static void SpiDmaInit( void );
+
+/*!
+ * @brief Runs a transfer through the DMA and waits for its completion
+ *
+ * @param [IN] txData Data to be sent, NULL to clock out don't care bytes
+ * @param [OUT] rxData Received data, NULL to discard it
+ * @param [IN] size Number of bytes to transfer
+ */
+static void SpiDmaTransfer( uint8_t *txData, uint8_t *rxData, uint16_t size );
+#endif
+
 /* Exported functions ---------------------------------------------------------*/
 
 /*!
@@ -114,6 +147,10 @@ void HW_SPI_Init( void )
      Error_Handler();
   }
 
+#ifdef SPI_DMA
+  SpiDmaInit( );
+#endif
+
   /*##-2- Configure the SPI GPIOs */
   HW_SPI_IoInit(  );
 }
@@ -127,6 +164,10 @@ void HW_SPI_DeInit( void )
 {
 
   HAL_SPI_DeInit( &hspi);
+#ifdef SPI_DMA
+  HAL_DMA_DeInit( &hdmaRx );
+  HAL_DMA_DeInit( &hdmaTx );
+#endif
 
     /*##-1- Reset peripherals ####*/
   __HAL_RCC_SPI1_FORCE_RESET();
@@ -195,6 +236,64 @@ uint16_t HW_SPI_InOut( uint16_t txData )
   return rxData;
 }
 
+/*!
+ * @brief Sends and receives a block of bytes in a single SPI transaction
+ *
+ * @param [IN] txData Data to be sent, NULL to clock out don't care bytes
+ * @param [OUT] rxData Received data, NULL to discard it
+ * @param [IN] size Number of bytes to transfer
+ */
+void HW_SPI_Transfer( uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+#ifdef SPI_DMA
+  if( size >= HW_SPI_DMA_THRESHOLD )
+  {
+    SpiDmaTransfer( txData, rxData, size );
+    return;
+  }
+#endif
+
+  if( txData == NULL )
+  {
+    HAL_SPI_Receive( &hspi, rxData, size, HAL_MAX_DELAY );
+  }
+  else if( rxData == NULL )
+  {
+    HAL_SPI_Transmit( &hspi, txData, size, HAL_MAX_DELAY );
+  }
+  else
+  {
+    HAL_SPI_TransmitReceive( &hspi, txData, rxData, size, HAL_MAX_DELAY );
+  }
+}
+
+#ifdef SPI_DMA
+/*!
+ * @brief SPI DMA completion callbacks, called from SpiDmaTransfer
+ *
+ * @param [IN] handle SPI handle
+ */
+void HAL_SPI_TxCpltCallback( SPI_HandleTypeDef *handle )
+{
+  SpiDmaBusy = false;
+}
+
+void HAL_SPI_RxCpltCallback( SPI_HandleTypeDef *handle )
+{
+  SpiDmaBusy = false;
+}
+
+void HAL_SPI_TxRxCpltCallback( SPI_HandleTypeDef *handle )
+{
+  SpiDmaBusy = false;
+}
+
+void HAL_SPI_ErrorCallback( SPI_HandleTypeDef *handle )
+{
+  SpiDmaBusy = false;
+}
+#endif
+
 /* Private functions ---------------------------------------------------------*/
 
 static uint32_t SpiFrequency( uint32_t hz )
@@ -219,5 +318,94 @@ static uint32_t SpiFrequency( uint32_t hz )
   return baudRate;
 }
 
+#ifdef SPI_DMA
+static void SpiDmaInit( void )
+{
+  SPI_DMA_CLK_ENABLE( );
+
+  hdmaRx.Instance                 = SPI_RX_DMA_CHANNEL;
+#ifdef SPI_RX_DMA_REQUEST
+  hdmaRx.Init.Request             = SPI_RX_DMA_REQUEST;
+#endif
+  hdmaRx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+  hdmaRx.Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdmaRx.Init.MemInc              = DMA_MINC_ENABLE;
+  hdmaRx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdmaRx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+  hdmaRx.Init.Mode                = DMA_NORMAL;
+  /* Rx must win the arbitration: a late read overruns the SPI */
+  hdmaRx.Init.Priority            = DMA_PRIORITY_VERY_HIGH;
+
+  hdmaTx.Instance                 = SPI_TX_DMA_CHANNEL;
+#ifdef SPI_TX_DMA_REQUEST
+  hdmaTx.Init.Request             = SPI_TX_DMA_REQUEST;
+#endif
+  hdmaTx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+  hdmaTx.Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdmaTx.Init.MemInc              = DMA_MINC_ENABLE;
+  hdmaTx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdmaTx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+  hdmaTx.Init.Mode                = DMA_NORMAL;
+  hdmaTx.Init.Priority            = DMA_PRIORITY_HIGH;
+
+  if( ( HAL_DMA_Init( &hdmaRx ) != HAL_OK ) || ( HAL_DMA_Init( &hdmaTx ) != HAL_OK ) )
+  {
+    /* Initialization Error */
+     Error_Handler();
+  }
+
+  __HAL_LINKDMA( &hspi, hdmarx, hdmaRx );
+  __HAL_LINKDMA( &hspi, hdmatx, hdmaTx );
+
+  /* The channels interrupts stay disabled in the NVIC: SpiDmaTransfer services
+     them itself, which also works from the radio IRQ handlers that run at the
+     same priority. SEVONPEND lets a pending request wake the core from WFE */
+  HAL_NVIC_DisableIRQ( SPI_RX_DMA_IRQn );
+  HAL_NVIC_DisableIRQ( SPI_TX_DMA_IRQn );
+  SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+}
+
+static void SpiDmaTransfer( uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+  HAL_StatusTypeDef status;
+
+  SpiDmaBusy = true;
+
+  if( txData == NULL )
+  {
+    status = HAL_SPI_Receive_DMA( &hspi, rxData, size );
+  }
+  else if( rxData == NULL )
+  {
+    status = HAL_SPI_Transmit_DMA( &hspi, txData, size );
+  }
+  else
+  {
+    status = HAL_SPI_TransmitReceive_DMA( &hspi, txData, rxData, size );
+  }
+
+  if( status != HAL_OK )
+  {
+    SpiDmaBusy = false;
+  }
+
+  while( SpiDmaBusy == true )
+  {
+    /* sleep until a channel interrupt is pending */
+    __WFE( );
+
+    if( ( NVIC_GetPendingIRQ( SPI_RX_DMA_IRQn ) != 0 ) ||
+        ( NVIC_GetPendingIRQ( SPI_TX_DMA_IRQn ) != 0 ) )
+    {
+      HAL_DMA_IRQHandler( &hdmaRx );
+      HAL_DMA_IRQHandler( &hdmaTx );
+      /* a channel still flagged sets its pending bit again */
+      NVIC_ClearPendingIRQ( SPI_RX_DMA_IRQn );
+      NVIC_ClearPendingIRQ( SPI_TX_DMA_IRQn );
+    }
+  }
+}
+#endif
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
@@ -48,6 +48,8 @@
 #include "hw.h"
 #include "low_power_manager.h"
 #include "lora.h"
+#include "lora-test.h"
+#include "LoRaMacCrypto.h"
 #include "bsp.h"
 #include "timeServer.h"
 #include "vcom.h"
@@ -75,7 +77,9 @@
 /*!
  * Defines the application data transmission duty cycle. 5s, value in [ms].
  */
+#ifndef APP_TX_DUTYCYCLE
 #define APP_TX_DUTYCYCLE                            10000
+#endif
 /*!
  * LoRaWAN Adaptive Data Rate
  * @note Please note that when ADR is enabled the end-device should be static
@@ -137,6 +141,9 @@ static void LoraStartTx(TxEventType_t EventType);
 /* tx timer callback function*/
 static void OnTxTimerEvent( void );
 
+/* push button callback function*/
+static void OnTxButtonEvent( void );
+
 /* Private variables ---------------------------------------------------------*/
 /* load Main call backs structure*/
 static LoRaMainCallback_t LoRaMainCallbacks ={ HW_GetBatteryLevel,
@@ -147,10 +154,22 @@ static LoRaMainCallback_t LoRaMainCallbacks ={ HW_GetBatteryLevel,
                                                LORA_HasJoined,
                                                LORA_ConfirmClass};
 
+/* AES coprocessor used by the LoRaMac crypto when the MCU has one */
+static const LoRaMacCryptoProvider_t HwAesProvider = { HW_AES_Init,
+                                                       HW_AES_Ecb,
+                                                       HW_AES_CbcMac,
+                                                       HW_AES_Ctr };
+
 /*!
  * Specifies the state of the application LED
  */
 static uint8_t AppLedStateOn = RESET;
+
+/*!
+ * Set by the tx timer or the push button, the LoRaMac runs from the main loop
+ * and so does the send request
+ */
+static volatile uint8_t AppTxRequest = RESET;
                                                
 static TimerEvent_t TxTimer;
 
@@ -211,6 +230,9 @@ int main( void )
   /*Disbale Stand-by mode*/
   LPM_SetOffMode(LPM_APPLI_Id , LPM_Disable );
   
+  /* Select the AES provider, falls back to software if no AES coprocessor*/
+  LoRaMacCryptoInit( &HwAesProvider );
+  
   /* Configure the Lora Stack*/
   LORA_Init( &LoRaMainCallbacks, &LoRaParamInit);
 
@@ -233,13 +255,28 @@ int main( void )
   
   while( 1 )
   {
+    if ( AppTxRequest == SET )
+    {
+      AppTxRequest = RESET;
+      Send( );
+    }
+
+    /* run the LoRaMac on the radio and timer events */
+    LoRaMacProcess( );
+
+    /* send the compliance test frame posted by its timer */
+    certif_process( );
+
     DISABLE_IRQ( );
     /* if an interrupt has occurred after DISABLE_IRQ, it is kept pending 
      * and cortex will not enter low power anyway  */
-
+    /* don't go in low power mode if an event is waiting to be processed */
+    if ( ( AppTxRequest == RESET ) && ( LoRaMacIsProcessPending( ) == false ) && ( certif_pending( ) == false ) )
+    {
 #ifndef LOW_POWER_DISABLE
-    LPM_EnterLowPower( );
+      LPM_EnterLowPower( );
 #endif
+    }
 
     ENABLE_IRQ();
     
@@ -449,11 +486,16 @@ static void LORA_RxData( lora_AppData_t *AppData )
 
 static void OnTxTimerEvent( void )
 {
-  Send( );
+  AppTxRequest = SET;
   /*Wait for next tx slot*/
   TimerStart( &TxTimer);
 }
 
+static void OnTxButtonEvent( void )
+{
+  AppTxRequest = SET;
+}
+
 static void LoraStartTx(TxEventType_t EventType)
 {
   if (EventType == TX_ON_TIMER)
@@ -473,7 +515,7 @@ static void LoraStartTx(TxEventType_t EventType)
     initStruct.Speed = GPIO_SPEED_HIGH;
 
     HW_GPIO_Init( USER_BUTTON_GPIO_PORT, USER_BUTTON_PIN, &initStruct );
-    HW_GPIO_SetIrq( USER_BUTTON_GPIO_PORT, USER_BUTTON_PIN, 0, Send );
+    HW_GPIO_SetIrq( USER_BUTTON_GPIO_PORT, USER_BUTTON_PIN, 0, OnTxButtonEvent );
   }
 }
 
@@ -291,13 +291,21 @@ void SystemClock_Config( void )
 }
 /**
   * @brief This function return a random seed
-  * @note based on the device unique ID
+  * @note based on the device unique ID and on the noise of the ADC
   * @param None
   * @retval see
   */
 uint32_t HW_GetRandomSeed( void )
 {
-  return ( ( *( uint32_t* )ID1 ) ^ ( *( uint32_t* )ID2 ) ^ ( *( uint32_t* )ID3 ) );
+  uint32_t seed = ( ( *( uint32_t* )ID1 ) ^ ( *( uint32_t* )ID2 ) ^ ( *( uint32_t* )ID3 ) );
+  uint8_t i;
+
+  /* the LSBs of the Vrefint conversions are noise */
+  for( i = 0; i < 8; i++ )
+  {
+    seed = ( ( seed << 4 ) | ( seed >> 28 ) ) ^ HW_AdcReadChannel( ADC_CHANNEL_VREFINT );
+  }
+  return seed;
 }
 
 /**
@@ -46,28 +46,73 @@
   
 #include "hw.h"
 #include "vcom.h"
+#include "low_power_manager.h"
 #include <stdarg.h>
+#include <stdio.h>
 
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 #define BUFSIZE 256
+#define MAX_PRINT_SIZE 128
 #define USARTX_IRQn USART2_IRQn
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 
-/* buffer */
-static char buff[BUFSIZE];
-/* buffer write index*/
-__IO uint16_t iw=0;
-/* buffer read index*/
-static uint16_t ir=0;
+/* buffer, then the spill of a string formatted across its end */
+static char buff[BUFSIZE + MAX_PRINT_SIZE];
+/* count of chars written in buffer */
+static __IO uint32_t iw=0;
+/* count of chars sent */
+static uint32_t ir=0;
+/* count of chars being sent in IT mode, 0 when idle */
+static __IO uint16_t itSize=0;
+/* iw at the end of buffer the last spill went across, 0 for none */
+static uint32_t spillWrap=0;
+/* count of chars in the spill, also copied at the start of buffer */
+static uint16_t spillLen=0;
+/* count of strings dropped or lines discarded */
+static uint32_t dropped=0;
 /* Uart Handle */
 static UART_HandleTypeDef UartHandle;
 
 /* Private function prototypes -----------------------------------------------*/
-/* Functions Definition ------------------------------------------------------*/
+/**
+ * @brief  Formats a string straight in the circular buffer
+ * @note   A string the buffer cannot take is handled as set by VCOM_TX_POLICY
+ * @param  C string that contains a format string
+ * @param  arguments of the format
+ * @param  true to start sending, false to only record the string (no wait either)
+ */
+static void vcom_Format(const char *format, va_list args, bool Print);
+
+/**
+ * @brief  Sends the chars of the circular buffer up to its end in IT mode
+ * @note   A string spilled across the end of buffer is sent in the same transfer
+ * @param  None
+ */
+static void vcom_PrintIT(void);
 
+#if (VCOM_TX_POLICY == VCOM_TX_BLOCK)
+/**
+ * @brief  Waits until the current IT transfer ends
+ * @note   Polls the UART, so works with the interrupts disabled
+ * @param  None
+ */
+static void vcom_WaitSent(void);
+#endif
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+/**
+ * @brief  Discards the oldest line of the circular buffer not being sent yet
+ * @note   To be called with the interrupts disabled
+ * @param  None
+ * @retval false if there is nothing left to discard
+ */
+static bool vcom_DiscardLine(void);
+#endif
+
+/* Functions Definition ------------------------------------------------------*/
 void vcom_Init(void)
 {
   /*## Configure the UART peripheral ######################################*/
@@ -109,86 +154,203 @@ void vcom_Send( char *format, ... )
 {
   va_list args;
   va_start(args, format);
-  uint8_t len;
-  uint8_t lenTop;
-  char tempBuff[128];
-  
-  BACKUP_PRIMASK();
-  DISABLE_IRQ();
-  
-  /*convert into string at buff[0] of length iw*/
-  len = vsprintf(&tempBuff[0], format, args);
-  
-  if (iw+len<BUFSIZE)
+
+  vcom_Format(format, args, true);
+
+  va_end(args);
+}
+
+uint32_t vcom_GetDropCount( void )
+{
+  return dropped;
+}
+
+void vcom_Print( void)
+{
+  /*sends the next chars, ends the transfer*/
+  HAL_UART_IRQHandler(&UartHandle);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  ir += itSize;
+  itSize = 0;
+
+  if (ir != iw)
   {
-    memcpy( &buff[iw], &tempBuff[0], len);
-    iw+=len;
+    /*continue if more has been written in buffer meanwhile*/
+    vcom_PrintIT();
   }
   else
   {
-    lenTop=BUFSIZE-iw;
-    memcpy( &buff[iw], &tempBuff[0], lenTop);
-    len-=lenTop;
-    memcpy( &buff[0], &tempBuff[lenTop], len);
-    iw = len;
+    /*enable lowpower since finished*/
+    LPM_SetStopMode(LPM_UART_TX_Id, LPM_Enable);
   }
-  RESTORE_PRIMASK();
-  
-  HAL_NVIC_SetPendingIRQ(USARTX_IRQn);
-    
+}
+
+void vcom_Send_Lp( char *format, ... )
+{
+  va_list args;
+  va_start(args, format);
+
+  /*sent with the next vcom_Send*/
+  vcom_Format(format, args, false);
+
   va_end(args);
 }
 
-/* modifes only ir*/
-void vcom_Print( void)
+static void vcom_Format(const char *format, va_list args, bool Print)
 {
-  char* CurChar;
-  while( ( (iw+BUFSIZE-ir)%BUFSIZE) >0 )
+  va_list argsTry;
+  uint32_t room;
+  uint32_t size;
+  uint32_t pos;
+  int len;
+  BACKUP_PRIMASK();
+
+  while (1)
   {
-    BACKUP_PRIMASK();
+    /*an interrupt may print meanwhile: the string is formatted and committed at once*/
     DISABLE_IRQ();
-    
-    CurChar = &buff[ir];
-    ir= (ir+1) %BUFSIZE;
-    
+
+    room = BUFSIZE - (iw - ir);
+    size = (room < MAX_PRINT_SIZE) ? room : MAX_PRINT_SIZE;
+    pos = iw % BUFSIZE;
+
+    /*chars past the end of buff go in the spill*/
+    va_copy(argsTry, args);
+    len = vsnprintf(&buff[pos], size, format, argsTry);
+    va_end(argsTry);
+
+    /*the string may only be truncated to MAX_PRINT_SIZE, as with a temporary buffer*/
+    if ((len >= 0) && (((uint32_t) len < size) || (size == MAX_PRINT_SIZE)))
+    {
+      if ((uint32_t) len >= size)
+      {
+        len = size - 1;
+      }
+      if ((pos + len) > BUFSIZE)
+      {
+        /*copy the spill at the start of buff, the UART sends it from either place*/
+        spillLen = pos + len - BUFSIZE;
+        spillWrap = iw + (BUFSIZE - pos);
+        memcpy(&buff[0], &buff[BUFSIZE], spillLen);
+      }
+      iw += len;
+
+      /*also sends the chars left by vcom_Send_Lp*/
+      if (Print && (itSize == 0) && (iw != ir))
+      {
+        vcom_PrintIT();
+      }
+      RESTORE_PRIMASK();
+      return;
+    }
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+    if (vcom_DiscardLine())
+    {
+      RESTORE_PRIMASK();
+      continue;
+    }
+#elif (VCOM_TX_POLICY == VCOM_TX_BLOCK)
+    if (Print && (len >= 0) && (__get_IPSR() == 0))
+    {
+      /*wait until some chars are sent, never in an interrupt*/
+      if (itSize == 0)
+      {
+        /*the chars of vcom_Send_Lp are not being sent yet*/
+        vcom_PrintIT();
+      }
+      RESTORE_PRIMASK();
+      vcom_WaitSent();
+      continue;
+    }
+#endif
+    dropped++;
+    if (Print && (itSize == 0) && (iw != ir))
+    {
+      vcom_PrintIT();
+    }
     RESTORE_PRIMASK();
-    
-    HAL_UART_Transmit(&UartHandle,(uint8_t *) CurChar, 1, 300);    
+    return;
   }
-  HAL_NVIC_ClearPendingIRQ(USARTX_IRQn);
 }
 
-void vcom_Send_Lp( char *format, ... )
+static void vcom_PrintIT(void)
 {
-  va_list args;
-  va_start(args, format);
-  uint8_t len;
-  uint8_t lenTop;
-  char tempBuff[128];
-  
-  BACKUP_PRIMASK();
-  DISABLE_IRQ();
-  
-  /*convert into string at buff[0] of length iw*/
-  len = vsprintf(&tempBuff[0], format, args);
-  
-  if (iw+len<BUFSIZE)
+  uint16_t write_idx = iw % BUFSIZE;
+  uint16_t read_idx = ir % BUFSIZE;
+
+  /*shall not go in stop mode while printing*/
+  LPM_SetStopMode(LPM_UART_TX_Id, LPM_Disable);
+
+  if (write_idx > read_idx)
   {
-    memcpy( &buff[iw], &tempBuff[0], len);
-    iw+=len;
+    /*contiguous buff[ir..iw]*/
+    itSize = write_idx - read_idx;
   }
   else
   {
-    lenTop=BUFSIZE-iw;
-    memcpy( &buff[iw], &tempBuff[0], lenTop);
-    len-=lenTop;
-    memcpy( &buff[0], &tempBuff[lenTop], len);
-    iw = len;
+    /*[ir:BUFSIZE-1] and [0:iw]*/
+    itSize = BUFSIZE - read_idx;
+    if (spillWrap == (ir + itSize))
+    {
+      /*the string spilled across the end of buff follows [ir:BUFSIZE-1]: same transfer*/
+      itSize += MIN(spillLen, iw - spillWrap);
+    }
+    /*the rest of [0:iw] will be sent on the end of the transfer*/
   }
-  RESTORE_PRIMASK();  
-  
-  va_end(args);
+  HAL_UART_Transmit_IT(&UartHandle, (uint8_t *) &buff[read_idx], itSize);
+}
+
+#if (VCOM_TX_POLICY == VCOM_TX_BLOCK)
+static void vcom_WaitSent(void)
+{
+  uint32_t sent = ir;
+  BACKUP_PRIMASK();
+
+  /*poll the UART, its interrupt may not preempt the caller*/
+  while ((ir == sent) && (itSize != 0))
+  {
+    DISABLE_IRQ();
+    HAL_UART_IRQHandler(&UartHandle);
+    RESTORE_PRIMASK();
+  }
+}
+#endif
+
+#if (VCOM_TX_POLICY == VCOM_TX_OVERWRITE)
+static bool vcom_DiscardLine(void)
+{
+  uint32_t start = ir + itSize;
+  uint32_t n = 1;
+  uint32_t i;
+
+  /*the chars of the IT transfer are being sent*/
+  if (start == iw)
+  {
+    return false;
+  }
+
+  /*the oldest line ends at its '\n'*/
+  while (((start + n) != iw) && (buff[(start + n - 1) % BUFSIZE] != '\n'))
+  {
+    n++;
+  }
+  /*move the younger chars over it*/
+  for (i = start; (i + n) != iw; i++)
+  {
+    buff[i % BUFSIZE] = buff[(i + n) % BUFSIZE];
+  }
+  iw -= n;
+  /*the spill is no longer a copy of the start of buff*/
+  spillWrap = 0;
+  dropped++;
+  return true;
 }
+#endif
+
 /**
   * @brief UART MSP Initialization 
   *        This function configures the hardware resources used in this example: 
@@ -131,6 +131,12 @@ Maintainer: Miguel Luis and Gregory Cristian
 /* uncomment below line to never enter lowpower modes in main.c*/
 //#define LOW_POWER_DISABLE
 
+/* uncomment below line to measure the critical sections durations (cs_profiler.h)*/
+//#define CS_PROFILER
+
+/* uncomment below line to move the long radio SPI transfers to the DMA (hw_spi.c)*/
+//#define SPI_DMA
+
 /* debug swicthes in bsp.c */
 //#define SENSOR_ENABLED
    
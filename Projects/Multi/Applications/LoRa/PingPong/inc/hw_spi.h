@@ -93,6 +93,17 @@ void HW_SPI_DeInit( void );
  */
 uint16_t HW_SPI_InOut( uint16_t outData );
 
+/*!
+ * @brief Sends and receives a block of bytes in a single SPI transaction
+ *
+ * @note  With SPI_DMA defined, transfers above a threshold use the DMA
+ *
+ * @param [IN] txData Data to be sent, NULL to clock out don't care bytes
+ * @param [OUT] rxData Received data, NULL to discard it
+ * @param [IN] size Number of bytes to transfer
+ */
+void HW_SPI_Transfer( uint8_t *txData, uint8_t *rxData, uint16_t size );
+
 
 
 #ifdef __cplusplus
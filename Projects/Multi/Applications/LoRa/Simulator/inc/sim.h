@@ -0,0 +1,405 @@
+/**
+ ******************************************************************************
+ * @file    sim.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Discrete event kernel of the host simulator and its models
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "hw_conf.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/*!
+ * Simulated time, in micro seconds since the power up
+ */
+typedef uint64_t SimTime_t;
+
+/*!
+ * A hardware event of the simulated world (RTC alarm, end of a radio
+ * operation...). The owner of the event allocates it and arms it at an
+ * absolute time, the kernel calls back when the time is reached.
+ */
+typedef struct sSimEvent
+{
+  SimTime_t Time;                       /* Expiry time */
+  void ( *Callback )( void *context );  /* Called at the expiry time */
+  void *Context;                        /* Passed to the callback */
+  bool IsArmed;
+  struct sSimEvent *Next;
+} SimEvent_t;
+
+/*!
+ * A LoRa frame on the air
+ */
+typedef struct
+{
+  SimTime_t Start;                      /* First preamble symbol */
+  SimTime_t End;                        /* End of the last symbol */
+  uint32_t Frequency;                   /* in Hz */
+  uint8_t Bandwidth;                    /* SX1276 code: 7 = 125 kHz, 8 = 250 kHz, 9 = 500 kHz */
+  uint8_t SpreadingFactor;              /* 6 to 12 */
+  uint8_t CodingRate;                   /* 1 (4/5) to 4 (4/8) */
+  uint16_t PreambleLen;                 /* in symbols */
+  bool IqInverted;
+  uint8_t SyncWord;
+  int16_t Rssi;                         /* in dBm at the receiver */
+  int8_t Snr;                           /* in dB at the receiver */
+  uint8_t Size;
+  uint8_t Payload[255];
+} SimFrame_t;
+
+/*!
+ * Run time options, from the command line
+ */
+typedef struct
+{
+  SimTime_t Duration;                   /* Simulated duration */
+  uint32_t Seed;                        /* Seeds the random generators and the device Id */
+  uint32_t DownlinkPeriod;              /* The network sends a downlink every N uplinks, 0 for never */
+  int16_t Rssi;                         /* Link RSSI, both ways, of a single device */
+  int8_t Snr;                           /* Link SNR, both ways, of a single device */
+  bool Verbose;                         /* Traces the radio and the network */
+  bool Quiet;                           /* Drops the application traces */
+  uint32_t Devices;                     /* Devices of the fleet, 0 for a single device */
+  uint32_t Jobs;                        /* Worker processes running the fleet */
+  uint32_t Radius;                      /* Radius of the cell around the gateway, in m */
+  uint32_t Confirmed;                   /* Share of the devices sending confirmed uplinks, in % */
+  const char *Report;                   /* Per device report file (CSV), NULL for none */
+  uint32_t Device;                      /* Index of this device in the fleet */
+  SimTime_t PowerOn;                    /* Power up time of this device */
+  bool ConfirmedUplinks;                /* This device sends confirmed uplinks */
+} SimConfig_t;
+
+/*!
+ * Counters reported at the end of the run
+ */
+typedef struct
+{
+  uint32_t Interrupts;
+  uint32_t Sleeps;
+  uint32_t SpiTransactions;
+  uint32_t SpiBytes;
+  uint32_t TxFrames;
+  SimTime_t TxAirTime;
+  uint32_t RxWindows;
+  uint32_t RxTimeouts;
+  uint32_t RxFrames;
+  uint32_t JoinRequests;
+  uint32_t JoinAccepts;
+  uint32_t Uplinks;
+  uint32_t ConfirmedUplinks;
+  uint32_t MicErrors;
+  uint32_t Downlinks;
+  uint32_t AppRequests;                 /* LORA_send calls of the application */
+  uint32_t AppRejected;                 /* LORA_send calls the LoRaMac refused */
+} SimStats_t;
+
+/*!
+ * Outcome of a frame at the network server
+ */
+typedef enum
+{
+  SIM_NETWORK_DROPPED = 0,              /* Not for this network, or bad MIC */
+  SIM_NETWORK_JOINED,                   /* Join request accepted */
+  SIM_NETWORK_UPLINK,                   /* First reception of an uplink */
+  SIM_NETWORK_REPEATED,                 /* Retransmission of the last uplink */
+} SimNetworkStatus_t;
+
+/*!
+ * Counters of the gateway of a fleet
+ */
+typedef struct
+{
+  uint32_t Frames;                      /* Uplink frames on the air */
+  uint32_t FramesPerSf[6];              /* SF7 to SF12 */
+  uint32_t Received;                    /* Demodulated, handed to the network server */
+  uint32_t BelowSensitivity;            /* Too weak to be detected */
+  uint32_t NoDemodulator;               /* All the demodulation paths were busy */
+  uint32_t Collisions;                  /* Lost to a frame of the same channel and SF */
+  uint32_t Transmitting;                /* Lost to a downlink of the gateway (half duplex) */
+  uint32_t Downlinks;                   /* Sent by the gateway */
+  uint32_t DownlinksRx2;                /* Sent in RX2, RX1 was busy */
+  uint32_t DownlinksBusy;               /* Dropped, RX1 and RX2 were busy */
+  uint32_t DownlinksLost;               /* Too weak at the device */
+} SimGatewayStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/*!
+ * Interrupt lines: 0 to 15 are the EXTI lines of the GPIO pins
+ */
+#define SIM_IRQ_RTC                     16
+
+/*!
+ * Time of an event that never comes
+ */
+#define SIM_TIME_NEVER                  UINT64_MAX
+
+/* External variables --------------------------------------------------------*/
+extern SimConfig_t SimConfig;
+
+extern SimStats_t SimStats;
+
+extern SimGatewayStats_t SimGatewayStats;
+
+/* Exported functions ------------------------------------------------------- */
+
+/*!
+ * @brief Starts the simulated world: random generator, radio and network
+ */
+void Sim_Init( void );
+
+/*!
+ * @brief Current simulated time
+ */
+SimTime_t Sim_Now( void );
+
+/*!
+ * @brief Initializes an event, it is not armed
+ */
+void Sim_EventInit( SimEvent_t *event, void ( *callback )( void *context ), void *context );
+
+/*!
+ * @brief Arms (or re-arms) an event at an absolute time, not before now
+ */
+void Sim_EventArm( SimEvent_t *event, SimTime_t time );
+
+/*!
+ * @brief Disarms an event, nothing is done if it is not armed
+ */
+void Sim_EventDisarm( SimEvent_t *event );
+
+/*!
+ * @brief Moves the time forward, running the events met on the way. The
+ *        interrupts they raise are delivered if they are not masked.
+ */
+void Sim_Advance( SimTime_t time );
+
+/*!
+ * @brief Sleeps until an interrupt is pending (WFI). The time jumps from
+ *        event to event up to the horizon: the run ends there when it is
+ *        the end of the simulation, a fleet device yields to its worker.
+ */
+void Sim_WaitForInterrupt( void );
+
+/*!
+ * @brief Sets the time up to which the device may run
+ */
+void Sim_SetHorizon( SimTime_t horizon );
+
+/*!
+ * @brief Time the device next needs to run: its first armed event, or the
+ *        end of a busy wait; SIM_TIME_NEVER if there is none
+ */
+SimTime_t Sim_NextEventTime( void );
+
+/*!
+ * @brief Marks an interrupt line pending, it is delivered as soon as the
+ *        interrupts are unmasked and no handler is running
+ */
+void Sim_IrqSetPending( uint32_t line );
+
+/*!
+ * @brief Clears a pending interrupt line
+ */
+void Sim_IrqClearPending( uint32_t line );
+
+/*!
+ * @brief Ends the run and prints the statistics
+ */
+void Sim_Stop( void );
+
+/*!
+ * @brief Prints a simulator trace, prefixed with the simulated time
+ */
+void Sim_Log( const char *format, ... );
+
+/*!
+ * @brief Deterministic random generator of the simulated world
+ */
+uint32_t Sim_Random( void );
+
+/*!
+ * @brief Calls the EXTI handler of a GPIO line (sim_gpio.c)
+ */
+void SimGpio_IrqHandler( uint32_t line );
+
+/*!
+ * @brief Drives the level of a GPIO input, a rising edge on an interrupt
+ *        input makes its line pending
+ */
+void SimGpio_SetInput( GPIO_TypeDef *port, uint16_t pin, uint32_t value );
+
+/*!
+ * @brief Initializes the SX1276 model, in its power on reset state
+ */
+void SimRadio_Init( void );
+
+/*!
+ * @brief Puts the SX1276 model back in its reset state (NRESET pin low)
+ */
+void SimRadio_Reset( void );
+
+/*!
+ * @brief Chip select of the SX1276 model, 0 starts an SPI transaction
+ */
+void SimRadio_Select( uint32_t nss );
+
+/*!
+ * @brief Puts a frame on the air towards the device
+ */
+void SimRadio_Transmit( const SimFrame_t *frame );
+
+/*!
+ * @brief LoRa time on air of a frame, from its Size, PreambleLen and modulation
+ */
+SimTime_t SimRadio_TimeOnAir( const SimFrame_t *frame, bool crcOn, bool implicitHeader, bool lowDatarateOptimize );
+
+/*!
+ * @brief Puts on the air a frame the device transmits, at its start
+ */
+void SimChannel_Transmit( const SimFrame_t *frame );
+
+/*!
+ * @brief Places the devices of a fleet around the gateway
+ */
+void SimChannel_Init( uint32_t nbDevices );
+
+/*!
+ * @brief Distance of a device of the fleet to the gateway, in m
+ */
+uint32_t SimChannel_Distance( uint32_t device );
+
+/*!
+ * @brief Puts on the air an uplink frame of a device of the fleet
+ *
+ * @param [IN] device      index of the device
+ * @param [IN] requestTime time of the application request the frame carries
+ * @param [IN] frame       the frame, from its start
+ */
+void SimChannel_Uplink( uint32_t device, SimTime_t requestTime, const SimFrame_t *frame );
+
+/*!
+ * @brief Decides the fate of the uplink frames over by a time: the gateway
+ *        hands the ones it receives to the network server and schedules
+ *        the answers (SimFleet_Delivered and SimFleet_Downlink)
+ */
+void SimChannel_Resolve( SimTime_t time );
+
+/*!
+ * @brief Initializes the network server stand-in, for a number of devices
+ */
+void SimNetwork_Init( uint32_t nbDevices );
+
+/*!
+ * @brief Hands to the network server a frame the gateway received
+ *
+ * @param [IN]  frame    the uplink, with the RSSI and SNR at the gateway
+ * @param [OUT] downlink the RX1 answer, when downlink->Size is not 0
+ * @retval outcome of the frame
+ */
+SimNetworkStatus_t SimNetwork_Receive( const SimFrame_t *frame, SimFrame_t *downlink );
+
+/*!
+ * @brief Entry point of the application, its main( ) renamed by the Makefile
+ */
+int EndNode_main( void );
+
+/*!
+ * @brief Runs a fleet of devices against a gateway and the network server
+ *        (sim_fleet.c), prints the report at the end
+ */
+int SimFleet_Run( void );
+
+/*!
+ * @brief True in a worker process of the fleet
+ */
+bool SimFleet_IsWorker( void );
+
+/*!
+ * @brief Gives the hand back to the worker, the device has reached its horizon
+ */
+void SimFleet_Yield( void );
+
+/*!
+ * @brief Reports to the worker a frame the device starts to transmit
+ */
+void SimFleet_Uplink( const SimFrame_t *frame );
+
+/*!
+ * @brief The network server got an uplink frame of a device
+ *
+ * @param [IN] device      index of the device
+ * @param [IN] status      outcome of the frame at the network server
+ * @param [IN] latency     from the application request to the end of the frame
+ */
+void SimFleet_Delivered( uint32_t device, SimNetworkStatus_t status, SimTime_t latency );
+
+/*!
+ * @brief Queues a downlink for a device, it is on the air in the next epoch
+ */
+void SimFleet_Downlink( uint32_t device, bool isAck, const SimFrame_t *frame );
+
+/*!
+ * @brief Time of the last LORA_send call of the application (sim_hw.c)
+ */
+extern SimTime_t SimAppRequestTime;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
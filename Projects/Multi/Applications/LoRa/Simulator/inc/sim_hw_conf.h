@@ -0,0 +1,285 @@
+/**
+ ******************************************************************************
+ * @file    sim_hw_conf.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host stand-in for the MCU HAL and the board definitions
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_HW_CONF_H__
+#define __SIM_HW_CONF_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  RESET = 0,
+  SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum
+{
+  HAL_OK       = 0x00,
+  HAL_ERROR    = 0x01,
+  HAL_BUSY     = 0x02,
+  HAL_TIMEOUT  = 0x03
+} HAL_StatusTypeDef;
+
+/* Only the interrupt lines the applications name are listed */
+typedef enum
+{
+  RTC_IRQn                    = 2,
+  EXTI0_1_IRQn                = 5,
+  EXTI2_3_IRQn                = 6,
+  EXTI4_15_IRQn               = 7,
+} IRQn_Type;
+
+/*!
+ * A simulated GPIO port: the mode, output and input levels of its 16 pins
+ */
+typedef struct
+{
+  uint32_t MODE[16];
+  uint32_t ODR;
+  uint32_t IDR;
+  uint32_t BSRR;
+  uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum
+{
+  LED1 = 0,
+  LED2 = 1,
+  LED3 = 2,
+  LED4 = 3,
+  LED_GREEN = LED1,
+  LED_RED1 = LED2,
+  LED_BLUE = LED3,
+  LED_RED2 = LED4
+} Led_TypeDef;
+
+#if defined( CS_PROFILER )
+/* the core debug blocks the critical section profiler reads */
+typedef struct
+{
+  uint32_t CTRL;
+  uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+  uint32_t DEMCR;
+} CoreDebug_Type;
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define SIM_GPIO_NB_PORTS               4
+
+#if defined( CS_PROFILER )
+/* a Cortex-M3 class cycle counter, counting host nanoseconds: a 1 GHz core */
+#define __CORTEX_M                      3U
+#define DWT                             ( SimDwt( ) )
+#define CoreDebug                       ( &SimCoreDebug )
+#define SystemCoreClock                 1000000000U
+#define DWT_CTRL_CYCCNTENA_Msk          ( 1UL << 0 )
+#define CoreDebug_DEMCR_TRCENA_Msk      ( 1UL << 24 )
+
+extern CoreDebug_Type SimCoreDebug;
+#endif
+
+extern GPIO_TypeDef SimGpioPorts[SIM_GPIO_NB_PORTS];
+
+#define GPIOA                           ( &SimGpioPorts[0] )
+#define GPIOB                           ( &SimGpioPorts[1] )
+#define GPIOC                           ( &SimGpioPorts[2] )
+#define GPIOH                           ( &SimGpioPorts[3] )
+
+#define GPIO_PIN_0                      ( ( uint16_t )0x0001 )
+#define GPIO_PIN_1                      ( ( uint16_t )0x0002 )
+#define GPIO_PIN_2                      ( ( uint16_t )0x0004 )
+#define GPIO_PIN_3                      ( ( uint16_t )0x0008 )
+#define GPIO_PIN_4                      ( ( uint16_t )0x0010 )
+#define GPIO_PIN_5                      ( ( uint16_t )0x0020 )
+#define GPIO_PIN_6                      ( ( uint16_t )0x0040 )
+#define GPIO_PIN_7                      ( ( uint16_t )0x0080 )
+#define GPIO_PIN_8                      ( ( uint16_t )0x0100 )
+#define GPIO_PIN_9                      ( ( uint16_t )0x0200 )
+#define GPIO_PIN_10                     ( ( uint16_t )0x0400 )
+#define GPIO_PIN_11                     ( ( uint16_t )0x0800 )
+#define GPIO_PIN_12                     ( ( uint16_t )0x1000 )
+#define GPIO_PIN_13                     ( ( uint16_t )0x2000 )
+#define GPIO_PIN_14                     ( ( uint16_t )0x4000 )
+#define GPIO_PIN_15                     ( ( uint16_t )0x8000 )
+
+#define GPIO_MODE_INPUT                 ( 0x00000000U )
+#define GPIO_MODE_OUTPUT_PP             ( 0x00000001U )
+#define GPIO_MODE_OUTPUT_OD             ( 0x00000011U )
+#define GPIO_MODE_AF_PP                 ( 0x00000002U )
+#define GPIO_MODE_ANALOG                ( 0x00000003U )
+#define GPIO_MODE_IT_RISING             ( 0x10110000U )
+#define GPIO_MODE_IT_FALLING            ( 0x10210000U )
+#define GPIO_MODE_IT_RISING_FALLING     ( 0x10310000U )
+
+#define GPIO_NOPULL                     ( 0x00000000U )
+#define GPIO_PULLUP                     ( 0x00000001U )
+#define GPIO_PULLDOWN                   ( 0x00000002U )
+
+#define GPIO_SPEED_LOW                  ( 0x00000000U )
+#define GPIO_SPEED_MEDIUM               ( 0x00000001U )
+#define GPIO_SPEED_HIGH                 ( 0x00000003U )
+
+/* LORA I/O definition, as on the B-L072Z-LRWAN1 (mlm32l0xx_hw_conf.h) */
+#define RADIO_RESET_PORT                          GPIOC
+#define RADIO_RESET_PIN                           GPIO_PIN_0
+
+#define RADIO_MOSI_PORT                           GPIOA
+#define RADIO_MOSI_PIN                            GPIO_PIN_7
+
+#define RADIO_MISO_PORT                           GPIOA
+#define RADIO_MISO_PIN                            GPIO_PIN_6
+
+#define RADIO_SCLK_PORT                           GPIOB
+#define RADIO_SCLK_PIN                            GPIO_PIN_3
+
+#define RADIO_NSS_PORT                            GPIOA
+#define RADIO_NSS_PIN                             GPIO_PIN_15
+
+#define RADIO_DIO_0_PORT                          GPIOB
+#define RADIO_DIO_0_PIN                           GPIO_PIN_4
+
+#define RADIO_DIO_1_PORT                          GPIOB
+#define RADIO_DIO_1_PIN                           GPIO_PIN_1
+
+#define RADIO_DIO_2_PORT                          GPIOB
+#define RADIO_DIO_2_PIN                           GPIO_PIN_0
+
+#define RADIO_DIO_3_PORT                          GPIOC
+#define RADIO_DIO_3_PIN                           GPIO_PIN_13
+
+#define RADIO_TCXO_VCC_PORT                       GPIOA
+#define RADIO_TCXO_VCC_PIN                        GPIO_PIN_12
+
+#define RADIO_ANT_SWITCH_PORT_RX                  GPIOA //CRF1
+#define RADIO_ANT_SWITCH_PIN_RX                   GPIO_PIN_1
+
+#define RADIO_ANT_SWITCH_PORT_TX_BOOST            GPIOC //CRF3
+#define RADIO_ANT_SWITCH_PIN_TX_BOOST             GPIO_PIN_1
+
+#define RADIO_ANT_SWITCH_PORT_TX_RFO              GPIOC //CRF2
+#define RADIO_ANT_SWITCH_PIN_TX_RFO               GPIO_PIN_2
+
+#define USER_BUTTON_GPIO_PORT                     GPIOB
+#define USER_BUTTON_PIN                           GPIO_PIN_2
+
+#define RTC_OUTPUT_DISABLE                        0
+
+/* Exported macros -----------------------------------------------------------*/
+#define __weak                          __attribute__( ( weak ) )
+#define __STATIC_INLINE                 static inline
+#define __NOP( )                        do { } while( 0 )
+#define __DMB( )                        __sync_synchronize( )
+#define __CLZ( x )                      ( ( ( x ) == 0 ) ? 32 : __builtin_clz( x ) )
+
+#define LED_Toggle( x )                 SimLedWrite( x, 2 )
+#define LED_On( x )                     SimLedWrite( x, 1 )
+#define LED_Off( x )                    SimLedWrite( x, 0 )
+
+/*!
+ * Application transmission period, in ms, the End_Node APP_TX_DUTYCYCLE
+ */
+extern uint32_t SimAppTxDutyCycle;
+
+/* Exported functions ------------------------------------------------------- */
+
+HAL_StatusTypeDef HAL_Init( void );
+
+/*!
+ * @brief Reads the simulated PRIMASK (1 when the interrupts are masked)
+ */
+uint32_t __get_PRIMASK( void );
+
+/*!
+ * @brief Writes the simulated PRIMASK, unmasking delivers the pending interrupts
+ */
+void __set_PRIMASK( uint32_t priMask );
+
+void __disable_irq( void );
+
+void __enable_irq( void );
+
+#if defined( CS_PROFILER )
+/*!
+ * @brief The DWT, its CYCCNT loaded with the host monotonic clock in ns
+ */
+DWT_Type *SimDwt( void );
+#endif
+
+/*!
+ * @brief Drives a board LED, value 2 toggles it
+ */
+void SimLedWrite( Led_TypeDef led, uint32_t value );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_HW_CONF_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,631 @@
+/**
+ ******************************************************************************
+ * @file    sim_channel.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Radio channel and gateway of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "hw.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * What happens to an uplink frame at the gateway
+ */
+typedef enum
+{
+  SIM_CHANNEL_PENDING = 0,              /* On the air, or not decided yet */
+  SIM_CHANNEL_RECEIVED,
+  SIM_CHANNEL_BELOW_SENSITIVITY,
+  SIM_CHANNEL_NO_DEMODULATOR,
+  SIM_CHANNEL_COLLISION,
+  SIM_CHANNEL_TRANSMITTING,
+} SimChannelFate_t;
+
+/*!
+ * An uplink frame of the fleet on the air
+ */
+typedef struct
+{
+  SimFrame_t Frame;
+  uint32_t Device;
+  SimTime_t RequestTime;
+  double Power;                         /* Received power at the gateway, in dBm */
+  bool Demodulating;                    /* Holds a demodulation path of the gateway */
+  bool Resolved;
+  SimChannelFate_t Fate;
+} SimChannelFrame_t;
+
+/*!
+ * A transmission of the gateway
+ */
+typedef struct
+{
+  SimTime_t Start;
+  SimTime_t End;
+} SimChannelTx_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/*!
+ * Transmit power of the devices and of the gateway, in dBm
+ */
+#define SIM_CHANNEL_TX_POWER            14.0
+
+/*!
+ * Thermal noise over 125 kHz and a 6 dB noise figure, in dBm
+ */
+#define SIM_CHANNEL_NOISE_FLOOR         -117.0
+
+/*!
+ * Okumura-Hata path loss, urban, 868 MHz, gateway at 30 m, device at 1.5 m:
+ * A + B * log10( d in km ), in dB
+ */
+#define SIM_CHANNEL_PATH_LOSS_A         126.0
+#define SIM_CHANNEL_PATH_LOSS_B         35.2
+
+/*!
+ * Standard deviations of the shadowing (per device) and of the fading
+ * (per frame), in dB
+ */
+#define SIM_CHANNEL_SHADOWING           6.0
+#define SIM_CHANNEL_FADING              3.0
+
+#define SIM_CHANNEL_MIN_DISTANCE        10
+
+/*!
+ * Demodulation paths of the gateway (SX1301)
+ */
+#define SIM_CHANNEL_DEMODULATORS        8
+
+/*!
+ * A frame survives an overlapping frame of its channel and SF if it is
+ * that much stronger, in dB
+ */
+#define SIM_CHANNEL_CAPTURE             6.0
+
+/*!
+ * RX2 of EU868: 1 s after RX1, 869.525 MHz, SF12 BW125
+ */
+#define SIM_CHANNEL_RX2_OFFSET          1000000
+#define SIM_CHANNEL_RX2_FREQUENCY       869525000
+#define SIM_CHANNEL_RX2_SF              12
+#define SIM_CHANNEL_RX2_BANDWIDTH       7
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+SimGatewayStats_t SimGatewayStats;
+
+/*!
+ * SNR the demodulator needs, from SF7 to SF12, in dB
+ */
+static const double RequiredSnr[6] = { -7.5, -10.0, -12.5, -15.0, -17.5, -20.0 };
+
+/*!
+ * Frame and answer of a single device, on a fixed link
+ */
+static SimFrame_t Uplink;
+
+static SimEvent_t UplinkEvent;
+
+static SimFrame_t Downlink;
+
+static SimEvent_t DownlinkEvent;
+
+static bool LinkInitialized = false;
+
+/*!
+ * Distance (in m) and shadowing (in dB) of the devices of the fleet
+ */
+static uint32_t *Distances = NULL;
+
+static double *Shadowings = NULL;
+
+static uint32_t NbDevices = 0;
+
+/*!
+ * Uplink frames on the air or that may still be overlapped, by start time.
+ * The frames from AirNew on have just been reported by the devices.
+ */
+static SimChannelFrame_t *Air = NULL;
+
+static uint32_t AirSize = 0;
+
+static uint32_t AirMax = 0;
+
+static uint32_t AirNew = 0;
+
+/*!
+ * Transmissions of the gateway that may still overlap an uplink
+ */
+static SimChannelTx_t *GatewayTx = NULL;
+
+static uint32_t NbGatewayTx = 0;
+
+static uint32_t MaxGatewayTx = 0;
+
+/*!
+ * Random generator of the channel, apart from the ones of the devices
+ */
+static uint32_t ChannelRandomState = 1;
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void SimChannel_OnUplinkEnd( void *context );
+
+static void SimChannel_OnDownlink( void *context );
+
+/*!
+ * @brief Uniform random in ] 0, 1 [
+ */
+static double SimChannel_Uniform( void );
+
+/*!
+ * @brief Normal random of a standard deviation
+ */
+static double SimChannel_Normal( double sigma );
+
+/*!
+ * @brief Received power of a transmission between a device and the gateway, in dBm
+ */
+static double SimChannel_Power( uint32_t device );
+
+/*!
+ * @brief SNR of a received power over the bandwidth of a frame
+ */
+static double SimChannel_Snr( const SimFrame_t *frame, double power );
+
+/*!
+ * @brief True when the gateway transmits in a time interval
+ */
+static bool SimChannel_GatewayBusy( SimTime_t start, SimTime_t end );
+
+/*!
+ * @brief Decides whether a new frame is detected and gets a demodulation path
+ */
+static void SimChannel_Detect( uint32_t index );
+
+/*!
+ * @brief Decides the fate of a frame that is over, hands it to the network
+ */
+static void SimChannel_Receive( SimChannelFrame_t *frame );
+
+/*!
+ * @brief Sends the answer of the network server in RX1, else in RX2
+ */
+static void SimChannel_SendDownlink( uint32_t device, bool isAck, SimFrame_t *downlink );
+
+static int SimChannel_CompareStart( const void *a, const void *b );
+
+static int SimChannel_CompareEnd( const void *a, const void *b );
+
+/* Exported functions ---------------------------------------------------------*/
+
+void SimChannel_Transmit( const SimFrame_t *frame )
+{
+  if( SimFleet_IsWorker( ) == true )
+  {
+    SimFleet_Uplink( frame );
+    return;
+  }
+
+  /* a single device: the network server gets the frame at its end */
+  if( LinkInitialized == false )
+  {
+    Sim_EventInit( &UplinkEvent, SimChannel_OnUplinkEnd, NULL );
+    Sim_EventInit( &DownlinkEvent, SimChannel_OnDownlink, NULL );
+    LinkInitialized = true;
+  }
+  Uplink = *frame;
+  Sim_EventArm( &UplinkEvent, Uplink.End );
+}
+
+void SimChannel_Init( uint32_t nbDevices )
+{
+  ChannelRandomState = ( SimConfig.Seed * 0x9E3779B9 ) ^ 0x5BD1E995;
+  if( ChannelRandomState == 0 )
+  {
+    ChannelRandomState = 1;
+  }
+  NbDevices = nbDevices;
+  Distances = calloc( nbDevices, sizeof( uint32_t ) );
+  Shadowings = calloc( nbDevices, sizeof( double ) );
+  if( ( Distances == NULL ) || ( Shadowings == NULL ) )
+  {
+    Sim_Log( "channel: out of memory for %u devices", nbDevices );
+    exit( 1 );
+  }
+
+  /* uniform over the disc of the cell */
+  for( uint32_t i = 0; i < nbDevices; i++ )
+  {
+    Distances[i] = ( uint32_t )( SimConfig.Radius * sqrt( SimChannel_Uniform( ) ) );
+    if( Distances[i] < SIM_CHANNEL_MIN_DISTANCE )
+    {
+      Distances[i] = SIM_CHANNEL_MIN_DISTANCE;
+    }
+    Shadowings[i] = SimChannel_Normal( SIM_CHANNEL_SHADOWING );
+  }
+}
+
+uint32_t SimChannel_Distance( uint32_t device )
+{
+  return Distances[device];
+}
+
+void SimChannel_Uplink( uint32_t device, SimTime_t requestTime, const SimFrame_t *frame )
+{
+  if( AirSize == AirMax )
+  {
+    AirMax = ( AirMax != 0 ) ? 2 * AirMax : 256;
+    Air = realloc( Air, AirMax * sizeof( SimChannelFrame_t ) );
+    if( Air == NULL )
+    {
+      Sim_Log( "channel: out of memory for %u frames", AirMax );
+      exit( 1 );
+    }
+  }
+  Air[AirSize].Frame = *frame;
+  Air[AirSize].Device = device;
+  Air[AirSize].RequestTime = requestTime;
+  Air[AirSize].Power = 0;
+  Air[AirSize].Demodulating = false;
+  Air[AirSize].Resolved = false;
+  Air[AirSize].Fate = SIM_CHANNEL_PENDING;
+  AirSize++;
+}
+
+void SimChannel_Resolve( SimTime_t time )
+{
+  uint32_t *over;
+  uint32_t nbOver = 0;
+  uint32_t kept = 0;
+  SimTime_t firstStart = time;
+
+  /* the new frames start after the ones already known: detected by start time */
+  qsort( &Air[AirNew], AirSize - AirNew, sizeof( SimChannelFrame_t ), SimChannel_CompareStart );
+  for( ; AirNew < AirSize; AirNew++ )
+  {
+    SimChannel_Detect( AirNew );
+  }
+
+  /* the frames over are all known with the frames they overlap, by end time */
+  over = malloc( ( AirSize + 1 ) * sizeof( uint32_t ) );
+  if( over == NULL )
+  {
+    Sim_Log( "channel: out of memory" );
+    exit( 1 );
+  }
+  for( uint32_t i = 0; i < AirSize; i++ )
+  {
+    if( ( Air[i].Resolved == false ) && ( Air[i].Frame.End <= time ) )
+    {
+      over[nbOver++] = i;
+    }
+  }
+  qsort( over, nbOver, sizeof( uint32_t ), SimChannel_CompareEnd );
+  for( uint32_t i = 0; i < nbOver; i++ )
+  {
+    SimChannel_Receive( &Air[over[i]] );
+  }
+  free( over );
+
+  /* the frames decided stay as long as an undecided one may overlap them */
+  for( uint32_t i = 0; i < AirSize; i++ )
+  {
+    if( ( Air[i].Resolved == false ) && ( Air[i].Frame.Start < firstStart ) )
+    {
+      firstStart = Air[i].Frame.Start;
+    }
+  }
+  for( uint32_t i = 0; i < AirSize; i++ )
+  {
+    if( ( Air[i].Resolved == false ) || ( Air[i].Frame.End > firstStart ) )
+    {
+      Air[kept++] = Air[i];
+    }
+  }
+  AirSize = kept;
+  AirNew = kept;
+
+  kept = 0;
+  for( uint32_t i = 0; i < NbGatewayTx; i++ )
+  {
+    if( GatewayTx[i].End > firstStart )
+    {
+      GatewayTx[kept++] = GatewayTx[i];
+    }
+  }
+  NbGatewayTx = kept;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void SimChannel_OnUplinkEnd( void *context )
+{
+  Uplink.Rssi = SimConfig.Rssi;
+  Uplink.Snr = SimConfig.Snr;
+  SimNetwork_Receive( &Uplink, &Downlink );
+  if( Downlink.Size != 0 )
+  {
+    Downlink.Rssi = SimConfig.Rssi;
+    Downlink.Snr = SimConfig.Snr;
+    Sim_EventArm( &DownlinkEvent, Downlink.Start );
+  }
+}
+
+static void SimChannel_OnDownlink( void *context )
+{
+  SimStats.Downlinks++;
+  if( SimConfig.Verbose == true )
+  {
+    Sim_Log( "network: downlink %u bytes", Downlink.Size );
+  }
+  SimRadio_Transmit( &Downlink );
+}
+
+static double SimChannel_Uniform( void )
+{
+  /* xorshift32 */
+  ChannelRandomState ^= ChannelRandomState << 13;
+  ChannelRandomState ^= ChannelRandomState >> 17;
+  ChannelRandomState ^= ChannelRandomState << 5;
+  return ( ( double )ChannelRandomState + 0.5 ) / 4294967296.0;
+}
+
+static double SimChannel_Normal( double sigma )
+{
+  /* Box-Muller */
+  double u1 = SimChannel_Uniform( );
+  double u2 = SimChannel_Uniform( );
+
+  return sigma * sqrt( -2.0 * log( u1 ) ) * cos( 2.0 * M_PI * u2 );
+}
+
+static double SimChannel_Power( uint32_t device )
+{
+  double pathLoss = SIM_CHANNEL_PATH_LOSS_A + SIM_CHANNEL_PATH_LOSS_B * log10( ( double )Distances[device] / 1000.0 );
+
+  return SIM_CHANNEL_TX_POWER - pathLoss - Shadowings[device] + SimChannel_Normal( SIM_CHANNEL_FADING );
+}
+
+static double SimChannel_Snr( const SimFrame_t *frame, double power )
+{
+  /* the noise doubles with the bandwidth */
+  return power - ( SIM_CHANNEL_NOISE_FLOOR + 3.0 * ( frame->Bandwidth - 7 ) );
+}
+
+static bool SimChannel_GatewayBusy( SimTime_t start, SimTime_t end )
+{
+  for( uint32_t i = 0; i < NbGatewayTx; i++ )
+  {
+    if( ( GatewayTx[i].Start < end ) && ( GatewayTx[i].End > start ) )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void SimChannel_Detect( uint32_t index )
+{
+  SimChannelFrame_t *frame = &Air[index];
+  uint8_t sf = frame->Frame.SpreadingFactor;
+  double snr;
+  uint32_t busy = 0;
+
+  frame->Power = SimChannel_Power( frame->Device );
+  snr = SimChannel_Snr( &frame->Frame, frame->Power );
+  frame->Frame.Rssi = ( int16_t )lround( frame->Power );
+  frame->Frame.Snr = ( int8_t )lround( ( snr < -128 ) ? -128 : ( ( snr > 127 ) ? 127 : snr ) );
+
+  SimGatewayStats.Frames++;
+  if( ( sf >= 7 ) && ( sf <= 12 ) )
+  {
+    SimGatewayStats.FramesPerSf[sf - 7]++;
+  }
+  if( ( sf < 7 ) || ( sf > 12 ) || ( snr < RequiredSnr[sf - 7] ) )
+  {
+    frame->Fate = SIM_CHANNEL_BELOW_SENSITIVITY;
+    return;
+  }
+  if( SimChannel_GatewayBusy( frame->Frame.Start, frame->Frame.Start + 1 ) == true )
+  {
+    frame->Fate = SIM_CHANNEL_TRANSMITTING;
+    return;
+  }
+  /* a path is held from the preamble detection to the end of the frame */
+  for( uint32_t i = 0; i < index; i++ )
+  {
+    if( ( Air[i].Demodulating == true ) && ( Air[i].Frame.End > frame->Frame.Start ) )
+    {
+      busy++;
+    }
+  }
+  if( busy >= SIM_CHANNEL_DEMODULATORS )
+  {
+    frame->Fate = SIM_CHANNEL_NO_DEMODULATOR;
+    return;
+  }
+  frame->Demodulating = true;
+}
+
+static void SimChannel_Receive( SimChannelFrame_t *frame )
+{
+  const SimFrame_t *air = &frame->Frame;
+  SimFrame_t downlink;
+  SimNetworkStatus_t status;
+  bool confirmed;
+
+  frame->Resolved = true;
+  frame->Demodulating = false;
+  if( frame->Fate == SIM_CHANNEL_PENDING )
+  {
+    if( SimChannel_GatewayBusy( air->Start, air->End ) == true )
+    {
+      frame->Fate = SIM_CHANNEL_TRANSMITTING;
+    }
+    else
+    {
+      frame->Fate = SIM_CHANNEL_RECEIVED;
+      for( uint32_t i = 0; i < AirSize; i++ )
+      {
+        const SimFrame_t *other = &Air[i].Frame;
+
+        if( ( &Air[i] == frame ) || ( other->Frequency != air->Frequency ) ||
+            ( other->SpreadingFactor != air->SpreadingFactor ) || ( other->Bandwidth != air->Bandwidth ) ||
+            ( other->Start >= air->End ) || ( other->End <= air->Start ) )
+        {
+          continue;
+        }
+        if( ( frame->Power - Air[i].Power ) < SIM_CHANNEL_CAPTURE )
+        {
+          frame->Fate = SIM_CHANNEL_COLLISION;
+          break;
+        }
+      }
+    }
+  }
+
+  switch( frame->Fate )
+  {
+  case SIM_CHANNEL_BELOW_SENSITIVITY:
+    SimGatewayStats.BelowSensitivity++;
+    return;
+  case SIM_CHANNEL_NO_DEMODULATOR:
+    SimGatewayStats.NoDemodulator++;
+    return;
+  case SIM_CHANNEL_COLLISION:
+    SimGatewayStats.Collisions++;
+    return;
+  case SIM_CHANNEL_TRANSMITTING:
+    SimGatewayStats.Transmitting++;
+    return;
+  default:
+    break;
+  }
+
+  SimGatewayStats.Received++;
+  confirmed = ( air->Payload[0] & 0xE0 ) == 0x80;
+  status = SimNetwork_Receive( air, &downlink );
+  SimFleet_Delivered( frame->Device, status, air->End - frame->RequestTime );
+  if( downlink.Size != 0 )
+  {
+    SimChannel_SendDownlink( frame->Device, confirmed && ( status != SIM_NETWORK_DROPPED ), &downlink );
+  }
+}
+
+static void SimChannel_SendDownlink( uint32_t device, bool isAck, SimFrame_t *downlink )
+{
+  double power;
+  double snr;
+
+  if( SimChannel_GatewayBusy( downlink->Start, downlink->End ) == true )
+  {
+    downlink->Start += SIM_CHANNEL_RX2_OFFSET;
+    downlink->Frequency = SIM_CHANNEL_RX2_FREQUENCY;
+    downlink->SpreadingFactor = SIM_CHANNEL_RX2_SF;
+    downlink->Bandwidth = SIM_CHANNEL_RX2_BANDWIDTH;
+    downlink->End = downlink->Start + SimRadio_TimeOnAir( downlink, false, false, true );
+    if( SimChannel_GatewayBusy( downlink->Start, downlink->End ) == true )
+    {
+      SimGatewayStats.DownlinksBusy++;
+      return;
+    }
+    SimGatewayStats.DownlinksRx2++;
+  }
+
+  if( NbGatewayTx == MaxGatewayTx )
+  {
+    MaxGatewayTx = ( MaxGatewayTx != 0 ) ? 2 * MaxGatewayTx : 64;
+    GatewayTx = realloc( GatewayTx, MaxGatewayTx * sizeof( SimChannelTx_t ) );
+    if( GatewayTx == NULL )
+    {
+      Sim_Log( "channel: out of memory for %u transmissions", MaxGatewayTx );
+      exit( 1 );
+    }
+  }
+  GatewayTx[NbGatewayTx].Start = downlink->Start;
+  GatewayTx[NbGatewayTx].End = downlink->End;
+  NbGatewayTx++;
+  SimGatewayStats.Downlinks++;
+
+  power = SimChannel_Power( device );
+  snr = SimChannel_Snr( downlink, power );
+  if( snr < RequiredSnr[downlink->SpreadingFactor - 7] )
+  {
+    SimGatewayStats.DownlinksLost++;
+    return;
+  }
+  downlink->Rssi = ( int16_t )lround( power );
+  downlink->Snr = ( int8_t )lround( ( snr > 127 ) ? 127 : snr );
+  SimFleet_Downlink( device, isAck, downlink );
+}
+
+static int SimChannel_CompareStart( const void *a, const void *b )
+{
+  const SimChannelFrame_t *frameA = a;
+  const SimChannelFrame_t *frameB = b;
+
+  if( frameA->Frame.Start != frameB->Frame.Start )
+  {
+    return ( frameA->Frame.Start < frameB->Frame.Start ) ? -1 : 1;
+  }
+  return ( frameA->Device < frameB->Device ) ? -1 : ( frameA->Device > frameB->Device );
+}
+
+static int SimChannel_CompareEnd( const void *a, const void *b )
+{
+  const SimChannelFrame_t *frameA = &Air[*( const uint32_t * )a];
+  const SimChannelFrame_t *frameB = &Air[*( const uint32_t * )b];
+
+  if( frameA->Frame.End != frameB->Frame.End )
+  {
+    return ( frameA->Frame.End < frameB->Frame.End ) ? -1 : 1;
+  }
+  return ( frameA->Device < frameB->Device ) ? -1 : ( frameA->Device > frameB->Device );
+}
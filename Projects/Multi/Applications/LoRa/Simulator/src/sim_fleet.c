@@ -0,0 +1,847 @@
+/**
+ ******************************************************************************
+ * @file    sim_fleet.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Fleet of devices of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "hw.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * Commands of the coordinator to its workers
+ */
+typedef enum
+{
+  SIM_FLEET_EPOCH = 0,                  /* Runs the devices up to the horizon */
+  SIM_FLEET_FINISH,                     /* Returns the results of the devices */
+} SimFleetCommandType_t;
+
+typedef struct
+{
+  uint32_t Type;
+  uint32_t NbDownlinks;                 /* SimFleetDownlink_t following the command */
+  SimTime_t Horizon;
+} SimFleetCommand_t;
+
+typedef struct
+{
+  uint32_t Device;
+  uint32_t IsAck;                       /* Answers a confirmed uplink */
+  SimFrame_t Frame;
+} SimFleetDownlink_t;
+
+/*!
+ * Answer of a worker to an epoch
+ */
+typedef struct
+{
+  SimTime_t Next;                       /* First time one of its devices needs to run */
+  uint32_t NbUplinks;                   /* SimFleetUplink_t following the reply */
+} SimFleetReply_t;
+
+typedef struct
+{
+  uint32_t Device;
+  SimTime_t RequestTime;
+  SimFrame_t Frame;
+} SimFleetUplink_t;
+
+/*!
+ * Answer of a worker to the finish command, one per device
+ */
+typedef struct
+{
+  uint32_t Device;
+  uint32_t AcksReceived;
+  SimStats_t Stats;
+} SimFleetResult_t;
+
+/*!
+ * A device hosted by a worker
+ */
+typedef struct
+{
+  ucontext_t Context;
+  void *Stack;
+  uint8_t *Image;                       /* Its sim_device_data and sim_device_bss sections */
+  SimTime_t Next;                       /* Time it needs to run, its power on until it is started */
+  bool Started;
+  SimTime_t AckCheck;                   /* End of an ACK sent to it, SIM_TIME_NEVER for none */
+  uint32_t AckRxFrames;                 /* Frames it had received before the ACK */
+  uint32_t AcksReceived;
+} SimFleetDevice_t;
+
+/*!
+ * A worker process, seen from the coordinator
+ */
+typedef struct
+{
+  pid_t Pid;
+  int Command;
+  int Reply;
+  SimFleetDownlink_t *Downlinks;        /* Queued for the next epoch */
+  uint32_t NbDownlinks;
+  uint32_t MaxDownlinks;
+} SimFleetWorker_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/*!
+ * Length of an epoch: the devices run that far ahead of the gateway. It is
+ * shorter than the RX1 delay so that the answers reach the devices in time.
+ */
+#define SIM_FLEET_LOOKAHEAD             250000
+
+#define SIM_FLEET_STACK_SIZE            ( 64 * 1024 )
+
+#define SIM_FLEET_LATENCY_BUCKETS       9
+#define SIM_FLEET_PDR_BUCKETS           10
+#define SIM_FLEET_AIRTIME_BUCKETS       6
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/*!
+ * Bounds of the sections holding the variables of the devices, from the
+ * linker: the Makefile renames the .data and .bss of the device objects
+ */
+extern uint8_t __start_sim_device_data[];
+extern uint8_t __stop_sim_device_data[];
+extern uint8_t __start_sim_device_bss[];
+extern uint8_t __stop_sim_device_bss[];
+
+static bool IsWorker = false;
+
+static uint32_t NbWorkers = 1;
+
+static uint32_t WorkerIndex = 0;
+
+/*!
+ * Devices of this worker: device WorkerIndex + n * NbWorkers is the n-th
+ */
+static SimFleetDevice_t *Devices = NULL;
+
+static uint32_t NbHosted = 0;
+
+/*!
+ * Device whose variables are in the sections, NbHosted for none
+ */
+static uint32_t Loaded = 0;
+
+static ucontext_t WorkerContext;
+
+static SimTime_t Horizon = 0;
+
+/*!
+ * Uplinks the devices of this worker started in the epoch
+ */
+static SimFleetUplink_t *Uplinks = NULL;
+
+static uint32_t NbUplinks = 0;
+
+static uint32_t MaxUplinks = 0;
+
+static SimFleetWorker_t *Workers = NULL;
+
+/*!
+ * Network results of each device, in the coordinator
+ */
+static uint32_t *Delivered = NULL;
+
+static bool *Joined = NULL;
+
+static uint32_t Repeated = 0;
+
+static uint32_t LatencyHistogram[SIM_FLEET_LATENCY_BUCKETS];
+
+static const SimTime_t LatencyBounds[SIM_FLEET_LATENCY_BUCKETS - 1] =
+{
+  1000000, 2000000, 5000000, 10000000, 30000000, 60000000, 120000000, 300000000
+};
+
+static const char *const LatencyLabels[SIM_FLEET_LATENCY_BUCKETS] =
+{
+  "< 1 s", "1-2 s", "2-5 s", "5-10 s", "10-30 s", "30-60 s", "1-2 min", "2-5 min", "> 5 min"
+};
+
+static const char *const PdrLabels[SIM_FLEET_PDR_BUCKETS] =
+{
+  "0-10 %", "10-20 %", "20-30 %", "30-40 %", "40-50 %", "50-60 %", "60-70 %", "70-80 %", "80-90 %", "90-100 %"
+};
+
+/*!
+ * Bounds of the airtime buckets, in thousandth of the time
+ */
+static const uint32_t AirtimeBounds[SIM_FLEET_AIRTIME_BUCKETS - 1] = { 1, 2, 5, 10, 20 };
+
+static const char *const AirtimeLabels[SIM_FLEET_AIRTIME_BUCKETS] =
+{
+  "< 0.1 %", "0.1-0.2 %", "0.2-0.5 %", "0.5-1 %", "1-2 %", "> 2 %"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief Hash of a device index, for its power on time and its uplink type
+ */
+static uint32_t SimFleet_Hash( uint32_t device, uint32_t salt );
+
+static SimTime_t SimFleet_PowerOn( uint32_t device );
+
+static bool SimFleet_IsConfirmed( uint32_t device );
+
+static void SimFleet_Write( int fd, const void *buffer, size_t size );
+
+static void SimFleet_Read( int fd, void *buffer, size_t size );
+
+/*!
+ * @brief Main loop of a worker process, never returns
+ */
+static void SimFleet_Worker( int command, int reply );
+
+/*!
+ * @brief Puts the variables of a device in the sections, saving the ones there
+ */
+static void SimFleet_Load( uint32_t local );
+
+/*!
+ * @brief Runs a device up to the horizon
+ */
+static void SimFleet_Resume( uint32_t local );
+
+/*!
+ * @brief Entry point of the coroutine of a device
+ */
+static void SimFleet_DeviceMain( void );
+
+/*!
+ * @brief Counts the ACK sent to the loaded device once it is over
+ */
+static void SimFleet_CheckAck( uint32_t local, bool finish );
+
+static void SimFleet_Report( const SimFleetResult_t *results, double wall );
+
+static void SimFleet_PrintHistogram( const char *title, const char *const *labels, const uint32_t *counts, uint32_t nb );
+
+/* Exported functions ---------------------------------------------------------*/
+
+int SimFleet_Run( void )
+{
+  uint32_t nbDevices = SimConfig.Devices;
+  SimFleetResult_t *results;
+  SimFleetCommand_t command;
+  SimFleetReply_t reply;
+  SimFleetUplink_t uplink;
+  SimTime_t barrier = 0;
+  SimTime_t next = 0;
+  struct timespec wallStart;
+  struct timespec wallEnd;
+
+  clock_gettime( CLOCK_MONOTONIC, &wallStart );
+
+  /* the devices trace nothing: a fleet is judged on its report */
+  SimConfig.Verbose = false;
+  SimConfig.Quiet = true;
+
+  NbWorkers = ( SimConfig.Jobs != 0 ) ? SimConfig.Jobs : ( uint32_t )sysconf( _SC_NPROCESSORS_ONLN );
+  if( NbWorkers > nbDevices )
+  {
+    NbWorkers = nbDevices;
+  }
+  if( NbWorkers == 0 )
+  {
+    NbWorkers = 1;
+  }
+  Workers = calloc( NbWorkers, sizeof( SimFleetWorker_t ) );
+  Delivered = calloc( nbDevices, sizeof( uint32_t ) );
+  Joined = calloc( nbDevices, sizeof( bool ) );
+  results = calloc( nbDevices, sizeof( SimFleetResult_t ) );
+  if( ( Workers == NULL ) || ( Delivered == NULL ) || ( Joined == NULL ) || ( results == NULL ) )
+  {
+    printf( "fleet: out of memory for %u devices\n", nbDevices );
+    return 1;
+  }
+
+  printf( "fleet: %u devices in %u m, %u %% confirmed, one uplink every %u s, %u workers\n", nbDevices,
+          SimConfig.Radius, SimConfig.Confirmed, SimAppTxDutyCycle / 1000, NbWorkers );
+  fflush( stdout );
+
+  for( uint32_t w = 0; w < NbWorkers; w++ )
+  {
+    int command[2];
+    int reply[2];
+
+    if( ( pipe( command ) != 0 ) || ( pipe( reply ) != 0 ) )
+    {
+      perror( "fleet: pipe" );
+      return 1;
+    }
+    Workers[w].Pid = fork( );
+    if( Workers[w].Pid < 0 )
+    {
+      perror( "fleet: fork" );
+      return 1;
+    }
+    if( Workers[w].Pid == 0 )
+    {
+      /* the pipes of the workers forked before are not this one's business */
+      for( uint32_t i = 0; i < w; i++ )
+      {
+        close( Workers[i].Command );
+        close( Workers[i].Reply );
+      }
+      close( command[1] );
+      close( reply[0] );
+      WorkerIndex = w;
+      SimFleet_Worker( command[0], reply[1] );
+    }
+    close( command[0] );
+    close( reply[1] );
+    Workers[w].Command = command[1];
+    Workers[w].Reply = reply[0];
+  }
+
+  SimNetwork_Init( nbDevices );
+  SimChannel_Init( nbDevices );
+
+  while( barrier < SimConfig.Duration )
+  {
+    /* nothing happens before the first device needs to run */
+    if( next > barrier )
+    {
+      barrier = ( next < SimConfig.Duration ) ? next : SimConfig.Duration;
+    }
+    barrier = ( ( SimConfig.Duration - barrier ) > SIM_FLEET_LOOKAHEAD ) ? barrier + SIM_FLEET_LOOKAHEAD : SimConfig.Duration;
+
+    for( uint32_t w = 0; w < NbWorkers; w++ )
+    {
+      command.Type = SIM_FLEET_EPOCH;
+      command.NbDownlinks = Workers[w].NbDownlinks;
+      command.Horizon = barrier;
+      SimFleet_Write( Workers[w].Command, &command, sizeof( command ) );
+      SimFleet_Write( Workers[w].Command, Workers[w].Downlinks, Workers[w].NbDownlinks * sizeof( SimFleetDownlink_t ) );
+      Workers[w].NbDownlinks = 0;
+    }
+    next = SIM_TIME_NEVER;
+    for( uint32_t w = 0; w < NbWorkers; w++ )
+    {
+      SimFleet_Read( Workers[w].Reply, &reply, sizeof( reply ) );
+      if( reply.Next < next )
+      {
+        next = reply.Next;
+      }
+      for( uint32_t i = 0; i < reply.NbUplinks; i++ )
+      {
+        SimFleet_Read( Workers[w].Reply, &uplink, sizeof( uplink ) );
+        SimChannel_Uplink( uplink.Device, uplink.RequestTime, &uplink.Frame );
+      }
+    }
+    SimChannel_Resolve( barrier );
+  }
+
+  for( uint32_t w = 0; w < NbWorkers; w++ )
+  {
+    command.Type = SIM_FLEET_FINISH;
+    command.NbDownlinks = 0;
+    command.Horizon = barrier;
+    SimFleet_Write( Workers[w].Command, &command, sizeof( command ) );
+  }
+  for( uint32_t d = 0; d < nbDevices; d++ )
+  {
+    SimFleetResult_t result;
+
+    SimFleet_Read( Workers[d % NbWorkers].Reply, &result, sizeof( result ) );
+    results[result.Device] = result;
+  }
+  for( uint32_t w = 0; w < NbWorkers; w++ )
+  {
+    waitpid( Workers[w].Pid, NULL, 0 );
+  }
+
+  clock_gettime( CLOCK_MONOTONIC, &wallEnd );
+  SimFleet_Report( results, ( double )( wallEnd.tv_sec - wallStart.tv_sec ) + ( double )( wallEnd.tv_nsec - wallStart.tv_nsec ) / 1e9 );
+  return 0;
+}
+
+bool SimFleet_IsWorker( void )
+{
+  return IsWorker;
+}
+
+void SimFleet_Yield( void )
+{
+  swapcontext( &Devices[Loaded].Context, &WorkerContext );
+}
+
+void SimFleet_Uplink( const SimFrame_t *frame )
+{
+  if( NbUplinks == MaxUplinks )
+  {
+    MaxUplinks = ( MaxUplinks != 0 ) ? 2 * MaxUplinks : 64;
+    Uplinks = realloc( Uplinks, MaxUplinks * sizeof( SimFleetUplink_t ) );
+    if( Uplinks == NULL )
+    {
+      Sim_Log( "fleet: out of memory for %u uplinks", MaxUplinks );
+      _exit( 1 );
+    }
+  }
+  Uplinks[NbUplinks].Device = SimConfig.Device;
+  Uplinks[NbUplinks].RequestTime = SimAppRequestTime;
+  Uplinks[NbUplinks].Frame = *frame;
+  NbUplinks++;
+}
+
+void SimFleet_Delivered( uint32_t device, SimNetworkStatus_t status, SimTime_t latency )
+{
+  uint32_t bucket = 0;
+
+  switch( status )
+  {
+  case SIM_NETWORK_JOINED:
+    Joined[device] = true;
+    break;
+  case SIM_NETWORK_UPLINK:
+    Delivered[device]++;
+    while( ( bucket < ( SIM_FLEET_LATENCY_BUCKETS - 1 ) ) && ( latency >= LatencyBounds[bucket] ) )
+    {
+      bucket++;
+    }
+    LatencyHistogram[bucket]++;
+    break;
+  case SIM_NETWORK_REPEATED:
+    Repeated++;
+    break;
+  default:
+    break;
+  }
+}
+
+void SimFleet_Downlink( uint32_t device, bool isAck, const SimFrame_t *frame )
+{
+  SimFleetWorker_t *worker = &Workers[device % NbWorkers];
+
+  if( worker->NbDownlinks == worker->MaxDownlinks )
+  {
+    worker->MaxDownlinks = ( worker->MaxDownlinks != 0 ) ? 2 * worker->MaxDownlinks : 64;
+    worker->Downlinks = realloc( worker->Downlinks, worker->MaxDownlinks * sizeof( SimFleetDownlink_t ) );
+    if( worker->Downlinks == NULL )
+    {
+      printf( "fleet: out of memory for %u downlinks\n", worker->MaxDownlinks );
+      exit( 1 );
+    }
+  }
+  worker->Downlinks[worker->NbDownlinks].Device = device;
+  worker->Downlinks[worker->NbDownlinks].IsAck = isAck;
+  worker->Downlinks[worker->NbDownlinks].Frame = *frame;
+  worker->NbDownlinks++;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t SimFleet_Hash( uint32_t device, uint32_t salt )
+{
+  uint32_t hash = SimConfig.Seed ^ ( device * 0x9E3779B9 ) ^ ( salt * 0x85EBCA6B );
+
+  hash ^= hash >> 16;
+  hash *= 0x7FEB352D;
+  hash ^= hash >> 15;
+  hash *= 0x846CA68B;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+static SimTime_t SimFleet_PowerOn( uint32_t device )
+{
+  /* spread over one application period */
+  return ( SimTime_t )( SimFleet_Hash( device, 1 ) % SimAppTxDutyCycle ) * 1000;
+}
+
+static bool SimFleet_IsConfirmed( uint32_t device )
+{
+  return ( SimFleet_Hash( device, 2 ) % 100 ) < SimConfig.Confirmed;
+}
+
+static void SimFleet_Write( int fd, const void *buffer, size_t size )
+{
+  const uint8_t *data = buffer;
+  ssize_t done;
+
+  while( size != 0 )
+  {
+    done = write( fd, data, size );
+    if( done <= 0 )
+    {
+      perror( "fleet: write" );
+      _exit( 1 );
+    }
+    data += done;
+    size -= done;
+  }
+}
+
+static void SimFleet_Read( int fd, void *buffer, size_t size )
+{
+  uint8_t *data = buffer;
+  ssize_t done;
+
+  while( size != 0 )
+  {
+    done = read( fd, data, size );
+    if( done <= 0 )
+    {
+      printf( "fleet: a worker stopped\n" );
+      _exit( 1 );
+    }
+    data += done;
+    size -= done;
+  }
+}
+
+static void SimFleet_Worker( int command, int reply )
+{
+  size_t dataSize = __stop_sim_device_data - __start_sim_device_data;
+  size_t bssSize = __stop_sim_device_bss - __start_sim_device_bss;
+  SimFleetCommand_t order;
+  SimFleetDownlink_t downlink;
+  SimFleetReply_t answer;
+  SimFleetResult_t result;
+
+  IsWorker = true;
+  NbHosted = ( SimConfig.Devices - WorkerIndex + NbWorkers - 1 ) / NbWorkers;
+  Devices = calloc( NbHosted, sizeof( SimFleetDevice_t ) );
+  if( Devices == NULL )
+  {
+    _exit( 1 );
+  }
+  /* all the devices start from the variables as the options left them */
+  for( uint32_t local = 0; local < NbHosted; local++ )
+  {
+    Devices[local].Image = malloc( dataSize + bssSize );
+    if( Devices[local].Image == NULL )
+    {
+      printf( "fleet: out of memory for %u devices\n", NbHosted );
+      _exit( 1 );
+    }
+    memcpy( Devices[local].Image, __start_sim_device_data, dataSize );
+    memcpy( Devices[local].Image + dataSize, __start_sim_device_bss, bssSize );
+    Devices[local].Next = SimFleet_PowerOn( WorkerIndex + local * NbWorkers );
+    Devices[local].AckCheck = SIM_TIME_NEVER;
+  }
+  Loaded = NbHosted;
+
+  while( true )
+  {
+    SimFleet_Read( command, &order, sizeof( order ) );
+
+    if( order.Type == SIM_FLEET_FINISH )
+    {
+      for( uint32_t local = 0; local < NbHosted; local++ )
+      {
+        SimFleet_Load( local );
+        SimFleet_CheckAck( local, true );
+        result.Device = WorkerIndex + local * NbWorkers;
+        result.AcksReceived = Devices[local].AcksReceived;
+        result.Stats = SimStats;
+        SimFleet_Write( reply, &result, sizeof( result ) );
+      }
+      _exit( 0 );
+    }
+
+    /* the answers of the gateway are on the air before the devices run */
+    for( uint32_t i = 0; i < order.NbDownlinks; i++ )
+    {
+      uint32_t local;
+
+      SimFleet_Read( command, &downlink, sizeof( downlink ) );
+      local = downlink.Device / NbWorkers;
+      SimFleet_Load( local );
+      if( downlink.IsAck != 0 )
+      {
+        SimFleet_CheckAck( local, true );
+        Devices[local].AckCheck = downlink.Frame.End;
+        Devices[local].AckRxFrames = SimStats.RxFrames;
+      }
+      SimRadio_Transmit( &downlink.Frame );
+      Devices[local].Next = Sim_NextEventTime( );
+    }
+
+    Horizon = order.Horizon;
+    NbUplinks = 0;
+    answer.Next = SIM_TIME_NEVER;
+    for( uint32_t local = 0; local < NbHosted; local++ )
+    {
+      if( Devices[local].Next <= Horizon )
+      {
+        SimFleet_Resume( local );
+      }
+      if( Devices[local].Next < answer.Next )
+      {
+        answer.Next = Devices[local].Next;
+      }
+    }
+    answer.NbUplinks = NbUplinks;
+    SimFleet_Write( reply, &answer, sizeof( answer ) );
+    SimFleet_Write( reply, Uplinks, NbUplinks * sizeof( SimFleetUplink_t ) );
+  }
+}
+
+static void SimFleet_Load( uint32_t local )
+{
+  size_t dataSize = __stop_sim_device_data - __start_sim_device_data;
+  size_t bssSize = __stop_sim_device_bss - __start_sim_device_bss;
+
+  if( Loaded == local )
+  {
+    return;
+  }
+  if( Loaded < NbHosted )
+  {
+    memcpy( Devices[Loaded].Image, __start_sim_device_data, dataSize );
+    memcpy( Devices[Loaded].Image + dataSize, __start_sim_device_bss, bssSize );
+  }
+  memcpy( __start_sim_device_data, Devices[local].Image, dataSize );
+  memcpy( __start_sim_device_bss, Devices[local].Image + dataSize, bssSize );
+  Loaded = local;
+}
+
+static void SimFleet_Resume( uint32_t local )
+{
+  SimFleetDevice_t *device = &Devices[local];
+
+  SimFleet_Load( local );
+  if( device->Started == false )
+  {
+    SimConfig.Device = WorkerIndex + local * NbWorkers;
+    SimConfig.PowerOn = device->Next;
+    SimConfig.ConfirmedUplinks = SimFleet_IsConfirmed( SimConfig.Device );
+
+    device->Stack = mmap( NULL, SIM_FLEET_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    if( device->Stack == MAP_FAILED )
+    {
+      perror( "fleet: mmap" );
+      _exit( 1 );
+    }
+    getcontext( &device->Context );
+    device->Context.uc_stack.ss_sp = device->Stack;
+    device->Context.uc_stack.ss_size = SIM_FLEET_STACK_SIZE;
+    device->Context.uc_link = NULL;
+    makecontext( &device->Context, SimFleet_DeviceMain, 0 );
+    device->Started = true;
+  }
+  else
+  {
+    Sim_SetHorizon( Horizon );
+  }
+  swapcontext( &WorkerContext, &device->Context );
+
+  SimFleet_CheckAck( local, false );
+  device->Next = Sim_NextEventTime( );
+}
+
+static void SimFleet_DeviceMain( void )
+{
+  Sim_Init( );
+  Sim_SetHorizon( Horizon );
+
+  EndNode_main( );
+}
+
+static void SimFleet_CheckAck( uint32_t local, bool finish )
+{
+  SimFleetDevice_t *device = &Devices[local];
+
+  if( ( device->AckCheck == SIM_TIME_NEVER ) || ( ( finish == false ) && ( Sim_Now( ) < device->AckCheck ) ) )
+  {
+    return;
+  }
+  /* only its own downlinks are on the air of a device */
+  if( SimStats.RxFrames > device->AckRxFrames )
+  {
+    device->AcksReceived++;
+  }
+  device->AckCheck = SIM_TIME_NEVER;
+}
+
+static void SimFleet_Report( const SimFleetResult_t *results, double wall )
+{
+  uint32_t nbDevices = SimConfig.Devices;
+  uint32_t pdrHistogram[SIM_FLEET_PDR_BUCKETS] = { 0 };
+  uint32_t airtimeHistogram[SIM_FLEET_AIRTIME_BUCKETS] = { 0 };
+  uint32_t joined = 0;
+  uint32_t requests = 0;
+  uint32_t refused = 0;
+  uint32_t delivered = 0;
+  uint32_t silent = 0;
+  uint32_t confirmedRequests = 0;
+  uint32_t acks = 0;
+  uint32_t txFrames = 0;
+  uint32_t rxFrames = 0;
+  double simulated = ( double )SimConfig.Duration / 1e6;
+  FILE *csv = NULL;
+
+  if( SimConfig.Report != NULL )
+  {
+    csv = fopen( SimConfig.Report, "w" );
+    if( csv == NULL )
+    {
+      perror( SimConfig.Report );
+    }
+    else
+    {
+      fprintf( csv, "device,distance_m,confirmed,requests,refused,delivered,pdr,tx_frames,airtime_s,rx_frames,acks\n" );
+    }
+  }
+
+  for( uint32_t d = 0; d < nbDevices; d++ )
+  {
+    const SimStats_t *stats = &results[d].Stats;
+    uint32_t accepted = stats->AppRequests - stats->AppRejected;
+    uint32_t airtime = ( uint32_t )( ( double )stats->TxAirTime / 1e3 / simulated );
+    uint32_t bucket = 0;
+    double pdr = ( accepted != 0 ) ? ( double )Delivered[d] / accepted : 0;
+
+    joined += ( Joined[d] == true ) ? 1 : 0;
+    requests += stats->AppRequests;
+    refused += stats->AppRejected;
+    delivered += Delivered[d];
+    txFrames += stats->TxFrames;
+    rxFrames += stats->RxFrames;
+    if( SimFleet_IsConfirmed( d ) == true )
+    {
+      confirmedRequests += accepted;
+      acks += results[d].AcksReceived;
+    }
+    if( accepted == 0 )
+    {
+      silent++;
+    }
+    else
+    {
+      /* a retransmission delivered late may count for a request refused */
+      bucket = ( pdr >= 1.0 ) ? ( SIM_FLEET_PDR_BUCKETS - 1 ) : ( uint32_t )( pdr * SIM_FLEET_PDR_BUCKETS );
+      pdrHistogram[bucket]++;
+    }
+    bucket = 0;
+    while( ( bucket < ( SIM_FLEET_AIRTIME_BUCKETS - 1 ) ) && ( airtime >= AirtimeBounds[bucket] ) )
+    {
+      bucket++;
+    }
+    airtimeHistogram[bucket]++;
+
+    if( csv != NULL )
+    {
+      fprintf( csv, "%u,%u,%u,%u,%u,%u,%.3f,%u,%.3f,%u,%u\n", d, SimChannel_Distance( d ), SimFleet_IsConfirmed( d ) ? 1 : 0,
+               stats->AppRequests, stats->AppRejected, Delivered[d], pdr, stats->TxFrames,
+               ( double )stats->TxAirTime / 1e6, stats->RxFrames, results[d].AcksReceived );
+    }
+  }
+  if( csv != NULL )
+  {
+    fclose( csv );
+  }
+
+  printf( "\n--- end of simulation at %.3f s (%.3f s of host time, x%.0f) ---\n", simulated, wall, ( wall > 0 ) ? simulated / wall : 0 );
+  printf( "devices:     %u joined of %u, %u frames sent, %u frames received\n", joined, nbDevices, txFrames, rxFrames );
+  printf( "gateway:     %u uplink frames, %u received; lost: %u below sensitivity, %u no demodulator, %u collisions, %u transmitting\n",
+          SimGatewayStats.Frames, SimGatewayStats.Received, SimGatewayStats.BelowSensitivity, SimGatewayStats.NoDemodulator,
+          SimGatewayStats.Collisions, SimGatewayStats.Transmitting );
+  printf( "downlinks:   %u sent (%u in RX2), %u dropped with the gateway busy, %u too weak at the device\n",
+          SimGatewayStats.Downlinks, SimGatewayStats.DownlinksRx2, SimGatewayStats.DownlinksBusy, SimGatewayStats.DownlinksLost );
+  printf( "network:     %u join requests, %u join accepts, %u uplinks (%u confirmed), %u repeated, %u mic errors\n",
+          SimStats.JoinRequests, SimStats.JoinAccepts, SimStats.Uplinks, SimStats.ConfirmedUplinks, Repeated, SimStats.MicErrors );
+  printf( "application: %u requests, %u refused by the MAC, %u delivered, PDR %.1f %%\n", requests, refused, delivered,
+          ( requests > refused ) ? 100.0 * delivered / ( requests - refused ) : 0.0 );
+  if( confirmedRequests != 0 )
+  {
+    printf( "acks:        %u received for %u confirmed requests, %.1f %%\n", acks, confirmedRequests, 100.0 * acks / confirmedRequests );
+  }
+
+  printf( "\nspreading factors of the uplink frames:\n" );
+  for( uint32_t sf = 0; sf < 6; sf++ )
+  {
+    printf( "  SF%-2u %8u  %5.1f %%\n", sf + 7, SimGatewayStats.FramesPerSf[sf],
+            ( SimGatewayStats.Frames != 0 ) ? 100.0 * SimGatewayStats.FramesPerSf[sf] / SimGatewayStats.Frames : 0.0 );
+  }
+  SimFleet_PrintHistogram( "PDR of the devices", PdrLabels, pdrHistogram, SIM_FLEET_PDR_BUCKETS );
+  if( silent != 0 )
+  {
+    printf( "  (%u devices without any request)\n", silent );
+  }
+  SimFleet_PrintHistogram( "latency of the uplinks delivered, from the request", LatencyLabels, LatencyHistogram, SIM_FLEET_LATENCY_BUCKETS );
+  SimFleet_PrintHistogram( "airtime of the devices", AirtimeLabels, airtimeHistogram, SIM_FLEET_AIRTIME_BUCKETS );
+  fflush( stdout );
+}
+
+static void SimFleet_PrintHistogram( const char *title, const char *const *labels, const uint32_t *counts, uint32_t nb )
+{
+  uint32_t total = 0;
+  uint32_t max = 0;
+
+  for( uint32_t i = 0; i < nb; i++ )
+  {
+    total += counts[i];
+    max = ( counts[i] > max ) ? counts[i] : max;
+  }
+  printf( "\n%s:\n", title );
+  for( uint32_t i = 0; i < nb; i++ )
+  {
+    printf( "  %-10s %8u  %5.1f %%  ", labels[i], counts[i], ( total != 0 ) ? 100.0 * counts[i] / total : 0.0 );
+    for( uint32_t j = 0; ( max != 0 ) && ( j < ( counts[i] * 40 + max - 1 ) / max ); j++ )
+    {
+      putchar( '#' );
+    }
+    putchar( '\n' );
+  }
+}
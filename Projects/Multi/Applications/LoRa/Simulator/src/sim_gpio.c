@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * @file    sim_gpio.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   GPIO and EXTI lines of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+GPIO_TypeDef SimGpioPorts[SIM_GPIO_NB_PORTS];
+
+static GpioIrqHandler *GpioIrq[16] = { NULL };
+
+/*!
+ * Port selected as source of each EXTI line (SYSCFG_EXTICR)
+ */
+static GPIO_TypeDef *GpioExtiPort[16] = { NULL };
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t HW_GPIO_GetBitPos(uint16_t GPIO_Pin);
+
+/* Exported functions ---------------------------------------------------------*/
+
+void HW_GPIO_Init( GPIO_TypeDef* port, uint16_t GPIO_Pin, GPIO_InitTypeDef* initStruct)
+{
+  uint32_t BitPos = HW_GPIO_GetBitPos( GPIO_Pin );
+
+  initStruct->Pin = GPIO_Pin ;
+
+  port->MODE[BitPos] = initStruct->Mode;
+  if ( ( initStruct->Mode & GPIO_MODE_IT_RISING_FALLING ) != 0 )
+  {
+    GpioExtiPort[BitPos] = port;
+  }
+  else if ( GpioExtiPort[BitPos] == port )
+  {
+    GpioExtiPort[BitPos] = NULL;
+  }
+}
+
+void HW_GPIO_SetIrq( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint32_t prio,  GpioIrqHandler *irqHandler )
+{
+  uint32_t BitPos = HW_GPIO_GetBitPos( GPIO_Pin ) ;
+
+  /* all the lines share one priority in the simulator */
+  GpioIrq[ BitPos ] = irqHandler;
+}
+
+void HW_GPIO_IrqHandler( uint16_t GPIO_Pin )
+{
+  uint32_t BitPos = HW_GPIO_GetBitPos( GPIO_Pin );
+  CSP_ISR_ENTER( );
+
+  if ( GpioIrq[ BitPos ]  != NULL)
+  {
+    GpioIrq[ BitPos ] ( );
+  }
+
+  CSP_ISR_EXIT( );
+}
+
+void HW_GPIO_Write( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin,  uint32_t value )
+{
+  if ( value != 0 )
+  {
+    GPIOx->ODR |= GPIO_Pin;
+  }
+  else
+  {
+    GPIOx->ODR &= ~( uint32_t )GPIO_Pin;
+  }
+
+  /* the radio sees its chip select and reset pins */
+  if ( ( GPIOx == RADIO_NSS_PORT ) && ( GPIO_Pin == RADIO_NSS_PIN ) )
+  {
+    SimRadio_Select( value );
+  }
+  else if ( ( GPIOx == RADIO_RESET_PORT ) && ( GPIO_Pin == RADIO_RESET_PIN ) && ( value == 0 ) )
+  {
+    SimRadio_Reset( );
+  }
+}
+
+uint32_t HW_GPIO_Read( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin )
+{
+  uint32_t BitPos = HW_GPIO_GetBitPos( GPIO_Pin );
+
+  if ( ( GPIOx->MODE[BitPos] == GPIO_MODE_OUTPUT_PP ) || ( GPIOx->MODE[BitPos] == GPIO_MODE_OUTPUT_OD ) )
+  {
+    return ( ( GPIOx->ODR & GPIO_Pin ) != 0 ) ? 1 : 0;
+  }
+  return ( ( GPIOx->IDR & GPIO_Pin ) != 0 ) ? 1 : 0;
+}
+
+void SimGpio_IrqHandler( uint32_t line )
+{
+  HW_GPIO_IrqHandler( ( uint16_t )( 1 << line ) );
+}
+
+void SimGpio_SetInput( GPIO_TypeDef *port, uint16_t pin, uint32_t value )
+{
+  uint32_t BitPos = HW_GPIO_GetBitPos( pin );
+  bool rising = ( value != 0 ) && ( ( port->IDR & pin ) == 0 );
+  bool falling = ( value == 0 ) && ( ( port->IDR & pin ) != 0 );
+  uint32_t mode = port->MODE[BitPos];
+
+  if ( value != 0 )
+  {
+    port->IDR |= pin;
+  }
+  else
+  {
+    port->IDR &= ~( uint32_t )pin;
+  }
+
+  if ( GpioExtiPort[BitPos] != port )
+  {
+    return;
+  }
+  if ( ( rising && ( mode == GPIO_MODE_IT_RISING || mode == GPIO_MODE_IT_RISING_FALLING ) ) ||
+       ( falling && ( mode == GPIO_MODE_IT_FALLING || mode == GPIO_MODE_IT_RISING_FALLING ) ) )
+  {
+    Sim_IrqSetPending( BitPos );
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint8_t HW_GPIO_GetBitPos(uint16_t GPIO_Pin)
+{
+  uint8_t PinPos=0;
+
+  if ( ( GPIO_Pin & 0xFF00 ) != 0) { PinPos |= 0x8; }
+  if ( ( GPIO_Pin & 0xF0F0 ) != 0) { PinPos |= 0x4; }
+  if ( ( GPIO_Pin & 0xCCCC ) != 0) { PinPos |= 0x2; }
+  if ( ( GPIO_Pin & 0xAAAA ) != 0) { PinPos |= 0x1; }
+
+  return PinPos;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
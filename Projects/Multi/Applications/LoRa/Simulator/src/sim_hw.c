@@ -0,0 +1,318 @@
+/**
+ ******************************************************************************
+ * @file    sim_hw.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   MCU services of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdarg.h>
+#include "hw.h"
+#include "radio.h"
+#include "bsp.h"
+#include "vcom.h"
+#include "lora.h"
+#include "low_power_manager.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+
+#define VCOM_BUFSIZE 256
+
+/* battery level reported to the network, fully charged */
+#define LORAWAN_MAX_BAT   254
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+uint32_t SimAppTxDutyCycle = 10000;
+
+SimTime_t SimAppRequestTime = 0;
+
+static bool McuInitialized = false;
+
+static const char *LedNames[4] = { "GREEN", "RED1", "BLUE", "RED2" };
+
+static uint8_t LedStates = 0;
+
+/*!
+ * Line being printed on the virtual COM port
+ */
+static char VcomLine[VCOM_BUFSIZE];
+
+static uint16_t VcomLineLen = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+/* Exported functions ---------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_Init( void )
+{
+  return HAL_OK;
+}
+
+void SystemClock_Config( void )
+{
+}
+
+void DBG_Init( void )
+{
+}
+
+void Error_Handler( void )
+{
+  Sim_Log( "Error_Handler" );
+  Sim_Stop( );
+}
+
+void HW_Init( void )
+{
+  if( McuInitialized == false )
+  {
+    Radio.IoInit( );
+
+    HW_SPI_Init( );
+
+    HW_RTC_Init( );
+
+    vcom_Init( );
+
+    BSP_sensor_Init( );
+
+    McuInitialized = true;
+  }
+}
+
+void HW_DeInit( void )
+{
+  HW_SPI_DeInit( );
+
+  Radio.IoDeInit( );
+
+  vcom_DeInit( );
+
+  McuInitialized = false;
+}
+
+uint32_t HW_GetRandomSeed( void )
+{
+  return ( SimConfig.Seed + SimConfig.Device ) * 0x9E3779B9;
+}
+
+void HW_GetUniqueId( uint8_t *id )
+{
+  /* one device Id per seed, the devices of a fleet follow each other */
+  uint32_t seed = SimConfig.Seed + SimConfig.Device;
+
+  id[7] = 0x00;
+  id[6] = 0x80;
+  id[5] = 0xE1;
+  id[4] = 0x01;
+  id[3] = seed >> 24;
+  id[2] = seed >> 16;
+  id[1] = seed >> 8;
+  id[0] = seed;
+}
+
+uint16_t HW_GetTemperatureLevel( void )
+{
+  /* 25 degrees C, in q8 */
+  return 25 << 8;
+}
+
+uint8_t HW_GetBatteryLevel( void )
+{
+  return LORAWAN_MAX_BAT;
+}
+
+void HW_EnterStopMode( void )
+{
+}
+
+void HW_ExitStopMode( void )
+{
+}
+
+void HW_EnterSleepMode( void )
+{
+}
+
+/* The simulated time only moves while the MCU waits for an interrupt */
+void LPM_EnterStopMode( void )
+{
+  Sim_WaitForInterrupt( );
+}
+
+void LPM_EnterSleepMode( void )
+{
+  Sim_WaitForInterrupt( );
+}
+
+void LPM_EnterOffMode( void )
+{
+  Sim_WaitForInterrupt( );
+}
+
+void vcom_Init( void )
+{
+}
+
+void vcom_DeInit( void )
+{
+}
+
+void vcom_IoInit( void )
+{
+}
+
+void vcom_IoDeInit( void )
+{
+}
+
+void vcom_Print( void )
+{
+}
+
+void vcom_Send( char *format, ... )
+{
+  va_list args;
+  char buffer[VCOM_BUFSIZE];
+  char *c;
+
+  if( SimConfig.Quiet == true )
+  {
+    return;
+  }
+  va_start( args, format );
+  vsnprintf( buffer, sizeof( buffer ), format, args );
+  va_end( args );
+
+  /* the traces are printed by lines, timestamped, without the \r of the terminal */
+  for( c = buffer; *c != '\0'; c++ )
+  {
+    if( ( *c == '\n' ) || ( VcomLineLen == ( VCOM_BUFSIZE - 1 ) ) )
+    {
+      VcomLine[VcomLineLen] = '\0';
+      Sim_Log( "vcom: %s", VcomLine );
+      VcomLineLen = 0;
+    }
+    if( ( *c != '\r' ) && ( *c != '\n' ) )
+    {
+      VcomLine[VcomLineLen++] = *c;
+    }
+  }
+}
+
+void vcom_Send_Lp( char *format, ... )
+{
+  va_list args;
+  char buffer[VCOM_BUFSIZE];
+
+  va_start( args, format );
+  vsnprintf( buffer, sizeof( buffer ), format, args );
+  va_end( args );
+  vcom_Send( "%s", buffer );
+}
+
+void SimLedWrite( Led_TypeDef led, uint32_t value )
+{
+  uint8_t previous = LedStates;
+
+  if( value == 2 )
+  {
+    LedStates ^= 1 << led;
+  }
+  else if( value != 0 )
+  {
+    LedStates |= 1 << led;
+  }
+  else
+  {
+    LedStates &= ~( 1 << led );
+  }
+  if( ( SimConfig.Verbose == true ) && ( previous != LedStates ) )
+  {
+    Sim_Log( "led: %s %s", LedNames[led], ( ( LedStates >> led ) & 1 ) ? "on" : "off" );
+  }
+}
+
+/* LORA_send( ) of the application, renamed by the Makefile */
+bool SimApp_Send( lora_AppData_t *AppData, LoraConfirm_t IsTxConfirmed )
+{
+  bool refused;
+
+  SimStats.AppRequests++;
+  SimAppRequestTime = Sim_Now( );
+  if( SimConfig.ConfirmedUplinks == true )
+  {
+    IsTxConfirmed = LORAWAN_CONFIRMED_MSG;
+  }
+  refused = LORA_send( AppData, IsTxConfirmed );
+  if( refused == true )
+  {
+    SimStats.AppRejected++;
+  }
+  return refused;
+}
+
+#if defined( CS_PROFILER )
+/* LoRaMacProcess( ) of the application, renamed by the Makefile: the deferred */
+/* radio and timer events are timed as the interrupt handlers that ran them */
+void SimMac_Process( void )
+{
+  if( LoRaMacIsProcessPending( ) == true )
+  {
+    CSP_ISR_ENTER( );
+
+    LoRaMacProcess( );
+
+    CSP_ISR_EXIT( );
+  }
+  else
+  {
+    LoRaMacProcess( );
+  }
+}
+#endif
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
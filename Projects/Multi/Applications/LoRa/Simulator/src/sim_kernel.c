@@ -0,0 +1,451 @@
+/**
+ ******************************************************************************
+ * @file    sim_kernel.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Discrete event clock and interrupt controller of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include "hw.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+SimConfig_t SimConfig =
+{
+  .Duration = 3600ULL * 1000000ULL,
+  .Seed = 1,
+  .DownlinkPeriod = 0,
+  .Rssi = -60,
+  .Snr = 8,
+  .Verbose = false,
+  .Quiet = false,
+  .Devices = 0,
+  .Jobs = 0,
+  .Radius = 2000,
+  .Confirmed = 0,
+  .Report = NULL,
+  .Device = 0,
+  .PowerOn = 0,
+  .ConfirmedUplinks = false,
+};
+
+SimStats_t SimStats;
+
+/*!
+ * Simulated time
+ */
+static SimTime_t SimNowTime = 0;
+
+/*!
+ * Time up to which the device may run
+ */
+static SimTime_t SimHorizon = 0;
+
+/*!
+ * Time a busy wait (Sim_Advance) stopped at the horizon wants to reach
+ */
+static SimTime_t SimAdvanceTime = SIM_TIME_NEVER;
+
+/*!
+ * Armed events, sorted by expiry time (FIFO for the same time)
+ */
+static SimEvent_t *SimEventList = NULL;
+
+/*!
+ * Pending interrupt lines, bit n for line n
+ */
+static uint32_t SimIrqPending = 0;
+
+/*!
+ * Simulated PRIMASK, 1 when the interrupts are masked
+ */
+static uint32_t SimPrimask = 0;
+
+/*!
+ * Set while an interrupt handler runs: all the lines share the same
+ * priority, as the radio DIOs and the RTC alarm do on the boards
+ */
+static bool SimInIsr = false;
+
+static uint32_t SimRandomState = 1;
+
+static struct timespec SimWallStart;
+
+#if defined( CS_PROFILER )
+CoreDebug_Type SimCoreDebug;
+
+static DWT_Type SimDwtRegs;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief Delivers the pending interrupts, if they are not masked
+ */
+static void Sim_IrqDeliver( void );
+
+/*!
+ * @brief Runs the first armed event
+ */
+static void Sim_EventRunFirst( void );
+
+/*!
+ * @brief The device has reached its horizon: the run ends, or a fleet
+ *        device waits for its worker to move the horizon
+ */
+static void Sim_ReachHorizon( void );
+
+#if defined( CS_PROFILER )
+/*!
+ * @brief Prints the critical sections and interrupt handlers of the profiler
+ */
+static void Sim_PrintProfile( void );
+#endif
+
+/* Exported functions ---------------------------------------------------------*/
+
+void Sim_Init( void )
+{
+  /* one random sequence per device of the fleet */
+  SimRandomState = SimConfig.Seed ^ ( SimConfig.Device * 0x9E3779B9 );
+  if( SimRandomState == 0 )
+  {
+    SimRandomState = 1;
+  }
+  clock_gettime( CLOCK_MONOTONIC, &SimWallStart );
+
+  SimNowTime = SimConfig.PowerOn;
+  SimHorizon = SimConfig.Duration;
+
+  SimRadio_Init( );
+}
+
+SimTime_t Sim_Now( void )
+{
+  return SimNowTime;
+}
+
+void Sim_EventInit( SimEvent_t *event, void ( *callback )( void *context ), void *context )
+{
+  event->Time = 0;
+  event->Callback = callback;
+  event->Context = context;
+  event->IsArmed = false;
+  event->Next = NULL;
+}
+
+void Sim_EventArm( SimEvent_t *event, SimTime_t time )
+{
+  SimEvent_t **cur = &SimEventList;
+
+  Sim_EventDisarm( event );
+
+  if( time < SimNowTime )
+  {
+    time = SimNowTime;
+  }
+  event->Time = time;
+  event->IsArmed = true;
+
+  while( ( *cur != NULL ) && ( ( *cur )->Time <= time ) )
+  {
+    cur = &( *cur )->Next;
+  }
+  event->Next = *cur;
+  *cur = event;
+}
+
+void Sim_EventDisarm( SimEvent_t *event )
+{
+  SimEvent_t **cur = &SimEventList;
+
+  if( event->IsArmed == false )
+  {
+    return;
+  }
+  while( *cur != event )
+  {
+    cur = &( *cur )->Next;
+  }
+  *cur = event->Next;
+  event->Next = NULL;
+  event->IsArmed = false;
+}
+
+void Sim_Advance( SimTime_t time )
+{
+  while( true )
+  {
+    while( ( SimEventList != NULL ) && ( SimEventList->Time <= time ) && ( SimEventList->Time <= SimHorizon ) )
+    {
+      Sim_EventRunFirst( );
+      Sim_IrqDeliver( );
+    }
+    if( time <= SimHorizon )
+    {
+      break;
+    }
+    SimAdvanceTime = time;
+    Sim_ReachHorizon( );
+  }
+  SimAdvanceTime = SIM_TIME_NEVER;
+  SimNowTime = time;
+  Sim_IrqDeliver( );
+}
+
+void Sim_WaitForInterrupt( void )
+{
+  SimStats.Sleeps++;
+
+  while( SimIrqPending == 0 )
+  {
+    if( ( SimEventList == NULL ) || ( SimEventList->Time > SimHorizon ) )
+    {
+      /* nothing wakes the MCU up before the horizon */
+      Sim_ReachHorizon( );
+      continue;
+    }
+    Sim_EventRunFirst( );
+  }
+  /* the handlers run on wake up if the sleep was entered unmasked */
+  Sim_IrqDeliver( );
+}
+
+void Sim_SetHorizon( SimTime_t horizon )
+{
+  SimHorizon = horizon;
+}
+
+SimTime_t Sim_NextEventTime( void )
+{
+  if( ( SimEventList != NULL ) && ( SimEventList->Time < SimAdvanceTime ) )
+  {
+    return SimEventList->Time;
+  }
+  return SimAdvanceTime;
+}
+
+void Sim_IrqSetPending( uint32_t line )
+{
+  SimIrqPending |= 1UL << line;
+}
+
+void Sim_IrqClearPending( uint32_t line )
+{
+  SimIrqPending &= ~( 1UL << line );
+}
+
+void Sim_Stop( void )
+{
+  struct timespec wallEnd;
+  double wall;
+  double simulated = ( double )SimNowTime / 1e6;
+
+  clock_gettime( CLOCK_MONOTONIC, &wallEnd );
+  wall = ( double )( wallEnd.tv_sec - SimWallStart.tv_sec ) + ( double )( wallEnd.tv_nsec - SimWallStart.tv_nsec ) / 1e9;
+
+  printf( "\n--- end of simulation at %.3f s (%.3f s of host time, x%.0f) ---\n", simulated, wall, ( wall > 0 ) ? simulated / wall : 0 );
+  printf( "mcu:     %u interrupts, %u sleeps, %u spi transactions (%u bytes)\n",
+          SimStats.Interrupts, SimStats.Sleeps, SimStats.SpiTransactions, SimStats.SpiBytes );
+  printf( "radio:   %u frames sent (%.3f s on air, %.3f %%), %u rx windows, %u rx timeouts, %u frames received\n",
+          SimStats.TxFrames, ( double )SimStats.TxAirTime / 1e6, ( simulated > 0 ) ? ( double )SimStats.TxAirTime / 1e4 / simulated : 0,
+          SimStats.RxWindows, SimStats.RxTimeouts, SimStats.RxFrames );
+  printf( "network: %u join requests, %u join accepts, %u uplinks (%u confirmed), %u mic errors, %u downlinks\n",
+          SimStats.JoinRequests, SimStats.JoinAccepts, SimStats.Uplinks, SimStats.ConfirmedUplinks,
+          SimStats.MicErrors, SimStats.Downlinks );
+#if defined( CS_PROFILER )
+  Sim_PrintProfile( );
+#endif
+  fflush( stdout );
+  exit( 0 );
+}
+
+void Sim_Log( const char *format, ... )
+{
+  va_list args;
+
+  printf( "[%11.6f] ", ( double )SimNowTime / 1e6 );
+  va_start( args, format );
+  vprintf( format, args );
+  va_end( args );
+  printf( "\n" );
+}
+
+uint32_t Sim_Random( void )
+{
+  /* xorshift32 */
+  SimRandomState ^= SimRandomState << 13;
+  SimRandomState ^= SimRandomState >> 17;
+  SimRandomState ^= SimRandomState << 5;
+  return SimRandomState;
+}
+
+#if defined( CS_PROFILER )
+DWT_Type *SimDwt( void )
+{
+  struct timespec now;
+
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  SimDwtRegs.CYCCNT = ( uint32_t )( ( uint64_t )now.tv_sec * 1000000000ULL + ( uint64_t )now.tv_nsec );
+  return &SimDwtRegs;
+}
+#endif
+
+uint32_t __get_PRIMASK( void )
+{
+  return SimPrimask;
+}
+
+void __set_PRIMASK( uint32_t priMask )
+{
+  SimPrimask = priMask & 1;
+  Sim_IrqDeliver( );
+}
+
+void __disable_irq( void )
+{
+  SimPrimask = 1;
+}
+
+void __enable_irq( void )
+{
+  SimPrimask = 0;
+  Sim_IrqDeliver( );
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void Sim_IrqDeliver( void )
+{
+  uint32_t line;
+
+  if( ( SimPrimask != 0 ) || ( SimInIsr == true ) )
+  {
+    return;
+  }
+
+  while( SimIrqPending != 0 )
+  {
+    /* the RTC has the lowest IRQn, it goes first as on the NVIC */
+    if( ( SimIrqPending & ( 1UL << SIM_IRQ_RTC ) ) != 0 )
+    {
+      line = SIM_IRQ_RTC;
+    }
+    else
+    {
+      line = __builtin_ctz( SimIrqPending );
+    }
+    SimIrqPending &= ~( 1UL << line );
+    SimStats.Interrupts++;
+
+    SimInIsr = true;
+    if( line == SIM_IRQ_RTC )
+    {
+      HW_RTC_IrqHandler( );
+    }
+    else
+    {
+      SimGpio_IrqHandler( line );
+    }
+    SimInIsr = false;
+  }
+}
+
+static void Sim_EventRunFirst( void )
+{
+  SimEvent_t *event = SimEventList;
+
+  SimNowTime = event->Time;
+  SimEventList = event->Next;
+  event->Next = NULL;
+  event->IsArmed = false;
+
+  event->Callback( event->Context );
+}
+
+#if defined( CS_PROFILER )
+static void Sim_PrintProfile( void )
+{
+  const CSP_Site_t *site;
+  const char *file;
+  uint8_t i;
+
+  printf( "profile: host ns per site, count, max and histogram (< 64, 256, 1k, 4k, 16k, 64k, 256k, more)\n" );
+  for( site = CSP_GetSites( ); site != NULL; site = site->Next )
+  {
+    file = strrchr( site->File, '/' );
+    printf( "  %20s:%-5u %6u %8u  ", ( file != NULL ) ? file + 1 : site->File, site->Line, site->Count, site->Max );
+    for( i = 0; i < CSP_NB_BINS; i++ )
+    {
+      printf( " %u", site->Histogram[i] );
+    }
+    printf( "\n" );
+  }
+}
+#endif
+
+static void Sim_ReachHorizon( void )
+{
+  if( SimNowTime < SimHorizon )
+  {
+    SimNowTime = SimHorizon;
+  }
+  if( SimFleet_IsWorker( ) == true )
+  {
+    SimFleet_Yield( );
+  }
+  else
+  {
+    Sim_Stop( );
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
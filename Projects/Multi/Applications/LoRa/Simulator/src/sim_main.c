@@ -0,0 +1,155 @@
+/**
+ ******************************************************************************
+ * @file    sim_main.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Entry point of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "hw.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+
+static void Sim_Usage( const char *name );
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( int argc, char **argv )
+{
+  int opt;
+
+  while( ( opt = getopt( argc, argv, "t:s:d:r:n:vqN:j:R:c:p:o:h" ) ) != -1 )
+  {
+    switch( opt )
+    {
+    case 't':
+      SimConfig.Duration = ( SimTime_t )strtoul( optarg, NULL, 0 ) * 1000000;
+      break;
+    case 's':
+      SimConfig.Seed = strtoul( optarg, NULL, 0 );
+      break;
+    case 'd':
+      SimConfig.DownlinkPeriod = strtoul( optarg, NULL, 0 );
+      break;
+    case 'r':
+      SimConfig.Rssi = ( int16_t )strtol( optarg, NULL, 0 );
+      break;
+    case 'n':
+      SimConfig.Snr = ( int8_t )strtol( optarg, NULL, 0 );
+      break;
+    case 'v':
+      SimConfig.Verbose = true;
+      break;
+    case 'q':
+      SimConfig.Quiet = true;
+      break;
+    case 'N':
+      SimConfig.Devices = strtoul( optarg, NULL, 0 );
+      break;
+    case 'j':
+      SimConfig.Jobs = strtoul( optarg, NULL, 0 );
+      break;
+    case 'R':
+      SimConfig.Radius = strtoul( optarg, NULL, 0 );
+      break;
+    case 'c':
+      SimConfig.Confirmed = strtoul( optarg, NULL, 0 );
+      break;
+    case 'p':
+      SimAppTxDutyCycle = strtoul( optarg, NULL, 0 ) * 1000;
+      break;
+    case 'o':
+      SimConfig.Report = optarg;
+      break;
+    default:
+      Sim_Usage( argv[0] );
+      return ( opt == 'h' ) ? 0 : 1;
+    }
+  }
+  if( SimAppTxDutyCycle == 0 )
+  {
+    SimAppTxDutyCycle = 1000;
+  }
+
+  if( SimConfig.Devices != 0 )
+  {
+    return SimFleet_Run( );
+  }
+
+  /* a single device, on a fixed link */
+  SimNetwork_Init( 1 );
+  Sim_Init( );
+
+  return EndNode_main( );
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void Sim_Usage( const char *name )
+{
+  printf( "usage: %s [-t seconds] [-s seed] [-d period] [-p seconds] [-r rssi] [-n snr] [-v] [-q]\n", name );
+  printf( "       %s -N devices [-j jobs] [-R radius] [-c percent] [-o file] [-t seconds] [-s seed] [-d period] [-p seconds]\n", name );
+  printf( "  -t  simulated duration in seconds (%u)\n", ( uint32_t )( SimConfig.Duration / 1000000 ) );
+  printf( "  -s  seed of the random generators and of the device Id (%u)\n", SimConfig.Seed );
+  printf( "  -d  the network sends an application downlink every period uplinks, 0 for never (%u)\n", SimConfig.DownlinkPeriod );
+  printf( "  -p  application transmission period in seconds (%u)\n", SimAppTxDutyCycle / 1000 );
+  printf( "  -r  link RSSI in dBm (%d)\n", SimConfig.Rssi );
+  printf( "  -n  link SNR in dB (%d)\n", SimConfig.Snr );
+  printf( "  -v  traces the radio, the network and the LEDs\n" );
+  printf( "  -q  drops the application traces\n" );
+  printf( "  -N  runs a fleet of devices around one gateway, prints its report\n" );
+  printf( "  -j  worker processes of the fleet, 0 for one per CPU (%u)\n", SimConfig.Jobs );
+  printf( "  -R  radius of the cell in m (%u)\n", SimConfig.Radius );
+  printf( "  -c  share of the devices sending confirmed uplinks, in %% (%u)\n", SimConfig.Confirmed );
+  printf( "  -o  writes the results of each device of the fleet to a CSV file\n" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
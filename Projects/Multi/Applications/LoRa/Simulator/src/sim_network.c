@@ -0,0 +1,531 @@
+/**
+ ******************************************************************************
+ * @file    sim_network.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Gateway and network server stand-in of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "hw.h"
+#include "aes.h"
+#include "cmac.h"
+#include "Commissioning.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * What the network server knows of a device
+ */
+typedef struct
+{
+  uint8_t DevEui[8];
+  bool Joined;
+  uint32_t DevAddr;
+  uint8_t NwkSKey[16];
+  uint8_t AppSKey[16];
+  uint32_t FCntUp;                      /* Rebuilt from its 16 lsb */
+  uint32_t FCntDown;
+  uint32_t NbUplinks;                   /* Data uplinks since the session start */
+  uint8_t LedState;                     /* State of the device LED the downlinks drive */
+  int8_t AdrMaxSnr;                     /* Best SNR of the uplinks since the last ADR decision */
+  uint8_t AdrSamples;
+  bool AdrPending;                      /* A LinkADRReq is to be sent */
+  uint8_t AdrDatarate;
+} SimSession_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/*!
+ * LoRaWAN message types (MHDR)
+ */
+#define SIM_NETWORK_JOIN_REQUEST        0x00
+#define SIM_NETWORK_JOIN_ACCEPT         0x20
+#define SIM_NETWORK_UNCONFIRMED_UP      0x40
+#define SIM_NETWORK_UNCONFIRMED_DOWN    0x60
+#define SIM_NETWORK_CONFIRMED_UP        0x80
+
+/*!
+ * FCtrl bits
+ */
+#define SIM_NETWORK_FCTRL_ADR           0x80
+#define SIM_NETWORK_FCTRL_ADRACKREQ     0x40
+#define SIM_NETWORK_FCTRL_ACK           0x20
+#define SIM_NETWORK_FCTRL_FOPTSLEN      0x0F
+
+/*!
+ * LinkADRReq command identifier
+ */
+#define SIM_NETWORK_LINK_ADR_REQ        0x03
+
+/*!
+ * RX1 delays of the LoRaWAN specification, in us
+ */
+#define SIM_NETWORK_JOIN_ACCEPT_DELAY1  5000000
+#define SIM_NETWORK_RECEIVE_DELAY1      1000000
+
+/*!
+ * Network Id of the join accepts, its 7 lsb are the DevAddr prefix
+ */
+#define SIM_NETWORK_NET_ID              0x000013
+
+/*!
+ * The DevAddr of a session is the NwkID and the session index
+ */
+#define SIM_NETWORK_NWK_ADDR_MASK       0x01FFFFFF
+
+/*!
+ * Application port of the downlinks, the End_Node drives its LED on it
+ */
+#define SIM_NETWORK_APP_PORT            2
+
+#define SIM_NETWORK_MIC_SIZE            4
+
+/*!
+ * ADR: uplinks per decision, installation margin and top data rate (EU868 DR5, SF7)
+ */
+#define SIM_NETWORK_ADR_SAMPLES         20
+#define SIM_NETWORK_ADR_MARGIN          10
+#define SIM_NETWORK_ADR_MAX_DATARATE    5
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+static const uint8_t AppKey[16] = LORAWAN_APPLICATION_KEY;
+
+/*!
+ * SNR the demodulator needs, in tenth of dB, from SF7 to SF12
+ */
+static const int16_t AdrRequiredSnr[6] = { -75, -100, -125, -150, -175, -200 };
+
+static SimSession_t *Sessions = NULL;
+
+static uint32_t NbSessions = 0;
+
+static uint32_t MaxSessions = 0;
+
+/*!
+ * Open addressing index of the sessions by DevEUI, twice as large as the
+ * number of sessions; 0 is a free slot, otherwise the session index + 1
+ */
+static uint32_t *DevEuiIndex = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief 4 bytes MIC of a message, B0 prepended when b0 is not NULL
+ */
+static uint32_t SimNetwork_Mic( const uint8_t *key, const uint8_t *b0, const uint8_t *buffer, uint16_t size );
+
+/*!
+ * @brief Builds the B0 (0x49) or A (0x01) block of a data frame
+ */
+static void SimNetwork_Block( uint8_t *block, uint8_t type, uint8_t dir, uint32_t address, uint32_t fCnt, uint8_t last );
+
+/*!
+ * @brief Session of a DevEUI, a new one is created on its first join
+ */
+static SimSession_t *SimNetwork_GetSession( const uint8_t *devEui );
+
+static SimNetworkStatus_t SimNetwork_OnJoinRequest( const SimFrame_t *frame, SimFrame_t *downlink );
+
+static SimNetworkStatus_t SimNetwork_OnUplink( const SimFrame_t *frame, SimFrame_t *downlink );
+
+/*!
+ * @brief Decides the data rate of a device from the SNR of its uplinks
+ */
+static void SimNetwork_Adr( SimSession_t *session, const SimFrame_t *frame );
+
+/*!
+ * @brief Builds the RX1 answer to an uplink frame
+ */
+static void SimNetwork_Answer( const SimFrame_t *uplink, SimTime_t delay, const uint8_t *payload, uint8_t size, SimFrame_t *downlink );
+
+/* Exported functions ---------------------------------------------------------*/
+
+void SimNetwork_Init( uint32_t nbDevices )
+{
+  MaxSessions = ( nbDevices != 0 ) ? nbDevices : 1;
+  NbSessions = 0;
+  Sessions = calloc( MaxSessions, sizeof( SimSession_t ) );
+  DevEuiIndex = calloc( 2 * MaxSessions, sizeof( uint32_t ) );
+  if( ( Sessions == NULL ) || ( DevEuiIndex == NULL ) )
+  {
+    Sim_Log( "network: out of memory for %u sessions", MaxSessions );
+    exit( 1 );
+  }
+}
+
+SimNetworkStatus_t SimNetwork_Receive( const SimFrame_t *frame, SimFrame_t *downlink )
+{
+  downlink->Size = 0;
+
+  /* the gateways only listen to the uplinks of the public network */
+  if( ( frame->IqInverted == true ) || ( frame->Size == 0 ) )
+  {
+    return SIM_NETWORK_DROPPED;
+  }
+
+  switch( frame->Payload[0] & 0xE0 )
+  {
+  case SIM_NETWORK_JOIN_REQUEST:
+    return SimNetwork_OnJoinRequest( frame, downlink );
+  case SIM_NETWORK_UNCONFIRMED_UP:
+  case SIM_NETWORK_CONFIRMED_UP:
+    return SimNetwork_OnUplink( frame, downlink );
+  default:
+    return SIM_NETWORK_DROPPED;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t SimNetwork_Mic( const uint8_t *key, const uint8_t *b0, const uint8_t *buffer, uint16_t size )
+{
+  AES_CMAC_CTX ctx;
+  uint8_t digest[AES_CMAC_DIGEST_LENGTH];
+
+  AES_CMAC_Init( &ctx );
+  AES_CMAC_SetKey( &ctx, key );
+  if( b0 != NULL )
+  {
+    AES_CMAC_Update( &ctx, b0, 16 );
+  }
+  AES_CMAC_Update( &ctx, buffer, size );
+  AES_CMAC_Final( digest, &ctx );
+
+  return ( uint32_t )digest[0] | ( ( uint32_t )digest[1] << 8 ) | ( ( uint32_t )digest[2] << 16 ) | ( ( uint32_t )digest[3] << 24 );
+}
+
+static void SimNetwork_Block( uint8_t *block, uint8_t type, uint8_t dir, uint32_t address, uint32_t fCnt, uint8_t last )
+{
+  memset( block, 0, 16 );
+  block[0] = type;
+  block[5] = dir;
+  block[6] = address & 0xFF;
+  block[7] = ( address >> 8 ) & 0xFF;
+  block[8] = ( address >> 16 ) & 0xFF;
+  block[9] = ( address >> 24 ) & 0xFF;
+  block[10] = fCnt & 0xFF;
+  block[11] = ( fCnt >> 8 ) & 0xFF;
+  block[12] = ( fCnt >> 16 ) & 0xFF;
+  block[13] = ( fCnt >> 24 ) & 0xFF;
+  block[15] = last;
+}
+
+static SimSession_t *SimNetwork_GetSession( const uint8_t *devEui )
+{
+  uint32_t hash = 2166136261u;
+  uint32_t slot;
+  SimSession_t *session;
+
+  /* FNV-1a */
+  for( int i = 0; i < 8; i++ )
+  {
+    hash = ( hash ^ devEui[i] ) * 16777619u;
+  }
+  for( slot = hash % ( 2 * MaxSessions ); DevEuiIndex[slot] != 0; slot = ( slot + 1 ) % ( 2 * MaxSessions ) )
+  {
+    session = &Sessions[DevEuiIndex[slot] - 1];
+    if( memcmp( session->DevEui, devEui, 8 ) == 0 )
+    {
+      return session;
+    }
+  }
+  if( NbSessions == MaxSessions )
+  {
+    return NULL;
+  }
+  session = &Sessions[NbSessions++];
+  memcpy( session->DevEui, devEui, 8 );
+  session->DevAddr = ( ( uint32_t )SIM_NETWORK_NET_ID << 25 ) | ( uint32_t )( session - Sessions );
+  DevEuiIndex[slot] = NbSessions;
+  return session;
+}
+
+static SimNetworkStatus_t SimNetwork_OnJoinRequest( const SimFrame_t *frame, SimFrame_t *downlink )
+{
+  SimSession_t *session;
+  uint8_t accept[1 + 16];
+  uint8_t keyBlock[16];
+  uint32_t appNonce = Sim_Random( ) & 0xFFFFFF;
+  uint32_t devAddr;
+  uint32_t mic;
+  aes_context aes;
+
+  SimStats.JoinRequests++;
+  if( frame->Size != 23 )
+  {
+    return SIM_NETWORK_DROPPED;
+  }
+  mic = SimNetwork_Mic( AppKey, NULL, frame->Payload, 19 );
+  if( memcmp( &mic, &frame->Payload[19], SIM_NETWORK_MIC_SIZE ) != 0 )
+  {
+    SimStats.MicErrors++;
+    Sim_Log( "network: join request with a bad MIC" );
+    return SIM_NETWORK_DROPPED;
+  }
+  /* MHDR | AppEUI | DevEUI | DevNonce | MIC */
+  session = SimNetwork_GetSession( &frame->Payload[9] );
+  if( session == NULL )
+  {
+    Sim_Log( "network: no session left for a join request" );
+    return SIM_NETWORK_DROPPED;
+  }
+  devAddr = session->DevAddr;
+
+  /* MHDR | AppNonce | NetID | DevAddr | DLSettings | RxDelay | MIC */
+  accept[0] = SIM_NETWORK_JOIN_ACCEPT;
+  accept[1] = appNonce & 0xFF;
+  accept[2] = ( appNonce >> 8 ) & 0xFF;
+  accept[3] = ( appNonce >> 16 ) & 0xFF;
+  accept[4] = SIM_NETWORK_NET_ID & 0xFF;
+  accept[5] = ( SIM_NETWORK_NET_ID >> 8 ) & 0xFF;
+  accept[6] = ( SIM_NETWORK_NET_ID >> 16 ) & 0xFF;
+  accept[7] = devAddr & 0xFF;
+  accept[8] = ( devAddr >> 8 ) & 0xFF;
+  accept[9] = ( devAddr >> 16 ) & 0xFF;
+  accept[10] = ( devAddr >> 24 ) & 0xFF;
+  accept[11] = 0x00;
+  accept[12] = 0x01;
+  mic = SimNetwork_Mic( AppKey, NULL, accept, 13 );
+  memcpy( &accept[13], &mic, SIM_NETWORK_MIC_SIZE );
+
+  /* session keys: AppKey( 0x01 or 0x02 | AppNonce | NetID | DevNonce | pad ) */
+  aes_set_key( AppKey, 16, &aes );
+  memset( keyBlock, 0, sizeof( keyBlock ) );
+  memcpy( &keyBlock[1], &accept[1], 6 );
+  memcpy( &keyBlock[7], &frame->Payload[17], 2 );
+  keyBlock[0] = 0x01;
+  aes_encrypt( keyBlock, session->NwkSKey, &aes );
+  keyBlock[0] = 0x02;
+  aes_encrypt( keyBlock, session->AppSKey, &aes );
+
+  /* the network decrypts the join accept so that the device only needs the encryption */
+  aes_decrypt( &accept[1], &accept[1], &aes );
+
+  session->Joined = true;
+  session->FCntUp = 0;
+  session->FCntDown = 0;
+  session->NbUplinks = 0;
+  session->AdrMaxSnr = INT8_MIN;
+  session->AdrSamples = 0;
+  session->AdrPending = false;
+  SimStats.JoinAccepts++;
+  if( SimConfig.Verbose == true )
+  {
+    Sim_Log( "network: join accept, DevAddr %08X", devAddr );
+  }
+  SimNetwork_Answer( frame, SIM_NETWORK_JOIN_ACCEPT_DELAY1, accept, sizeof( accept ), downlink );
+  return SIM_NETWORK_JOINED;
+}
+
+static SimNetworkStatus_t SimNetwork_OnUplink( const SimFrame_t *frame, SimFrame_t *downlink )
+{
+  const uint8_t *payload = frame->Payload;
+  SimSession_t *session;
+  uint8_t b0[16];
+  uint8_t block[16];
+  uint8_t answer[1 + 7 + 5 + 1 + 1 + SIM_NETWORK_MIC_SIZE];
+  uint8_t size = 0;
+  uint8_t fCtrl;
+  uint32_t address;
+  uint32_t fCnt;
+  uint32_t mic;
+  bool confirmed = ( payload[0] & 0xE0 ) == SIM_NETWORK_CONFIRMED_UP;
+  bool repeated;
+  bool appData;
+  aes_context aes;
+
+  if( frame->Size < 1 + 7 + SIM_NETWORK_MIC_SIZE )
+  {
+    return SIM_NETWORK_DROPPED;
+  }
+  address = ( uint32_t )payload[1] | ( ( uint32_t )payload[2] << 8 ) | ( ( uint32_t )payload[3] << 16 ) | ( ( uint32_t )payload[4] << 24 );
+  if( ( address & SIM_NETWORK_NWK_ADDR_MASK ) >= NbSessions )
+  {
+    return SIM_NETWORK_DROPPED;
+  }
+  session = &Sessions[address & SIM_NETWORK_NWK_ADDR_MASK];
+  if( ( session->Joined == false ) || ( address != session->DevAddr ) )
+  {
+    return SIM_NETWORK_DROPPED;
+  }
+  fCtrl = payload[5];
+
+  /* the 16 lsb of the counter are sent, a smaller value means a roll over */
+  fCnt = ( session->FCntUp & 0xFFFF0000 ) | ( ( uint32_t )payload[7] << 8 ) | payload[6];
+  if( fCnt < session->FCntUp )
+  {
+    fCnt += 0x10000;
+  }
+  SimNetwork_Block( b0, 0x49, 0, address, fCnt, frame->Size - SIM_NETWORK_MIC_SIZE );
+  mic = SimNetwork_Mic( session->NwkSKey, b0, payload, frame->Size - SIM_NETWORK_MIC_SIZE );
+  if( memcmp( &mic, &payload[frame->Size - SIM_NETWORK_MIC_SIZE], SIM_NETWORK_MIC_SIZE ) != 0 )
+  {
+    SimStats.MicErrors++;
+    Sim_Log( "network: uplink %u of %08X with a bad MIC", fCnt, address );
+    return SIM_NETWORK_DROPPED;
+  }
+  repeated = ( session->NbUplinks != 0 ) && ( fCnt == session->FCntUp );
+  session->FCntUp = fCnt;
+  if( repeated == false )
+  {
+    session->NbUplinks++;
+    SimStats.Uplinks++;
+    if( confirmed == true )
+    {
+      SimStats.ConfirmedUplinks++;
+    }
+  }
+  if( SimConfig.Verbose == true )
+  {
+    Sim_Log( "network: %s uplink %u of %08X, %u bytes%s", confirmed ? "confirmed" : "unconfirmed", fCnt, address,
+             frame->Size, repeated ? ", repeated" : "" );
+  }
+  if( ( fCtrl & SIM_NETWORK_FCTRL_ADR ) != 0 )
+  {
+    SimNetwork_Adr( session, frame );
+  }
+
+  appData = ( repeated == false ) && ( SimConfig.DownlinkPeriod != 0 ) && ( ( session->NbUplinks % SimConfig.DownlinkPeriod ) == 0 );
+  if( ( confirmed == false ) && ( appData == false ) && ( session->AdrPending == false ) &&
+      ( ( fCtrl & SIM_NETWORK_FCTRL_ADRACKREQ ) == 0 ) )
+  {
+    return repeated ? SIM_NETWORK_REPEATED : SIM_NETWORK_UPLINK;
+  }
+
+  /* MHDR | DevAddr | FCtrl | FCnt | FOpts | [ FPort | FRMPayload ] | MIC */
+  answer[size++] = SIM_NETWORK_UNCONFIRMED_DOWN;
+  memcpy( &answer[size], &payload[1], 4 );
+  size += 4;
+  answer[size++] = confirmed ? SIM_NETWORK_FCTRL_ACK : 0;
+  answer[size++] = session->FCntDown & 0xFF;
+  answer[size++] = ( session->FCntDown >> 8 ) & 0xFF;
+  if( session->AdrPending == true )
+  {
+    /* LinkADRReq: data rate and max power, the 3 default channels, 1 transmission */
+    answer[5] |= 5;
+    answer[size++] = SIM_NETWORK_LINK_ADR_REQ;
+    answer[size++] = session->AdrDatarate << 4;
+    answer[size++] = 0x07;
+    answer[size++] = 0x00;
+    answer[size++] = 0x01;
+    session->AdrPending = false;
+    if( SimConfig.Verbose == true )
+    {
+      Sim_Log( "network: %08X to DR%u", address, session->AdrDatarate );
+    }
+  }
+  if( appData == true )
+  {
+    /* toggles the device LED, encrypted with the AppSKey */
+    session->LedState ^= 1;
+    aes_set_key( session->AppSKey, 16, &aes );
+    SimNetwork_Block( block, 0x01, 1, address, session->FCntDown, 1 );
+    aes_encrypt( block, block, &aes );
+    answer[size++] = SIM_NETWORK_APP_PORT;
+    answer[size++] = session->LedState ^ block[0];
+  }
+  SimNetwork_Block( b0, 0x49, 1, address, session->FCntDown, size );
+  mic = SimNetwork_Mic( session->NwkSKey, b0, answer, size );
+  memcpy( &answer[size], &mic, SIM_NETWORK_MIC_SIZE );
+  size += SIM_NETWORK_MIC_SIZE;
+  session->FCntDown++;
+
+  SimNetwork_Answer( frame, SIM_NETWORK_RECEIVE_DELAY1, answer, size, downlink );
+  return repeated ? SIM_NETWORK_REPEATED : SIM_NETWORK_UPLINK;
+}
+
+static void SimNetwork_Adr( SimSession_t *session, const SimFrame_t *frame )
+{
+  int32_t margin;
+  uint8_t datarate;
+
+  if( ( frame->SpreadingFactor < 7 ) || ( frame->SpreadingFactor > 12 ) )
+  {
+    return;
+  }
+  if( frame->Snr > session->AdrMaxSnr )
+  {
+    session->AdrMaxSnr = frame->Snr;
+  }
+  if( ++session->AdrSamples < SIM_NETWORK_ADR_SAMPLES )
+  {
+    return;
+  }
+
+  /* one data rate step per 3 dB of margin, the transmit power is left at its maximum */
+  datarate = 12 - frame->SpreadingFactor;
+  margin = ( int32_t )session->AdrMaxSnr * 10 - AdrRequiredSnr[frame->SpreadingFactor - 7] - SIM_NETWORK_ADR_MARGIN * 10;
+  while( ( margin >= 30 ) && ( datarate < SIM_NETWORK_ADR_MAX_DATARATE ) )
+  {
+    datarate++;
+    margin -= 30;
+  }
+  if( datarate != ( 12 - frame->SpreadingFactor ) )
+  {
+    session->AdrPending = true;
+    session->AdrDatarate = datarate;
+  }
+  session->AdrMaxSnr = INT8_MIN;
+  session->AdrSamples = 0;
+}
+
+static void SimNetwork_Answer( const SimFrame_t *uplink, SimTime_t delay, const uint8_t *payload, uint8_t size, SimFrame_t *downlink )
+{
+  /* RX1: the uplink channel and data rate, inverted IQ */
+  *downlink = *uplink;
+  downlink->Start = uplink->End + delay;
+  downlink->PreambleLen = 8;
+  downlink->IqInverted = true;
+  downlink->Size = size;
+  memcpy( downlink->Payload, payload, size );
+  /* explicit header, no payload CRC on the downlinks */
+  downlink->End = downlink->Start + SimRadio_TimeOnAir( downlink, false, false,
+                                                        ( downlink->SpreadingFactor >= 11 ) && ( downlink->Bandwidth == 7 ) );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,853 @@
+/**
+ ******************************************************************************
+ * @file    sim_radio.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Register level model of the SX1276 behind the SPI of the host simulator
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include "hw.h"
+#include "sx1276Regs-Fsk.h"
+#include "sx1276Regs-LoRa.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * What the modem is busy with
+ */
+typedef enum
+{
+  SIM_RADIO_IDLE = 0,                   /* Sleep, standby or synthesizer */
+  SIM_RADIO_TX,                         /* Transmitting TxFrame */
+  SIM_RADIO_RX_SEARCHING,               /* Listening, no preamble detected */
+  SIM_RADIO_RX_RECEIVING,               /* Locked on a frame of the air */
+  SIM_RADIO_CAD,                        /* Channel activity detection */
+} SimRadioState_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/*!
+ * Crystal frequency, the synthesizer step is XTAL / 2^19
+ */
+#define SIM_RADIO_XTAL_FREQ             32000000ULL
+
+/*!
+ * The SX1276 RSSI offset above RF_MID_BAND_THRESH (sx1276.c)
+ */
+#define SIM_RADIO_RSSI_OFFSET_HF        157
+
+/*!
+ * Preamble symbols the modem needs to detect a frame
+ */
+#define SIM_RADIO_DETECT_SYMBOLS        4
+
+/*!
+ * Frames at most on the air towards the device at once
+ */
+#define SIM_RADIO_AIR_SIZE              4
+
+/*!
+ * FSK FIFO size
+ */
+#define SIM_RADIO_FSK_FIFO_SIZE         64
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/*!
+ * Registers shared by the modems, and the FSK page (0x0D to 0x3F)
+ */
+static uint8_t RegCommon[0x80];
+
+/*!
+ * LoRa page, selected by the LongRangeMode bit for the 0x0D to 0x3F range
+ */
+static uint8_t RegLoRa[0x80];
+
+/*!
+ * LoRa data buffer
+ */
+static uint8_t LoRaFifo[256];
+
+static uint8_t FskFifo[SIM_RADIO_FSK_FIFO_SIZE];
+
+static uint8_t FskFifoLen = 0;
+
+/*!
+ * SPI transaction state
+ */
+static bool SpiSelected = false;
+static bool SpiAddressPhase = false;
+static bool SpiWrite = false;
+static uint8_t SpiAddress = 0;
+
+static SimRadioState_t RadioState = SIM_RADIO_IDLE;
+
+/*!
+ * End of the current operation: TxDone, RxTimeout, RxDone or CadDone
+ */
+static SimEvent_t RadioEvent;
+
+/*!
+ * Frame being transmitted
+ */
+static SimFrame_t TxFrame;
+
+/*!
+ * Frames on the air towards the device, the one being received is RxFrame
+ */
+static SimFrame_t Air[SIM_RADIO_AIR_SIZE];
+static bool AirUsed[SIM_RADIO_AIR_SIZE];
+static int RxFrame = -1;
+
+/*!
+ * Time the receiver was turned on
+ */
+static SimTime_t RxStart;
+
+/*!
+ * Bandwidth in Hz of the LoRa bandwidth codes
+ */
+static const uint32_t LoRaBandwidths[10] = { 7810, 10420, 15630, 20830, 31250, 41670, 62500, 125000, 250000, 500000 };
+
+static const struct
+{
+  GPIO_TypeDef *Port;
+  uint16_t Pin;
+} DioPins[4] =
+{
+  { RADIO_DIO_0_PORT, RADIO_DIO_0_PIN },
+  { RADIO_DIO_1_PORT, RADIO_DIO_1_PIN },
+  { RADIO_DIO_2_PORT, RADIO_DIO_2_PIN },
+  { RADIO_DIO_3_PORT, RADIO_DIO_3_PIN },
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief Register of the page selected by the modem
+ */
+static uint8_t *SimRadio_Reg( uint8_t addr );
+
+static bool SimRadio_IsLoRa( void );
+
+static uint8_t SimRadio_GetMode( void );
+
+static void SimRadio_WriteReg( uint8_t addr, uint8_t value );
+
+static uint8_t SimRadio_ReadReg( uint8_t addr );
+
+/*!
+ * @brief Starts the operation of a new mode, stopping the current one
+ */
+static void SimRadio_SetMode( uint8_t mode );
+
+/*!
+ * @brief Back to standby at the end of a single operation
+ */
+static void SimRadio_Standby( void );
+
+/*!
+ * @brief Sets LoRa interrupt flags that are not masked
+ */
+static void SimRadio_SetIrqFlags( uint8_t flags );
+
+/*!
+ * @brief Drives the DIO pins from the interrupt flags and the DIO mapping
+ */
+static void SimRadio_UpdateDios( void );
+
+static uint32_t SimRadio_GetFrequency( void );
+
+/*!
+ * @brief LoRa symbol duration in nano seconds
+ */
+static uint64_t SimRadio_SymbolTime( uint8_t bandwidth, uint8_t sf );
+
+static void SimRadio_StartLoRaTx( void );
+
+static void SimRadio_StartFskTx( void );
+
+/*!
+ * @brief Looks for a frame of the air the receiver can lock on
+ */
+static void SimRadio_RxEvaluate( void );
+
+static void SimRadio_OnEvent( void *context );
+
+/* Exported functions ---------------------------------------------------------*/
+
+void SimRadio_Init( void )
+{
+  Sim_EventInit( &RadioEvent, SimRadio_OnEvent, NULL );
+  memset( AirUsed, 0, sizeof( AirUsed ) );
+  SimRadio_Reset( );
+}
+
+void SimRadio_Reset( void )
+{
+  Sim_EventDisarm( &RadioEvent );
+  RadioState = SIM_RADIO_IDLE;
+  RxFrame = -1;
+  FskFifoLen = 0;
+
+  memset( RegCommon, 0, sizeof( RegCommon ) );
+  memset( RegLoRa, 0, sizeof( RegLoRa ) );
+
+  /* Power on reset values of the registers the driver relies on */
+  RegCommon[REG_OPMODE] = RF_OPMODE_STANDBY | RFLR_OPMODE_FREQMODE_ACCESS_LF;
+  RegCommon[REG_BITRATEMSB] = 0x1A;
+  RegCommon[REG_BITRATELSB] = 0x0B;
+  RegCommon[REG_FRFMSB] = 0x6C;
+  RegCommon[REG_FRFMID] = 0x80;
+  RegCommon[REG_LR_PACONFIG] = 0x4F;
+  RegCommon[REG_LR_PARAMP] = 0x09;
+  RegCommon[REG_LR_OCP] = 0x2B;
+  RegCommon[REG_LR_LNA] = 0x20;
+  RegCommon[REG_PREAMBLELSB] = 0x03;
+  RegCommon[REG_SYNCCONFIG] = 0x93;
+  RegCommon[REG_PACKETCONFIG1] = 0x90;
+  RegCommon[REG_PAYLOADLENGTH] = 0x40;
+  RegCommon[REG_IMAGECAL] = 0x82;
+  RegCommon[REG_VERSION] = 0x12;
+  RegCommon[REG_PADAC] = 0x84;
+
+  RegLoRa[REG_LR_FIFOTXBASEADDR] = 0x80;
+  RegLoRa[REG_LR_MODEMCONFIG1] = 0x72;
+  RegLoRa[REG_LR_MODEMCONFIG2] = 0x70;
+  RegLoRa[REG_LR_SYMBTIMEOUTLSB] = 0x64;
+  RegLoRa[REG_LR_PREAMBLELSB] = 0x08;
+  RegLoRa[REG_LR_PAYLOADLENGTH] = 0x01;
+  RegLoRa[REG_LR_PAYLOADMAXLENGTH] = 0xFF;
+  RegLoRa[REG_LR_MODEMCONFIG3] = 0x04;
+  RegLoRa[REG_LR_DETECTOPTIMIZE] = 0xC3;
+  RegLoRa[REG_LR_INVERTIQ] = 0x27;
+  RegLoRa[REG_LR_DETECTIONTHRESHOLD] = 0x0A;
+  RegLoRa[REG_LR_SYNCWORD] = 0x12;
+  RegLoRa[REG_LR_INVERTIQ2] = 0x1D;
+
+  SimRadio_UpdateDios( );
+}
+
+void SimRadio_Select( uint32_t nss )
+{
+  if( nss == 0 )
+  {
+    SpiSelected = true;
+    SpiAddressPhase = true;
+    SimStats.SpiTransactions++;
+  }
+  else
+  {
+    SpiSelected = false;
+  }
+}
+
+void SimRadio_Transmit( const SimFrame_t *frame )
+{
+  int i;
+
+  for( i = 0; i < SIM_RADIO_AIR_SIZE; i++ )
+  {
+    /* frames over and not being received leave the air */
+    if( ( AirUsed[i] == true ) && ( Air[i].End < Sim_Now( ) ) && ( i != RxFrame ) )
+    {
+      AirUsed[i] = false;
+    }
+  }
+  for( i = 0; i < SIM_RADIO_AIR_SIZE; i++ )
+  {
+    if( AirUsed[i] == false )
+    {
+      Air[i] = *frame;
+      AirUsed[i] = true;
+      break;
+    }
+  }
+  if( i == SIM_RADIO_AIR_SIZE )
+  {
+    Sim_Log( "radio: air full, frame dropped" );
+    return;
+  }
+
+  if( RadioState == SIM_RADIO_RX_SEARCHING )
+  {
+    SimRadio_RxEvaluate( );
+  }
+}
+
+void HW_SPI_Init( void )
+{
+}
+
+void HW_SPI_DeInit( void )
+{
+}
+
+void HW_SPI_IoInit( void )
+{
+}
+
+void HW_SPI_IoDeInit( void )
+{
+}
+
+uint16_t HW_SPI_InOut( uint16_t txData )
+{
+  uint8_t rxData = 0;
+
+  if( SpiSelected == false )
+  {
+    return 0;
+  }
+  SimStats.SpiBytes++;
+
+  if( SpiAddressPhase == true )
+  {
+    SpiAddressPhase = false;
+    SpiWrite = ( txData & 0x80 ) != 0;
+    SpiAddress = txData & 0x7F;
+    return 0;
+  }
+
+  if( SpiWrite == true )
+  {
+    SimRadio_WriteReg( SpiAddress, ( uint8_t )txData );
+  }
+  else
+  {
+    rxData = SimRadio_ReadReg( SpiAddress );
+  }
+  /* the address auto-increments, except on the FIFO */
+  if( SpiAddress != REG_FIFO )
+  {
+    SpiAddress = ( SpiAddress + 1 ) & 0x7F;
+  }
+  return rxData;
+}
+
+void HW_SPI_Transfer( uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+  uint16_t i;
+  uint8_t data;
+
+  for( i = 0; i < size; i++ )
+  {
+    data = ( uint8_t )HW_SPI_InOut( ( txData != NULL ) ? txData[i] : 0 );
+    if( rxData != NULL )
+    {
+      rxData[i] = data;
+    }
+  }
+}
+
+SimTime_t SimRadio_TimeOnAir( const SimFrame_t *frame, bool crcOn, bool implicitHeader, bool lowDatarateOptimize )
+{
+  /* SX1276 datasheet, 4.1.1.7 */
+  double tSym = ( double )SimRadio_SymbolTime( frame->Bandwidth, frame->SpreadingFactor ) / 1000.0;
+  double tPreamble = ( frame->PreambleLen + 4.25 ) * tSym;
+  double num = 8.0 * frame->Size - 4.0 * frame->SpreadingFactor + 28 + ( crcOn ? 16 : 0 ) - ( implicitHeader ? 20 : 0 );
+  double den = 4.0 * ( frame->SpreadingFactor - ( lowDatarateOptimize ? 2 : 0 ) );
+  double nPayload = 8;
+
+  if( num > 0 )
+  {
+    nPayload += ceil( num / den ) * ( frame->CodingRate + 4 );
+  }
+  return ( SimTime_t )( tPreamble + nPayload * tSym + 0.5 );
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint8_t *SimRadio_Reg( uint8_t addr )
+{
+  if( ( SimRadio_IsLoRa( ) == true ) && ( addr >= REG_LR_FIFOADDRPTR ) && ( addr < REG_LR_DIOMAPPING1 ) )
+  {
+    return &RegLoRa[addr];
+  }
+  return &RegCommon[addr];
+}
+
+static bool SimRadio_IsLoRa( void )
+{
+  return ( RegCommon[REG_OPMODE] & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0;
+}
+
+static uint8_t SimRadio_GetMode( void )
+{
+  return RegCommon[REG_OPMODE] & ~RF_OPMODE_MASK;
+}
+
+static void SimRadio_WriteReg( uint8_t addr, uint8_t value )
+{
+  uint8_t previous;
+
+  switch( addr )
+  {
+  case REG_FIFO:
+    if( SimRadio_IsLoRa( ) == true )
+    {
+      LoRaFifo[RegLoRa[REG_LR_FIFOADDRPTR]++] = value;
+    }
+    else if( FskFifoLen < SIM_RADIO_FSK_FIFO_SIZE )
+    {
+      FskFifo[FskFifoLen++] = value;
+    }
+    return;
+
+  case REG_OPMODE:
+    previous = RegCommon[REG_OPMODE];
+    if( ( previous & ~RF_OPMODE_MASK ) != RF_OPMODE_SLEEP )
+    {
+      /* the modem can only be changed in sleep mode */
+      value = ( value & RFLR_OPMODE_LONGRANGEMODE_MASK ) | ( previous & RFLR_OPMODE_LONGRANGEMODE_ON );
+    }
+    RegCommon[REG_OPMODE] = value;
+    if( ( ( previous ^ value ) & ( RFLR_OPMODE_LONGRANGEMODE_ON | ~RF_OPMODE_MASK ) ) != 0 )
+    {
+      SimRadio_SetMode( value & ~RF_OPMODE_MASK );
+    }
+    return;
+
+  default:
+    break;
+  }
+
+  if( SimRadio_IsLoRa( ) == true )
+  {
+    switch( addr )
+    {
+    case REG_LR_IRQFLAGS:
+      /* flags are cleared by writing 1 */
+      RegLoRa[REG_LR_IRQFLAGS] &= ~value;
+      SimRadio_UpdateDios( );
+      return;
+    case REG_LR_RXNBBYTES:
+    case REG_LR_PKTSNRVALUE:
+    case REG_LR_PKTRSSIVALUE:
+    case REG_LR_RSSIVALUE:
+    case REG_LR_FIFORXCURRENTADDR:
+      /* read only */
+      return;
+    default:
+      break;
+    }
+  }
+  else if( addr == REG_IMAGECAL )
+  {
+    /* the image calibration completes at once */
+    value &= ~( RF_IMAGECAL_IMAGECAL_START | RF_IMAGECAL_IMAGECAL_RUNNING );
+  }
+
+  *SimRadio_Reg( addr ) = value;
+
+  if( addr == REG_DIOMAPPING1 )
+  {
+    SimRadio_UpdateDios( );
+  }
+}
+
+static uint8_t SimRadio_ReadReg( uint8_t addr )
+{
+  if( addr == REG_FIFO )
+  {
+    if( SimRadio_IsLoRa( ) == true )
+    {
+      return LoRaFifo[RegLoRa[REG_LR_FIFOADDRPTR]++];
+    }
+    return 0;
+  }
+  if( SimRadio_IsLoRa( ) == true )
+  {
+    switch( addr )
+    {
+    case REG_LR_RSSIVALUE:
+      /* noise floor, around -120 dBm */
+      return SIM_RADIO_RSSI_OFFSET_HF - 120 + ( Sim_Random( ) & 0x03 );
+    case REG_LR_RSSIWIDEBAND:
+      return ( uint8_t )Sim_Random( );
+    default:
+      break;
+    }
+  }
+  else if( addr == REG_RSSIVALUE )
+  {
+    /* -RSSI * 2 */
+    return 240 - ( Sim_Random( ) & 0x07 );
+  }
+  return *SimRadio_Reg( addr );
+}
+
+static void SimRadio_SetMode( uint8_t mode )
+{
+  /* a new mode stops the on going operation */
+  Sim_EventDisarm( &RadioEvent );
+  RadioState = SIM_RADIO_IDLE;
+  RxFrame = -1;
+  RegCommon[REG_IRQFLAGS2] &= ~RF_IRQFLAGS2_PACKETSENT;
+
+  if( SimRadio_IsLoRa( ) == true )
+  {
+    switch( mode )
+    {
+    case RFLR_OPMODE_TRANSMITTER:
+      SimRadio_StartLoRaTx( );
+      break;
+    case RFLR_OPMODE_RECEIVER:
+    case RFLR_OPMODE_RECEIVER_SINGLE:
+      RadioState = SIM_RADIO_RX_SEARCHING;
+      RxStart = Sim_Now( );
+      if( RegLoRa[REG_LR_IRQFLAGSMASK] != 0xFF )
+      {
+        /* not counted: the driver samples the wideband RSSI with all the interrupts masked */
+        SimStats.RxWindows++;
+      }
+      SimRadio_RxEvaluate( );
+      break;
+    case RFLR_OPMODE_CAD:
+      /* nobody else is on the air: the detection ends empty after 2 symbols */
+      RadioState = SIM_RADIO_CAD;
+      Sim_EventArm( &RadioEvent, Sim_Now( ) + ( 2 * SimRadio_SymbolTime( RegLoRa[REG_LR_MODEMCONFIG1] >> 4, RegLoRa[REG_LR_MODEMCONFIG2] >> 4 ) ) / 1000 );
+      break;
+    default:
+      break;
+    }
+  }
+  else
+  {
+    if( mode == RF_OPMODE_TRANSMITTER )
+    {
+      SimRadio_StartFskTx( );
+    }
+    else if( mode != RF_OPMODE_RECEIVER )
+    {
+      FskFifoLen = 0;
+    }
+    /* the FSK receiver never gets a frame, the driver times out */
+  }
+  SimRadio_UpdateDios( );
+}
+
+static void SimRadio_Standby( void )
+{
+  RegCommon[REG_OPMODE] = ( RegCommon[REG_OPMODE] & RF_OPMODE_MASK ) | RF_OPMODE_STANDBY;
+  RadioState = SIM_RADIO_IDLE;
+}
+
+static void SimRadio_SetIrqFlags( uint8_t flags )
+{
+  RegLoRa[REG_LR_IRQFLAGS] |= flags & ~RegLoRa[REG_LR_IRQFLAGSMASK];
+  SimRadio_UpdateDios( );
+}
+
+static void SimRadio_UpdateDios( void )
+{
+  uint8_t mapping = RegCommon[REG_DIOMAPPING1];
+  uint8_t flags = RegLoRa[REG_LR_IRQFLAGS];
+  uint8_t levels = 0;
+
+  if( SimRadio_IsLoRa( ) == true )
+  {
+    /* DIO0: RxDone, TxDone, CadDone */
+    switch( mapping & ~RFLR_DIOMAPPING1_DIO0_MASK )
+    {
+    case RFLR_DIOMAPPING1_DIO0_00: levels |= ( ( flags & RFLR_IRQFLAGS_RXDONE ) != 0 ) << 0; break;
+    case RFLR_DIOMAPPING1_DIO0_01: levels |= ( ( flags & RFLR_IRQFLAGS_TXDONE ) != 0 ) << 0; break;
+    case RFLR_DIOMAPPING1_DIO0_10: levels |= ( ( flags & RFLR_IRQFLAGS_CADDONE ) != 0 ) << 0; break;
+    default: break;
+    }
+    /* DIO1: RxTimeout, FhssChangeChannel, CadDetected */
+    switch( mapping & ~RFLR_DIOMAPPING1_DIO1_MASK )
+    {
+    case RFLR_DIOMAPPING1_DIO1_00: levels |= ( ( flags & RFLR_IRQFLAGS_RXTIMEOUT ) != 0 ) << 1; break;
+    case RFLR_DIOMAPPING1_DIO1_01: levels |= ( ( flags & RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL ) != 0 ) << 1; break;
+    case RFLR_DIOMAPPING1_DIO1_10: levels |= ( ( flags & RFLR_IRQFLAGS_CADDETECTED ) != 0 ) << 1; break;
+    default: break;
+    }
+    /* DIO2: FhssChangeChannel */
+    if( ( mapping & ~RFLR_DIOMAPPING1_DIO2_MASK ) != RFLR_DIOMAPPING1_DIO2_11 )
+    {
+      levels |= ( ( flags & RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL ) != 0 ) << 2;
+    }
+    /* DIO3: CadDone, ValidHeader, PayloadCrcError */
+    switch( mapping & ~RFLR_DIOMAPPING1_DIO3_MASK )
+    {
+    case RFLR_DIOMAPPING1_DIO3_00: levels |= ( ( flags & RFLR_IRQFLAGS_CADDONE ) != 0 ) << 3; break;
+    case RFLR_DIOMAPPING1_DIO3_01: levels |= ( ( flags & RFLR_IRQFLAGS_VALIDHEADER ) != 0 ) << 3; break;
+    case RFLR_DIOMAPPING1_DIO3_10: levels |= ( ( flags & RFLR_IRQFLAGS_PAYLOADCRCERROR ) != 0 ) << 3; break;
+    default: break;
+    }
+  }
+  else if( ( ( mapping & ~RF_DIOMAPPING1_DIO0_MASK ) == RF_DIOMAPPING1_DIO0_00 ) &&
+           ( ( RegCommon[REG_IRQFLAGS2] & RF_IRQFLAGS2_PACKETSENT ) != 0 ) )
+  {
+    /* DIO0: PacketSent in transmit mode */
+    levels |= 1;
+  }
+
+  for( int i = 0; i < 4; i++ )
+  {
+    SimGpio_SetInput( DioPins[i].Port, DioPins[i].Pin, ( levels >> i ) & 1 );
+  }
+}
+
+static uint32_t SimRadio_GetFrequency( void )
+{
+  uint32_t frf = ( ( uint32_t )RegCommon[REG_FRFMSB] << 16 ) | ( ( uint32_t )RegCommon[REG_FRFMID] << 8 ) | RegCommon[REG_FRFLSB];
+
+  return ( uint32_t )( ( ( uint64_t )frf * SIM_RADIO_XTAL_FREQ ) >> 19 );
+}
+
+static uint64_t SimRadio_SymbolTime( uint8_t bandwidth, uint8_t sf )
+{
+  if( bandwidth > 9 )
+  {
+    bandwidth = 9;
+  }
+  return ( ( uint64_t )1000000000 << sf ) / LoRaBandwidths[bandwidth];
+}
+
+static void SimRadio_StartLoRaTx( void )
+{
+  uint8_t config1 = RegLoRa[REG_LR_MODEMCONFIG1];
+  uint8_t config2 = RegLoRa[REG_LR_MODEMCONFIG2];
+  uint8_t address = RegLoRa[REG_LR_FIFOTXBASEADDR];
+  SimTime_t timeOnAir;
+
+  TxFrame.Frequency = SimRadio_GetFrequency( );
+  TxFrame.Bandwidth = config1 >> 4;
+  TxFrame.CodingRate = ( config1 >> 1 ) & 0x07;
+  TxFrame.SpreadingFactor = config2 >> 4;
+  TxFrame.PreambleLen = ( ( uint16_t )RegLoRa[REG_LR_PREAMBLEMSB] << 8 ) | RegLoRa[REG_LR_PREAMBLELSB];
+  TxFrame.IqInverted = ( RegLoRa[REG_LR_INVERTIQ] & ~RFLR_INVERTIQ_TX_MASK ) == RFLR_INVERTIQ_TX_ON;
+  TxFrame.SyncWord = RegLoRa[REG_LR_SYNCWORD];
+  TxFrame.Rssi = 0;
+  TxFrame.Snr = 0;
+  TxFrame.Size = RegLoRa[REG_LR_PAYLOADLENGTH];
+  for( int i = 0; i < TxFrame.Size; i++ )
+  {
+    TxFrame.Payload[i] = LoRaFifo[( uint8_t )( address + i )];
+  }
+
+  timeOnAir = SimRadio_TimeOnAir( &TxFrame, ( config2 & RFLR_MODEMCONFIG2_RXPAYLOADCRC_ON ) != 0,
+                                  ( config1 & RFLR_MODEMCONFIG1_IMPLICITHEADER_ON ) != 0,
+                                  ( RegLoRa[REG_LR_MODEMCONFIG3] & RFLR_MODEMCONFIG3_LOWDATARATEOPTIMIZE_ON ) != 0 );
+  TxFrame.Start = Sim_Now( );
+  TxFrame.End = TxFrame.Start + timeOnAir;
+
+  SimStats.TxFrames++;
+  SimStats.TxAirTime += timeOnAir;
+  if( SimConfig.Verbose == true )
+  {
+    Sim_Log( "radio: tx %u.%06u MHz SF%u BW%u %u bytes, %u.%03u ms on air", TxFrame.Frequency / 1000000, TxFrame.Frequency % 1000000,
+             TxFrame.SpreadingFactor, LoRaBandwidths[TxFrame.Bandwidth] / 1000, TxFrame.Size,
+             ( uint32_t )( timeOnAir / 1000 ), ( uint32_t )( timeOnAir % 1000 ) );
+  }
+
+  RadioState = SIM_RADIO_TX;
+  Sim_EventArm( &RadioEvent, TxFrame.End );
+  SimChannel_Transmit( &TxFrame );
+}
+
+static void SimRadio_StartFskTx( void )
+{
+  uint32_t bitrate = ( ( uint32_t )RegCommon[REG_BITRATEMSB] << 8 ) | RegCommon[REG_BITRATELSB];
+  uint32_t size;
+  uint32_t bits;
+  SimTime_t timeOnAir;
+
+  if( ( RegCommon[REG_PACKETCONFIG1] & RF_PACKETCONFIG1_PACKETFORMAT_VARIABLE ) != 0 )
+  {
+    size = ( FskFifoLen > 0 ) ? FskFifo[0] + 1 : 1;
+  }
+  else
+  {
+    size = RegCommon[REG_PAYLOADLENGTH];
+  }
+  /* preamble, sync word, payload and CRC */
+  bits = 8 * ( ( ( ( uint32_t )RegCommon[REG_PREAMBLEMSB] << 8 ) | RegCommon[REG_PREAMBLELSB] ) +
+               ( ( RegCommon[REG_SYNCCONFIG] & ~RF_SYNCCONFIG_SYNCSIZE_MASK ) + 1 ) + size +
+               ( ( ( RegCommon[REG_PACKETCONFIG1] & RF_PACKETCONFIG1_CRC_ON ) != 0 ) ? 2 : 0 ) );
+  timeOnAir = ( ( SimTime_t )bits * ( bitrate != 0 ? bitrate : 1 ) * 1000000 + ( SIM_RADIO_XTAL_FREQ / 2 ) ) / SIM_RADIO_XTAL_FREQ;
+
+  FskFifoLen = 0;
+  SimStats.TxFrames++;
+  SimStats.TxAirTime += timeOnAir;
+  if( SimConfig.Verbose == true )
+  {
+    Sim_Log( "radio: fsk tx %u bytes, %u us on air (not forwarded to the network)", size, ( uint32_t )timeOnAir );
+  }
+
+  RadioState = SIM_RADIO_TX;
+  Sim_EventArm( &RadioEvent, Sim_Now( ) + timeOnAir );
+}
+
+static void SimRadio_RxEvaluate( void )
+{
+  uint8_t bandwidth = RegLoRa[REG_LR_MODEMCONFIG1] >> 4;
+  uint8_t sf = RegLoRa[REG_LR_MODEMCONFIG2] >> 4;
+  uint32_t frequency = SimRadio_GetFrequency( );
+  bool iqInverted = ( RegLoRa[REG_LR_INVERTIQ] & ~RFLR_INVERTIQ_RX_MASK ) == RFLR_INVERTIQ_RX_ON;
+  uint64_t tSym = SimRadio_SymbolTime( bandwidth, sf );
+  uint32_t symbTimeout = ( ( uint32_t )( RegLoRa[REG_LR_MODEMCONFIG2] & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) << 8 ) |
+                         RegLoRa[REG_LR_SYMBTIMEOUTLSB];
+  SimTime_t timeout = RxStart + ( symbTimeout * tSym ) / 1000;
+  SimTime_t lock;
+  SimTime_t bestLock = 0;
+  int best = -1;
+
+  for( int i = 0; i < SIM_RADIO_AIR_SIZE; i++ )
+  {
+    const SimFrame_t *frame = &Air[i];
+
+    if( ( AirUsed[i] == false ) || ( frame->SpreadingFactor != sf ) || ( frame->Bandwidth != bandwidth ) ||
+        ( frame->IqInverted != iqInverted ) || ( frame->SyncWord != RegLoRa[REG_LR_SYNCWORD] ) ||
+        ( ( frame->Frequency > frequency ? frame->Frequency - frequency : frequency - frame->Frequency ) > LoRaBandwidths[bandwidth] / 4 ) )
+    {
+      continue;
+    }
+    /* the modem needs a few preamble symbols to lock */
+    lock = ( ( RxStart > frame->Start ) ? RxStart : frame->Start ) + ( SIM_RADIO_DETECT_SYMBOLS * tSym ) / 1000;
+    if( lock > frame->Start + ( frame->PreambleLen * tSym ) / 1000 )
+    {
+      continue;
+    }
+    if( ( SimRadio_GetMode( ) == RFLR_OPMODE_RECEIVER_SINGLE ) && ( lock > timeout ) )
+    {
+      continue;
+    }
+    if( ( best < 0 ) || ( lock < bestLock ) )
+    {
+      best = i;
+      bestLock = lock;
+    }
+  }
+
+  if( best >= 0 )
+  {
+    RadioState = SIM_RADIO_RX_RECEIVING;
+    RxFrame = best;
+    Sim_EventArm( &RadioEvent, Air[best].End );
+  }
+  else if( SimRadio_GetMode( ) == RFLR_OPMODE_RECEIVER_SINGLE )
+  {
+    Sim_EventArm( &RadioEvent, timeout );
+  }
+}
+
+static void SimRadio_OnEvent( void *context )
+{
+  const SimFrame_t *frame;
+  uint8_t address;
+
+  switch( RadioState )
+  {
+  case SIM_RADIO_TX:
+    SimRadio_Standby( );
+    if( SimRadio_IsLoRa( ) == true )
+    {
+      SimRadio_SetIrqFlags( RFLR_IRQFLAGS_TXDONE );
+    }
+    else
+    {
+      RegCommon[REG_IRQFLAGS2] |= RF_IRQFLAGS2_PACKETSENT;
+      SimRadio_UpdateDios( );
+    }
+    break;
+
+  case SIM_RADIO_RX_SEARCHING:
+    SimStats.RxTimeouts++;
+    if( SimConfig.Verbose == true )
+    {
+      Sim_Log( "radio: rx timeout" );
+    }
+    SimRadio_Standby( );
+    SimRadio_SetIrqFlags( RFLR_IRQFLAGS_RXTIMEOUT );
+    break;
+
+  case SIM_RADIO_RX_RECEIVING:
+    frame = &Air[RxFrame];
+    address = RegLoRa[REG_LR_FIFORXBASEADDR];
+    for( int i = 0; i < frame->Size; i++ )
+    {
+      LoRaFifo[( uint8_t )( address + i )] = frame->Payload[i];
+    }
+    RegLoRa[REG_LR_FIFORXCURRENTADDR] = address;
+    RegLoRa[REG_LR_RXNBBYTES] = frame->Size;
+    RegLoRa[REG_LR_PKTSNRVALUE] = ( uint8_t )( frame->Snr * 4 );
+    RegLoRa[REG_LR_PKTRSSIVALUE] = ( uint8_t )( frame->Rssi + SIM_RADIO_RSSI_OFFSET_HF );
+    AirUsed[RxFrame] = false;
+    RxFrame = -1;
+
+    SimStats.RxFrames++;
+    if( SimConfig.Verbose == true )
+    {
+      Sim_Log( "radio: rx %u bytes", frame->Size );
+    }
+    if( SimRadio_GetMode( ) == RFLR_OPMODE_RECEIVER_SINGLE )
+    {
+      SimRadio_Standby( );
+    }
+    else
+    {
+      /* continuous reception goes on */
+      RadioState = SIM_RADIO_RX_SEARCHING;
+      RxStart = Sim_Now( );
+    }
+    SimRadio_SetIrqFlags( RFLR_IRQFLAGS_VALIDHEADER | RFLR_IRQFLAGS_RXDONE );
+    break;
+
+  case SIM_RADIO_CAD:
+    SimRadio_Standby( );
+    SimRadio_SetIrqFlags( RFLR_IRQFLAGS_CADDONE );
+    break;
+
+  default:
+    break;
+  }
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * @file    sim_rtc.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   RTC timer of the host simulator, counts on the simulated time
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw.h"
+#include "timeServer.h"
+#include "sim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+
+/* MINIMUM alarm duration, as on the boards */
+#define MIN_ALARM_DELAY               3 /* in ticks */
+
+/* The RTC ticks at 1024 Hz, as on the boards (N_PREDIV_S in hw_rtc.c) */
+#define N_PREDIV_S                 10
+
+#define USEC_NUMBER               1000000
+#define MSEC_NUMBER               (USEC_NUMBER/1000)
+
+#define COMMON_FACTOR        3
+#define CONV_NUMER                (MSEC_NUMBER>>COMMON_FACTOR)
+#define CONV_DENOM                (1<<(N_PREDIV_S-COMMON_FACTOR))
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/*!
+ * Tick value of the time reference of the timer server
+ */
+static uint32_t RtcTimerContext = 0;
+
+/*!
+ * Alarm A, raises the RTC interrupt line when it expires
+ */
+static SimEvent_t RtcAlarm;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/*!
+ * @brief Number of ticks counted since the power up
+ */
+static uint64_t HW_RTC_GetTicks( void );
+
+/*!
+ * @brief Alarm A expiry
+ */
+static void HW_RTC_OnAlarm( void *context );
+
+/* Exported functions ---------------------------------------------------------*/
+
+void HW_RTC_Init( void )
+{
+  Sim_EventInit( &RtcAlarm, HW_RTC_OnAlarm, NULL );
+  HW_RTC_SetTimerContext( );
+}
+
+void HW_RTC_setMcuWakeUpTime( void )
+{
+}
+
+int16_t HW_RTC_getMcuWakeUpTime( void )
+{
+  /* the simulated MCU wakes up instantly */
+  return 0;
+}
+
+uint32_t HW_RTC_GetMinimumTimeout( void )
+{
+  return( MIN_ALARM_DELAY );
+}
+
+uint32_t HW_RTC_ms2Tick( TimerTime_t timeMicroSec )
+{
+  return ( uint32_t) ( ( ((uint64_t)timeMicroSec) * CONV_DENOM ) / CONV_NUMER );
+}
+
+TimerTime_t HW_RTC_Tick2ms( uint32_t tick )
+{
+  return  ( ( (uint64_t)( tick )* CONV_NUMER ) / CONV_DENOM );
+}
+
+void HW_RTC_SetAlarm( uint32_t timeout )
+{
+  uint64_t now = HW_RTC_GetTicks( );
+  /* the timeout counts from the time reference, the tick counter wraps */
+  int32_t delta = ( int32_t )( RtcTimerContext + timeout - ( uint32_t )now );
+  uint64_t alarm = now + ( ( delta > 0 ) ? delta : 0 );
+
+  /* first micro second at which the counter reads the alarm value */
+  Sim_EventArm( &RtcAlarm, ( ( alarm * USEC_NUMBER ) + ( 1 << N_PREDIV_S ) - 1 ) >> N_PREDIV_S );
+}
+
+uint32_t HW_RTC_GetTimerElapsedTime( void )
+{
+  return( ( uint32_t )HW_RTC_GetTicks( ) - RtcTimerContext );
+}
+
+uint32_t HW_RTC_GetTimerValue( void )
+{
+  return( ( uint32_t )HW_RTC_GetTicks( ) );
+}
+
+void HW_RTC_StopAlarm( void )
+{
+  Sim_EventDisarm( &RtcAlarm );
+  Sim_IrqClearPending( SIM_IRQ_RTC );
+}
+
+void HW_RTC_IrqHandler ( void )
+{
+  /* AlarmA callback */
+  TimerIrqHandler( );
+}
+
+void HW_RTC_DelayMs( uint32_t delay )
+{
+  Sim_Advance( Sim_Now( ) + ( SimTime_t )delay * MSEC_NUMBER );
+}
+
+uint32_t HW_RTC_SetTimerContext( void )
+{
+  RtcTimerContext = ( uint32_t )HW_RTC_GetTicks( );
+  return RtcTimerContext;
+}
+
+uint32_t HW_RTC_GetTimerContext( void )
+{
+  return RtcTimerContext;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint64_t HW_RTC_GetTicks( void )
+{
+  return ( Sim_Now( ) << N_PREDIV_S ) / USEC_NUMBER;
+}
+
+static void HW_RTC_OnAlarm( void *context )
+{
+  Sim_IrqSetPending( SIM_IRQ_RTC );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ * @file    bench_ctr.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host benchmark of the FRMPayload encryption: batched keystream
+ *          against one counter block at a time, for 1 to 242 bytes payloads
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "utilities.h"
+#include "aes.h"
+#include "LoRaMacCrypto.h"
+#include "sim_test.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Encryptions per measure */
+#define BENCH_LOOPS                 1000
+
+/* Largest LoRaWAN FRMPayload */
+#define BENCH_MAX_SIZE              242
+
+/* Private variables ---------------------------------------------------------*/
+
+static const uint8_t BenchSizes[] = { 1, 16, 51, 64, 115, 128, 222, 242 };
+
+static aes_context BenchContext;
+
+/* Private functions ---------------------------------------------------------*/
+
+/*!
+ * @brief The payload encryption as done before the keystream batches: one
+ *        counter block at a time and a byte per byte XOR. The key is
+ *        expanded on each call unless expandKey is false.
+ */
+static void BenchEncryptPerBlock( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint8_t *encBuffer, bool expandKey )
+{
+  uint8_t aBlock[16] = { 0x01 };
+  uint8_t sBlock[16];
+  uint16_t i;
+  uint8_t bufferIndex = 0;
+  uint16_t ctr = 1;
+
+  if( expandKey == true )
+  {
+    memset1( BenchContext.ksch, '\0', 240 );
+    aes_set_key( key, 16, &BenchContext );
+  }
+
+  aBlock[5] = dir;
+  aBlock[6] = ( address ) & 0xFF;
+  aBlock[7] = ( address >> 8 ) & 0xFF;
+  aBlock[8] = ( address >> 16 ) & 0xFF;
+  aBlock[9] = ( address >> 24 ) & 0xFF;
+  aBlock[10] = ( sequenceCounter ) & 0xFF;
+  aBlock[11] = ( sequenceCounter >> 8 ) & 0xFF;
+  aBlock[12] = ( sequenceCounter >> 16 ) & 0xFF;
+  aBlock[13] = ( sequenceCounter >> 24 ) & 0xFF;
+
+  while( size >= 16 )
+  {
+    aBlock[15] = ( ( ctr ) & 0xFF );
+    ctr++;
+    aes_encrypt( aBlock, sBlock, &BenchContext );
+    for( i = 0; i < 16; i++ )
+    {
+      encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
+    }
+    size -= 16;
+    bufferIndex += 16;
+  }
+
+  if( size > 0 )
+  {
+    aBlock[15] = ( ( ctr ) & 0xFF );
+    aes_encrypt( aBlock, sBlock, &BenchContext );
+    for( i = 0; i < size; i++ )
+    {
+      encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
+    }
+  }
+}
+
+/*!
+ * @brief Same cipher text as the per block encryption, for every size,
+ *        alignment, in place or not, and for the bare keystream
+ */
+static void BenchCheck( const uint8_t *key )
+{
+  uint8_t buffer[256 + 4];
+  uint8_t ref[256];
+  uint8_t out[256 + 4];
+  uint8_t keystream[16 * 16];
+  uint16_t size;
+  uint16_t offset;
+  uint16_t i;
+
+  for( i = 0; i < sizeof( buffer ); i++ )
+  {
+    buffer[i] = rand( );
+  }
+  for( size = 0; size <= 255; size++ )
+  {
+    for( offset = 0; offset < 4; offset++ )
+    {
+      BenchEncryptPerBlock( buffer + offset, size, key, 0x26011234, offset & 1, size, ref, true );
+
+      LoRaMacPayloadEncrypt( buffer + offset, size, key, 0x26011234, offset & 1, size, out + ( 3 - offset ) );
+      TEST_CHECK( memcmp( ref, out + ( 3 - offset ), size ) == 0 );
+
+      memcpy( out, buffer, sizeof( out ) );
+      LoRaMacPayloadEncrypt( out + offset, size, key, 0x26011234, offset & 1, size, out + offset );
+      TEST_CHECK( memcmp( ref, out + offset, size ) == 0 );
+
+      /* the keystream is the encryption of zeros */
+      if( ( size % 16 ) == 0 )
+      {
+        memset( out, 0, size );
+        BenchEncryptPerBlock( out, size, key, 0x26011234, offset & 1, size, ref, true );
+        LoRaMacPayloadKeystream( key, 0x26011234, offset & 1, size, 1, size / 16, keystream );
+        TEST_CHECK( memcmp( ref, keystream, size ) == 0 );
+      }
+    }
+  }
+}
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( void )
+{
+  uint8_t key[16];
+  uint8_t buffer[BENCH_MAX_SIZE + 1];
+  uint8_t out[BENCH_MAX_SIZE + 1];
+  uint64_t cycles[5];
+  uint16_t size;
+  uint32_t i;
+  uint32_t n;
+
+  srand( 1 );
+  for( i = 0; i < 16; i++ )
+  {
+    key[i] = rand( );
+  }
+  for( i = 0; i < sizeof( buffer ); i++ )
+  {
+    buffer[i] = rand( );
+  }
+
+  /* the key not cached, then cached as the AppSKey */
+  BenchCheck( key );
+  LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, key );
+  BenchCheck( key );
+
+  printf( "cycles per payload encryption, %s\n", ( TestFailures == 0 ) ? "identical results" : "RESULTS DIFFER" );
+  printf( "  per block: one counter block at a time and a byte XOR, with and without the key expansion\n" );
+  printf( "  batched: LoRaMacPayloadEncrypt with the cached key, out of place, in place, unaligned\n" );
+  printf( " size  per block   (no key)   batched   in place  unaligned  speedup\n" );
+  for( n = 0; n < sizeof( BenchSizes ); n++ )
+  {
+    size = BenchSizes[n];
+
+    TEST_MEASURE( cycles[0], BENCH_LOOPS, BenchEncryptPerBlock( buffer, size, key, 0x26011234, 0, size, out, true ) );
+    TEST_MEASURE( cycles[1], BENCH_LOOPS, BenchEncryptPerBlock( buffer, size, key, 0x26011234, 0, size, out, false ) );
+    TEST_MEASURE( cycles[2], BENCH_LOOPS, LoRaMacPayloadEncrypt( buffer, size, key, 0x26011234, 0, size, out ) );
+    TEST_MEASURE( cycles[3], BENCH_LOOPS, LoRaMacPayloadEncrypt( out, size, key, 0x26011234, 0, size, out ) );
+    TEST_MEASURE( cycles[4], BENCH_LOOPS, LoRaMacPayloadEncrypt( buffer + 1, size, key, 0x26011234, 0, size, out ) );
+
+    printf( "%5u %10lu %10lu %9lu %10lu %10lu %8.2f\n", size, ( unsigned long )cycles[0], ( unsigned long )cycles[1],
+            ( unsigned long )cycles[2], ( unsigned long )cycles[3], ( unsigned long )cycles[4],
+            ( double )cycles[0] / ( double )( cycles[2] ? cycles[2] : 1 ) );
+  }
+
+  return TEST_END( "bench_ctr" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
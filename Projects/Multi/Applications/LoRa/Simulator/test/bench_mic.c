@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file    bench_mic.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host benchmark of the LoRaWAN MIC: LoRaMacComputeMicFast against
+ *          the AES_CMAC context path, for 1 to 242 bytes payloads
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "utilities.h"
+#include "aes.h"
+#include "cmac.h"
+#include "LoRaMacCrypto.h"
+#include "sim_test.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* MICs per measure */
+#define BENCH_LOOPS                 2000
+
+/* Largest LoRaWAN frame without its MIC */
+#define BENCH_MAX_SIZE              242
+
+/* Private variables ---------------------------------------------------------*/
+
+static const uint8_t BenchSizes[] = { 1, 8, 15, 16, 17, 32, 51, 64, 115, 128, 222, 242 };
+
+/* Private functions ---------------------------------------------------------*/
+
+/*!
+ * @brief The MIC as computed before the subkeys were cached: the key is
+ *        expanded, the subkeys derived and B0 copied through the CMAC context
+ *        on every call
+ */
+static void BenchMicCmac( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t address, uint8_t dir, uint32_t sequenceCounter, uint32_t *mic )
+{
+  static uint8_t MicBlockB0[16] = { 0x49 };
+  static AES_CMAC_CTX AesCmacCtx[1];
+  uint8_t digest[16];
+
+  MicBlockB0[5] = dir;
+  MicBlockB0[6] = ( address ) & 0xFF;
+  MicBlockB0[7] = ( address >> 8 ) & 0xFF;
+  MicBlockB0[8] = ( address >> 16 ) & 0xFF;
+  MicBlockB0[9] = ( address >> 24 ) & 0xFF;
+  MicBlockB0[10] = ( sequenceCounter ) & 0xFF;
+  MicBlockB0[11] = ( sequenceCounter >> 8 ) & 0xFF;
+  MicBlockB0[12] = ( sequenceCounter >> 16 ) & 0xFF;
+  MicBlockB0[13] = ( sequenceCounter >> 24 ) & 0xFF;
+  MicBlockB0[15] = size & 0xFF;
+
+  AES_CMAC_Init( AesCmacCtx );
+  AES_CMAC_SetKey( AesCmacCtx, key );
+  AES_CMAC_Update( AesCmacCtx, MicBlockB0, 16 );
+  AES_CMAC_Update( AesCmacCtx, buffer, size & 0xFF );
+  AES_CMAC_Final( digest, AesCmacCtx );
+
+  *mic = ( uint32_t )digest[3] << 24 | ( uint32_t )digest[2] << 16 | ( uint32_t )digest[1] << 8 | ( uint32_t )digest[0];
+}
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( void )
+{
+  uint8_t key[16];
+  uint8_t buffer[BENCH_MAX_SIZE];
+  uint32_t micRef;
+  uint32_t mic;
+  uint32_t address;
+  uint32_t fcnt;
+  uint64_t start;
+  uint64_t cmacCycles;
+  uint64_t fastCycles;
+  uint16_t size;
+  uint32_t i;
+  uint32_t n;
+
+  srand( 1 );
+  for( i = 0; i < 16; i++ )
+  {
+    key[i] = rand( );
+  }
+  for( i = 0; i < sizeof( buffer ); i++ )
+  {
+    buffer[i] = rand( );
+  }
+  LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, key );
+
+  /* same MIC for every size, both directions, and from the uncached entry point */
+  for( size = 0; size <= BENCH_MAX_SIZE; size++ )
+  {
+    for( i = 0; i < 2; i++ )
+    {
+      address = rand( );
+      fcnt = rand( );
+      BenchMicCmac( buffer, size, key, address, i, fcnt, &micRef );
+      LoRaMacComputeMicFast( LORAMAC_CRYPTO_NWK_S_KEY, i, address, fcnt, buffer, size, &mic );
+      TEST_CHECK( mic == micRef );
+      LoRaMacComputeMic( buffer, size, key, address, i, fcnt, &mic );
+      TEST_CHECK( mic == micRef );
+    }
+  }
+  LoRaMacCryptoClearKey( LORAMAC_CRYPTO_NWK_S_KEY );
+  for( size = 0; size <= BENCH_MAX_SIZE; size += 17 )
+  {
+    BenchMicCmac( buffer, size, key, 0x26011234, 0, size, &micRef );
+    LoRaMacComputeMic( buffer, size, key, 0x26011234, 0, size, &mic );
+    TEST_CHECK( mic == micRef );
+  }
+  LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, key );
+
+  printf( "cycles per MIC, %s\n", ( TestFailures == 0 ) ? "identical results" : "RESULTS DIFFER" );
+  printf( " size     AES_CMAC  MicFast  speedup\n" );
+  for( n = 0; n < sizeof( BenchSizes ); n++ )
+  {
+    size = BenchSizes[n];
+
+    start = TestCycles( );
+    for( i = 0; i < BENCH_LOOPS; i++ )
+    {
+      BenchMicCmac( buffer, size, key, 0x26011234, 0, i, &mic );
+    }
+    cmacCycles = ( TestCycles( ) - start ) / BENCH_LOOPS;
+
+    start = TestCycles( );
+    for( i = 0; i < BENCH_LOOPS; i++ )
+    {
+      LoRaMacComputeMicFast( LORAMAC_CRYPTO_NWK_S_KEY, 0, 0x26011234, i, buffer, size, &mic );
+    }
+    fastCycles = ( TestCycles( ) - start ) / BENCH_LOOPS;
+
+    printf( "%5u %12lu %8lu %7.2f\n", size, ( unsigned long )cmacCycles, ( unsigned long )fastCycles,
+            ( double )cmacCycles / ( double )( fastCycles ? fastCycles : 1 ) );
+  }
+
+  return TEST_END( "bench_mic" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
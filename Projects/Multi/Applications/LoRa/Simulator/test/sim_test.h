@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * @file    sim_test.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Checks and cycle counter of the host tests and benchmarks
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SIM_TEST_H__
+#define __SIM_TEST_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+
+/*!
+ * Number of failed checks of the test program, its exit status
+ */
+static uint32_t TestFailures = 0;
+
+/* Exported macros -----------------------------------------------------------*/
+
+/*!
+ * Counts and reports a failed condition, the test goes on
+ */
+#define TEST_CHECK( cond )                                                      \
+  do                                                                            \
+  {                                                                             \
+    if( !( cond ) )                                                             \
+    {                                                                           \
+      printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond );         \
+      TestFailures++;                                                           \
+    }                                                                           \
+  } while( 0 )
+
+/*!
+ * Reports the result of the test program, to be returned by main( )
+ */
+#define TEST_END( name )                                                        \
+  ( printf( "%s: %s (%u failed checks)\n", ( name ), ( TestFailures == 0 ) ? "ok" : "FAILED", TestFailures ), \
+    ( TestFailures == 0 ) ? 0 : 1 )
+
+/*!
+ * Measures the cycles of one run of the statement: the best of 5 rounds
+ * of loops runs, which keeps the preemptions of the host out
+ */
+#define TEST_MEASURE( cycles, loops, statement )                               \
+  do                                                                            \
+  {                                                                             \
+    uint64_t measureStart;                                                      \
+    uint64_t measureRound;                                                      \
+    uint32_t measureN;                                                          \
+    uint32_t measureLoop;                                                       \
+                                                                                \
+    ( cycles ) = UINT64_MAX;                                                    \
+    for( measureN = 0; measureN < 5; measureN++ )                               \
+    {                                                                           \
+      measureStart = TestCycles( );                                             \
+      for( measureLoop = 0; measureLoop < ( loops ); measureLoop++ )            \
+      {                                                                         \
+        statement;                                                              \
+      }                                                                         \
+      measureRound = ( TestCycles( ) - measureStart ) / ( loops );              \
+      if( measureRound < ( cycles ) )                                           \
+      {                                                                         \
+        ( cycles ) = measureRound;                                              \
+      }                                                                         \
+    }                                                                           \
+  } while( 0 )
+
+/* Exported functions ------------------------------------------------------- */
+
+/*!
+ * @brief Reads a free running cycle counter: the TSC on x86, else the
+ *        monotonic clock in ns
+ */
+static inline uint64_t TestCycles( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+  return __rdtsc( );
+#else
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ( uint64_t )ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_TEST_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ * @file    test_aes.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the AES encryption backends: FIPS-197 and RFC 4493
+ *          vectors, built once per backend
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "utilities.h"
+#include "aes.h"
+#include "cmac.h"
+#include "LoRaMacCrypto.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+typedef struct
+{
+  const char *Name;
+  uint8_t KeyLen;
+  uint8_t Key[32];
+  uint8_t Plain[16];
+  uint8_t Cipher[16];
+} AesVector_t;
+
+typedef struct
+{
+  const char *Name;
+  uint8_t Size;
+  uint8_t Mac[16];
+} CmacVector_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+/* FIPS-197 appendix B and appendix C.1 to C.3 */
+static const AesVector_t AesVectors[] =
+{
+  { "FIPS-197 B", 16,
+    { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c },
+    { 0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34 },
+    { 0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32 } },
+  { "FIPS-197 C.1", 16,
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f },
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+    { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a } },
+  { "FIPS-197 C.2", 24,
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 },
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+    { 0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91 } },
+  { "FIPS-197 C.3", 32,
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f },
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+    { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 } },
+};
+
+/* RFC 4493 section 4: the key and the message they all use */
+static const uint8_t CmacKey[16] =
+{
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t CmacMessage[64] =
+{
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static const CmacVector_t CmacVectors[] =
+{
+  { "RFC 4493 example 1", 0,
+    { 0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46 } },
+  { "RFC 4493 example 2", 16,
+    { 0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c } },
+  { "RFC 4493 example 3", 40,
+    { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 } },
+  { "RFC 4493 example 4", 64,
+    { 0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe } },
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+static void TestAesVectors( void )
+{
+  aes_context ctx;
+  uint8_t out[16];
+  uint32_t i;
+
+  for( i = 0; i < sizeof( AesVectors ) / sizeof( AesVectors[0] ); i++ )
+  {
+    memset( &ctx, 0, sizeof( ctx ) );
+    TEST_CHECK( aes_set_key( AesVectors[i].Key, AesVectors[i].KeyLen, &ctx ) == 0 );
+    aes_encrypt( AesVectors[i].Plain, out, &ctx );
+    if( memcmp( out, AesVectors[i].Cipher, 16 ) != 0 )
+    {
+      printf( "%s: wrong cipher text\n", AesVectors[i].Name );
+      TestFailures++;
+    }
+    /* in place, as the LoRaMac does */
+    memcpy( out, AesVectors[i].Plain, 16 );
+    aes_encrypt( out, out, &ctx );
+    TEST_CHECK( memcmp( out, AesVectors[i].Cipher, 16 ) == 0 );
+    aes_decrypt( out, out, &ctx );
+    TEST_CHECK( memcmp( out, AesVectors[i].Plain, 16 ) == 0 );
+  }
+}
+
+static void TestCmacVectors( void )
+{
+  AES_CMAC_CTX cmac;
+  uint8_t digest[16];
+  uint32_t mic;
+  uint32_t i;
+  uint32_t split;
+
+  for( i = 0; i < sizeof( CmacVectors ) / sizeof( CmacVectors[0] ); i++ )
+  {
+    /* in one update, then split in two at every position */
+    for( split = 0; split <= CmacVectors[i].Size; split++ )
+    {
+      AES_CMAC_Init( &cmac );
+      AES_CMAC_SetKey( &cmac, CmacKey );
+      AES_CMAC_Update( &cmac, CmacMessage, split );
+      AES_CMAC_Update( &cmac, CmacMessage + split, CmacVectors[i].Size - split );
+      AES_CMAC_Final( digest, &cmac );
+      if( memcmp( digest, CmacVectors[i].Mac, 16 ) != 0 )
+      {
+        printf( "%s: wrong AES_CMAC, split at %u\n", CmacVectors[i].Name, split );
+        TestFailures++;
+      }
+    }
+
+    /* the join MIC is the first 4 bytes of the CMAC, without and with the key cache */
+    LoRaMacJoinComputeMic( CmacMessage, CmacVectors[i].Size, CmacKey, &mic );
+    TEST_CHECK( mic == ( ( uint32_t )CmacVectors[i].Mac[3] << 24 | ( uint32_t )CmacVectors[i].Mac[2] << 16 |
+                         ( uint32_t )CmacVectors[i].Mac[1] << 8 | CmacVectors[i].Mac[0] ) );
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_KEY, CmacKey );
+    LoRaMacJoinComputeMic( CmacMessage, CmacVectors[i].Size, CmacKey, &mic );
+    TEST_CHECK( mic == ( ( uint32_t )CmacVectors[i].Mac[3] << 24 | ( uint32_t )CmacVectors[i].Mac[2] << 16 |
+                         ( uint32_t )CmacVectors[i].Mac[1] << 8 | CmacVectors[i].Mac[0] ) );
+    LoRaMacCryptoClearKey( LORAMAC_CRYPTO_APP_KEY );
+  }
+}
+
+/*!
+ * @brief Random round trips: the encryption backend under test against the
+ *        byte oriented decryption
+ */
+static void TestAesRoundTrips( void )
+{
+  aes_context ctx;
+  uint8_t key[16];
+  uint8_t in[16];
+  uint8_t out[16];
+  uint32_t i;
+  uint32_t j;
+
+  srand( 1 );
+  for( i = 0; i < 10000; i++ )
+  {
+    for( j = 0; j < 16; j++ )
+    {
+      key[j] = rand( );
+      in[j] = rand( );
+    }
+    memset( &ctx, 0, sizeof( ctx ) );
+    aes_set_key( key, 16, &ctx );
+    aes_encrypt( in, out, &ctx );
+    TEST_CHECK( memcmp( in, out, 16 ) != 0 );
+    aes_decrypt( out, out, &ctx );
+    TEST_CHECK( memcmp( in, out, 16 ) == 0 );
+  }
+}
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( void )
+{
+  TestAesVectors( );
+  TestCmacVectors( );
+  TestAesRoundTrips( );
+
+#if defined( AES_ENC_TTABLE )
+  return TEST_END( "test_aes (T-table backend)" );
+#else
+  return TEST_END( "test_aes (byte backend)" );
+#endif
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,849 @@
+/**
+ ******************************************************************************
+ * @file    test_binmode.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the binary mode of AT_Slave: the handoff from the text
+ *          commands as the host sends it, the COBS and CRC16 coding, the TLVs
+ *          of the frames and the capture of the AT command output, through
+ *          command.c, binmode.c and vcom.c on fake LL drivers
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_test.h"
+#include "test_vcom.h"
+#include "at.h"
+#include "lora.h"
+#include "binmode.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Chars written by the rx DMA between two CMD_Process( ) */
+#define TEST_RX_CHUNK                   128
+
+/* Chars printed by AT+VER=?: up to past the TEXT TLV of a response */
+#define TEST_TEXT_SIZE                  300
+
+/* Largest TLV value */
+#define TEST_TLV_SIZE                   255
+
+/* Wire bytes of a frame, as BIN_COBS_MAX_SIZE of the host: the COBS frame
+   between two 0x00 */
+#define TEST_WIRE_SIZE                  ( BIN_FRAME_SIZE + ( BIN_FRAME_SIZE / 254 ) + 3 )
+
+/* Private macro -------------------------------------------------------------*/
+
+/* a handler of the command table the tests do not run */
+#define TEST_HANDLER( name ) \
+  ATEerror_t name( const char *param ) { return AT_OK; }
+
+/* Private variables ---------------------------------------------------------*/
+
+/* text AT+VER=? prints, by chunks of TestChunk chars */
+static char TestText[TEST_TEXT_SIZE + 1];
+static uint16_t TestChunk = 1;
+
+/* payload handed to LORA_send */
+static uint8_t TestSent[TEST_TLV_SIZE];
+static int TestSentSize = -1;
+static uint8_t TestSentPort = 0;
+static LoraConfirm_t TestSentConfirmed = LORAWAN_UNCONFIRMED_MSG;
+
+/* calls of LORA_Join */
+static uint32_t TestJoins = 0;
+
+/* frame the modem sent, decoded */
+static uint8_t TestRx[TEST_WIRE_SIZE];
+
+/* Private functions ---------------------------------------------------------*/
+
+/* utilities.c builds with the End_Node headers, not with the AT_Slave ones */
+void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+  memcpy( dst, src, size );
+}
+
+/* Handlers of the command table ---------------------------------------------*/
+
+TEST_HANDLER( at_return_error )
+TEST_HANDLER( at_reset )
+TEST_HANDLER( at_DevEUI_get )
+TEST_HANDLER( at_DevAddr_get )
+TEST_HANDLER( at_DevAddr_set )
+TEST_HANDLER( at_AppKey_get )
+TEST_HANDLER( at_AppKey_set )
+TEST_HANDLER( at_NwkSKey_get )
+TEST_HANDLER( at_NwkSKey_set )
+TEST_HANDLER( at_AppSKey_get )
+TEST_HANDLER( at_AppSKey_set )
+TEST_HANDLER( at_AppEUI_get )
+TEST_HANDLER( at_AppEUI_set )
+TEST_HANDLER( at_ADR_get )
+TEST_HANDLER( at_ADR_set )
+TEST_HANDLER( at_TransmitPower_get )
+TEST_HANDLER( at_TransmitPower_set )
+TEST_HANDLER( at_DataRate_get )
+TEST_HANDLER( at_DataRate_set )
+TEST_HANDLER( at_DutyCycle_get )
+TEST_HANDLER( at_DutyCycle_set )
+TEST_HANDLER( at_PublicNetwork_get )
+TEST_HANDLER( at_PublicNetwork_set )
+TEST_HANDLER( at_Rx2Frequency_get )
+TEST_HANDLER( at_Rx2Frequency_set )
+TEST_HANDLER( at_Rx2DataRate_get )
+TEST_HANDLER( at_Rx2DataRate_set )
+TEST_HANDLER( at_Rx1Delay_get )
+TEST_HANDLER( at_Rx1Delay_set )
+TEST_HANDLER( at_Rx2Delay_get )
+TEST_HANDLER( at_Rx2Delay_set )
+TEST_HANDLER( at_JoinAcceptDelay1_get )
+TEST_HANDLER( at_JoinAcceptDelay1_set )
+TEST_HANDLER( at_JoinAcceptDelay2_get )
+TEST_HANDLER( at_JoinAcceptDelay2_set )
+TEST_HANDLER( at_NetworkJoinMode_get )
+TEST_HANDLER( at_NetworkJoinMode_set )
+TEST_HANDLER( at_NetworkID_get )
+TEST_HANDLER( at_NetworkID_set )
+TEST_HANDLER( at_UplinkCounter_get )
+TEST_HANDLER( at_UplinkCounter_set )
+TEST_HANDLER( at_DownlinkCounter_get )
+TEST_HANDLER( at_DownlinkCounter_set )
+TEST_HANDLER( at_DeviceClass_get )
+TEST_HANDLER( at_DeviceClass_set )
+TEST_HANDLER( at_Join )
+TEST_HANDLER( at_NetworkJoinStatus )
+TEST_HANDLER( at_SendBinary )
+TEST_HANDLER( at_Send )
+TEST_HANDLER( at_ReceiveBinary )
+TEST_HANDLER( at_Receive )
+TEST_HANDLER( at_ack_get )
+TEST_HANDLER( at_ack_set )
+TEST_HANDLER( at_isack_get )
+TEST_HANDLER( at_snr_get )
+TEST_HANDLER( at_rssi_get )
+TEST_HANDLER( at_bat_get )
+TEST_HANDLER( at_test_rxTone )
+TEST_HANDLER( at_test_txTone )
+TEST_HANDLER( at_test_txlora )
+TEST_HANDLER( at_test_rxlora )
+TEST_HANDLER( at_test_get_lora_config )
+TEST_HANDLER( at_test_set_lora_config )
+TEST_HANDLER( at_test_stop )
+TEST_HANDLER( at_Certif )
+TEST_HANDLER( at_CsProfiler_get )
+TEST_HANDLER( at_CsProfiler_set )
+TEST_HANDLER( at_CsProfiler_run )
+
+/* The AT_Slave command parser and binary mode -------------------------------*/
+
+#include COMMAND_SOURCE
+#include BINMODE_SOURCE
+
+ATEerror_t at_BinMode( const char *param )
+{
+  BIN_Enter( );
+  return AT_OK;
+}
+
+ATEerror_t at_version_get( const char *param )
+{
+  char chunk[TEST_TEXT_SIZE + 1];
+  size_t i;
+  size_t n;
+
+  for( i = 0; i < strlen( TestText ); i += n )
+  {
+    n = strlen( &TestText[i] );
+    n = ( n > TestChunk ) ? TestChunk : n;
+    memcpy( chunk, &TestText[i], n );
+    chunk[n] = '\0';
+    AT_PRINTF( "%s", chunk );
+  }
+  return AT_OK;
+}
+
+/* Fake LoRa layer -----------------------------------------------------------*/
+
+LoraErrorStatus LORA_send( lora_AppData_t *AppData, LoraConfirm_t IsTxConfirmed )
+{
+  memcpy( TestSent, AppData->Buff, AppData->BuffSize );
+  TestSentSize = AppData->BuffSize;
+  TestSentPort = AppData->Port;
+  TestSentConfirmed = IsTxConfirmed;
+  return LORA_SUCCESS;
+}
+
+void LORA_Join( void )
+{
+  TestJoins++;
+}
+
+LoraConfirm_t lora_config_reqack_get( void )
+{
+  return LORAWAN_UNCONFIRMED_MSG;
+}
+
+/* Reference frame coding ----------------------------------------------------*/
+
+/*!
+ * @brief CRC16-CCITT, poly 0x1021, init 0xFFFF, one bit at a time
+ */
+static uint16_t TestCrc16( const uint8_t *buf, uint16_t size )
+{
+  uint16_t crc = 0xFFFF;
+  uint8_t bit;
+
+  while( size-- > 0 )
+  {
+    crc ^= *buf++ << 8;
+    for( bit = 0; bit < 8; bit++ )
+    {
+      crc = ( crc & 0x8000 ) ? ( ( crc << 1 ) ^ 0x1021 ) : ( crc << 1 );
+    }
+  }
+  return crc;
+}
+
+/*!
+ * @brief COBS encoding, run by run: the data ends with a phantom zero, a
+ *        block is a run of non zero bytes and the zero after it, or 254
+ *        non zero bytes
+ */
+static uint16_t TestCobsEncode( const uint8_t *from, uint16_t size, uint8_t *to )
+{
+  uint16_t ir = 0;
+  uint16_t iw = 0;
+  uint16_t run;
+
+  do
+  {
+    for( run = 0; ( ( ir + run ) < size ) && ( from[ir + run] != 0 ) && ( run < 254 ); run++ )
+    {
+    }
+    to[iw++] = run + 1;
+    memcpy( &to[iw], &from[ir], run );
+    iw += run;
+    ir += run;
+    if( run < 254 )
+    {
+      ir++;
+    }
+  } while( ir <= size );
+  return iw;
+}
+
+/*!
+ * @brief COBS decoding to another buffer
+ * @retval The size of the decoded buffer, -1 if not valid or with a zero
+ */
+static int TestCobsDecode( const uint8_t *from, uint16_t size, uint8_t *to )
+{
+  uint16_t ir = 0;
+  int iw = 0;
+  uint8_t code;
+  uint8_t i;
+
+  while( ir < size )
+  {
+    code = from[ir++];
+    if( ( code == 0 ) || ( ( ir + code - 1 ) > size ) )
+    {
+      return -1;
+    }
+    for( i = 1; i < code; i++ )
+    {
+      if( from[ir] == 0 )
+      {
+        return -1;
+      }
+      to[iw++] = from[ir++];
+    }
+    if( ( code != 0xFF ) && ( ir < size ) )
+    {
+      to[iw++] = 0;
+    }
+  }
+  return iw;
+}
+
+/*!
+ * @brief The wire bytes of a command frame, as at_cmd_bin_send sends them:
+ *        a 0x00, the frame with its CRC16 COBS encoded, a 0x00
+ * @retval The count of wire bytes
+ */
+static uint16_t TestWire( uint8_t id, uint8_t seq, const uint8_t *tlv, uint16_t size, uint8_t *wire )
+{
+  uint8_t frame[TEST_WIRE_SIZE];
+  uint16_t crc;
+  uint16_t n;
+
+  frame[0] = id;
+  frame[1] = seq;
+  memcpy( &frame[2], tlv, size );
+  crc = TestCrc16( frame, size + 2 );
+  frame[size + 2] = crc >> 8;
+  frame[size + 3] = crc & 0xFF;
+
+  wire[0] = 0;
+  n = TestCobsEncode( frame, size + 4, &wire[1] );
+  wire[n + 1] = 0;
+  return n + 2;
+}
+
+/* The virtual COM port link -------------------------------------------------*/
+
+/*!
+ * @brief Sends bytes to the modem as the host does, CMD_Process( ) run as
+ *        the rx DMA writes them, then collects what the modem sent back
+ */
+static void TestInput( const uint8_t *buf, uint16_t size )
+{
+  uint16_t chunk;
+
+  TestStart( 0 );
+  while( size > 0 )
+  {
+    chunk = ( size > TEST_RX_CHUNK ) ? TEST_RX_CHUNK : size;
+    TestReceive( buf, chunk );
+    CMD_Process( );
+    buf += chunk;
+    size -= chunk;
+  }
+  TestDrain( );
+}
+
+/*!
+ * @brief Checks the output starts with the given text
+ */
+static bool TestStartsWith( const char *text )
+{
+  return ( TestOutputSize >= strlen( text ) ) && ( memcmp( TestOutput, text, strlen( text ) ) == 0 );
+}
+
+/*!
+ * @brief Decodes the response frame the modem sent after the given count of
+ *        text chars, and checks it: one frame, its CRC16, Id and Seq
+ * @retval The size of its TLVs, from TestRx[2], -1 if no valid response
+ */
+static int TestResponse( uint16_t skip, uint8_t seq )
+{
+  int size;
+
+  if( ( TestOutputSize <= skip ) || ( TestOutput[TestOutputSize - 1] != 0 ) )
+  {
+    return -1;
+  }
+  size = TestCobsDecode( ( const uint8_t * )&TestOutput[skip], TestOutputSize - skip - 1, TestRx );
+  if( ( size < BIN_FRAME_MIN ) || ( size > BIN_FRAME_SIZE ) )
+  {
+    return -1;
+  }
+  size -= 2;
+  if( TestCrc16( TestRx, size ) != ( ( TestRx[size] << 8 ) | TestRx[size + 1] ) )
+  {
+    return -1;
+  }
+  if( ( TestRx[0] != BIN_ID_RESPONSE ) || ( TestRx[1] != seq ) )
+  {
+    return -1;
+  }
+  return size - 2;
+}
+
+/*!
+ * @brief Looks a TLV up in the response, all its TLVs well formed
+ * @retval The TLV value, NULL if not found
+ */
+static const uint8_t *TestTlv( int size, uint8_t type, uint8_t *len )
+{
+  const uint8_t *tlv = &TestRx[2];
+  const uint8_t *value = NULL;
+
+  while( size >= 2 )
+  {
+    TEST_CHECK( ( 2 + tlv[1] ) <= size );
+    if( ( value == NULL ) && ( tlv[0] == type ) )
+    {
+      *len = tlv[1];
+      value = &tlv[2];
+    }
+    size -= 2 + tlv[1];
+    tlv += 2 + tlv[1];
+  }
+  TEST_CHECK( size == 0 );
+  return value;
+}
+
+/*!
+ * @brief The status of the response
+ * @retval The status, AT_MAX if the response is not valid
+ */
+static uint8_t TestStatus( uint16_t skip, uint8_t seq )
+{
+  const uint8_t *status;
+  uint8_t len;
+  int size;
+
+  size = TestResponse( skip, seq );
+  if( size < 0 )
+  {
+    return AT_MAX;
+  }
+  status = TestTlv( size, BIN_TLV_STATUS, &len );
+  return ( ( status != NULL ) && ( len == 1 ) ) ? *status : AT_MAX;
+}
+
+/*!
+ * @brief Sends a command frame, the modem answers it alone
+ * @retval The status of the response, AT_MAX if the response is not valid
+ */
+static uint8_t TestCommand( uint8_t id, uint8_t seq, const uint8_t *tlv, uint16_t size )
+{
+  uint8_t wire[TEST_WIRE_SIZE];
+
+  TestInput( wire, TestWire( id, seq, tlv, size, wire ) );
+  return TestStatus( 0, seq );
+}
+
+/*!
+ * @brief Sends a text AT command in an AT frame, as Modem_AT_Cmd sends it
+ */
+static uint8_t TestAt( uint8_t seq, const char *line )
+{
+  uint8_t tlv[2 + TEST_TLV_SIZE];
+
+  tlv[0] = BIN_TLV_TEXT;
+  tlv[1] = strlen( line );
+  memcpy( &tlv[2], line, tlv[1] );
+  return TestCommand( BIN_ID_AT, seq, tlv, 2 + tlv[1] );
+}
+
+/* Tests ---------------------------------------------------------------------*/
+
+/*!
+ * @brief The nibble table against the bitwise CRC16, on every byte and on
+ *        every frame size
+ */
+static void TestCrc( const uint8_t *data )
+{
+  uint8_t byte;
+  uint16_t size;
+  uint16_t i;
+
+  TEST_CHECK( crc16( ( const uint8_t * )"123456789", 9 ) == 0x29B1 );
+  TEST_CHECK( TestCrc16( ( const uint8_t * )"123456789", 9 ) == 0x29B1 );
+
+  for( i = 0; i < 256; i++ )
+  {
+    byte = i;
+    TEST_CHECK( crc16( &byte, 1 ) == TestCrc16( &byte, 1 ) );
+  }
+  for( size = 0; size <= BIN_FRAME_SIZE; size++ )
+  {
+    TEST_CHECK( crc16( data, size ) == TestCrc16( data, size ) );
+  }
+}
+
+/*!
+ * @brief Zero free runs around the 254 byte COBS block, between zeros, up to
+ *        the largest frame; truncated and zero holding encodings rejected
+ */
+static void TestCobs( const uint8_t *data )
+{
+  static const uint16_t runs[] = { 0, 1, 253, 254, 255, BIN_FRAME_SIZE - 2, BIN_FRAME_SIZE };
+  uint8_t frame[BIN_COBS_SIZE];
+  uint8_t ref[BIN_COBS_SIZE + 8];
+  uint8_t cobs[BIN_COBS_SIZE + 8];
+  uint16_t run;
+  uint16_t size;
+  uint16_t n;
+  uint16_t i;
+  int zeros;
+
+  for( i = 0; i < ( sizeof( runs ) / sizeof( runs[0] ) ); i++ )
+  {
+    for( zeros = 0; zeros < 4; zeros++ )
+    {
+      /* the run, after a zero, before a zero */
+      run = runs[i];
+      if( ( run + ( zeros & 1 ) + ( zeros >> 1 ) ) > BIN_FRAME_SIZE )
+      {
+        continue;
+      }
+      size = 0;
+      if( ( zeros & 1 ) != 0 )
+      {
+        frame[size++] = 0;
+      }
+      memset( &frame[size], 0xA5, run );
+      size += run;
+      if( ( zeros & 2 ) != 0 )
+      {
+        frame[size++] = 0;
+      }
+
+      n = TestCobsEncode( frame, size, ref );
+      memset( cobs, 0, sizeof( cobs ) );
+      TEST_CHECK( cobs_encode( frame, size, cobs ) == n );
+      TEST_CHECK( memcmp( cobs, ref, n ) == 0 );
+      TEST_CHECK( memchr( cobs, 0, n ) == NULL );
+      TEST_CHECK( n <= ( BIN_COBS_SIZE - 1 ) );
+      TEST_CHECK( cobs_decode( cobs, n ) == size );
+      TEST_CHECK( memcmp( cobs, frame, size ) == 0 );
+    }
+  }
+
+  /* any frame, with its zeros */
+  for( size = 0; size <= BIN_FRAME_SIZE; size++ )
+  {
+    n = TestCobsEncode( data, size, ref );
+    TEST_CHECK( cobs_encode( data, size, cobs ) == n );
+    TEST_CHECK( memcmp( cobs, ref, n ) == 0 );
+    TEST_CHECK( ( cobs_decode( cobs, n ) == size ) && ( memcmp( cobs, data, size ) == 0 ) );
+  }
+
+  /* the last block cut short */
+  memset( frame, 0x5A, 253 );
+  n = TestCobsEncode( frame, 253, ref );
+  TEST_CHECK( n == 254 );
+  for( size = 1; size < n; size++ )
+  {
+    memcpy( cobs, ref, n );
+    TEST_CHECK( cobs_decode( cobs, size ) == -1 );
+  }
+  n = TestCobsEncode( frame, 254, ref );
+  TEST_CHECK( n == 256 );
+  for( size = 1; size < 255; size++ )
+  {
+    memcpy( cobs, ref, n );
+    TEST_CHECK( cobs_decode( cobs, size ) == -1 );
+  }
+}
+
+/*!
+ * @brief TLVs found in well formed TLVs only: a header or a value cut
+ *        short, a length past the end hide the TLVs after them
+ */
+static void TestFindTlv( void )
+{
+  uint8_t tlv[] =
+  {
+    BIN_TLV_PORT, 1, 2,
+    BIN_TLV_TEXT, 0,
+    BIN_TLV_DATA, 3, 0x00, 0x01, 0x02,
+    BIN_TLV_ACK, 1,
+  };
+  uint8_t len;
+  uint16_t size;
+
+  size = sizeof( tlv ) - 2;
+  len = 0xFF;
+  TEST_CHECK( ( find_tlv( tlv, size, BIN_TLV_PORT, &len ) == &tlv[2] ) && ( len == 1 ) );
+  len = 0xFF;
+  TEST_CHECK( ( find_tlv( tlv, size, BIN_TLV_TEXT, &len ) == &tlv[5] ) && ( len == 0 ) );
+  len = 0xFF;
+  TEST_CHECK( ( find_tlv( tlv, size, BIN_TLV_DATA, &len ) == &tlv[7] ) && ( len == 3 ) );
+  TEST_CHECK( find_tlv( tlv, size, BIN_TLV_SNR, &len ) == NULL );
+  TEST_CHECK( find_tlv( tlv, 0, BIN_TLV_PORT, &len ) == NULL );
+
+  /* a TLV header alone, then the value of the last TLV cut short */
+  TEST_CHECK( find_tlv( tlv, sizeof( tlv ), BIN_TLV_ACK, &len ) == NULL );
+  TEST_CHECK( find_tlv( tlv, sizeof( tlv ) - 1, BIN_TLV_ACK, &len ) == NULL );
+  for( size = 6; size < 10; size++ )
+  {
+    TEST_CHECK( find_tlv( tlv, size, BIN_TLV_DATA, &len ) == NULL );
+  }
+  TEST_CHECK( find_tlv( tlv, 2, BIN_TLV_PORT, &len ) == NULL );
+
+  /* a length past the end hides what follows */
+  tlv[1] = 200;
+  TEST_CHECK( find_tlv( tlv, sizeof( tlv ) - 2, BIN_TLV_PORT, &len ) == NULL );
+  TEST_CHECK( find_tlv( tlv, sizeof( tlv ) - 2, BIN_TLV_DATA, &len ) == NULL );
+  tlv[1] = 1;
+
+  /* a length that ends inside the next TLV shifts the walk */
+  tlv[4] = 2;
+  TEST_CHECK( find_tlv( tlv, sizeof( tlv ) - 2, BIN_TLV_DATA, &len ) == NULL );
+  tlv[4] = 0;
+}
+
+/*!
+ * @brief AT+BINMODE as Modem_AT_Cmd sends it, "AT+BINMODE\r\n", then the
+ *        first frame: with its status awaited or in the same write, and
+ *        the frame without the leading 0x00 dropped
+ */
+static void TestHandoff( void )
+{
+  static const char binMode[] = "AT+BINMODE\r\n";
+  const char *ok = ATError_description[AT_OK];
+  uint8_t wire[sizeof( binMode ) + TEST_WIRE_SIZE];
+  uint8_t frame[TEST_WIRE_SIZE];
+  uint8_t exitTlv[1];
+  uint16_t n;
+  uint16_t size;
+
+  /* the status awaited before the first frame */
+  TestInput( ( const uint8_t * )binMode, strlen( binMode ) );
+  TEST_CHECK( ( TestOutputSize == strlen( ok ) ) && TestStartsWith( ok ) );
+  TEST_CHECK( BIN_IsActive( ) );
+  TEST_CHECK( TestAt( 1, "AT" ) == AT_OK );
+  TEST_CHECK( TestAt( 2, "AT+VER=?" ) == AT_OK );
+
+  /* back to the text commands */
+  TEST_CHECK( TestCommand( BIN_ID_EXIT, 3, exitTlv, 0 ) == AT_OK );
+  TEST_CHECK( !BIN_IsActive( ) );
+  TestInput( ( const uint8_t * )"AT\r\n", 4 );
+  TEST_CHECK( ( TestOutputSize == strlen( ok ) ) && TestStartsWith( ok ) );
+
+  /* the first frame in the same write as the command */
+  memcpy( wire, binMode, strlen( binMode ) );
+  n = strlen( binMode );
+  n += TestWire( BIN_ID_EXIT, 4, exitTlv, 0, &wire[n] );
+  TestInput( wire, n );
+  TEST_CHECK( TestStartsWith( ok ) && ( TestStatus( strlen( ok ), 4 ) == AT_OK ) );
+  TEST_CHECK( !BIN_IsActive( ) );
+
+  /* a frame without the leading 0x00 is what follows the command: dropped,
+     even after a <cr> alone */
+  n = strlen( binMode ) - 1;
+  memcpy( wire, binMode, n );
+  size = TestWire( BIN_ID_EXIT, 5, exitTlv, 0, frame ) - 1;
+  memcpy( &wire[n], &frame[1], size );
+  n += size;
+  TestInput( wire, n );
+  TEST_CHECK( ( TestOutputSize == strlen( ok ) ) && TestStartsWith( ok ) );
+  TEST_CHECK( BIN_IsActive( ) );
+  TEST_CHECK( TestAt( 6, "AT" ) == AT_OK );
+}
+
+/*!
+ * @brief The frames the modem drops: bad CRC16, bad COBS, too short, too
+ *        long; the next frame is answered
+ */
+static void TestBadFrames( void )
+{
+  uint8_t wire[TEST_WIRE_SIZE + 8];
+  uint8_t tlv[2 + 255 + 2 + 8] = { BIN_TLV_TEXT, 0 };
+  uint32_t joins;
+  uint16_t n;
+  uint8_t k;
+
+  n = TestWire( BIN_ID_AT, 7, tlv, 2, wire );
+  wire[3] ^= 0x10;
+  TestInput( wire, n );
+  TEST_CHECK( TestOutputSize == 0 );
+
+  n = TestWire( BIN_ID_AT, 7, tlv, 2, wire );
+  wire[1] += 1;
+  TestInput( wire, n );
+  TEST_CHECK( TestOutputSize == 0 );
+
+  /* Id and Seq, no CRC16 */
+  wire[0] = 0;
+  n = 1 + TestCobsEncode( ( const uint8_t * )"\x01\x07", 2, &wire[1] );
+  wire[n++] = 0;
+  TestInput( wire, n );
+  TEST_CHECK( TestOutputSize == 0 );
+
+  /* a JOIN frame which fills the receive buffer, its TLVs ignored: answered,
+     then with one more byte before its 0x00: dropped */
+  memset( tlv, 0x55, sizeof( tlv ) );
+  tlv[1] = 255;
+  for( k = 0, n = 0; n < ( 2 + sizeof( RxFrame ) ); k++ )
+  {
+    tlv[2 + 255 + 1] = k;
+    n = TestWire( BIN_ID_JOIN, 9, tlv, 2 + 255 + 2 + k, wire );
+  }
+  TEST_CHECK( n == ( 2 + sizeof( RxFrame ) ) );
+  joins = TestJoins;
+  TestInput( wire, n );
+  TEST_CHECK( ( TestStatus( 0, 9 ) == AT_OK ) && ( TestJoins == ( joins + 1 ) ) );
+  wire[n - 1] = 0x55;
+  wire[n++] = 0;
+  TestInput( wire, n );
+  TEST_CHECK( ( TestOutputSize == 0 ) && ( TestJoins == ( joins + 1 ) ) );
+
+  tlv[1] = 0;
+  TEST_CHECK( TestAt( 8, "AT" ) == AT_OK );
+}
+
+/*!
+ * @brief The text of AT+VER=? of every size up to past the TEXT TLV, printed
+ *        at once or by chunks: captured up to 255 chars, the STATUS TLV
+ *        after it, the response within BIN_FRAME_SIZE
+ */
+static void TestCapture( void )
+{
+  static const uint16_t chunks[] = { 1, 7, 128, TEST_TEXT_SIZE };
+  const uint8_t *text;
+  uint8_t len;
+  uint16_t size;
+  uint16_t i;
+  uint16_t k;
+  int n;
+
+  for( k = 0; k < ( sizeof( chunks ) / sizeof( chunks[0] ) ); k++ )
+  {
+    TestChunk = chunks[k];
+    for( size = 0; size <= TEST_TEXT_SIZE; size++ )
+    {
+      for( i = 0; i < size; i++ )
+      {
+        TestText[i] = 'A' + ( ( i + k ) % 26 );
+      }
+      TestText[size] = '\0';
+
+      TEST_CHECK( TestAt( size, "AT+VER=?" ) == AT_OK );
+      n = TestResponse( 0, size );
+      text = TestTlv( n, BIN_TLV_TEXT, &len );
+      if( size == 0 )
+      {
+        TEST_CHECK( text == NULL );
+        TEST_CHECK( n == 3 );
+      }
+      else
+      {
+        TEST_CHECK( ( text != NULL ) && ( len == ( ( size > 255 ) ? 255 : size ) ) );
+        TEST_CHECK( ( text != NULL ) && ( memcmp( text, TestText, len ) == 0 ) );
+        TEST_CHECK( n == ( 2 + len + 3 ) );
+      }
+    }
+  }
+  TestText[0] = '\0';
+}
+
+/*!
+ * @brief Payloads from none up to the largest frame; a TLV cut short or
+ *        missing fails the frame with AT_PARAM_ERROR
+ */
+static void TestSend( const uint8_t *data )
+{
+  uint8_t tlv[3 + 3 + 2 + TEST_TLV_SIZE];
+  uint32_t joins;
+  uint16_t size;
+  uint16_t cut;
+
+  tlv[0] = BIN_TLV_PORT;
+  tlv[1] = 1;
+  tlv[2] = 2;
+  tlv[3] = BIN_TLV_CONFIRMED;
+  tlv[4] = 1;
+  tlv[5] = 1;
+  tlv[6] = BIN_TLV_DATA;
+
+  for( size = 0; ( 2 + 8 + size + 2 ) <= BIN_FRAME_SIZE; size++ )
+  {
+    tlv[7] = size;
+    memcpy( &tlv[8], data, size );
+    TestSentSize = -1;
+    TEST_CHECK( TestCommand( BIN_ID_SEND, size, tlv, 8 + size ) == AT_OK );
+    TEST_CHECK( ( TestSentSize == size ) && ( TestSentPort == 2 ) );
+    TEST_CHECK( memcmp( TestSent, data, size ) == 0 );
+    TEST_CHECK( TestSentConfirmed == LORAWAN_CONFIRMED_MSG );
+
+    /* without the PORT TLV */
+    TestSentSize = -1;
+    TEST_CHECK( TestCommand( BIN_ID_SEND, size, &tlv[3], 5 + size ) == AT_PARAM_ERROR );
+    TEST_CHECK( TestSentSize == -1 );
+  }
+
+  /* the DATA TLV cut short, by its header or by its value */
+  tlv[7] = 32;
+  for( cut = 1; cut <= ( 2 + 32 ); cut++ )
+  {
+    TestSentSize = -1;
+    TEST_CHECK( TestCommand( BIN_ID_SEND, cut, tlv, 8 + 32 - cut ) == AT_PARAM_ERROR );
+    TEST_CHECK( TestSentSize == -1 );
+  }
+
+  /* the PORT TLV of 2 bytes, then of none */
+  tlv[1] = 2;
+  TEST_CHECK( TestCommand( BIN_ID_SEND, 0, tlv, 8 + 32 ) == AT_PARAM_ERROR );
+  TEST_CHECK( TestSentSize == -1 );
+  tlv[1] = 0;
+  tlv[2] = BIN_TLV_CONFIRMED;
+  tlv[3] = 1;
+  tlv[4] = 0;
+  tlv[5] = BIN_TLV_DATA;
+  tlv[6] = 1;
+  tlv[7] = 0;
+  TEST_CHECK( TestCommand( BIN_ID_SEND, 0, tlv, 8 ) == AT_PARAM_ERROR );
+  TEST_CHECK( TestSentSize == -1 );
+
+  joins = TestJoins;
+  TEST_CHECK( TestCommand( BIN_ID_JOIN, 1, tlv, 0 ) == AT_OK );
+  TEST_CHECK( TestJoins == ( joins + 1 ) );
+  TEST_CHECK( TestCommand( 0x7F, 2, tlv, 0 ) == AT_ERROR );
+}
+
+int main( void )
+{
+  uint8_t data[BIN_COBS_SIZE];
+  uint16_t i;
+
+  srand( 1 );
+  for( i = 0; i < sizeof( data ); i++ )
+  {
+    data[i] = ( i % 5 ) ? rand( ) : 0;
+  }
+
+  /* the vcom context is left as it starts: its LL setup drives the fake
+     channels of the tx DMA */
+  sort_cmd( );
+
+  TestCrc( data );
+  TestCobs( data );
+  TestFindTlv( );
+  TestHandoff( );
+  TestBadFrames( );
+  TestCapture( );
+  TestSend( data );
+  TEST_CHECK( vcom_GetDropCount( ) == 0 );
+
+  return TEST_END( "test_binmode" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,414 @@
+/**
+ ******************************************************************************
+ * @file    test_command.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the AT_Slave command parser: every command
+ *          through CMD_Process, on recording handlers
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* the MCU layer of AT_Slave is replaced by the fakes below */
+#define __HW_H__
+
+typedef enum
+{
+  RESET = 0,
+  SET = !RESET
+} FlagStatus;
+
+#include "vcom.h"
+#include "at.h"
+#include "binmode.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef ATEerror_t ( *TestHandler_t )( const char *param );
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_OUTPUT_SIZE                4096
+
+/* the characters a command may be extended with */
+#define TEST_CMD_CHARS                  "+ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+
+/* Private macro -------------------------------------------------------------*/
+
+/* a handler of the command table: records its call, returns TestStatus */
+#define TEST_HANDLER( name ) \
+  ATEerror_t name( const char *param ) { return TestCall( name, param ); }
+
+/* Private variables ---------------------------------------------------------*/
+
+/* characters of the virtual COM port, to CMD_Process */
+static const char *TestInput = "";
+
+/* text of vcom_Send */
+static char TestOutput[TEST_OUTPUT_SIZE];
+static size_t TestOutputSize = 0;
+
+/* last handler called, its parameter and the status it returns */
+static TestHandler_t TestHandler = NULL;
+static const char *TestParam = NULL;
+static uint32_t TestCalls = 0;
+static ATEerror_t TestStatus = AT_OK;
+
+/* Private functions ---------------------------------------------------------*/
+
+static ATEerror_t TestCall( TestHandler_t handler, const char *param )
+{
+  TestHandler = handler;
+  TestParam = param;
+  TestCalls++;
+  return TestStatus;
+}
+
+/* Fake virtual COM port and binary mode -------------------------------------*/
+
+void vcom_Init( void )
+{
+}
+
+void vcom_ReceiveInit( void )
+{
+}
+
+void vcom_Send( const char *format, ... )
+{
+  va_list args;
+  int size;
+
+  va_start( args, format );
+  size = vsnprintf( &TestOutput[TestOutputSize], sizeof( TestOutput ) - TestOutputSize, format, args );
+  va_end( args );
+  if( size > 0 )
+  {
+    TestOutputSize += size;
+    if( TestOutputSize >= sizeof( TestOutput ) )
+    {
+      TestOutputSize = sizeof( TestOutput ) - 1;
+    }
+  }
+}
+
+FlagStatus IsNewCharReceived( void )
+{
+  return ( *TestInput != '\0' ) ? SET : RESET;
+}
+
+uint8_t GetNewChar( void )
+{
+  return ( uint8_t )*TestInput++;
+}
+
+bool BIN_IsActive( void )
+{
+  return false;
+}
+
+void BIN_Receive( uint8_t c )
+{
+}
+
+/* Handlers of the command table ---------------------------------------------*/
+
+TEST_HANDLER( at_return_error )
+TEST_HANDLER( at_reset )
+TEST_HANDLER( at_DevEUI_get )
+TEST_HANDLER( at_DevAddr_get )
+TEST_HANDLER( at_DevAddr_set )
+TEST_HANDLER( at_AppKey_get )
+TEST_HANDLER( at_AppKey_set )
+TEST_HANDLER( at_NwkSKey_get )
+TEST_HANDLER( at_NwkSKey_set )
+TEST_HANDLER( at_AppSKey_get )
+TEST_HANDLER( at_AppSKey_set )
+TEST_HANDLER( at_AppEUI_get )
+TEST_HANDLER( at_AppEUI_set )
+TEST_HANDLER( at_ADR_get )
+TEST_HANDLER( at_ADR_set )
+TEST_HANDLER( at_TransmitPower_get )
+TEST_HANDLER( at_TransmitPower_set )
+TEST_HANDLER( at_DataRate_get )
+TEST_HANDLER( at_DataRate_set )
+TEST_HANDLER( at_DutyCycle_get )
+TEST_HANDLER( at_DutyCycle_set )
+TEST_HANDLER( at_PublicNetwork_get )
+TEST_HANDLER( at_PublicNetwork_set )
+TEST_HANDLER( at_Rx2Frequency_get )
+TEST_HANDLER( at_Rx2Frequency_set )
+TEST_HANDLER( at_Rx2DataRate_get )
+TEST_HANDLER( at_Rx2DataRate_set )
+TEST_HANDLER( at_Rx1Delay_get )
+TEST_HANDLER( at_Rx1Delay_set )
+TEST_HANDLER( at_Rx2Delay_get )
+TEST_HANDLER( at_Rx2Delay_set )
+TEST_HANDLER( at_JoinAcceptDelay1_get )
+TEST_HANDLER( at_JoinAcceptDelay1_set )
+TEST_HANDLER( at_JoinAcceptDelay2_get )
+TEST_HANDLER( at_JoinAcceptDelay2_set )
+TEST_HANDLER( at_NetworkJoinMode_get )
+TEST_HANDLER( at_NetworkJoinMode_set )
+TEST_HANDLER( at_NetworkID_get )
+TEST_HANDLER( at_NetworkID_set )
+TEST_HANDLER( at_UplinkCounter_get )
+TEST_HANDLER( at_UplinkCounter_set )
+TEST_HANDLER( at_DownlinkCounter_get )
+TEST_HANDLER( at_DownlinkCounter_set )
+TEST_HANDLER( at_DeviceClass_get )
+TEST_HANDLER( at_DeviceClass_set )
+TEST_HANDLER( at_Join )
+TEST_HANDLER( at_NetworkJoinStatus )
+TEST_HANDLER( at_SendBinary )
+TEST_HANDLER( at_Send )
+TEST_HANDLER( at_ReceiveBinary )
+TEST_HANDLER( at_Receive )
+TEST_HANDLER( at_version_get )
+TEST_HANDLER( at_ack_get )
+TEST_HANDLER( at_ack_set )
+TEST_HANDLER( at_isack_get )
+TEST_HANDLER( at_snr_get )
+TEST_HANDLER( at_rssi_get )
+TEST_HANDLER( at_bat_get )
+TEST_HANDLER( at_test_rxTone )
+TEST_HANDLER( at_test_txTone )
+TEST_HANDLER( at_test_txlora )
+TEST_HANDLER( at_test_rxlora )
+TEST_HANDLER( at_test_get_lora_config )
+TEST_HANDLER( at_test_set_lora_config )
+TEST_HANDLER( at_test_stop )
+TEST_HANDLER( at_Certif )
+TEST_HANDLER( at_CsProfiler_get )
+TEST_HANDLER( at_CsProfiler_set )
+TEST_HANDLER( at_CsProfiler_run )
+TEST_HANDLER( at_BinMode )
+
+/* The AT_Slave command parser -----------------------------------------------*/
+
+#include COMMAND_SOURCE
+
+/* Tests ---------------------------------------------------------------------*/
+
+/*!
+ * @brief Sends a line to CMD_Process, as received on the virtual COM port
+ */
+static void TestLine( const char *line, ATEerror_t status )
+{
+  static char input[CMD_SIZE];
+
+  snprintf( input, sizeof( input ), "%s\r", line );
+  TestInput = input;
+  TestOutputSize = 0;
+  TestOutput[0] = '\0';
+  TestHandler = NULL;
+  TestParam = NULL;
+  TestCalls = 0;
+  TestStatus = status;
+
+  CMD_Process( );
+}
+
+/*!
+ * @brief Checks the line was rejected: no handler, AT_ERROR printed
+ */
+static bool TestRejected( const char *line )
+{
+  TestLine( line, AT_OK );
+  return ( TestCalls == 0 ) && ( strcmp( TestOutput, ATError_description[AT_ERROR] ) == 0 );
+}
+
+static bool TestIsCommand( const char *string )
+{
+  int i;
+
+  for( i = 0; i < AT_COMMAND_NB; i++ )
+  {
+    if( strcmp( ATCommand[i].string, string ) == 0 )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+ * @brief The index sorts every command once, by size then string
+ */
+static void TestIndex( void )
+{
+  bool seen[AT_COMMAND_NB] = { false };
+  int i;
+
+  for( i = 0; i < AT_COMMAND_NB; i++ )
+  {
+    TEST_CHECK( ATCommand[i].size_string == strlen( ATCommand[i].string ) );
+    TEST_CHECK( ATCommandIndex[i] < AT_COMMAND_NB );
+    seen[ATCommandIndex[i]] = true;
+    if( i > 0 )
+    {
+      TEST_CHECK( compare_cmd( &ATCommand[ATCommandIndex[i - 1]], ATCommand[ATCommandIndex[i]].string,
+                               ATCommand[ATCommandIndex[i]].size_string ) < 0 );
+    }
+  }
+  for( i = 0; i < AT_COMMAND_NB; i++ )
+  {
+    TEST_CHECK( seen[i] == true );
+  }
+}
+
+/*!
+ * @brief AT<cmd>, AT<cmd>=?, AT<cmd>=1 and AT<cmd>? of every command reach
+ *        their handler with their parameter, the status is printed
+ */
+static void TestCommands( void )
+{
+  static const ATEerror_t statuses[] = { AT_OK, AT_PARAM_ERROR, AT_BUSY_ERROR };
+  char line[64];
+  int i;
+
+  for( i = 0; i < AT_COMMAND_NB; i++ )
+  {
+    ATEerror_t status = statuses[i % ( sizeof( statuses ) / sizeof( statuses[0] ) )];
+
+    snprintf( line, sizeof( line ), "AT%s", ATCommand[i].string );
+    TestLine( line, status );
+    TEST_CHECK( ( TestCalls == 1 ) && ( TestHandler == ATCommand[i].run ) && ( strcmp( TestParam, "" ) == 0 ) );
+    TEST_CHECK( strcmp( TestOutput, ATError_description[status] ) == 0 );
+
+    snprintf( line, sizeof( line ), "AT%s=?", ATCommand[i].string );
+    TestLine( line, status );
+    TEST_CHECK( ( TestCalls == 1 ) && ( TestHandler == ATCommand[i].get ) && ( strcmp( TestParam, "?" ) == 0 ) );
+    TEST_CHECK( strcmp( TestOutput, ATError_description[status] ) == 0 );
+
+    snprintf( line, sizeof( line ), "AT%s=1", ATCommand[i].string );
+    TestLine( line, status );
+    TEST_CHECK( ( TestCalls == 1 ) && ( TestHandler == ATCommand[i].set ) && ( strcmp( TestParam, "1" ) == 0 ) );
+    TEST_CHECK( strcmp( TestOutput, ATError_description[status] ) == 0 );
+
+    /* the parameters are passed as received, up to the end of line */
+    snprintf( line, sizeof( line ), "AT%s=1,2:?", ATCommand[i].string );
+    TestLine( line, status );
+    TEST_CHECK( ( TestCalls == 1 ) && ( TestHandler == ATCommand[i].set ) && ( strcmp( TestParam, "1,2:?" ) == 0 ) );
+
+    snprintf( line, sizeof( line ), "AT%s?", ATCommand[i].string );
+    TestLine( line, status );
+    TEST_CHECK( TestCalls == 0 );
+    TEST_CHECK( strncmp( TestOutput, ATCommand[i].help_string, strlen( ATCommand[i].help_string ) ) == 0 );
+    TEST_CHECK( strcmp( &TestOutput[strlen( ATCommand[i].help_string )], ATError_description[AT_OK] ) == 0 );
+  }
+
+  TestLine( "AT", AT_BUSY_ERROR );
+  TEST_CHECK( ( TestCalls == 0 ) && ( strcmp( TestOutput, ATError_description[AT_OK] ) == 0 ) );
+  TestLine( "AT?", AT_BUSY_ERROR );
+  TEST_CHECK( ( TestCalls == 0 ) && ( strstr( TestOutput, ATCommand[AT_COMMAND_NB - 1].help_string ) != NULL ) );
+}
+
+/*!
+ * @brief A command is matched on its whole token: its prefixes and
+ *        extensions that are not commands themselves are rejected
+ */
+static void TestTokens( void )
+{
+  static const char *const rejected[] =
+  {
+    "AT+DRX", "AT+DRX=1", "AT+DRX=?", "AT+DRX?", "AT+SEN", "AT+SEN=1", "AT+SEN=?",
+    "AT+SENDBX=01", "AT+D", "AT+", "ATZZ", "AT+dr", "at+DR", "BT+DR", "A", "AT+DR+DR",
+  };
+  char line[64];
+  char token[32];
+  uint32_t count = 0;
+  int i;
+  int n;
+  const char *c;
+
+  for( i = 0; i < sizeof( rejected ) / sizeof( rejected[0] ); i++ )
+  {
+    TEST_CHECK( TestRejected( rejected[i] ) );
+  }
+
+  for( i = 0; i < AT_COMMAND_NB; i++ )
+  {
+    /* the proper prefixes */
+    for( n = 1; n < ATCommand[i].size_string; n++ )
+    {
+      snprintf( token, sizeof( token ), "%.*s", n, ATCommand[i].string );
+      if( TestIsCommand( token ) == false )
+      {
+        snprintf( line, sizeof( line ), "AT%s=1", token );
+        TEST_CHECK( TestRejected( line ) );
+        count++;
+      }
+    }
+    /* the extensions by one character */
+    for( c = TEST_CMD_CHARS; *c != '\0'; c++ )
+    {
+      snprintf( token, sizeof( token ), "%s%c", ATCommand[i].string, *c );
+      if( TestIsCommand( token ) == false )
+      {
+        snprintf( line, sizeof( line ), "AT%s", token );
+        TEST_CHECK( TestRejected( line ) );
+        snprintf( line, sizeof( line ), "AT%s=1", token );
+        TEST_CHECK( TestRejected( line ) );
+        count++;
+      }
+    }
+  }
+  printf( "%u commands, %u prefixes and extensions rejected\n", ( uint32_t )AT_COMMAND_NB, count );
+}
+
+int main( void )
+{
+  CMD_Init( );
+
+  TestIndex( );
+  TestCommands( );
+  TestTokens( );
+
+  return TEST_END( "test_command" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
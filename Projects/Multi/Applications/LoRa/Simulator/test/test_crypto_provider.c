@@ -0,0 +1,332 @@
+/**
+ ******************************************************************************
+ * @file    test_crypto_provider.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the LoRaMacCrypto provider contract: a mock provider
+ *          against the software provider
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "utilities.h"
+#include "aes.h"
+#include "LoRaMacCrypto.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * Calls received by the mock provider
+ */
+typedef struct
+{
+  uint32_t Init;
+  uint32_t Ecb;
+  uint32_t CbcMac;
+  uint32_t Ctr;
+} MockCalls_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Largest buffer handed to a provider: a 255 bytes frame */
+#define TEST_MAX_SIZE               256
+
+/* Private variables ---------------------------------------------------------*/
+
+static MockCalls_t MockCalls;
+
+/* Result of the mock Init, false as for an MCU without the AES peripheral */
+static bool MockPresent = true;
+
+/* Private functions ---------------------------------------------------------*/
+
+/*!
+ * The mock provider works as hw_aes.c drives the peripheral: the key is
+ * loaded on every call, the blocks go one at a time, the CTR counter is the
+ * last 32 bits word of the block and the last partial block is zero padded
+ */
+static void MockBlock( const uint8_t *key, const uint8_t *in, uint8_t *out )
+{
+  aes_context ctx;
+
+  memset( &ctx, 0, sizeof( ctx ) );
+  aes_set_key( key, 16, &ctx );
+  aes_encrypt( in, out, &ctx );
+}
+
+static bool MockInit( void )
+{
+  MockCalls.Init++;
+  return MockPresent;
+}
+
+static void MockEcb( const uint8_t *key, const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+  MockCalls.Ecb++;
+  while( nbBlocks-- > 0 )
+  {
+    MockBlock( key, in, out );
+    in += 16;
+    out += 16;
+  }
+}
+
+static void MockCbcMac( const uint8_t *key, const uint8_t *in, uint16_t nbBlocks, uint8_t *chain )
+{
+  uint8_t i;
+
+  MockCalls.CbcMac++;
+  while( nbBlocks-- > 0 )
+  {
+    for( i = 0; i < 16; i++ )
+    {
+      chain[i] ^= in[i];
+    }
+    MockBlock( key, chain, chain );
+    in += 16;
+  }
+}
+
+static void MockCtr( const uint8_t *key, const uint8_t *counterBlock, const uint8_t *in, uint16_t size, uint8_t *out )
+{
+  uint8_t counter[16];
+  uint8_t keystream[16];
+  uint8_t i;
+  uint8_t len;
+
+  MockCalls.Ctr++;
+  memcpy( counter, counterBlock, 16 );
+  while( size > 0 )
+  {
+    MockBlock( key, counter, keystream );
+    len = ( size < 16 ) ? size : 16;
+    for( i = 0; i < len; i++ )
+    {
+      out[i] = in[i] ^ keystream[i];
+    }
+    in += len;
+    out += len;
+    size -= len;
+
+    /* 32 bits big endian increment */
+    for( i = 15; ( i >= 12 ) && ( ++counter[i] == 0 ); i-- )
+    {
+    }
+  }
+}
+
+static const LoRaMacCryptoProvider_t MockProvider =
+{
+  MockInit,
+  MockEcb,
+  MockCbcMac,
+  MockCtr
+};
+
+static void RandomFill( uint8_t *buffer, uint16_t size )
+{
+  while( size-- > 0 )
+  {
+    *buffer++ = rand( );
+  }
+}
+
+/*!
+ * @brief The provider contract: the mock gives the results of the software
+ *        provider, for unaligned and in place buffers
+ */
+static void TestProviderContract( void )
+{
+  const LoRaMacCryptoProvider_t *soft = &LoRaMacCryptoSoftProvider;
+  uint8_t key[16];
+  uint8_t in[TEST_MAX_SIZE + 4];
+  uint8_t outSoft[TEST_MAX_SIZE + 4];
+  uint8_t outMock[TEST_MAX_SIZE + 4];
+  uint8_t counter[16];
+  uint16_t size;
+  uint16_t offset;
+
+  for( size = 0; size <= TEST_MAX_SIZE; size++ )
+  {
+    offset = size & 0x03;
+    RandomFill( key, 16 );
+    RandomFill( in, sizeof( in ) );
+    RandomFill( counter, 16 );
+    /* LoRaMac counter blocks: the counter never crosses its last byte */
+    counter[12] = 0;
+    counter[13] = 0;
+    counter[14] = 0;
+    counter[15] = 1;
+
+    if( ( size % 16 ) == 0 )
+    {
+      soft->Ecb( key, in + offset, outSoft, size / 16 );
+      MockProvider.Ecb( key, in + offset, outMock + offset, size / 16 );
+      TEST_CHECK( memcmp( outSoft, outMock + offset, size ) == 0 );
+
+      memcpy( outSoft, counter, 16 );
+      memcpy( outMock, counter, 16 );
+      soft->CbcMac( key, in + offset, size / 16, outSoft );
+      MockProvider.CbcMac( key, in + offset, size / 16, outMock );
+      TEST_CHECK( memcmp( outSoft, outMock, 16 ) == 0 );
+    }
+
+    soft->Ctr( key, counter, in + offset, size, outSoft );
+    MockProvider.Ctr( key, counter, in + offset, size, outMock + ( 3 - offset ) );
+    TEST_CHECK( memcmp( outSoft, outMock + ( 3 - offset ), size ) == 0 );
+
+    /* in place */
+    memcpy( outMock, in, sizeof( in ) );
+    MockProvider.Ctr( key, counter, outMock + offset, size, outMock + offset );
+    TEST_CHECK( memcmp( outSoft, outMock + offset, size ) == 0 );
+  }
+}
+
+/*!
+ * @brief Results of the LoRaMacCrypto primitives with the current provider
+ */
+static void RunPrimitives( const uint8_t *key, const uint8_t *frame, uint16_t size, uint8_t *results )
+{
+  uint32_t mic;
+  uint8_t appNonce[6] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+
+  LoRaMacComputeMic( frame, size, key, 0x26011234, 0, size * 7, &mic );
+  memcpy( results, &mic, 4 );
+  results += 4;
+  LoRaMacComputeMicFast( LORAMAC_CRYPTO_NWK_S_KEY, 1, 0x26011234, size * 3, frame, size, &mic );
+  memcpy( results, &mic, 4 );
+  results += 4;
+  LoRaMacJoinComputeMic( frame, size, key, &mic );
+  memcpy( results, &mic, 4 );
+  results += 4;
+  LoRaMacPayloadEncrypt( frame, size, key, 0x26011234, 0, size, results );
+  results += size;
+  LoRaMacPayloadDecrypt( frame, size, key, 0x26011234, 1, size, results );
+  results += size;
+  LoRaMacPayloadKeystream( key, 0x26011234, 0, size, 2, 3, results );
+  results += 48;
+  LoRaMacJoinDecrypt( frame, ( size >= 16 ) ? 32 : 16, key, results );
+  results += 32;
+  LoRaMacJoinComputeSKeys( key, appNonce, size, results, results + 16 );
+}
+
+/*!
+ * @brief The LoRaMacCrypto primitives give the same results on the mock
+ *        provider as on the software one, and do call the provider
+ */
+static void TestPrimitives( void )
+{
+  uint8_t key[16];
+  uint8_t nwkSKey[16];
+  uint8_t frame[TEST_MAX_SIZE];
+  uint8_t resultsSoft[2 * TEST_MAX_SIZE + 128];
+  uint8_t resultsMock[2 * TEST_MAX_SIZE + 128];
+  uint16_t size;
+
+  for( size = 0; size < TEST_MAX_SIZE; size++ )
+  {
+    RandomFill( key, 16 );
+    RandomFill( nwkSKey, 16 );
+    RandomFill( frame, sizeof( frame ) );
+    LoRaMacCryptoSetKey( LORAMAC_CRYPTO_NWK_S_KEY, nwkSKey );
+    /* cached and not cached keys */
+    if( ( size & 1 ) != 0 )
+    {
+      LoRaMacCryptoSetKey( LORAMAC_CRYPTO_APP_S_KEY, key );
+    }
+    else
+    {
+      LoRaMacCryptoClearKey( LORAMAC_CRYPTO_APP_S_KEY );
+    }
+
+    memset( resultsSoft, 0, sizeof( resultsSoft ) );
+    memset( resultsMock, 0, sizeof( resultsMock ) );
+    LoRaMacCryptoInit( NULL );
+    RunPrimitives( key, frame, size, resultsSoft );
+    LoRaMacCryptoInit( &MockProvider );
+    RunPrimitives( key, frame, size, resultsMock );
+    TEST_CHECK( memcmp( resultsSoft, resultsMock, sizeof( resultsSoft ) ) == 0 );
+  }
+  LoRaMacCryptoInit( NULL );
+
+  TEST_CHECK( MockCalls.Ecb > 0 );
+  TEST_CHECK( MockCalls.CbcMac > 0 );
+  TEST_CHECK( MockCalls.Ctr > 0 );
+}
+
+/*!
+ * @brief The software provider stays in use when the provider is absent
+ */
+static void TestFallback( void )
+{
+  uint8_t key[16] = { 0 };
+  uint8_t frame[32] = { 0 };
+  uint8_t results[2 * 32 + 128];
+  MockCalls_t calls;
+
+  MockPresent = false;
+  calls = MockCalls;
+  LoRaMacCryptoInit( &MockProvider );
+  RunPrimitives( key, frame, sizeof( frame ), results );
+  TEST_CHECK( MockCalls.Init == ( calls.Init + 1 ) );
+  TEST_CHECK( MockCalls.Ecb == calls.Ecb );
+  TEST_CHECK( MockCalls.CbcMac == calls.CbcMac );
+  TEST_CHECK( MockCalls.Ctr == calls.Ctr );
+  MockPresent = true;
+  LoRaMacCryptoInit( NULL );
+}
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( void )
+{
+  srand( 1 );
+  TestProviderContract( );
+  TestPrimitives( );
+  TestFallback( );
+
+  return TEST_END( "test_crypto_provider" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,379 @@
+/**
+ ******************************************************************************
+ * @file    test_hex.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the AT+SENDB and AT+RECVB hex payloads: decode_hex
+ *          of at.c and vcom_WriteHex of vcom.c, on fake LL drivers. Built with
+ *          BENCH_HEX, also times them against the byte per byte formatting
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_test.h"
+#include "test_vcom.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Bytes of the payloads: the largest LoRaWAN FRMPayload and past it */
+#define TEST_MAX_SIZE                   242
+#define TEST_OVER_SIZE                  300
+
+/* Application port of the test payloads */
+#define TEST_PORT                       2
+
+/* Lines per measure */
+#define BENCH_LOOPS                     200
+
+/* Private variables ---------------------------------------------------------*/
+
+/* payload handed to LORA_send */
+static uint8_t TestSent[TEST_OVER_SIZE];
+static uint8_t TestSentSize = 0;
+static uint8_t TestSentPort = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+/* never called: AT+RESET is not tested */
+void NVIC_SystemReset( void );
+
+/* utilities.c builds with the End_Node headers, not with the AT_Slave ones */
+void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+  memcpy( dst, src, size );
+}
+
+/* The AT commands of AT_Slave -----------------------------------------------*/
+
+#include AT_SOURCE
+
+/* Fake LoRa layer: only AT+SENDB reaches it, the linker drops the rest ------*/
+
+LoraErrorStatus LORA_send( lora_AppData_t *AppData, LoraConfirm_t IsTxConfirmed )
+{
+  memcpy( TestSent, AppData->Buff, AppData->BuffSize );
+  TestSentSize = AppData->BuffSize;
+  TestSentPort = AppData->Port;
+  return LORA_SUCCESS;
+}
+
+LoraConfirm_t lora_config_reqack_get( void )
+{
+  return LORAWAN_UNCONFIRMED_MSG;
+}
+
+/*!
+ * @brief The reference digits of the bytes, by the C library
+ */
+static void TestHex( const uint8_t *buf, uint16_t size, char *hex, bool upper )
+{
+  uint16_t i;
+
+  for( i = 0; i < size; i++ )
+  {
+    sprintf( &hex[i * 2], upper ? "%02X" : "%02x", buf[i] );
+  }
+  hex[size * 2] = '\0';
+}
+
+/*!
+ * @brief AT+SENDB as done before the nibble table: tiny_sscanf once per
+ *        byte. Returns the payload size, -1 if a digit is not valid.
+ */
+static int BenchDecodeScanf( const char *buf, unsigned bufSize, uint8_t *out )
+{
+  unsigned size = 0;
+  char hex[3];
+
+  hex[2] = 0;
+  while( ( size < LORAWAN_APP_DATA_BUFF_SIZE ) && ( bufSize > 1 ) )
+  {
+    hex[0] = buf[size * 2];
+    hex[1] = buf[size * 2 + 1];
+    if( tiny_sscanf( hex, "%hhx", &out[size] ) != 1 )
+    {
+      return -1;
+    }
+    size++;
+    bufSize -= 2;
+  }
+  return ( bufSize != 0 ) ? -1 : size;
+}
+
+#if defined( BENCH_HEX )
+/*!
+ * @brief AT+RECVB as done before vcom_WriteHex: one AT_PRINTF per byte
+ */
+static void BenchEncodePrintf( const uint8_t *buf, uint16_t size )
+{
+  uint16_t i;
+
+  for( i = 0; i < size; i++ )
+  {
+    AT_PRINTF( "%02x", buf[i] );
+  }
+}
+#endif
+
+/*!
+ * @brief Every byte in both cases, every other char rejected in either
+ *        digit of a byte, every payload size through AT+SENDB
+ */
+static void TestDecode( const uint8_t *data )
+{
+  char param[TEST_OVER_SIZE * 2 + 8];
+  char hex[3];
+  uint8_t byte;
+  uint16_t size;
+  uint16_t i;
+  int n;
+  int c;
+
+  for( i = 0; i < 256; i++ )
+  {
+    byte = i;
+    TestHex( &byte, 1, hex, false );
+    byte = ~i;
+    TEST_CHECK( ( decode_hex( hex, 2, &byte ) == 0 ) && ( byte == i ) );
+    byte = i;
+    TestHex( &byte, 1, hex, true );
+    byte = ~i;
+    TEST_CHECK( ( decode_hex( hex, 2, &byte ) == 0 ) && ( byte == i ) );
+  }
+
+  for( c = 1; c < 256; c++ )
+  {
+    hex[0] = c;
+    hex[1] = '5';
+    TEST_CHECK( ( decode_hex( hex, 2, &byte ) == 0 ) == ( isxdigit( c ) != 0 ) );
+    hex[0] = 'A';
+    hex[1] = c;
+    TEST_CHECK( ( decode_hex( hex, 2, &byte ) == 0 ) == ( isxdigit( c ) != 0 ) );
+  }
+
+  for( size = 0; size <= TEST_MAX_SIZE; size++ )
+  {
+    n = sprintf( param, "%u:", TEST_PORT );
+    TestHex( data, size, &param[n], ( size % 2 ) != 0 );
+    memset( TestSent, 0, sizeof( TestSent ) );
+    TestSentSize = 0xFF;
+    TEST_CHECK( at_SendBinary( param ) == AT_OK );
+    TEST_CHECK( ( TestSentSize == size ) && ( TestSentPort == TEST_PORT ) );
+    TEST_CHECK( memcmp( TestSent, data, size ) == 0 );
+
+    /* the byte per byte decoding gave the same payload */
+    TEST_CHECK( BenchDecodeScanf( &param[n], size * 2, TestSent ) == size );
+    TEST_CHECK( memcmp( TestSent, data, size ) == 0 );
+
+    /* an odd digit count */
+    param[n + size * 2] = '0';
+    param[n + size * 2 + 1] = '\0';
+    TEST_CHECK( at_SendBinary( param ) == AT_PARAM_ERROR );
+  }
+
+  /* a non hex char in any position of the largest payload */
+  TestHex( data, TEST_MAX_SIZE, &param[n], false );
+  for( i = n; i < ( n + TEST_MAX_SIZE * 2 ); i++ )
+  {
+    hex[0] = param[i];
+    param[i] = ( i % 3 ) ? 'g' : ':';
+    TestSentSize = 0;
+    TEST_CHECK( ( at_SendBinary( param ) == AT_PARAM_ERROR ) && ( TestSentSize == 0 ) );
+    param[i] = hex[0];
+  }
+
+  /* one byte past the largest payload */
+  TestHex( data, TEST_MAX_SIZE + 1, &param[n], false );
+  TestSentSize = 0;
+  TEST_CHECK( ( at_SendBinary( param ) == AT_PARAM_ERROR ) && ( TestSentSize == 0 ) );
+}
+
+/*!
+ * @brief Every payload size from every position of the tx buffer, between
+ *        the strings vcom_Send formats, then in the capture buffer
+ */
+static void TestEncode( const uint8_t *data )
+{
+  char ref[TEST_OVER_SIZE * 2 + 8];
+  char capture[32];
+  uint16_t size;
+  uint16_t pos;
+  uint16_t room;
+  int n;
+
+  for( pos = 0; pos < BUFSIZE_TX; pos++ )
+  {
+    for( size = 0; size <= TEST_OVER_SIZE; size++ )
+    {
+      TestStart( pos );
+      vcom_Send( "%u:", TEST_PORT );
+      vcom_WriteHex( data, size );
+      vcom_Send( "\r\n" );
+      TestDrain( );
+
+      n = sprintf( ref, "%u:", TEST_PORT );
+      TestHex( data, size, &ref[n], false );
+      strcat( ref, "\r\n" );
+      TEST_CHECK( ( TestOutputSize == strlen( ref ) ) && ( memcmp( TestOutput, ref, TestOutputSize ) == 0 ) );
+    }
+  }
+
+  /* AT+RECVB of every received size */
+  for( size = 0; size <= TEST_MAX_SIZE; size++ )
+  {
+    TestStart( size );
+    set_at_receive( TEST_PORT, ( uint8_t * )data, size );
+    TEST_CHECK( at_ReceiveBinary( "" ) == AT_OK );
+    TestDrain( );
+
+    n = sprintf( ref, "%u:", TEST_PORT );
+    TestHex( data, size, &ref[n], false );
+    strcat( ref, "\r\n" );
+    TEST_CHECK( ( TestOutputSize == strlen( ref ) ) && ( memcmp( TestOutput, ref, TestOutputSize ) == 0 ) );
+  }
+
+  /* the capture takes the whole bytes that fit, nothing goes to the port */
+  for( room = 0; room < sizeof( capture ); room++ )
+  {
+    for( size = 0; size <= sizeof( capture ); size++ )
+    {
+      memset( capture, 0, sizeof( capture ) );
+      vcom_CaptureStart( capture, room );
+      vcom_WriteHex( data, size );
+      TEST_CHECK( vcom_CaptureStop( ) == MIN( size, room / 2 ) * 2 );
+
+      TestHex( data, MIN( size, room / 2 ), ref, false );
+      TEST_CHECK( strcmp( capture, ref ) == 0 );
+    }
+  }
+  TestStart( 0 );
+  TestDrain( );
+  TEST_CHECK( TestOutputSize == 0 );
+}
+
+#if defined( BENCH_HEX )
+/*!
+ * @brief Cycles per AT+SENDB and AT+RECVB payload, before and after the
+ *        nibble table and vcom_WriteHex
+ */
+static void Bench( const uint8_t *data )
+{
+  static const uint8_t BenchSizes[] = { 1, 16, 51, 64, 115, 128, 222, 242 };
+  char hex[TEST_MAX_SIZE * 2 + 1];
+  uint8_t out[TEST_MAX_SIZE];
+  uint64_t cycles[4];
+  uint64_t total[4] = { 0 };
+  uint16_t size;
+  uint32_t n;
+
+  /* the fake DMA sends the tx buffer without copying it */
+  TestKeep = false;
+
+  printf( "cycles per payload, decoded for AT+SENDB and encoded for AT+RECVB\n" );
+  printf( "  scanf: tiny_sscanf per byte, table: decode_hex\n" );
+  printf( "  printf: AT_PRINTF per byte, table: vcom_WriteHex\n" );
+  printf( " size      scanf      table  speedup     printf      table  speedup\n" );
+  for( size = 1; size <= TEST_MAX_SIZE; size++ )
+  {
+    TestHex( data, size, hex, false );
+
+    TEST_MEASURE( cycles[0], BENCH_LOOPS, BenchDecodeScanf( hex, size * 2, out ) );
+    TEST_MEASURE( cycles[1], BENCH_LOOPS, decode_hex( hex, size * 2, out ) );
+    TEST_MEASURE( cycles[2], BENCH_LOOPS, BenchEncodePrintf( data, size ) );
+    TEST_MEASURE( cycles[3], BENCH_LOOPS, vcom_WriteHex( data, size ) );
+    TEST_CHECK( memcmp( out, data, size ) == 0 );
+    for( n = 0; n < 4; n++ )
+    {
+      total[n] += cycles[n];
+    }
+
+    if( memchr( BenchSizes, size, sizeof( BenchSizes ) ) != NULL )
+    {
+      printf( "%5u %10lu %10lu %8.2f %10lu %10lu %8.2f\n", size,
+              ( unsigned long )cycles[0], ( unsigned long )cycles[1], ( double )cycles[0] / ( double )( cycles[1] ? cycles[1] : 1 ),
+              ( unsigned long )cycles[2], ( unsigned long )cycles[3], ( double )cycles[2] / ( double )( cycles[3] ? cycles[3] : 1 ) );
+    }
+  }
+  printf( "1-%u %9lu %10lu %8.2f %10lu %10lu %8.2f  (sum of all sizes)\n", TEST_MAX_SIZE,
+          ( unsigned long )total[0], ( unsigned long )total[1], ( double )total[0] / ( double )( total[1] ? total[1] : 1 ),
+          ( unsigned long )total[2], ( unsigned long )total[3], ( double )total[2] / ( double )( total[3] ? total[3] : 1 ) );
+
+  TestStart( 0 );
+  TestKeep = true;
+}
+#endif
+
+/* Exported functions ---------------------------------------------------------*/
+
+int main( void )
+{
+  uint8_t data[TEST_OVER_SIZE];
+  uint16_t i;
+
+  srand( 1 );
+  for( i = 0; i < sizeof( data ); i++ )
+  {
+    data[i] = rand( );
+  }
+  /* every byte value in the longest payload */
+  for( i = 0; i < 256; i++ )
+  {
+    data[( i * 7 ) % sizeof( data )] = i;
+  }
+
+  TestDecode( data );
+  TestEncode( data );
+  TEST_CHECK( vcom_GetDropCount( ) == 0 );
+
+#if defined( BENCH_HEX )
+  Bench( data );
+  return TEST_END( "bench_hex" );
+#else
+  return TEST_END( "test_hex" );
+#endif
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,736 @@
+/**
+ ******************************************************************************
+ * @file    test_rtc.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the RTC drivers of the applications: timer value,
+ *          timer context and wake-up alarm against the calendar, 2000 to 2099
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "hw.h"
+#include "low_power_manager.h"
+#include "timeServer.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Fake STM32 RTC, HAL and LL: only the calendar registers the driver reads */
+/* and the alarm it programs are modelled, the rest of the setup is ignored */
+
+typedef struct
+{
+  volatile uint32_t TR;
+  volatile uint32_t DR;
+  volatile uint32_t CR;
+  volatile uint32_t SSR;
+} RTC_TypeDef;
+
+typedef struct
+{
+  volatile uint32_t CR;
+  volatile uint32_t CSR;
+} RCC_TypeDef;
+
+typedef struct
+{
+  uint32_t HourFormat;
+  uint32_t AsynchPrediv;
+  uint32_t SynchPrediv;
+  uint32_t OutPut;
+  uint32_t OutPutPolarity;
+  uint32_t OutPutType;
+} RTC_InitTypeDef;
+
+typedef struct
+{
+  RTC_TypeDef *Instance;
+  RTC_InitTypeDef Init;
+} RTC_HandleTypeDef;
+
+typedef struct
+{
+  uint8_t Hours;
+  uint8_t Minutes;
+  uint8_t Seconds;
+  uint8_t TimeFormat;
+  uint32_t SubSeconds;
+  uint32_t SecondFraction;
+  uint32_t DayLightSaving;
+  uint32_t StoreOperation;
+} RTC_TimeTypeDef;
+
+typedef struct
+{
+  uint8_t WeekDay;
+  uint8_t Month;
+  uint8_t Date;
+  uint8_t Year;
+} RTC_DateTypeDef;
+
+typedef struct
+{
+  RTC_TimeTypeDef AlarmTime;
+  uint32_t AlarmMask;
+  uint32_t AlarmSubSecondMask;
+  uint32_t AlarmDateWeekDaySel;
+  uint8_t AlarmDateWeekDay;
+  uint32_t Alarm;
+} RTC_AlarmTypeDef;
+
+typedef struct
+{
+  uint32_t WeekDay;
+  uint32_t Month;
+  uint8_t Day;
+  uint8_t Year;
+} LL_RTC_DateTypeDef;
+
+/*!
+ * The alarm A as programmed by the driver, in binary
+ */
+typedef struct
+{
+  bool Armed;
+  bool OnDate;                          /* Date match, not week day */
+  uint32_t Date;
+  uint32_t Hours;
+  uint32_t Minutes;
+  uint32_t Seconds;
+  uint32_t SubSeconds;                  /* SSR value, the SSR counts down */
+  uint32_t SubSecondMask;               /* As the ALRMASSR register */
+} FakeAlarm_t;
+
+/*!
+ * A calendar date and time, from 01/01/2000 to 31/12/2099
+ */
+typedef struct
+{
+  uint32_t Year;                        /* 0 is 2000 */
+  uint32_t Month;                       /* 1 to 12 */
+  uint32_t Date;                        /* 1 to 31 */
+  uint32_t Hours;
+  uint32_t Minutes;
+  uint32_t Seconds;
+  uint32_t SubSeconds;                  /* SSR value, TEST_PREDIV_S to 0 */
+} TestTime_t;
+
+/* Private define ------------------------------------------------------------*/
+
+#define RTC_TR_PM                       ( ( uint32_t )0x00400000 )
+#define RTC_TR_HT                       ( ( uint32_t )0x00300000 )
+#define RTC_TR_HU                       ( ( uint32_t )0x000F0000 )
+#define RTC_TR_MNT                      ( ( uint32_t )0x00007000 )
+#define RTC_TR_MNU                      ( ( uint32_t )0x00000F00 )
+#define RTC_TR_ST                       ( ( uint32_t )0x00000070 )
+#define RTC_TR_SU                       ( ( uint32_t )0x0000000F )
+#define RTC_DR_YT                       ( ( uint32_t )0x00F00000 )
+#define RTC_DR_YU                       ( ( uint32_t )0x000F0000 )
+#define RTC_DR_WDU                      ( ( uint32_t )0x0000E000 )
+#define RTC_DR_MT                       ( ( uint32_t )0x00001000 )
+#define RTC_DR_MU                       ( ( uint32_t )0x00000F00 )
+#define RTC_DR_DT                       ( ( uint32_t )0x00000030 )
+#define RTC_DR_DU                       ( ( uint32_t )0x0000000F )
+#define RTC_SSR_SS                      ( ( uint32_t )0x0000FFFF )
+#define RTC_CR_BYPSHAD                  ( ( uint32_t )0x00000020 )
+#define RTC_ALRMASSR_MASKSS_1           ( ( uint32_t )0x02000000 )
+#define RTC_ALRMASSR_MASKSS_3           ( ( uint32_t )0x08000000 )
+#define RTC_POSITION_ALMA_MASKSS        24U
+#define RTC_POSITION_DR_WDU             13U
+#define RCC_CSR_LSERDY                  ( ( uint32_t )0x00000200 )
+#define RCC_CSR_LSERDY_Msk              RCC_CSR_LSERDY
+#define RCC_CSR_RTCSEL                  ( ( uint32_t )0x00030000 )
+#define RCC_CR_RTCPRE                   ( ( uint32_t )0x00300000 )
+
+#define RTC                             ( &FakeRtc )
+#define RCC                             ( &FakeRcc )
+#define RTC_Alarm_IRQn                  RTC_IRQn
+#define IRQ_PRIORITY_ALARMA             0
+#define RTC_OUTPUT                      0
+
+#define RTC_HOURFORMAT_24               0U
+#define RTC_OUTPUT_POLARITY_HIGH        0U
+#define RTC_OUTPUT_TYPE_OPENDRAIN       0U
+#define RTC_MONTH_JANUARY               1U
+#define RTC_WEEKDAY_MONDAY              1U
+#define RTC_FORMAT_BIN                  0U
+#define RTC_DAYLIGHTSAVING_NONE         0U
+#define RTC_STOREOPERATION_RESET        0U
+#define RTC_ALARMDATEWEEKDAYSEL_DATE    0U
+#define RTC_ALARMMASK_NONE              0U
+#define RTC_ALARMSUBSECONDMASK_SS14_10  ( RTC_ALRMASSR_MASKSS_1 | RTC_ALRMASSR_MASKSS_3 )
+#define RTC_ALARM_A                     0x100U
+#define RTC_FLAG_ALRAF                  0x100U
+#define RTC_IT_ALRA                     0x1000U
+
+#define LL_EXTI_LINE_17                 ( 1U << 17 )
+#define LL_APB1_GRP1_PERIPH_PWR         ( 1U << 28 )
+#define LL_RCC_RTC_CLKSOURCE_LSE        RCC_CSR_RTCSEL
+#define LL_RTC_HOURFORMAT_24HOUR        0U
+#define LL_RTC_OUTPUTPOLARITY_PIN_HIGH  0U
+#define LL_RTC_ALARM_OUTPUTTYPE_OPENDRAIN 0U
+#define LL_RTC_WEEKDAY_SATURDAY         6U
+#define LL_RTC_TIME_FORMAT_AM_OR_24     0U
+#define LL_RTC_ALMA_MASK_NONE           0U
+
+/* Ticks per second of the driver, N_PREDIV_S = 10 */
+#define TEST_PREDIV_S                   1023U
+#define TEST_TICKS_PER_DAY              ( 86400ULL * ( TEST_PREDIV_S + 1 ) )
+
+/* Private macro -------------------------------------------------------------*/
+
+#define __LL_RTC_CONVERT_BIN2BCD( v )   ( ( uint8_t )( ( ( ( v ) / 10U ) << 4U ) | ( ( v ) % 10U ) ) )
+#define __LL_RTC_CONVERT_BCD2BIN( v )   ( ( uint8_t )( ( ( ( v ) & 0xF0U ) >> 4U ) * 10U + ( ( v ) & 0x0FU ) ) )
+#define READ_BIT( REG, BIT )            ( ( REG ) & ( BIT ) )
+#define CLEAR_BIT( REG, BIT )           ( ( REG ) &= ~( BIT ) )
+
+/* HAL calls the sweep does not observe */
+#define HAL_NVIC_GetPendingIRQ( ... )           0U
+#define __HAL_RTC_ALARM_CLEAR_FLAG( ... )       ( ( void )0 )
+#define __HAL_RTC_ALARM_EXTI_CLEAR_FLAG( ... )  ( ( void )0 )
+#define __HAL_RTC_ALARM_GET_IT_SOURCE( ... )    RESET
+#define __HAL_RTC_ALARM_GET_FLAG( ... )         RESET
+
+/* LL calls the sweep does not observe */
+#define NVIC_GetPendingIRQ( ... )               0U
+#define NVIC_SetPriority( ... )                 ( ( void )0 )
+#define NVIC_EnableIRQ( ... )                   ( ( void )0 )
+#define LL_APB1_GRP1_IsEnabledClock( ... )      SET
+#define LL_APB1_GRP1_EnableClock( ... )         ( ( void )0 )
+#define LL_APB1_GRP1_DisableClock( ... )        ( ( void )0 )
+#define LL_PWR_IsEnabledBkUpAccess( ... )       SET
+#define LL_PWR_EnableBkUpAccess( ... )          ( ( void )0 )
+#define LL_PWR_DisableBkUpAccess( ... )         ( ( void )0 )
+#define LL_RCC_LSE_Enable( ... )                ( ( void )0 )
+#define LL_RCC_EnableRTC( ... )                 ( ( void )0 )
+#define LL_RCC_ReadReg( ... )                   RCC_CSR_LSERDY
+#define LL_RCC_WriteReg( ... )                  ( ( void )0 )
+#define LL_RCC_GetRTCClockSource( ... )         LL_RCC_RTC_CLKSOURCE_LSE
+#define LL_RCC_SetRTCClockSource( ... )         ( ( void )0 )
+#define LL_RCC_ForceBackupDomainReset( ... )    ( ( void )0 )
+#define LL_RCC_ReleaseBackupDomainReset( ... )  ( ( void )0 )
+#define LL_RTC_DisableWriteProtection( ... )    ( ( void )0 )
+#define LL_RTC_EnableWriteProtection( ... )     ( ( void )0 )
+#define LL_RTC_EnterInitMode( ... )             ( ( void )0 )
+#define LL_RTC_DisableInitMode( ... )           ( ( void )0 )
+#define LL_RTC_SetHourFormat( ... )             ( ( void )0 )
+#define LL_RTC_SetAlarmOutEvent( ... )          ( ( void )0 )
+#define LL_RTC_SetOutputPolarity( ... )         ( ( void )0 )
+#define LL_RTC_SetSynchPrescaler( ... )         ( ( void )0 )
+#define LL_RTC_SetAsynchPrescaler( ... )        ( ( void )0 )
+#define LL_RTC_DisableOutRemap( ... )           ( ( void )0 )
+#define LL_RTC_SetAlarmOutputType( ... )        ( ( void )0 )
+#define LL_RTC_DATE_Config( ... )               ( ( void )0 )
+#define LL_RTC_TIME_Config( ... )               ( ( void )0 )
+#define LL_RTC_IsShadowRegBypassEnabled( ... )  1U
+#define LL_RTC_WaitForSynchro( ... )            ( ( void )0 )
+#define LL_RTC_EnableShadowRegBypass( ... )     ( ( void )0 )
+#define LL_RTC_ClearFlag_ALRA( ... )            ( ( void )0 )
+#define LL_RTC_IsActiveFlag_ALRA( ... )         0U
+#define LL_RTC_IsActiveFlag_ALRAW( ... )        1U
+#define LL_RTC_EnableIT_ALRA( ... )             ( ( void )0 )
+#define LL_RTC_DisableIT_ALRA( ... )            ( ( void )0 )
+#define LL_RTC_ALMA_SetMask( ... )              ( ( void )0 )
+#define LL_RTC_TIME_DisableDayLightStore( ... ) ( ( void )0 )
+#define LL_EXTI_EnableIT_0_31( ... )            ( ( void )0 )
+#define LL_EXTI_EnableRisingTrig_0_31( ... )    ( ( void )0 )
+#define LL_EXTI_ClearFlag_0_31( ... )           ( ( void )0 )
+
+/* Private variables ---------------------------------------------------------*/
+
+static RTC_TypeDef FakeRtc;
+RCC_TypeDef FakeRcc;
+static FakeAlarm_t FakeAlarm;
+
+static const uint8_t TestDaysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+/* Private functions ---------------------------------------------------------*/
+
+/* Fake HAL and LL calls that program or read the alarm ----------------------*/
+
+static inline uint8_t RTC_Bcd2ToByte( uint8_t value )
+{
+  return __LL_RTC_CONVERT_BCD2BIN( value );
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_Init( RTC_HandleTypeDef *hrtc )
+{
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTCEx_EnableBypassShadow( RTC_HandleTypeDef *hrtc )
+{
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_SetDate( RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *date, uint32_t format )
+{
+  FakeRtc.DR = ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( date->Year ) << 16 ) |
+               ( ( uint32_t )date->WeekDay << RTC_POSITION_DR_WDU ) |
+               ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( date->Month ) << 8 ) |
+               __LL_RTC_CONVERT_BIN2BCD( date->Date );
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_SetTime( RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *time, uint32_t format )
+{
+  FakeRtc.TR = ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( time->Hours ) << 16 ) |
+               ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( time->Minutes ) << 8 ) |
+               __LL_RTC_CONVERT_BIN2BCD( time->Seconds );
+  FakeRtc.SSR = TEST_PREDIV_S;
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_SetAlarm_IT( RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *alarm, uint32_t format )
+{
+  FakeAlarm.Armed = true;
+  FakeAlarm.OnDate = ( alarm->AlarmDateWeekDaySel == RTC_ALARMDATEWEEKDAYSEL_DATE ) &&
+                     ( alarm->AlarmMask == RTC_ALARMMASK_NONE );
+  FakeAlarm.Date = alarm->AlarmDateWeekDay;
+  FakeAlarm.Hours = alarm->AlarmTime.Hours;
+  FakeAlarm.Minutes = alarm->AlarmTime.Minutes;
+  FakeAlarm.Seconds = alarm->AlarmTime.Seconds;
+  FakeAlarm.SubSeconds = alarm->AlarmTime.SubSeconds;
+  FakeAlarm.SubSecondMask = alarm->AlarmSubSecondMask;
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_GetAlarm( RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *alarm, uint32_t id, uint32_t format )
+{
+  alarm->AlarmDateWeekDay = FakeAlarm.Date;
+  alarm->AlarmTime.Hours = FakeAlarm.Hours;
+  alarm->AlarmTime.Minutes = FakeAlarm.Minutes;
+  alarm->AlarmTime.Seconds = FakeAlarm.Seconds;
+  alarm->AlarmTime.SubSeconds = FakeAlarm.SubSeconds;
+  return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_RTC_DeactivateAlarm( RTC_HandleTypeDef *hrtc, uint32_t id )
+{
+  FakeAlarm.Armed = false;
+  return HAL_OK;
+}
+
+static inline void HAL_RTC_AlarmAEventCallback( RTC_HandleTypeDef *hrtc )
+{
+}
+
+static inline void LL_RTC_ALMA_Enable( RTC_TypeDef *rtc )
+{
+  FakeAlarm.Armed = true;
+}
+
+static inline void LL_RTC_ALMA_Disable( RTC_TypeDef *rtc )
+{
+  FakeAlarm.Armed = false;
+}
+
+static inline void LL_RTC_ALMA_DisableWeekday( RTC_TypeDef *rtc )
+{
+  FakeAlarm.OnDate = true;
+}
+
+static inline void LL_RTC_ALMA_SetDay( RTC_TypeDef *rtc, uint32_t day )
+{
+  FakeAlarm.Date = __LL_RTC_CONVERT_BCD2BIN( day );
+}
+
+static inline void LL_RTC_ALMA_ConfigTime( RTC_TypeDef *rtc, uint32_t format, uint32_t hours, uint32_t minutes, uint32_t seconds )
+{
+  FakeAlarm.Hours = __LL_RTC_CONVERT_BCD2BIN( hours );
+  FakeAlarm.Minutes = __LL_RTC_CONVERT_BCD2BIN( minutes );
+  FakeAlarm.Seconds = __LL_RTC_CONVERT_BCD2BIN( seconds );
+}
+
+static inline void LL_RTC_ALMA_SetSubSecond( RTC_TypeDef *rtc, uint32_t subSeconds )
+{
+  FakeAlarm.SubSeconds = subSeconds;
+}
+
+static inline void LL_RTC_ALMA_SetSubSecondMask( RTC_TypeDef *rtc, uint32_t mask )
+{
+  FakeAlarm.SubSecondMask = mask << RTC_POSITION_ALMA_MASKSS;
+}
+
+static inline uint32_t LL_RTC_ALMA_GetDay( RTC_TypeDef *rtc )
+{
+  return FakeAlarm.Date;
+}
+
+static inline uint32_t LL_RTC_ALMA_GetHour( RTC_TypeDef *rtc )
+{
+  return __LL_RTC_CONVERT_BIN2BCD( FakeAlarm.Hours );
+}
+
+static inline uint32_t LL_RTC_ALMA_GetMinute( RTC_TypeDef *rtc )
+{
+  return __LL_RTC_CONVERT_BIN2BCD( FakeAlarm.Minutes );
+}
+
+static inline uint32_t LL_RTC_ALMA_GetSecond( RTC_TypeDef *rtc )
+{
+  return __LL_RTC_CONVERT_BIN2BCD( FakeAlarm.Seconds );
+}
+
+static inline uint32_t LL_RTC_ALMA_GetSubSecond( RTC_TypeDef *rtc )
+{
+  return FakeAlarm.SubSeconds;
+}
+
+/* The driver under test, HW_RTC_SOURCE and TEST_APP are set by the Makefile */
+
+/* AT_Slave picks the EXTI line of the alarm by board */
+#define USE_B_L072Z_LRWAN1
+
+#include HW_RTC_SOURCE
+
+/* the AT_Slave driver keeps the date in the LL structure */
+#ifdef HW_RTC_EXTI_LINE_ALARM_EVENT
+#define TEST_CONTEXT_DATE               RtcTimerContext.RTC_Calndr_Date.Day
+#else
+#define TEST_CONTEXT_DATE               RtcTimerContext.RTC_Calndr_Date.Date
+#endif
+
+/* Stubs of the low power manager and of the timer server --------------------*/
+
+void LPM_SetStopMode( LPM_Id_t id, LPM_SetMode_t mode )
+{
+}
+
+LPM_GetMode_t LPM_GetMode( void )
+{
+  return LPM_SleepMode;
+}
+
+void TimerIrqHandler( void )
+{
+}
+
+/* Reference calendar --------------------------------------------------------*/
+
+/*!
+ * @brief Days in a month, 2000 to 2099: every year divisible by 4 is leap
+ */
+static uint32_t TestMonthDays( uint32_t year, uint32_t month )
+{
+  if( ( month == 2 ) && ( ( year % 4 ) == 0 ) )
+  {
+    return 29;
+  }
+  return TestDaysInMonth[month - 1];
+}
+
+/*!
+ * @brief Ticks from 01/01/2000 00:00:00, by walking the calendar
+ */
+static uint64_t TestTicks( const TestTime_t *t )
+{
+  uint64_t days = t->Date - 1;
+  uint32_t i;
+
+  for( i = 0; i < t->Year; i++ )
+  {
+    days += ( ( i % 4 ) == 0 ) ? 366 : 365;
+  }
+  for( i = 1; i < t->Month; i++ )
+  {
+    days += TestMonthDays( t->Year, i );
+  }
+  return ( ( days * 86400 + t->Hours * 3600 + t->Minutes * 60 + t->Seconds ) * ( TEST_PREDIV_S + 1 ) ) +
+         ( TEST_PREDIV_S - t->SubSeconds );
+}
+
+/*!
+ * @brief Date and time of a number of ticks from 01/01/2000 00:00:00
+ */
+static void TestTime( uint64_t ticks, TestTime_t *t )
+{
+  uint64_t seconds = ticks / ( TEST_PREDIV_S + 1 );
+  uint32_t days = ( uint32_t )( seconds / 86400 );
+  uint32_t daySeconds = ( uint32_t )( seconds % 86400 );
+
+  t->SubSeconds = TEST_PREDIV_S - ( uint32_t )( ticks % ( TEST_PREDIV_S + 1 ) );
+  t->Hours = daySeconds / 3600;
+  t->Minutes = ( daySeconds / 60 ) % 60;
+  t->Seconds = daySeconds % 60;
+  t->Year = 0;
+  while( days >= ( ( ( t->Year % 4 ) == 0 ) ? 366U : 365U ) )
+  {
+    days -= ( ( t->Year % 4 ) == 0 ) ? 366 : 365;
+    t->Year++;
+  }
+  t->Month = 1;
+  while( days >= TestMonthDays( t->Year, t->Month ) )
+  {
+    days -= TestMonthDays( t->Year, t->Month );
+    t->Month++;
+  }
+  t->Date = days + 1;
+}
+
+/*!
+ * @brief Loads the calendar registers, the week day is the real one
+ */
+static void FakeRtcSet( const TestTime_t *t )
+{
+  /* 01/01/2000 is a saturday, week day 6 */
+  uint32_t weekDay = ( uint32_t )( ( ( TestTicks( t ) / TEST_TICKS_PER_DAY ) + 5 ) % 7 ) + 1;
+
+  FakeRtc.TR = ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( t->Hours ) << 16 ) |
+               ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( t->Minutes ) << 8 ) |
+               __LL_RTC_CONVERT_BIN2BCD( t->Seconds );
+  FakeRtc.DR = ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( t->Year ) << 16 ) |
+               ( weekDay << RTC_POSITION_DR_WDU ) |
+               ( ( uint32_t )__LL_RTC_CONVERT_BIN2BCD( t->Month ) << 8 ) |
+               __LL_RTC_CONVERT_BIN2BCD( t->Date );
+  FakeRtc.SSR = t->SubSeconds;
+}
+
+static void TestSetTime( TestTime_t *t, uint32_t year, uint32_t month, uint32_t date,
+                         uint32_t hours, uint32_t minutes, uint32_t seconds, uint32_t subSeconds )
+{
+  t->Year = year;
+  t->Month = month;
+  t->Date = date;
+  t->Hours = hours;
+  t->Minutes = minutes;
+  t->Seconds = seconds;
+  t->SubSeconds = subSeconds;
+}
+
+/* Tests ---------------------------------------------------------------------*/
+
+/*!
+ * @brief Checks the timer value and the timer context against the calendar
+ *        at a time, the timer value counts from the first read of 2000
+ */
+static void TestCalendarAt( const TestTime_t *t, uint32_t origin )
+{
+  uint32_t ticks = ( uint32_t )TestTicks( t );
+
+  FakeRtcSet( t );
+  TEST_CHECK( HW_RTC_GetTimerValue( ) - origin == ticks );
+  /* the day base is cached: a second read of the same day gives the same */
+  TEST_CHECK( HW_RTC_GetTimerValue( ) - origin == ticks );
+
+  TEST_CHECK( HW_RTC_SetTimerContext( ) - origin == ticks );
+  TEST_CHECK( HW_RTC_GetTimerContext( ) - origin == ticks );
+  TEST_CHECK( HW_RTC_GetTimerElapsedTime( ) == 0 );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Date.Year == t->Year );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Date.Month == t->Month );
+  TEST_CHECK( TEST_CONTEXT_DATE == t->Date );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Time.Hours == t->Hours );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Time.Minutes == t->Minutes );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Time.Seconds == t->Seconds );
+  TEST_CHECK( RtcTimerContext.RTC_Calndr_Time.SubSeconds == t->SubSeconds );
+}
+
+/*!
+ * @brief Every day of 2000 to 2099: first, last and a random tick of the day,
+ *        then random dates, so that the cached day base keeps changing
+ */
+static void TestCalendar( void )
+{
+  TestTime_t t;
+  uint32_t origin;
+  uint32_t lastTick = 0;
+  uint32_t year, month, date;
+  uint32_t i;
+
+  TestSetTime( &t, 0, 1, 1, 0, 0, 0, TEST_PREDIV_S );
+  FakeRtcSet( &t );
+  origin = HW_RTC_GetTimerValue( );
+
+  for( year = 0; year < 100; year++ )
+  {
+    for( month = 1; month <= 12; month++ )
+    {
+      for( date = 1; date <= TestMonthDays( year, month ); date++ )
+      {
+        TestSetTime( &t, year, month, date, 0, 0, 0, TEST_PREDIV_S );
+        TestCalendarAt( &t, origin );
+        /* one tick after the last tick of the day before */
+        if( ( year | ( month - 1 ) | ( date - 1 ) ) != 0 )
+        {
+          TEST_CHECK( HW_RTC_GetTimerValue( ) == lastTick + 1 );
+        }
+
+        TestSetTime( &t, year, month, date, rand( ) % 24, rand( ) % 60, rand( ) % 60, rand( ) % ( TEST_PREDIV_S + 1 ) );
+        TestCalendarAt( &t, origin );
+
+        TestSetTime( &t, year, month, date, 23, 59, 59, 0 );
+        TestCalendarAt( &t, origin );
+        lastTick = HW_RTC_GetTimerValue( );
+      }
+    }
+  }
+
+  for( i = 0; i < 10000; i++ )
+  {
+    TestTime( ( ( uint64_t )rand( ) << 16 ^ rand( ) ) % ( 36525 * TEST_TICKS_PER_DAY ), &t );
+    TestCalendarAt( &t, origin );
+  }
+}
+
+/*!
+ * @brief Programs the alarm at a timeout from the context and checks it
+ *        against the calendar
+ */
+static void TestAlarmAt( const TestTime_t *context, uint32_t timeout )
+{
+  TestTime_t wakeUp;
+
+  TestTime( TestTicks( context ) + timeout, &wakeUp );
+
+  FakeAlarm.Armed = false;
+  HW_RTC_StartWakeUpAlarm( timeout );
+
+  TEST_CHECK( FakeAlarm.Armed == true );
+  TEST_CHECK( FakeAlarm.OnDate == true );
+  TEST_CHECK( FakeAlarm.SubSecondMask == RTC_ALARMSUBSECONDMASK_SS14_10 );
+  TEST_CHECK( FakeAlarm.SubSeconds == wakeUp.SubSeconds );
+  TEST_CHECK( FakeAlarm.Seconds == wakeUp.Seconds );
+  TEST_CHECK( FakeAlarm.Minutes == wakeUp.Minutes );
+  TEST_CHECK( FakeAlarm.Hours == wakeUp.Hours );
+  /* the alarm matches the date of the month: it is never 0, and the */
+  /* longest timeout, 2^32 ticks or 48 days, ends at most two months later */
+  TEST_CHECK( FakeAlarm.Date == wakeUp.Date );
+}
+
+/*!
+ * @brief Contexts at the start, end and middle of every month of 2000 to
+ *        2099, timeouts of whole days up to 2^32 ticks and random ones
+ */
+static void TestAlarm( void )
+{
+  TestTime_t context;
+  uint32_t year, month, days, ctx, day;
+  uint32_t i;
+
+  for( year = 0; year < 100; year++ )
+  {
+    for( month = 1; month <= 12; month++ )
+    {
+      days = TestMonthDays( year, month );
+      for( ctx = 0; ctx < 4; ctx++ )
+      {
+        switch( ctx )
+        {
+          case 0:
+            TestSetTime( &context, year, month, 1, 0, 0, 0, TEST_PREDIV_S );
+            break;
+          case 1:
+            TestSetTime( &context, year, month, days, 23, 59, 59, 0 );
+            break;
+          case 2:
+            TestSetTime( &context, year, month, days - 1, 12, 0, 0, TEST_PREDIV_S / 2 );
+            break;
+          default:
+            TestSetTime( &context, year, month, 1 + rand( ) % days, rand( ) % 24, rand( ) % 60, rand( ) % 60,
+                         rand( ) % ( TEST_PREDIV_S + 1 ) );
+            break;
+        }
+        FakeRtcSet( &context );
+        HW_RTC_SetTimerContext( );
+
+        for( i = 0; i < 2048; i++ )
+        {
+          TestAlarmAt( &context, i );
+        }
+        for( day = 1; day * TEST_TICKS_PER_DAY < 0xFFFFFFFFULL; day++ )
+        {
+          TestAlarmAt( &context, ( uint32_t )( day * TEST_TICKS_PER_DAY ) - 1 );
+          TestAlarmAt( &context, ( uint32_t )( day * TEST_TICKS_PER_DAY ) );
+          TestAlarmAt( &context, ( uint32_t )( day * TEST_TICKS_PER_DAY ) + 1 );
+        }
+        TestAlarmAt( &context, 0xFFFFFFFF );
+        for( i = 0; i < 256; i++ )
+        {
+          TestAlarmAt( &context, ( ( uint32_t )rand( ) << 16 ) ^ ( uint32_t )rand( ) );
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * @brief The alarm through HW_RTC_SetAlarm, as the timer server sets it
+ */
+static void TestSetAlarm( void )
+{
+  TestTime_t context;
+  uint32_t i;
+
+  TestSetTime( &context, 16, 2, 28, 23, 59, 59, 0 );
+  FakeRtcSet( &context );
+  HW_RTC_SetTimerContext( );
+  for( i = 0; i < 1000; i++ )
+  {
+    uint32_t timeout = ( ( uint32_t )rand( ) << 16 ) ^ ( uint32_t )rand( );
+    TestTime_t wakeUp;
+
+    TestTime( TestTicks( &context ) + timeout, &wakeUp );
+    HW_RTC_SetAlarm( timeout );
+    TEST_CHECK( FakeAlarm.Armed == true );
+    TEST_CHECK( FakeAlarm.Date == wakeUp.Date );
+    TEST_CHECK( FakeAlarm.Hours == wakeUp.Hours );
+    TEST_CHECK( FakeAlarm.Minutes == wakeUp.Minutes );
+    TEST_CHECK( FakeAlarm.Seconds == wakeUp.Seconds );
+    TEST_CHECK( FakeAlarm.SubSeconds == wakeUp.SubSeconds );
+  }
+  HW_RTC_StopAlarm( );
+  TEST_CHECK( FakeAlarm.Armed == false );
+}
+
+int main( void )
+{
+  srand( 1 );
+
+  TestCalendar( );
+  TestAlarm( );
+  TestSetAlarm( );
+
+  return TEST_END( "test_rtc " TEST_APP );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,473 @@
+/**
+ ******************************************************************************
+ * @file    test_timer.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the timer server on a fake RTC: expiry order and
+ *          heap work per critical section for 1 to 256 timers, with the
+ *          interrupts off time for information
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "hw.h"
+#include "timeServer.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * A timer under test and its expected state
+ */
+typedef struct
+{
+  TimerEvent_t Timer;
+  bool Running;                         /* Expected to be in the heap */
+  uint32_t Expiry;                      /* Expected expiry, in ticks */
+  uint32_t Value;                       /* Duration, in ticks */
+  uint32_t Fired;
+} TestTimer_t;
+
+/* Private define ------------------------------------------------------------*/
+
+#define TEST_MAX_TIMERS             256
+
+/* Minimum alarm duration of the fake RTC, in ticks */
+#define TEST_MIN_TIMEOUT            3
+
+/* The tick counter starts close to its wrap around */
+#define TEST_START_TICKS            0xFFFFF000
+
+/* Expiry comparisons per critical section, amortized, per bit of the number
+   of timers: the pairing heap makes less than 0.4 */
+#define TEST_COMPARES_PER_LOG2      1
+
+/* Private variables ---------------------------------------------------------*/
+
+static TestTimer_t Timers[TEST_MAX_TIMERS];
+static uint32_t NbTimers;
+
+/* Fake RTC: the tick counter, the timer context and the alarm */
+static uint32_t RtcNow;
+static uint32_t RtcContext;
+static uint32_t RtcAlarm;
+static bool RtcAlarmArmed;
+
+/* Fake PRIMASK and the measure of the time spent with the interrupts off */
+static uint32_t Primask;
+static bool InIrq;
+static uint64_t IrqOffStart;
+static uint64_t IrqOffMax;
+static uint64_t IrqOffTotal;
+static uint32_t IrqOffCount;
+static uint64_t IrqHandlerMax;
+
+/* The heap work: the expiry comparisons, the critical sections and
+   TimerIrqHandler runs they are made in */
+static uint32_t Compares;
+static uint32_t Sections;
+
+/* What the callbacks do besides checking the expiry */
+static bool CallbackRestarts;
+
+/* The timer server, its comparisons counted ---------------------------------*/
+
+#define TIMER_COUNT_COMPARE( )      ( Compares++ )
+
+#include TIMER_SOURCE
+
+/* Private functions ---------------------------------------------------------*/
+
+/*!
+ * @brief Checks that the timer fires on time and before every other running timer
+ */
+static void OnTimer( void )
+{
+  TestTimer_t *t = TimerGetContext( );
+  uint32_t i;
+
+  TEST_CHECK( t != NULL );
+  if( t == NULL )
+  {
+    return;
+  }
+  TEST_CHECK( t->Running == true );
+  TEST_CHECK( t->Timer.IsRunning == false );
+  /* never early, late by the minimum alarm duration at most */
+  TEST_CHECK( ( int32_t )( RtcNow - t->Expiry ) >= 0 );
+  TEST_CHECK( ( int32_t )( RtcNow - t->Expiry ) <= TEST_MIN_TIMEOUT );
+  for( i = 0; i < NbTimers; i++ )
+  {
+    if( ( Timers[i].Running == true ) && ( ( int32_t )( Timers[i].Expiry - t->Expiry ) < 0 ) )
+    {
+      printf( "timer %u fired at %u before timer %u of expiry %u\n", ( unsigned )( t - Timers ), t->Expiry,
+              ( unsigned )i, Timers[i].Expiry );
+      TestFailures++;
+    }
+  }
+  t->Running = false;
+  t->Fired++;
+
+  if( ( CallbackRestarts == true ) && ( ( rand( ) % 2 ) == 0 ) )
+  {
+    /* periodic timer */
+    TimerStart( &t->Timer );
+    t->Running = true;
+    t->Expiry = RtcNow + t->Value;
+  }
+  if( ( CallbackRestarts == true ) && ( ( rand( ) % 4 ) == 0 ) )
+  {
+    /* stops another timer, maybe the next one to expire */
+    i = rand( ) % NbTimers;
+    TimerStop( &Timers[i].Timer );
+    Timers[i].Running = false;
+  }
+}
+
+/*!
+ * @brief Runs the alarms up to the given tick
+ */
+static void RunUntil( uint32_t end )
+{
+  uint64_t start;
+  uint64_t cycles;
+
+  while( ( RtcAlarmArmed == true ) && ( ( int32_t )( RtcAlarm - end ) <= 0 ) )
+  {
+    RtcNow = RtcAlarm;
+    RtcAlarmArmed = false;
+
+    InIrq = true;
+    Sections++;
+    start = TestCycles( );
+    TimerIrqHandler( );
+    cycles = TestCycles( ) - start;
+    InIrq = false;
+    if( cycles > IrqHandlerMax )
+    {
+      IrqHandlerMax = cycles;
+    }
+  }
+  RtcNow = end;
+}
+
+/*!
+ * @brief Starts a stopped timer for value ticks
+ */
+static void StartTimer( TestTimer_t *t, uint32_t value )
+{
+  if( value < TEST_MIN_TIMEOUT )
+  {
+    value = TEST_MIN_TIMEOUT;
+  }
+  TimerSetValue( &t->Timer, value );
+  TimerStart( &t->Timer );
+  t->Value = value;
+  t->Running = true;
+  t->Expiry = RtcNow + value;
+  TEST_CHECK( Primask == 0 );
+}
+
+static void StopTimer( TestTimer_t *t )
+{
+  TimerStop( &t->Timer );
+  t->Running = false;
+  TEST_CHECK( Primask == 0 );
+}
+
+static void InitTimers( uint32_t n )
+{
+  uint32_t i;
+
+  NbTimers = n;
+  for( i = 0; i < n; i++ )
+  {
+    TimerInit( &Timers[i].Timer, OnTimer );
+    TimerSetContext( &Timers[i].Timer, &Timers[i] );
+    Timers[i].Running = false;
+    Timers[i].Value = 0;
+    Timers[i].Fired = 0;
+  }
+}
+
+static void ResetIrqOff( void )
+{
+  IrqOffMax = 0;
+  IrqOffTotal = 0;
+  IrqOffCount = 0;
+  IrqHandlerMax = 0;
+  Compares = 0;
+  Sections = 0;
+}
+
+/*!
+ * @brief Checks the heap work, amortized over the critical sections since
+ *        ResetIrqOff( ), is logarithmic in the number of timers
+ */
+static void CheckCompares( uint32_t n )
+{
+  uint32_t log2n = 1;
+
+  while( ( n >> log2n ) != 0 )
+  {
+    log2n++;
+  }
+  /* log2n is the bit length of n, 1 + floor( log2( n ) ) */
+  if( Compares > ( TEST_COMPARES_PER_LOG2 * log2n * Sections ) )
+  {
+    printf( "%u timers: %u comparisons in %u critical sections\n", n, Compares, Sections );
+    TestFailures++;
+  }
+}
+
+/*!
+ * @brief n timers of random durations, started in a random order, fire in
+ *        the order of their expiry
+ */
+static void TestOrder( uint32_t n )
+{
+  uint32_t i;
+
+  InitTimers( n );
+  CallbackRestarts = false;
+  for( i = 0; i < n; i++ )
+  {
+    /* duplicated expiries and ranges across the 2^32 wrap around */
+    StartTimer( &Timers[i], 1 + rand( ) % ( ( i & 1 ) ? 50 : 100000 ) );
+    RunUntil( RtcNow + rand( ) % 3 );
+  }
+  RunUntil( RtcNow + 200000 );
+  for( i = 0; i < n; i++ )
+  {
+    TEST_CHECK( Timers[i].Fired == 1 );
+    TEST_CHECK( Timers[i].Timer.IsRunning == false );
+  }
+  TEST_CHECK( RtcAlarmArmed == false );
+}
+
+/*!
+ * @brief Random starts, stops, resets, restarts from the callbacks and
+ *        stops from the callbacks of n timers
+ */
+static void TestRandom( uint32_t n, uint32_t steps )
+{
+  TestTimer_t *t;
+  uint32_t i;
+
+  InitTimers( n );
+  CallbackRestarts = true;
+  for( i = 0; i < steps; i++ )
+  {
+    t = &Timers[rand( ) % n];
+    switch( rand( ) % 5 )
+    {
+    case 0:
+      StartTimer( t, 1 + rand( ) % 5000 );
+      break;
+    case 1:
+      /* already running: no change */
+      if( t->Running == true )
+      {
+        TimerStart( &t->Timer );
+      }
+      break;
+    case 2:
+      StopTimer( t );
+      break;
+    case 3:
+      if( t->Value != 0 )
+      {
+        TimerReset( &t->Timer );
+        t->Running = true;
+        t->Expiry = RtcNow + t->Value;
+      }
+      break;
+    default:
+      RunUntil( RtcNow + rand( ) % 500 );
+      break;
+    }
+    TEST_CHECK( t->Timer.IsRunning == t->Running );
+  }
+
+  /* everything still running fires */
+  CallbackRestarts = false;
+  RunUntil( RtcNow + 10000 );
+  for( i = 0; i < n; i++ )
+  {
+    TEST_CHECK( Timers[i].Running == false );
+  }
+  TEST_CHECK( RtcAlarmArmed == false );
+}
+
+/* Exported functions ---------------------------------------------------------*/
+
+/* Fake RTC, one tick per ms */
+
+uint32_t HW_RTC_ms2Tick( TimerTime_t timeMicroSec )
+{
+  return timeMicroSec;
+}
+
+TimerTime_t HW_RTC_Tick2ms( uint32_t tick )
+{
+  return tick;
+}
+
+uint32_t HW_RTC_GetMinimumTimeout( void )
+{
+  return TEST_MIN_TIMEOUT;
+}
+
+void HW_RTC_SetAlarm( uint32_t timeout )
+{
+  TEST_CHECK( ( Primask != 0 ) || ( InIrq == true ) );
+  RtcAlarm = RtcContext + timeout;
+  RtcAlarmArmed = true;
+  /* never in the past */
+  TEST_CHECK( ( int32_t )( RtcAlarm - RtcNow ) >= TEST_MIN_TIMEOUT );
+}
+
+void HW_RTC_StopAlarm( void )
+{
+  RtcAlarmArmed = false;
+}
+
+uint32_t HW_RTC_GetTimerElapsedTime( void )
+{
+  return RtcNow - RtcContext;
+}
+
+uint32_t HW_RTC_GetTimerValue( void )
+{
+  return RtcNow;
+}
+
+uint32_t HW_RTC_SetTimerContext( void )
+{
+  RtcContext = RtcNow;
+  return RtcContext;
+}
+
+uint32_t HW_RTC_GetTimerContext( void )
+{
+  return RtcContext;
+}
+
+/* Fake PRIMASK */
+
+uint32_t __get_PRIMASK( void )
+{
+  return Primask;
+}
+
+void __set_PRIMASK( uint32_t priMask )
+{
+  uint64_t cycles;
+
+  if( ( Primask == 0 ) && ( priMask != 0 ) )
+  {
+    Sections++;
+    IrqOffStart = TestCycles( );
+  }
+  else if( ( Primask != 0 ) && ( priMask == 0 ) )
+  {
+    cycles = TestCycles( ) - IrqOffStart;
+    IrqOffTotal += cycles;
+    IrqOffCount++;
+    if( cycles > IrqOffMax )
+    {
+      IrqOffMax = cycles;
+    }
+  }
+  Primask = priMask;
+}
+
+void __disable_irq( void )
+{
+  __set_PRIMASK( 1 );
+}
+
+void __enable_irq( void )
+{
+  __set_PRIMASK( 0 );
+}
+
+int main( void )
+{
+  uint32_t n;
+
+  srand( 1 );
+  RtcNow = TEST_START_TICKS;
+  HW_RTC_SetTimerContext( );
+
+  /* the heap work is counted, it does not depend on the host */
+  for( n = 1; n <= TEST_MAX_TIMERS; n++ )
+  {
+    ResetIrqOff( );
+    TestOrder( n );
+    CheckCompares( n );
+  }
+  for( n = 1; n <= TEST_MAX_TIMERS; n++ )
+  {
+    ResetIrqOff( );
+    TestRandom( n, 20 * n + 100 );
+    CheckCompares( n );
+  }
+
+  /* interrupts off time, for information: it follows the heap work but
+     depends on the host */
+  printf( "cycles with the interrupts off, per critical section of the timer server\n" );
+  printf( "timers      max     mean  TimerIrqHandler max\n" );
+  for( n = 1; n <= TEST_MAX_TIMERS; n *= 2 )
+  {
+    TestRandom( n, 20000 );
+    ResetIrqOff( );
+    TestRandom( n, 20000 );
+    printf( "%6u %8lu %8lu %8lu\n", n, ( unsigned long )IrqOffMax,
+            ( unsigned long )( IrqOffTotal / ( IrqOffCount ? IrqOffCount : 1 ) ), ( unsigned long )IrqHandlerMax );
+  }
+
+  return TEST_END( "test_timer" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
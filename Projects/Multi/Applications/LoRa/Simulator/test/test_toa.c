@@ -0,0 +1,589 @@
+/**
+ ******************************************************************************
+ * @file    test_toa.c
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Host test of the integer time-on-air and RX window computations
+ *          against the baseline double code and exact integer references
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include "hw.h"
+#include "radio.h"
+#include "sx1276.h"
+#include "timeServer.h"
+#include "delay.h"
+#include "LoRaMac.h"
+#include "RegionCommon.h"
+#include "sim_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/*!
+ * Differences between the baseline double code and the integer code, by cause
+ */
+typedef struct
+{
+  uint32_t Cases;
+  uint32_t Wrapped;                     /* LoRa: negative payload bits wrapped as unsigned */
+  uint32_t Undefined;                   /* Negative double converted to uint32_t */
+  uint32_t Overshoot;                   /* Exact integer, ceil( ) of the double one above */
+  uint32_t Tie;                         /* Exact .5, round( ) of the double one below */
+  uint32_t Truncated;                   /* Exact integer, cast of the double one below */
+} TestDiffs_t;
+
+/* Private define ------------------------------------------------------------*/
+
+#define TEST_FIFO_ADDR                  0x00
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Fake SX1276 register file, behind the SPI */
+static uint8_t FakeRegs[256];
+static uint8_t FakeAddr;
+static bool FakeWrite;
+
+static uint32_t Primask;
+
+/* Private functions ---------------------------------------------------------*/
+
+/* Fake SPI, GPIO, timers and board of the radio driver ----------------------*/
+
+uint16_t HW_SPI_InOut( uint16_t outData )
+{
+  FakeAddr = outData & 0x7F;
+  FakeWrite = ( outData & 0x80 ) != 0;
+  return 0;
+}
+
+void HW_SPI_Transfer( uint8_t *txData, uint8_t *rxData, uint16_t size )
+{
+  uint16_t i;
+
+  for( i = 0; i < size; i++ )
+  {
+    if( FakeWrite )
+    {
+      FakeRegs[FakeAddr] = ( txData != NULL ) ? txData[i] : 0;
+    }
+    else if( rxData != NULL )
+    {
+      rxData[i] = FakeRegs[FakeAddr];
+    }
+    if( FakeAddr != TEST_FIFO_ADDR )
+    {
+      FakeAddr = ( FakeAddr + 1 ) & 0x7F;
+    }
+  }
+}
+
+GPIO_TypeDef SimGpioPorts[SIM_GPIO_NB_PORTS];
+
+void HW_GPIO_Init( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_InitTypeDef* initStruct )
+{
+}
+
+void HW_GPIO_Write( GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, uint32_t value )
+{
+}
+
+void DelayMs( uint32_t ms )
+{
+}
+
+void TimerInit( TimerEvent_t *obj, void ( *callback )( void ) )
+{
+}
+
+void TimerStart( TimerEvent_t *obj )
+{
+}
+
+void TimerStop( TimerEvent_t *obj )
+{
+}
+
+void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+{
+}
+
+TimerTime_t TimerGetCurrentTime( void )
+{
+  return 0;
+}
+
+TimerTime_t TimerGetElapsedTime( TimerTime_t past )
+{
+  return 0;
+}
+
+uint32_t __get_PRIMASK( void )
+{
+  return Primask;
+}
+
+void __set_PRIMASK( uint32_t priMask )
+{
+  Primask = priMask;
+}
+
+void __disable_irq( void )
+{
+  Primask = 1;
+}
+
+void __enable_irq( void )
+{
+  Primask = 0;
+}
+
+static void BoardSetXO( uint8_t state )
+{
+}
+
+static uint32_t BoardGetWakeTime( void )
+{
+  return 0;
+}
+
+static void BoardIoIrqInit( DioIrqHandler **irqHandlers )
+{
+}
+
+static void BoardSetRfTxPower( int8_t power )
+{
+}
+
+static void BoardSetAntSwLowPower( bool status )
+{
+}
+
+static void BoardSetAntSw( uint8_t opMode )
+{
+}
+
+static LoRaBoardCallback_t BoardCallbacks =
+{
+  BoardSetXO,
+  BoardGetWakeTime,
+  BoardIoIrqInit,
+  BoardSetRfTxPower,
+  BoardSetAntSwLowPower,
+  BoardSetAntSw
+};
+
+/* The baseline double code, copied as it was -------------------------------*/
+
+/*!
+ * @brief Baseline LoRa time-on-air, false when the payload bits wrapped
+ *        around as unsigned and the conversion to uint32_t was undefined
+ */
+static bool OldTimeOnAirLoRa( const RadioLoRaSettings_t *s, uint8_t pktLen, uint32_t *airTime )
+{
+  double bw = 0.0;
+
+  switch( s->Bandwidth )
+  {
+  case 7: // 125 kHz
+      bw = 125000;
+      break;
+  case 8: // 250 kHz
+      bw = 250000;
+      break;
+  case 9: // 500 kHz
+      bw = 500000;
+      break;
+  }
+
+  if( ( int32_t )( 8 * pktLen - 4 * s->Datarate + 28 + 16 * s->CrcOn - ( s->FixLen ? 20 : 0 ) ) < 0 )
+  {
+    return false;
+  }
+
+  // Symbol rate : time for one symbol (secs)
+  double rs = bw / ( 1 << s->Datarate );
+  double ts = 1 / rs;
+  // time of preamble
+  double tPreamble = ( s->PreambleLen + 4.25 ) * ts;
+  // Symbol length of payload and time
+  double tmp = ceil( ( 8 * pktLen - 4 * s->Datarate +
+                       28 + 16 * s->CrcOn -
+                       ( s->FixLen ? 20 : 0 ) ) /
+                       ( double )( 4 * ( s->Datarate -
+                       ( ( s->LowDatarateOptimize > 0 ) ? 2 : 0 ) ) ) ) *
+                       ( s->Coderate + 4 );
+  double nPayload = 8 + ( ( tmp > 0 ) ? tmp : 0 );
+  double tPayload = nPayload * ts;
+  // Time on air
+  double tOnAir = tPreamble + tPayload;
+  // return ms secs
+  *airTime = ( uint32_t )floor( tOnAir * 1000 + 0.999 );
+  return true;
+}
+
+static uint32_t OldTimeOnAirFsk( const RadioFskSettings_t *s, uint8_t syncConfig, uint8_t packetConfig1, uint8_t pktLen )
+{
+  return ( uint32_t )round( ( 8 * ( s->PreambleLen +
+                              ( ( syncConfig & ~RF_SYNCCONFIG_SYNCSIZE_MASK ) + 1 ) +
+                              ( ( s->FixLen == 0x01 ) ? 0.0 : 1.0 ) +
+                              ( ( ( packetConfig1 & ~RF_PACKETCONFIG1_ADDRSFILTERING_MASK ) != 0x00 ) ? 1.0 : 0 ) +
+                              pktLen +
+                              ( ( s->CrcOn == 0x01 ) ? 2.0 : 0 ) ) /
+                              s->Datarate ) * 1000 );
+}
+
+static uint32_t OldRxSingleTimeout( uint16_t symbTimeout, uint32_t datarate )
+{
+  return ( uint32_t )( symbTimeout * ( ( 1.0 / ( double )datarate ) * 8.0 ) * 1000 );
+}
+
+static uint16_t OldBitrateReg( uint32_t datarate )
+{
+  return ( uint16_t )( ( double )XTAL_FREQ / ( double )datarate );
+}
+
+static uint16_t OldFdevReg( uint32_t fdev )
+{
+  return ( uint16_t )( ( double )fdev / ( double )FREQ_STEP );
+}
+
+static double OldSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth )
+{
+  return ( ( double )( 1 << phyDr ) / ( double )bandwidth ) * 1000;
+}
+
+static double OldSymbolTimeFsk( uint8_t phyDr )
+{
+  return ( 8.0 / ( double )phyDr ); // 1 symbol equals 1 byte
+}
+
+/*!
+ * @brief Baseline RX window, false when a negative timeout was converted to
+ *        uint32_t, which is undefined
+ */
+static bool OldComputeRxWindowParameters( double tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime,
+                                          uint32_t* windowTimeout, int32_t* windowOffset )
+{
+  double timeout = ceil( ( ( 2 * minRxSymbols - 8 ) * tSymbol + 2 * rxError ) / tSymbol );
+
+  if( timeout < 0 )
+  {
+    return false;
+  }
+  *windowTimeout = MAX( ( uint32_t )timeout, minRxSymbols ); // Computed number of symbols
+  *windowOffset = ( int32_t )ceil( ( 4.0 * tSymbol ) - ( ( *windowTimeout * tSymbol ) / 2.0 ) - wakeUpTime );
+  return true;
+}
+
+/* Exact references, in 64-bit integers -------------------------------------*/
+
+static int64_t TestCeilDiv( int64_t num, int64_t den )
+{
+  int64_t q = num / den;
+
+  return ( ( num % den ) > 0 ) ? q + 1 : q;
+}
+
+/*!
+ * @brief ( preamble + 4.25 + 8 + payload symbols ) * 2^SF / bw, rounded up to the ms
+ */
+static uint32_t ExactTimeOnAirLoRa( const RadioLoRaSettings_t *s, uint8_t pktLen )
+{
+  int64_t bw = 125000 << ( s->Bandwidth - 7 );
+  int64_t bits = 8 * pktLen - 4 * ( int64_t )s->Datarate + 28 + 16 * s->CrcOn - ( s->FixLen ? 20 : 0 );
+  int64_t blocks = ( bits > 0 ) ? TestCeilDiv( bits, 4 * ( s->Datarate - ( s->LowDatarateOptimize ? 2 : 0 ) ) ) : 0;
+  int64_t quarters = 4 * ( int64_t )s->PreambleLen + 17 + 32 + 4 * blocks * ( s->Coderate + 4 );
+
+  return ( uint32_t )TestCeilDiv( ( quarters << s->Datarate ) * 1000, 4 * bw );
+}
+
+/*!
+ * @brief Differences are only legal when the exact value sits on the boundary
+ *        the double missed: a .5 for round( ), an integer for ceil( ) and casts
+ */
+static void TestClassify( TestDiffs_t *diffs, uint32_t old, uint32_t new, int64_t num, int64_t den, bool ceiling )
+{
+  diffs->Cases++;
+  if( old == new )
+  {
+    return;
+  }
+  if( ceiling && ( old == new + 1 ) && ( ( num % den ) == 0 ) )
+  {
+    diffs->Overshoot++;
+  }
+  else if( !ceiling && ( old + 1 == new ) && ( ( ( 2 * num ) % ( 2 * den ) ) == den ) )
+  {
+    diffs->Tie++;
+  }
+  else if( !ceiling && ( old + 1 == new ) && ( ( num % den ) == 0 ) )
+  {
+    diffs->Truncated++;
+  }
+  else
+  {
+    TEST_CHECK( old == new );
+  }
+}
+
+static void TestPrintDiffs( const char *name, const TestDiffs_t *diffs )
+{
+  printf( "%-22s %10u cases, %u wrapped, %u undefined, %u ceil overshoots, %u round ties, %u cast truncations\n",
+          name, diffs->Cases, diffs->Wrapped, diffs->Undefined, diffs->Overshoot, diffs->Tie, diffs->Truncated );
+}
+
+/* Tests ---------------------------------------------------------------------*/
+
+/*!
+ * @brief LoRa time-on-air: every SF, BW, CR, CRC, header, LDRO and payload
+ *        length, on a set of preamble lengths
+ */
+static void TestTimeOnAirLoRa( void )
+{
+  static const uint16_t preambles[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 16, 32, 64, 255, 256, 1000, 4096, 65535 };
+  RadioLoRaSettings_t *s = &SX1276.Settings.LoRa;
+  TestDiffs_t diffs = { 0 };
+  uint32_t p, sf, bw, cr, flags, len;
+  uint32_t old, new, exact;
+
+  for( p = 0; p < sizeof( preambles ) / sizeof( preambles[0] ); p++ )
+  for( sf = 6; sf <= 12; sf++ )
+  for( bw = 7; bw <= 9; bw++ )
+  for( cr = 1; cr <= 4; cr++ )
+  for( flags = 0; flags < 8; flags++ )
+  for( len = 0; len < 256; len++ )
+  {
+    s->PreambleLen = preambles[p];
+    s->Datarate = sf;
+    s->Bandwidth = bw;
+    s->Coderate = cr;
+    s->CrcOn = ( flags & 1 ) != 0;
+    s->FixLen = ( flags & 2 ) != 0;
+    s->LowDatarateOptimize = ( flags & 4 ) != 0;
+
+    new = SX1276GetTimeOnAir( MODEM_LORA, len );
+    exact = ExactTimeOnAirLoRa( s, len );
+    TEST_CHECK( new == exact );
+    if( OldTimeOnAirLoRa( s, len, &old ) == false )
+    {
+      diffs.Cases++;
+      diffs.Wrapped++;
+      continue;
+    }
+    /* floor( x + 0.999 ) is a ceil( ): x is a multiple of 1 / 500 ms */
+    TestClassify( &diffs, old, new, 1, 1, true );
+  }
+  TestPrintDiffs( "LoRa time-on-air", &diffs );
+}
+
+/*!
+ * @brief FSK time-on-air: every packet option at the common bit rates, and
+ *        every bit rate from 600 bps to 300 kbps on a few lengths
+ */
+static void TestTimeOnAirFsk( void )
+{
+  static const uint32_t datarates[] = { 1200, 2400, 4800, 9600, 19200, 38400, 50000, 100000, 150000, 200000, 250000, 300000 };
+  RadioFskSettings_t *s = &SX1276.Settings.Fsk;
+  TestDiffs_t diffs = { 0 };
+  uint32_t dr, preamble, sync, flags, len;
+  uint32_t i, n;
+
+  for( i = 0; i < sizeof( datarates ) / sizeof( datarates[0] ); i++ )
+  for( preamble = 0; preamble <= 16; preamble++ )
+  for( sync = 0; sync < 8; sync++ )
+  for( flags = 0; flags < 8; flags++ )
+  for( len = 0; len < 256; len++ )
+  {
+    s->Datarate = datarates[i];
+    s->PreambleLen = preamble;
+    s->FixLen = ( flags & 1 ) != 0;
+    s->CrcOn = ( flags & 2 ) != 0;
+    SX1276Write( REG_SYNCCONFIG, sync );
+    SX1276Write( REG_PACKETCONFIG1, ( flags & 4 ) ? RF_PACKETCONFIG1_ADDRSFILTERING_NODE : 0 );
+    n = preamble + sync + 1 + ( s->FixLen ? 0 : 1 ) + ( ( flags & 4 ) ? 1 : 0 ) + len + ( s->CrcOn ? 2 : 0 );
+
+    TestClassify( &diffs, OldTimeOnAirFsk( s, sync, SX1276Read( REG_PACKETCONFIG1 ), len ),
+                  SX1276GetTimeOnAir( MODEM_FSK, len ), 8000 * ( int64_t )n, s->Datarate, false );
+    /* round half up of 8000 * n / datarate ms */
+    TEST_CHECK( SX1276GetTimeOnAir( MODEM_FSK, len ) == ( 16000 * ( uint64_t )n + s->Datarate ) / ( 2 * s->Datarate ) );
+  }
+
+  s->PreambleLen = 5;
+  s->FixLen = false;
+  s->CrcOn = true;
+  SX1276Write( REG_SYNCCONFIG, 2 );
+  SX1276Write( REG_PACKETCONFIG1, 0 );
+  for( dr = 600; dr <= 300000; dr++ )
+  {
+    static const uint8_t lengths[] = { 0, 17, 51, 255 };
+
+    s->Datarate = dr;
+    for( i = 0; i < sizeof( lengths ) / sizeof( lengths[0] ); i++ )
+    {
+      n = 5 + 3 + 1 + lengths[i] + 2;
+      TestClassify( &diffs, OldTimeOnAirFsk( s, 2, 0, lengths[i] ),
+                    SX1276GetTimeOnAir( MODEM_FSK, lengths[i] ), 8000 * ( int64_t )n, dr, false );
+    }
+  }
+  TestPrintDiffs( "FSK time-on-air", &diffs );
+}
+
+/*!
+ * @brief FSK RX single timeout and bit rate register through SX1276SetRxConfig,
+ *        frequency deviation register through SX1276SetTxConfig
+ */
+static void TestFskConfig( void )
+{
+  static const uint16_t timeouts[] = { 0, 1, 5, 8, 100, 1023, 65535 };
+  TestDiffs_t diffs = { 0 };
+  TestDiffs_t regs = { 0 };
+  uint32_t dr, fdev, i;
+  uint16_t reg;
+
+  for( dr = 600; dr <= 300000; dr++ )
+  {
+    for( i = 0; i < sizeof( timeouts ) / sizeof( timeouts[0] ); i++ )
+    {
+      SX1276SetRxConfig( MODEM_FSK, 50000, dr, 0, 83333, 5, timeouts[i], false, 0, true, 0, 0, false, false );
+      TEST_CHECK( SX1276.Settings.Fsk.RxSingleTimeout == ( uint32_t )( ( timeouts[i] * 8000ULL ) / dr ) );
+      TestClassify( &diffs, OldRxSingleTimeout( timeouts[i], dr ), SX1276.Settings.Fsk.RxSingleTimeout,
+                    timeouts[i] * 8000LL, dr, false );
+    }
+    reg = ( ( uint16_t )SX1276Read( REG_BITRATEMSB ) << 8 ) | SX1276Read( REG_BITRATELSB );
+    TEST_CHECK( reg == ( uint16_t )( XTAL_FREQ / dr ) );
+    TestClassify( &regs, OldBitrateReg( dr ), reg, XTAL_FREQ, dr, false );
+  }
+  for( fdev = 0; fdev <= 200000; fdev++ )
+  {
+    SX1276SetTxConfig( MODEM_FSK, 14, fdev, 0, 50000, 0, 5, false, true, 0, 0, 0, 3000 );
+    reg = ( ( uint16_t )SX1276Read( REG_FDEVMSB ) << 8 ) | SX1276Read( REG_FDEVLSB );
+    TEST_CHECK( reg == ( uint16_t )( ( ( uint64_t )fdev << 8 ) / FREQ_STEP_8 ) );
+    TestClassify( &regs, OldFdevReg( fdev ), reg, ( int64_t )fdev << 8, FREQ_STEP_8, false );
+  }
+  TestPrintDiffs( "FSK RxSingleTimeout", &diffs );
+  TestPrintDiffs( "FSK bitrate/fdev regs", &regs );
+}
+
+/*!
+ * @brief RX window of every LoRa datarate of the regions and of FSK 50 kbps,
+ *        over the MIB range of minRxSymbols and a wide range of rxError
+ */
+static void TestRxWindow( void )
+{
+  static const uint8_t sfs[] = { 7, 8, 9, 10, 11, 12 };
+  static const uint32_t bws[] = { 125000, 250000, 500000 };
+  static const uint32_t wakeUps[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 15, 20, 50, 100 };
+  TestDiffs_t timeouts = { 0 };
+  TestDiffs_t offsets = { 0 };
+  TestDiffs_t defaults = { 0 };
+  uint32_t k, minRx, rxError, w;
+
+  for( k = 0; k <= sizeof( sfs ) * 3; k++ )
+  {
+    bool fsk = ( k == sizeof( sfs ) * 3 );
+    uint32_t tSymbol = fsk ? RegionCommonComputeSymbolTimeFsk( 50 ) :
+                             RegionCommonComputeSymbolTimeLoRa( sfs[k / 3], bws[k % 3] );
+    double oldSymbol = fsk ? OldSymbolTimeFsk( 50 ) : OldSymbolTimeLoRa( sfs[k / 3], bws[k % 3] );
+
+    /* the symbol time in us is exact */
+    TEST_CHECK( fsk ? ( tSymbol * 50 == 8000 ) : ( ( uint64_t )tSymbol * bws[k % 3] == 1000000ULL << sfs[k / 3] ) );
+
+    for( minRx = 0; minRx < 256; minRx++ )
+    for( rxError = 0; rxError <= 500; rxError++ )
+    for( w = 0; w < sizeof( wakeUps ) / sizeof( wakeUps[0] ); w++ )
+    {
+      uint32_t newTimeout, oldTimeout;
+      int32_t newOffset, oldOffset;
+      int64_t num = ( 2 * ( int64_t )minRx - 8 ) * tSymbol + 2000 * ( int64_t )rxError;
+      int64_t exactTimeout = MAX( ( num > 0 ) ? TestCeilDiv( num, tSymbol ) : 0, ( int64_t )minRx );
+      int64_t offsetNum;
+
+      RegionCommonComputeRxWindowParameters( tSymbol, minRx, rxError, wakeUps[w], &newTimeout, &newOffset );
+      TEST_CHECK( newTimeout == exactTimeout );
+      offsetNum = ( 8 - ( int64_t )newTimeout ) * tSymbol - 2000 * ( int64_t )wakeUps[w];
+      TEST_CHECK( newOffset == TestCeilDiv( offsetNum, 2000 ) );
+
+      if( OldComputeRxWindowParameters( oldSymbol, minRx, rxError, wakeUps[w], &oldTimeout, &oldOffset ) == false )
+      {
+        timeouts.Cases++;
+        timeouts.Undefined++;
+        continue;
+      }
+      TestClassify( &timeouts, oldTimeout, newTimeout, num, tSymbol, true );
+      if( ( fsk == false ) && ( minRx <= 16 ) && ( rxError <= 100 ) )
+      {
+        TestClassify( &defaults, oldTimeout, newTimeout, num, tSymbol, true );
+      }
+      /* the defaults of the MAC: 6 symbols, 10 ms of error */
+      if( ( minRx == 6 ) && ( rxError == 10 ) )
+      {
+        TEST_CHECK( ( oldTimeout == newTimeout ) && ( oldOffset == newOffset ) );
+      }
+      /* an offset is only comparable for the same timeout */
+      if( oldTimeout == newTimeout )
+      {
+        TestClassify( &offsets, ( uint32_t )oldOffset, ( uint32_t )newOffset, offsetNum, 2000, true );
+      }
+    }
+  }
+  TestPrintDiffs( "RX window timeout", &timeouts );
+  TestPrintDiffs( "  LoRa, small settings", &defaults );
+  TestPrintDiffs( "RX window offset", &offsets );
+  /* LoRa overshoots need minRxSymbols above 16 or rxError above 100 ms */
+  TEST_CHECK( defaults.Overshoot == 0 );
+}
+
+int main( void )
+{
+  SX1276BoardInit( &BoardCallbacks );
+
+  TestTimeOnAirLoRa( );
+  TestTimeOnAirFsk( );
+  TestFskConfig( );
+  TestRxWindow( );
+
+  return TEST_END( "test_toa" );
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
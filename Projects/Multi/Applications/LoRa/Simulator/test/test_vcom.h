@@ -0,0 +1,325 @@
+/**
+ ******************************************************************************
+ * @file    test_vcom.h
+ * @author  MCD Application Team
+ * @version V1.1.4
+ * @date    08-January-2018
+ * @brief   Fake LPUART and DMA of the AT_Slave virtual COM port, for the host
+ *          tests that include vcom.c
+ ******************************************************************************
+ * @attention
+ *
+ * <h2><center>&copy; Copyright (c) 2017 STMicroelectronics International N.V.
+ * All rights reserved.</center></h2>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted, provided that the following conditions are met:
+ *
+ * 1. Redistribution of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of STMicroelectronics nor the names of other
+ *    contributors to this software may be used to endorse or promote products
+ *    derived from this software without specific written permission.
+ * 4. This software, including modifications and/or derivative works of this
+ *    software, must execute solely and exclusively on microcontroller or
+ *    microprocessor devices manufactured by or for STMicroelectronics.
+ * 5. Redistribution and use of this software other than as permitted under
+ *    this license is void and will automatically terminate your rights under
+ *    this license.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STMICROELECTRONICS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS, IMPLIED OR STATUTORY WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NON-INFRINGEMENT OF THIRD PARTY INTELLECTUAL PROPERTY
+ * RIGHTS ARE DISCLAIMED TO THE FULLEST EXTENT PERMITTED BY LAW. IN NO EVENT
+ * SHALL STMICROELECTRONICS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_VCOM_H__
+#define __TEST_VCOM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_hw_conf.h"
+#include "low_power_manager.h"
+
+/* the MCU layer and the LL drivers of AT_Slave are replaced by the fakes below */
+#define __HW_H__
+#define __STM32L0xx_LL_LPUART_H
+#define __STM32L0xx_LL_RCC_H
+#define __STM32L0xx_LL_DMA_H
+
+/* the interrupt mask macros of hw.h */
+#include "utilities.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Fake LPUART and DMA: the DMA channel 7 sends the tx buffer of vcom.c to
+   TestOutput, a transfer completes as soon as its flag is polled. The DMA
+   channel 6 has received the chars TestReceive wrote in the rx buffer */
+
+typedef struct
+{
+  volatile uint32_t TDR;
+  volatile uint32_t RDR;
+} USART_TypeDef;
+
+typedef struct
+{
+  uint32_t BaudRate;
+  uint32_t DataWidth;
+  uint32_t StopBits;
+  uint32_t Parity;
+  uint32_t TransferDirection;
+  uint32_t HardwareFlowControl;
+} LL_LPUART_InitTypeDef;
+
+typedef struct
+{
+  uint32_t PeriphOrM2MSrcAddress;
+  uint32_t MemoryOrM2MDstAddress;
+  uint32_t Direction;
+  uint32_t Mode;
+  uint32_t PeriphOrM2MSrcIncMode;
+  uint32_t MemoryOrM2MDstIncMode;
+  uint32_t PeriphOrM2MSrcDataSize;
+  uint32_t MemoryOrM2MDstDataSize;
+  uint32_t NbData;
+  uint32_t PeriphRequest;
+  uint32_t Priority;
+} LL_DMA_InitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+
+#define __IO                            volatile
+
+#define UARTX                           ( &FakeUart )
+#define DMA1                            NULL
+#define UARTX_IRQn                      0
+#define UARTX_TX_PIN                    GPIO_PIN_2
+#define UARTX_TX_GPIO_PORT              GPIOA
+#define UARTX_TX_AF                     6U
+#define UARTX_RX_PIN                    GPIO_PIN_3
+#define UARTX_RX_GPIO_PORT              GPIOA
+#define UARTX_RX_AF                     6U
+#define DMA1_Channel4_5_6_7_IRQn        0
+#define IRQ_PRIORITY_USARTX             2
+#define GPIO_SPEED_FREQ_MEDIUM          GPIO_SPEED_MEDIUM
+
+#define LL_AHB1_GRP1_PERIPH_DMA1        0U
+#define LL_RCC_LPUART1_CLKSOURCE_HSI    0U
+#define LL_LPUART_DATAWIDTH_8B          0U
+#define LL_LPUART_STOPBITS_1            0U
+#define LL_LPUART_PARITY_NONE           0U
+#define LL_LPUART_DIRECTION_TX_RX       0U
+#define LL_LPUART_HWCONTROL_NONE        0U
+#define LL_LPUART_WAKEUP_ON_STARTBIT    0U
+#define LL_DMA_CHANNEL_6                6U
+#define LL_DMA_CHANNEL_7                7U
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY 0U
+#define LL_DMA_DIRECTION_MEMORY_TO_PERIPH 1U
+#define LL_DMA_MODE_NORMAL              0U
+#define LL_DMA_MODE_CIRCULAR            1U
+#define LL_DMA_PERIPH_NOINCREMENT       0U
+#define LL_DMA_MEMORY_INCREMENT         1U
+#define LL_DMA_PDATAALIGN_BYTE          0U
+#define LL_DMA_MDATAALIGN_BYTE          0U
+#define LL_DMA_REQUEST_5                5U
+#define LL_DMA_PRIORITY_LOW             0U
+#define LL_DMA_PRIORITY_MEDIUM          1U
+
+#define TEST_OUTPUT_SIZE                4096
+
+/* Exported macros -----------------------------------------------------------*/
+
+/* DMA channel 7, the tx */
+#define LL_DMA_IsEnabledChannel( ... )          FakeDmaOn
+#define LL_DMA_EnableChannel( ... )             ( FakeDmaOn = true )
+#define LL_DMA_DisableChannel( ... )            ( FakeDmaOn = false )
+#define LL_DMA_IsActiveFlag_TC7( ... )          FakeDmaDone( )
+
+/* DMA channel 6, the rx: the count of chars left before it wraps */
+#define LL_DMA_GetDataLength( ... )             ( BUFSIZE_RX - ( FakeRxCount % BUFSIZE_RX ) )
+
+/* the DMA addresses are 32 bits on the MCU, the fake DMA does not use them */
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+
+/* LL and HAL calls the tests do not observe */
+#define DBG_PRINTF( ... )                       ( ( void )0 )
+#define HAL_NVIC_SetPriority( ... )             ( ( void )0 )
+#define HAL_NVIC_EnableIRQ( ... )               ( ( void )0 )
+#define UARTX_CLK_ENABLE( ... )                 ( ( void )0 )
+#define LL_AHB1_GRP1_EnableClock( ... )         ( ( void )0 )
+#define LL_RCC_SetLPUARTClockSource( ... )      ( ( void )0 )
+#define LL_LPUART_DeInit( ... )                 ( ( void )0 )
+#define LL_LPUART_Enable( ... )                 ( ( void )0 )
+#define LL_LPUART_EnableInStopMode( ... )       ( ( void )0 )
+#define LL_LPUART_SetWKUPType( ... )            ( ( void )0 )
+#define LL_LPUART_EnableDMAReq_RX( ... )        ( ( void )0 )
+#define LL_LPUART_DisableDMAReq_RX( ... )       ( ( void )0 )
+#define LL_LPUART_EnableDMAReq_TX( ... )        ( ( void )0 )
+#define LL_LPUART_DisableDMAReq_TX( ... )       ( ( void )0 )
+#define LL_LPUART_EnableIT_TC( ... )            ( ( void )0 )
+#define LL_LPUART_EnableIT_IDLE( ... )          ( ( void )0 )
+#define LL_LPUART_EnableIT_WKUP( ... )          ( ( void )0 )
+#define LL_LPUART_EnableIT_PE( ... )            ( ( void )0 )
+#define LL_LPUART_EnableIT_ERROR( ... )         ( ( void )0 )
+#define LL_LPUART_IsEnabledIT_TC( ... )         0U
+#define LL_LPUART_IsEnabledIT_IDLE( ... )       0U
+#define LL_LPUART_IsEnabledIT_WKUP( ... )       0U
+#define LL_LPUART_IsActiveFlag_TEACK( ... )     1U
+#define LL_LPUART_IsActiveFlag_REACK( ... )     1U
+#define LL_LPUART_IsActiveFlag_TC( ... )        0U
+#define LL_LPUART_IsActiveFlag_IDLE( ... )      0U
+#define LL_LPUART_IsActiveFlag_WKUP( ... )      0U
+#define LL_LPUART_IsActiveFlag_PE( ... )        0U
+#define LL_LPUART_IsActiveFlag_FE( ... )        0U
+#define LL_LPUART_IsActiveFlag_ORE( ... )       0U
+#define LL_LPUART_IsActiveFlag_NE( ... )        0U
+#define LL_LPUART_ClearFlag_TC( ... )           ( ( void )0 )
+#define LL_LPUART_ClearFlag_IDLE( ... )         ( ( void )0 )
+#define LL_LPUART_ClearFlag_WKUP( ... )         ( ( void )0 )
+#define LL_LPUART_ClearFlag_PE( ... )           ( ( void )0 )
+#define LL_LPUART_ClearFlag_FE( ... )           ( ( void )0 )
+#define LL_LPUART_ClearFlag_ORE( ... )          ( ( void )0 )
+#define LL_LPUART_ClearFlag_NE( ... )           ( ( void )0 )
+#define LL_DMA_EnableIT_HT( ... )               ( ( void )0 )
+#define LL_DMA_EnableIT_TC( ... )               ( ( void )0 )
+#define LL_DMA_DisableIT_TC( ... )              ( ( void )0 )
+#define LL_DMA_IsActiveFlag_HT6( ... )          0U
+#define LL_DMA_IsActiveFlag_TC6( ... )          0U
+#define LL_DMA_ClearFlag_HT6( ... )             ( ( void )0 )
+#define LL_DMA_ClearFlag_TC6( ... )             ( ( void )0 )
+#define LL_DMA_ClearFlag_TC7( ... )             ( ( void )0 )
+
+/* Exported variables --------------------------------------------------------*/
+
+static USART_TypeDef FakeUart;
+static bool FakeDmaOn = false;
+
+/* count of chars the rx DMA wrote */
+static uint32_t FakeRxCount = 0;
+
+/* chars sent by the fake DMA, not kept when TestKeep is false */
+static char TestOutput[TEST_OUTPUT_SIZE];
+static size_t TestOutputSize = 0;
+static bool TestKeep = true;
+
+/* Exported functions ------------------------------------------------------- */
+
+static uint32_t FakeDmaDone( void );
+
+/* Fake interrupt mask, thread mode ------------------------------------------*/
+
+uint32_t __get_PRIMASK( void )
+{
+  return 0;
+}
+
+void __set_PRIMASK( uint32_t priMask )
+{
+}
+
+void __disable_irq( void )
+{
+}
+
+static inline uint32_t __get_IPSR( void )
+{
+  return 0;
+}
+
+void LPM_SetStopMode( LPM_Id_t id, LPM_SetMode_t mode )
+{
+}
+
+/* Fake setup of the LPUART and the DMA, not observed ------------------------*/
+
+static inline void HW_GPIO_Init( GPIO_TypeDef *port, uint16_t pin, GPIO_InitTypeDef *init )
+{
+}
+
+static inline void LL_LPUART_Init( USART_TypeDef *uart, LL_LPUART_InitTypeDef *init )
+{
+}
+
+static inline void LL_DMA_Init( void *dma, uint32_t channel, LL_DMA_InitTypeDef *init )
+{
+}
+
+/* The virtual COM port of AT_Slave ------------------------------------------*/
+
+#include VCOM_SOURCE
+
+static uint32_t FakeDmaDone( void )
+{
+  /* the transfer vcom_PrintDMA started, taken from the buffer at its end */
+  if( ( FakeDmaOn == true ) && ( TestKeep == true ) &&
+      ( ( TestOutputSize + uart_context.tx.dmabuffSize ) < sizeof( TestOutput ) ) )
+  {
+    memcpy( &TestOutput[TestOutputSize], &uart_context.tx.buff[uart_context.tx.ir % BUFSIZE_TX], uart_context.tx.dmabuffSize );
+    TestOutputSize += uart_context.tx.dmabuffSize;
+  }
+  return FakeDmaOn;
+}
+
+/*!
+ * @brief Runs the DMA until the tx buffer is empty
+ */
+static inline void TestDrain( void )
+{
+  while( FakeDmaOn == true )
+  {
+    vcom_Dma_IRQHandler( );
+  }
+}
+
+/*!
+ * @brief Empties the tx buffer, moves its indexes to the given position in
+ *        the buffer and clears the output
+ */
+static inline void TestStart( uint16_t pos )
+{
+  TestDrain( );
+  uart_context.tx.iw += ( uint16_t )( pos - uart_context.tx.iw ) % BUFSIZE_TX;
+  uart_context.tx.ir = uart_context.tx.iw;
+  TestOutputSize = 0;
+  TestOutput[0] = '\0';
+}
+
+/*!
+ * @brief Receives chars by the rx DMA, less than BUFSIZE_RX before they are read
+ */
+static inline void TestReceive( const uint8_t *buf, uint16_t size )
+{
+  while( size-- > 0 )
+  {
+    uart_context.rx.buff[FakeRxCount % BUFSIZE_RX] = *buf++;
+    FakeRxCount++;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_VCOM_H__ */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/